@@ -14,6 +14,7 @@ SUBDIRS += sub_dataquay svcore svgui svapp
 SUBDIRS += plugins
 # SUBDIRS += PraalinePy
 SUBDIRS += app
+SUBDIRS += benchmarks
 
 sub_dataquay.file = dataquay/libdataquay.pro
 
@@ -25,4 +26,5 @@ svgui.depends = svcore
 svapp.depends = svcore svgui
 
 app.depends = praaline-core pnlib pngui sub_dataquay svcore svgui svapp
+benchmarks.depends = praaline-core praaline-media praaline-asr pnlib sub_dataquay svcore svgui svapp
 
@@ -192,11 +192,19 @@ bool CorpusRepositoriesManager::saveCorpusMetadata(const QString &corpusID)
     foreach (QString id, d->corpora.keys()) {
         if ((!corpusID.isEmpty()) && (corpusID != id)) continue;
         QPointer<Corpus> corpus = d->corpora.value(id);
-        if (corpus) result = result && corpus->save();
+        if (!corpus) continue;
+        bool saved = corpus->save();
+        if (saved && corpus->repository()) emit metadataSaved(corpus->repository()->ID());
+        result = result && saved;
     }
     return result;
 }
 
+void CorpusRepositoriesManager::notifyMetadataSaved(const QString &repositoryID)
+{
+    emit metadataSaved(repositoryID);
+}
+
 bool CorpusRepositoriesManager::removeCorpus(const QString &corpusID)
 {
     QPointer<Corpus> corpus = d->corpora.value(corpusID, Q_NULLPTR);
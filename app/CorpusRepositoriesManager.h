@@ -47,6 +47,7 @@ public:
     QList<QPointer<Praaline::Core::Corpus> > listOpenCorpora() const;
     QPointer<Praaline::Core::Corpus> getCorpusAlreadyOpen(const QString &corpusID);
     bool saveCorpusMetadata(const QString &corpusID = QString());
+    void notifyMetadataSaved(const QString &repositoryID);
     bool removeCorpus(const QString &corpusID);
 
     // Observer
@@ -60,6 +61,7 @@ signals:
     void activeCorpusRepositoryChanged(const QString &newActiveCorpusRepositoryID);
     void corpusOpened(const QString &corpusID, const QString &repositoryID);
     void corpusClosed(const QString &corpusID, const QString &repositoryID);
+    void metadataSaved(const QString &repositoryID);
 
 public slots:
 
@@ -0,0 +1,113 @@
+#include <QDebug>
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include <QEventLoop>
+#include <QtConcurrent>
+
+#include "svcore/base/Trace.h"
+
+#include "app/interfaces/IAnnotationPlugin.h"
+using namespace Praaline::Plugins;
+
+#include "PluginResourcesManager.h"
+
+struct PluginResourcesManagerData {
+    // Resource loading is mostly disk-bound: a small pool of its own keeps it from holding up the global pool
+    QThreadPool pool;
+    QHash<QString, QFuture<bool> > futures;
+    // Written from the pool threads
+    mutable QMutex mutex;
+    QHash<QString, QString> errorMessages;
+};
+
+namespace {
+
+bool prepareResources(IAnnotationPlugin *plugin, PluginResourcesManagerData *d)
+{
+    QString name = plugin->pluginName();
+    Trace::setThreadName("Plugin resources");
+    TraceSpan span("plugin resources", Trace::intern(name));
+    QString errorMessage;
+    bool ok = plugin->prepareResources(errorMessage);
+    if (!ok && errorMessage.isEmpty()) errorMessage = QString("Could not load the resources of %1").arg(name);
+    QMutexLocker locker(&d->mutex);
+    if (ok) d->errorMessages.remove(name); else d->errorMessages.insert(name, errorMessage);
+    return ok;
+}
+
+}
+
+PluginResourcesManager::PluginResourcesManager(QObject *parent) :
+    QObject(parent), d(new PluginResourcesManagerData)
+{
+    d->pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+PluginResourcesManager::~PluginResourcesManager()
+{
+    waitForAll();
+    delete d;
+}
+
+QFuture<bool> PluginResourcesManager::prepare(IAnnotationPlugin *plugin)
+{
+    if (!plugin) return QFuture<bool>();
+    QString name = plugin->pluginName();
+    if (d->futures.contains(name)) {
+        QFuture<bool> future = d->futures.value(name);
+        // A plugin whose resources failed to load is tried again, in case the problem has been fixed
+        if (!future.isFinished() || (future.resultCount() > 0 && future.result())) return future;
+    }
+    QFuture<bool> future = QtConcurrent::run(&d->pool, prepareResources, plugin, d);
+    d->futures.insert(name, future);
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, name]() {
+        bool ok = watcher->result();
+        if (!ok) {
+            QMutexLocker locker(&d->mutex);
+            qDebug() << "PluginResourcesManager:" << d->errorMessages.value(name);
+        }
+        emit resourcesReady(name, ok);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+    return future;
+}
+
+bool PluginResourcesManager::isReady(IAnnotationPlugin *plugin) const
+{
+    if (!plugin) return false;
+    QFuture<bool> future = d->futures.value(plugin->pluginName());
+    return future.isFinished() && !future.isCanceled() && future.resultCount() > 0 && future.result();
+}
+
+QString PluginResourcesManager::errorMessage(IAnnotationPlugin *plugin) const
+{
+    if (!plugin) return QString();
+    QMutexLocker locker(&d->mutex);
+    return d->errorMessages.value(plugin->pluginName());
+}
+
+bool PluginResourcesManager::waitUntilReady(IAnnotationPlugin *plugin, QString &errorMessage)
+{
+    QFuture<bool> future = prepare(plugin);
+    if (!future.isFinished()) {
+        QFutureWatcher<bool> watcher;
+        QEventLoop loop;
+        connect(&watcher, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+        watcher.setFuture(future);
+        if (!future.isFinished()) loop.exec();
+    }
+    if (future.resultCount() > 0 && future.result()) return true;
+    errorMessage = this->errorMessage(plugin);
+    return false;
+}
+
+void PluginResourcesManager::waitForAll()
+{
+    d->pool.waitForDone();
+}
@@ -0,0 +1,45 @@
+#ifndef PLUGINRESOURCESMANAGER_H
+#define PLUGINRESOURCESMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QFuture>
+
+namespace Praaline {
+namespace Plugins {
+class IAnnotationPlugin;
+}
+}
+
+struct PluginResourcesManagerData;
+
+// Loads the resources of annotation plugins (models, dictionaries) on first use, on background threads, so that
+// startup does not depend on the number of installed plugins. Each plugin's IAnnotationPlugin::prepareResources()
+// is called at most once (again only after it failed), and every caller gets the same future.
+class PluginResourcesManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PluginResourcesManager(QObject *parent = nullptr);
+    ~PluginResourcesManager();
+
+    // Start loading the resources of the plugin, if not already loaded or loading. The future's result is true
+    // when the plugin is ready to process.
+    QFuture<bool> prepare(Praaline::Plugins::IAnnotationPlugin *plugin);
+    bool isReady(Praaline::Plugins::IAnnotationPlugin *plugin) const;
+    QString errorMessage(Praaline::Plugins::IAnnotationPlugin *plugin) const;
+
+    // Start loading the resources of the plugin if needed and wait for them, keeping the event loop running.
+    bool waitUntilReady(Praaline::Plugins::IAnnotationPlugin *plugin, QString &errorMessage);
+
+    // Wait for all background loading to finish (before the plugins are finalised).
+    void waitForAll();
+
+signals:
+    void resourcesReady(const QString &pluginName, bool ok);
+
+private:
+    PluginResourcesManagerData *d;
+};
+
+#endif // PLUGINRESOURCESMANAGER_H
@@ -9,10 +9,13 @@
 
 #include "svcore/base/UnitDatabase.h"
 #include "svcore/base/Preferences.h"
+#include "svcore/transform/TransformFactory.h"
+#include "svcore/plugin/PluginScanCache.h"
 #include "svgui/layer/ColourDatabase.h"
 #include "svgui/widgets/KeyReference.h"
 #include "svgui/widgets/ActivityLog.h"
 #include "svgui/widgets/UnitConverter.h"
+#include "svgui/widgets/TraceViewer.h"
 #include "svgui/widgets/IconLoader.h"
 #include "svgui/widgets/CommandHistory.h"
 #include "updater/UpdatePraalineDialog.h"
@@ -44,16 +47,19 @@ using namespace QtilitiesProjectManagement;
 using namespace Praaline;
 
 #include "CorpusRepositoriesManager.h"
+#include "PluginResourcesManager.h"
 
 struct PraalineMainWindowData {
-    PraalineMainWindowData() : usingDarkPalette(false) {}
+    PraalineMainWindowData() : pluginResourcesManager(0), usingDarkPalette(false) {}
 
     QString shortcut_mapping_file;
     ConfigurationWidget  *configurationWidget;
     ActivityLog          *activityLog;
     UnitConverter        *unitConverter;
+    TraceViewer          *traceViewer;
     KeyReference         *keyReference;
     UpdatePraalineDialog *updaterDialog;
+    PluginResourcesManager *pluginResourcesManager;
 
     ActionContainer *menubar;
     ActionContainer *menu_file;
@@ -76,6 +82,7 @@ PraalineMainWindow::PraalineMainWindow(QtilitiesMainWindow *mainWindow, QObject
     d->configurationWidget = new ConfigurationWidget();
     d->activityLog = new ActivityLog();
     d->unitConverter = new UnitConverter();
+    d->traceViewer = new TraceViewer();
     d->keyReference = new KeyReference();
     d->updaterDialog = new UpdatePraalineDialog();
     d->unitConverter->hide();
@@ -87,6 +94,7 @@ PraalineMainWindow::~PraalineMainWindow()
     delete d->keyReference;
     delete d->activityLog;
     delete d->unitConverter;
+    delete d->traceViewer;
     delete d->updaterDialog;
     delete d;
 }
@@ -196,6 +204,10 @@ void PraalineMainWindow::initialise()
     CorpusRepositoriesManager *corpusRepositoryManager = new CorpusRepositoriesManager();
     OBJECT_MANAGER->registerObject(corpusRepositoryManager, QtilitiesCategory("Corpus"));
 
+    // Plugins register their metadata when loaded; their resources are loaded on first use by this manager
+    d->pluginResourcesManager = new PluginResourcesManager();
+    OBJECT_MANAGER->registerObject(d->pluginResourcesManager, QtilitiesCategory("Plugins"));
+
     // Register main window in object manager
     OBJECT_MANAGER->registerObject(m_mainWindow, QtilitiesCategory("PraalineMainWindow"));
 
@@ -332,7 +344,13 @@ void PraalineMainWindow::finalise()
     ACTION_MANAGER->saveShortcutMapping(d->shortcut_mapping_file);
     PROJECT_MANAGER_FINALIZE();
     LOG_FINALIZE();
+    // Plugins must not be finalised while their resources are still loading
+    if (d->pluginResourcesManager) d->pluginResourcesManager->waitForAll();
     EXTENSION_SYSTEM->finalize();
+    // Audio plugin factories: the transform factory's population thread uses the plugin scan cache, which then
+    // waits for its revalidation thread and saves the plugin metadata for the next session
+    TransformFactory::deleteInstance();
+    PluginScanCache::deleteInstance();
 }
 
 // ==============================================================================================================================
@@ -654,6 +672,13 @@ void PraalineMainWindow::setupToolsMenu()
     command = ACTION_MANAGER->registerAction("Tools.UnitConverter", action, std_context);
     command->setCategory(QtilitiesCategory(tr("Tools")));
     d->menu_tools->addAction(command);
+    // Trace viewer
+    action = new QAction(tr("&Trace"), this);
+    action->setStatusTip(tr("Record and export the time spent in annotation, alignment, statistics and audio analysis"));
+    connect(action, &QAction::triggered, this, &PraalineMainWindow::showTraceViewer);
+    command = ACTION_MANAGER->registerAction("Tools.TraceViewer", action, std_context);
+    command->setCategory(QtilitiesCategory(tr("Tools")));
+    d->menu_tools->addAction(command);
     // Separator
     d->menu_playback->addSeparator();
     // Check for updates
@@ -736,6 +761,12 @@ void PraalineMainWindow::showUnitConverter()
     d->unitConverter->raise();
 }
 
+void PraalineMainWindow::showTraceViewer()
+{
+    d->traceViewer->show();
+    d->traceViewer->raise();
+}
+
 void PraalineMainWindow::showUpdater()
 {
     d->updaterDialog->show();
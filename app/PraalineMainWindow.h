@@ -27,6 +27,7 @@ private slots:
     void showKeyReference();
     void showActivityLog();
     void showUnitConverter();
+    void showTraceViewer();
     void showUpdater();
     void toggleColourPalette();
 
@@ -15,6 +15,10 @@
 
 #include "pngui/PraalineUserInterfaceOptions.h"
 
+#include "svcore/base/Trace.h"
+
+#include "PluginResourcesManager.h"
+
 #include <QtilitiesExtensionSystem>
 using namespace QtilitiesExtensionSystem;
 
@@ -46,6 +50,8 @@ struct AutomaticAnnotationWidgetData {
     QHash<QString, QHash<QString, QtProperty *> > propertiesParameters;
 
     StatusMessagesWidget *statusMessages;
+
+    QPointer<PluginResourcesManager> pluginResources;
 };
 
 AutomaticAnnotationWidget::AutomaticAnnotationWidget(QWidget *parent) :
@@ -61,6 +67,12 @@ AutomaticAnnotationWidget::AutomaticAnnotationWidget(QWidget *parent) :
         TreeNode *node = qobject_cast<TreeNode *>(obj);
         if (node && node->observerName() == tr("Corpus Explorer")) d->corporaTopLevelNode = node;
     }
+    // Plugin resources manager
+    list = OBJECT_MANAGER->registeredInterfaces("PluginResourcesManager");
+    foreach (QObject* obj, list) {
+        PluginResourcesManager *manager = qobject_cast<PluginResourcesManager *>(obj);
+        if (manager) d->pluginResources = manager;
+    }
 
     // Status messages output widget
     d->statusMessages = new StatusMessagesWidget(this);
@@ -132,6 +144,13 @@ void AutomaticAnnotationWidget::pluginSelectionChanged()
 {
     QList<IAnnotationPlugin *> plugins = selectedPlugins();
 
+    // Start loading the resources of the selected plugins, so that they are (more likely to be) ready when annotating
+    if (d->pluginResources) {
+        foreach (IAnnotationPlugin *plugin, plugins) {
+            d->pluginResources->prepare(plugin);
+        }
+    }
+
     // Remove properties of unselected plugins
     foreach (QString pluginFilename, d->propertiesSelectedPlugins.keys()) {
         bool selected = false;
@@ -246,8 +265,19 @@ void AutomaticAnnotationWidget::actionAnnotate()
     }
     ui->progressBar->setValue(0);
     d->runningPlugins = plugins.count();
+    ui->commandAnnotate->setEnabled(false);
 
     foreach (IAnnotationPlugin *plugin, plugins) {
+        // Wait for the plugin's resources, if still loading
+        if (d->pluginResources && !d->pluginResources->isReady(plugin)) {
+            logAnnotationMessage(tr("Loading resources for %1...").arg(plugin->pluginName()));
+            QString errorMessage;
+            if (!d->pluginResources->waitUntilReady(plugin, errorMessage)) {
+                logAnnotationMessage(tr("%1 will not run: %2").arg(plugin->pluginName()).arg(errorMessage));
+                d->runningPlugins--;
+                continue;
+            }
+        }
         // Connect signals
         connect(dynamic_cast<QObject *>(plugin), SIGNAL(printMessage(QString)), this, SLOT(logAnnotationMessage(QString)));
         connect(dynamic_cast<QObject *>(plugin), SIGNAL(madeProgress(int)), this, SLOT(pluginMadeProgress(int)));
@@ -262,10 +292,14 @@ void AutomaticAnnotationWidget::actionAnnotate()
         // Send parameters to plugin
         plugin->setParameters(parameterValues);
         // Launch annotation plugin
-        plugin->process(communications);
+        {
+            TraceSpan span("annotation plugin", Trace::intern(plugin->pluginFileName()));
+            plugin->process(communications);
+        }
         // Disconnect signals
         disconnect(dynamic_cast<QObject *>(plugin), SIGNAL(printMessage(QString)), this, SLOT(logAnnotationMessage(QString)));
         disconnect(dynamic_cast<QObject *>(plugin), SIGNAL(madeProgress(int)), this, SLOT(pluginMadeProgress(int)));
     }
     d->runningPlugins = 0;
+    ui->commandAnnotate->setEnabled(true);
 }
@@ -19,11 +19,13 @@
 #include "PraalineCore/Diff/DiffIntervals.h"
 using namespace Praaline::Core;
 
+#include "pnlib/diff/IntervalDiffEngine.h"
+
 #include "pngui/model/diff/DiffSESForIntervalsTableModel.h"
 #include "pngui/widgets/CheckBoxList.h"
 #include "pngui/widgets/GridViewWidget.h"
 
-#include "pngui/xlsx/xlsxdocument.h"
+#include "pngui/xlsx/xlsxstreamingdocument.h"
 #include "pngui/xlsx/xlsxformat.h"
 
 #include "pngui/PraalineUserInterfaceOptions.h"
@@ -324,8 +326,8 @@ void CompareAnnotationsWidget::compareAnnotations()
         }
     }
 
-    d->sesSequence = DiffIntervals::intervalDiff(tier_left->intervals(), tier_right->intervals(), false,
-                                                 attributeID_left, attributeID_right).getSes().getSequence();
+    d->sesSequence = IntervalDiffEngine::diff(tier_left->intervals(), tier_right->intervals(), false,
+                                              attributeID_left, attributeID_right);
 
     DiffSESforIntervalsTableModel *model = new DiffSESforIntervalsTableModel(
                 d->sesSequence, tier_left->intervals(), tier_right->intervals(),
@@ -408,17 +410,28 @@ void CompareAnnotationsWidget::compareCorpora()
             foreach (QString speakerID, speakerIDs_common) {
                 QMap<QString, QPointer<DiffSESforIntervalsTableModel> > models;
                 QMap<QString, dtl::Ses<Interval *>::sesElemVec> sesSequences;
+                // Diff all levels of this speaker in parallel
+                QList<QString> levelIDs_diffed;
+                QList<IntervalDiffEngine::Job> jobs;
                 foreach (QString levelID, levelIDs_common) {
                     // Load annotations
                     IntervalTier *tier_left = tiersAll_left.value(speakerID)->getIntervalTierByName(levelID);
                     if (!tier_left) continue;
                     IntervalTier *tier_right = tiersAll_right.value(speakerID)->getIntervalTierByName(levelID);
                     if (!tier_right) continue;
-                    // Apply diff
-                    sesSequences.insert(levelID, DiffIntervals::intervalDiff(tier_left->intervals(), tier_right->intervals(), false).getSes().getSequence());
+                    IntervalDiffEngine::Job job;
+                    job.intervalsA = tier_left->intervals();
+                    job.intervalsB = tier_right->intervals();
+                    jobs << job;
+                    levelIDs_diffed << levelID;
+                }
+                QList<dtl::Ses<Interval *>::sesElemVec> results = IntervalDiffEngine::diffAll(jobs);
+                for (int i = 0; i < levelIDs_diffed.count(); ++i) {
+                    QString levelID = levelIDs_diffed.at(i);
+                    sesSequences.insert(levelID, results.at(i));
                     // Get model of diff sequence and add it
                     models.insert(levelID, new DiffSESforIntervalsTableModel(
-                                      sesSequences[levelID], tier_left->intervals(), tier_right->intervals(),
+                                      sesSequences[levelID], jobs.at(i).intervalsA, jobs.at(i).intervalsB,
                                       "", "", QStringList(), QStringList(), this));
                 }
                 // Export diff tables
@@ -433,41 +446,52 @@ void CompareAnnotationsWidget::compareCorpora()
 
 }
 
+// Writes the two header rows (level, column name) of the diff tables, each starting at the given column
+static void writeDiffTableHeaders(QXlsx::StreamingDocument &xlsx, const QStringList &levelIDs,
+                                  const QList<QPointer<DiffSESforIntervalsTableModel> > &models, const QList<int> &columns,
+                                  const QXlsx::Format &format)
+{
+    for (int k = 0; k < models.count(); ++k) {
+        QPointer<DiffSESforIntervalsTableModel> model = models.at(k);
+        for (int j = 0; j < model->columnCount(); ++j) {
+            xlsx.write(1, columns.at(k) + j, levelIDs.at(k), format);
+            xlsx.write(2, columns.at(k) + j, model->headerData(j, Qt::Horizontal, Qt::DisplayRole), format);
+        }
+    }
+}
+
 void CompareAnnotationsWidget::exportDiffTableByLevelExcel(const QString &communicationID, const QString &annotationID, const QString &speakerID,
                                                            QMap<QString, QPointer<DiffSESforIntervalsTableModel> > &models,
                                                            QStringList levelIDs)
 {
     if (levelIDs.isEmpty()) levelIDs = models.keys();
-    // Create an Excel document
-    QXlsx::Document xlsx;
+    // Create an Excel document, written out row by row (diff tables can be very long)
+    QString filename = QString("%1_%2.xlsx").arg(communicationID, speakerID);
+    QXlsx::StreamingDocument xlsx(d->outputPath + filename);
     // Note: rows and columns start from 1 for QXlsx
-    int row(1), col(1);
+    int row(3), col(1);
     // Format for the headers
     QXlsx::Format format_header;
     format_header.setFontBold(true);
     format_header.setHorizontalAlignment(QXlsx::Format::AlignHCenter);
     // Format: OP tMinA tMaxA tMinB tMaxB A B
+    QStringList levelModelIDs;
+    QList<QPointer<DiffSESforIntervalsTableModel> > levelModels;
+    QList<int> levelColumns;
+    int rowCount(0);
     foreach (QString levelID, levelIDs) {
         QPointer<DiffSESforIntervalsTableModel> model = models.value(levelID);
         if (!model) continue;
         int countAdditions{0}, countDeletions{0};
-        // Header
-        for (int j = 0; j < model->columnCount(); ++j) {
-            xlsx.write(1, col + j, levelID, format_header);
-            xlsx.write(2, col + j, model->headerData(j, Qt::Horizontal, Qt::DisplayRole), format_header);
-        }
-        row = 3;
         for (int i = 0; i < model->rowCount(); ++i) {
             QString opcode = model->data(model->index(i, 0), Qt::DisplayRole).toString();
             if (opcode == "+") countAdditions++;
             if (opcode == "-") countDeletions++;
-            for (int j = 0; j < model->columnCount(); ++j) {
-                if (j == 0)
-                    xlsx.write(row + i, col + j, model->data(model->index(i, j), Qt::DisplayRole).toString().replace("=", ""));
-                else
-                    xlsx.write(row + i, col + j, model->data(model->index(i, j), Qt::DisplayRole));
-            }
         }
+        levelModelIDs << levelID;
+        levelModels << model;
+        levelColumns << col;
+        rowCount = qMax(rowCount, model->rowCount());
         col = col + model->columnCount();
         // Counts
         QString message = QString("%1\t%2\t%3\t").arg(communicationID, annotationID, speakerID);
@@ -476,8 +500,32 @@ void CompareAnnotationsWidget::exportDiffTableByLevelExcel(const QString &commun
         ui->editCompareCorporaMessages->appendPlainText(message);
         QApplication::processEvents();
     }
-    QString filename = QString("%1_%2.xlsx").arg(communicationID, speakerID);
-    xlsx.saveAs(d->outputPath + filename);
+    writeDiffTableHeaders(xlsx, levelModelIDs, levelModels, levelColumns, format_header);
+    // Levels side by side, one row at a time. Rows that do not fit in a worksheet continue on the next one.
+    int sheetCount(1);
+    for (int i = 0; i < rowCount; ++i) {
+        if (row > QXlsx::StreamingDocument::maximumRowCount()) {
+            xlsx.addSheet();
+            writeDiffTableHeaders(xlsx, levelModelIDs, levelModels, levelColumns, format_header);
+            row = 3;
+            sheetCount++;
+        }
+        for (int k = 0; k < levelModels.count(); ++k) {
+            QPointer<DiffSESforIntervalsTableModel> model = levelModels.at(k);
+            if (i >= model->rowCount()) continue;
+            for (int j = 0; j < model->columnCount(); ++j) {
+                if (j == 0)
+                    xlsx.write(row, levelColumns.at(k) + j, model->data(model->index(i, j), Qt::DisplayRole).toString().replace("=", ""));
+                else
+                    xlsx.write(row, levelColumns.at(k) + j, model->data(model->index(i, j), Qt::DisplayRole));
+            }
+        }
+        row++;
+    }
+    if (sheetCount > 1)
+        ui->editCompareCorporaMessages->appendPlainText(tr("%1: the diff table is split over %2 worksheets").arg(filename).arg(sheetCount));
+    if (!xlsx.save())
+        ui->editCompareCorporaMessages->appendPlainText(tr("Error writing %1").arg(filename));
 }
 
 struct CombinedTimelineData {
@@ -491,8 +539,9 @@ void CompareAnnotationsWidget::exportDiffTableCombinedExcel(const QString &commu
                                                             QStringList levelIDs)
 {
     if (levelIDs.isEmpty()) levelIDs = models.keys();
-    // Create an Excel document
-    QXlsx::Document xlsx;
+    // Create an Excel document, written out row by row (diff tables can be very long)
+    QString filename = QString("Combined_%1_%2.xlsx").arg(communicationID, speakerID);
+    QXlsx::StreamingDocument xlsx(d->outputPath + filename);
     // Note: rows and columns start from 1 for QXlsx
     int row(1), col(1);
     // Format for the headers
@@ -503,6 +552,9 @@ void CompareAnnotationsWidget::exportDiffTableCombinedExcel(const QString &commu
     format_addition.setPatternBackgroundColor(QColor(204, 255, 204));
     format_deletion.setPatternBackgroundColor(QColor(255, 204, 255));
     // Format: OP tMinA tMaxA tMinB tMaxB A B
+    QStringList levelModelIDs;
+    QList<QPointer<DiffSESforIntervalsTableModel> > levelModels;
+    QList<int> levelFirstColumns;
     QHash<QString, int> levelColumn;
     QMultiMap<RealTime, CombinedTimelineData> timeline;
     QHash<QString, int> countDifferences;
@@ -513,11 +565,9 @@ void CompareAnnotationsWidget::exportDiffTableCombinedExcel(const QString &commu
         if (!model) continue;
         levelColumn.insert(levelID, col);
         countDifferences.insert(levelID, 0);
-        // Header
-        for (int j = 0; j < model->columnCount(); ++j) {
-            xlsx.write(1, (col - 1) * model->columnCount() + j + 1, levelID, format_header);
-            xlsx.write(2, (col - 1) * model->columnCount() + j + 1, model->headerData(j, Qt::Horizontal, Qt::DisplayRole), format_header);
-        }
+        levelModelIDs << levelID;
+        levelModels << model;
+        levelFirstColumns << (col - 1) * model->columnCount() + 1;
         for (int i = 0; i < model->rowCount(); ++i) {
             RealTime t_A = RealTime::fromSeconds(model->data(model->index(i, 1), Qt::DisplayRole).toDouble());
             RealTime t_B = RealTime::fromSeconds(model->data(model->index(i, 3), Qt::DisplayRole).toDouble());
@@ -545,8 +595,17 @@ void CompareAnnotationsWidget::exportDiffTableCombinedExcel(const QString &commu
         }
         col++;
     }
+    writeDiffTableHeaders(xlsx, levelModelIDs, levelModels, levelFirstColumns, format_header);
+    // Rows that do not fit in a worksheet continue on the next one
     row = 3;
+    int sheetCount(1);
     foreach (RealTime t, timeline.uniqueKeys()) {
+        if (row > QXlsx::StreamingDocument::maximumRowCount()) {
+            xlsx.addSheet();
+            writeDiffTableHeaders(xlsx, levelModelIDs, levelModels, levelFirstColumns, format_header);
+            row = 3;
+            sheetCount++;
+        }
         QHash<QString, int> rowsPerModel;
         foreach (CombinedTimelineData td, timeline.values(t)) {
             QPointer<DiffSESforIntervalsTableModel> model = models.value(td.levelID);
@@ -573,10 +632,12 @@ void CompareAnnotationsWidget::exportDiffTableCombinedExcel(const QString &commu
     foreach (QString levelID, levelIDs) message = message.append(QString::number(countDifferences[levelID])).append("\t");
     if (!message.isEmpty()) message.chop(1);
     ui->editCompareCorporaMessages->appendPlainText(message);
+    if (sheetCount > 1)
+        ui->editCompareCorporaMessages->appendPlainText(tr("%1: the diff table is split over %2 worksheets").arg(filename).arg(sheetCount));
     QApplication::processEvents();
 
-    QString filename = QString("Combined_%1_%2.xlsx").arg(communicationID, speakerID);
-    xlsx.saveAs(d->outputPath + filename);
+    if (!xlsx.save())
+        ui->editCompareCorporaMessages->appendPlainText(tr("Error writing %1").arg(filename));
 }
 
 
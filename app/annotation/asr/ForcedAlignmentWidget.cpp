@@ -18,6 +18,7 @@ using namespace Praaline::Core;
 #include "pngui/widgets/StatusMessagesWidget.h"
 
 // Visualiser
+#include "svcore/base/Trace.h"
 #include "svcore/data/model/WaveFileModel.h"
 #include "svcore/data/model/SparseTimeValueModel.h"
 #include "svgui/view/Pane.h"
@@ -149,7 +150,11 @@ void ForcedAlignmentWidget::open(Corpus *corpus, CorpusCommunication *com, Corpu
     qDeleteAll(d->currentTierGroups);
     d->currentTierGroups.clear();
     if (annot && d->repository) {
+        TraceSpan span("annotation", "load tiers");
         d->currentTierGroups = d->repository->annotations()->getTiersAllSpeakers(annot->ID());
+        foreach (AnnotationTierGroup *tiers, d->currentTierGroups) {
+            if (tiers) TraceCounter::tiersLoaded().add(tiers->tiersCount());
+        }
     }
 
     // Visualiser pane
@@ -187,6 +192,8 @@ void ForcedAlignmentWidget::open(Corpus *corpus, CorpusCommunication *com, Corpu
     if (d->tierModel) delete d->tierModel;
     d->tierModel = new AnnotationMultiTierTableModel(d->currentTierGroups, "transcription", annotationAttributes, Qt::Vertical);
     d->gridviewTranscription->tableView()->setModel(d->tierModel);
+    // Boundaries edited in the annotation pane change the same tiers
+    connect(model, &AnnotationGridModel::tiersChanged, d->tierModel, &AnnotationMultiTierTableModel::tiersChanged);
 }
 
 void ForcedAlignmentWidget::stepPhonetiseAll()
@@ -220,7 +227,13 @@ void ForcedAlignmentWidget::stepAlignAll()
         QList<Interval *> list_phones;
         QString alignerOutput;
         HTKForcedAligner aligner;
-        bool ok = aligner.alignAllTokens(d->recording->filePath(), tier_tokens, list_phones, alignerOutput);
+        bool ok = false;
+        {
+            // HVite runs once over the whole token tier
+            TraceSpan span("alignment", "htk align all tokens");
+            ok = aligner.alignAllTokens(d->recording->filePath(), tier_tokens, list_phones, alignerOutput);
+            TraceCounter::processesLaunched().add(aligner.countProcessesLaunched());
+        }
         d->statusMessages->appendMessage(alignerOutput);
 
         if (ok) {
@@ -228,11 +241,15 @@ void ForcedAlignmentWidget::stepAlignAll()
             IntervalTier *tier_phone = new IntervalTier("phone", list_phones);
             IntervalTier *tier_syll= syllabifier.createSyllableTier(tier_phone);
             tier_syll->setName("syll");
-            d->repository->annotations()->saveTier(annotationID, speakerID, tier_tokens);
-            d->repository->annotations()->saveTier(annotationID, speakerID, tier_phone);
-            d->repository->annotations()->saveTier(annotationID, speakerID, tier_syll);
+            int tiersSaved = 0;
+            if (d->repository->annotations()->saveTier(annotationID, speakerID, tier_tokens)) tiersSaved++;
+            if (d->repository->annotations()->saveTier(annotationID, speakerID, tier_phone)) tiersSaved++;
+            if (d->repository->annotations()->saveTier(annotationID, speakerID, tier_syll)) tiersSaved++;
+            TraceCounter::tiersSaved().add(tiersSaved);
         }
     }
+    // The token boundaries were changed by the aligner, outside the table model
+    if (d->tierModel) d->tierModel->tiersChanged();
 }
 
 void ForcedAlignmentWidget::stepSpeakerAdaptation()
@@ -2,6 +2,7 @@
 #include <QPointer>
 #include <QString>
 #include <QList>
+#include <QFileDialog>
 
 #include "LanguageModelBuilderWidget.h"
 #include "ui_LanguageModelBuilderWidget.h"
@@ -34,6 +35,7 @@ LanguageModelBuilderWidget::LanguageModelBuilderWidget(QWidget *parent) :
     ui->setupUi(this);
     // Initialise
     d->languageModelBuilder = new SphinxLanguageModelBuilder(this);
+    connect(d->languageModelBuilder, &SphinxLanguageModelBuilder::printMessage, ui->textMessages, &QPlainTextEdit::appendPlainText);
     // Annotation Level and Attributes
     connect(ui->comboBoxUtterancesLevel, &QComboBox::currentTextChanged, this, &LanguageModelBuilderWidget::utterancesLevelChanged);
     connect(ui->comboBoxTokensLevel, &QComboBox::currentTextChanged, this, &LanguageModelBuilderWidget::tokensLevelChanged);
@@ -116,8 +118,14 @@ void LanguageModelBuilderWidget::createLanguageModel()
     foreach (QString utt, normalisedUtterances) {
         ui->textMessages->appendPlainText(utt);
     }
-
-    // text2wfreq < S05_transcript.txt | wfreq2vocab > S05.vocab
-    // text2idngram -vocab S05.vocab -idngram S05.idngram < S05_transcript.txt
-    // idngram2lm -vocab_type 0 -idngram S05.idngram -vocab S05.vocab -arpa S05.lm
+    // Build the n-gram model and save it (ARPA, or pocketsphinx binary for .bin files)
+    d->languageModelBuilder->clearCounts();
+    if (!d->languageModelBuilder->addUtterances(normalisedUtterances)) return;
+    QString filename = QFileDialog::getSaveFileName(this, tr("Save Language Model"), d->communication->ID() + ".lm",
+                                                    tr("ARPA Language Model (*.lm *.arpa);;Pocketsphinx Binary Language Model (*.bin)"));
+    if (filename.isEmpty()) return;
+    bool result = (filename.endsWith(".bin")) ? d->languageModelBuilder->writeBinary(filename)
+                                              : d->languageModelBuilder->writeARPA(filename);
+    ui->textMessages->appendPlainText(result ? tr("Language model written to %1").arg(filename)
+                                             : tr("Error writing language model to %1").arg(filename));
 }
@@ -27,6 +27,7 @@ using namespace Praaline::Core;
 #include "pngui/widgets/CorpusItemSelectorWidget.h"
 #include "pngui/model/visualiser/ProsogramModel.h"
 
+#include "pnlib/diff/IntervalDiffEngine.h"
 #include "pngui/model/diff/DiffSESForIntervalsTableModel.h"
 #include "pngui/widgets/GridViewWidget.h"
 
@@ -148,8 +149,7 @@ void LongSoundAlignerWidget::diffTranscriptionWithRecogniser()
     QList<Interval *> tokens_transcript = d->annotation->repository()->annotations()->getIntervals(
                 AnnotationDatastore::Selection(d->annotation->ID(), "", "tok_min"));
 
-    d->sesSequence = DiffIntervals::intervalDiff(
-                tokens_transcript, tokens_recognised, false).getSes().getSequence();
+    d->sesSequence = IntervalDiffEngine::diff(tokens_transcript, tokens_recognised, false);
 
     DiffSESforIntervalsTableModel *model = new DiffSESforIntervalsTableModel(
                 d->sesSequence, tokens_transcript, tokens_recognised,
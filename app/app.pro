@@ -109,6 +109,7 @@ LIBS +=  \
         -L../pngui/$${COMPONENTSPATH} -lpngui \
         -L../pnlib/crf/$${COMPONENTSPATH} -lpraaline-crf \
         -L../pnlib/featextract/$${COMPONENTSPATH} -lpraaline-featextract \
+        -L../pnlib/diff/$${COMPONENTSPATH} -lpraaline-diff \
         -L../praaline-asr/$${COMPONENTSPATH} -lpraaline-asr$${PRAALINE_LIB_POSTFIX} \
         -L../praaline-media/$${COMPONENTSPATH} -lpraaline-media$${PRAALINE_LIB_POSTFIX} \
         -L../praaline-core/$${COMPONENTSPATH} -lpraaline-core$${PRAALINE_LIB_POSTFIX} \
@@ -117,6 +118,7 @@ PRE_TARGETDEPS += \
         ../pngui/$${COMPONENTSPATH}/libpngui.a \
         ../pnlib/crf/$${COMPONENTSPATH}/libpraaline-crf.a \
         ../pnlib/featextract/$${COMPONENTSPATH}/libpraaline-featextract.a \
+        ../pnlib/diff/$${COMPONENTSPATH}/libpraaline-diff.a \
         ../praaline-asr/$${COMPONENTSPATH}/libpraaline-asr$${PRAALINE_LIB_POSTFIX}.$${LIB_SUFFIX}
         ../praaline-media/$${COMPONENTSPATH}/libpraaline-media$${PRAALINE_LIB_POSTFIX}.$${LIB_SUFFIX}
         ../praaline-core/$${COMPONENTSPATH}/libpraaline-core$${PRAALINE_LIB_POSTFIX}.$${LIB_SUFFIX}
@@ -126,6 +128,7 @@ SOURCES += main.cpp \
     NetworkPermissionTester.cpp \
     PraalineSplash.cpp \
     CorpusRepositoriesManager.cpp \
+    PluginResourcesManager.cpp \
     annotation/AnnotationBrowserWidget.cpp \
     annotation/asr/PhonetiserWidget.cpp \
     annotation/editors/TestEditor.cpp \
@@ -244,6 +247,7 @@ SOURCES += main.cpp \
     statistics/interrater/KappaStatisticsCalculator.cpp \
     statistics/disfluencies/StatisticsPluginDisfluencies.cpp \
     statistics/StatisticalMeasureAggregator.cpp \
+    statistics/StatisticalMeasureCube.cpp \
     statistics/disfluencies/AnalyserDisfluencies.cpp \
     statistics/disfluencies/AnalyserDisfluenciesItem.cpp \
     statistics/disfluencies/AnalyserDisfluenciesWidget.cpp \
@@ -258,6 +262,7 @@ SOURCES += main.cpp \
     web/WebDesignerModeWidget.cpp \
     statistics/pca/StatisticsPluginPCA.cpp \
     statistics/pca/PCAPlotWidget.cpp \
+    statistics/pca/PCAEngine.cpp \
     annotation/editors/PFCTranscriptionEditor.cpp \
     web/MetadataWebDesigner.cpp \
     web/ConcordancerWebDesigner.cpp \
@@ -273,6 +278,7 @@ HEADERS  += \
     PraalineSplash.h \
     Version.h \
     CorpusRepositoriesManager.h \
+    PluginResourcesManager.h \
     annotation/AnnotationBrowserWidget.h \
     annotation/asr/PhonetiserWidget.h \
     annotation/editors/TestEditor.h \
@@ -384,6 +390,7 @@ HEADERS  += \
     statistics/temporal/PauseLengthDistributionWidget.h \
     statistics/disfluencies/StatisticsPluginDisfluencies.h \
     statistics/StatisticalMeasureAggregator.h \
+    statistics/StatisticalMeasureCube.h \
     statistics/disfluencies/AnalyserDisfluencies.h \
     statistics/disfluencies/AnalyserDisfluenciesItem.h \
     statistics/AnalyserItemBase.h \
@@ -410,6 +417,7 @@ HEADERS  += \
     welcome/WelcomeModeWidget.h \
     web/WebDesignerModeWidget.h \
     statistics/pca/StatisticsPluginPCA.h \
+    statistics/pca/PCAEngine.h \
     statistics/pca/PCAPlotWidget.h \ #\
     annotation/editors/PFCTranscriptionEditor.h \
     web/MetadataWebDesigner.h \
@@ -231,6 +231,8 @@ void CorpusExplorerTableWidget::save()
     else if (d->corpuObjectType == CorpusObject::Type_Participation)
         result = d->repository->metadata()->saveParticipations(d->itemsPart);
 
+    if (result && d->corpusRepositoryManager)
+        d->corpusRepositoryManager->notifyMetadataSaved(d->repository->ID());
     if (result && d->model) {
         refreshModel(); // d->model->modelSavedInDatabase();
     } else {
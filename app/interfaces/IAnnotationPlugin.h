@@ -39,6 +39,11 @@ namespace Praaline {
             virtual QList<PluginParameter> pluginParameters() const = 0;
             virtual void setParameters(const QHash<QString, QVariant> &parameters) = 0;
             virtual void process(const QList<CorpusCommunication *> &communications) = 0;
+            // Load the resources the plugin needs to process (models, dictionaries), so that they are not loaded at
+            // startup. Called before process(), on a background thread: implementations must not emit signals or use
+            // widgets, and process() must still work if this was never called. Called once if it succeeds; after a
+            // failure it is called again the next time the plugin is run, so it must be safe to retry.
+            virtual bool prepareResources(QString &errorMessage) { Q_UNUSED(errorMessage) return true; }
         signals:
             virtual void printMessage(const QString &message) = 0 ;
             virtual void madeProgress(int progress) = 0;
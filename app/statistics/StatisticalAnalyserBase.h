@@ -4,9 +4,16 @@
 #include <QString>
 #include <QList>
 #include <QMap>
+#include <QPair>
 
 #include "PraalineCore/Statistics/StatisticalMeasureDefinition.h"
 
+namespace Praaline {
+namespace Core {
+class Corpus;
+}
+}
+
 // Base class for statistical analysers that support aggregating their measures per Communication or per Speaker
 
 class StatisticalAnalyserBase
@@ -15,6 +22,9 @@ public:
     StatisticalAnalyserBase();
     virtual ~StatisticalAnalyserBase();
 
+    // Corpus analysed, for its metadata
+    virtual Praaline::Core::Corpus *corpus() const { return nullptr; }
+
     virtual QStringList measureIDsForCommunication() = 0;
     virtual QStringList measureIDsForSpeaker() = 0;
     virtual QStringList vectorMeasureIDsForCommunication() = 0;
@@ -25,6 +35,11 @@ public:
             const QString &measureID, const QStringList &groupAttributeIDsCom) = 0;
     virtual QMap<QString, QList<double> > aggregateMeasureSpk(
             const QString &measureID, const QStringList &groupAttributeIDsCom, const QStringList &groupAttributeIDsSpk) = 0;
+
+    // Value of a measure for each communication (by communication ID), or for each speaker in each communication
+    // (by communication ID and speaker ID). Missing values are NaN.
+    virtual QMap<QString, double> measureValuesCom(const QString &measureID) = 0;
+    virtual QMap<QPair<QString, QString>, double> measureValuesSpk(const QString &measureID) = 0;
 };
 
 #endif // STATISTICALANALYSERBASE_H
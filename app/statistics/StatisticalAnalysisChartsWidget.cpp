@@ -18,7 +18,13 @@ QT_CHARTS_USE_NAMESPACE
 #include "PraalineCore/Statistics/StatisticalSummary.h"
 using namespace Praaline::Core;
 
+#include "QtilitiesCore/QtilitiesCore"
+using namespace QtilitiesCore;
+
+#include "CorpusRepositoriesManager.h"
+
 #include "StatisticalAnalyserBase.h"
+#include "StatisticalMeasureAggregator.h"
 
 #include "StatisticalAnalysisChartsWidget.h"
 #include "ui_StatisticalAnalysisChartsWidget.h"
@@ -26,6 +32,8 @@ using namespace Praaline::Core;
 
 struct StatisticalAnalysisChartsWidgetData {
     StatisticalAnalyserBase *analyser;
+    // Measures are materialised in cubes after each analysis and regrouped in memory
+    StatisticalMeasureAggregator aggregator;
 
     CorpusRepository *repository;
     bool showMeasuresForCom;
@@ -43,6 +51,7 @@ StatisticalAnalysisChartsWidget::StatisticalAnalysisChartsWidget(CorpusRepositor
     d->repository = repository;
     // Analyser
     d->analyser = analyser;
+    d->aggregator.setAnalyser(analyser);
 
     // Measure combobox (start with measures for Communications by default)
     foreach (QString measureID, d->analyser->measureIDsForCommunication())
@@ -65,6 +74,13 @@ StatisticalAnalysisChartsWidget::StatisticalAnalysisChartsWidget(CorpusRepositor
     }
     // Command Draw Chart
     connect(ui->commandDrawChart, &QAbstractButton::clicked, this, &StatisticalAnalysisChartsWidget::drawChart);
+    // Grouping attributes are read again only when metadata is saved
+    QList<QObject *> list;
+    list = OBJECT_MANAGER->registeredInterfaces("CorpusRepositoriesManager");
+    foreach (QObject* obj, list) {
+        CorpusRepositoriesManager *manager = qobject_cast<CorpusRepositoriesManager *>(obj);
+        if (manager) connect(manager, &CorpusRepositoriesManager::metadataSaved, this, &StatisticalAnalysisChartsWidget::metadataSaved);
+    }
     // Defaults
     ui->checkBoxSetYMinMax->setChecked(true);
 }
@@ -95,9 +111,21 @@ void StatisticalAnalysisChartsWidget::showMeasuresForSpk()
     }
 }
 
+void StatisticalAnalysisChartsWidget::measuresChanged()
+{
+    d->aggregator.materialise();
+}
+
+void StatisticalAnalysisChartsWidget::metadataSaved(const QString &repositoryID)
+{
+    if (!d->repository || d->repository->ID() != repositoryID) return;
+    d->aggregator.metadataChanged();
+}
+
 void StatisticalAnalysisChartsWidget::drawChart()
 {
     if (!d->analyser) return;
+    if (!d->aggregator.isMaterialised()) measuresChanged();
 
     // Get parameters from user interface
     QString measureID = ui->comboBoxMeasure->currentData().toString();
@@ -109,11 +137,11 @@ void StatisticalAnalysisChartsWidget::drawChart()
     QMap<QString, QList<double> > aggregates;
     QString groupAttributes;
     if (d->showMeasuresForCom) {
-        aggregates = d->analyser->aggregateMeasureCom(measureID, groupAttributeIDsCom);
+        aggregates = d->aggregator.aggregateMeasureCom(measureID, groupAttributeIDsCom);
         groupAttributes = ui->comboBoxGroupByCom->currentText();
     }
     else {
-        aggregates = d->analyser->aggregateMeasureSpk(measureID, groupAttributeIDsCom, groupAttributeIDsSpk);
+        aggregates = d->aggregator.aggregateMeasureSpk(measureID, groupAttributeIDsCom, groupAttributeIDsSpk);
         QStringList sl; sl << ui->comboBoxGroupByCom->currentText() << ui->comboBoxGroupBySpk->currentText();
         groupAttributes = sl.join(", ");
     }
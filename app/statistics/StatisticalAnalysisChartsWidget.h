@@ -27,9 +27,12 @@ public:
 
     void showMeasuresForCom();
     void showMeasuresForSpk();
+    // The analyser's results changed: materialise its measures again
+    void measuresChanged();
 
 private slots:
     void drawChart();
+    void metadataSaved(const QString &repositoryID);
 
 private:
     Ui::StatisticalAnalysisChartsWidget *ui;
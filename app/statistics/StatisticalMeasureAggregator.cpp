@@ -1,69 +1,163 @@
+#include <QtMath>
+#include "StatisticalAnalyserBase.h"
+#include "StatisticalMeasureCube.h"
 #include "StatisticalMeasureAggregator.h"
 
-StatisticalMeasureAggregator::StatisticalMeasureAggregator()
+namespace {
+
+template<typename Key>
+StatisticalFeatureMatrix buildFeatureMatrix(const QStringList &measureIDs, const QList<QMap<Key, double> > &columns,
+                                            QPair<QString, QString> (*observation)(const Key &))
+{
+    StatisticalFeatureMatrix matrix;
+    matrix.measureIDs = measureIDs;
+    if (columns.isEmpty()) return matrix;
+    // Observations: all keys that have at least one value
+    QMap<Key, bool> keys;
+    foreach (const QMap<Key, double> &column, columns) {
+        for (typename QMap<Key, double>::const_iterator it = column.constBegin(); it != column.constEnd(); ++it) {
+            if (!qIsNaN(it.value())) keys.insert(it.key(), true);
+        }
+    }
+    // Means, to replace missing values
+    QVector<double> means(columns.count(), 0.0);
+    for (int j = 0; j < columns.count(); ++j) {
+        double sum = 0.0; int n = 0;
+        foreach (double v, columns.at(j).values()) {
+            if (!qIsNaN(v)) { sum += v; n++; }
+        }
+        means[j] = (n > 0) ? sum / n : 0.0;
+    }
+    matrix.values.reserve(keys.count() * columns.count());
+    foreach (const Key &key, keys.keys()) {
+        matrix.observations << observation(key);
+        for (int j = 0; j < columns.count(); ++j) {
+            double v = columns.at(j).value(key, qQNaN());
+            matrix.values << (qIsNaN(v) ? means.at(j) : v);
+        }
+    }
+    return matrix;
+}
+
+QPair<QString, QString> observationCom(const QString &communicationID)
+{
+    return QPair<QString, QString>(communicationID, QString());
+}
+
+QPair<QString, QString> observationSpk(const QPair<QString, QString> &key)
+{
+    return key;
+}
+
+}
+
+StatisticalMeasureAggregator::StatisticalMeasureAggregator(StatisticalAnalyserBase *analyser) :
+    m_analyser(analyser),
+    m_cubeCom(new StatisticalMeasureCube(StatisticalMeasureCube::Communication)),
+    m_cubeSpk(new StatisticalMeasureCube(StatisticalMeasureCube::Speaker))
+{
+}
+
+StatisticalMeasureAggregator::~StatisticalMeasureAggregator()
+{
+    delete m_cubeCom;
+    delete m_cubeSpk;
+}
+
+StatisticalAnalyserBase *StatisticalMeasureAggregator::analyser() const
+{
+    return m_analyser;
+}
+
+void StatisticalMeasureAggregator::setAnalyser(StatisticalAnalyserBase *analyser)
+{
+    if (m_analyser == analyser) return;
+    m_analyser = analyser;
+    m_cubeCom->clear();
+    m_cubeSpk->clear();
+}
+
+// ====================================================================================================================
+// Measure cubes
+// ====================================================================================================================
+
+void StatisticalMeasureAggregator::materialise()
+{
+    m_cubeCom->materialise(m_analyser);
+    m_cubeSpk->materialise(m_analyser);
+}
+
+bool StatisticalMeasureAggregator::isMaterialised() const
+{
+    return !m_cubeCom->isEmpty() || !m_cubeSpk->isEmpty();
+}
+
+void StatisticalMeasureAggregator::metadataChanged()
 {
+    m_cubeCom->clearAttributeCache();
+    m_cubeSpk->clearAttributeCache();
+}
 
+StatisticalMeasureCube *StatisticalMeasureAggregator::cubeCom() const
+{
+    return m_cubeCom;
 }
 
+StatisticalMeasureCube *StatisticalMeasureAggregator::cubeSpk() const
+{
+    return m_cubeSpk;
+}
+
+// ====================================================================================================================
+// Aggregation
+// ====================================================================================================================
+
 QMap<QString, QList<double> > StatisticalMeasureAggregator::aggregateMeasureCom(
         const QString &measureID, const QStringList &groupAttributeIDsCom)
 {
-    QMap<QString, QList<double> > aggregates;
-//    if (!d->corpus) return aggregates;
-//    foreach (CorpusCommunication *com, d->corpus->communications()) {
-//        if (!com) continue;
-//        AnalyserTemporalItem *theItem = item(com->ID());
-//        if (!theItem) continue;
-//        // Calculate ID for these data
-//        QString id;
-//        for (int i = 0; i < groupAttributeIDsCom.count(); ++i) {
-//            id = id.append(com->property(groupAttributeIDsCom.at(i)).toString());
-//            if (i < groupAttributeIDsCom.count() - 1) id = id.append("::");
-//        }
-//        // Create list if it does not exist already;
-//        if (!aggregates.contains(id))
-//            aggregates.insert(id, QList<double>());
-//        // Find measure
-//        if (AnalyserTemporalItem::measureDefinition(measureID).isVector()) {
-//            aggregates[id].append(theItem->vectorMeasureCom(measureID));
-//        } else {
-//            aggregates[id].append(theItem->measureCom(measureID));
-//        }
-//    }
-    return aggregates;
+    if (!m_analyser) return QMap<QString, QList<double> >();
+    if (m_analyser->corpus() && m_cubeCom->measureIDs().contains(measureID))
+        return m_cubeCom->aggregate(m_analyser->corpus(), measureID, groupAttributeIDsCom);
+    return m_analyser->aggregateMeasureCom(measureID, groupAttributeIDsCom);
 }
 
 QMap<QString, QList<double> > StatisticalMeasureAggregator::aggregateMeasureSpk(
         const QString &measureID, const QStringList &groupAttributeIDsCom, const QStringList &groupAttributeIDsSpk)
 {
-    QMap<QString, QList<double> > aggregates;
-//    if (!d->corpus) return aggregates;
-//    foreach (CorpusCommunication *com, d->corpus->communications()) {
-//        if (!com) continue;
-//        AnalyserTemporalItem *theItem = item(com->ID());
-//        if (!theItem) continue;
-//        foreach (QString speakerID, theItem->speakerIDs()) {
-//            QPointer<CorpusSpeaker> spk = d->corpus->speaker(speakerID);
-//            // Calculate ID for these data
-//            QString id;
-//            for (int i = 0; i < groupAttributeIDsCom.count(); ++i) {
-//                id = id.append(com->property(groupAttributeIDsCom.at(i)).toString());
-//                if (i < groupAttributeIDsCom.count() - 1) id = id.append("::");
-//            }
-//            for (int i = 0; i < groupAttributeIDsSpk.count(); ++i) {
-//                id = id.append(spk->property(groupAttributeIDsSpk.at(i)).toString());
-//                if (i < groupAttributeIDsSpk.count() - 1) id = id.append("::");
-//            }
-//            // Create list if it does not exist already;
-//            if (!aggregates.contains(id))
-//                aggregates.insert(id, QList<double>());
-//            // Find measure. If it is a vector, add the entire vector to the aggregated list; otherwise just the value.
-//            if (AnalyserTemporalItem::measureDefinition(measureID).isVector()) {
-//                aggregates[id].append(theItem->vectorMeasureSpk(speakerID, measureID));
-//            } else {
-//                aggregates[id].append(theItem->measureSpk(speakerID, measureID));
-//            }
-//        }
-//    }
-    return aggregates;
+    if (!m_analyser) return QMap<QString, QList<double> >();
+    if (m_analyser->corpus() && m_cubeSpk->measureIDs().contains(measureID))
+        return m_cubeSpk->aggregate(m_analyser->corpus(), measureID, groupAttributeIDsCom, groupAttributeIDsSpk);
+    return m_analyser->aggregateMeasureSpk(measureID, groupAttributeIDsCom, groupAttributeIDsSpk);
+}
+
+static bool containsAll(const QStringList &list, const QStringList &items)
+{
+    foreach (QString item, items) {
+        if (!list.contains(item)) return false;
+    }
+    return true;
+}
+
+StatisticalFeatureMatrix StatisticalMeasureAggregator::featureMatrixCom(const QStringList &measureIDs)
+{
+    if (!m_cubeCom->isEmpty() && containsAll(m_cubeCom->measureIDs(), measureIDs))
+        return m_cubeCom->featureMatrix(measureIDs);
+    QList<QMap<QString, double> > columns;
+    if (m_analyser) {
+        foreach (QString measureID, measureIDs)
+            columns << m_analyser->measureValuesCom(measureID);
+    }
+    return buildFeatureMatrix<QString>(measureIDs, columns, &observationCom);
+}
+
+StatisticalFeatureMatrix StatisticalMeasureAggregator::featureMatrixSpk(const QStringList &measureIDs)
+{
+    if (!m_cubeSpk->isEmpty() && containsAll(m_cubeSpk->measureIDs(), measureIDs))
+        return m_cubeSpk->featureMatrix(measureIDs);
+    QList<QMap<QPair<QString, QString>, double> > columns;
+    if (m_analyser) {
+        foreach (QString measureID, measureIDs)
+            columns << m_analyser->measureValuesSpk(measureID);
+    }
+    return buildFeatureMatrix<QPair<QString, QString> >(measureIDs, columns, &observationSpk);
 }
@@ -5,16 +5,60 @@
 #include <QList>
 #include <QStringList>
 #include <QMap>
+#include <QPair>
+#include <QVector>
+
+class StatisticalAnalyserBase;
+class StatisticalMeasureCube;
+
+// Measures of a set of observations (communications, or speakers in communications), for multivariate analyses.
+// Values are stored row by row: one row per observation, one column per measure.
+struct StatisticalFeatureMatrix
+{
+    QStringList measureIDs;
+    // Communication ID and speaker ID (empty when there is one observation per communication)
+    QList<QPair<QString, QString> > observations;
+    QVector<double> values;
+
+    int rowCount() const { return observations.count(); }
+    int columnCount() const { return measureIDs.count(); }
+    double value(int row, int column) const { return values.at(row * measureIDs.count() + column); }
+};
 
 class StatisticalMeasureAggregator
 {
 public:
-    StatisticalMeasureAggregator();
+    StatisticalMeasureAggregator(StatisticalAnalyserBase *analyser = nullptr);
+
+    ~StatisticalMeasureAggregator();
+
+    StatisticalAnalyserBase *analyser() const;
+    void setAnalyser(StatisticalAnalyserBase *analyser);
+
+    // Measure cubes: once materialised, scalar measures are aggregated and put in feature matrices from the cubes,
+    // without going back to the analyser. Materialise them again after each analysis.
+    void materialise();
+    bool isMaterialised() const;
+    // Clear the metadata attribute values cached for grouping, after the metadata change
+    void metadataChanged();
+    StatisticalMeasureCube *cubeCom() const;
+    StatisticalMeasureCube *cubeSpk() const;
 
     QMap<QString, QList<double> > aggregateMeasureCom(
             const QString &measureID, const QStringList &groupAttributeIDsCom);
     QMap<QString, QList<double> > aggregateMeasureSpk(
             const QString &measureID, const QStringList &groupAttributeIDsCom, const QStringList &groupAttributeIDsSpk);
+
+    // Feature matrix of the given measures, with one row per communication or per speaker in each communication.
+    // Missing values are replaced by the mean of their measure; observations without any value are left out.
+    StatisticalFeatureMatrix featureMatrixCom(const QStringList &measureIDs);
+    StatisticalFeatureMatrix featureMatrixSpk(const QStringList &measureIDs);
+
+private:
+    Q_DISABLE_COPY(StatisticalMeasureAggregator)
+    StatisticalAnalyserBase *m_analyser;
+    StatisticalMeasureCube *m_cubeCom;
+    StatisticalMeasureCube *m_cubeSpk;
 };
 
 #endif // STATISTICALMEASUREAGGREGATOR_H
@@ -0,0 +1,256 @@
+#include <QtMath>
+#include <QHash>
+#include <QPointer>
+
+#include "PraalineCore/Corpus/Corpus.h"
+using namespace Praaline::Core;
+
+#include "StatisticalAnalyserBase.h"
+#include "StatisticalMeasureCube.h"
+
+namespace {
+
+// Observations grouped by a combination of metadata attributes
+struct Grouping {
+    QStringList groupIDs;
+    QVector<int> groupOfRow;
+};
+
+}
+
+struct StatisticalMeasureCubeData {
+    StatisticalMeasureCubeData(StatisticalMeasureCube::Level level) :
+        level(level)
+    {}
+
+    StatisticalMeasureCube::Level level;
+    QStringList measureIDs;
+    QList<QPair<QString, QString> > observations;
+    // One column per measure, one value per observation (NaN when missing)
+    QHash<QString, QVector<double> > columns;
+    // Metadata attribute values per observation, by "com:" or "spk:" and attribute ID
+    QHash<QString, QVector<QString> > attributeColumns;
+    // Groupings, by combination of attribute IDs
+    QHash<QString, Grouping> groupings;
+};
+
+StatisticalMeasureCube::StatisticalMeasureCube(Level level) :
+    d(new StatisticalMeasureCubeData(level))
+{
+}
+
+StatisticalMeasureCube::~StatisticalMeasureCube()
+{
+    delete d;
+}
+
+StatisticalMeasureCube::Level StatisticalMeasureCube::level() const
+{
+    return d->level;
+}
+
+bool StatisticalMeasureCube::isEmpty() const
+{
+    return d->measureIDs.isEmpty();
+}
+
+QStringList StatisticalMeasureCube::measureIDs() const
+{
+    return d->measureIDs;
+}
+
+int StatisticalMeasureCube::observationCount() const
+{
+    return d->observations.count();
+}
+
+QPair<QString, QString> StatisticalMeasureCube::observation(int row) const
+{
+    return d->observations.value(row);
+}
+
+double StatisticalMeasureCube::value(int row, const QString &measureID) const
+{
+    QHash<QString, QVector<double> >::const_iterator column = d->columns.constFind(measureID);
+    if (column == d->columns.constEnd() || row < 0 || row >= column.value().count()) return qQNaN();
+    return column.value().at(row);
+}
+
+// ====================================================================================================================
+// Materialisation
+// ====================================================================================================================
+
+void StatisticalMeasureCube::clear()
+{
+    d->measureIDs.clear();
+    d->observations.clear();
+    d->columns.clear();
+    clearAttributeCache();
+}
+
+void StatisticalMeasureCube::materialise(StatisticalAnalyserBase *analyser)
+{
+    clear();
+    if (!analyser) return;
+    QStringList measureIDs, vectorMeasureIDs;
+    if (d->level == Communication) {
+        measureIDs = analyser->measureIDsForCommunication();
+        vectorMeasureIDs = analyser->vectorMeasureIDsForCommunication();
+    } else {
+        measureIDs = analyser->measureIDsForSpeaker();
+        vectorMeasureIDs = analyser->vectorMeasureIDsForSpeaker();
+    }
+    foreach (QString measureID, measureIDs) {
+        if (vectorMeasureIDs.contains(measureID)) continue;
+        d->measureIDs << measureID;
+        d->columns.insert(measureID, QVector<double>());
+    }
+    appendRows(analyser);
+}
+
+void StatisticalMeasureCube::appendRows(StatisticalAnalyserBase *analyser)
+{
+    if (d->level == Communication) {
+        QList<QMap<QString, double> > columns;
+        QMap<QString, bool> keys;
+        foreach (QString measureID, d->measureIDs) {
+            columns << analyser->measureValuesCom(measureID);
+            foreach (QString communicationID, columns.last().keys()) keys.insert(communicationID, true);
+        }
+        foreach (QString communicationID, keys.keys()) {
+            d->observations << QPair<QString, QString>(communicationID, QString());
+            for (int j = 0; j < d->measureIDs.count(); ++j)
+                d->columns[d->measureIDs.at(j)] << columns.at(j).value(communicationID, qQNaN());
+        }
+    } else {
+        QList<QMap<QPair<QString, QString>, double> > columns;
+        QMap<QPair<QString, QString>, bool> keys;
+        foreach (QString measureID, d->measureIDs) {
+            columns << analyser->measureValuesSpk(measureID);
+            foreach (const QPair<QString, QString> &key, columns.last().keys()) keys.insert(key, true);
+        }
+        foreach (const QPair<QString, QString> &key, keys.keys()) {
+            d->observations << key;
+            for (int j = 0; j < d->measureIDs.count(); ++j)
+                d->columns[d->measureIDs.at(j)] << columns.at(j).value(key, qQNaN());
+        }
+    }
+}
+
+// ====================================================================================================================
+// Grouping
+// ====================================================================================================================
+
+void StatisticalMeasureCube::clearAttributeCache()
+{
+    d->attributeColumns.clear();
+    d->groupings.clear();
+}
+
+const QVector<QString> &StatisticalMeasureCube::attributeColumn(Corpus *corpus, const QString &attributeID, bool speaker)
+{
+    QString key = QString(speaker ? "spk:" : "com:") + attributeID;
+    QHash<QString, QVector<QString> >::iterator cached = d->attributeColumns.find(key);
+    if (cached != d->attributeColumns.end()) return cached.value();
+    QVector<QString> values;
+    values.reserve(d->observations.count());
+    QHash<QString, QString> valueByID;
+    foreach (const QPair<QString, QString> &observation, d->observations) {
+        QString objectID = (speaker) ? observation.second : observation.first;
+        QHash<QString, QString>::const_iterator known = valueByID.constFind(objectID);
+        if (known != valueByID.constEnd()) {
+            values << known.value();
+            continue;
+        }
+        QString value;
+        if (corpus && speaker) {
+            QPointer<CorpusSpeaker> spk = corpus->speaker(objectID);
+            if (spk) value = spk->property(attributeID).toString();
+        } else if (corpus) {
+            CorpusCommunication *com = corpus->communication(objectID);
+            if (com) value = com->property(attributeID).toString();
+        }
+        valueByID.insert(objectID, value);
+        values << value;
+    }
+    return d->attributeColumns.insert(key, values).value();
+}
+
+QMap<QString, QList<double> > StatisticalMeasureCube::aggregate(
+        Corpus *corpus, const QString &measureID,
+        const QStringList &groupAttributeIDsCom, const QStringList &groupAttributeIDsSpk)
+{
+    QMap<QString, QList<double> > aggregates;
+    QHash<QString, QVector<double> >::const_iterator column = d->columns.constFind(measureID);
+    if (column == d->columns.constEnd()) return aggregates;
+    QStringList attributeIDsSpk = (d->level == Speaker) ? groupAttributeIDsSpk : QStringList();
+    QString groupingKey = groupAttributeIDsCom.join("\t") + "\n" + attributeIDsSpk.join("\t");
+    QHash<QString, Grouping>::iterator grouping = d->groupings.find(groupingKey);
+    if (grouping == d->groupings.end()) {
+        QList<const QVector<QString> *> attributes;
+        foreach (QString attributeID, groupAttributeIDsCom) attributes << &attributeColumn(corpus, attributeID, false);
+        int countCom = attributes.count();
+        foreach (QString attributeID, attributeIDsSpk) attributes << &attributeColumn(corpus, attributeID, true);
+        Grouping g;
+        g.groupOfRow.resize(d->observations.count());
+        QHash<QString, int> groupIndex;
+        for (int row = 0; row < d->observations.count(); ++row) {
+            // Same group IDs as the analysers' aggregateMeasure functions
+            QString id;
+            for (int i = 0; i < attributes.count(); ++i) {
+                id.append(attributes.at(i)->at(row));
+                if (i != countCom - 1 && i != attributes.count() - 1) id.append("::");
+            }
+            QHash<QString, int>::const_iterator index = groupIndex.constFind(id);
+            if (index == groupIndex.constEnd()) {
+                index = groupIndex.insert(id, g.groupIDs.count());
+                g.groupIDs << id;
+            }
+            g.groupOfRow[row] = index.value();
+        }
+        grouping = d->groupings.insert(groupingKey, g);
+    }
+    const Grouping &g = grouping.value();
+    QVector<QList<double> > groups(g.groupIDs.count());
+    const QVector<double> &values = column.value();
+    for (int row = 0; row < values.count(); ++row)
+        groups[g.groupOfRow.at(row)].append(values.at(row));
+    for (int i = 0; i < g.groupIDs.count(); ++i)
+        aggregates.insert(g.groupIDs.at(i), groups.at(i));
+    return aggregates;
+}
+
+StatisticalFeatureMatrix StatisticalMeasureCube::featureMatrix(const QStringList &measureIDs) const
+{
+    StatisticalFeatureMatrix matrix;
+    matrix.measureIDs = measureIDs;
+    QList<const QVector<double> *> columns;
+    foreach (QString measureID, measureIDs) {
+        QHash<QString, QVector<double> >::const_iterator column = d->columns.constFind(measureID);
+        columns << ((column != d->columns.constEnd()) ? &column.value() : nullptr);
+    }
+    // Means, to replace missing values
+    QVector<double> means(columns.count(), 0.0);
+    for (int j = 0; j < columns.count(); ++j) {
+        if (!columns.at(j)) continue;
+        double sum = 0.0; int n = 0;
+        foreach (double v, *columns.at(j)) {
+            if (!qIsNaN(v)) { sum += v; n++; }
+        }
+        means[j] = (n > 0) ? sum / n : 0.0;
+    }
+    // Observations without any value are left out
+    matrix.values.reserve(d->observations.count() * columns.count());
+    for (int row = 0; row < d->observations.count(); ++row) {
+        bool hasValue = false;
+        for (int j = 0; j < columns.count() && !hasValue; ++j)
+            hasValue = columns.at(j) && !qIsNaN(columns.at(j)->at(row));
+        if (!hasValue) continue;
+        matrix.observations << d->observations.at(row);
+        for (int j = 0; j < columns.count(); ++j) {
+            double v = (columns.at(j)) ? columns.at(j)->at(row) : qQNaN();
+            matrix.values << (qIsNaN(v) ? means.at(j) : v);
+        }
+    }
+    return matrix;
+}
@@ -0,0 +1,67 @@
+#ifndef STATISTICALMEASURECUBE_H
+#define STATISTICALMEASURECUBE_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QVector>
+
+#include "StatisticalMeasureAggregator.h"
+
+namespace Praaline {
+namespace Core {
+class Corpus;
+}
+}
+
+class StatisticalAnalyserBase;
+struct StatisticalMeasureCubeData;
+
+// Materialised scalar measures of an analyser, per communication or per speaker in each communication, stored
+// column by column. Grouping by metadata attributes is done in memory: attribute values are read from the corpus
+// once, and the group of each observation is cached per combination of attributes.
+class StatisticalMeasureCube
+{
+public:
+    enum Level {
+        Communication,
+        Speaker
+    };
+
+    StatisticalMeasureCube(Level level = Communication);
+    ~StatisticalMeasureCube();
+
+    Level level() const;
+    bool isEmpty() const;
+    QStringList measureIDs() const;
+    int observationCount() const;
+    // Communication ID and speaker ID (empty at the communication level)
+    QPair<QString, QString> observation(int row) const;
+    double value(int row, const QString &measureID) const;
+
+    // Computes the cube from the analyser's scalar measures
+    void materialise(StatisticalAnalyserBase *analyser);
+    void clear();
+
+    // Values of a measure grouped by the values of metadata attributes (joined with "::"), as the analysers'
+    // aggregateMeasure functions
+    QMap<QString, QList<double> > aggregate(Praaline::Core::Corpus *corpus, const QString &measureID,
+                                            const QStringList &groupAttributeIDsCom,
+                                            const QStringList &groupAttributeIDsSpk = QStringList());
+    // Metadata attribute values are cached: clear them when the metadata change
+    void clearAttributeCache();
+
+    StatisticalFeatureMatrix featureMatrix(const QStringList &measureIDs) const;
+
+private:
+    Q_DISABLE_COPY(StatisticalMeasureCube)
+    StatisticalMeasureCubeData *d;
+
+    void appendRows(StatisticalAnalyserBase *analyser);
+    const QVector<QString> &attributeColumn(Praaline::Core::Corpus *corpus, const QString &attributeID, bool speaker);
+};
+
+#endif // STATISTICALMEASURECUBE_H
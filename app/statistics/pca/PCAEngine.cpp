@@ -0,0 +1,445 @@
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <random>
+
+#include "PCAEngine.h"
+
+namespace Praaline {
+namespace Plugins {
+namespace StatisticsPluginPCA {
+
+struct PCAEngineData {
+    PCAEngineData() :
+        method(PCAEngine::Automatic), components(2), standardise(true), oversampling(10), powerIterations(2)
+    {}
+    PCAEngine::Method method;
+    int components;
+    bool standardise;
+    int oversampling;
+    int powerIterations;
+    // Cache of results, by measure set, data and options
+    QMutex mutex;
+    QHash<QString, PCAResult> cache;
+};
+
+PCAEngine::PCAEngine() :
+    d(new PCAEngineData)
+{
+}
+
+PCAEngine::~PCAEngine()
+{
+    delete d;
+}
+
+// ====================================================================================================================
+// Parameters
+// ====================================================================================================================
+
+PCAEngine::Method PCAEngine::method() const
+{
+    return d->method;
+}
+
+void PCAEngine::setMethod(Method method)
+{
+    d->method = method;
+}
+
+int PCAEngine::components() const
+{
+    return d->components;
+}
+
+void PCAEngine::setComponents(int components)
+{
+    d->components = qMax(1, components);
+}
+
+bool PCAEngine::standardise() const
+{
+    return d->standardise;
+}
+
+void PCAEngine::setStandardise(bool standardise)
+{
+    d->standardise = standardise;
+}
+
+int PCAEngine::oversampling() const
+{
+    return d->oversampling;
+}
+
+void PCAEngine::setOversampling(int oversampling)
+{
+    d->oversampling = qMax(0, oversampling);
+}
+
+int PCAEngine::powerIterations() const
+{
+    return d->powerIterations;
+}
+
+void PCAEngine::setPowerIterations(int iterations)
+{
+    d->powerIterations = qMax(0, iterations);
+}
+
+void PCAEngine::clearCache()
+{
+    QMutexLocker locker(&d->mutex);
+    d->cache.clear();
+}
+
+// ====================================================================================================================
+// Linear algebra on row-major dense matrices
+// ====================================================================================================================
+
+namespace {
+
+// A block of consecutive rows of the data matrix, processed by one thread. Steps that accumulate a sum over the
+// rows write it into the block's partial result, and the partial results are added up once all blocks are done.
+struct RowBlock
+{
+    int begin;
+    int end;
+    QVector<double> partial;
+};
+
+QVector<RowBlock> rowBlocks(int rows)
+{
+    int count = qBound(1, rows / 256, QThread::idealThreadCount() * 4);
+    QVector<RowBlock> blocks(count);
+    for (int b = 0; b < count; ++b) {
+        blocks[b].begin = static_cast<int>(static_cast<qint64>(rows) * b / count);
+        blocks[b].end = static_cast<int>(static_cast<qint64>(rows) * (b + 1) / count);
+    }
+    return blocks;
+}
+
+QVector<double> sumPartials(const QVector<RowBlock> &blocks, int size)
+{
+    QVector<double> sum(size, 0.0);
+    foreach (const RowBlock &block, blocks) {
+        for (int i = 0; i < size; ++i) sum[i] += block.partial.at(i);
+    }
+    return sum;
+}
+
+// Upper triangle of Z'Z (p x p), over a block of rows of Z (n x p)
+struct CrossProductStep
+{
+    const double *z;
+    int p;
+
+    CrossProductStep(const double *z, int p) : z(z), p(p) {}
+
+    void operator() (RowBlock &block)
+    {
+        block.partial.fill(0.0, p * p);
+        double *c = block.partial.data();
+        for (int i = block.begin; i < block.end; ++i) {
+            const double *row = z + static_cast<qint64>(i) * p;
+            for (int a = 0; a < p; ++a) {
+                double va = row[a];
+                if (va == 0.0) continue;
+                double *ca = c + a * p;
+                for (int b = a; b < p; ++b) ca[b] += va * row[b];
+            }
+        }
+    }
+};
+
+// Rows of Z M (n x l), for a block of rows of Z (n x p) and M (p x l); rows are written directly to the output
+struct ProjectStep
+{
+    const double *z;
+    const double *m;
+    double *out;
+    int p;
+    int l;
+
+    ProjectStep(const double *z, const double *m, double *out, int p, int l) : z(z), m(m), out(out), p(p), l(l) {}
+
+    void operator() (RowBlock &block)
+    {
+        for (int i = block.begin; i < block.end; ++i) {
+            const double *row = z + static_cast<qint64>(i) * p;
+            double *outRow = out + static_cast<qint64>(i) * l;
+            std::fill(outRow, outRow + l, 0.0);
+            for (int a = 0; a < p; ++a) {
+                double va = row[a];
+                if (va == 0.0) continue;
+                const double *mRow = m + a * l;
+                for (int j = 0; j < l; ++j) outRow[j] += va * mRow[j];
+            }
+        }
+    }
+};
+
+// Z'Q (p x l), over a block of rows of Z (n x p) and Q (n x l)
+struct TransposeProjectStep
+{
+    const double *z;
+    const double *q;
+    int p;
+    int l;
+
+    TransposeProjectStep(const double *z, const double *q, int p, int l) : z(z), q(q), p(p), l(l) {}
+
+    void operator() (RowBlock &block)
+    {
+        block.partial.fill(0.0, p * l);
+        double *w = block.partial.data();
+        for (int i = block.begin; i < block.end; ++i) {
+            const double *row = z + static_cast<qint64>(i) * p;
+            const double *qRow = q + static_cast<qint64>(i) * l;
+            for (int a = 0; a < p; ++a) {
+                double va = row[a];
+                if (va == 0.0) continue;
+                double *wRow = w + a * l;
+                for (int j = 0; j < l; ++j) wRow[j] += va * qRow[j];
+            }
+        }
+    }
+};
+
+QVector<double> multiply(const QVector<double> &z, int n, int p, const QVector<double> &m, int l)
+{
+    QVector<double> out(n * l, 0.0);
+    QVector<RowBlock> blocks = rowBlocks(n);
+    QtConcurrent::blockingMap(blocks, ProjectStep(z.constData(), m.constData(), out.data(), p, l));
+    return out;
+}
+
+QVector<double> multiplyTransposed(const QVector<double> &z, int n, int p, const QVector<double> &q, int l)
+{
+    QVector<RowBlock> blocks = rowBlocks(n);
+    QtConcurrent::blockingMap(blocks, TransposeProjectStep(z.constData(), q.constData(), p, l));
+    return sumPartials(blocks, p * l);
+}
+
+// Orthonormalise the columns of A (rows x cols) in place, by modified Gram-Schmidt. Columns that are (numerically)
+// linearly dependent on the previous ones are set to zero.
+void orthonormaliseColumns(QVector<double> &a, int rows, int cols)
+{
+    double *x = a.data();
+    for (int j = 0; j < cols; ++j) {
+        double norm0 = 0.0;
+        for (int i = 0; i < rows; ++i) norm0 += x[i * cols + j] * x[i * cols + j];
+        for (int k = 0; k < j; ++k) {
+            double dot = 0.0;
+            for (int i = 0; i < rows; ++i) dot += x[i * cols + k] * x[i * cols + j];
+            for (int i = 0; i < rows; ++i) x[i * cols + j] -= dot * x[i * cols + k];
+        }
+        double norm = 0.0;
+        for (int i = 0; i < rows; ++i) norm += x[i * cols + j] * x[i * cols + j];
+        if (norm <= 1.0e-20 * norm0 || norm == 0.0) {
+            for (int i = 0; i < rows; ++i) x[i * cols + j] = 0.0;
+            continue;
+        }
+        norm = qSqrt(norm);
+        for (int i = 0; i < rows; ++i) x[i * cols + j] /= norm;
+    }
+}
+
+// Eigenvalues and eigenvectors (as columns) of the symmetric matrix A (m x m), by cyclic Jacobi rotations.
+// Eigenvalues are sorted in decreasing order.
+void symmetricEigen(QVector<double> a, int m, QVector<double> &values, QVector<double> &vectors)
+{
+    QVector<double> v(m * m, 0.0);
+    for (int i = 0; i < m; ++i) v[i * m + i] = 1.0;
+    for (int sweep = 0; sweep < 100; ++sweep) {
+        double off = 0.0, diagonal = 0.0;
+        for (int p = 0; p < m; ++p) {
+            diagonal += a[p * m + p] * a[p * m + p];
+            for (int q = p + 1; q < m; ++q) off += a[p * m + q] * a[p * m + q];
+        }
+        if (off == 0.0 || off <= 1.0e-30 * diagonal) break;
+        for (int p = 0; p < m - 1; ++p) {
+            for (int q = p + 1; q < m; ++q) {
+                double apq = a[p * m + q];
+                if (apq == 0.0) continue;
+                double theta = (a[q * m + q] - a[p * m + p]) / (2.0 * apq);
+                double t = 1.0 / (qAbs(theta) + qSqrt(theta * theta + 1.0));
+                if (theta < 0.0) t = -t;
+                double c = 1.0 / qSqrt(t * t + 1.0);
+                double s = t * c;
+                for (int k = 0; k < m; ++k) {
+                    double akp = a[k * m + p], akq = a[k * m + q];
+                    a[k * m + p] = c * akp - s * akq;
+                    a[k * m + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < m; ++k) {
+                    double apk = a[p * m + k], aqk = a[q * m + k];
+                    a[p * m + k] = c * apk - s * aqk;
+                    a[q * m + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < m; ++k) {
+                    double vkp = v[k * m + p], vkq = v[k * m + q];
+                    v[k * m + p] = c * vkp - s * vkq;
+                    v[k * m + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    QVector<int> order(m);
+    for (int i = 0; i < m; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&a, m](int i, int j) { return a[i * m + i] > a[j * m + j]; });
+    values.resize(m);
+    vectors.resize(m * m);
+    for (int j = 0; j < m; ++j) {
+        values[j] = a[order[j] * m + order[j]];
+        for (int i = 0; i < m; ++i) vectors[i * m + j] = v[i * m + order[j]];
+    }
+}
+
+QString cacheKey(const StatisticalFeatureMatrix &matrix, int method, int components, bool standardise,
+                 int oversampling, int powerIterations)
+{
+    uint h = qHashBits(matrix.values.constData(), static_cast<size_t>(matrix.values.count()) * sizeof(double));
+    for (int i = 0; i < matrix.observations.count(); ++i)
+        h = h * 31 + qHash(matrix.observations.at(i));
+    return QString("%1|%2|%3|%4|%5|%6|%7|%8").arg(method).arg(components).arg(standardise).arg(oversampling)
+            .arg(powerIterations).arg(matrix.rowCount()).arg(h).arg(matrix.measureIDs.join("|"));
+}
+
+} // namespace
+
+// ====================================================================================================================
+// Analysis
+// ====================================================================================================================
+
+PCAResult PCAEngine::compute(const StatisticalFeatureMatrix &matrix)
+{
+    int n = matrix.rowCount();
+    int p = matrix.columnCount();
+    if (n < 2 || p < 1 || matrix.values.count() != n * p) return PCAResult();
+    QString key = cacheKey(matrix, d->method, d->components, d->standardise, d->oversampling, d->powerIterations);
+    {
+        QMutexLocker locker(&d->mutex);
+        if (d->cache.contains(key)) return d->cache.value(key);
+    }
+
+    PCAResult result;
+    result.variableIDs = matrix.measureIDs;
+    result.observations = matrix.observations;
+
+    // Centre, and scale to unit variance. Constant variables are only centred.
+    QVector<double> z = matrix.values;
+    result.means.fill(0.0, p);
+    result.standardDeviations.fill(0.0, p);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < p; ++j) result.means[j] += z.at(i * p + j);
+    for (int j = 0; j < p; ++j) result.means[j] /= n;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < p; ++j) {
+            z[i * p + j] -= result.means.at(j);
+            result.standardDeviations[j] += z.at(i * p + j) * z.at(i * p + j);
+        }
+    }
+    result.totalVariance = 0.0;
+    for (int j = 0; j < p; ++j) {
+        result.standardDeviations[j] = qSqrt(result.standardDeviations.at(j) / (n - 1));
+        if (d->standardise && result.standardDeviations.at(j) > 0.0)
+            result.totalVariance += 1.0;
+        else
+            result.totalVariance += result.standardDeviations.at(j) * result.standardDeviations.at(j);
+    }
+    if (d->standardise) {
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < p; ++j)
+                if (result.standardDeviations.at(j) > 0.0) z[i * p + j] /= result.standardDeviations.at(j);
+    }
+
+    int k = qMin(d->components, qMin(n, p));
+    Method method = d->method;
+    if (method == Automatic) method = (p <= covarianceVariablesLimit) ? Covariance : Randomised;
+    int l = qMin(k + d->oversampling, qMin(n, p));
+    if (method == Randomised && l >= p) method = Covariance;
+
+    QVector<double> loadings(p * k, 0.0);
+    result.explainedVariance.fill(0.0, k);
+    if (method == Covariance) {
+        // Covariance matrix, accumulated over blocks of observations in parallel
+        QVector<RowBlock> blocks = rowBlocks(n);
+        QtConcurrent::blockingMap(blocks, CrossProductStep(z.constData(), p));
+        QVector<double> covariance = sumPartials(blocks, p * p);
+        for (int a = 0; a < p; ++a) {
+            for (int b = a; b < p; ++b) {
+                covariance[a * p + b] /= (n - 1);
+                covariance[b * p + a] = covariance.at(a * p + b);
+            }
+        }
+        QVector<double> values, vectors;
+        symmetricEigen(covariance, p, values, vectors);
+        for (int c = 0; c < k; ++c) {
+            result.explainedVariance[c] = qMax(0.0, values.at(c));
+            for (int a = 0; a < p; ++a) loadings[a * k + c] = vectors.at(a * p + c);
+        }
+    }
+    else {
+        // Randomised range finder: orthonormal basis Q (n x l) of Z Omega, refined by power iterations
+        std::mt19937 generator(20110617);
+        std::normal_distribution<double> gaussian(0.0, 1.0);
+        QVector<double> omega(p * l);
+        for (int i = 0; i < omega.count(); ++i) omega[i] = gaussian(generator);
+        QVector<double> q = multiply(z, n, p, omega, l);
+        orthonormaliseColumns(q, n, l);
+        for (int iteration = 0; iteration < d->powerIterations; ++iteration) {
+            QVector<double> w = multiplyTransposed(z, n, p, q, l);
+            orthonormaliseColumns(w, p, l);
+            q = multiply(z, n, p, w, l);
+            orthonormaliseColumns(q, n, l);
+        }
+        // B' = Z'Q (p x l); the eigenvectors U of BB' (l x l) give the right singular vectors V = B'U / s
+        QVector<double> bt = multiplyTransposed(z, n, p, q, l);
+        QVector<double> gram(l * l, 0.0);
+        for (int a = 0; a < p; ++a)
+            for (int i = 0; i < l; ++i)
+                for (int j = i; j < l; ++j) gram[i * l + j] += bt.at(a * l + i) * bt.at(a * l + j);
+        for (int i = 0; i < l; ++i)
+            for (int j = i + 1; j < l; ++j) gram[j * l + i] = gram.at(i * l + j);
+        QVector<double> values, vectors;
+        symmetricEigen(gram, l, values, vectors);
+        for (int c = 0; c < k; ++c) {
+            if (values.at(c) <= 0.0) continue;
+            double s = qSqrt(values.at(c));
+            result.explainedVariance[c] = values.at(c) / (n - 1);
+            for (int a = 0; a < p; ++a) {
+                double sum = 0.0;
+                for (int i = 0; i < l; ++i) sum += bt.at(a * l + i) * vectors.at(i * l + c);
+                loadings[a * k + c] = sum / s;
+            }
+        }
+    }
+
+    // Signs are arbitrary: make the largest loading of each component positive, so that results are reproducible
+    for (int c = 0; c < k; ++c) {
+        int largest = 0;
+        for (int a = 1; a < p; ++a)
+            if (qAbs(loadings.at(a * k + c)) > qAbs(loadings.at(largest * k + c))) largest = a;
+        if (loadings.at(largest * k + c) < 0.0)
+            for (int a = 0; a < p; ++a) loadings[a * k + c] = -loadings.at(a * k + c);
+    }
+    result.components = k;
+    result.loadings = loadings;
+    result.scores = multiply(z, n, p, loadings, k);
+
+    QMutexLocker locker(&d->mutex);
+    if (d->cache.count() >= 16) d->cache.clear();
+    d->cache.insert(key, result);
+    return result;
+}
+
+} // namespace StatisticsPluginPCA
+} // namespace Plugins
+} // namespace Praaline
@@ -0,0 +1,88 @@
+#ifndef PRAALINE_PLUGINS_STATISTICSPLUGINPCA_PCAENGINE_H
+#define PRAALINE_PLUGINS_STATISTICSPLUGINPCA_PCAENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include "statistics/StatisticalMeasureAggregator.h"
+
+namespace Praaline {
+namespace Plugins {
+namespace StatisticsPluginPCA {
+
+struct PCAResult
+{
+    PCAResult() : components(0), totalVariance(0.0) {}
+
+    QStringList variableIDs;
+    QList<QPair<QString, QString> > observations;
+    int components;
+    // Scores: one row per observation, one column per component
+    QVector<double> scores;
+    // Loadings (unit eigenvectors): one row per variable, one column per component
+    QVector<double> loadings;
+    // Variance explained by each component, and total variance of the (standardised) data
+    QVector<double> explainedVariance;
+    double totalVariance;
+    // Parameters used to centre and scale each variable
+    QVector<double> means;
+    QVector<double> standardDeviations;
+
+    bool isValid() const { return components > 0; }
+    double score(int observation, int component) const { return scores.at(observation * components + component); }
+    double loading(int variable, int component) const { return loadings.at(variable * components + component); }
+    double explainedVarianceRatio(int component) const
+    {
+        return (totalVariance > 0.0) ? explainedVariance.at(component) / totalVariance : 0.0;
+    }
+};
+
+struct PCAEngineData;
+
+// Principal component analysis of a feature matrix (observations x measures).
+// With few variables, the covariance matrix is accumulated over blocks of observations in parallel and
+// diagonalised with the Jacobi method. With many variables, randomised PCA (Halko, Martinsson & Tropp 2011)
+// finds the leading components from a few parallel passes over the data. Results are cached, so that the same
+// measure set over the same data is only analysed once.
+class PCAEngine
+{
+public:
+    enum Method {
+        Automatic,
+        Covariance,
+        Randomised
+    };
+
+    PCAEngine();
+    ~PCAEngine();
+
+    Method method() const;
+    void setMethod(Method method);
+    int components() const;
+    void setComponents(int components);
+    bool standardise() const;
+    void setStandardise(bool standardise);
+    // Randomised PCA: extra dimensions in the random projection, and number of power iterations
+    int oversampling() const;
+    void setOversampling(int oversampling);
+    int powerIterations() const;
+    void setPowerIterations(int iterations);
+
+    PCAResult compute(const StatisticalFeatureMatrix &matrix);
+    void clearCache();
+
+    // Automatic method: above this number of variables, use randomised PCA
+    static const int covarianceVariablesLimit = 300;
+
+private:
+    PCAEngineData *d;
+};
+
+} // namespace StatisticsPluginPCA
+} // namespace Plugins
+} // namespace Praaline
+
+#endif // PRAALINE_PLUGINS_STATISTICSPLUGINPCA_PCAENGINE_H
@@ -1,5 +1,6 @@
 #include <QDebug>
 #include <QMessageBox>
+#include <QHash>
 #include <math.h>
 
 #include "PCAPlotWidget.h"
@@ -21,17 +22,41 @@ using namespace Praaline::Core;
 #include "qcustomplot.h"
 #include "pngui/widgets/GridViewWidget.h"
 
+#include "statistics/StatisticalMeasureAggregator.h"
+#include "statistics/temporal/AnalyserTemporal.h"
+using namespace Praaline::Plugins::StatisticsPluginTemporal;
+#include "PCAEngine.h"
+
 namespace Praaline {
 namespace Plugins {
 namespace StatisticsPluginPCA {
 
+// A point on the plot: a communication, or a speaker in a communication
+struct PCAPlotPoint {
+    PCAPlotPoint() : com(nullptr), x(0.0), y(0.0) {}
+    CorpusCommunication *com;
+    QString speakerID;
+    double x;
+    double y;
+};
+
 struct PCAPlotWidgetData {
     PCAPlotWidgetData() :
-        repository(0)
+        repository(0), plot(nullptr), analyser(nullptr)
     {}
     CorpusRepository *repository;
     QCustomPlot *plot;
-    QMap<QString, QList<CorpusCommunication *> > communications;
+    QMap<QString, QList<PCAPlotPoint> > points;
+    // Principal components computed from temporal measures
+    AnalyserTemporal *analyser;
+    QString analysedCorpusID;
+    PCAEngine engine;
+};
+
+enum PCACoordinates {
+    CoordinatesImported = 0,
+    CoordinatesTemporalCom = 1,
+    CoordinatesTemporalSpk = 2
 };
 
 PCAPlotWidget::PCAPlotWidget(CorpusRepository *repository, QWidget *parent) :
@@ -43,6 +68,11 @@ PCAPlotWidget::PCAPlotWidget(CorpusRepository *repository, QWidget *parent) :
 
     ui->splitter->setSizes(QList<int>() << 400 << 100);
 
+    // Coordinates: imported from metadata (PCA_dim1, PCA_dim2), or computed from the temporal measures
+    ui->comboBoxCoordinates->addItem(tr("Imported (PCA_dim1, PCA_dim2)"), CoordinatesImported);
+    ui->comboBoxCoordinates->addItem(tr("Temporal measures, per communication"), CoordinatesTemporalCom);
+    ui->comboBoxCoordinates->addItem(tr("Temporal measures, per speaker"), CoordinatesTemporalSpk);
+
     // List of metadata attributes for Communication
     foreach (MetadataStructureAttribute *attr, repository->metadataStructure()->attributes(CorpusObject::Type_Communication)) {
         ui->comboBoxClassificationAttribute->addItem(attr->name(), attr->ID());
@@ -54,6 +84,7 @@ PCAPlotWidget::PCAPlotWidget(CorpusRepository *repository, QWidget *parent) :
     connect(ui->comboBoxFilterAttribute, qOverload<int>(&QComboBox::currentIndexChanged), this, &PCAPlotWidget::filterAttributeChanged);
     connect(ui->listFilterAttributeValues, &QListWidget::currentTextChanged, this, &PCAPlotWidget::replot);
     connect(ui->comboBoxClassificationAttribute, qOverload<int>(&QComboBox::currentIndexChanged), this, &PCAPlotWidget::replot);
+    connect(ui->comboBoxCoordinates, qOverload<int>(&QComboBox::currentIndexChanged), this, &PCAPlotWidget::replot);
 
     // Set up plot
     d->plot = new QCustomPlot(this);
@@ -72,6 +103,7 @@ PCAPlotWidget::PCAPlotWidget(CorpusRepository *repository, QWidget *parent) :
 PCAPlotWidget::~PCAPlotWidget()
 {
     delete ui;
+    delete d;
 }
 
 void PCAPlotWidget::filterAttributeChanged(int indexFilterAttribute)
@@ -105,18 +137,54 @@ void PCAPlotWidget::replot()
     if (!ui->listFilterAttributeValues->currentItem()) return;
     QString filterAttributeValue = ui->listFilterAttributeValues->currentItem()->text();
 
+    // Compute principal components, if requested
+    int coordinates = ui->comboBoxCoordinates->currentData().toInt();
+    PCAResult pca;
+    QHash<QString, QList<int> > observationsByCom;
+    if (coordinates != CoordinatesImported) {
+        // The temporal analysis of the corpus is run once, and the PCA engine caches its results per measure set
+        if (!d->analyser) d->analyser = new AnalyserTemporal(this);
+        if (d->analysedCorpusID != corpus->ID()) {
+            d->analyser->setCorpus(corpus);
+            d->analyser->analyse();
+            d->analysedCorpusID = corpus->ID();
+        }
+        StatisticalMeasureAggregator aggregator(d->analyser);
+        if (coordinates == CoordinatesTemporalSpk)
+            pca = d->engine.compute(aggregator.featureMatrixSpk(d->analyser->measureIDsForSpeaker()));
+        else
+            pca = d->engine.compute(aggregator.featureMatrixCom(d->analyser->measureIDsForCommunication()));
+        if (!pca.isValid()) return;
+        for (int i = 0; i < pca.observations.count(); ++i) {
+            observationsByCom[pca.observations.at(i).first] << i;
+        }
+    }
+
     // Select communications and classify them
-    d->communications.clear();
+    d->points.clear();
     foreach (CorpusCommunication *com, corpus->communications()) {
         if (!com) continue;
         // Filter
         if (com->property(filterAttributeID).toString() != filterAttributeValue ) continue;
         // Classify
         QString comClass = com->property(classificationAttributeID).toString();
-        if (!d->communications.contains(comClass)) {
-            d->communications.insert(comClass, QList<CorpusCommunication *>());
+        if (coordinates == CoordinatesImported) {
+            PCAPlotPoint point;
+            point.com = com;
+            point.x = com->property("PCA_dim1").toDouble();
+            point.y = com->property("PCA_dim2").toDouble();
+            d->points[comClass] << point;
+        }
+        else {
+            foreach (int i, observationsByCom.value(com->ID())) {
+                PCAPlotPoint point;
+                point.com = com;
+                point.speakerID = pca.observations.at(i).second;
+                point.x = pca.score(i, 0);
+                point.y = (pca.components > 1) ? pca.score(i, 1) : 0.0;
+                d->points[comClass] << point;
+            }
         }
-        d->communications[comClass] << com;
     }
 
     // Create a graph for each class
@@ -129,13 +197,13 @@ void PCAPlotWidget::replot()
            << QCPScatterStyle::ssCrossSquare << QCPScatterStyle::ssPlusSquare << QCPScatterStyle::ssCrossCircle << QCPScatterStyle::ssPlusCircle;
     ColourDatabase *cdb = ColourDatabase::getInstance();
     d->plot->clearGraphs();
-    foreach (QString comClass, d->communications.keys()) {
-        QList<CorpusCommunication *> communications = d->communications[comClass];
+    foreach (QString comClass, d->points.keys()) {
+        QList<PCAPlotPoint> points = d->points[comClass];
         // Generate data points
-        QVector<double> x(communications.count()), y(communications.count());
-        for (int i = 0; i < communications.count(); ++i) {
-            x[i] = communications.at(i)->property("PCA_dim1").toDouble();
-            y[i] = communications.at(i)->property("PCA_dim2").toDouble();
+        QVector<double> x(points.count()), y(points.count());
+        for (int i = 0; i < points.count(); ++i) {
+            x[i] = points.at(i).x;
+            y[i] = points.at(i).y;
         }
         // Create graph and assign data to it
         if (d->plot->graphCount() < indexClass + 1) {
@@ -150,8 +218,16 @@ void PCAPlotWidget::replot()
         indexClass++;
     }
     // Axis labels
-    d->plot->xAxis->setLabel("PCA Dimension 1");
-    d->plot->yAxis->setLabel("PCA Dimension 2");
+    if (pca.isValid()) {
+        d->plot->xAxis->setLabel(QString("PCA Dimension 1 (%1%)").arg(pca.explainedVarianceRatio(0) * 100.0, 0, 'f', 1));
+        if (pca.components > 1)
+            d->plot->yAxis->setLabel(QString("PCA Dimension 2 (%1%)").arg(pca.explainedVarianceRatio(1) * 100.0, 0, 'f', 1));
+        else
+            d->plot->yAxis->setLabel("");
+    } else {
+        d->plot->xAxis->setLabel("PCA Dimension 1");
+        d->plot->yAxis->setLabel("PCA Dimension 2");
+    }
     // Set axes so that all data is visible, with a little margin
     d->plot->rescaleAxes(true);
     d->plot->xAxis->setRange(d->plot->xAxis->range().lower - 1.0, d->plot->xAxis->range().upper + 1.0);
@@ -164,12 +240,15 @@ void PCAPlotWidget::replot()
 
 void PCAPlotWidget::plotItemClick(QCPAbstractPlottable *plottable, int index, QMouseEvent *event)
 {
-    QList<CorpusCommunication *> communications = d->communications.value(plottable->name());
+    QList<PCAPlotPoint> points = d->points.value(plottable->name());
     if (index < 0) return;
-    if (index >= communications.count()) return;
-    CorpusCommunication *com = communications.at(index);
+    if (index >= points.count()) return;
+    CorpusCommunication *com = points.at(index).com;
     if (!com) return;
     QList<QTreeWidgetItem *> items;
+    if (!points.at(index).speakerID.isEmpty()) {
+        items.append(new QTreeWidgetItem((QTreeWidget*)0, QStringList() << tr("Speaker ID") << points.at(index).speakerID));
+    }
     foreach (MetadataStructureAttribute *attr, d->repository->metadataStructure()->attributes(CorpusObject::Type_Communication)) {
         QString attributeValue = com->property(attr->ID()).toString();
         items.append(new QTreeWidgetItem((QTreeWidget*)0, QStringList() << attr->name() << attributeValue));
@@ -237,6 +237,34 @@ QMap<QString, QList<double> > AnalyserTemporal::aggregateMeasureSpk(
     return aggregates;
 }
 
+QMap<QString, double> AnalyserTemporal::measureValuesCom(const QString &measureID)
+{
+    QMap<QString, double> values;
+    if (!d->corpus) return values;
+    foreach (CorpusCommunication *com, d->corpus->communications()) {
+        if (!com) continue;
+        AnalyserTemporalItem *theItem = item(com->ID());
+        if (!theItem) continue;
+        values.insert(com->ID(), theItem->measureCom(measureID));
+    }
+    return values;
+}
+
+QMap<QPair<QString, QString>, double> AnalyserTemporal::measureValuesSpk(const QString &measureID)
+{
+    QMap<QPair<QString, QString>, double> values;
+    if (!d->corpus) return values;
+    foreach (CorpusCommunication *com, d->corpus->communications()) {
+        if (!com) continue;
+        AnalyserTemporalItem *theItem = item(com->ID());
+        if (!theItem) continue;
+        foreach (QString speakerID, theItem->speakerIDs()) {
+            values.insert(QPair<QString, QString>(com->ID(), speakerID), theItem->measureSpk(speakerID, measureID));
+        }
+    }
+    return values;
+}
+
 QStringList AnalyserTemporal::measureIDsForCommunication()
 {
     return AnalyserTemporalItem::measureIDsForCommunication();
@@ -27,7 +27,7 @@ public:
     explicit AnalyserTemporal(QObject *parent = nullptr);
     ~AnalyserTemporal();
 
-    Praaline::Core::Corpus *corpus() const;
+    Praaline::Core::Corpus *corpus() const override;
     void setCorpus(Praaline::Core::Corpus *corpus);
 
     QString levelIDSyllables() const;
@@ -42,6 +42,8 @@ public:
             const QString &measureID, const QStringList &groupAttributeIDsCom) override;
     QMap<QString, QList<double> > aggregateMeasureSpk(
             const QString &measureID, const QStringList &groupAttributeIDsCom, const QStringList &groupAttributeIDsSpk) override;
+    QMap<QString, double> measureValuesCom(const QString &measureID) override;
+    QMap<QPair<QString, QString>, double> measureValuesSpk(const QString &measureID) override;
 
     QStringList measureIDsForCommunication() override;
     QStringList measureIDsForSpeaker() override;
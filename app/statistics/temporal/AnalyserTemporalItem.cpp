@@ -21,6 +21,9 @@ using namespace Praaline::Core;
 
 #include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
 
+#include "svcore/base/Trace.h"
+#include "pnlib/annotation/IntervalTierCursor.h"
+
 #include "AnalyserTemporalItem.h"
 
 struct AnalyserTemporalItemData {
@@ -224,6 +227,7 @@ void AnalyserTemporalItem::analyse(CorpusCommunication *com)
     if (!com) return;
     if (!com->repository()) return;
 
+    TraceSpan span("statistics", "temporal analysis");
     qDebug() << "Analysing temporal variables for " << com->ID();
 
     d->measuresCom.clear();
@@ -296,6 +300,9 @@ void AnalyserTemporalItem::analyse(CorpusCommunication *com)
         SpeakerAnnotationTierGroupMap tiersAll =
                 com->repository()->annotations()->getTiersAllSpeakers(annotationID, QStringList() << d->levelSyllables << d->levelTokens);
         mutex.unlock();
+        foreach (AnnotationTierGroup *tiers, tiersAll) {
+            if (tiers) TraceCounter::tiersLoaded().add(tiers->tiersCount());
+        }
         foreach (QString speakerID, tiersAll.keys()) {
             AnnotationTierGroup *tiers = tiersAll.value(speakerID);
             if (!tiers) continue;
@@ -316,6 +323,9 @@ void AnalyserTemporalItem::analyse(CorpusCommunication *com)
                 if (intv->text().contains(speakerID)) intv->setText(speakerID); else intv->setText("");
             }
             tier_turns->mergeIdenticalAnnotations();
+            // Turns and syllables are visited in time order: the cursors walk the lower tiers once
+            IntervalTierCursor cursorTokensInTurn(tier_tokmin), cursorSyllsInTurn(tier_syll);
+            IntervalTierCursor cursorTokensInSyll(tier_tokmin), cursorTimelineInSyll(tier_timelineSyll);
             foreach (Interval *turn, tier_turns->intervals()) {
                 if (!turn->text().contains(speakerID)) continue;
                 // qDebug() << com->ID() << speakerID;
@@ -323,7 +333,7 @@ void AnalyserTemporalItem::analyse(CorpusCommunication *com)
                 timeSpeech = timeSpeech + turn->duration();
                 // Count non-pause, non-filled pause tokens in the turn
                 int currentTurnTokenCount(0), currentTurnArtSyllCount(0);
-                foreach (Interval *token, tier_tokmin->getIntervalsContainedIn(turn)) {
+                foreach (Interval *token, cursorTokensInTurn.containedIn(turn)) {
                     if ((!token->isPauseSilent()) && (!d->filledPauseTokens.contains(token->text()))) {
                         numTokens++;
                         currentTurnTokenCount++;
@@ -331,24 +341,25 @@ void AnalyserTemporalItem::analyse(CorpusCommunication *com)
                 }
                 turnTokenCounts << static_cast<double>(currentTurnTokenCount);
                 // The basic units of time measurement are the speaker's syllables
-                int syllIndex(0);
-                foreach (Interval *syll, tier_syll->getIntervalsContainedIn(turn)) {
+                IntervalSpan sylls = cursorSyllsInTurn.containedIn(turn);
+                for (int syllIndex = sylls.firstIndex(); syllIndex <= sylls.lastIndex(); ++syllIndex) {
+                    Interval *syll = tier_syll->at(syllIndex);
                     QString syllCategory = ""; // SIL, FIL or ART?
-                    QList<Interval *> tokens = tier_tokmin->getIntervalsOverlappingWith(syll);
+                    IntervalSpan tokens = cursorTokensInSyll.overlappingWith(syll);
                     // foreach (Interval *token, tokens) qDebug() << token->text();
                     if (tokens.count() == 1 && d->filledPauseTokens.contains(tokens.first()->text())) {
                         syllCategory = "FIL"; // This syllable is a filled pause
                     }
-                    // Inter-Syllabic Interval (ISI)
+                    // Inter-Syllabic Interval (ISI), within the turn only
                     QString syllText = tier_syll->at(syllIndex)->text();
-                    QString syllTextPrev = (syllIndex > 0) ? tier_syll->at(syllIndex - 1)->text() : "";
-                    if ((syllIndex > 0) && (!tier_syll->at(syllIndex - 1)->isPauseSilent()) &&
+                    QString syllTextPrev = (syllIndex > sylls.firstIndex()) ? tier_syll->at(syllIndex - 1)->text() : "";
+                    if ((syllIndex > sylls.firstIndex()) && (!tier_syll->at(syllIndex - 1)->isPauseSilent()) &&
                         (!excludedSyllTextForISI.contains(syllText)) && (!excludedSyllTextForISI.contains(syllTextPrev))) {
                         double dur = (syll->tCenter() - tier_syll->at(syllIndex - 1)->tCenter()).toDouble();
                         intersyllabicIntervals << dur;
                     }
                     // Process sub-syllabic segments on the timeline
-                    foreach (Interval *intv, tier_timelineSyll->getIntervalsContainedIn(syll)) {
+                    foreach (Interval *intv, cursorTimelineInSyll.containedIn(syll)) {
                         QString temporal = intv->attribute("temporal").toString();
                         if (intv->text().contains(speakerID)) {
                             if (syllCategory == "FIL") { // Filled pause
@@ -379,7 +390,6 @@ void AnalyserTemporalItem::analyse(CorpusCommunication *com)
                     if      (syllCategory == "SIL") { numSilentPauses++; }
                     else if (syllCategory == "FIL") { numFilledPauses++; }
                     else if (syllCategory == "ART") { numSyllablesArticulated++; currentTurnArtSyllCount++; }
-                    syllIndex++;
                 } // end foreach syll
                 turnArtSyllCounts << static_cast<double>(currentTurnArtSyllCount);
             } // end foreach turn
@@ -179,6 +179,7 @@ void AnalyserTemporalWidget::analyse()
     d->analyser->setLevelIDTokens(ui->comboBoxLevelTokens->currentText());
     d->analyser->analyse();
     ui->progressBar->setValue(ui->progressBar->maximum());
+    d->chartsWidget->measuresChanged();
 
     changeDisplayedModel();
 }
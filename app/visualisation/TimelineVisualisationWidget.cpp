@@ -112,6 +112,8 @@ TimelineVisualisationWidget::TimelineVisualisationWidget(QWidget *parent) :
             this, &TimelineVisualisationWidget::visualiserUserScrolledToTime);
     connect(d->visualiser, &SimpleVisualiserWidget::playbackScrolledToTime,
             this, &TimelineVisualisationWidget::visualiserPlaybackScrolledToTime);
+    connect(d->visualiser, &VisualiserWidget::annotationTiersChanged,
+            d->annotationEditor, &AnnotationMultiTierEditorWidget::tiersChanged);
 
     // Waiting spinner
     d->waitingSpinner = new WaitingSpinnerWidget(this);
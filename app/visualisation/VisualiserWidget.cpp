@@ -3380,6 +3380,7 @@ void VisualiserWidget::addAnnotationPane(QVariantHash parameters)
     foreach (pair, m_annotationSelection) if (pair.first != "tapping") annotationAttributes << pair;
 
     AnnotationGridModel *model = new AnnotationGridModel(getMainModel()->getSampleRate(), m_tiers, annotationAttributes);
+    connect(model, &AnnotationGridModel::tiersChanged, this, &VisualiserWidget::annotationTiersChanged);
     // Excluded speakers
     QStringList excluded;
     if (parameters.contains("excludedSpeakers")) excluded = parameters.value("excludedSpeakers").toStringList();
@@ -45,6 +45,7 @@ public:
 signals:
     void canChangeSolo(bool);
     void canAlign(bool);
+    void annotationTiersChanged();
 
 public slots:
     virtual bool commitData(bool mayAskUser);
@@ -0,0 +1,305 @@
+#include <QDir>
+#include <QPointer>
+
+#include "PraalineCore/Base/RealTime.h"
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineCore/Annotation/AnnotationTierGroup.h"
+#include "PraalineCore/Datastore/CorpusRepository.h"
+#include "PraalineCore/Datastore/AnnotationDatastore.h"
+#include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
+using namespace Praaline::Core;
+
+#include "pnlib/annotation/IntervalTierCursor.h"
+
+#include "SyntheticCorpus.h"
+#include "Benchmark.h"
+#include "BenchmarkGroups.h"
+
+namespace {
+
+// Prevents the compiler from discarding the results of the benchmarked calls
+volatile qint64 benchmarkSink = 0;
+
+int countIntervals(AnnotationTierGroup *group)
+{
+    int count = 0;
+    foreach (QString name, group->tierNames()) {
+        IntervalTier *tier = group->getIntervalTierByName(name);
+        if (tier) count += tier->count();
+    }
+    return count;
+}
+
+// ==============================================================================================================
+// Praat TextGrids
+// ==============================================================================================================
+
+class TextGridLoadBenchmark : public Benchmark
+{
+public:
+    TextGridLoadBenchmark() : Benchmark("textgrid", "load"), m_intervals(0) {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        if (!corpus->createTextGrids(error)) return false;
+        m_filenames.clear();
+        m_intervals = 0;
+        foreach (QString communicationID, corpus->communicationIDs()) {
+            foreach (QString speakerID, corpus->speakerIDs(communicationID)) {
+                m_filenames << corpus->textGridFilename(communicationID, speakerID);
+            }
+        }
+        foreach (QString filename, m_filenames) {
+            AnnotationTierGroup group;
+            if (!PraatTextGrid::load(filename, &group)) {
+                error = QString("Could not read %1").arg(filename);
+                return false;
+            }
+            m_intervals += countIntervals(&group);
+        }
+        return true;
+    }
+    void run() override {
+        foreach (QString filename, m_filenames) {
+            AnnotationTierGroup *group = new AnnotationTierGroup();
+            PraatTextGrid::load(filename, group);
+            benchmarkSink += group->tiersCount();
+            delete group;
+        }
+    }
+    qint64 itemsPerIteration() const override { return m_intervals; }
+    QString itemsUnit() const override { return "intervals"; }
+
+private:
+    QStringList m_filenames;
+    qint64 m_intervals;
+};
+
+class TextGridSaveBenchmark : public Benchmark
+{
+public:
+    TextGridSaveBenchmark() : Benchmark("textgrid", "save"), m_intervals(0) {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        m_outputPath = corpus->basePath() + "/textgrid-save";
+        if (!QDir().mkpath(m_outputPath)) {
+            error = QString("Could not create %1").arg(m_outputPath);
+            return false;
+        }
+        m_intervals = 0;
+        foreach (QString communicationID, corpus->communicationIDs()) {
+            QList<QPair<QString, AnnotationTierGroup *> > tiersAll = corpus->annotation(communicationID);
+            for (int i = 0; i < tiersAll.count(); ++i) {
+                m_groups << tiersAll.at(i);
+                m_intervals += countIntervals(tiersAll.at(i).second);
+            }
+        }
+        return true;
+    }
+    void run() override {
+        for (int i = 0; i < m_groups.count(); ++i) {
+            PraatTextGrid::save(m_outputPath + "/" + m_groups.at(i).first + ".TextGrid", m_groups.at(i).second);
+        }
+    }
+    void tearDown() override {
+        for (int i = 0; i < m_groups.count(); ++i) delete m_groups.at(i).second;
+        m_groups.clear();
+        QDir(m_outputPath).removeRecursively();
+    }
+    qint64 itemsPerIteration() const override { return m_intervals; }
+    QString itemsUnit() const override { return "intervals"; }
+
+private:
+    QString m_outputPath;
+    QList<QPair<QString, AnnotationTierGroup *> > m_groups;
+    qint64 m_intervals;
+};
+
+// ==============================================================================================================
+// Interval tier queries
+// ==============================================================================================================
+
+// Queries over the phone and syllable tiers of every speaker, with windows of 0.5 to 5 seconds at positions
+// drawn from the corpus seed
+class TierQueryBenchmark : public Benchmark
+{
+public:
+    enum Query { RangeQuery, PointQuery };
+
+    TierQueryBenchmark(Query query) :
+        Benchmark("tier", (query == RangeQuery) ? "range-queries" : "point-queries"), m_query(query)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        Q_UNUSED(error)
+        quint32 state = corpus->parameters().seed;
+        double duration = corpus->parameters().duration;
+        foreach (QString communicationID, corpus->communicationIDs()) {
+            QList<QPair<QString, AnnotationTierGroup *> > tiersAll = corpus->annotation(communicationID);
+            for (int i = 0; i < tiersAll.count(); ++i) {
+                m_groups << tiersAll.at(i).second;
+                foreach (QString name, QStringList() << "phone" << "syll") {
+                    IntervalTier *tier = tiersAll.at(i).second->getIntervalTierByName(name);
+                    if (tier) m_tiers << tier;
+                }
+            }
+        }
+        for (int i = 0; i < 2000; ++i) {
+            state = state * 1664525u + 1013904223u;
+            double start = (state >> 8) / 16777216.0 * duration;
+            state = state * 1664525u + 1013904223u;
+            double length = 0.5 + 4.5 * ((state >> 8) / 16777216.0);
+            m_windows << new Interval(RealTime::fromSeconds(start), RealTime::fromSeconds(qMin(duration, start + length)), "");
+        }
+        return true;
+    }
+    void run() override {
+        qint64 found = 0;
+        foreach (IntervalTier *tier, m_tiers) {
+            foreach (Interval *window, m_windows) {
+                if (m_query == RangeQuery) {
+                    found += tier->getIntervalsOverlappingWith(window).count();
+                    found += tier->getIntervalsContainedIn(window).count();
+                } else {
+                    if (tier->intervalAtTime(window->tMin())) found++;
+                    if (tier->intervalAtTime(window->tCenter())) found++;
+                }
+            }
+        }
+        benchmarkSink += found;
+    }
+    void tearDown() override {
+        qDeleteAll(m_windows);
+        m_windows.clear();
+        m_tiers.clear();
+        qDeleteAll(m_groups);
+        m_groups.clear();
+    }
+    qint64 itemsPerIteration() const override { return 2 * m_tiers.count() * m_windows.count(); }
+    QString itemsUnit() const override { return "queries"; }
+
+private:
+    Query m_query;
+    QList<AnnotationTierGroup *> m_groups;
+    QList<IntervalTier *> m_tiers;
+    QList<Interval *> m_windows;
+};
+
+// Walking the segment, tok_min, syll and phone tiers of every speaker from the top down, asking at each level for the
+// intervals contained in the current interval of the level above: one tier query per interval, or one cursor per level
+class HierarchyWalkBenchmark : public Benchmark
+{
+public:
+    HierarchyWalkBenchmark(bool cursors) :
+        Benchmark("tier", cursors ? "hierarchy-walk-cursors" : "hierarchy-walk-queries"), m_cursors(cursors)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        Q_UNUSED(error)
+        foreach (QString communicationID, corpus->communicationIDs()) {
+            QList<QPair<QString, AnnotationTierGroup *> > tiersAll = corpus->annotation(communicationID);
+            for (int i = 0; i < tiersAll.count(); ++i) {
+                AnnotationTierGroup *group = tiersAll.at(i).second;
+                m_groups << group;
+                QList<IntervalTier *> levels;
+                foreach (QString name, QStringList() << "segment" << "tok_min" << "syll" << "phone") {
+                    IntervalTier *tier = group->getIntervalTierByName(name);
+                    if (tier) levels << tier;
+                }
+                if (levels.count() == 4) m_hierarchies << levels;
+            }
+        }
+        return true;
+    }
+    void run() override {
+        qint64 found = 0;
+        foreach (QList<IntervalTier *> levels, m_hierarchies) {
+            if (m_cursors) {
+                IntervalTierHierarchyCursor h(levels);
+                foreach (Interval *segment, h.all(0))
+                    foreach (Interval *token, h.children(0, segment))
+                        foreach (Interval *syll, h.children(1, token))
+                            found += h.children(2, syll).count();
+            } else {
+                foreach (Interval *segment, levels.at(0)->intervals())
+                    foreach (Interval *token, levels.at(1)->getIntervalsContainedIn(segment))
+                        foreach (Interval *syll, levels.at(2)->getIntervalsContainedIn(token))
+                            found += levels.at(3)->getIntervalsContainedIn(syll).count();
+            }
+        }
+        benchmarkSink += found;
+    }
+    void tearDown() override {
+        m_hierarchies.clear();
+        qDeleteAll(m_groups);
+        m_groups.clear();
+    }
+    qint64 itemsPerIteration() const override {
+        qint64 count = 0;
+        foreach (QList<IntervalTier *> levels, m_hierarchies) count += levels.at(3)->count();
+        return count;
+    }
+    QString itemsUnit() const override { return "phones"; }
+
+private:
+    bool m_cursors;
+    QList<AnnotationTierGroup *> m_groups;
+    QList<QList<IntervalTier *> > m_hierarchies;
+};
+
+// ==============================================================================================================
+// Corpus repository
+// ==============================================================================================================
+
+// Reading all the tiers of each communication, and optionally writing the token tier of each speaker back
+class RepositoryBenchmark : public Benchmark
+{
+public:
+    RepositoryBenchmark(bool save) :
+        Benchmark("repository", save ? "getTiersAllSpeakers-saveTier" : "getTiersAllSpeakers"),
+        m_save(save), m_repository(nullptr)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        m_repository = corpus->repository(error);
+        if (!m_repository) return false;
+        m_communicationIDs = corpus->communicationIDs();
+        return true;
+    }
+    void run() override {
+        foreach (QString communicationID, m_communicationIDs) {
+            SpeakerAnnotationTierGroupMap tiersAll = m_repository->annotations()->getTiersAllSpeakers(communicationID);
+            foreach (QString speakerID, tiersAll.keys()) {
+                AnnotationTierGroup *tiers = tiersAll.value(speakerID);
+                if (!tiers) continue;
+                benchmarkSink += tiers->tiersCount();
+                if (m_save) {
+                    IntervalTier *tier = tiers->getIntervalTierByName("tok_min");
+                    if (tier) m_repository->annotations()->saveTier(communicationID, speakerID, tier);
+                }
+            }
+            qDeleteAll(tiersAll);
+        }
+    }
+    qint64 itemsPerIteration() const override { return m_communicationIDs.count(); }
+    QString itemsUnit() const override { return "communications"; }
+
+private:
+    bool m_save;
+    CorpusRepository *m_repository;
+    QStringList m_communicationIDs;
+};
+
+} // namespace
+
+void registerAnnotationBenchmarks(BenchmarkRunner &runner)
+{
+    runner.add(new TextGridLoadBenchmark());
+    runner.add(new TextGridSaveBenchmark());
+    runner.add(new TierQueryBenchmark(TierQueryBenchmark::RangeQuery));
+    runner.add(new TierQueryBenchmark(TierQueryBenchmark::PointQuery));
+    runner.add(new HierarchyWalkBenchmark(false));
+    runner.add(new HierarchyWalkBenchmark(true));
+    runner.add(new RepositoryBenchmark(false));
+    runner.add(new RepositoryBenchmark(true));
+}
@@ -0,0 +1,193 @@
+#include <QCoreApplication>
+#include <QThread>
+
+#include <vector>
+
+#include "data/fileio/FileSource.h"
+#include "data/model/WaveFileModel.h"
+#include "data/model/FFTModel.h"
+#include "data/fft/FFTDataServer.h"
+#include "data/fileio/MatrixFile.h"
+#include "base/Window.h"
+
+#include "SyntheticCorpus.h"
+#include "Benchmark.h"
+#include "BenchmarkGroups.h"
+
+namespace {
+
+volatile qint64 benchmarkSink = 0;
+
+// The model fills its summary cache in a background thread, and reports completion through the event loop
+bool waitUntilReady(WaveFileModel *model)
+{
+    int completion = 0;
+    while (model->isOK() && !model->isReady(&completion)) {
+        QCoreApplication::processEvents();
+        QThread::usleep(200);
+    }
+    return model->isOK();
+}
+
+// ==============================================================================================================
+// Waveform summaries
+// ==============================================================================================================
+
+class WaveformBenchmark : public Benchmark
+{
+public:
+    enum Task { BuildSummaryCache, ReadSummaries };
+
+    WaveformBenchmark(Task task) :
+        Benchmark("waveform", (task == BuildSummaryCache) ? "summary-cache" : "summaries"),
+        m_task(task), m_model(nullptr), m_frames(0)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        if (!corpus->createRecordings(error)) return false;
+        m_filename = corpus->recordingFilename(corpus->communicationIDs().first());
+        m_model = new WaveFileModel(FileSource(m_filename));
+        if (!waitUntilReady(m_model)) {
+            error = QString("Could not open %1").arg(m_filename);
+            return false;
+        }
+        m_frames = m_model->getEndFrame() - m_model->getStartFrame();
+        return true;
+    }
+    void run() override {
+        if (m_task == BuildSummaryCache) {
+            // Opening the file, decoding it and building the summary cache
+            WaveFileModel *model = new WaveFileModel(FileSource(m_filename));
+            waitUntilReady(model);
+            benchmarkSink += model->getEndFrame();
+            delete model;
+        } else {
+            // Summaries of the whole recording at the resolutions used when zooming out
+            foreach (int desired, QList<int>() << 64 << 256 << 1024 << 4096) {
+                RangeSummarisableTimeValueModel::RangeBlock ranges;
+                int blockSize = desired;
+                m_model->getSummaries(0, m_model->getStartFrame(), m_frames, ranges, blockSize);
+                benchmarkSink += qint64(ranges.size());
+            }
+        }
+    }
+    void tearDown() override {
+        if (m_model) delete m_model;
+        m_model = nullptr;
+    }
+    qint64 itemsPerIteration() const override { return m_frames; }
+    QString itemsUnit() const override { return "frames"; }
+
+private:
+    Task m_task;
+    QString m_filename;
+    WaveFileModel *m_model;
+    sv_frame_t m_frames;
+};
+
+// ==============================================================================================================
+// FFT cache
+// ==============================================================================================================
+
+// Filling the FFT cache of a recording (as for a spectrogram), reading every column. The FFT data server is
+// discarded after each iteration, so that every iteration computes the spectra again.
+class FFTCacheBenchmark : public Benchmark
+{
+public:
+    FFTCacheBenchmark() : Benchmark("fft", "cache-fill"), m_model(nullptr), m_columns(0) {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        if (!corpus->createRecordings(error)) return false;
+        QString filename = corpus->recordingFilename(corpus->communicationIDs().first());
+        m_model = new WaveFileModel(FileSource(filename));
+        if (!waitUntilReady(m_model)) {
+            error = QString("Could not open %1").arg(filename);
+            return false;
+        }
+        return true;
+    }
+    void run() override {
+        FFTModel *fft = new FFTModel(m_model, 0, HanningWindow, 1024, 256, 1024, true);
+        std::vector<float> magnitudes(size_t(fft->getHeight()));
+        int width = fft->getWidth();
+        for (int x = 0; x < width; ++x) {
+            fft->getMagnitudesAt(x, magnitudes.data());
+        }
+        benchmarkSink += qint64(magnitudes[magnitudes.size() / 2] * 1000.0f);
+        m_columns = width;
+        delete fft;
+        FFTDataServer::modelAboutToBeDeleted(m_model);
+    }
+    void tearDown() override {
+        if (m_model) {
+            FFTDataServer::modelAboutToBeDeleted(m_model);
+            delete m_model;
+        }
+        m_model = nullptr;
+    }
+    qint64 itemsPerIteration() const override { return m_columns; }
+    QString itemsUnit() const override { return "columns"; }
+
+private:
+    WaveFileModel *m_model;
+    int m_columns;
+};
+
+// ==============================================================================================================
+// Matrix files
+// ==============================================================================================================
+
+// Writing a matrix file the size of the FFT cache of a long recording column by column, as the FFT fill thread
+// does, and then reading its columns in scattered order, as views do; through read and write calls, or through a
+// memory mapping.
+class MatrixFileBenchmark : public Benchmark
+{
+public:
+    enum { Width = 10000 };
+
+    MatrixFileBenchmark(bool mapped) :
+        Benchmark("matrixfile", mapped ? "write-read-mmap" : "write-read-syscall"),
+        m_mapped(mapped), m_iteration(0)
+    {}
+
+    void run() override {
+        const int width = Width, height = 1025;
+        bool wasEnabled = MatrixFile::isMappingEnabled();
+        MatrixFile::setMappingEnabled(m_mapped);
+        QString fileBase = QString("benchmark-%1-%2").arg(name()).arg(++m_iteration);
+        std::vector<float> column(size_t(height), 0.0f);
+        MatrixFile *writer = new MatrixFile(fileBase, MatrixFile::WriteOnly, int(sizeof(float)), width, height);
+        MatrixFile::setMappingEnabled(wasEnabled);
+        for (int x = 0; x < width; ++x) {
+            column[size_t(x % height)] = float(x);
+            writer->setColumnAt(x, column.data());
+        }
+        MatrixFile *reader = new MatrixFile(fileBase, MatrixFile::ReadOnly, int(sizeof(float)), width, height);
+        for (int i = 0; i < width; ++i) {
+            int x = int((qint64(i) * 7919) % width);
+            if (reader->haveSetColumnAt(x)) {
+                reader->getColumnAt(x, column.data());
+                benchmarkSink += qint64(column[size_t(x % height)]);
+            }
+        }
+        delete reader;
+        delete writer;
+    }
+    qint64 itemsPerIteration() const override { return Width; }
+    QString itemsUnit() const override { return "columns"; }
+
+private:
+    bool m_mapped;
+    int m_iteration;
+};
+
+} // namespace
+
+void registerAudioBenchmarks(BenchmarkRunner &runner)
+{
+    runner.add(new WaveformBenchmark(WaveformBenchmark::BuildSummaryCache));
+    runner.add(new WaveformBenchmark(WaveformBenchmark::ReadSummaries));
+    runner.add(new FFTCacheBenchmark());
+    runner.add(new MatrixFileBenchmark(false));
+    runner.add(new MatrixFileBenchmark(true));
+}
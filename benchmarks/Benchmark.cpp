@@ -0,0 +1,197 @@
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QJsonArray>
+#include <QTextStream>
+#include <QtMath>
+
+#include <algorithm>
+
+#include "SyntheticCorpus.h"
+#include "Benchmark.h"
+
+// ==============================================================================================================
+// Results
+// ==============================================================================================================
+
+void BenchmarkResult::summarise()
+{
+    minimum = median = mean = stddev = 0.0;
+    if (timings.isEmpty()) return;
+    QVector<qint64> sorted = timings;
+    std::sort(sorted.begin(), sorted.end());
+    int n = sorted.count();
+    minimum = sorted.first();
+    median = (n % 2) ? sorted.at(n / 2) : (sorted.at(n / 2 - 1) + sorted.at(n / 2)) / 2.0;
+    double sum = 0.0;
+    foreach (qint64 t, sorted) sum += t;
+    mean = sum / n;
+    if (n > 1) {
+        double squares = 0.0;
+        foreach (qint64 t, sorted) squares += (t - mean) * (t - mean);
+        stddev = qSqrt(squares / (n - 1));
+    }
+}
+
+QJsonObject BenchmarkResult::toJson() const
+{
+    QJsonObject json;
+    json.insert("id", ID);
+    json.insert("status", skipped ? "skipped" : "ok");
+    if (!message.isEmpty()) json.insert("message", message);
+    if (skipped) return json;
+    QJsonArray samples;
+    foreach (qint64 t, timings) samples.append(double(t));
+    json.insert("iterations", timings.count());
+    json.insert("timings_ns", samples);
+    json.insert("min_ns", minimum);
+    json.insert("median_ns", median);
+    json.insert("mean_ns", mean);
+    json.insert("stddev_ns", stddev);
+    if (items > 0) {
+        json.insert("items", double(items));
+        json.insert("items_unit", itemsUnit);
+        if (median > 0) json.insert("items_per_second", double(items) * 1.0e9 / median);
+    }
+    return json;
+}
+
+BenchmarkResult BenchmarkResult::fromJson(const QJsonObject &json)
+{
+    BenchmarkResult result;
+    result.ID = json.value("id").toString();
+    result.skipped = (json.value("status").toString() != "ok");
+    result.message = json.value("message").toString();
+    result.items = qint64(json.value("items").toDouble());
+    result.itemsUnit = json.value("items_unit").toString();
+    foreach (QJsonValue t, json.value("timings_ns").toArray()) result.timings << qint64(t.toDouble());
+    result.summarise();
+    return result;
+}
+
+// ==============================================================================================================
+// Runner
+// ==============================================================================================================
+
+struct BenchmarkRunnerData {
+    QList<Benchmark *> benchmarks;
+};
+
+BenchmarkRunner::BenchmarkRunner() :
+    d(new BenchmarkRunnerData())
+{
+}
+
+BenchmarkRunner::~BenchmarkRunner()
+{
+    qDeleteAll(d->benchmarks);
+    delete d;
+}
+
+void BenchmarkRunner::add(Benchmark *benchmark)
+{
+    if (benchmark) d->benchmarks << benchmark;
+}
+
+bool BenchmarkRunner::matches(const QString &ID, const QStringList &filters)
+{
+    if (filters.isEmpty()) return true;
+    foreach (QString filter, filters) {
+        // A group name on its own selects all the benchmarks of the group
+        if (!filter.contains("/") && !filter.contains("*")) filter.append("/*");
+        if (QRegExp(filter, Qt::CaseInsensitive, QRegExp::Wildcard).exactMatch(ID)) return true;
+    }
+    return false;
+}
+
+QStringList BenchmarkRunner::benchmarkIDs(const QStringList &filters) const
+{
+    QStringList IDs;
+    foreach (Benchmark *benchmark, d->benchmarks) {
+        if (matches(benchmark->ID(), filters)) IDs << benchmark->ID();
+    }
+    return IDs;
+}
+
+QList<BenchmarkResult> BenchmarkRunner::run(SyntheticCorpus *corpus, const Options &options)
+{
+    QList<BenchmarkResult> results;
+    QTextStream err(stderr);
+    foreach (Benchmark *benchmark, d->benchmarks) {
+        if (!matches(benchmark->ID(), options.filters)) continue;
+        BenchmarkResult result;
+        result.ID = benchmark->ID();
+        err << benchmark->ID() << "... " << flush;
+        QString error;
+        if (!benchmark->setUp(corpus, error)) {
+            result.skipped = true;
+            result.message = error;
+            benchmark->tearDown();
+            results << result;
+            err << "skipped (" << error << ")" << endl;
+            continue;
+        }
+        for (int i = 0; i < options.warmupIterations; ++i) {
+            benchmark->run();
+        }
+        QElapsedTimer timer;
+        for (int i = 0; i < options.iterations; ++i) {
+            timer.start();
+            benchmark->run();
+            result.timings << timer.nsecsElapsed();
+        }
+        result.items = benchmark->itemsPerIteration();
+        result.itemsUnit = benchmark->itemsUnit();
+        benchmark->tearDown();
+        result.summarise();
+        results << result;
+        err << QString("median %1 ms, min %2 ms").arg(result.median / 1.0e6, 0, 'f', 3)
+               .arg(result.minimum / 1.0e6, 0, 'f', 3) << endl;
+    }
+    return results;
+}
+
+QJsonDocument BenchmarkRunner::report(const QList<BenchmarkResult> &results, const QJsonObject &metadata)
+{
+    QJsonObject json;
+    json.insert("format", "praaline-benchmarks");
+    json.insert("version", 1);
+    json.insert("metadata", metadata);
+    QJsonArray benchmarks;
+    foreach (BenchmarkResult result, results) benchmarks.append(result.toJson());
+    json.insert("benchmarks", benchmarks);
+    return QJsonDocument(json);
+}
+
+QList<BenchmarkResult> BenchmarkRunner::resultsFromReport(const QJsonDocument &report)
+{
+    QList<BenchmarkResult> results;
+    if (report.object().value("format").toString() != "praaline-benchmarks") return results;
+    foreach (QJsonValue value, report.object().value("benchmarks").toArray()) {
+        results << BenchmarkResult::fromJson(value.toObject());
+    }
+    return results;
+}
+
+QStringList BenchmarkRunner::regressions(const QList<BenchmarkResult> &baseline, const QList<BenchmarkResult> &results,
+                                         double threshold, QStringList &messages)
+{
+    QStringList regressed;
+    foreach (BenchmarkResult result, results) {
+        if (result.skipped) continue;
+        foreach (BenchmarkResult reference, baseline) {
+            if (reference.ID != result.ID || reference.skipped || reference.median <= 0) continue;
+            double change = (result.median - reference.median) / reference.median;
+            QString message = QString("%1: median %2 ms -> %3 ms (%4%5%)").arg(result.ID)
+                    .arg(reference.median / 1.0e6, 0, 'f', 3).arg(result.median / 1.0e6, 0, 'f', 3)
+                    .arg(change >= 0 ? "+" : "").arg(change * 100.0, 0, 'f', 1);
+            if (change > threshold) {
+                regressed << result.ID;
+                message.append(" REGRESSION");
+            }
+            messages << message;
+            break;
+        }
+    }
+    return regressed;
+}
@@ -0,0 +1,98 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+class SyntheticCorpus;
+struct BenchmarkRunnerData;
+
+// A benchmark prepares its data once in setUp() (not timed), and then run() is timed over a number of iterations.
+// Benchmarks whose dependencies are not available (e.g. language models that are not installed) are reported as
+// skipped, with the reason, instead of failing the whole run.
+class Benchmark
+{
+public:
+    Benchmark(const QString &group, const QString &name) :
+        m_group(group), m_name(name)
+    {}
+    virtual ~Benchmark() {}
+
+    QString group() const { return m_group; }
+    QString name() const { return m_name; }
+    QString ID() const { return m_group + "/" + m_name; }
+
+    virtual bool setUp(SyntheticCorpus *corpus, QString &error) { Q_UNUSED(corpus); Q_UNUSED(error); return true; }
+    virtual void run() = 0;
+    virtual void tearDown() {}
+    // Units of work processed by one iteration (e.g. intervals, frames), to report throughput
+    virtual qint64 itemsPerIteration() const { return 0; }
+    virtual QString itemsUnit() const { return QString(); }
+
+private:
+    QString m_group;
+    QString m_name;
+};
+
+class BenchmarkResult
+{
+public:
+    BenchmarkResult() : skipped(false), items(0), minimum(0), median(0), mean(0), stddev(0) {}
+
+    QString ID;
+    bool skipped;
+    QString message;
+    qint64 items;
+    QString itemsUnit;
+    // Duration of each timed iteration, and their summary, in nanoseconds
+    QVector<qint64> timings;
+    double minimum;
+    double median;
+    double mean;
+    double stddev;
+
+    void summarise();
+    QJsonObject toJson() const;
+    static BenchmarkResult fromJson(const QJsonObject &json);
+};
+
+class BenchmarkRunner
+{
+public:
+    class Options {
+    public:
+        Options() : iterations(5), warmupIterations(1) {}
+        // Wildcard patterns matched against benchmark IDs (group/name); all benchmarks run when empty
+        QStringList filters;
+        int iterations;
+        int warmupIterations;
+    };
+
+    BenchmarkRunner();
+    ~BenchmarkRunner();
+
+    // Takes ownership of the benchmark
+    void add(Benchmark *benchmark);
+    QStringList benchmarkIDs(const QStringList &filters = QStringList()) const;
+
+    QList<BenchmarkResult> run(SyntheticCorpus *corpus, const Options &options);
+
+    // The report contains the results and the conditions of the run (build, host, corpus parameters), so that
+    // reports from successive runs can be compared
+    static QJsonDocument report(const QList<BenchmarkResult> &results, const QJsonObject &metadata);
+    static QList<BenchmarkResult> resultsFromReport(const QJsonDocument &report);
+    // Benchmarks whose median is slower than in the baseline by more than threshold (relative, e.g. 0.10)
+    static QStringList regressions(const QList<BenchmarkResult> &baseline, const QList<BenchmarkResult> &results,
+                                   double threshold, QStringList &messages);
+
+private:
+    BenchmarkRunnerData *d;
+
+    static bool matches(const QString &ID, const QStringList &filters);
+};
+
+#endif // BENCHMARK_H
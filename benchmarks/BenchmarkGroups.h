@@ -0,0 +1,13 @@
+#ifndef BENCHMARKGROUPS_H
+#define BENCHMARKGROUPS_H
+
+class BenchmarkRunner;
+
+// Each group of benchmarks adds its benchmarks to the runner
+void registerAnnotationBenchmarks(BenchmarkRunner &runner);
+void registerLinguisticBenchmarks(BenchmarkRunner &runner);
+void registerDiffBenchmarks(BenchmarkRunner &runner);
+void registerAudioBenchmarks(BenchmarkRunner &runner);
+void registerStatisticsBenchmarks(BenchmarkRunner &runner);
+
+#endif // BENCHMARKGROUPS_H
@@ -0,0 +1,104 @@
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineCore/Annotation/AnnotationTierGroup.h"
+using namespace Praaline::Core;
+
+#include "pnlib/diff/IntervalDiffEngine.h"
+
+#include "SyntheticCorpus.h"
+#include "Benchmark.h"
+#include "BenchmarkGroups.h"
+
+namespace {
+
+volatile qint64 benchmarkSink = 0;
+
+class CountingSink : public IntervalDiffSink
+{
+public:
+    CountingSink() : edits(0) {}
+    void addElement(dtl::edit_t type, long long indexA, long long indexB) override {
+        Q_UNUSED(indexA); Q_UNUSED(indexB);
+        if (type != dtl::SES_COMMON) edits++;
+    }
+    qint64 edits;
+};
+
+// Token tiers of every speaker compared with a copy in which about 5% of the tokens were substituted, deleted or
+// inserted (as when comparing a transcription with the output of a recogniser, or two annotators)
+class IntervalDiffBenchmark : public Benchmark
+{
+public:
+    IntervalDiffBenchmark(bool parallel) :
+        Benchmark("diff", parallel ? "tokens-diffAll" : "tokens"), m_parallel(parallel), m_tokens(0)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        Q_UNUSED(error)
+        quint32 state = corpus->parameters().seed;
+        m_tokens = 0;
+        foreach (QString communicationID, corpus->communicationIDs()) {
+            QList<QPair<QString, AnnotationTierGroup *> > tiersAll = corpus->annotation(communicationID);
+            for (int i = 0; i < tiersAll.count(); ++i) {
+                m_groups << tiersAll.at(i).second;
+                IntervalTier *tier = tiersAll.at(i).second->getIntervalTierByName("tok_min");
+                if (!tier) continue;
+                IntervalDiffEngine::Job job;
+                job.intervalsA = tier->intervals();
+                foreach (Interval *token, tier->intervals()) {
+                    state = state * 1664525u + 1013904223u;
+                    double p = (state >> 8) / 16777216.0;
+                    if (p < 0.02) continue;                                             // deletion
+                    if (p < 0.04) { job.intervalsB << newInterval(token, "xxx"); continue; } // substitution
+                    job.intervalsB << newInterval(token, token->text());
+                    if (p < 0.05) job.intervalsB << newInterval(token, "yyy");          // insertion
+                }
+                m_tokens += job.intervalsA.count() + job.intervalsB.count();
+                m_jobs << job;
+            }
+        }
+        return true;
+    }
+    void run() override {
+        if (m_parallel) {
+            QList<dtl::Ses<Interval *>::sesElemVec> results = IntervalDiffEngine::diffAll(m_jobs);
+            foreach (const dtl::Ses<Interval *>::sesElemVec &ses, results) benchmarkSink += qint64(ses.size());
+        } else {
+            CountingSink sink;
+            foreach (const IntervalDiffEngine::Job &job, m_jobs) {
+                IntervalDiffEngine::diff(job.intervalsA, job.intervalsB, &sink);
+            }
+            benchmarkSink += sink.edits;
+        }
+    }
+    void tearDown() override {
+        m_jobs.clear();
+        qDeleteAll(m_copies);
+        m_copies.clear();
+        qDeleteAll(m_groups);
+        m_groups.clear();
+    }
+    qint64 itemsPerIteration() const override { return m_tokens; }
+    QString itemsUnit() const override { return "tokens"; }
+
+private:
+    bool m_parallel;
+    QList<AnnotationTierGroup *> m_groups;
+    QList<Interval *> m_copies;
+    QList<IntervalDiffEngine::Job> m_jobs;
+    qint64 m_tokens;
+
+    Interval *newInterval(Interval *token, const QString &text) {
+        Interval *copy = new Interval(token->tMin(), token->tMax(), text);
+        m_copies << copy;
+        return copy;
+    }
+};
+
+} // namespace
+
+void registerDiffBenchmarks(BenchmarkRunner &runner)
+{
+    runner.add(new IntervalDiffBenchmark(false));
+    runner.add(new IntervalDiffBenchmark(true));
+}
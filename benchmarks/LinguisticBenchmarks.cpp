@@ -0,0 +1,142 @@
+#include <QFileInfo>
+
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineCore/Annotation/AnnotationTierGroup.h"
+using namespace Praaline::Core;
+
+#include "PraalineASR/Phonetiser/RuleBasedPhonetiser.h"
+using namespace Praaline::ASR;
+
+#include "dismo/DisMoAnnotator.h"
+#include "dismo/DisMoConfiguration.h"
+
+#include "SyntheticCorpus.h"
+#include "Benchmark.h"
+#include "BenchmarkGroups.h"
+
+namespace {
+
+volatile qint64 benchmarkSink = 0;
+
+// ==============================================================================================================
+// Phonetisation
+// ==============================================================================================================
+
+// Phonetisation of every token of the corpus with the rule-based phonetiser. Without the cache, every token goes
+// through the rules; with the cache, only the first occurrence of each word does.
+class PhonetisationBenchmark : public Benchmark
+{
+public:
+    PhonetisationBenchmark(bool cached) :
+        Benchmark("phonetisation", cached ? "rules-cached" : "rules"), m_cached(cached)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        if (!corpus->createPhonetisationRules(error)) return false;
+        if (!m_phonetiser.readRuleFile(corpus->phonetisationRulesFilename()) || m_phonetiser.rulesCount() == 0) {
+            error = "Could not read the phonetisation rules";
+            return false;
+        }
+        foreach (QString communicationID, corpus->communicationIDs()) {
+            QList<QPair<QString, AnnotationTierGroup *> > tiersAll = corpus->annotation(communicationID);
+            for (int i = 0; i < tiersAll.count(); ++i) {
+                IntervalTier *tier = tiersAll.at(i).second->getIntervalTierByName("tok_min");
+                if (tier) {
+                    foreach (Interval *token, tier->intervals()) {
+                        if (!token->isPauseSilent()) m_tokens << token->text();
+                    }
+                }
+                delete tiersAll.at(i).second;
+            }
+        }
+        return true;
+    }
+    void run() override {
+        if (!m_cached) m_phonetiser.clearCache();
+        qint64 length = 0;
+        foreach (QString token, m_tokens) length += m_phonetiser.phonetise(token).length();
+        benchmarkSink += length;
+    }
+    void tearDown() override {
+        m_tokens.clear();
+        m_phonetiser.clearCache();
+    }
+    qint64 itemsPerIteration() const override { return m_tokens.count(); }
+    QString itemsUnit() const override { return "tokens"; }
+
+private:
+    bool m_cached;
+    RuleBasedPhonetiser m_phonetiser;
+    QStringList m_tokens;
+};
+
+// ==============================================================================================================
+// DisMo
+// ==============================================================================================================
+
+// Tokenisation and POS tagging of the utterances of the first communications. Requires the French DisMo models,
+// as installed with the DisMo plugin.
+class DisMoBenchmark : public Benchmark
+{
+public:
+    DisMoBenchmark() : Benchmark("dismo", "annotate"), m_annotator(nullptr), m_utterances(0) {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        QString model = DisMoConfiguration::resourcesPath() + "/models/posmin_fr.model";
+        if (!QFileInfo::exists(model)) {
+            error = QString("DisMo models not installed (%1)").arg(model);
+            return false;
+        }
+        m_annotator = new DisMoAnnotator::DismoAnnotator("fr");
+        m_utterances = 0;
+        foreach (QString communicationID, corpus->communicationIDs().mid(0, 2)) {
+            QList<QPair<QString, AnnotationTierGroup *> > tiersAll = corpus->annotation(communicationID);
+            for (int i = 0; i < tiersAll.count(); ++i) {
+                IntervalTier *tier = tiersAll.at(i).second->getIntervalTierByName("segment");
+                if (tier) {
+                    m_segments << tier;
+                    foreach (Interval *segment, tier->intervals()) {
+                        if (!segment->isPauseSilent()) m_utterances++;
+                    }
+                }
+                m_groups << tiersAll.at(i).second;
+            }
+        }
+        return true;
+    }
+    void run() override {
+        foreach (IntervalTier *segments, m_segments) {
+            IntervalTier *tier_tok_min = new IntervalTier("tok_min", segments->tMin(), segments->tMax());
+            IntervalTier *tier_tok_mwu = new IntervalTier("tok_mwu", segments->tMin(), segments->tMax());
+            m_annotator->annotate(segments, tier_tok_min, tier_tok_mwu);
+            benchmarkSink += tier_tok_min->count();
+            delete tier_tok_min;
+            delete tier_tok_mwu;
+        }
+    }
+    void tearDown() override {
+        if (m_annotator) delete m_annotator;
+        m_annotator = nullptr;
+        m_segments.clear();
+        qDeleteAll(m_groups);
+        m_groups.clear();
+    }
+    qint64 itemsPerIteration() const override { return m_utterances; }
+    QString itemsUnit() const override { return "utterances"; }
+
+private:
+    DisMoAnnotator::DismoAnnotator *m_annotator;
+    QList<IntervalTier *> m_segments;
+    QList<AnnotationTierGroup *> m_groups;
+    qint64 m_utterances;
+};
+
+} // namespace
+
+void registerLinguisticBenchmarks(BenchmarkRunner &runner)
+{
+    runner.add(new PhonetisationBenchmark(false));
+    runner.add(new PhonetisationBenchmark(true));
+    runner.add(new DisMoBenchmark());
+}
@@ -0,0 +1,127 @@
+#include <QPointer>
+
+#include "PraalineCore/Corpus/Corpus.h"
+using namespace Praaline::Core;
+
+#include "statistics/StatisticalMeasureAggregator.h"
+#include "statistics/temporal/AnalyserTemporal.h"
+#include "statistics/temporal/AnalyserTemporalItem.h"
+
+#include "SyntheticCorpus.h"
+#include "Benchmark.h"
+#include "BenchmarkGroups.h"
+
+namespace {
+
+volatile qint64 benchmarkSink = 0;
+
+// ==============================================================================================================
+// Temporal analyser
+// ==============================================================================================================
+
+// Temporal measures (speech rate, pauses, overlaps, turns) of every communication, as computed by the Temporal
+// Analysis statistics plugin: one communication after the other, or the whole corpus in parallel.
+class TemporalAnalysisBenchmark : public Benchmark
+{
+public:
+    TemporalAnalysisBenchmark(bool parallel) :
+        Benchmark("statistics", parallel ? "temporal-corpus" : "temporal-communication"),
+        m_parallel(parallel), m_corpus(nullptr)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        m_corpus = corpus->corpus(error);
+        return (m_corpus != nullptr);
+    }
+    void run() override {
+        if (m_parallel) {
+            AnalyserTemporal analyser;
+            analyser.setCorpus(m_corpus);
+            analyser.analyse();
+            benchmarkSink += analyser.measureValuesCom("TimeTotalSample").count();
+        } else {
+            foreach (CorpusCommunication *com, m_corpus->communications()) {
+                AnalyserTemporalItem item;
+                item.analyse(com);
+                benchmarkSink += item.speakerIDs().count();
+            }
+        }
+    }
+    qint64 itemsPerIteration() const override { return m_corpus ? m_corpus->communications().count() : 0; }
+    QString itemsUnit() const override { return "communications"; }
+
+private:
+    bool m_parallel;
+    Corpus *m_corpus;
+};
+
+// ==============================================================================================================
+// Aggregation
+// ==============================================================================================================
+
+// Grouping every scalar measure of the temporal analyser by a metadata attribute, and building the feature matrix
+// of the speaker measures (as for a PCA), either from the analyser or from the materialised measure cubes.
+class AggregationBenchmark : public Benchmark
+{
+public:
+    AggregationBenchmark(bool materialised) :
+        Benchmark("statistics", materialised ? "aggregate-cube" : "aggregate-analyser"),
+        m_materialised(materialised), m_analyser(nullptr), m_aggregator(nullptr)
+    {}
+
+    bool setUp(SyntheticCorpus *corpus, QString &error) override {
+        Corpus *c = corpus->corpus(error);
+        if (!c) return false;
+        m_analyser = new AnalyserTemporal();
+        m_analyser->setCorpus(c);
+        m_analyser->analyse();
+        m_aggregator = new StatisticalMeasureAggregator(m_analyser);
+        if (m_materialised) m_aggregator->materialise();
+        return true;
+    }
+    void run() override {
+        qint64 values = 0;
+        QStringList groupBy = QStringList() << "name";
+        foreach (QString measureID, m_analyser->measureIDsForCommunication()) {
+            QMap<QString, QList<double> > aggregates = m_materialised ?
+                        m_aggregator->aggregateMeasureCom(measureID, groupBy) :
+                        m_analyser->aggregateMeasureCom(measureID, groupBy);
+            values += aggregates.count();
+        }
+        foreach (QString measureID, m_analyser->measureIDsForSpeaker()) {
+            QMap<QString, QList<double> > aggregates = m_materialised ?
+                        m_aggregator->aggregateMeasureSpk(measureID, groupBy, QStringList()) :
+                        m_analyser->aggregateMeasureSpk(measureID, groupBy, QStringList());
+            values += aggregates.count();
+        }
+        if (m_materialised) {
+            values += m_aggregator->featureMatrixSpk(m_analyser->measureIDsForSpeaker()).values.count();
+        }
+        benchmarkSink += values;
+    }
+    void tearDown() override {
+        if (m_aggregator) delete m_aggregator;
+        m_aggregator = nullptr;
+        if (m_analyser) delete m_analyser;
+        m_analyser = nullptr;
+    }
+    qint64 itemsPerIteration() const override {
+        return m_analyser ? m_analyser->measureIDsForCommunication().count() + m_analyser->measureIDsForSpeaker().count() : 0;
+    }
+    QString itemsUnit() const override { return "measures"; }
+
+private:
+    bool m_materialised;
+    AnalyserTemporal *m_analyser;
+    StatisticalMeasureAggregator *m_aggregator;
+};
+
+} // namespace
+
+void registerStatisticsBenchmarks(BenchmarkRunner &runner)
+{
+    runner.add(new TemporalAnalysisBenchmark(false));
+    runner.add(new TemporalAnalysisBenchmark(true));
+    runner.add(new AggregationBenchmark(false));
+    runner.add(new AggregationBenchmark(true));
+}
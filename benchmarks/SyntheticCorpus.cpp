@@ -0,0 +1,436 @@
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTemporaryDir>
+#include <QPointer>
+#include <QtMath>
+
+#include <vector>
+
+#include "PraalineCore/Base/RealTime.h"
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineCore/Annotation/AnnotationTierGroup.h"
+#include "PraalineCore/Corpus/Corpus.h"
+#include "PraalineCore/Datastore/CorpusRepository.h"
+#include "PraalineCore/Datastore/CorpusRepositoryDefinition.h"
+#include "PraalineCore/Datastore/AnnotationDatastore.h"
+#include "PraalineCore/Structure/AnnotationStructure.h"
+#include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
+using namespace Praaline::Core;
+
+#include "data/fileio/WavFileWriter.h"
+
+#include "SyntheticCorpus.h"
+
+namespace {
+
+// Linear congruential generator: same sequence on every platform, unlike qrand()
+class Random {
+public:
+    Random(quint32 seed) : m_state(seed) {}
+    quint32 next() { m_state = m_state * 1664525u + 1013904223u; return m_state; }
+    double uniform() { return (next() >> 8) / 16777216.0; }
+    double uniform(double from, double to) { return from + (to - from) * uniform(); }
+private:
+    quint32 m_state;
+};
+
+// Word and pronunciation (SAMPA, syllables separated by spaces)
+const char *const vocabularyData[][2] = {
+    { "de", "d@" }, { "le", "l@" }, { "la", "la" }, { "et", "e" }, { "est", "E" }, { "que", "k@" },
+    { "je", "Z@" }, { "il", "il" }, { "on", "o~" }, { "pas", "pa" }, { "une", "yn" }, { "bon", "bo~" },
+    { "va", "va" }, { "alors", "a lOR" }, { "faire", "fER" }, { "chose", "Soz" }, { "bien", "bjE~" },
+    { "tres", "tRE" }, { "quand", "ka~" }, { "meme", "mEm" }, { "voila", "vwa la" }, { "enfin", "a~ fE~" },
+    { "maison", "mE zo~" }, { "petit", "p@ ti" }, { "pense", "pa~s" }, { "comment", "kO ma~" },
+    { "beaucoup", "bo ku" }, { "toujours", "tu ZuR" }, { "semaine", "s@ mEn" }, { "parce", "paRs" },
+    { "derniere", "dER njER" }, { "probablement", "pRO ba bl@ ma~" }, { "evidemment", "e vi da ma~" },
+    { "ordinateur", "OR di na t9R" }, { "universite", "y ni vER si te" }
+};
+const int vocabularySize = sizeof(vocabularyData) / sizeof(vocabularyData[0]);
+
+QStringList splitPhones(const QString &syllable)
+{
+    QStringList phones;
+    foreach (QChar c, syllable) {
+        if (c == '~' && !phones.isEmpty()) phones.last().append(c);
+        else phones << QString(c);
+    }
+    return phones;
+}
+
+class TierBuilder {
+public:
+    TierBuilder() : cursor(RealTime::zeroTime) {}
+    void append(const RealTime &start, const RealTime &end, const QString &text) {
+        if (end <= start) return;
+        if (start > cursor) intervals << new Interval(cursor, start, "_");
+        intervals << new Interval(qMax(start, cursor), end, text);
+        cursor = end;
+    }
+    IntervalTier *tier(const QString &name, const RealTime &tMax) {
+        if (tMax > cursor) intervals << new Interval(cursor, tMax, "_");
+        IntervalTier *tier = new IntervalTier(name, intervals, RealTime::zeroTime, tMax);
+        intervals.clear();
+        return tier;
+    }
+    QList<Interval *> intervals;
+    RealTime cursor;
+};
+
+struct SpeakerTiers {
+    TierBuilder segment, tokens, syllables, phones;
+    QList<QPair<double, double> > voiced;
+};
+
+} // namespace
+
+struct SyntheticCorpusData {
+    SyntheticCorpusData() :
+        textGridsCreated(false), recordingsCreated(false), rulesCreated(false), repository(nullptr)
+    {}
+
+    SyntheticCorpus::Parameters parameters;
+    QTemporaryDir directory;
+    bool textGridsCreated;
+    bool recordingsCreated;
+    bool rulesCreated;
+    QPointer<CorpusRepository> repository;
+    QPointer<Corpus> corpus;
+};
+
+SyntheticCorpus::SyntheticCorpus(const Parameters &parameters) :
+    d(new SyntheticCorpusData())
+{
+    d->parameters = parameters;
+    if (d->parameters.speakersPerCommunication < 1) d->parameters.speakersPerCommunication = 1;
+}
+
+SyntheticCorpus::~SyntheticCorpus()
+{
+    if (d->corpus) delete d->corpus;
+    if (d->repository) delete d->repository;
+    delete d;
+}
+
+const SyntheticCorpus::Parameters &SyntheticCorpus::parameters() const
+{
+    return d->parameters;
+}
+
+QString SyntheticCorpus::basePath() const
+{
+    return d->directory.path();
+}
+
+bool SyntheticCorpus::isValid() const
+{
+    return d->directory.isValid();
+}
+
+QString SyntheticCorpus::errorString() const
+{
+    return d->directory.isValid() ? QString() : QString("Could not create a temporary directory");
+}
+
+QStringList SyntheticCorpus::communicationIDs() const
+{
+    QStringList IDs;
+    for (int i = 1; i <= d->parameters.communications; ++i) {
+        IDs << QString("bench%1").arg(i, 3, 10, QChar('0'));
+    }
+    return IDs;
+}
+
+QStringList SyntheticCorpus::speakerIDs(const QString &communicationID) const
+{
+    QStringList IDs;
+    for (int i = 0; i < d->parameters.speakersPerCommunication; ++i) {
+        IDs << QString("%1_%2").arg(communicationID).arg(QChar('A' + i));
+    }
+    return IDs;
+}
+
+QList<QPair<QString, QString> > SyntheticCorpus::vocabulary() const
+{
+    QList<QPair<QString, QString> > words;
+    for (int i = 0; i < vocabularySize; ++i) {
+        words << QPair<QString, QString>(vocabularyData[i][0], vocabularyData[i][1]);
+    }
+    return words;
+}
+
+// ==============================================================================================================
+// Annotation
+// ==============================================================================================================
+
+namespace {
+
+// Turns alternate between speakers, separated by gaps or overlaps; within a turn, words are drawn from the
+// vocabulary with a skewed (Zipf-like) distribution, with silent and filled pauses.
+QList<SpeakerTiers *> generateTiers(quint32 seed, int communicationIndex, int speakers, double duration)
+{
+    QList<SpeakerTiers *> tiers;
+    for (int s = 0; s < speakers; ++s) tiers << new SpeakerTiers();
+    Random random(seed ^ (quint32(communicationIndex + 1) * 2654435761u));
+    double t = random.uniform(0.2, 1.0);
+    int turn = 0;
+    while (t < duration - 1.0) {
+        SpeakerTiers *spk = tiers.at(turn % speakers);
+        double turnStart = t;
+        double turnEnd = qMin(duration, turnStart + random.uniform(1.5, 8.0));
+        QStringList utterance;
+        while (t < turnEnd) {
+            if (!utterance.isEmpty() && random.uniform() < 0.08) {
+                t += random.uniform(0.15, 0.6);        // silent pause within the turn
+                if (t >= turnEnd) break;
+            }
+            QString word, pronunciation;
+            if (random.uniform() < 0.05) {
+                word = "euh"; pronunciation = "2";
+            } else {
+                int index = int(vocabularySize * random.uniform() * random.uniform());
+                word = vocabularyData[index][0];
+                pronunciation = vocabularyData[index][1];
+            }
+            double wordStart = t;
+            foreach (QString syllable, pronunciation.split(" ")) {
+                double syllableDuration = (word == "euh") ? random.uniform(0.25, 0.6) : random.uniform(0.12, 0.26);
+                if (t + syllableDuration > duration) break;
+                QStringList phones = splitPhones(syllable);
+                for (int p = 0; p < phones.count(); ++p) {
+                    spk->phones.append(RealTime::fromSeconds(t + syllableDuration * p / phones.count()),
+                                       RealTime::fromSeconds(t + syllableDuration * (p + 1) / phones.count()),
+                                       phones.at(p));
+                }
+                spk->syllables.append(RealTime::fromSeconds(t), RealTime::fromSeconds(t + syllableDuration), syllable);
+                spk->voiced << QPair<double, double>(t, t + syllableDuration);
+                t += syllableDuration;
+            }
+            if (t <= wordStart) break;
+            spk->tokens.append(RealTime::fromSeconds(wordStart), RealTime::fromSeconds(t), word);
+            utterance << word;
+        }
+        if (!utterance.isEmpty()) {
+            spk->segment.append(RealTime::fromSeconds(turnStart), RealTime::fromSeconds(t), utterance.join(" "));
+        }
+        // Gap (positive) or overlap (negative) before the next turn; a single speaker never overlaps their own turns
+        double gap = random.uniform(-0.6, 1.2);
+        if (speakers == 1) gap = qAbs(gap);
+        t = qMax(turnStart + 0.5, t + gap);
+        turn++;
+    }
+    return tiers;
+}
+
+} // namespace
+
+QList<QPair<QString, AnnotationTierGroup *> > SyntheticCorpus::annotation(const QString &communicationID) const
+{
+    QList<QPair<QString, AnnotationTierGroup *> > annotation;
+    int index = communicationIDs().indexOf(communicationID);
+    if (index < 0) return annotation;
+    QStringList speakers = speakerIDs(communicationID);
+    RealTime tMax = RealTime::fromSeconds(d->parameters.duration);
+    QList<SpeakerTiers *> tiers = generateTiers(d->parameters.seed, index, speakers.count(), d->parameters.duration);
+    for (int s = 0; s < speakers.count(); ++s) {
+        AnnotationTierGroup *group = new AnnotationTierGroup();
+        group->addTier(tiers.at(s)->segment.tier("segment", tMax));
+        group->addTier(tiers.at(s)->tokens.tier("tok_min", tMax));
+        group->addTier(tiers.at(s)->syllables.tier("syll", tMax));
+        group->addTier(tiers.at(s)->phones.tier("phone", tMax));
+        annotation << QPair<QString, AnnotationTierGroup *>(speakers.at(s), group);
+    }
+    qDeleteAll(tiers);
+    return annotation;
+}
+
+bool SyntheticCorpus::createTextGrids(QString &error)
+{
+    if (d->textGridsCreated) return true;
+    if (!isValid()) { error = errorString(); return false; }
+    foreach (QString communicationID, communicationIDs()) {
+        QList<QPair<QString, AnnotationTierGroup *> > tiersAll = annotation(communicationID);
+        bool ok = true;
+        for (int i = 0; i < tiersAll.count(); ++i) {
+            QString filename = textGridFilename(communicationID, tiersAll.at(i).first);
+            if (ok && !PraatTextGrid::save(filename, tiersAll.at(i).second)) {
+                error = QString("Could not write %1").arg(filename);
+                ok = false;
+            }
+            delete tiersAll.at(i).second;
+        }
+        if (!ok) return false;
+    }
+    d->textGridsCreated = true;
+    return true;
+}
+
+QString SyntheticCorpus::textGridFilename(const QString &communicationID, const QString &speakerID) const
+{
+    Q_UNUSED(communicationID)
+    return basePath() + "/" + speakerID + ".TextGrid";
+}
+
+// ==============================================================================================================
+// Recordings
+// ==============================================================================================================
+
+// Mono recordings in which every syllable is a harmonic complex at the speaker's pitch, over background noise
+bool SyntheticCorpus::createRecordings(QString &error)
+{
+    if (d->recordingsCreated) return true;
+    if (!isValid()) { error = errorString(); return false; }
+    int sampleRate = d->parameters.sampleRate;
+    sv_frame_t frames = sv_frame_t(d->parameters.duration * sampleRate);
+    QStringList IDs = communicationIDs();
+    for (int c = 0; c < IDs.count(); ++c) {
+        QList<SpeakerTiers *> tiers = generateTiers(d->parameters.seed, c, d->parameters.speakersPerCommunication,
+                                                    d->parameters.duration);
+        std::vector<float> samples(size_t(frames), 0.0f);
+        for (int s = 0; s < tiers.count(); ++s) {
+            double f0 = 110.0 + 45.0 * s;
+            typedef QPair<double, double> Span;
+            foreach (Span span, tiers.at(s)->voiced) {
+                sv_frame_t from = sv_frame_t(span.first * sampleRate), to = qMin(frames, sv_frame_t(span.second * sampleRate));
+                for (sv_frame_t i = from; i < to; ++i) {
+                    double t = double(i) / sampleRate;
+                    double envelope = qSin(M_PI * double(i - from) / double(to - from));
+                    double value = 0.0;
+                    for (int h = 1; h <= 4; ++h) value += qSin(2.0 * M_PI * f0 * h * t) / h;
+                    samples[size_t(i)] += float(0.2 * envelope * value);
+                }
+            }
+        }
+        qDeleteAll(tiers);
+        Random noise(d->parameters.seed + quint32(c));
+        for (size_t i = 0; i < samples.size(); ++i) samples[i] += float(0.002 * (noise.uniform() - 0.5));
+        WavFileWriter writer(recordingFilename(IDs.at(c)), sampleRate, 1, WavFileWriter::WriteToTemporary);
+        float *channels[1] = { samples.data() };
+        if (!writer.isOK() || !writer.writeSamples(channels, frames) || !writer.close()) {
+            error = QString("%1: %2").arg(recordingFilename(IDs.at(c))).arg(writer.getError());
+            return false;
+        }
+    }
+    d->recordingsCreated = true;
+    return true;
+}
+
+QString SyntheticCorpus::recordingFilename(const QString &communicationID) const
+{
+    return basePath() + "/" + communicationID + ".wav";
+}
+
+// ==============================================================================================================
+// Phonetisation rules
+// ==============================================================================================================
+
+bool SyntheticCorpus::createPhonetisationRules(QString &error)
+{
+    if (d->rulesCreated) return true;
+    if (!isValid()) { error = errorString(); return false; }
+    QFile file(phonetisationRulesFilename());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        error = QString("Could not write %1").arg(file.fileName());
+        return false;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << "# Synthetic grapheme-to-phoneme rules (benchmarks)\n";
+    // Multi-letter graphemes first, then context-dependent rules (regular expressions), then single letters
+    out << "eau :: o\n" << "ou :: u\n" << "oi :: wa\n" << "ai :: E\n" << "ein :: E~\n" << "ien :: jE~\n"
+        << "ch :: S\n" << "qu :: k\n" << "gn :: J\n" << "ph :: f\n";
+    out << "[ae]n([^aeiou]|$) :: a~\\1\n" << "on([^aeiou]|$) :: o~\\1\n" << "in([^aeiou]|$) :: E~\\1\n"
+        << "e([rz])$ :: e\n" << "([^aeiou ])e$ :: \\1\n" << "s$ :: \n" << "t$ :: \n"
+        << "c([ei]) :: s\\1\n" << "g([ei]) :: Z\\1\n" << "([aeiou])s([aeiou]) :: \\1z\\2\n";
+    QString letters = "abcdefghijklmnopqrstuvwxyz";
+    QString phones = "abkdEfgaiZklmnOpkRstyvwksiz";
+    for (int i = 0; i < letters.length(); ++i) {
+        out << letters.at(i) << " :: " << phones.at(i) << "\n";
+    }
+    file.close();
+    d->rulesCreated = true;
+    return true;
+}
+
+QString SyntheticCorpus::phonetisationRulesFilename() const
+{
+    return basePath() + "/rules.txt";
+}
+
+// ==============================================================================================================
+// Corpus repository
+// ==============================================================================================================
+
+CorpusRepository *SyntheticCorpus::repository(QString &error)
+{
+    if (d->repository) return d->repository;
+    if (!isValid()) { error = errorString(); return nullptr; }
+    QString repositoryID = "benchmarks";
+    CorpusRepositoryDefinition definition;
+    definition.repositoryID = repositoryID;
+    definition.repositoryName = "Synthetic corpus for benchmarks";
+    definition.basePath = basePath();
+    definition.basePathMedia = ".";
+    definition.infoDatastoreMetadata = DatastoreInfo(
+                DatastoreInfo::SQL, "QSQLITE", "", basePath() + "/" + repositoryID + ".db", "", "");
+    definition.infoDatastoreAnnotations = DatastoreInfo(
+                DatastoreInfo::SQL, "QSQLITE", "", basePath() + "/" + repositoryID + ".db", "", "");
+    definition.filenameDefinition = basePath() + "/" + repositoryID + ".PraalineRepository";
+    QString errorMessages;
+    CorpusRepository *repository = CorpusRepository::create(definition, errorMessages);
+    if (!repository) {
+        error = QString("Could not create the corpus repository: %1").arg(errorMessages);
+        return nullptr;
+    }
+    // Annotation levels
+    foreach (QString levelID, QStringList() << "segment" << "tok_min" << "syll" << "phone") {
+        AnnotationStructureLevel *level = new AnnotationStructureLevel(levelID, AnnotationStructureLevel::IndependentIntervalsLevel, levelID);
+        if (!repository->annotations()->createAnnotationLevel(level)) {
+            error = QString("Could not create annotation level %1").arg(levelID);
+            delete level;
+            delete repository;
+            return nullptr;
+        }
+        repository->annotationStructure()->addLevel(level);
+    }
+    // Metadata and annotations
+    Corpus *corpus = new Corpus("benchmarks", repository);
+    foreach (QString communicationID, communicationIDs()) {
+        CorpusCommunication *com = new CorpusCommunication(communicationID);
+        com->setName(communicationID);
+        corpus->addCommunication(com);
+        CorpusRecording *rec = new CorpusRecording(communicationID);
+        rec->setFilename(QFileInfo(recordingFilename(communicationID)).fileName());
+        com->addRecording(rec);
+        com->addAnnotation(new CorpusAnnotation(communicationID));
+        foreach (QString speakerID, speakerIDs(communicationID)) {
+            corpus->addSpeaker(new CorpusSpeaker(speakerID));
+            corpus->addParticipation(communicationID, speakerID, "Participant");
+        }
+    }
+    if (!corpus->save()) {
+        error = "Could not save the corpus metadata";
+        delete corpus;
+        delete repository;
+        return nullptr;
+    }
+    foreach (QString communicationID, communicationIDs()) {
+        QList<QPair<QString, AnnotationTierGroup *> > tiersAll = annotation(communicationID);
+        for (int i = 0; i < tiersAll.count(); ++i) {
+            repository->annotations()->saveTiers(communicationID, tiersAll.at(i).first, tiersAll.at(i).second);
+            delete tiersAll.at(i).second;
+        }
+    }
+    d->repository = repository;
+    d->corpus = corpus;
+    return repository;
+}
+
+Corpus *SyntheticCorpus::corpus(QString &error)
+{
+    if (!repository(error)) return nullptr;
+    return d->corpus;
+}
@@ -0,0 +1,75 @@
+#ifndef SYNTHETICCORPUS_H
+#define SYNTHETICCORPUS_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QPair>
+
+namespace Praaline {
+namespace Core {
+class AnnotationTierGroup;
+class CorpusRepository;
+class Corpus;
+}
+}
+
+struct SyntheticCorpusData;
+
+// Reproducible corpus for the benchmarks. Everything is derived from the parameters: the same seed and size give
+// the same annotations and the same recordings on every run and every platform. Each communication is a dialogue
+// between speakers who alternate turns, with gaps and overlaps, annotated on the levels segment (utterances),
+// tok_min (words, with filled pauses), syll and phone; silent pauses are labelled "_". The files (TextGrids,
+// recordings, rule file) and the SQLite corpus repository are created on demand in a temporary directory.
+class SyntheticCorpus
+{
+public:
+    class Parameters {
+    public:
+        Parameters() :
+            seed(20200101), communications(8), speakersPerCommunication(2), duration(300.0), sampleRate(16000)
+        {}
+
+        quint32 seed;
+        int communications;
+        int speakersPerCommunication;
+        // Duration of each communication, in seconds
+        double duration;
+        int sampleRate;
+    };
+
+    SyntheticCorpus(const Parameters &parameters = Parameters());
+    ~SyntheticCorpus();
+
+    const Parameters &parameters() const;
+    QString basePath() const;
+    bool isValid() const;
+    QString errorString() const;
+
+    QStringList communicationIDs() const;
+    QStringList speakerIDs(const QString &communicationID) const;
+
+    // Generates the annotation of a communication: one tier group per speaker. The caller owns the tier groups.
+    QList<QPair<QString, Praaline::Core::AnnotationTierGroup *> > annotation(const QString &communicationID) const;
+    // Pronunciations (SAMPA, syllables separated by spaces) of the vocabulary used in the annotations
+    QList<QPair<QString, QString> > vocabulary() const;
+
+    bool createTextGrids(QString &error);
+    QString textGridFilename(const QString &communicationID, const QString &speakerID) const;
+
+    bool createRecordings(QString &error);
+    QString recordingFilename(const QString &communicationID) const;
+
+    // Grapheme-to-phoneme rules for the vocabulary, in the format of RuleBasedPhonetiser
+    bool createPhonetisationRules(QString &error);
+    QString phonetisationRulesFilename() const;
+
+    // Creates the repository on first call: metadata, annotation levels and the annotation of every communication
+    Praaline::Core::CorpusRepository *repository(QString &error);
+    Praaline::Core::Corpus *corpus(QString &error);
+
+private:
+    SyntheticCorpusData *d;
+};
+
+#endif // SYNTHETICCORPUS_H
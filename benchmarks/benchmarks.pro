@@ -0,0 +1,129 @@
+# Praaline Benchmarks
+# (c) George Christodoulides 2012-2020
+
+! include( ../common.pri ) {
+    error( Could not find the common.pri file! )
+}
+
+TARGET = praaline-benchmarks
+TEMPLATE = app
+
+CONFIG += qt thread warn_on stl rtti exceptions console c++14
+CONFIG -= app_bundle
+
+QT += core sql xml network concurrent
+greaterThan(QT_MAJOR_VERSION, 4) {
+    QT += widgets
+}
+
+# The revision is recorded in the reports, to compare runs over time
+BENCHMARKS_REVISION = $$system(git -C $$PWD rev-parse --short HEAD)
+!isEmpty(BENCHMARKS_REVISION) {
+    DEFINES += PRAALINE_BENCHMARKS_REVISION=\\\"$${BENCHMARKS_REVISION}\\\"
+}
+
+DEPENDPATH += . .. ../app ../pnlib
+INCLUDEPATH += . .. ../app ../pnlib
+
+# Dependency: Praaline Core
+DEFINES += USE_NAMESPACE_PRAALINE_CORE
+INCLUDEPATH += ../praaline-core/include
+DEPENDPATH += ../praaline-core
+
+# Dependency: Praaline Media
+DEFINES += USE_NAMESPACE_PRAALINE_MEDIA
+INCLUDEPATH += ../praaline-media/include
+DEPENDPATH += ../praaline-media
+
+# Dependency: Praaline ASR
+DEFINES += USE_NAMESPACE_PRAALINE_ASR
+INCLUDEPATH += ../praaline-asr/include
+DEPENDPATH += ../praaline-asr
+
+# Sonic Visualiser libraries
+include (../app/svinclude.pri)
+
+# Linking dynamically with PocketSphinx (needed by Praaline ASR)
+win32-g++ {
+    LIBS += -L$$PWD/../dependency-builds/pn/win32-mingw/lib -lpocketsphinx -lsphinxbase -liconv
+}
+win32-msvc* {
+    LIBS += -L$$PWD/../dependency-builds/pn/win32-msvc/lib -lpocketsphinx -lsphinxbase -liconv
+}
+unix {
+    LIBS += -L/usr/local/lib -lpocketsphinx -lsphinxbase
+}
+
+# Application components
+LIBS +=  \
+        -L../pnlib/diff/$${COMPONENTSPATH} -lpraaline-diff \
+        -L../praaline-asr/$${COMPONENTSPATH} -lpraaline-asr$${PRAALINE_LIB_POSTFIX} \
+        -L../praaline-media/$${COMPONENTSPATH} -lpraaline-media$${PRAALINE_LIB_POSTFIX} \
+        -L../praaline-core/$${COMPONENTSPATH} -lpraaline-core$${PRAALINE_LIB_POSTFIX} \
+        $$LIBS
+PRE_TARGETDEPS += \
+        ../pnlib/diff/$${COMPONENTSPATH}/libpraaline-diff.a \
+        ../praaline-asr/$${COMPONENTSPATH}/libpraaline-asr$${PRAALINE_LIB_POSTFIX}.$${LIB_SUFFIX} \
+        ../praaline-media/$${COMPONENTSPATH}/libpraaline-media$${PRAALINE_LIB_POSTFIX}.$${LIB_SUFFIX} \
+        ../praaline-core/$${COMPONENTSPATH}/libpraaline-core$${PRAALINE_LIB_POSTFIX}.$${LIB_SUFFIX}
+
+# DisMo is a plugin: its annotator is compiled in, without the plugin interface
+DISMO_PATH = ../plugins/dismo
+INCLUDEPATH += $${DISMO_PATH}
+DEPENDPATH += $${DISMO_PATH}
+unix {
+    DEFINES += HAVE_CRFPP_CONFIG_H
+}
+
+HEADERS += \
+    Benchmark.h \
+    BenchmarkGroups.h \
+    SyntheticCorpus.h \
+    ../app/statistics/StatisticalAnalyserBase.h \
+    ../app/statistics/StatisticalMeasureAggregator.h \
+    ../app/statistics/StatisticalMeasureCube.h \
+    ../app/statistics/temporal/AnalyserTemporal.h \
+    ../app/statistics/temporal/AnalyserTemporalItem.h
+
+SOURCES += \
+    main.cpp \
+    Benchmark.cpp \
+    SyntheticCorpus.cpp \
+    AnnotationBenchmarks.cpp \
+    LinguisticBenchmarks.cpp \
+    DiffBenchmarks.cpp \
+    AudioBenchmarks.cpp \
+    StatisticsBenchmarks.cpp \
+    ../app/statistics/StatisticalAnalyserBase.cpp \
+    ../app/statistics/StatisticalMeasureAggregator.cpp \
+    ../app/statistics/StatisticalMeasureCube.cpp \
+    ../app/statistics/temporal/AnalyserTemporal.cpp \
+    ../app/statistics/temporal/AnalyserTemporalItem.cpp
+
+SOURCES += \
+    $${DISMO_PATH}/crfpp/encoder.cpp \
+    $${DISMO_PATH}/crfpp/feature.cpp \
+    $${DISMO_PATH}/crfpp/feature_cache.cpp \
+    $${DISMO_PATH}/crfpp/feature_index.cpp \
+    $${DISMO_PATH}/crfpp/lbfgs.cpp \
+    $${DISMO_PATH}/crfpp/libcrfpp.cpp \
+    $${DISMO_PATH}/crfpp/node.cpp \
+    $${DISMO_PATH}/crfpp/param.cpp \
+    $${DISMO_PATH}/crfpp/path.cpp \
+    $${DISMO_PATH}/crfpp/tagger.cpp \
+    $${DISMO_PATH}/dismo/CRFFeatureSet.cpp \
+    $${DISMO_PATH}/dismo/BoundaryDetector.cpp \
+    $${DISMO_PATH}/dismo/CRFAnnotator.cpp \
+    $${DISMO_PATH}/dismo/DictionaryFST.cpp \
+    $${DISMO_PATH}/dismo/DictionarySQL.cpp \
+    $${DISMO_PATH}/dismo/DiscourseTagger.cpp \
+    $${DISMO_PATH}/dismo/DisfluencyDetector.cpp \
+    $${DISMO_PATH}/dismo/DisMoAnnotator.cpp \
+    $${DISMO_PATH}/dismo/DisMoConfiguration.cpp \
+    $${DISMO_PATH}/dismo/POSTagger.cpp \
+    $${DISMO_PATH}/dismo/PostProcessor.cpp \
+    $${DISMO_PATH}/dismo/PreProcessor.cpp \
+    $${DISMO_PATH}/dismo/Token.cpp \
+    $${DISMO_PATH}/dismo/Tokenizer.cpp \
+    $${DISMO_PATH}/dismo/TokenList.cpp \
+    $${DISMO_PATH}/dismo/TokenUnit.cpp
@@ -0,0 +1,140 @@
+// Praaline benchmarks
+// Headless timing of the core workflows over a reproducible synthetic corpus, with a JSON report that can be
+// compared against the report of a previous run.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QThread>
+#include <QTextStream>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include "SyntheticCorpus.h"
+#include "Benchmark.h"
+#include "BenchmarkGroups.h"
+
+#ifndef PRAALINE_BENCHMARKS_REVISION
+#define PRAALINE_BENCHMARKS_REVISION "unknown"
+#endif
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Praaline");
+    QCoreApplication::setApplicationName("praaline-benchmarks");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Praaline benchmarks");
+    parser.addHelpOption();
+    QCommandLineOption optionList("list", "List the benchmarks and exit.");
+    QCommandLineOption optionFilter(QStringList() << "f" << "filter", "Run the benchmarks matching the pattern "
+                                    "(group, or group/name with wildcards). Can be repeated.", "pattern");
+    QCommandLineOption optionIterations(QStringList() << "i" << "iterations", "Timed iterations (default 5).", "n", "5");
+    QCommandLineOption optionWarmup("warmup", "Untimed iterations before timing (default 1).", "n", "1");
+    QCommandLineOption optionSeed("seed", "Seed of the synthetic corpus.", "n",
+                                  QString::number(SyntheticCorpus::Parameters().seed));
+    QCommandLineOption optionCommunications("communications", "Communications in the synthetic corpus (default 8).", "n", "8");
+    QCommandLineOption optionSpeakers("speakers", "Speakers per communication (default 2).", "n", "2");
+    QCommandLineOption optionDuration("duration", "Duration of each communication in seconds (default 300).", "s", "300");
+    QCommandLineOption optionOutput(QStringList() << "o" << "output", "Write the JSON report to this file "
+                                    "instead of the standard output.", "file");
+    QCommandLineOption optionBaseline("baseline", "Compare with the JSON report of a previous run; the exit code "
+                                      "is 2 when a benchmark is slower than the threshold allows.", "file");
+    QCommandLineOption optionThreshold("threshold", "Relative slowdown of the median counted as a regression, "
+                                       "in percent (default 10).", "percent", "10");
+    parser.addOptions(QList<QCommandLineOption>() << optionList << optionFilter << optionIterations << optionWarmup
+                      << optionSeed << optionCommunications << optionSpeakers << optionDuration
+                      << optionOutput << optionBaseline << optionThreshold);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    BenchmarkRunner runner;
+    registerAnnotationBenchmarks(runner);
+    registerLinguisticBenchmarks(runner);
+    registerDiffBenchmarks(runner);
+    registerAudioBenchmarks(runner);
+    registerStatisticsBenchmarks(runner);
+
+    BenchmarkRunner::Options options;
+    foreach (QString filter, parser.values(optionFilter)) options.filters << filter.split(",", QString::SkipEmptyParts);
+    options.iterations = qMax(1, parser.value(optionIterations).toInt());
+    options.warmupIterations = qMax(0, parser.value(optionWarmup).toInt());
+
+    if (parser.isSet(optionList)) {
+        foreach (QString ID, runner.benchmarkIDs(options.filters)) out << ID << endl;
+        return 0;
+    }
+
+    SyntheticCorpus::Parameters parameters;
+    parameters.seed = parser.value(optionSeed).toUInt();
+    parameters.communications = qMax(1, parser.value(optionCommunications).toInt());
+    parameters.speakersPerCommunication = qMax(1, parser.value(optionSpeakers).toInt());
+    parameters.duration = qMax(10.0, parser.value(optionDuration).toDouble());
+    SyntheticCorpus corpus(parameters);
+    if (!corpus.isValid()) {
+        err << corpus.errorString() << endl;
+        return 1;
+    }
+
+    QList<BenchmarkResult> results = runner.run(&corpus, options);
+
+    // Conditions of the run, so that reports are only compared when they are comparable
+    QJsonObject metadata;
+    metadata.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    metadata.insert("revision", QString(PRAALINE_BENCHMARKS_REVISION));
+#ifdef QT_NO_DEBUG
+    metadata.insert("build", "release");
+#else
+    metadata.insert("build", "debug");
+#endif
+    metadata.insert("qt_version", QString(qVersion()));
+    metadata.insert("os", QSysInfo::prettyProductName());
+    metadata.insert("cpu_architecture", QSysInfo::currentCpuArchitecture());
+    metadata.insert("host", QSysInfo::machineHostName());
+    metadata.insert("threads", QThread::idealThreadCount());
+    metadata.insert("iterations", options.iterations);
+    metadata.insert("warmup_iterations", options.warmupIterations);
+    QJsonObject corpusParameters;
+    corpusParameters.insert("seed", double(parameters.seed));
+    corpusParameters.insert("communications", parameters.communications);
+    corpusParameters.insert("speakers_per_communication", parameters.speakersPerCommunication);
+    corpusParameters.insert("duration", parameters.duration);
+    corpusParameters.insert("sample_rate", parameters.sampleRate);
+    metadata.insert("corpus", corpusParameters);
+
+    QJsonDocument report = BenchmarkRunner::report(results, metadata);
+    if (parser.isSet(optionOutput)) {
+        QSaveFile file(parser.value(optionOutput));
+        if (!file.open(QIODevice::WriteOnly) || file.write(report.toJson()) < 0 || !file.commit()) {
+            err << "Could not write " << parser.value(optionOutput) << endl;
+            return 1;
+        }
+    } else {
+        out << report.toJson();
+        out.flush();
+    }
+
+    if (parser.isSet(optionBaseline)) {
+        QFile file(parser.value(optionBaseline));
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << "Could not read " << file.fileName() << endl;
+            return 1;
+        }
+        QList<BenchmarkResult> baseline = BenchmarkRunner::resultsFromReport(QJsonDocument::fromJson(file.readAll()));
+        QStringList messages;
+        QStringList regressed = BenchmarkRunner::regressions(baseline, results,
+                                                             parser.value(optionThreshold).toDouble() / 100.0, messages);
+        foreach (QString message, messages) err << message << endl;
+        if (!regressed.isEmpty()) {
+            err << regressed.count() << " regression(s)" << endl;
+            return 2;
+        }
+    }
+    return 0;
+}
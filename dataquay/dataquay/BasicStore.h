@@ -36,6 +36,8 @@
 
 #include "Store.h"
 
+#include <QSharedPointer>
+
 namespace Dataquay
 {
 	
@@ -50,7 +52,10 @@ namespace Dataquay
  * on whether USE_REDLAND or USE_SORD was defined when Dataquay was
  * built.
  *
- * All operations are thread safe.
+ * All operations are thread safe.  By default they are also
+ * serialised, across all BasicStores, by a lock on the underlying
+ * datastore; see setConcurrentReads for a mode in which reads are
+ * not.
  */
 class BasicStore : public Store
 {
@@ -94,6 +99,64 @@ public:
      */
     void addPrefix(QString prefix, Uri uri);
 
+    /**
+     * Snapshot is an immutable copy of the triples in a store at the
+     * moment it was taken, indexed for matching by subject, predicate
+     * and object.  Snapshots are cheap to copy and may be queried
+     * from any number of threads at once without locking, whatever
+     * happens to the store afterwards.
+     */
+    class Snapshot
+    {
+    public:
+        /**
+         * Construct an empty snapshot.
+         */
+        Snapshot();
+
+        /**
+         * Construct a snapshot of the given triples, which must be
+         * complete and contain no duplicates.
+         */
+        explicit Snapshot(const Triples &triples);
+
+        int size() const;
+
+        bool contains(Triple t) const;
+        Triples match(Triple t) const;
+        Triple matchOnce(Triple t) const;
+        Node complete(Triple t) const;
+
+    private:
+        class Index;
+        QSharedPointer<const Index> m_index;
+    };
+
+    /**
+     * Return a snapshot of the current contents of the store.
+     */
+    Snapshot getSnapshot() const;
+
+    /**
+     * Switch concurrent reads on or off (they are off by default).
+     *
+     * With concurrent reads on, contains, match, matchOnce and
+     * complete are answered from a snapshot of the store where one is
+     * available, without taking the datastore lock, so that any
+     * number of threads may read at once.  The snapshot is taken
+     * when an empty store is loaded by import, and whenever the
+     * store has been read a number of times without being modified
+     * in between; any modification discards it.  This suits stores that are loaded
+     * and then mostly read.  A TransactionalStore wrapping a store
+     * with concurrent reads answers its non-transactional reads from
+     * a snapshot of the last committed state, without waiting for
+     * transactions in progress.
+     *
+     * With the Redland backend, reads always take the lock.
+     */
+    void setConcurrentReads(bool concurrent);
+    bool getConcurrentReads() const;
+
     // Store interface
 
     bool add(Triple t);
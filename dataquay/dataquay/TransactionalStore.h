@@ -57,7 +57,12 @@ namespace Dataquay
  * Read access may be carried out through a Transaction, in which case
  * the read state will reflect the changes made so far in that
  * transaction, or directly on the TransactionalStore, in which case
- * the read will be isolated from any pending transaction.
+ * the read will be isolated from any pending transaction.  If the
+ * underlying store is a BasicStore with concurrent reads enabled
+ * (see BasicStore::setConcurrentReads), direct reads through
+ * contains, match, matchOnce and complete are answered from a
+ * snapshot of the last committed state, and so may run concurrently
+ * with each other and with a transaction in progress.
  *
  * Call startTransaction to obtain a new Transaction object and start
  * its transaction; use the Transaction's Store interface for all
@@ -44,7 +44,8 @@ HEADERS += dataquay/BasicStore.h \
            src/Debug.h \
     dataquay/objectmapper/ObjectMapperExceptions.h
            
-SOURCES += src/Connection.cpp \
+SOURCES += src/BasicStoreSnapshot.cpp \
+           src/Connection.cpp \
            src/Node.cpp \
            src/PropertyObject.cpp \
            src/RDFException.cpp \
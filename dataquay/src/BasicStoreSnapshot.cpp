@@ -0,0 +1,172 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Dataquay
+
+    A C++/Qt library for simple RDF datastore management.
+    Copyright 2009-2012 Chris Cannam.
+  
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use, copy,
+    modify, merge, publish, distribute, sublicense, and/or sell copies
+    of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR
+    ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+    CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+    Except as contained in this notice, the name of Chris Cannam
+    shall not be used in advertising or otherwise to promote the sale,
+    use or other dealings in this Software without prior written
+    authorization.
+*/
+
+
+#include "BasicStore.h"
+#include "RDFException.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace Dataquay
+{
+
+class BasicStore::Snapshot::Index
+{
+public:
+    Triples triples;
+
+    // For each of subject, predicate and object, the positions in
+    // triples of the triples having each node in that place
+    QHash<Node, QVector<int> > positions[3];
+
+    static const Node &nodeAt(const Triple &t, int i) {
+        switch (i) {
+        case 0: return t.a;
+        case 1: return t.b;
+        default: return t.c;
+        }
+    }
+
+    static bool matches(const Triple &candidate, const Triple &t) {
+        if (t.a.type != Node::Nothing && candidate.a != t.a) return false;
+        if (t.b.type != Node::Nothing && candidate.b != t.b) return false;
+        if (t.c.type != Node::Nothing && candidate.c != t.c) return false;
+        return true;
+    }
+
+    Triples match(const Triple &t, bool single) const {
+
+        // Scan the shortest of the position lists for the nodes that
+        // are given, or everything if there are none
+
+        const QVector<int> *shortest = 0;
+
+        for (int i = 0; i < 3; ++i) {
+            const Node &n = nodeAt(t, i);
+            if (n.type == Node::Nothing) continue;
+            QHash<Node, QVector<int> >::const_iterator pi = positions[i].find(n);
+            if (pi == positions[i].end()) return Triples();
+            if (!shortest || pi->size() < shortest->size()) {
+                shortest = &(*pi);
+            }
+        }
+
+        Triples results;
+
+        if (!shortest) {
+            if (single) {
+                if (!triples.empty()) results.push_back(triples[0]);
+                return results;
+            }
+            return triples;
+        }
+
+        for (int i = 0; i < shortest->size(); ++i) {
+            const Triple &candidate = triples[(*shortest)[i]];
+            if (matches(candidate, t)) {
+                results.push_back(candidate);
+                if (single) break;
+            }
+        }
+
+        return results;
+    }
+};
+
+BasicStore::Snapshot::Snapshot() :
+    m_index(new Index)
+{
+}
+
+BasicStore::Snapshot::Snapshot(const Triples &triples)
+{
+    Index *index = new Index;
+    index->triples = triples;
+    for (int i = 0; i < triples.size(); ++i) {
+        const Triple &t = triples[i];
+        index->positions[0][t.a].push_back(i);
+        index->positions[1][t.b].push_back(i);
+        index->positions[2][t.c].push_back(i);
+    }
+    m_index = QSharedPointer<const Index>(index);
+}
+
+int
+BasicStore::Snapshot::size() const
+{
+    return m_index->triples.size();
+}
+
+bool
+BasicStore::Snapshot::contains(Triple t) const
+{
+    if (t.a.type == Node::Nothing || t.a.type == Node::Literal ||
+        t.b.type != Node::URI ||
+        t.c.type == Node::Nothing) {
+        throw RDFException("Failed to test for triple (statement is incomplete)");
+    }
+    return !m_index->match(t, true).empty();
+}
+
+Triples
+BasicStore::Snapshot::match(Triple t) const
+{
+    return m_index->match(t, false);
+}
+
+Triple
+BasicStore::Snapshot::matchOnce(Triple t) const
+{
+    Triples result = m_index->match(t, true);
+    if (result.empty()) return Triple();
+    else return result[0];
+}
+
+Node
+BasicStore::Snapshot::complete(Triple t) const
+{
+    int count = 0, match = 0;
+    if (t.a == Node()) { ++count; match = 0; }
+    if (t.b == Node()) { ++count; match = 1; }
+    if (t.c == Node()) { ++count; match = 2; }
+    if (count != 1) {
+        throw RDFException("Cannot complete triple unless it has only a single wildcard node", t);
+    }
+    Triples result = m_index->match(t, true);
+    if (result.empty()) return Node();
+    return Index::nodeAt(result[0], match);
+}
+
+}
+
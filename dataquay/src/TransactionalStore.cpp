@@ -38,6 +38,9 @@
 
 #include <QMutex>
 #include <QMutexLocker>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
 
 #include <iostream>
 #include <memory> // auto_ptr
@@ -68,7 +71,9 @@ public:
         m_store(store),
         m_dwb(dwb),
         m_currentTx(NoTransaction),
-        m_context(NonTxContext) {
+        m_context(NonTxContext),
+        m_basicStore(dynamic_cast<BasicStore *>(store)),
+        m_haveCommittedSnapshot(false) {
     }
     
     ~D() {
@@ -98,6 +103,7 @@ public:
             }
             enterTransactionContext();
             cs = m_currentTx->getChanges();
+            if (!cs.empty()) discardCommittedSnapshot();
             // The store is now in transaction context, which means
             // its changes have been committed; resetting m_currentTx
             // now ensures they will remain committed.  Reset
@@ -250,6 +256,31 @@ public:
 
     Store *getStore() { return m_store; }
     const Store *getStore() const { return m_store; }
+
+    bool getCommittedSnapshot(BasicStore::Snapshot &s) {
+        // Non-transactional reads are answered from a snapshot of
+        // the committed state, if the store is a BasicStore with
+        // concurrent reads, so that they neither wait for nor undo
+        // the transaction in progress.  The snapshot is taken on the
+        // first such read after each commit
+        if (!m_basicStore || !m_basicStore->getConcurrentReads()) {
+            return false;
+        }
+        {
+            QReadLocker locker(&m_snapshotLock);
+            if (m_haveCommittedSnapshot) {
+                s = m_committedSnapshot;
+                return true;
+            }
+        }
+        NonTransactionalAccess ntxa(this);
+        s = m_basicStore->getSnapshot();
+        // Still holding m_mutex, so no commit can have intervened
+        QWriteLocker locker(&m_snapshotLock);
+        m_committedSnapshot = s;
+        m_haveCommittedSnapshot = true;
+        return true;
+    }
     
 private:
     // Most things are mutable here because the TransactionalStore
@@ -263,6 +294,18 @@ private:
     const Transaction *m_currentTx;
     mutable Context m_context;
 
+    BasicStore *m_basicStore; // m_store, if it is a BasicStore
+    QReadWriteLock m_snapshotLock; // protects the following two
+    BasicStore::Snapshot m_committedSnapshot;
+    bool m_haveCommittedSnapshot;
+
+    void discardCommittedSnapshot() {
+        // This is always called with m_mutex held
+        QWriteLocker locker(&m_snapshotLock);
+        m_committedSnapshot = BasicStore::Snapshot();
+        m_haveCommittedSnapshot = false;
+    }
+
     void startOperation(const Transaction *tx) const {
         // This will succeed immediately if the mutex is already held
         // by this thread from a startTransaction call (because it is
@@ -689,6 +732,8 @@ TransactionalStore::revert(ChangeSet cs)
 bool
 TransactionalStore::contains(Triple t) const
 {
+    BasicStore::Snapshot s;
+    if (m_d->getCommittedSnapshot(s)) return s.contains(t);
     D::NonTransactionalAccess ntxa(m_d);
     return m_d->getStore()->contains(t);
 }
@@ -696,6 +741,8 @@ TransactionalStore::contains(Triple t) const
 Triples
 TransactionalStore::match(Triple t) const
 {
+    BasicStore::Snapshot s;
+    if (m_d->getCommittedSnapshot(s)) return s.match(t);
     D::NonTransactionalAccess ntxa(m_d);
     return m_d->getStore()->match(t);
 }
@@ -710,6 +757,8 @@ TransactionalStore::query(QString s) const
 Node
 TransactionalStore::complete(Triple t) const
 {
+    BasicStore::Snapshot s;
+    if (m_d->getCommittedSnapshot(s)) return s.complete(t);
     D::NonTransactionalAccess ntxa(m_d);
     return m_d->getStore()->complete(t);
 }
@@ -717,6 +766,8 @@ TransactionalStore::complete(Triple t) const
 Triple
 TransactionalStore::matchOnce(Triple t) const
 {
+    BasicStore::Snapshot s;
+    if (m_d->getCommittedSnapshot(s)) return s.matchOnce(t);
     D::NonTransactionalAccess ntxa(m_d);
     return m_d->getStore()->matchOnce(t);
 }
@@ -57,7 +57,7 @@ namespace Dataquay
 class BasicStore::D
 {
 public:
-    D() : m_storage(0), m_model(0), m_counter(0) {
+    D() : m_storage(0), m_model(0), m_counter(0), m_concurrentReads(false) {
         m_prefixes["rdf"] = Uri("http://www.w3.org/1999/02/22-rdf-syntax-ns#");
         m_prefixes["xsd"] = Uri("http://www.w3.org/2001/XMLSchema#");
         clear();
@@ -126,6 +126,23 @@ public:
         m_prefixes[prefix] = uri;
     }
 
+    // Reads with Redland always take the lock; the setting is only
+    // recorded, so that a TransactionalStore can still use snapshots
+    void setConcurrentReads(bool concurrent) {
+        QMutexLocker locker(&m_librdfLock);
+        m_concurrentReads = concurrent;
+    }
+
+    bool getConcurrentReads() const {
+        QMutexLocker locker(&m_librdfLock);
+        return m_concurrentReads;
+    }
+
+    Snapshot getSnapshot() const {
+        QMutexLocker locker(&m_librdfLock);
+        return Snapshot(doMatch(Triple()));
+    }
+
     bool add(Triple t) {
         QMutexLocker locker(&m_librdfLock);
         DEBUG << "BasicStore::add: " << t << endl;
@@ -594,6 +611,7 @@ private:
     mutable QMutex m_prefixLock; // also protects m_baseUri
 
     mutable int m_counter;
+    bool m_concurrentReads;
 
     bool doAdd(Triple t) {
         librdf_statement *statement = tripleToStatement(t);
@@ -865,6 +883,24 @@ BasicStore::clear()
     m_d->clear();
 }
 
+BasicStore::Snapshot
+BasicStore::getSnapshot() const
+{
+    return m_d->getSnapshot();
+}
+
+void
+BasicStore::setConcurrentReads(bool concurrent)
+{
+    m_d->setConcurrentReads(concurrent);
+}
+
+bool
+BasicStore::getConcurrentReads() const
+{
+    return m_d->getConcurrentReads();
+}
+
 bool
 BasicStore::add(Triple t)
 {
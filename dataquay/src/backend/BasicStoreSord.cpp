@@ -45,6 +45,9 @@
 #include <QFile>
 #include <QCryptographicHash>
 #include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QAtomicInt>
 
 #include "../Debug.h"
 
@@ -58,7 +61,8 @@ namespace Dataquay
 class BasicStore::D
 {
 public:
-    D() : m_model(0) {
+    D() : m_model(0), m_concurrentReads(false), m_haveSnapshot(false),
+          m_readsSinceChange(0) {
         m_prefixes["rdf"] = Uri("http://www.w3.org/1999/02/22-rdf-syntax-ns#");
         m_prefixes["xsd"] = Uri("http://www.w3.org/2001/XMLSchema#");
         clear();
@@ -109,6 +113,7 @@ public:
     void clear() {
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::clear" << Qt::endl;
+        discardSnapshot();
         if (m_model) sord_free(m_model);
         // Sord can only perform wildcard matches if at least one of
         // the non-wildcard nodes in the matched triple is the primary
@@ -122,10 +127,33 @@ public:
         m_prefixes[prefix] = uri;
     }
 
+    void setConcurrentReads(bool concurrent) {
+        QMutexLocker locker(&m_backendLock);
+        discardSnapshot();
+        QWriteLocker slocker(&m_snapshotLock);
+        m_concurrentReads = concurrent;
+    }
+
+    bool getConcurrentReads() const {
+        QReadLocker slocker(&m_snapshotLock);
+        return m_concurrentReads;
+    }
+
+    Snapshot getSnapshot() const {
+        Snapshot s;
+        if (getCurrentSnapshot(s)) return s;
+        QMutexLocker locker(&m_backendLock);
+        s = Snapshot(doMatch(Triple()));
+        if (m_concurrentReads) publishSnapshot(s);
+        return s;
+    }
+
     bool add(Triple t) {
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::add: " << t << Qt::endl;
-        return doAdd(t);
+        if (!doAdd(t)) return false;
+        discardSnapshot();
+        return true;
     }
 
     bool remove(Triple t) {
@@ -136,6 +164,7 @@ public:
             t.c.type == Node::Nothing) {
             Triples tt = doMatch(t);
             if (tt.empty()) return false;
+            discardSnapshot();
             DEBUG << "BasicStore::remove: Removing " << tt.size() << " triple(s)" << Qt::endl;
             for (int i = 0; i < tt.size(); ++i) {
                 if (!doRemove(tt[i])) {
@@ -145,13 +174,16 @@ public:
             }
             return true;
         } else {
-            return doRemove(t);
+            if (!doRemove(t)) return false;
+            discardSnapshot();
+            return true;
         }
     }
 
     void change(ChangeSet cs) {
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::change: " << cs.size() << " changes" << Qt::endl;
+        discardSnapshot();
         for (int i = 0; i < cs.size(); ++i) {
             ChangeType type = cs[i].first;
             Triple triple = cs[i].second;
@@ -173,6 +205,7 @@ public:
     void revert(ChangeSet cs) {
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::revert: " << cs.size() << " changes" << Qt::endl;
+        discardSnapshot();
         for (int i = cs.size()-1; i >= 0; --i) {
             ChangeType type = cs[i].first;
             Triple triple = cs[i].second;
@@ -192,23 +225,28 @@ public:
     }
 
     bool contains(Triple t) const {
+        Snapshot s;
+        if (getCurrentSnapshot(s)) return s.contains(t);
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::contains: " << t << Qt::endl;
+        noteLockedRead();
         SordQuad statement;
         tripleToStatement(t, statement);
         if (!checkComplete(statement)) {
+            freeStatement(statement);
             throw RDFException("Failed to test for triple (statement is incomplete)");
         }
-        if (!sord_contains(m_model, statement)) {
-            return false;
-        }
+        bool found = sord_contains(m_model, statement);
         freeStatement(statement);
-        return true;
+        return found;
     }
     
     Triples match(Triple t) const {
+        Snapshot s;
+        if (getCurrentSnapshot(s)) return s.match(t);
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::match: " << t << Qt::endl;
+        noteLockedRead();
         Triples result = doMatch(t);
 #ifndef NDEBUG
         DEBUG << "BasicStore::match result (size " << result.size() << "):" << endl;
@@ -227,8 +265,11 @@ public:
         if (count != 1) {
             throw RDFException("Cannot complete triple unless it has only a single wildcard node", t);
         }
+        Snapshot s;
+        if (getCurrentSnapshot(s)) return s.complete(t);
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::complete: " << t << Qt::endl;
+        noteLockedRead();
         Triples result = doMatch(t, true);
         if (result.empty()) return Node();
         else switch (match) {
@@ -245,8 +286,11 @@ public:
             if (contains(t)) return t;
             else return Triple();
         }
+        Snapshot s;
+        if (getCurrentSnapshot(s)) return s.matchOnce(t);
         QMutexLocker locker(&m_backendLock);
         DEBUG << "BasicStore::matchOnce: " << t << Qt::endl;
+        noteLockedRead();
         Triples result = doMatch(t, true);
 #ifndef NDEBUG
         DEBUG << "BasicStore::matchOnce result:" << endl;
@@ -454,12 +498,13 @@ public:
 
         DEBUG << "BasicStoreSord::import: " << url << Qt::endl;
 
-        QMutexLocker wlocker(&m_backendLock);
-        QMutexLocker plocker(&m_prefixLock);
-
         //!!! todo: format?
-        
-        QString base = m_baseUri.toString();
+
+        QString base;
+        {
+            QMutexLocker plocker(&m_prefixLock);
+            base = m_baseUri.toString();
+        }
         if (base == "") {
             // No base URI in store: use file URL as base
             base = url.toString();
@@ -491,6 +536,9 @@ public:
             // No special handling for duplicates, do whatever the
             // underlying engine does
 
+            QMutexLocker wlocker(&m_backendLock);
+            discardSnapshot();
+
             SerdReader *reader = sord_new_reader(m_model, env, SERD_TURTLE, NULL);
 
             // if we have data in the store already, then we must add
@@ -520,72 +568,95 @@ public:
             // ImportFailOnDuplicates and ImportIgnoreDuplicates:
             // import into a separate model and transfer across
 
-            SordModel *im = sord_new(m_w.getWorld(), 0, false); // no index
-            
-            SerdReader *reader = sord_new_reader(im, env, SERD_TURTLE, NULL);
+            bulkImport(url, fileUri, env, idm);
+        }
 
-            // if we have data in the store already, then we must add
-            // a prefix for the new blank nodes we're importing to
-            // disambiguate them
-            if (!doMatch(Triple(), true).empty()) {
-                serd_reader_add_blank_prefix
-                    (reader, (uint8_t *)(getNewString().toUtf8().data()));
-            }
+        QMutexLocker plocker(&m_prefixLock);
+	serd_env_foreach(env, addPrefixSink, this);
+        serd_env_free(env);
+    }
 
-            SerdStatus rv = serd_reader_read_file
-                (reader, (const uint8_t *)fileUri.toLocal8Bit().data());
-            
-            if (rv != SERD_SUCCESS) {
-                serd_reader_free(reader);
-                sord_free(im);
-                serd_env_free(env);
-                throw RDFException
-                    (QString("Failed to import model from URL: %1")
-                     .arg(serdStatusToString(rv)),
-                     url.toString());
-            }
+    void bulkImport(QUrl url, QString fileUri, SerdEnv *env,
+                    ImportDuplicatesMode idm) {
 
-            serd_reader_free(reader);
+        // The file is parsed into an unindexed model in a Sord world
+        // of our own, without taking the backend lock, so that any
+        // number of imports can parse at once.  The triples are then
+        // added to the store in one pass with the lock held and, if
+        // reads are concurrent and the store was empty, the snapshot
+        // index is built once from them at the end
 
-            SordQuad templ;
-            tripleToStatement(Triple(), templ);
-
-            if (idm == ImportFailOnDuplicates) {
-
-                SordIter *itr = sord_find(im, templ);
-                while (!sord_iter_end(itr)) {
-                    SordQuad q;
-                    sord_iter_get(itr, q);
-                    if (sord_contains(m_model, q)) {
-                        Triple culprit = statementToTriple(q);
-                        sord_iter_free(itr);
-                        freeStatement(templ);
-                        sord_free(im);
-                        serd_env_free(env);
-                        throw RDFDuplicateImportException("Duplicate statement encountered on import in ImportFailOnDuplicates mode", culprit);
-                    }
-                    sord_iter_next(itr);
-                }
-                sord_iter_free(itr);
-            }
+        SordWorld *world = sord_world_new();
+        SordModel *im = sord_new(world, 0, false); // no index
+            
+        SerdReader *reader = sord_new_reader(im, env, SERD_TURTLE, NULL);
+
+        // The blank nodes we're importing always get a prefix of
+        // their own, even if the store is empty now: another import
+        // may be parsing at the same time, and its blank nodes would
+        // otherwise be merged with ours when both are added.  The
+        // counter makes the prefix unique within the process
+        static QAtomicInt importCount(0);
+        QString blankPrefix = QString("%1i%2")
+            .arg(getNewString()).arg(importCount.fetchAndAddRelaxed(1));
+        serd_reader_add_blank_prefix
+            (reader, (uint8_t *)(blankPrefix.toUtf8().data()));
+
+        SerdStatus rv = serd_reader_read_file
+            (reader, (const uint8_t *)fileUri.toLocal8Bit().data());
+
+        serd_reader_free(reader);
             
-            SordIter *itr = sord_find(im, templ);
-            while (!sord_iter_end(itr)) {
+        if (rv != SERD_SUCCESS) {
+            sord_free(im);
+            sord_world_free(world);
+            serd_env_free(env);
+            throw RDFException
+                (QString("Failed to import model from URL: %1")
+                 .arg(serdStatusToString(rv)),
+                 url.toString());
+        }
+
+        Triples imported;
+        SordQuad templ = { 0, 0, 0, 0 };
+        SordIter *itr = sord_find(im, templ);
+        while (!sord_iter_end(itr)) {
+            SordQuad q;
+            sord_iter_get(itr, q);
+            imported.push_back(statementToTriple(q));
+            sord_iter_next(itr);
+        }
+        sord_iter_free(itr);
+        sord_free(im);
+        sord_world_free(world);
+
+        QMutexLocker locker(&m_backendLock);
+
+        if (idm == ImportFailOnDuplicates) {
+            for (int i = 0; i < imported.size(); ++i) {
                 SordQuad q;
-                sord_iter_get(itr, q);
-                if (idm == ImportFailOnDuplicates || // (already tested if so)
-                    !sord_contains(m_model, q)) {
-                    sord_add(m_model, q);
+                tripleToStatement(imported[i], q);
+                bool found = sord_contains(m_model, q);
+                freeStatement(q);
+                if (found) {
+                    serd_env_free(env);
+                    throw RDFDuplicateImportException("Duplicate statement encountered on import in ImportFailOnDuplicates mode", imported[i]);
                 }
-                sord_iter_next(itr);
             }
-            sord_iter_free(itr);
-            freeStatement(templ);
-            sord_free(im);
         }
 
-	serd_env_foreach(env, addPrefixSink, this);
-        serd_env_free(env);
+        discardSnapshot();
+
+        bool wasEmpty = doMatch(Triple(), true).empty();
+        Triples added;
+        for (int i = 0; i < imported.size(); ++i) {
+            if (doAdd(imported[i])) added.push_back(imported[i]);
+        }
+
+        if (m_concurrentReads && wasEmpty) {
+            // The store holds exactly what we added
+            publishSnapshot(Snapshot(added));
+        }
     }
 
 private:
@@ -623,6 +694,47 @@ private:
     SordModel *m_model;
     static QMutex m_backendLock; // assume the worst
 
+    // Number of reads under the backend lock, with no modification
+    // in between, after which we take a snapshot for concurrent reads
+    enum { SnapshotAfterReads = 64 };
+
+    // m_concurrentReads, m_snapshot and m_haveSnapshot are protected
+    // by m_snapshotLock, and only ever written with m_backendLock
+    // held as well; m_readsSinceChange is protected by m_backendLock
+    mutable QReadWriteLock m_snapshotLock;
+    bool m_concurrentReads;
+    mutable Snapshot m_snapshot;
+    mutable bool m_haveSnapshot;
+    mutable int m_readsSinceChange;
+
+    bool getCurrentSnapshot(Snapshot &s) const {
+        QReadLocker slocker(&m_snapshotLock);
+        if (!m_concurrentReads || !m_haveSnapshot) return false;
+        s = m_snapshot;
+        return true;
+    }
+
+    void publishSnapshot(const Snapshot &s) const { // m_backendLock held
+        QWriteLocker slocker(&m_snapshotLock);
+        m_snapshot = s;
+        m_haveSnapshot = true;
+    }
+
+    void discardSnapshot() { // m_backendLock held
+        m_readsSinceChange = 0;
+        QWriteLocker slocker(&m_snapshotLock);
+        if (!m_haveSnapshot) return;
+        m_snapshot = Snapshot();
+        m_haveSnapshot = false;
+    }
+
+    void noteLockedRead() const { // m_backendLock held
+        if (!m_concurrentReads) return;
+        if (++m_readsSinceChange < SnapshotAfterReads) return;
+        DEBUG << "BasicStore: Taking snapshot for concurrent reads" << Qt::endl;
+        publishSnapshot(Snapshot(doMatch(Triple())));
+    }
+
     typedef QHash<QString, Uri> PrefixMap;
     Uri m_baseUri;
     PrefixMap m_prefixes;
@@ -635,6 +747,7 @@ private:
             throw RDFException("Failed to add triple (statement is incomplete)");
         }
         if (sord_contains(m_model, statement)) {
+            freeStatement(statement);
             return false;
         }
         sord_add(m_model, statement);
@@ -649,6 +762,7 @@ private:
             throw RDFException("Failed to remove triple (statement is incomplete)");
         }
         if (!sord_contains(m_model, statement)) {
+            freeStatement(statement);
             return false;
         }
         sord_remove(m_model, statement);
@@ -867,6 +981,24 @@ BasicStore::clear()
     m_d->clear();
 }
 
+BasicStore::Snapshot
+BasicStore::getSnapshot() const
+{
+    return m_d->getSnapshot();
+}
+
+void
+BasicStore::setConcurrentReads(bool concurrent)
+{
+    m_d->setConcurrentReads(concurrent);
+}
+
+bool
+BasicStore::getConcurrentReads() const
+{
+    return m_d->getConcurrentReads();
+}
+
 bool
 BasicStore::add(Triple t)
 {
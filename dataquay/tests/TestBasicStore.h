@@ -694,6 +694,57 @@ private slots:
 	QCOMPARE(triples.size(), 0);
     }
 
+    void snapshot() {
+        BasicStore s;
+        Uri knows("http://xmlns.com/foaf/0.1/knows");
+        Triple t(store.expand(":fred"), knows, store.expand(":alice"));
+        QVERIFY(s.add(t));
+        BasicStore::Snapshot snap = s.getSnapshot();
+        QCOMPARE(snap.size(), 1);
+
+        // the snapshot is unaffected by later changes to the store
+        Triple u(store.expand(":alice"), knows, store.expand(":fred"));
+        QVERIFY(s.add(u));
+        QVERIFY(s.contains(u));
+        QVERIFY(!snap.contains(u));
+        QVERIFY(snap.contains(t));
+        QCOMPARE(snap.match(Triple(Node(), knows, Node())).size(), 1);
+        QCOMPARE(snap.complete(Triple(store.expand(":fred"), knows, Node())),
+                 Node(store.expand(":alice")));
+        QCOMPARE(snap.matchOnce(Triple(store.expand(":alice"), Node(), Node())),
+                 Triple());
+    }
+
+    void concurrentReads() {
+        BasicStore s;
+        Uri knows("http://xmlns.com/foaf/0.1/knows");
+        for (int i = 0; i < 100; ++i) {
+            s.add(Triple(store.expand(QString(":p%1").arg(i)), knows,
+                         store.expand(QString(":p%1").arg((i + 1) % 100))));
+        }
+        s.setConcurrentReads(true);
+        QVERIFY(s.getConcurrentReads());
+
+        // enough reads to have the store take a snapshot, and then
+        // some more that should be answered from it
+        for (int n = 0; n < 200; ++n) {
+            int i = n % 100;
+            Node next = s.complete(Triple(store.expand(QString(":p%1").arg(i)),
+                                          knows, Node()));
+            QCOMPARE(next, Node(store.expand(QString(":p%1").arg((i + 1) % 100))));
+        }
+        QCOMPARE(s.match(Triple(Node(), knows, Node())).size(), 100);
+
+        // a change is visible to the next read
+        Triple t(store.expand(":p0"), knows, store.expand(":p50"));
+        QVERIFY(!s.contains(t));
+        QVERIFY(s.add(t));
+        QVERIFY(s.contains(t));
+        QCOMPARE(s.match(Triple(store.expand(":p0"), Node(), Node())).size(), 2);
+        QVERIFY(s.remove(t));
+        QVERIFY(!s.contains(t));
+    }
+
 private:
     BasicStore store;
     QString base;
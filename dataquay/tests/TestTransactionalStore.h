@@ -363,6 +363,33 @@ private slots:
         QCOMPARE(triples.size(), 0);
     }
 
+    void snapshotReads() {
+        BasicStore bs;
+        bs.setConcurrentReads(true);
+        TransactionalStore sts(&bs);
+        QCOMPARE(sts.match(Triple()).size(), 0);
+
+        Transaction *t = sts.startTransaction();
+        int added = 0;
+        QVERIFY(addThings(t, added));
+
+        // reads outside the transaction see the committed state,
+        // before and after reads through the transaction
+        QCOMPARE(sts.match(Triple()).size(), 0);
+        QCOMPARE(t->match(Triple()).size(), added);
+        QVERIFY(!sts.contains(Triple(store.expand(":fred"),
+                                     store.expand(":age"),
+                                     Node::fromVariant(QVariant(42)))));
+
+        t->commit();
+        delete t;
+
+        QCOMPARE(sts.match(Triple()).size(), added);
+        QVERIFY(sts.contains(Triple(store.expand(":fred"),
+                                    store.expand(":age"),
+                                    Node::fromVariant(QVariant(42)))));
+    }
+
 private:
     BasicStore store;
     TransactionalStore *ts;
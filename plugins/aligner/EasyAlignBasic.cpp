@@ -145,6 +145,7 @@ QString EasyAlignBasic::prepareAlignmentTextgrid(QList<Interval *> intervalsToAl
         phonetized.replace("|", " ");
         intv_utterance->setText(phonetized.trimmed());
     }
+    ExternalPhonetiser::saveCache();
     IntervalTier *tier_toAlign_wordsT = new IntervalTier("wordsT", intervalsWords,
                                                          tier_ortho->tMin(), tier_ortho->tMax());
     IntervalTier *tier_toAlign_phonesT = new IntervalTier("phonesT", intervalsPhones,
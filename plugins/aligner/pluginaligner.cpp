@@ -583,6 +583,7 @@ void Praaline::Plugins::Aligner::PluginAligner::addPhonetisationToTokens(const Q
         emit printMessage(QString("Phonetisation OK: %1").arg(com->ID()));
         QApplication::processEvents();
     }
+    ExternalPhonetiser::saveCache();
     emit madeProgress(100);
     emit printMessage("Finished");
 }
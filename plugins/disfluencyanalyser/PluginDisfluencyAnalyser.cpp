@@ -16,6 +16,8 @@
 #include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
 using namespace Praaline::Core;
 
+#include "pnlib/annotation/IntervalTierCursor.h"
+
 #include "Disfluency.h"
 #include "DisfluencyAnalyserTool.h"
 #include "DisfluencyPatternDetector.h"
@@ -146,6 +148,8 @@ void Praaline::Plugins::DisfluencyAnalyser::PluginDisfluencyAnalyser::concordanc
 
                 IntervalTier *tier_syll = 0;
                 if (withSyllData) tier_syll = tiers->getIntervalTierByName("syll");
+                // Disfluencies are read in time order: the cursor walks the syllable tier once (no syllables without it)
+                IntervalTierCursor cursorSyll(tier_syll);
 
                 DisfluencyAnalyserTool *DA = new DisfluencyAnalyserTool(tier_tok_min, this);
                 DA->readFromTier(tier_tok_min, "disfluency");
@@ -167,7 +171,7 @@ void Praaline::Plugins::DisfluencyAnalyser::PluginDisfluencyAnalyser::concordanc
                         startReparandum = reparandum.first()->tMin();
                         endReparandum = reparandum.last()->tMax();
 
-                        QList<Interval *> sylls = tier_syll->getIntervalsContainedIn(startReparandum, endReparandum);
+                        IntervalSpan sylls = cursorSyll.containedIn(startReparandum, endReparandum);
                         // int countSyll(0); // double sum(0.0);
                         foreach (Interval *syll, sylls) {
                             if (syll->attribute("f0_min").toInt() == 0) continue;
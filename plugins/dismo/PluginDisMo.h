@@ -7,6 +7,10 @@
 #include <QtilitiesCategory>
 #include <QObject>
 
+namespace DisMoAnnotator {
+class DismoAnnotator;
+}
+
 namespace Praaline {
     namespace Plugins {
         namespace DisMo {
@@ -56,6 +60,7 @@ namespace Praaline {
                 QList<PluginParameter> pluginParameters() const override;
                 void setParameters(const QHash<QString, QVariant> &parameters) override;
                 void process(const QList<CorpusCommunication *> &communications) override;
+                bool prepareResources(QString &errorMessage) override;
 
             signals:
                 void printMessage(const QString &message) override;
@@ -64,6 +69,7 @@ namespace Praaline {
             private:
                 PluginDisMoPrivateData* d;
 
+                DisMoAnnotator::DismoAnnotator *annotator();
                 void createDisMoAnnotationStructure(CorpusRepository *corpus);
                 void addMWUindications(QList<CorpusCommunication *> communications);
             };
@@ -2,6 +2,8 @@
 #include <QtPlugin>
 #include <QIcon>
 #include <QApplication>
+#include <QMutex>
+#include <QMutexLocker>
 #include <ExtensionSystemConstants>
 
 #include <QSqlQuery>
@@ -24,7 +26,7 @@ struct Praaline::Plugins::DisMo::PluginDisMoPrivateData {
     PluginDisMoPrivateData() :
         createDisMoAnnotationLevels(false), alreadyTokenised(false), tokenisedOnlyToMinimal(false),
         levelToAnnotate("segment"), levelTokMin("tok_min"), levelTokMWU("tok_mwu"),
-        levelPhones("phone"), attributePrefix("")
+        levelPhones("phone"), attributePrefix(""), annotator(0)
     {
         attributeNames["pos_min"] = "pos_min";
         attributeNames["pos_ext_min"] = "pos_ext_min";
@@ -45,6 +47,9 @@ struct Praaline::Plugins::DisMo::PluginDisMoPrivateData {
     QString levelPhones;
     QString attributePrefix;
     QHash<QString, QString> attributeNames;
+    // Loaded once (dictionaries and models) and kept for all later runs
+    DisMoAnnotator::DismoAnnotator *annotator;
+    QMutex annotatorMutex;
 };
 
 Praaline::Plugins::DisMo::PluginDisMo::PluginDisMo(QObject* parent) : QObject(parent)
@@ -71,6 +76,7 @@ bool Praaline::Plugins::DisMo::PluginDisMo::initializeDependencies(QStringList *
 }
 
 void Praaline::Plugins::DisMo::PluginDisMo::finalize() {
+    delete d->annotator;
     delete d;
 }
 
@@ -262,6 +268,21 @@ QString evaluateCRFfile(const QString &filename, double &precision, double &prec
 }
 
 
+DisMoAnnotator::DismoAnnotator *Praaline::Plugins::DisMo::PluginDisMo::annotator()
+{
+    QMutexLocker locker(&d->annotatorMutex);
+    if (!d->annotator) d->annotator = new DisMoAnnotator::DismoAnnotator("fr");
+    return d->annotator;
+}
+
+bool Praaline::Plugins::DisMo::PluginDisMo::prepareResources(QString &errorMessage)
+{
+    Q_UNUSED(errorMessage)
+    // Loads the dictionaries; the CRF models are read by crf_test on each run
+    annotator();
+    return true;
+}
+
 void Praaline::Plugins::DisMo::PluginDisMo::process(const QList<CorpusCommunication *> &communications)
 {
 //    addMWUindications(corpus, communications);
@@ -281,7 +302,7 @@ void Praaline::Plugins::DisMo::PluginDisMo::process(const QList<CorpusCommunicat
 //    return;
 
 
-    DisMoAnnotator::DismoAnnotator *DISMO = new DisMoAnnotator::DismoAnnotator("fr");
+    DisMoAnnotator::DismoAnnotator *DISMO = annotator();
     QPointer<IntervalTier> tier_tok_min;
     QPointer<IntervalTier> tier_tok_mwu;
     QList<QPointer<CorpusRepository> > repositoriesWithDisMoAnnotationStructure;
@@ -350,7 +371,6 @@ void Praaline::Plugins::DisMo::PluginDisMo::process(const QList<CorpusCommunicat
         countDone++;
         emit madeProgress(countDone * 100 / communications.count());
     }
-    delete DISMO;
     emit madeProgress(100);
     emit printMessage("DisMo finished.");
 }
@@ -15,6 +15,7 @@
 #include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
 using namespace Praaline::Core;
 
+#include "SyllableFeatureExtractor.h"
 #include "ProsodicBoundariesAnnotator.h"
 
 struct ProsodicBoundariesAnnotatorData {
@@ -187,58 +188,33 @@ void ProsodicBoundariesAnnotator::closeCRFDataFile()
 // PREPARE FEATURES
 // ========================================================================================================================================
 
+// static
+void ProsodicBoundariesAnnotator::prepareFeatures(SyllableFeatureExtractor &features, IntervalTier *tier_syll, IntervalTier *tier_token)
+{
+    features.setSmoothedAttributes(QStringList() << "f0_min" << "f0_max" << "f0_mean");
+    features.clearRelativeFeatures();
+    // Duration and log(duration)
+    features.addRelativeFeature("syll_dur_rel20", "duration", 2, 0, "", false);
+    features.addRelativeFeature("syll_dur_rel30", "duration", 3, 0, "", false);
+    features.addRelativeFeature("syll_dur_rel40", "duration", 4, 0, "", false);
+    features.addRelativeFeature("syll_dur_log_rel20", "duration_log", 2, 0, "", true);
+    features.addRelativeFeature("syll_dur_log_rel30", "duration_log", 3, 0, "", true);
+    features.addRelativeFeature("syll_dur_log_rel40", "duration_log", 4, 0, "", true);
+    // Pitch mean ST
+    features.addRelativeFeature("f0_mean_st_rel20", "f0_mean", 2, 0, "f0_min", true);
+    features.addRelativeFeature("f0_mean_st_rel30", "f0_mean", 3, 0, "f0_min", true);
+    features.addRelativeFeature("f0_mean_st_rel40", "f0_mean", 4, 0, "f0_min", true);
+    features.addRelativeFeature("f0_mean_st_rel50", "f0_mean", 5, 0, "f0_min", true);
+    // Following pause and f0 movement features are always extracted
+    features.extract(tier_syll, tier_token);
+}
+
 // static
 void ProsodicBoundariesAnnotator::prepareFeatures(QHash<QString, RealValueList> &features, IntervalTier *tier_syll)
 {
-    // Prepare data
-    for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
-        Interval *syll = tier_syll->interval(isyll);
-        // Duration
-        double syll_dur = syll->attribute("duration").toDouble();
-        syll->setAttribute("duration_log", log(syll_dur));
-        // Smoothing for non-stylised syllables
-        if (!syll->isPauseSilent() && syll->attribute("f0_min").toInt() == 0) {
-            syll->setAttribute("f0_min", Measures::mean(tier_syll, "f0_min", isyll, 4, 4, true, "f0_min"));
-            syll->setAttribute("f0_max", Measures::mean(tier_syll, "f0_max", isyll, 4, 4, true, "f0_min"));
-            syll->setAttribute("f0_mean", Measures::mean(tier_syll, "f0_mean", isyll, 4, 4, true, "f0_min"));
-        }
-        // Logarithmic transformation
-        if (tier_syll->interval(isyll)->attribute("f0_min").toInt() > 0) {
-            double f0_max = tier_syll->interval(isyll)->attribute("f0_max").toDouble();
-            double f0_max_st = 12.0 * log2(f0_max);
-            tier_syll->interval(isyll)->setAttribute("f0_max_st", f0_max_st);
-        }
-    }
-    for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
-        // Following pause
-        if (isyll < tier_syll->count() - 1 && tier_syll->interval(isyll+1)->isPauseSilent()) {
-            double pausedur = tier_syll->interval(isyll+1)->duration().toDouble();
-            features["following_pause_dur"] << pausedur;
-            features["following_pause_dur_log"] << log(pausedur);
-        }
-        else {
-            features["following_pause_dur"] << 0.0;
-            features["following_pause_dur_log"] << 0.0;
-        }
-        // Duration and log(duration)
-        features["syll_dur_rel20"] << Measures::relative(tier_syll, "duration", isyll, 2, 0, true, "", false);
-        features["syll_dur_rel30"] << Measures::relative(tier_syll, "duration", isyll, 3, 0, true, "", false);
-        features["syll_dur_rel40"] << Measures::relative(tier_syll, "duration", isyll, 4, 0, true, "", false);
-        features["syll_dur_log_rel20"] << Measures::relative(tier_syll, "duration_log", isyll, 2, 0, true, "", true);
-        features["syll_dur_log_rel30"] << Measures::relative(tier_syll, "duration_log", isyll, 3, 0, true, "", true);
-        features["syll_dur_log_rel40"] << Measures::relative(tier_syll, "duration_log", isyll, 4, 0, true, "", true);
-        // Pitch mean ST
-        features["f0_mean_st"] << tier_syll->interval(isyll)->attribute("f0_mean").toDouble();
-        features["f0_mean_st_rel20"] << Measures::relative(tier_syll, "f0_mean", isyll, 2, 0, true, "f0_min", true);
-        features["f0_mean_st_rel30"] << Measures::relative(tier_syll, "f0_mean", isyll, 3, 0, true, "f0_min", true);
-        features["f0_mean_st_rel40"] << Measures::relative(tier_syll, "f0_mean", isyll, 4, 0, true, "f0_min", true);
-        features["f0_mean_st_rel50"] << Measures::relative(tier_syll, "f0_mean", isyll, 5, 0, true, "f0_min", true);
-        double up = tier_syll->interval(isyll)->attribute("intrasyllabup").toDouble();
-        double down = tier_syll->interval(isyll)->attribute("intrasyllabdown").toDouble();
-        features["f0_up"] << up;
-        features["f0_down"] << down;
-        features["f0_traj"] << tier_syll->interval(isyll)->attribute("trajectory").toDouble();
-    }
+    SyllableFeatureExtractor extractor;
+    prepareFeatures(extractor, tier_syll);
+    extractor.toRealValueLists(features);
 }
 
 // ========================================================================================================================================
@@ -246,7 +222,7 @@ void ProsodicBoundariesAnnotator::prepareFeatures(QHash<QString, RealValueList>
 // ========================================================================================================================================
 
 int ProsodicBoundariesAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier *tier_token,
-                                           QHash<QString, RealValueList> &features, bool withPOS, bool annotateContours,
+                                           const SyllableFeatureExtractor &features, bool withPOS, bool annotateContours,
                                            QTextStream &out, bool createSequences)
 {
     bool quantize(true);
@@ -257,6 +233,10 @@ int ProsodicBoundariesAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
                         "syll_dur_log_rel20" << "syll_dur_log_rel30" << "syll_dur_log_rel40" <<
                         "f0_mean_st_rel20" << "f0_mean_st_rel30" << "f0_mean_st_rel40" << "f0_mean_st_rel50" <<
                         "f0_up" << "f0_down"<< "f0_traj";
+    // Contiguous table of the selected features, one row per syllable
+    QVector<double> table = features.table(featureSelection);
+    int nf = featureSelection.count();
+    const QVector<double> &followingPause = features.column("following_pause_dur");
     bool endSequence = true;
     for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
         // Get attributes: syllable text
@@ -284,7 +264,8 @@ int ProsodicBoundariesAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
             }
         }
         // Tokens
-        QList<Interval *> tokens = tier_token->getIntervalsOverlappingWith(syll, RealTime(0, 5000));
+        Interval *tokenFirst = (features.firstToken(isyll) >= 0) ? tier_token->interval(features.firstToken(isyll)) : nullptr;
+        Interval *tokenLast = (features.lastToken(isyll) >= 0) ? tier_token->interval(features.lastToken(isyll)) : nullptr;
 
         if (createSequences) {
             if (syll->isPauseSilent() && syll->duration().toDouble() > 0.300) {
@@ -303,40 +284,30 @@ int ProsodicBoundariesAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
         // out << syll->xMin().toDouble() << "\t";
         out << sylltext << "\t";
         // FEATURES
-        foreach (QString featureName, featureSelection) {
-            if (featureName.endsWith("_z")) {
-                featureName.chop(2);
-                if (quantize) {
-                    int x = Measures::quantize(features[featureName].zscore(isyll), 10, 200);
-                    if (x == 200 || x == -200) out << "NA\t"; else out << x << "\t";
-                } else {
-                    out << features[featureName].zscore(isyll) << "\t";
-                }
-            }
-            else {
-                if (quantize) {
-                    int x = Measures::quantize(features[featureName].at(isyll), 10, 200);
-                    if (x == 200 || x == -200) out << "NA\t"; else out << x << "\t";
-                } else {
-                    out << features[featureName].at(isyll) << "\t";
-                }
+        const double *row = table.constData() + isyll * nf;
+        for (int f = 0; f < nf; ++f) {
+            if (quantize) {
+                int x = Measures::quantize(row[f], 10, 200);
+                if (x == 200 || x == -200) out << "NA\t"; else out << x << "\t";
+            } else {
+                out << row[f] << "\t";
             }
         }
         // Following pause (silent or filled) presence
         if (syll->isPauseSilent())
             out << "SIL\t";
-        else if (tokens.count() > 0 && tokens.last()->text() == "euh")
+        else if (tokenLast && tokenLast->text() == "euh")
             out << "FIL\t";
-        else if (features["following_pause_dur"].at(isyll) > 0)
+        else if (followingPause.at(isyll) > 0)
             out << "BRK\t";
         else
             out << "CNT\t";
         // Token data
         bool initial = false, final = false;
-        if (tokens.count() > 0) {
+        if (tokenLast) {
             // Initial - final
-            if (tokens.first()->tMin() == syll->tMin()) initial = true;
-            if (tokens.last()->tMax() == syll->tMax()) final = true;
+            if (tokenFirst->tMin() == syll->tMin()) initial = true;
+            if (tokenLast->tMax() == syll->tMax()) final = true;
             if (initial && final)
                 out << "U\t";
             else if (final)
@@ -347,9 +318,9 @@ int ProsodicBoundariesAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
                 out << "0\t";
             // POS
             if (withPOS) {
-                QString tokentext = tokens.last()->text().replace(" ", "_");
+                QString tokentext = tokenLast->text().replace(" ", "_");
                 if (tokentext.length() == 0) tokentext = "_";
-                QString pos = tokens.last()->attribute("pos_min").toString();
+                QString pos = tokenLast->attribute("pos_min").toString();
                 if (pos.length() == 0) pos = "_";
                 out << tokentext << "\t";
                 out << pos.left(3) << "\t";
@@ -373,7 +344,7 @@ int ProsodicBoundariesAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
 }
 
 IntervalTier *ProsodicBoundariesAnnotator::annotateWithCRF(IntervalTier *tier_syll, IntervalTier *tier_token,
-                                                           QHash<QString, RealValueList> &features, bool withPOS, bool annotateContours,
+                                                           const SyllableFeatureExtractor &features, bool withPOS, bool annotateContours,
                                                            const QString &filenameModel, const QString &tier_name)
 {
     IntervalTier *promise = tier_syll->clone(tier_name);
@@ -447,8 +418,8 @@ IntervalTier *ProsodicBoundariesAnnotator::annotate(const QString &annotationID,
                                                     bool annotateContours)
 {
     d->currentAnnotationID = annotationID;
-    QHash<QString, RealValueList> features;
-    prepareFeatures(features, tier_syll);
+    SyllableFeatureExtractor features;
+    prepareFeatures(features, tier_syll, tier_token);
 
     QString filenameModel;
     if (annotateContours)
@@ -467,21 +438,17 @@ IntervalTier *ProsodicBoundariesAnnotator::annotate(const QString &annotationID,
                             "syll_dur_log_rel20" << "syll_dur_log_rel30" << "syll_dur_log_rel40" <<
                             "f0_mean_st_rel20" << "f0_mean_st_rel30" << "f0_mean_st_rel40" << "f0_mean_st_rel50" <<
                             "f0_up" << "f0_down"<< "f0_traj";
+        QVector<double> table = features.table(featureSelection);
+        int nf = featureSelection.count();
         for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
             out << annotationID << "\t" << speakerID  << "\t" << isyll << "\t";
             Interval *syll = tier_syll->interval(isyll);
             out << syll->text() << "\t";
             out << syll->tMin().toDouble() << "\t";
             out << syll->tMax().toDouble() << "\t";
-            foreach (QString featureID, featureSelection) {
-                if (featureID.endsWith("_z")) {
-                    featureID.chop(2);
-                    out << features[featureID].zscore(isyll) << "\t";
-                }
-                else {
-                    out << features[featureID].at(isyll) << "\t";
-                }
-            }
+            const double *row = table.constData() + isyll * nf;
+            for (int f = 0; f < nf; ++f)
+                out << row[f] << "\t";
             out << syll->attribute(d->attributeBoundaryTrain).toString();
             foreach (QString featureID, d->extraFeatures)
                 out << "\t" << syll->attribute(featureID).toString();
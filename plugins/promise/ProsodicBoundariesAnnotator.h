@@ -9,6 +9,7 @@
 #include "PraalineCore/Base/RealValueList.h"
 #include "PraalineCore/Annotation/Interval.h"
 #include "PraalineCore/Annotation/IntervalTier.h"
+#include "SyllableFeatureExtractor.h"
 
 struct ProsodicBoundariesAnnotatorData;
 
@@ -39,6 +40,8 @@ public:
     void closeFeaturesTableFile();
     void closeCRFDataFile();
 
+    static void prepareFeatures(SyllableFeatureExtractor &features,
+                                Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token = 0);
     static void prepareFeatures(QHash<QString, RealValueList> &features, Praaline::Core::IntervalTier *tier_syll);
 
     Praaline::Core::IntervalTier *annotate(
@@ -48,11 +51,11 @@ public:
 
 private:
     int outputCRF(Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token,
-                  QHash<QString, RealValueList> &features, bool withPOS, bool annotateContours,
+                  const SyllableFeatureExtractor &features, bool withPOS, bool annotateContours,
                   QTextStream &out, bool createSequences = true);
     Praaline::Core::IntervalTier *annotateWithCRF(
             Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token,
-            QHash<QString, RealValueList> &features, bool withPOS, bool annotateContours,
+            const SyllableFeatureExtractor &features, bool withPOS, bool annotateContours,
             const QString &filenameModel, const QString &tier_name = "boundary_auto");
 
     ProsodicBoundariesAnnotatorData *d;
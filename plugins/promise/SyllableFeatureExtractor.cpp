@@ -0,0 +1,360 @@
+#include <math.h>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QVariant>
+
+#include "PraalineCore/Statistics/Measures.h"
+using namespace Praaline::Core;
+
+#include "SyllableFeatureExtractor.h"
+
+struct RelativeFeatureDefinition {
+    QString featureID;
+    QString attributeID;
+    int windowLeft;
+    int windowRight;
+    QString attributeCheck;
+    bool logarithmic;
+};
+
+struct SyllableFeatureExtractorData {
+    SyllableFeatureExtractorData() :
+        count(0)
+    {
+        smoothedAttributes << "f0_min" << "f0_max" << "f0_mean" << "int_peak";
+    }
+
+    QStringList smoothedAttributes;
+    QList<RelativeFeatureDefinition> relativeFeatures;
+    // Results
+    int count;
+    QStringList featureIDs;
+    QHash<QString, QVector<double> > columns;
+    QHash<QString, QVector<double> > zscores;
+    QVector<int> firstToken;
+    QVector<int> lastToken;
+    QVector<double> empty;
+};
+
+SyllableFeatureExtractor::SyllableFeatureExtractor() :
+    d(new SyllableFeatureExtractorData)
+{
+}
+
+SyllableFeatureExtractor::~SyllableFeatureExtractor()
+{
+    delete d;
+}
+
+// ========================================================================================================================================
+// Feature definitions
+// ========================================================================================================================================
+
+QStringList SyllableFeatureExtractor::smoothedAttributes() const
+{
+    return d->smoothedAttributes;
+}
+
+void SyllableFeatureExtractor::setSmoothedAttributes(const QStringList &attributeIDs)
+{
+    d->smoothedAttributes = attributeIDs;
+}
+
+void SyllableFeatureExtractor::addRelativeFeature(const QString &featureID, const QString &attributeID,
+                                                  int windowLeft, int windowRight,
+                                                  const QString &attributeCheck, bool logarithmic)
+{
+    RelativeFeatureDefinition def;
+    def.featureID = featureID;
+    def.attributeID = attributeID;
+    def.windowLeft = windowLeft;
+    def.windowRight = windowRight;
+    def.attributeCheck = attributeCheck;
+    def.logarithmic = logarithmic;
+    d->relativeFeatures << def;
+}
+
+void SyllableFeatureExtractor::clearRelativeFeatures()
+{
+    d->relativeFeatures.clear();
+}
+
+// ========================================================================================================================================
+// Extraction
+// ========================================================================================================================================
+
+static QVector<double> readAttribute(IntervalTier *tier, const QString &attributeID)
+{
+    QVector<double> values(tier->count());
+    for (int i = 0; i < tier->count(); ++i)
+        values[i] = tier->interval(i)->attribute(attributeID).toDouble();
+    return values;
+}
+
+// Syllables that are not pauses and have a non-zero check attribute (all of them if there is no check attribute)
+static QVector<bool> readEligible(IntervalTier *tier, const QVector<bool> &pause, const QString &attributeCheck)
+{
+    QVector<bool> eligible(tier->count());
+    for (int i = 0; i < tier->count(); ++i) {
+        eligible[i] = !pause.at(i) &&
+                (attributeCheck.isEmpty() || tier->interval(i)->attribute(attributeCheck).toInt() != 0);
+    }
+    return eligible;
+}
+
+void SyllableFeatureExtractor::extract(IntervalTier *tier_syll, IntervalTier *tier_token)
+{
+    d->featureIDs.clear();
+    d->columns.clear();
+    d->zscores.clear();
+    d->firstToken.clear();
+    d->lastToken.clear();
+    d->count = 0;
+    if (!tier_syll) return;
+    int n = tier_syll->count();
+    d->count = n;
+
+    // Pauses end the context windows: each window is clipped to the run of syllables between two pauses.
+    QVector<bool> pause(n);
+    QVector<int> runStart(n), runEnd(n);
+    int start = 0;
+    for (int i = 0; i < n; ++i) {
+        pause[i] = tier_syll->interval(i)->isPauseSilent();
+        if (pause.at(i)) { runStart[i] = i; start = i + 1; }
+        else             { runStart[i] = start; }
+    }
+    int end = n - 1;
+    for (int i = n - 1; i >= 0; --i) {
+        if (pause.at(i)) { runEnd[i] = i; end = i - 1; }
+        else             { runEnd[i] = end; }
+    }
+
+    // Duration
+    for (int i = 0; i < n; ++i) {
+        Interval *syll = tier_syll->interval(i);
+        syll->setAttribute("duration_log", log(syll->attribute("duration").toDouble()));
+    }
+
+    // Smoothing for non-stylised syllables: mean over 4 syllables left and right. The window slides along each run,
+    // and a syllable that has been smoothed counts in the windows that follow (as it does when smoothing in place).
+    if (!d->smoothedAttributes.isEmpty()) {
+        int na = d->smoothedAttributes.count();
+        QVector<QVector<double> > values;
+        foreach (QString attributeID, d->smoothedAttributes)
+            values << readAttribute(tier_syll, attributeID);
+        QVector<bool> stylised = readEligible(tier_syll, pause, d->smoothedAttributes.first());
+        QVector<double> sums(na, 0.0);
+        int countStylised = 0, lo = 0, hi = -1;
+        for (int i = 0; i < n; ++i) {
+            if (pause.at(i)) continue;
+            int a = qMax(runStart.at(i), i - 4), b = qMin(runEnd.at(i), i + 4);
+            if (i == runStart.at(i)) {
+                sums.fill(0.0); countStylised = 0; lo = a; hi = a - 1;
+            }
+            while (hi < b) {
+                ++hi;
+                if (!stylised.at(hi)) continue;
+                for (int k = 0; k < na; ++k) sums[k] += values.at(k).at(hi);
+                countStylised++;
+            }
+            while (lo < a) {
+                if (stylised.at(lo)) {
+                    for (int k = 0; k < na; ++k) sums[k] -= values.at(k).at(lo);
+                    countStylised--;
+                }
+                ++lo;
+            }
+            if (stylised.at(i)) continue;
+            Interval *syll = tier_syll->interval(i);
+            for (int k = 0; k < na; ++k) {
+                double mean = (countStylised > 0) ? sums.at(k) / countStylised : 0.0;
+                double previous = values.at(k).at(i);
+                values[k][i] = mean;
+                syll->setAttribute(d->smoothedAttributes.at(k), mean);
+                if (k == 0) {
+                    stylised[i] = (QVariant(mean).toInt() != 0);
+                    if (stylised.at(i)) {
+                        for (int j = 0; j < na; ++j) sums[j] += values.at(j).at(i);
+                        countStylised++;
+                    }
+                }
+                else if (stylised.at(i)) {
+                    sums[k] += mean - previous;
+                }
+            }
+        }
+    }
+
+    // Logarithmic transformation
+    for (int i = 0; i < n; ++i) {
+        Interval *syll = tier_syll->interval(i);
+        if (syll->attribute("f0_min").toInt() > 0) {
+            syll->setAttribute("f0_max_st", 12.0 * log2(syll->attribute("f0_max").toDouble()));
+        }
+    }
+
+    // Relative features, from prefix sums over the eligible syllables: the sum over any window is then the difference
+    // of two prefix sums. Cases without a well-defined window mean (pauses, windows with no eligible syllable) are
+    // left to Measures::relative.
+    QHash<QString, QVector<double> > attributes;
+    QHash<QString, QVector<double> > prefixSums;
+    QHash<QString, QVector<int> > prefixCounts;
+    foreach (RelativeFeatureDefinition def, d->relativeFeatures) {
+        if (!attributes.contains(def.attributeID))
+            attributes.insert(def.attributeID, readAttribute(tier_syll, def.attributeID));
+        const QVector<double> &values = attributes[def.attributeID];
+        QString key = def.attributeID + "|" + def.attributeCheck;
+        if (!prefixSums.contains(key)) {
+            QVector<bool> eligible = readEligible(tier_syll, pause, def.attributeCheck);
+            QVector<double> sums(n + 1, 0.0);
+            QVector<int> counts(n + 1, 0);
+            for (int i = 0; i < n; ++i) {
+                sums[i + 1] = sums.at(i) + (eligible.at(i) ? values.at(i) : 0.0);
+                counts[i + 1] = counts.at(i) + (eligible.at(i) ? 1 : 0);
+            }
+            prefixSums.insert(key, sums);
+            prefixCounts.insert(key, counts);
+        }
+        const QVector<double> &sums = prefixSums[key];
+        const QVector<int> &counts = prefixCounts[key];
+        QVector<double> column(n);
+        for (int i = 0; i < n; ++i) {
+            int a = qMax(runStart.at(i), i - def.windowLeft), b = qMin(runEnd.at(i), i + def.windowRight);
+            int c = counts.at(b + 1) - counts.at(a);
+            double mean = (c > 0) ? (sums.at(b + 1) - sums.at(a)) / c : 0.0;
+            if (pause.at(i) || c == 0 || (!def.logarithmic && mean == 0.0)) {
+                column[i] = Measures::relative(tier_syll, def.attributeID, i, def.windowLeft, def.windowRight, true,
+                                               def.attributeCheck, def.logarithmic);
+                continue;
+            }
+            column[i] = (def.logarithmic) ? values.at(i) - mean : values.at(i) / mean;
+        }
+        d->columns.insert(def.featureID, column);
+        d->featureIDs << def.featureID;
+    }
+
+    // Syllable features
+    QVector<double> f0_mean(n), f0_up(n), f0_down(n), f0_mvt(n), f0_traj(n), intensity(n), pause_dur(n), pause_dur_log(n);
+    for (int i = 0; i < n; ++i) {
+        Interval *syll = tier_syll->interval(i);
+        f0_mean[i] = syll->attribute("f0_mean").toDouble();
+        f0_up[i] = syll->attribute("intrasyllabup").toDouble();
+        f0_down[i] = syll->attribute("intrasyllabdown").toDouble();
+        f0_mvt[i] = f0_up.at(i) + f0_down.at(i);
+        f0_traj[i] = syll->attribute("trajectory").toDouble();
+        intensity[i] = syll->attribute("int_peak").toDouble();
+        // Following pause
+        if (i < n - 1 && pause.at(i + 1)) {
+            pause_dur[i] = tier_syll->interval(i + 1)->duration().toDouble();
+            pause_dur_log[i] = log(pause_dur.at(i));
+        } else {
+            pause_dur[i] = 0.0;
+            pause_dur_log[i] = 0.0;
+        }
+    }
+    d->columns.insert("f0_mean_st", f0_mean);
+    d->columns.insert("f0_up", f0_up);
+    d->columns.insert("f0_down", f0_down);
+    d->columns.insert("f0_mvt", f0_mvt);
+    d->columns.insert("f0_traj", f0_traj);
+    d->columns.insert("intensity", intensity);
+    d->columns.insert("following_pause_dur", pause_dur);
+    d->columns.insert("following_pause_dur_log", pause_dur_log);
+    d->featureIDs << "f0_mean_st" << "f0_up" << "f0_down" << "f0_mvt" << "f0_traj" << "intensity"
+                  << "following_pause_dur" << "following_pause_dur_log";
+
+    // Tokens overlapping each syllable: both tiers are sorted, so the first candidate token only moves forward
+    d->firstToken.fill(-1, n);
+    d->lastToken.fill(-1, n);
+    if (!tier_token) return;
+    RealTime threshold(0, 5000);
+    int m = tier_token->count();
+    int t = 0;
+    for (int i = 0; i < n; ++i) {
+        Interval *syll = tier_syll->interval(i);
+        while (t < m && tier_token->interval(t)->tMax() <= syll->tMin() + threshold) ++t;
+        int j = t;
+        while (j < m && tier_token->interval(j)->tMin() < syll->tMax() - threshold) ++j;
+        if (j > t) {
+            d->firstToken[i] = t;
+            d->lastToken[i] = j - 1;
+        }
+    }
+}
+
+// ========================================================================================================================================
+// Results
+// ========================================================================================================================================
+
+int SyllableFeatureExtractor::count() const
+{
+    return d->count;
+}
+
+QStringList SyllableFeatureExtractor::featureIDs() const
+{
+    return d->featureIDs;
+}
+
+bool SyllableFeatureExtractor::hasFeature(const QString &featureID) const
+{
+    if (featureID.endsWith("_z")) return d->columns.contains(featureID.left(featureID.length() - 2));
+    return d->columns.contains(featureID);
+}
+
+const QVector<double> &SyllableFeatureExtractor::column(const QString &featureID) const
+{
+    if (!featureID.endsWith("_z")) {
+        QHash<QString, QVector<double> >::const_iterator it = d->columns.constFind(featureID);
+        return (it != d->columns.constEnd()) ? it.value() : d->empty;
+    }
+    // Z-scores are computed once per feature, the first time they are requested
+    if (!d->zscores.contains(featureID)) {
+        QString baseID = featureID.left(featureID.length() - 2);
+        if (!d->columns.contains(baseID)) return d->empty;
+        const QVector<double> &values = d->columns[baseID];
+        RealValueList list;
+        foreach (double value, values) list << value;
+        QVector<double> zscores(values.count());
+        for (int i = 0; i < values.count(); ++i) zscores[i] = list.zscore(i);
+        d->zscores.insert(featureID, zscores);
+    }
+    return d->zscores[featureID];
+}
+
+QVector<double> SyllableFeatureExtractor::table(const QStringList &featureSelection) const
+{
+    int nf = featureSelection.count();
+    QVector<double> ret(d->count * nf, 0.0);
+    for (int f = 0; f < nf; ++f) {
+        const QVector<double> &values = column(featureSelection.at(f));
+        if (values.count() != d->count) continue;
+        const double *src = values.constData();
+        double *dst = ret.data() + f;
+        for (int i = 0; i < d->count; ++i, dst += nf) *dst = src[i];
+    }
+    return ret;
+}
+
+void SyllableFeatureExtractor::toRealValueLists(QHash<QString, RealValueList> &features) const
+{
+    foreach (QString featureID, d->featureIDs) {
+        RealValueList list;
+        foreach (double value, d->columns[featureID]) list << value;
+        features.insert(featureID, list);
+    }
+}
+
+int SyllableFeatureExtractor::firstToken(int isyll) const
+{
+    if (isyll < 0 || isyll >= d->firstToken.count()) return -1;
+    return d->firstToken.at(isyll);
+}
+
+int SyllableFeatureExtractor::lastToken(int isyll) const
+{
+    if (isyll < 0 || isyll >= d->lastToken.count()) return -1;
+    return d->lastToken.at(isyll);
+}
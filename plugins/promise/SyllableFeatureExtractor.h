@@ -0,0 +1,56 @@
+#ifndef SYLLABLEFEATUREEXTRACTOR_H
+#define SYLLABLEFEATUREEXTRACTOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include "PraalineCore/Base/RealValueList.h"
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+
+struct SyllableFeatureExtractorData;
+
+// Computes the prosodic features of all the syllables of a tier in a single pass, storing each feature in a contiguous
+// column (one value per syllable) that the statistical models can read directly. Relative features (the value of a
+// syllable compared to the mean over a window of neighbouring syllables, as in Measures::relative with pauses ending
+// the window) are computed from running sums rather than by scanning each window, and the tokens overlapping each
+// syllable are found by walking the syllable and token tiers together.
+class SyllableFeatureExtractor
+{
+public:
+    SyllableFeatureExtractor();
+    ~SyllableFeatureExtractor();
+
+    // Feature definitions
+    // Attributes replaced by their mean over a 4+4 window in syllables that were not stylised. The first attribute
+    // is the one that indicates whether a syllable was stylised (non-zero value).
+    QStringList smoothedAttributes() const;
+    void setSmoothedAttributes(const QStringList &attributeIDs);
+    void addRelativeFeature(const QString &featureID, const QString &attributeID, int windowLeft, int windowRight,
+                            const QString &attributeCheck, bool logarithmic);
+    void clearRelativeFeatures();
+
+    // Extraction. Sets the duration_log, f0_max_st and smoothed attributes on the syllables, as before.
+    void extract(Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token = nullptr);
+
+    // Results
+    int count() const;
+    QStringList featureIDs() const;
+    bool hasFeature(const QString &featureID) const;
+    // A feature ID ending in _z returns the z-scores of the feature.
+    const QVector<double> &column(const QString &featureID) const;
+    // Row-major table (one row per syllable) of the selected features.
+    QVector<double> table(const QStringList &featureSelection) const;
+    void toRealValueLists(QHash<QString, RealValueList> &features) const;
+
+    // Tokens overlapping each syllable: indices in the token tier, -1 if there are none
+    int firstToken(int isyll) const;
+    int lastToken(int isyll) const;
+
+private:
+    SyllableFeatureExtractorData *d;
+};
+
+#endif // SYLLABLEFEATUREEXTRACTOR_H
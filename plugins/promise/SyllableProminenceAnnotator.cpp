@@ -16,6 +16,7 @@
 #include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
 using namespace Praaline::Core;
 
+#include "SyllableFeatureExtractor.h"
 #include "SyllableProminenceAnnotator.h"
 
 struct SyllableProminenceAnnotatorData {
@@ -167,70 +168,44 @@ void SyllableProminenceAnnotator::closeCRFDataFile()
 // PREPARE FEATURES
 // ========================================================================================================================================
 
+// static
+void SyllableProminenceAnnotator::prepareFeatures(SyllableFeatureExtractor &features, IntervalTier *tier_syll, IntervalTier *tier_token)
+{
+    features.setSmoothedAttributes(QStringList() << "f0_min" << "f0_max" << "f0_mean" << "int_peak");
+    features.clearRelativeFeatures();
+    // Duration (log)
+    features.addRelativeFeature("syll_dur_rel22", "duration", 2, 2, "", false);
+    features.addRelativeFeature("syll_dur_rel33", "duration", 3, 3, "", false);
+    features.addRelativeFeature("syll_dur_rel44", "duration", 4, 4, "", false);
+    features.addRelativeFeature("syll_dur_log_rel22", "duration_log", 2, 2, "", true);
+    features.addRelativeFeature("syll_dur_log_rel33", "duration_log", 3, 3, "", true);
+    features.addRelativeFeature("syll_dur_log_rel44", "duration_log", 4, 4, "", true);
+    features.addRelativeFeature("syll_dur_log_rel55", "duration_log", 5, 5, "", true);
+    // Pitch ST
+    features.addRelativeFeature("f0_max_st_rel22", "f0_max_st", 2, 2, "f0_min", true);
+    features.addRelativeFeature("f0_max_st_rel33", "f0_max_st", 3, 3, "f0_min", true);
+    features.addRelativeFeature("f0_max_st_rel44", "f0_max_st", 4, 4, "f0_min", true);
+    features.addRelativeFeature("f0_max_st_rel55", "f0_max_st", 5, 5, "f0_min", true);
+    features.addRelativeFeature("f0_mean_st_rel22", "f0_mean", 2, 2, "f0_min", true);
+    features.addRelativeFeature("f0_mean_st_rel33", "f0_mean", 3, 3, "f0_min", true);
+    features.addRelativeFeature("f0_mean_st_rel44", "f0_mean", 4, 4, "f0_min", true);
+    features.addRelativeFeature("f0_mean_st_rel55", "f0_mean", 5, 5, "f0_min", true);
+    // Intensity dB
+    features.addRelativeFeature("intensity_rel22", "int_peak", 2, 2, "f0_min", true);
+    features.addRelativeFeature("intensity_rel33", "int_peak", 3, 3, "f0_min", true);
+    features.addRelativeFeature("intensity_rel44", "int_peak", 4, 4, "f0_min", true);
+    features.addRelativeFeature("intensity_rel55", "int_peak", 5, 5, "f0_min", true);
+    // The syllable features (f0 movement, intensity, following pause) are always extracted
+    features.extract(tier_syll, tier_token);
+}
+
 // static
 void SyllableProminenceAnnotator::prepareFeatures(QHash<QString, RealValueList> &features, IntervalTier *tier_syll, IntervalTier *tier_phones)
 {
     Q_UNUSED(tier_phones)
-    // Prepare data
-    for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
-        Interval *syll = tier_syll->interval(isyll);
-        // Duration
-        double syll_dur = syll->attribute("duration").toDouble();
-        syll->setAttribute("duration_log", log(syll_dur));
-        // Smoothing for non-stylised syllables
-        if (!syll->isPauseSilent() && syll->attribute("f0_min").toInt() == 0) {
-            syll->setAttribute("f0_min", Measures::mean(tier_syll, "f0_min", isyll, 4, 4, true, "f0_min"));
-            syll->setAttribute("f0_max", Measures::mean(tier_syll, "f0_max", isyll, 4, 4, true, "f0_min"));
-            syll->setAttribute("f0_mean", Measures::mean(tier_syll, "f0_mean", isyll, 4, 4, true, "f0_min"));
-            syll->setAttribute("int_peak", Measures::mean(tier_syll, "int_peak", isyll, 4, 4, true, "f0_min"));
-        }
-        // Logarithmic transformation
-        if (tier_syll->interval(isyll)->attribute("f0_min").toInt() > 0) {
-            double f0_max = tier_syll->interval(isyll)->attribute("f0_max").toDouble();
-            double f0_max_st = 12.0 * log2(f0_max);
-            tier_syll->interval(isyll)->setAttribute("f0_max_st", f0_max_st);
-        }
-    }
-    for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
-        // Duration (log)
-        features["syll_dur_rel22"] << Measures::relative(tier_syll, "duration", isyll, 2, 2, true, "", false);
-        features["syll_dur_rel33"] << Measures::relative(tier_syll, "duration", isyll, 3, 3, true, "", false);
-        features["syll_dur_rel44"] << Measures::relative(tier_syll, "duration", isyll, 4, 4, true, "", false);
-        features["syll_dur_log_rel22"] << Measures::relative(tier_syll, "duration_log", isyll, 2, 2, true, "", true);
-        features["syll_dur_log_rel33"] << Measures::relative(tier_syll, "duration_log", isyll, 3, 3, true, "", true);
-        features["syll_dur_log_rel44"] << Measures::relative(tier_syll, "duration_log", isyll, 4, 4, true, "", true);
-        features["syll_dur_log_rel55"] << Measures::relative(tier_syll, "duration_log", isyll, 5, 5, true, "", true);
-        // Pitch ST
-        features["f0_max_st_rel22"] << Measures::relative(tier_syll, "f0_max_st", isyll, 2, 2, true, "f0_min", true);
-        features["f0_max_st_rel33"] << Measures::relative(tier_syll, "f0_max_st", isyll, 3, 3, true, "f0_min", true);
-        features["f0_max_st_rel44"] << Measures::relative(tier_syll, "f0_max_st", isyll, 4, 4, true, "f0_min", true);
-        features["f0_max_st_rel55"] << Measures::relative(tier_syll, "f0_max_st", isyll, 5, 5, true, "f0_min", true);
-        features["f0_mean_st"] << tier_syll->interval(isyll)->attribute("f0_mean").toDouble();
-        features["f0_mean_st_rel22"] << Measures::relative(tier_syll, "f0_mean", isyll, 2, 2, true, "f0_min", true);
-        features["f0_mean_st_rel33"] << Measures::relative(tier_syll, "f0_mean", isyll, 3, 3, true, "f0_min", true);
-        features["f0_mean_st_rel44"] << Measures::relative(tier_syll, "f0_mean", isyll, 4, 4, true, "f0_min", true);
-        features["f0_mean_st_rel55"] << Measures::relative(tier_syll, "f0_mean", isyll, 5, 5, true, "f0_min", true);
-        double up = tier_syll->interval(isyll)->attribute("intrasyllabup").toDouble();
-        double down = tier_syll->interval(isyll)->attribute("intrasyllabdown").toDouble();
-        features["f0_up"] << up;
-        features["f0_down"] << down;
-        features["f0_mvt"] << (up + down);
-        features["f0_traj"] << tier_syll->interval(isyll)->attribute("trajectory").toDouble();
-        // Intensity dB
-        features["intensity"] << tier_syll->interval(isyll)->attribute("int_peak").toDouble();
-        features["intensity_rel22"]  << Measures::relative(tier_syll, "int_peak", isyll, 2, 2, true, "f0_min", true);
-        features["intensity_rel33"]  << Measures::relative(tier_syll, "int_peak", isyll, 3, 3, true, "f0_min", true);
-        features["intensity_rel44"]  << Measures::relative(tier_syll, "int_peak", isyll, 4, 4, true, "f0_min", true);
-        features["intensity_rel55"]  << Measures::relative(tier_syll, "int_peak", isyll, 5, 5, true, "f0_min", true);
-        // Following pause
-        if (isyll < tier_syll->count() - 1 && tier_syll->interval(isyll+1)->isPauseSilent()) {
-            double pausedur = tier_syll->interval(isyll+1)->duration().toDouble();
-            features["following_pause_dur"] << pausedur;
-        }
-        else {
-            features["following_pause_dur"] << 0.0;
-        }
-    }
+    SyllableFeatureExtractor extractor;
+    prepareFeatures(extractor, tier_syll);
+    extractor.toRealValueLists(features);
 }
 
 QString doubleToString(double number, QString decimalSeparator = ".")
@@ -243,7 +218,7 @@ QString doubleToString(double number, QString decimalSeparator = ".")
 // ========================================================================================================================================
 
 void SyllableProminenceAnnotator::outputRFACE(const QString &sampleID, IntervalTier *tier_syll, IntervalTier *tier_token,
-                                              QHash<QString, RealValueList> &features, QTextStream &out)
+                                              const SyllableFeatureExtractor &features, QTextStream &out)
 {
     QStringList featureSelection;
     featureSelection << "syll_dur_log_rel22_z" << "syll_dur_log_rel33_z" << "syll_dur_log_rel44_z" << "syll_dur_log_rel55_z" <<
@@ -251,6 +226,10 @@ void SyllableProminenceAnnotator::outputRFACE(const QString &sampleID, IntervalT
                         "f0_mean_st_rel22" << "f0_mean_st_rel33" << "f0_mean_st_rel44" << "f0_mean_st_rel55" <<
                         "f0_up" << "f0_down" << "f0_mvt" << "f0_traj" <<
                         "intensity_rel22" << "intensity_rel33" << "intensity_rel44" << "intensity_rel55";
+    // Contiguous table of the selected features, one row per syllable
+    QVector<double> table = features.table(featureSelection);
+    int nf = featureSelection.count();
+    const QVector<double> &followingPause = features.column("following_pause_dur");
 
     for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
         QString sylldata;
@@ -260,7 +239,8 @@ void SyllableProminenceAnnotator::outputRFACE(const QString &sampleID, IntervalT
         QString delivery = syll->attribute("delivery").toString();
         QString prom = syll->attribute("prom").toString();
         QString sylltext = syll->text().replace(" ", "_").trimmed();
-        QList<Interval *> tokens = tier_token->getIntervalsOverlappingWith(syll, RealTime(0, 5000));
+        Interval *tokenFirst = (features.firstToken(isyll) >= 0) ? tier_token->interval(features.firstToken(isyll)) : nullptr;
+        Interval *tokenLast = (features.lastToken(isyll) >= 0) ? tier_token->interval(features.lastToken(isyll)) : nullptr;
 
         // Skip
         if (syll->isPauseSilent()) continue;
@@ -273,25 +253,20 @@ void SyllableProminenceAnnotator::outputRFACE(const QString &sampleID, IntervalT
         sylldata.append(QString::number(isyll)).append(":");
         sylldata.append(syll->text()).append("\t");
         // FEATURES
-        foreach (QString featureName, featureSelection) {
-            if (featureName.endsWith("_z")) {
-                featureName.chop(2);
-                sylldata.append(doubleToString(features[featureName].zscore(isyll), ",")).append("\t");
-            }
-            else
-                sylldata.append(doubleToString(features[featureName].at(isyll), ",")).append("\t");
-        }
+        const double *row = table.constData() + isyll * nf;
+        for (int f = 0; f < nf; ++f)
+            sylldata.append(doubleToString(row[f], ",")).append("\t");
         // Following pause presence
-        sylldata.append((features["following_pause_dur"].at(isyll) > 0) ? "Y" : "N").append("\t");
-        sylldata.append((tokens.count() > 0 && tokens.last()->text() == "euh") ? "F" : "0").append("\t");
+        sylldata.append((followingPause.at(isyll) > 0) ? "Y" : "N").append("\t");
+        sylldata.append((tokenLast && tokenLast->text() == "euh") ? "F" : "0").append("\t");
         // Token data - initial or final syllalble
         bool initial = false, final = false;
-        if (tokens.count() > 0) {
+        if (tokenLast) {
             // Initial - final
-            if (tokens.first()->tMin() == syll->tMin()) initial = true;
-            if (tokens.last()->tMax() == syll->tMax()) final = true;
+            if (tokenFirst->tMin() == syll->tMin()) initial = true;
+            if (tokenLast->tMax() == syll->tMax()) final = true;
         }
-        if (tokens.count() == 0)
+        if (!tokenLast)
             sylldata.append("0\t");
         else {
             if (initial && final)   sylldata.append("U\t");
@@ -342,7 +317,7 @@ void SyllableProminenceAnnotator::readRFACEprediction(QString filename, Interval
 
 void SyllableProminenceAnnotator::annotateRFACE(QString filenameModel, const QString &sampleID,
                                                 IntervalTier *tier_syll, IntervalTier *tier_token,
-                                                QHash<QString, RealValueList> &features, QString attributeOutput)
+                                                const SyllableFeatureExtractor &features, QString attributeOutput)
 {
     // Get a temporary file
     QString filenameFeatures = d->modelsPath + "/prompraaline.afm";
@@ -380,7 +355,7 @@ void SyllableProminenceAnnotator::annotateRFACE(QString filenameModel, const QSt
 }
 
 void SyllableProminenceAnnotator::outputSVM(IntervalTier *tier_syll, IntervalTier *tier_token,
-                                            QHash<QString, RealValueList> &features, QTextStream &out)
+                                            const SyllableFeatureExtractor &features, QTextStream &out)
 {
     QStringList featureSelection;
     featureSelection << "syll_dur_log_rel22_z" << "syll_dur_log_rel33_z" << "syll_dur_log_rel44_z" << "syll_dur_log_rel55_z" <<
@@ -388,6 +363,10 @@ void SyllableProminenceAnnotator::outputSVM(IntervalTier *tier_syll, IntervalTie
                         "f0_mean_st_rel22" << "f0_mean_st_rel33" << "f0_mean_st_rel44" << "f0_mean_st_rel55" <<
                         "f0_up" << "f0_down" << "f0_mvt" << "f0_traj" <<
                         "intensity_rel22" << "intensity_rel33" << "intensity_rel44" << "intensity_rel55";
+    // Contiguous table of the selected features, one row per syllable
+    QVector<double> table = features.table(featureSelection);
+    int nf = featureSelection.count();
+    const QVector<double> &followingPause = features.column("following_pause_dur");
 
 
     for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
@@ -398,7 +377,8 @@ void SyllableProminenceAnnotator::outputSVM(IntervalTier *tier_syll, IntervalTie
         QString delivery = syll->attribute("delivery").toString();
         QString prom = syll->attribute("prom").toString();
         QString sylltext = syll->text().replace(" ", "_").trimmed();
-        QList<Interval *> tokens = tier_token->getIntervalsOverlappingWith(syll, RealTime(0, 5000));
+        Interval *tokenFirst = (features.firstToken(isyll) >= 0) ? tier_token->interval(features.firstToken(isyll)) : nullptr;
+        Interval *tokenLast = (features.lastToken(isyll) >= 0) ? tier_token->interval(features.lastToken(isyll)) : nullptr;
 
         // Skip
         if (syll->isPauseSilent()) continue;
@@ -414,30 +394,26 @@ void SyllableProminenceAnnotator::outputSVM(IntervalTier *tier_syll, IntervalTie
             sylldata.append("-1 ");
         // FEATURES
         int ifeature = 1;
-        foreach (QString featureName, featureSelection) {
+        const double *row = table.constData() + isyll * nf;
+        for (int f = 0; f < nf; ++f) {
             sylldata.append(QString::number(ifeature)).append(":");
-            if (featureName.endsWith("_z")) {
-                featureName.chop(2);
-                sylldata.append(doubleToString(features[featureName].zscore(isyll))).append(" ");
-            }
-            else
-                sylldata.append(doubleToString(features[featureName].at(isyll))).append(" ");
+            sylldata.append(doubleToString(row[f])).append(" ");
             ifeature++;
         }
         // Following pause presence
         sylldata.append(QString::number(ifeature)).append(":");
-        sylldata.append((features["following_pause_dur"].at(isyll) > 0) ? "1" : "0").append(" ");
+        sylldata.append((followingPause.at(isyll) > 0) ? "1" : "0").append(" ");
         ifeature++;
         // Is euh
         sylldata.append(QString::number(ifeature)).append(":");
-        sylldata.append((tokens.count() > 0 && tokens.last()->text() == "euh") ? "1" : "0").append(" ");
+        sylldata.append((tokenLast && tokenLast->text() == "euh") ? "1" : "0").append(" ");
         ifeature++;
         // Token data - initial or final syllalble
         bool initial = false, final = false;
-        if (tokens.count() > 0) {
+        if (tokenLast) {
             // Initial - final
-            if (tokens.first()->tMin() == syll->tMin()) initial = true;
-            if (tokens.last()->tMax() == syll->tMax()) final = true;
+            if (tokenFirst->tMin() == syll->tMin()) initial = true;
+            if (tokenLast->tMax() == syll->tMax()) final = true;
         }
         sylldata.append(QString::number(ifeature)).append(":");
         sylldata.append((final) ? "1" : "0").append(" ");
@@ -454,7 +430,7 @@ void SyllableProminenceAnnotator::outputSVM(IntervalTier *tier_syll, IntervalTie
 }
 
 int SyllableProminenceAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier *tier_token,
-                                           QHash<QString, RealValueList> &features, bool withPOS, QTextStream &out,
+                                           const SyllableFeatureExtractor &features, bool withPOS, QTextStream &out,
                                            bool createSequences)
 {
     int noSequences = 0;
@@ -464,6 +440,10 @@ int SyllableProminenceAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
                         "f0_mean_st_rel22" << "f0_mean_st_rel33" << "f0_mean_st_rel44" << "f0_mean_st_rel55" <<
                         "f0_up" << "f0_down" << "f0_mvt" << "f0_traj" <<
                         "intensity_rel22" << "intensity_rel33" << "intensity_rel44" << "intensity_rel55";
+    // Contiguous table of the selected features, one row per syllable
+    QVector<double> table = features.table(featureSelection);
+    int nf = featureSelection.count();
+    const QVector<double> &followingPause = features.column("following_pause_dur");
 
     bool endSequence = true;
     for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
@@ -474,7 +454,8 @@ int SyllableProminenceAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
 
         QString sylltext = syll->text().replace(" ", "_").replace("\t", "").trimmed();
 
-        QList<Interval *> tokens = tier_token->getIntervalsOverlappingWith(syll, RealTime(0, 5000));
+        Interval *tokenFirst = (features.firstToken(isyll) >= 0) ? tier_token->interval(features.firstToken(isyll)) : nullptr;
+        Interval *tokenLast = (features.lastToken(isyll) >= 0) ? tier_token->interval(features.lastToken(isyll)) : nullptr;
 
         // if (!prom.isEmpty() && prom != "p" && prom != "P") exclude = true;
         // if (delivery == "H" || delivery == "%" || delivery == "&") exclude = true;
@@ -497,32 +478,26 @@ int SyllableProminenceAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
         // out << syll->xMin().toDouble() << "\t";
         out << sylltext << "\t";
         // FEATURES
-        foreach (QString featureName, featureSelection) {
-            if (featureName.endsWith("_z")) {
-                featureName.chop(2);
-                int x = Measures::quantize(features[featureName].zscore(isyll), 10, 200);
-                if (x == 200 || x == -200) out << "NA\t"; else out << x << "\t";
-            }
-            else {
-                int x = Measures::quantize(features[featureName].at(isyll), 10, 200);
-                if (x == 200 || x == -200) out << "NA\t"; else out << x << "\t";
-            }
+        const double *row = table.constData() + isyll * nf;
+        for (int f = 0; f < nf; ++f) {
+            int x = Measures::quantize(row[f], 10, 200);
+            if (x == 200 || x == -200) out << "NA\t"; else out << x << "\t";
         }
         // Following pause (silent or filled) presence
         if (syll->isPauseSilent())
             out << "SIL\t";
-        else if (tokens.count() > 0 && tokens.last()->text() == "euh")
+        else if (tokenLast && tokenLast->text() == "euh")
             out << "FIL\t";
-        else if (features["following_pause_dur"].at(isyll) > 0)
+        else if (followingPause.at(isyll) > 0)
             out << "BRK\t";
         else
             out << "CNT\t";
         // Token data
         bool initial = false, final = false;
-        if (tokens.count() > 0) {
+        if (tokenLast) {
             // Initial - final
-            if (tokens.first()->tMin() == syll->tMin()) initial = true;
-            if (tokens.last()->tMax() == syll->tMax()) final = true;
+            if (tokenFirst->tMin() == syll->tMin()) initial = true;
+            if (tokenLast->tMax() == syll->tMax()) final = true;
             if (initial && final)
                 out << "U\t";
             else if (final)
@@ -533,9 +508,9 @@ int SyllableProminenceAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
                 out << "0\t";
             // POS
             if (withPOS) {
-                QString tokentext = tokens.last()->text().replace(" ", "_");
+                QString tokentext = tokenLast->text().replace(" ", "_");
                 if (tokentext.length() == 0) tokentext = "_";
-                QString pos = tokens.last()->attribute("pos_min").toString();
+                QString pos = tokenLast->attribute("pos_min").toString();
                 if (pos.length() == 0) pos = "_";
                 out << tokentext << "\t";
                 out << pos.left(3) << "\t";
@@ -572,7 +547,7 @@ int SyllableProminenceAnnotator::outputCRF(IntervalTier *tier_syll, IntervalTier
 }
 
 IntervalTier *SyllableProminenceAnnotator::annotateWithCRF(IntervalTier *tier_syll, IntervalTier *tier_token,
-                                                           QHash<QString, RealValueList> &features, bool withPOS,
+                                                           const SyllableFeatureExtractor &features, bool withPOS,
                                                            const QString &filenameModel, const QString &tier_name)
 {
     IntervalTier *promise = tier_syll->clone(tier_name);
@@ -656,8 +631,8 @@ IntervalTier *SyllableProminenceAnnotator::annotate(const QString &annotationID,
                                                     IntervalTier *tier_syll, IntervalTier *tier_token, bool withPOS)
 {
     d->currentAnnotationID = annotationID;
-    QHash<QString, RealValueList> features;
-    prepareFeatures(features, tier_syll);
+    SyllableFeatureExtractor features;
+    prepareFeatures(features, tier_syll, tier_token);
 
     QString filenameModel;
     if (withPOS)
@@ -678,21 +653,17 @@ IntervalTier *SyllableProminenceAnnotator::annotate(const QString &annotationID,
                             "f0_mean_st_rel22" << "f0_mean_st_rel33" << "f0_mean_st_rel44" << "f0_mean_st_rel55" <<
                             "f0_up" << "f0_down" << "f0_mvt" << "f0_traj" <<
                             "intensity_rel22" << "intensity_rel33" << "intensity_rel44" << "intensity_rel55";
+        QVector<double> table = features.table(featureSelection);
+        int nf = featureSelection.count();
         for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
             out << annotationID << "\t" << speakerID  << "\t" << isyll << "\t";
             Interval *syll = tier_syll->interval(isyll);
             out << syll->text() << "\t";
             out << syll->tMin().toDouble() << "\t";
             out << syll->tMax().toDouble() << "\t";
-            foreach (QString featureName, featureSelection) {
-                if (featureName.endsWith("_z")) {
-                    featureName.chop(2);
-                    out << features[featureName].zscore(isyll) << "\t";
-                }
-                else {
-                    out << features[featureName].at(isyll) << "\t";
-                }
-            }
+            const double *row = table.constData() + isyll * nf;
+            for (int f = 0; f < nf; ++f)
+                out << row[f] << "\t";
             out << syll->attribute("promise").toString() << "\t";
             out << syll->attribute("promise_pos").toString() << "\n";
         }
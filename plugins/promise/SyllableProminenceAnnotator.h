@@ -11,6 +11,7 @@
 #include "PraalineCore/Annotation/Interval.h"
 #include "PraalineCore/Annotation/IntervalTier.h"
 #include "PraalineCore/Annotation/AnnotationTierGroup.h"
+#include "SyllableFeatureExtractor.h"
 
 struct SyllableProminenceAnnotatorData;
 
@@ -41,6 +42,8 @@ public:
     void closeFeaturesTableFile();
     void closeCRFDataFile();
 
+    static void prepareFeatures(SyllableFeatureExtractor &features,
+                                Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token = 0);
     static void prepareFeatures(QHash<QString, RealValueList> &features,
                                 Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_phones = 0);
 
@@ -56,19 +59,19 @@ public slots:
 private:
     void outputRFACE(const QString &sampleID,
                      Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token,
-                     QHash<QString, RealValueList> &features, QTextStream &out);
+                     const SyllableFeatureExtractor &features, QTextStream &out);
     void readRFACEprediction(QString filename, Praaline::Core::IntervalTier *tier_syll, QString attribute);
     void annotateRFACE(QString filenameModel, const QString &sampleID,
                        Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token,
-                       QHash<QString, RealValueList> &features, QString attributeOutput);
+                       const SyllableFeatureExtractor &features, QString attributeOutput);
     void outputSVM(Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token,
-                   QHash<QString, RealValueList> &features, QTextStream &out);
+                   const SyllableFeatureExtractor &features, QTextStream &out);
     int outputCRF(Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token,
-                  QHash<QString, RealValueList> &features, bool withPOS, QTextStream &out,
+                  const SyllableFeatureExtractor &features, bool withPOS, QTextStream &out,
                   bool createSequences = true);
     Praaline::Core::IntervalTier *annotateWithCRF(
             Praaline::Core::IntervalTier *tier_syll, Praaline::Core::IntervalTier *tier_token,
-            QHash<QString, RealValueList> &features, bool withPOS,
+            const SyllableFeatureExtractor &features, bool withPOS,
             const QString &filenameModel, const QString &tierName = "promise");
 
     SyllableProminenceAnnotatorData *d;
@@ -65,6 +65,7 @@ HEADERS += \
     pluginprosobox5.h \
     attributenametranslation.h \
     ProsodicBoundariesAnnotator.h \
+    SyllableFeatureExtractor.h \
     SyllableProminenceAnnotator.h \
     SpeechRateEstimator.h \
     PluginPromise.h \
@@ -76,6 +77,7 @@ SOURCES += \
     pluginprosobox5.cpp \
     attributenametranslation.cpp \
     ProsodicBoundariesAnnotator.cpp \
+    SyllableFeatureExtractor.cpp \
     SyllableProminenceAnnotator.cpp \
     SpeechRateEstimator.cpp \
     PluginPromise.cpp \
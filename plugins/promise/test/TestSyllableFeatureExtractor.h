@@ -0,0 +1,167 @@
+#ifndef TEST_SYLLABLEFEATUREEXTRACTOR_H
+#define TEST_SYLLABLEFEATUREEXTRACTOR_H
+
+#include <cmath>
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineCore/Statistics/Measures.h"
+#include "SyllableFeatureExtractor.h"
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QtTest>
+
+using namespace Praaline::Core;
+
+// Each column of the extractor must be equal to the value computed syllable by syllable with Measures::mean (smoothing)
+// and Measures::relative, as the Promise annotators did before the extractor.
+class TestSyllableFeatureExtractor : public QObject
+{
+    Q_OBJECT
+
+    struct Relative {
+        QString featureID; QString attributeID; int left; int right; QString check; bool logarithmic;
+    };
+
+    // Syllables with pauses every few syllables, some syllables not stylised (f0_min = 0) and one run of syllables
+    // between two pauses that has no stylised syllable at all
+    static IntervalTier *syllableTier(quint32 seed) {
+        QList<Interval *> intervals;
+        double t = 0.0;
+        for (int i = 0; i < 240; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            double r = (seed >> 8) / 16777216.0;
+            bool pause = (i == 0) || (i % 11 == 0) || (i == 63) || (i == 64);
+            double duration = pause ? 0.1 + 0.5 * r : 0.08 + 0.25 * r;
+            Interval *syll = new Interval(RealTime::fromSeconds(t), RealTime::fromSeconds(t + duration), pause ? "_" : "la");
+            syll->setAttribute("duration", duration);
+            bool stylised = !pause && !(i >= 56 && i <= 62) && ((seed >> 4) % 5 != 0);
+            if (stylised) {
+                double f0 = 90.0 + 120.0 * r;
+                syll->setAttribute("f0_min", f0 - 10.0 * r);
+                syll->setAttribute("f0_max", f0 + 15.0 * r);
+                syll->setAttribute("f0_mean", 12.0 * log2(f0));
+                syll->setAttribute("int_peak", 60.0 + 20.0 * r);
+            } else {
+                syll->setAttribute("f0_min", 0);
+                syll->setAttribute("f0_max", 0);
+                syll->setAttribute("f0_mean", 0);
+                syll->setAttribute("int_peak", pause ? 0.0 : 55.0 + 10.0 * r);
+            }
+            syll->setAttribute("intrasyllabup", stylised ? 3.0 * r : 0.0);
+            syll->setAttribute("intrasyllabdown", stylised ? -2.0 * r : 0.0);
+            syll->setAttribute("trajectory", stylised ? 5.0 * r : 0.0);
+            intervals << syll;
+            t += duration;
+        }
+        return new IntervalTier("syll", intervals, RealTime::zeroTime, RealTime::fromSeconds(t));
+    }
+
+    // The per-syllable computation replaced by SyllableFeatureExtractor::extract
+    static QHash<QString, QList<double> > referenceFeatures(IntervalTier *tier_syll, const QStringList &smoothed,
+                                                          const QList<Relative> &relatives) {
+        QHash<QString, QList<double> > features;
+        for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
+            Interval *syll = tier_syll->interval(isyll);
+            syll->setAttribute("duration_log", log(syll->attribute("duration").toDouble()));
+            if (!syll->isPauseSilent() && syll->attribute("f0_min").toInt() == 0) {
+                foreach (QString attributeID, smoothed)
+                    syll->setAttribute(attributeID, Measures::mean(tier_syll, attributeID, isyll, 4, 4, true, "f0_min"));
+            }
+            if (syll->attribute("f0_min").toInt() > 0)
+                syll->setAttribute("f0_max_st", 12.0 * log2(syll->attribute("f0_max").toDouble()));
+        }
+        for (int isyll = 0; isyll < tier_syll->count(); isyll++) {
+            Interval *syll = tier_syll->interval(isyll);
+            foreach (Relative rel, relatives)
+                features[rel.featureID] << Measures::relative(tier_syll, rel.attributeID, isyll, rel.left, rel.right, true,
+                                                              rel.check, rel.logarithmic);
+            double up = syll->attribute("intrasyllabup").toDouble();
+            double down = syll->attribute("intrasyllabdown").toDouble();
+            features["f0_mean_st"] << syll->attribute("f0_mean").toDouble();
+            features["f0_up"] << up;
+            features["f0_down"] << down;
+            features["f0_mvt"] << (up + down);
+            features["f0_traj"] << syll->attribute("trajectory").toDouble();
+            features["intensity"] << syll->attribute("int_peak").toDouble();
+            if (isyll < tier_syll->count() - 1 && tier_syll->interval(isyll + 1)->isPauseSilent()) {
+                double pausedur = tier_syll->interval(isyll + 1)->duration().toDouble();
+                features["following_pause_dur"] << pausedur;
+                features["following_pause_dur_log"] << log(pausedur);
+            } else {
+                features["following_pause_dur"] << 0.0;
+                features["following_pause_dur_log"] << 0.0;
+            }
+        }
+        return features;
+    }
+
+    static bool same(double a, double b) {
+        if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+        if (std::isinf(a) || std::isinf(b)) return a == b;
+        return qAbs(a - b) <= 1e-9 * qMax(1.0, qAbs(b));
+    }
+
+    static void compare(const QStringList &smoothed, const QList<Relative> &relatives) {
+        QScopedPointer<IntervalTier> tierReference(syllableTier(42));
+        QScopedPointer<IntervalTier> tierExtracted(syllableTier(42));
+        QHash<QString, QList<double> > reference = referenceFeatures(tierReference.data(), smoothed, relatives);
+
+        SyllableFeatureExtractor extractor;
+        extractor.setSmoothedAttributes(smoothed);
+        foreach (Relative rel, relatives)
+            extractor.addRelativeFeature(rel.featureID, rel.attributeID, rel.left, rel.right, rel.check, rel.logarithmic);
+        extractor.extract(tierExtracted.data());
+        QCOMPARE(extractor.count(), tierReference->count());
+
+        foreach (QString featureID, reference.keys()) {
+            QVERIFY2(extractor.hasFeature(featureID), qPrintable(featureID));
+            const QVector<double> &column = extractor.column(featureID);
+            QCOMPARE(column.count(), reference.value(featureID).count());
+            for (int i = 0; i < column.count(); ++i) {
+                QVERIFY2(same(column.at(i), reference.value(featureID).at(i)),
+                         qPrintable(QString("%1, syllable %2: %3 instead of %4").arg(featureID).arg(i)
+                                    .arg(column.at(i)).arg(reference.value(featureID).at(i))));
+            }
+        }
+        // Attributes set on the syllables
+        QStringList attributeIDs = QStringList(smoothed) << "duration_log" << "f0_max_st";
+        for (int i = 0; i < tierReference->count(); ++i) {
+            foreach (QString attributeID, attributeIDs) {
+                QVariant expected = tierReference->interval(i)->attribute(attributeID);
+                QVariant actual = tierExtracted->interval(i)->attribute(attributeID);
+                QCOMPARE(actual.isValid(), expected.isValid());
+                QVERIFY2(same(actual.toDouble(), expected.toDouble()),
+                         qPrintable(QString("%1, syllable %2").arg(attributeID).arg(i)));
+            }
+        }
+    }
+
+private slots:
+    // Features of SyllableProminenceAnnotator::prepareFeatures
+    void prominenceFeatures() {
+        QList<Relative> relatives;
+        relatives << Relative{"syll_dur_rel22", "duration", 2, 2, "", false}
+                  << Relative{"syll_dur_rel44", "duration", 4, 4, "", false}
+                  << Relative{"syll_dur_log_rel33", "duration_log", 3, 3, "", true}
+                  << Relative{"syll_dur_log_rel55", "duration_log", 5, 5, "", true}
+                  << Relative{"f0_max_st_rel22", "f0_max_st", 2, 2, "f0_min", true}
+                  << Relative{"f0_max_st_rel55", "f0_max_st", 5, 5, "f0_min", true}
+                  << Relative{"f0_mean_st_rel33", "f0_mean", 3, 3, "f0_min", true}
+                  << Relative{"intensity_rel44", "int_peak", 4, 4, "f0_min", true};
+        compare(QStringList() << "f0_min" << "f0_max" << "f0_mean" << "int_peak", relatives);
+    }
+
+    // Features of ProsodicBoundariesAnnotator::prepareFeatures: windows to the left only
+    void boundaryFeatures() {
+        QList<Relative> relatives;
+        relatives << Relative{"syll_dur_rel20", "duration", 2, 0, "", false}
+                  << Relative{"syll_dur_rel40", "duration", 4, 0, "", false}
+                  << Relative{"syll_dur_log_rel30", "duration_log", 3, 0, "", true}
+                  << Relative{"f0_mean_st_rel20", "f0_mean", 2, 0, "f0_min", true}
+                  << Relative{"f0_mean_st_rel50", "f0_mean", 5, 0, "f0_min", true};
+        compare(QStringList() << "f0_min" << "f0_max" << "f0_mean", relatives);
+    }
+};
+
+#endif // TEST_SYLLABLEFEATUREEXTRACTOR_H
@@ -0,0 +1,37 @@
+TEMPLATE = app
+
+CONFIG( debug, debug|release ) {
+    COMPONENTSPATH = build/debug
+} else {
+    COMPONENTSPATH = build/release
+}
+
+DEFINES += USE_NAMESPACE_PRAALINE_CORE
+INCLUDEPATH += .. ../../../praaline-core/include
+DEPENDPATH += ..
+
+LIBS += -L../../../praaline-core/$${COMPONENTSPATH} -lpraaline-core$${PRAALINE_LIB_POSTFIX}
+
+CONFIG += qt thread warn_on stl rtti exceptions console c++11
+QT += testlib
+QT -= gui
+
+TARGET = promise-test
+
+OBJECTS_DIR = o
+MOC_DIR = o
+
+HEADERS += TestSyllableFeatureExtractor.h
+SOURCES += main.cpp \
+    ../SyllableFeatureExtractor.cpp
+
+!win32 {
+    !macx* {
+        QMAKE_POST_LINK=./$${TARGET}
+    }
+    macx* {
+        QMAKE_POST_LINK=./$${TARGET}.app/Contents/MacOS/$${TARGET}
+    }
+}
+
+win32:QMAKE_POST_LINK=./release/$${TARGET}.exe
@@ -1,101 +1,258 @@
 #include <QDebug>
 #include <QString>
 #include <QList>
+#include <QHash>
+#include <QMap>
 #include <QFile>
-#include <QTextStream>
+#include <cstring>
 #include "CoNLLUReader.h"
 #include "UDSentence.h"
 
-CoNLLUReader::CoNLLUReader()
+struct CoNLLUReaderData {
+    CoNLLUReaderData() : sentencesRead(0), lineNumber(0), stopped(false) {}
+
+    CoNLLUReader::SentenceHandler handler;
+    UDSentence sentence;
+    int sentencesRead;
+    qint64 lineNumber;
+    bool stopped;
+    QString errorMessage;
+    // Interned values, by their UTF-8 bytes: tags (UPOS, XPOS, DEPREL), words (FORM, LEMMA) and FEATS
+    QHash<QByteArray, QString> tags;
+    QHash<QByteArray, QString> words;
+    QHash<QByteArray, QMap<QString, QString> > features;
+};
+
+// Values are interned until the tables reach this size, so that unique values (e.g. in MISC) do not make them grow
+// without bound
+static const int maxInterned = 1 << 16;
+
+CoNLLUReader::CoNLLUReader() :
+    d(new CoNLLUReaderData())
 {
 }
 
-// static
-bool CoNLLUReader::readCoNLLU(const QString &filename, QList<UDSentence> &sentences)
+CoNLLUReader::~CoNLLUReader()
+{
+    delete d;
+}
+
+QString CoNLLUReader::errorMessage() const
+{
+    return d->errorMessage;
+}
+
+int CoNLLUReader::sentencesRead() const
+{
+    return d->sentencesRead;
+}
+
+// ====================================================================================================================
+// Fields
+// ====================================================================================================================
+
+namespace {
+
+struct Field {
+    const char *data;
+    int length;
+    bool isEmpty() const { return length == 0 || (length == 1 && data[0] == '_'); }
+};
+
+QString intern(QHash<QByteArray, QString> &table, const Field &field)
 {
-    // Read CoNLLU file
+    if (field.isEmpty()) return QString();
+    QByteArray key = QByteArray::fromRawData(field.data, field.length);
+    QHash<QByteArray, QString>::const_iterator i = table.constFind(key);
+    if (i != table.constEnd()) return i.value();
+    QString value = QString::fromUtf8(field.data, field.length);
+    if (table.count() < maxInterned) table.insert(QByteArray(field.data, field.length), value);
+    return value;
+}
+
+// FEATS and MISC: Key=Value pairs separated by |
+QMap<QString, QString> internAttributes(QHash<QByteArray, QMap<QString, QString> > &table, const Field &field)
+{
+    if (field.isEmpty()) return QMap<QString, QString>();
+    QByteArray key = QByteArray::fromRawData(field.data, field.length);
+    QHash<QByteArray, QMap<QString, QString> >::const_iterator i = table.constFind(key);
+    if (i != table.constEnd()) return i.value();
+    QMap<QString, QString> attributes;
+    foreach (QString pair, QString::fromUtf8(field.data, field.length).split("|")) {
+        int eq = pair.indexOf("=");
+        if (eq < 0) continue;
+        attributes.insert(pair.left(eq), pair.mid(eq + 1));
+    }
+    if (table.count() < maxInterned) table.insert(QByteArray(field.data, field.length), attributes);
+    return attributes;
+}
+
+int toInt(const char *data, int length, bool *ok = nullptr)
+{
+    int value = 0;
+    bool valid = (length > 0);
+    for (int i = 0; i < length; ++i) {
+        if (data[i] < '0' || data[i] > '9') { valid = false; break; }
+        value = value * 10 + (data[i] - '0');
+    }
+    if (ok) *ok = valid;
+    return valid ? value : -1;
+}
+
+// LEMMA to MISC
+void setFields(UDToken &token, const Field *fields, CoNLLUReaderData *d)
+{
+    // A lemma of _ is only empty if the form is not _ as well
+    if (!fields[2].isEmpty()) token.setLemma(intern(d->words, fields[2]));
+    else if (token.form() == "_" && fields[2].length == 1) token.setLemma("_");
+    token.setUPOSTag(intern(d->tags, fields[3]));
+    token.setXPOSTag(intern(d->tags, fields[4]));
+    token.setFeats(internAttributes(d->features, fields[5]));
+    token.setHead(fields[6].isEmpty() ? -1 : toInt(fields[6].data, fields[6].length));
+    token.setDepRel(intern(d->tags, fields[7]));
+    if (!fields[8].isEmpty()) token.setDepsFromString(QString::fromUtf8(fields[8].data, fields[8].length));
+    if (!fields[9].isEmpty()) token.setMiscFromString(QString::fromUtf8(fields[9].data, fields[9].length));
+}
+
+}
+
+// ====================================================================================================================
+// Reading
+// ====================================================================================================================
+
+bool CoNLLUReader::finishSentence()
+{
+    UDSentence &sentence = d->sentence;
+    if (sentence.empty() && sentence.comments().isEmpty() && sentence.tokensMultiword().isEmpty()) return true;
+    // Link heads and children now that all tokens are known
+    for (int id = 1; id < sentence.tokens().count(); ++id) {
+        const UDToken &token = sentence.tokens().at(id);
+        if (token.head() >= 0) sentence.setHead(id, token.head(), token.depRel());
+    }
+    d->sentencesRead++;
+    if (d->handler && !d->handler(sentence)) d->stopped = true;
+    sentence.clear();
+    return !d->stopped;
+}
+
+bool CoNLLUReader::readLine(const char *line, int length)
+{
+    d->lineNumber++;
+    if (length > 0 && line[length - 1] == '\r') length--;
+    int start = 0;
+    while (start < length && (line[start] == ' ' || line[start] == '\t')) start++;
+    if (start == length) return finishSentence();
+    if (line[start] == '#') {
+        d->sentence.comments() << QString::fromUtf8(line + start, length - start);
+        return true;
+    }
+
+    // Split the ten fields in place
+    Field fields[10];
+    int count = 0;
+    const char *p = line, *end = line + length;
+    while (count < 10) {
+        const char *tab = (count < 9) ? static_cast<const char *>(memchr(p, '\t', end - p)) : nullptr;
+        const char *fieldEnd = tab ? tab : end;
+        fields[count].data = p;
+        fields[count].length = static_cast<int>(fieldEnd - p);
+        count++;
+        if (!tab) break;
+        p = tab + 1;
+    }
+    if (count < 10) {
+        qDebug() << "Less than 10 fields in line " << d->lineNumber;
+        return true;
+    }
+
+    // ID: n, n-m (multi-word token) or n.k (empty node)
+    const Field &id = fields[0];
+    const char *dash = static_cast<const char *>(memchr(id.data, '-', id.length));
+    const char *dot = static_cast<const char *>(memchr(id.data, '.', id.length));
+    // FORM is never empty: _ is an underscore
+    QString form = fields[1].isEmpty() ? QString("_") : intern(d->words, fields[1]);
+    if (dash) {
+        int first = toInt(id.data, static_cast<int>(dash - id.data));
+        int last = toInt(dash + 1, static_cast<int>(id.data + id.length - dash - 1));
+        UDTokenMultiWord token(first, last, form, QString());
+        if (!fields[9].isEmpty()) token.setMiscFromString(QString::fromUtf8(fields[9].data, fields[9].length));
+        d->sentence.tokensMultiword() << token;
+        return true;
+    }
+
+    if (dot) {
+        UDEmptyNode node(toInt(id.data, static_cast<int>(dot - id.data)),
+                         toInt(dot + 1, static_cast<int>(id.data + id.length - dot - 1)));
+        node.setForm(form);
+        setFields(node, fields, d);
+        d->sentence.emptyNodes() << node;
+        return true;
+    }
+
+    bool ok = false;
+    int n = toInt(id.data, id.length, &ok);
+    if (!ok || n != d->sentence.tokens().count()) {
+        d->errorMessage = QString("Unexpected token ID %1 in line %2")
+                .arg(QString::fromUtf8(id.data, id.length)).arg(d->lineNumber);
+        return false;
+    }
+    setFields(d->sentence.addToken(form), fields, d);
+    return true;
+}
+
+bool CoNLLUReader::read(const QString &filename, SentenceHandler handler)
+{
+    d->handler = handler;
+    d->sentence.clear();
+    d->sentencesRead = 0;
+    d->lineNumber = 0;
+    d->stopped = false;
+    d->errorMessage.clear();
+
     QFile file(filename);
-    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) ) return false;
-    // File opened ok
-    sentences.clear();
-    QString line;
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
-    int lineNumber = 1;
-    int rangeFrom = 0, rangeTo = 0;
-    // Current sentence
-    UDSentence sent;
-    QString currentSentenceID;
-    int sentenceFrom = 0, sentenceTo = 0;
-
-    do {
-        line = stream.readLine().trimmed();
-        if (line.startsWith("# sentid:")) {
-            currentSentenceID = line.section(":", 1, 1).trimmed();
-            sentenceFrom = lineNumber;
-            rangeFrom = rangeTo = 0;
-            continue;
-        }
-        else if (line.isEmpty()) {
-            sentenceTo = lineNumber - 1;
-            //intervals_sentences << new Interval(RealTime(sentenceFrom, 0), RealTime(sentenceTo, 0), currentSentenceID);
-            Q_UNUSED(sentenceFrom)
-            Q_UNUSED(sentenceTo)
-            rangeFrom = rangeTo = 0;
-            continue;
-        }
-        else if (line.startsWith("#")) {
-            // skip comments, reset
-            rangeFrom = rangeTo = 0;
-            continue;
-        }
-        // otherwise this line is a word / minimal word
-        QStringList fields = line.split("\t");
-        if (fields.count() < 10) {
-            qDebug() << "Less than 10 fields in line " << lineNumber;
-            rangeFrom = rangeTo = 0;
-            continue;
-        }
-        QString id = fields.at(0);
-        if (rangeFrom != 0) {
-            // we are inside a range, check if finished
-            if (id.toInt() == rangeTo) {
-                rangeFrom = rangeTo = 0; // finished
-            }
-            // in any case skip this token
-            continue;
+    if (!file.open(QIODevice::ReadOnly)) {
+        d->errorMessage = QString("Cannot open file %1").arg(filename);
+        return false;
+    }
+    bool ok = true;
+    qint64 size = file.size();
+    const char *data = (size > 0) ? reinterpret_cast<const char *>(file.map(0, size)) : nullptr;
+    if (data) {
+        const char *p = data, *end = data + size;
+        // Skip the UTF-8 byte order mark
+        if (size >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+        while (p < end && ok) {
+            const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+            if (!eol) eol = end;
+            ok = readLine(p, static_cast<int>(eol - p));
+            p = eol + 1;
         }
-        // begin a new range?
-        if (id.contains("-")) {
-            // begin range
-            rangeFrom = id.section("-", 0, 0).toInt();
-            rangeTo = id.section("-", 1, 1).toInt();
+        file.unmap(const_cast<uchar *>(reinterpret_cast<const uchar *>(data)));
+    } else {
+        // The file could not be mapped (e.g. a file larger than the address space): read it line by line
+        QByteArray line;
+        bool first = true;
+        while (ok && !file.atEnd()) {
+            line = file.readLine();
+            if (first && line.startsWith("\xEF\xBB\xBF")) line.remove(0, 3);
+            first = false;
+            if (line.endsWith('\n')) line.chop(1);
+            ok = readLine(line.constData(), line.length());
         }
-        UDToken token;
-        token.setID(fields.at(0).toInt());
-        token.setForm(fields.at(1));
-        token.setLemma(fields.at(2));
-        token.setUPOSTag(fields.at(3));
-        token.setXPOSTag(fields.at(4));
-        token.setFeatsFromString(fields.at(5));
-        token.setHead(fields.at(6).toInt());
-        token.setDepRel(fields.at(7));
-        token.setDepsFromString(fields.at(8));
-        token.setMiscFromString(fields.at(9));
-
-        // Interval *intv = new Interval(RealTime(lineNumber - 1, 0), RealTime(lineNumber, 0), fields.at(1));
-
-        if (lineNumber % 10000 == 0) qDebug() << lineNumber << "\t" << fields.at(1);
-        ++lineNumber;
     }
-    while (!stream.atEnd());
+    if (ok) finishSentence();
     file.close();
-//    IntervalTier *tier_words = new IntervalTier("ud_words");
-//    tier_words->replaceAllIntervals(intervals_words);
-//    IntervalTier *tier_sentences = new IntervalTier("ud_sentences");
-//    tier_sentences->replaceAllIntervals(intervals_sentences);
-//    group->addTierReplacing(tier_words);
-//    group->addTierReplacing(tier_sentences);
-    return true;
+    d->handler = SentenceHandler();
+    return d->errorMessage.isEmpty();
 }
 
+// static
+bool CoNLLUReader::readCoNLLU(const QString &filename, QList<UDSentence> &sentences)
+{
+    sentences.clear();
+    CoNLLUReader reader;
+    return reader.read(filename, [&sentences](UDSentence &sentence) {
+        sentences << sentence;
+        return true;
+    });
+}
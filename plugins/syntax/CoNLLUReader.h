@@ -2,15 +2,37 @@
 #define CONLLUREADER_H
 
 #include <QString>
+#include <QList>
+#include <functional>
 #include "UDSentence.h"
 
+struct CoNLLUReaderData;
+
+// Reads CoNLL-U files one sentence at a time, so that memory use does not depend on the size of the file. The file is
+// memory-mapped and its fields are scanned in place; values that repeat (tags, features, relations) are shared
+// between the tokens that have them.
 class CoNLLUReader
 {
 public:
+    // Called for each sentence read. The sentence is reused for the next one: copy it to keep it. Return false to
+    // stop reading.
+    typedef std::function<bool(UDSentence &)> SentenceHandler;
+
+    CoNLLUReader();
+    ~CoNLLUReader();
+
+    bool read(const QString &filename, SentenceHandler handler);
+    QString errorMessage() const;
+    int sentencesRead() const;
+
+    // Read the whole file into a list of sentences
     static bool readCoNLLU(const QString &filename, QList<UDSentence> &sentences);
 
 private:
-    CoNLLUReader();
+    CoNLLUReaderData *d;
+
+    bool readLine(const char *line, int length);
+    bool finishSentence();
 };
 
 #endif // CONLLUREADER_H
@@ -0,0 +1,140 @@
+#include <QString>
+#include <QList>
+#include <QFile>
+#include "CoNLLUWriter.h"
+#include "UDSentence.h"
+
+struct CoNLLUWriterData {
+    QFile file;
+    QByteArray buffer;
+    QString errorMessage;
+};
+
+// Sentences are collected in a buffer of this size before being written out
+static const int bufferSize = 1 << 20;
+
+CoNLLUWriter::CoNLLUWriter() :
+    d(new CoNLLUWriterData())
+{
+}
+
+CoNLLUWriter::~CoNLLUWriter()
+{
+    close();
+    delete d;
+}
+
+QString CoNLLUWriter::errorMessage() const
+{
+    return d->errorMessage;
+}
+
+bool CoNLLUWriter::open(const QString &filename)
+{
+    close();
+    d->errorMessage.clear();
+    d->file.setFileName(filename);
+    if (!d->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        d->errorMessage = QString("Cannot open file %1 for writing").arg(filename);
+        return false;
+    }
+    d->buffer.reserve(bufferSize + 4096);
+    return true;
+}
+
+bool CoNLLUWriter::flush()
+{
+    if (d->buffer.isEmpty()) return true;
+    if (d->file.write(d->buffer) != d->buffer.size()) {
+        d->errorMessage = QString("Error writing to file %1").arg(d->file.fileName());
+        d->buffer.clear();
+        return false;
+    }
+    d->buffer.clear();
+    return true;
+}
+
+bool CoNLLUWriter::close()
+{
+    if (!d->file.isOpen()) return d->errorMessage.isEmpty();
+    bool ok = flush();
+    d->file.close();
+    return ok && d->errorMessage.isEmpty();
+}
+
+// ====================================================================================================================
+// Sentences
+// ====================================================================================================================
+
+namespace {
+
+inline void appendField(QByteArray &buffer, const QString &value)
+{
+    buffer.append('\t');
+    if (value.isEmpty()) buffer.append('_'); else buffer.append(value.toUtf8());
+}
+
+void appendToken(QByteArray &buffer, const QByteArray &id, const UDToken &token)
+{
+    buffer.append(id);
+    appendField(buffer, token.form());
+    appendField(buffer, token.lemma());
+    appendField(buffer, token.UPOSTag());
+    appendField(buffer, token.XPOSTag());
+    appendField(buffer, token.featsToString());
+    buffer.append('\t');
+    if (token.head() >= 0) buffer.append(QByteArray::number(token.head())); else buffer.append('_');
+    appendField(buffer, token.depRel());
+    appendField(buffer, token.depsToString());
+    appendField(buffer, token.miscToString());
+    buffer.append('\n');
+}
+
+}
+
+bool CoNLLUWriter::writeSentence(const UDSentence &sentence)
+{
+    if (!d->file.isOpen()) {
+        d->errorMessage = "No CoNLL-U file open for writing";
+        return false;
+    }
+    QByteArray &buffer = d->buffer;
+    foreach (const QString &comment, sentence.comments()) {
+        buffer.append(comment.toUtf8()).append('\n');
+    }
+    const QList<UDToken> &tokens = sentence.tokens();
+    const QList<UDTokenMultiWord> &multiwords = sentence.tokensMultiword();
+    const QList<UDEmptyNode> &emptyNodes = sentence.emptyNodes();
+    // Multi-word tokens come before their first word, empty nodes after the word they follow
+    for (int id = 0; id < tokens.count(); ++id) {
+        if (id > 0) {
+            foreach (const UDTokenMultiWord &mwt, multiwords) {
+                if (mwt.IDFirst() != id) continue;
+                buffer.append(QByteArray::number(mwt.IDFirst())).append('-').append(QByteArray::number(mwt.IDLast()));
+                appendField(buffer, mwt.form());
+                buffer.append("\t_\t_\t_\t_\t_\t_\t_");
+                appendField(buffer, mwt.miscToString());
+                buffer.append('\n');
+            }
+            appendToken(buffer, QByteArray::number(id), tokens.at(id));
+        }
+        foreach (const UDEmptyNode &node, emptyNodes) {
+            if (node.ID() != id) continue;
+            appendToken(buffer, QByteArray::number(node.ID()) + "." + QByteArray::number(node.index()), node);
+        }
+    }
+    buffer.append('\n');
+    if (buffer.size() >= bufferSize) return flush();
+    return true;
+}
+
+// static
+bool CoNLLUWriter::writeCoNLLU(const QString &filename, const QList<UDSentence> &sentences)
+{
+    CoNLLUWriter writer;
+    if (!writer.open(filename)) return false;
+    foreach (const UDSentence &sentence, sentences) {
+        if (!writer.writeSentence(sentence)) return false;
+    }
+    return writer.close();
+}
@@ -0,0 +1,31 @@
+#ifndef CONLLUWRITER_H
+#define CONLLUWRITER_H
+
+#include <QString>
+#include <QList>
+#include "UDSentence.h"
+
+struct CoNLLUWriterData;
+
+// Writes CoNLL-U files one sentence at a time (the counterpart of CoNLLUReader)
+class CoNLLUWriter
+{
+public:
+    CoNLLUWriter();
+    ~CoNLLUWriter();
+
+    bool open(const QString &filename);
+    bool writeSentence(const UDSentence &sentence);
+    bool close();
+    QString errorMessage() const;
+
+    // Write a list of sentences to a file
+    static bool writeCoNLLU(const QString &filename, const QList<UDSentence> &sentences);
+
+private:
+    CoNLLUWriterData *d;
+
+    bool flush();
+};
+
+#endif // CONLLUWRITER_H
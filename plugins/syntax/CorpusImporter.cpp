@@ -8,6 +8,7 @@
 #include <QDebug>
 #include "PraalineCore/Annotation/IntervalTier.h"
 #include "PraalineCore/Annotation/AnnotationTierGroup.h"
+#include "CoNLLUReader.h"
 #include "CorpusImporter.h"
 
 CorpusImporter::CorpusImporter()
@@ -62,3 +63,48 @@ bool CorpusImporter::readPerceo(const QString &filename, SpeakerAnnotationTierGr
     }
     return true;
 }
+
+// Words and sentences of a CoNLL-U file, one second per word as for Perceo. The file is read a sentence at a time.
+bool CorpusImporter::readCoNLLU(const QString &filename, const QString &speakerID, SpeakerAnnotationTierGroupMap &tiers,
+                                QString &errorMessage)
+{
+    QList<Interval *> intervals_words;
+    QList<Interval *> intervals_sentences;
+    int wordNo = 0;
+    CoNLLUReader reader;
+    bool ok = reader.read(filename, [&](UDSentence &sentence) {
+        if (sentence.empty()) return true;
+        int sentenceStart = wordNo;
+        for (int id = 1; id < sentence.tokens().count(); ++id) {
+            const UDToken &token = sentence.tokens().at(id);
+            Interval *intv = new Interval(RealTime(wordNo, 0), RealTime(wordNo + 1, 0), token.form());
+            intv->setAttribute("lemma", token.lemma());
+            intv->setAttribute("upos", token.UPOSTag());
+            intv->setAttribute("xpos", token.XPOSTag());
+            intv->setAttribute("feats", token.featsToString());
+            intv->setAttribute("head", token.head());
+            intv->setAttribute("deprel", token.depRel());
+            intervals_words << intv;
+            ++wordNo;
+        }
+        QString sentenceID;
+        sentence.getSentID(sentenceID);
+        intervals_sentences << new Interval(RealTime(sentenceStart, 0), RealTime(wordNo, 0), sentenceID);
+        return true;
+    });
+    if (!ok) {
+        errorMessage = reader.errorMessage();
+        qDeleteAll(intervals_words);
+        qDeleteAll(intervals_sentences);
+        return false;
+    }
+    AnnotationTierGroup *tiersForSpeaker = new AnnotationTierGroup();
+    IntervalTier *tier_words = new IntervalTier("ud_words");
+    tier_words->replaceAllIntervals(intervals_words);
+    tiersForSpeaker->addTierReplacing(tier_words);
+    IntervalTier *tier_sentences = new IntervalTier("ud_sentences");
+    tier_sentences->replaceAllIntervals(intervals_sentences);
+    tiersForSpeaker->addTierReplacing(tier_sentences);
+    tiers.insert(speakerID, tiersForSpeaker);
+    return true;
+}
@@ -14,6 +14,8 @@ public:
     CorpusImporter();
 
     static bool readPerceo(const QString &filename, SpeakerAnnotationTierGroupMap &tiers);
+    static bool readCoNLLU(const QString &filename, const QString &speakerID, SpeakerAnnotationTierGroupMap &tiers,
+                           QString &errorMessage);
 };
 
 #endif // CORPUSIMPORTER_H
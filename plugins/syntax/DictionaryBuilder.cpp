@@ -1,6 +1,81 @@
+#include <QString>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QStringList>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include "CoNLLUReader.h"
 #include "DictionaryBuilder.h"
 
-DictionaryBuilder::DictionaryBuilder()
+struct DictionaryBuilderData {
+    // form -> (lemma, UPOS) -> frequency
+    QHash<QString, QHash<QPair<QString, QString>, int> > entries;
+};
+
+DictionaryBuilder::DictionaryBuilder() :
+    d(new DictionaryBuilderData())
+{
+}
+
+DictionaryBuilder::~DictionaryBuilder()
+{
+    delete d;
+}
+
+bool DictionaryBuilder::addCoNLLU(const QString &filename, QString &errorMessage)
+{
+    CoNLLUReader reader;
+    bool ok = reader.read(filename, [this](UDSentence &sentence) {
+        for (int id = 1; id < sentence.tokens().count(); ++id) {
+            const UDToken &token = sentence.tokens().at(id);
+            d->entries[token.form()][QPair<QString, QString>(token.lemma(), token.UPOSTag())]++;
+        }
+        return true;
+    });
+    if (!ok) errorMessage = reader.errorMessage();
+    return ok;
+}
+
+int DictionaryBuilder::count(const QString &form, const QString &lemma, const QString &UPOS) const
 {
+    return d->entries.value(form).value(QPair<QString, QString>(lemma, UPOS), 0);
+}
+
+int DictionaryBuilder::countEntries() const
+{
+    int n = 0;
+    foreach (const QString &form, d->entries.keys()) {
+        n += d->entries.value(form).count();
+    }
+    return n;
+}
 
+void DictionaryBuilder::clear()
+{
+    d->entries.clear();
+}
+
+bool DictionaryBuilder::writeDictionary(const QString &filename, QString &errorMessage) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorMessage = QString("Cannot open file %1 for writing").arg(filename);
+        return false;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    QStringList forms = d->entries.keys();
+    std::sort(forms.begin(), forms.end());
+    foreach (const QString &form, forms) {
+        const QHash<QPair<QString, QString>, int> &analyses = d->entries[form];
+        QList<QPair<QString, QString> > keys = analyses.keys();
+        std::sort(keys.begin(), keys.end());
+        foreach (const QPair<QString, QString> &key, keys) {
+            out << form << "\t" << key.first << "\t" << key.second << "\t" << analyses.value(key) << "\n";
+        }
+    }
+    file.close();
+    return true;
 }
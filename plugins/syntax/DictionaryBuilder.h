@@ -1,11 +1,28 @@
 #ifndef DICTIONARYBUILDER_H
 #define DICTIONARYBUILDER_H
 
+#include <QString>
 
+struct DictionaryBuilderData;
+
+// Builds a form / lemma / part-of-speech dictionary, with frequencies, from CoNLL-U files. Files are read a sentence
+// at a time, so that only the dictionary is kept in memory.
 class DictionaryBuilder
 {
 public:
     DictionaryBuilder();
+    ~DictionaryBuilder();
+
+    bool addCoNLLU(const QString &filename, QString &errorMessage);
+    int count(const QString &form, const QString &lemma, const QString &UPOS) const;
+    int countEntries() const;
+    void clear();
+
+    // Tab-separated form, lemma, UPOS and frequency, by form
+    bool writeDictionary(const QString &filename, QString &errorMessage) const;
+
+private:
+    DictionaryBuilderData *d;
 };
 
-#endif // DICTIONARYBUILDER_H
\ No newline at end of file
+#endif // DICTIONARYBUILDER_H
@@ -1,7 +1,10 @@
 #include "UDSentence.h"
 
+const QString UDSentence::root_form = "<root>";
+
 UDSentence::UDSentence()
 {
+    clear();
 }
 
 UDSentence::~UDSentence()
@@ -11,74 +14,168 @@ UDSentence::~UDSentence()
 // Basic sentence modifications
 bool UDSentence::empty()
 {
-    return false;
+    return m_tokens.count() == 1;
 }
 
 void UDSentence::clear()
 {
+    m_tokens.clear();
+    m_tokensMultiword.clear();
+    m_emptyNodes.clear();
+    m_comments.clear();
+
+    UDToken root(0, root_form);
+    root.setLemma(root_form);
+    root.setUPOSTag(root_form);
+    root.setXPOSTag(root_form);
+    m_tokens << root;
 }
 
 UDToken& UDSentence::addToken(const QString &form)
 {
-    // TODO: Implement this!
-    Q_UNUSED(form)
-    return m_tokens[0];
+    m_tokens << UDToken(m_tokens.count(), form);
+    return m_tokens.last();
 }
 
 void UDSentence::setHead(int id, int head, const QString &deprel)
 {
-    Q_UNUSED(id)
-    Q_UNUSED(head)
-    Q_UNUSED(deprel)
+    if (id < 0 || id >= m_tokens.count()) return;
+    if (head >= m_tokens.count()) return;
+
+    // Remove the existing head
+    int previousHead = m_tokens[id].head();
+    if (previousHead >= 0 && previousHead < m_tokens.count()) {
+        m_tokens[previousHead].children().removeOne(id);
+    }
+
+    // Set the new head, keeping the children of each token sorted
+    m_tokens[id].setHead(head);
+    m_tokens[id].setDepRel(deprel);
+    if (head >= 0) {
+        QList<int> &children = m_tokens[head].children();
+        int i = children.count();
+        while (i > 0 && children.at(i - 1) > id) i--;
+        if (i == 0 || children.at(i - 1) < id) children.insert(i, id);
+    }
 }
 
 void UDSentence::unlinkAllTokens()
 {
+    for (int i = 0; i < m_tokens.count(); ++i) {
+        m_tokens[i].setHead(-1);
+        m_tokens[i].setDepRel(QString());
+        m_tokens[i].children().clear();
+    }
+}
+
+QList<UDToken> &UDSentence::tokens()
+{
+    return m_tokens;
+}
+
+const QList<UDToken> &UDSentence::tokens() const
+{
+    return m_tokens;
+}
+
+QList<UDTokenMultiWord> &UDSentence::tokensMultiword()
+{
+    return m_tokensMultiword;
+}
+
+const QList<UDTokenMultiWord> &UDSentence::tokensMultiword() const
+{
+    return m_tokensMultiword;
+}
+
+QList<UDEmptyNode> &UDSentence::emptyNodes()
+{
+    return m_emptyNodes;
+}
+
+const QList<UDEmptyNode> &UDSentence::emptyNodes() const
+{
+    return m_emptyNodes;
+}
+
+QStringList &UDSentence::comments()
+{
+    return m_comments;
+}
+
+const QStringList &UDSentence::comments() const
+{
+    return m_comments;
 }
 
 // CoNLL-U defined comments
-bool UDSentence::getNewDoc(QString &id) const
+// A comment is either "# name" or "# name = value"
+bool UDSentence::getComment(const QString &name, QString *value) const
 {
-    Q_UNUSED(id)
+    foreach (QString comment, m_comments) {
+        if (!comment.startsWith("#")) continue;
+        QString text = comment.mid(1).trimmed();
+        if (text == name) {
+            if (value) value->clear();
+            return true;
+        }
+        if (text.startsWith(name) && text.mid(name.length()).trimmed().startsWith("=")) {
+            if (value) *value = text.section("=", 1).trimmed();
+            return true;
+        }
+    }
     return false;
 }
 
+void UDSentence::removeComment(const QString &name)
+{
+    for (int i = m_comments.count() - 1; i >= 0; --i) {
+        QString text = m_comments.at(i).mid(1).trimmed();
+        if (text == name || (text.startsWith(name) && text.mid(name.length()).trimmed().startsWith("=")))
+            m_comments.removeAt(i);
+    }
+}
+
+bool UDSentence::getNewDoc(QString &id) const
+{
+    return getComment("newdoc", &id);
+}
+
 void UDSentence::setNewDoc(bool newDoc, const QString &id)
 {
-    Q_UNUSED(newDoc)
-    Q_UNUSED(id)
+    removeComment("newdoc");
+    if (newDoc) m_comments.prepend(id.isEmpty() ? QString("# newdoc") : QString("# newdoc id = %1").arg(id));
 }
 
 bool UDSentence::getNewPar(QString &id) const
 {
-    Q_UNUSED(id)
-    return false;
+    return getComment("newpar", &id);
 }
 
 void UDSentence::setNewPar(bool newPar, const QString &id)
 {
-    Q_UNUSED(newPar)
-    Q_UNUSED(id)
+    removeComment("newpar");
+    if (newPar) m_comments << (id.isEmpty() ? QString("# newpar") : QString("# newpar id = %1").arg(id));
 }
 
 bool UDSentence::getSentID(QString &id) const
 {
-    Q_UNUSED(id)
-    return false;
+    return getComment("sent_id", &id);
 }
 
 void UDSentence::setSentID(const QString &id)
 {
-    Q_UNUSED(id)
+    removeComment("sent_id");
+    if (!id.isEmpty()) m_comments << QString("# sent_id = %1").arg(id);
 }
 
 bool UDSentence::getText(QString &text) const
 {
-    Q_UNUSED(text)
-    return false;
+    return getComment("text", &text);
 }
 
 void UDSentence::setText(const QString &text)
 {
-    Q_UNUSED(text)
+    removeComment("text");
+    if (!text.isEmpty()) m_comments << QString("# text = %1").arg(text);
 }
@@ -21,6 +21,16 @@ public:
     void setHead(int id, int head, const QString &deprel);
     void unlinkAllTokens();
 
+    // Tokens, with the root (ID 0) first, multi-word tokens, empty nodes and comments
+    QList<UDToken> &tokens();
+    const QList<UDToken> &tokens() const;
+    QList<UDTokenMultiWord> &tokensMultiword();
+    const QList<UDTokenMultiWord> &tokensMultiword() const;
+    QList<UDEmptyNode> &emptyNodes();
+    const QList<UDEmptyNode> &emptyNodes() const;
+    QStringList &comments();
+    const QStringList &comments() const;
+
     // CoNLL-U defined comments
     bool getNewDoc(QString &id) const;
     void setNewDoc(bool newDoc, const QString &id = QString());
@@ -37,6 +47,9 @@ protected:
     QList<UDEmptyNode> m_emptyNodes;
     QStringList m_comments;
     static const QString root_form;
+
+    bool getComment(const QString &name, QString *value) const;
+    void removeComment(const QString &name);
 };
 
 #endif // UDSENTENCE_H
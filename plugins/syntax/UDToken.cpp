@@ -2,11 +2,12 @@
 #include <QList>
 #include <QPair>
 #include <QMap>
+#include <QStringList>
 #include "UDTokenBase.h"
 #include "UDToken.h"
 
 UDToken::UDToken(int id, QString form) :
-    UDTokenBase(form), m_id(id)
+    UDTokenBase(form), m_id(id), m_head(-1)
 {
 }
 
@@ -72,6 +73,16 @@ void UDToken::setFeat(const QString &key, const QString &value)
     m_feats.insert(key, value);
 }
 
+QMap<QString, QString> UDToken::feats() const
+{
+    return m_feats;
+}
+
+void UDToken::setFeats(const QMap<QString, QString> &feats)
+{
+    m_feats = feats;
+}
+
 QString UDToken::featsToString() const
 {
     return attributesToString(m_feats);
@@ -102,14 +113,19 @@ void UDToken::setDepRel(const QString &deprel)
     m_deprel = deprel;
 }
 
-QList<QPair<int, QString> > &UDToken::deps()
+QList<QPair<QString, QString> > &UDToken::deps()
+{
+    return m_deps;
+}
+
+const QList<QPair<QString, QString> > &UDToken::deps() const
 {
     return m_deps;
 }
 
-void UDToken::appendDep(int id, const QString &dep)
+void UDToken::appendDep(const QString &id, const QString &dep)
 {
-    m_deps << QPair<int, QString>(id, dep);
+    m_deps << QPair<QString, QString>(id, dep);
 }
 
 void UDToken::clearDeps()
@@ -117,13 +133,24 @@ void UDToken::clearDeps()
     m_deps.clear();
 }
 
+// CoNLL-U enhanced dependencies: head:deprel pairs separated by |. Heads are kept as written, since the head of
+// an enhanced dependency may be an empty node (e.g. 8.1).
+QString UDToken::depsToString() const
+{
+    QStringList list;
+    for (int i = 0; i < m_deps.count(); ++i) {
+        list << QString("%1:%2").arg(m_deps.at(i).first).arg(m_deps.at(i).second);
+    }
+    return list.join("|");
+}
+
 void UDToken::setDepsFromString(const QString &deps)
 {
     m_deps.clear();
     foreach (QString depstring, deps.split("|")) {
-        if (!depstring.contains(",")) continue;
-        int id = depstring.section(",", 0, 0).toInt();
-        QString dep = depstring.section(",", 1, 1);
+        if (!depstring.contains(":")) continue;
+        QString id = depstring.section(":", 0, 0);
+        QString dep = depstring.section(":", 1);
         appendDep(id, dep);
     }
 }
@@ -22,6 +22,8 @@ public:
     QString XPOSTag() const;
     void setXPOSTag(const QString &XPOSTag);
     QString feat(const QString &key) const;
+    QMap<QString, QString> feats() const;
+    void setFeats(const QMap<QString, QString> &feats);
     void setFeat(const QString &key, const QString &value);
     QString featsToString() const;
     void setFeatsFromString(const QString &feats);
@@ -29,9 +31,11 @@ public:
     void setHead(int head);
     QString depRel() const;
     void setDepRel(const QString &deprel);
-    QList<QPair<int, QString> > &deps();
-    void appendDep(int id, const QString &dep);
+    QList<QPair<QString, QString> > &deps();
+    const QList<QPair<QString, QString> > &deps() const;
+    void appendDep(const QString &id, const QString &dep);
     void clearDeps();
+    QString depsToString() const;
     void setDepsFromString(const QString &deps);
     QList<int> &children();
 
@@ -44,7 +48,7 @@ protected:
     QMap<QString, QString> m_feats;     // list of morphological features
     int m_head;                         // head, 0 is root, <0 is undefined
     QString m_deprel;                   // dependency relation to the head
-    QList<QPair<int, QString> > m_deps; // secondary dependencies
+    QList<QPair<QString, QString> > m_deps; // secondary dependencies
     QList<int> m_children;
 };
 
@@ -7,7 +7,7 @@ QString UDTokenBase::attributesToString(const QMap<QString, QString> &attributes
 {
     QString ret;
     foreach (QString key, attributes.keys()) {
-        ret.append(QString("%1=%2|").arg(key, m_misc.value(key)));
+        ret.append(QString("%1=%2|").arg(key, attributes.value(key)));
     }
     if (!ret.isEmpty()) ret.chop(1);
     return ret;
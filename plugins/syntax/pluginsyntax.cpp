@@ -3,6 +3,8 @@
 #include <QtPlugin>
 #include <QIcon>
 #include <QApplication>
+#include <QDir>
+#include <QFile>
 #include <ExtensionSystemConstants>
 
 #include "pluginsyntax.h"
@@ -13,6 +15,7 @@
 
 #include "CoNLLUReader.h"
 #include "CorpusImporter.h"
+#include "DictionaryBuilder.h"
 #include "SentencesSplitter.h"
 #include "LatexTikzDependencyExporter.h"
 
@@ -26,6 +29,8 @@ struct Praaline::Plugins::Syntax::PluginSyntaxPrivateData {
     bool operationExportSentenceBreakFile;
     bool operationImportSentenceBreakFile;
     bool operationCreateSentenceTier;
+    QString pathImportCoNLLU;
+    QString filenameDictionary;
 };
 
 Praaline::Plugins::Syntax::PluginSyntax::PluginSyntax(QObject* parent) : QObject(parent)
@@ -99,6 +104,8 @@ QList<IAnnotationPlugin::PluginParameter> Praaline::Plugins::Syntax::PluginSynta
     parameters << PluginParameter("operationExportSentenceBreakFile", "Export Sentence Break File", QVariant::Bool, d->operationExportSentenceBreakFile);
     parameters << PluginParameter("operationImportSentenceBreakFile", "Import Sentence Break File", QVariant::Bool, d->operationImportSentenceBreakFile);
     parameters << PluginParameter("operationCreateSentenceTier", "Create Sentence Tier", QVariant::Bool, d->operationCreateSentenceTier);
+    parameters << PluginParameter("pathImportCoNLLU", "Import CoNLL-U files from folder", QVariant::String, d->pathImportCoNLLU);
+    parameters << PluginParameter("filenameDictionary", "Write dictionary of imported CoNLL-U files to", QVariant::String, d->filenameDictionary);
     return parameters;
 }
 
@@ -107,20 +114,41 @@ void Praaline::Plugins::Syntax::PluginSyntax::setParameters(const QHash<QString,
     if (parameters.contains("operationExportSentenceBreakFile")) d->operationExportSentenceBreakFile = parameters.value("operationExportSentenceBreakFile").toBool();
     if (parameters.contains("operationImportSentenceBreakFile")) d->operationImportSentenceBreakFile = parameters.value("operationImportSentenceBreakFile").toBool();
     if (parameters.contains("operationCreateSentenceTier")) d->operationCreateSentenceTier = parameters.value("operationCreateSentenceTier").toBool();
+    if (parameters.contains("pathImportCoNLLU")) d->pathImportCoNLLU = parameters.value("pathImportCoNLLU").toString();
+    if (parameters.contains("filenameDictionary")) d->filenameDictionary = parameters.value("filenameDictionary").toString();
 }
 
-void readUDCorpus(const QList<CorpusCommunication *> &communications)
+// Imports the file <communication ID>.conllu of the folder, when there is one, as the annotation of the same ID (speaker
+// "ud"). When a dictionary file name is given, the form / lemma / part-of-speech dictionary of the files is written to it.
+QString readUDCorpus(const QList<CorpusCommunication *> &communications, const QString &path, const QString &filenameDictionary)
 {
-    Q_UNUSED(communications)
-//    QString filename = "/media/george/Elements/universal-dependencies-1.2/UD_French/fr-ud-train.conllu"; // "D:/CORPORA/universal-dependencies-1.2/UD_French/fr-ud-train.conllu";
-//    foreach (CorpusCommunication *com, communications) {
-//        if (!com) continue;
-//        CorpusAnnotation *annot = new CorpusAnnotation(com->ID());
-//        com->addAnnotation(annot);
-//        AnnotationTierGroup *group = new AnnotationTierGroup();
-//        CoNLLUReader::readCoNLLUtoIntervalTier(filename, group);
-//        com->repository()->annotations()->saveTiers(com->ID(), "ud", group);
-//    }
+    QString ret;
+    DictionaryBuilder dictionary;
+    QString errorMessage;
+    foreach (CorpusCommunication *com, communications) {
+        if (!com) continue;
+        QString filename = QDir(path).absoluteFilePath(com->ID() + ".conllu");
+        if (!QFile::exists(filename)) continue;
+        SpeakerAnnotationTierGroupMap tiers;
+        if (!CorpusImporter::readCoNLLU(filename, "ud", tiers, errorMessage)) {
+            ret.append(QString("%1\t%2\n").arg(com->ID(), errorMessage));
+            continue;
+        }
+        if (!com->hasAnnotation(com->ID())) com->addAnnotation(new CorpusAnnotation(com->ID()));
+        com->repository()->annotations()->saveTiersAllSpeakers(com->ID(), tiers);
+        qDeleteAll(tiers);
+        ret.append(QString("%1\tImported %2\n").arg(com->ID(), filename));
+        if (!filenameDictionary.isEmpty() && !dictionary.addCoNLLU(filename, errorMessage))
+            ret.append(QString("%1\t%2\n").arg(com->ID(), errorMessage));
+    }
+    if (!filenameDictionary.isEmpty()) {
+        if (dictionary.writeDictionary(filenameDictionary, errorMessage))
+            ret.append(QString("Dictionary of %1 entries written to %2\n").arg(dictionary.countEntries()).arg(filenameDictionary));
+        else
+            ret.append(errorMessage).append("\n");
+    }
+    if (ret.endsWith("\n")) ret.chop(1);
+    return ret;
 }
 
 void readPerceoCorpus(const QList<CorpusCommunication *> &communications)
@@ -140,6 +168,12 @@ void Praaline::Plugins::Syntax::PluginSyntax::process(const QList<CorpusCommunic
 {
     QString m;
 
+    // An import run does not also run the other operations
+    if (!d->pathImportCoNLLU.isEmpty()) {
+        emit printMessage(readUDCorpus(communications, d->pathImportCoNLLU, d->filenameDictionary));
+        return;
+    }
+
     LatexTikzDependencyExporter latex;
     foreach (CorpusCommunication *com, communications) {
         if (!com) continue;
@@ -65,6 +65,7 @@ HEADERS += \
     pluginsyntax_global.h \
     pluginsyntax.h \
     CoNLLUReader.h \
+    CoNLLUWriter.h \
     CorpusImporter.h \
     DependenciesToLatex.h \
     UDTokenBase.h \
@@ -81,6 +82,7 @@ SOURCES += \
     ParseScore.cpp \
     pluginsyntax.cpp \
     CoNLLUReader.cpp \
+    CoNLLUWriter.cpp \
     CorpusImporter.cpp \
     DependenciesToLatex.cpp \
     UDTokenBase.cpp \
@@ -0,0 +1,111 @@
+#ifndef TEST_CONLLUREADER_H
+#define TEST_CONLLUREADER_H
+
+#include "CoNLLUReader.h"
+#include "CoNLLUWriter.h"
+
+#include <QObject>
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+
+// Reading a file and writing it back must give the same file, with comments written without their indentation.
+class TestCoNLLUReader : public QObject
+{
+    Q_OBJECT
+
+    // A multi-word token (3-4), an empty node (2.1) that is also an enhanced head, and indented comments
+    static QByteArray sample(bool indented) {
+        QString indent1 = indented ? "  " : "";
+        QString indent2 = indented ? "\t" : "";
+        QStringList lines;
+        lines << "# sent_id = s1"
+              << indent1 + "# text = Il va au marché"
+              << "1\tIl\til\tPRON\t_\tNumber=Sing|Person=3\t2\tnsubj\t2:nsubj|2.1:nsubj\t_"
+              << "2\tva\taller\tVERB\t_\t_\t0\troot\t0:root\t_"
+              << "2.1\tva\taller\tVERB\t_\t_\t_\t_\t0:root|2:conj\tCopyOf=2"
+              << "3-4\tau\t_\t_\t_\t_\t_\t_\t_\tSpaceAfter=No"
+              << "3\tà\tà\tADP\t_\t_\t5\tcase\t5:case\t_"
+              << "4\tle\tle\tDET\t_\tDefinite=Def\t5\tdet\t5:det\t_"
+              << "5\tmarché\tmarché\tNOUN\t_\t_\t2\tobl\t2:obl:à\t_"
+              << ""
+              << indent2 + "# sent_id = s2"
+              << indent1 + "# text = x=y"
+              << "1\tx=y\tx=y\tSYM\t_\t_\t0\troot\t0:root\t_"
+              << "";
+        return lines.join("\n").toUtf8() + "\n";
+    }
+
+    static bool writeFile(const QString &filename, const QByteArray &data) {
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly)) return false;
+        return file.write(data) == data.size();
+    }
+
+    static QByteArray readFile(const QString &filename) {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+        return file.readAll();
+    }
+
+private slots:
+    void readsAllNodeTypes() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString filename = dir.filePath("sample.conllu");
+        QVERIFY(writeFile(filename, sample(true)));
+        QList<UDSentence> sentences;
+        QVERIFY(CoNLLUReader::readCoNLLU(filename, sentences));
+        QCOMPARE(sentences.count(), 2);
+
+        const UDSentence &s1 = sentences.at(0);
+        QCOMPARE(s1.tokens().count(), 6); // with the root
+        QCOMPARE(s1.tokens().at(5).form(), QString("marché"));
+        QCOMPARE(s1.tokens().at(5).head(), 2);
+        QCOMPARE(s1.tokens().at(5).deps().first().second, QString("obl:à"));
+        // Enhanced head on an empty node, kept as written
+        QCOMPARE(s1.tokens().at(1).deps().count(), 2);
+        QCOMPARE(s1.tokens().at(1).deps().at(1).first, QString("2.1"));
+        QCOMPARE(s1.tokensMultiword().count(), 1);
+        QCOMPARE(s1.tokensMultiword().first().IDFirst(), 3);
+        QCOMPARE(s1.tokensMultiword().first().IDLast(), 4);
+        QCOMPARE(s1.tokensMultiword().first().form(), QString("au"));
+        QVERIFY(!s1.tokensMultiword().first().getSpaceAfter());
+        QCOMPARE(s1.emptyNodes().count(), 1);
+        QCOMPARE(s1.emptyNodes().first().ID(), 2);
+        QCOMPARE(s1.emptyNodes().first().index(), 1);
+        QCOMPARE(s1.emptyNodes().first().head(), -1);
+        QCOMPARE(s1.emptyNodes().first().misc("CopyOf"), QString("2"));
+        QString text;
+        QVERIFY(s1.getText(text));
+        QCOMPARE(text, QString("Il va au marché"));
+
+        // Indented comments are comments; the value of a comment runs to the end of the line
+        const UDSentence &s2 = sentences.at(1);
+        QCOMPARE(s2.tokens().count(), 2);
+        QString id;
+        QVERIFY(s2.getSentID(id));
+        QCOMPARE(id, QString("s2"));
+        QVERIFY(s2.getText(text));
+        QCOMPARE(text, QString("x=y"));
+    }
+
+    void roundTrip() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString filenameIn = dir.filePath("in.conllu");
+        QString filenameOut = dir.filePath("out.conllu");
+        QVERIFY(writeFile(filenameIn, sample(true)));
+        QList<UDSentence> sentences;
+        QVERIFY(CoNLLUReader::readCoNLLU(filenameIn, sentences));
+        QVERIFY(CoNLLUWriter::writeCoNLLU(filenameOut, sentences));
+        QCOMPARE(QString::fromUtf8(readFile(filenameOut)), QString::fromUtf8(sample(false)));
+        // and once more, from the written file
+        QList<UDSentence> again;
+        QVERIFY(CoNLLUReader::readCoNLLU(filenameOut, again));
+        QVERIFY(CoNLLUWriter::writeCoNLLU(filenameIn, again));
+        QCOMPARE(QString::fromUtf8(readFile(filenameIn)), QString::fromUtf8(sample(false)));
+    }
+};
+
+#endif // TEST_CONLLUREADER_H
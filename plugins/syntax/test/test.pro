@@ -0,0 +1,34 @@
+TEMPLATE = app
+
+INCLUDEPATH += ..
+DEPENDPATH += ..
+
+CONFIG += qt thread warn_on stl rtti exceptions console c++11
+QT += testlib
+QT -= gui
+
+TARGET = syntax-test
+
+OBJECTS_DIR = o
+MOC_DIR = o
+
+HEADERS += TestCoNLLUReader.h
+SOURCES += main.cpp \
+    ../CoNLLUReader.cpp \
+    ../CoNLLUWriter.cpp \
+    ../UDTokenBase.cpp \
+    ../UDToken.cpp \
+    ../UDTokenMultiWord.cpp \
+    ../UDEmptyNode.cpp \
+    ../UDSentence.cpp
+
+!win32 {
+    !macx* {
+        QMAKE_POST_LINK=./$${TARGET}
+    }
+    macx* {
+        QMAKE_POST_LINK=./$${TARGET}.app/Contents/MacOS/$${TARGET}
+    }
+}
+
+win32:QMAKE_POST_LINK=./release/$${TARGET}.exe
@@ -6,6 +6,8 @@
 #include <ExtensionSystemConstants>
 
 #include "PluginUDPipe.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineCore/Annotation/AnnotationTierGroup.h"
 #include "PraalineCore/Corpus/Corpus.h"
 #include "PraalineCore/Corpus/CorpusBookmark.h"
 #include "PraalineCore/Datastore/CorpusRepository.h"
@@ -13,16 +15,26 @@
 #include "PraalineCore/Datastore/FileDatastore.h"
 #include "PraalineCore/Serialisers/XML/XMLSerialiserCorpusBookmark.h"
 #include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
+using namespace Praaline::Core;
+
+#ifdef PRAALINE_WITH_UDPIPE
+#include "UDPipeModelServer.h"
+#endif
 
 using namespace Qtilities::ExtensionSystem;
 using namespace Praaline::Plugins;
 
 struct Praaline::Plugins::UDPipe::PluginUDPipePrivateData {
     PluginUDPipePrivateData() :
-        commandPatternsREP(false)
+        language("french"), levelSentences("sentence"), levelTokens("tok_min"),
+        tag(true), parse(true)
     {}
 
-    bool commandPatternsREP;
+    QString language;
+    QString levelSentences;
+    QString levelTokens;
+    bool tag;
+    bool parse;
 };
 
 Praaline::Plugins::UDPipe::PluginUDPipe::PluginUDPipe(QObject* parent) : QObject(parent)
@@ -50,7 +62,9 @@ bool Praaline::Plugins::UDPipe::PluginUDPipe::initializeDependencies(QStringList
 }
 
 void Praaline::Plugins::UDPipe::PluginUDPipe::finalize() {
-
+#ifdef PRAALINE_WITH_UDPIPE
+    UDPipeModelServer::deleteInstance();
+#endif
 }
 
 QString Praaline::Plugins::UDPipe::PluginUDPipe::pluginName() const {
@@ -93,13 +107,21 @@ QString Praaline::Plugins::UDPipe::PluginUDPipe::pluginLicense() const {
 QList<IAnnotationPlugin::PluginParameter> Praaline::Plugins::UDPipe::PluginUDPipe::pluginParameters() const
 {
     QList<IAnnotationPlugin::PluginParameter> parameters;
-    parameters << PluginParameter("commandPatternsREP", "Patterns-based detection: Repetitions", QVariant::Bool, d->commandPatternsREP);
+    parameters << PluginParameter("language", "UDPipe model language", QVariant::String, d->language);
+    parameters << PluginParameter("levelSentences", "Annotation level: Sentences", QVariant::String, d->levelSentences);
+    parameters << PluginParameter("levelTokens", "Annotation level: Tokens", QVariant::String, d->levelTokens);
+    parameters << PluginParameter("tag", "Tag (lemma, part-of-speech, features)", QVariant::Bool, d->tag);
+    parameters << PluginParameter("parse", "Parse (dependencies)", QVariant::Bool, d->parse);
     return parameters;
 }
 
 void Praaline::Plugins::UDPipe::PluginUDPipe::setParameters(const QHash<QString, QVariant> &parameters)
 {
-    if (parameters.contains("commandPatternsREP")) d->commandPatternsREP = parameters.value("commandPatternsREP").toBool();
+    if (parameters.contains("language")) d->language = parameters.value("language").toString();
+    if (parameters.contains("levelSentences")) d->levelSentences = parameters.value("levelSentences").toString();
+    if (parameters.contains("levelTokens")) d->levelTokens = parameters.value("levelTokens").toString();
+    if (parameters.contains("tag")) d->tag = parameters.value("tag").toBool();
+    if (parameters.contains("parse")) d->parse = parameters.value("parse").toBool();
 }
 
 
@@ -153,14 +175,96 @@ void Praaline::Plugins::UDPipe::PluginUDPipe::setParameters(const QHash<QString,
 //    }
 //}
 
+bool Praaline::Plugins::UDPipe::PluginUDPipe::prepareResources(QString &errorMessage)
+{
+#ifdef PRAALINE_WITH_UDPIPE
+    // Loads the model of the current language into the shared server; process() loads it if the language has changed
+    return UDPipeModelServer::instance()->loadModel(d->language, errorMessage);
+#else
+    Q_UNUSED(errorMessage)
+    return true;
+#endif
+}
+
+// Tags and parses the tokens of each sentence with the shared UDPipe model of the language, and stores the results
+// in the attributes ud_lemma, ud_upos, ud_xpos, ud_feats, ud_head (index of the head in the sentence, 0 for the root)
+// and ud_deprel of the tokens. Pauses are left out of the sentences. The parser needs tagged input, so the sentences
+// are always tagged when parsing; the tags are only stored when tagging was asked for.
 void Praaline::Plugins::UDPipe::PluginUDPipe::process(const QList<CorpusCommunication *> &communications)
 {
-    Q_UNUSED(communications)
-    QStringList patternsToAnnotate;
-    if (d->commandPatternsREP)
-    {
-        patternsToAnnotate << "REP";
+#ifdef PRAALINE_WITH_UDPIPE
+    QString errorMessage;
+    if (!UDPipeModelServer::instance()->loadModel(d->language, errorMessage)) {
+        emit printMessage(errorMessage);
+        return;
     }
+    bool tag = d->tag || d->parse;
+    int countDone = 0;
+    emit madeProgress(0);
+    foreach (CorpusCommunication *com, communications) {
+        if (!com) continue;
+        foreach (CorpusAnnotation *annot, com->annotations()) {
+            if (!annot) continue;
+            QString annotationID = annot->ID();
+            SpeakerAnnotationTierGroupMap tiersAll = com->repository()->annotations()->getTiersAllSpeakers(annotationID);
+            foreach (QString speakerID, tiersAll.keys()) {
+                AnnotationTierGroup *tiers = tiersAll.value(speakerID);
+                if (!tiers) continue;
+                IntervalTier *tier_sentences = tiers->getIntervalTierByName(d->levelSentences);
+                IntervalTier *tier_tokens = tiers->getIntervalTierByName(d->levelTokens);
+                if (!tier_sentences || !tier_tokens) continue;
+                // One UDPipe sentence per sentence interval, keeping the token intervals to write the results back
+                QList<UDSentence> sentences;
+                QList<QList<Interval *> > sentenceTokens;
+                foreach (Interval *sentence, tier_sentences->intervals()) {
+                    if (sentence->isPauseSilent()) continue;
+                    QList<Interval *> tokens;
+                    UDSentence ud;
+                    foreach (Interval *token, tier_tokens->getIntervalsContainedIn(sentence)) {
+                        if (token->isPauseSilent()) continue;
+                        tokens << token;
+                        ud.addToken(token->text());
+                    }
+                    if (tokens.isEmpty()) continue;
+                    sentences << ud;
+                    sentenceTokens << tokens;
+                }
+                if (!UDPipeModelServer::instance()->tagAndParse(d->language, sentences, tag, d->parse, errorMessage)) {
+                    emit printMessage(QString("%1 %2: %3").arg(annotationID, speakerID, errorMessage));
+                    continue;
+                }
+                for (int i = 0; i < sentences.count(); ++i) {
+                    const QList<UDToken> &udTokens = sentences.at(i).tokens();
+                    const QList<Interval *> &tokens = sentenceTokens.at(i);
+                    // udTokens starts with the root
+                    for (int j = 0; j < tokens.count() && j + 1 < udTokens.count(); ++j) {
+                        const UDToken &ud = udTokens.at(j + 1);
+                        Interval *token = tokens.at(j);
+                        if (d->tag) {
+                            token->setAttribute("ud_lemma", ud.lemma());
+                            token->setAttribute("ud_upos", ud.UPOSTag());
+                            token->setAttribute("ud_xpos", ud.XPOSTag());
+                            token->setAttribute("ud_feats", ud.featsToString());
+                        }
+                        if (d->parse) {
+                            token->setAttribute("ud_head", ud.head());
+                            token->setAttribute("ud_deprel", ud.depRel());
+                        }
+                    }
+                }
+                com->repository()->annotations()->saveTier(annotationID, speakerID, tier_tokens);
+                emit printMessage(QString("%1 %2: %3 sentences").arg(annotationID, speakerID).arg(sentences.count()));
+            }
+            qDeleteAll(tiersAll);
+        }
+        countDone++;
+        emit madeProgress(countDone * 100 / communications.count());
+    }
+    emit madeProgress(100);
+#else
+    Q_UNUSED(communications)
+    emit printMessage("UDPipe: Praaline was built without the UDPipe library (qmake CONFIG+=udpipe)");
+#endif
 }
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
@@ -55,6 +55,7 @@ namespace Praaline {
                 QList<PluginParameter> pluginParameters() const override;
                 void setParameters(const QHash<QString, QVariant> &parameters) override;
                 void process(const QList<CorpusCommunication *> &communications) override;
+                bool prepareResources(QString &errorMessage) override;
 
             signals:
                 void printMessage(const QString &message) override;
@@ -0,0 +1,292 @@
+#include <QDebug>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QFuture>
+#include <QtConcurrent>
+#include <memory>
+
+#include "udpipe.h"
+#include "syntax/UDSentence.h"
+#include "UDPipeModelServer.h"
+
+using namespace ufal;
+
+struct UDPipeModelServerData {
+    UDPipeModelServerData() : batchSize(64) {}
+
+    // Locking loadMutex for the whole load means a model that two threads ask for at once is only loaded once
+    QMutex loadMutex;
+    mutable QMutex mutex;
+    QHash<QString, QString> modelFilePaths;
+    QHash<QString, QSharedPointer<udpipe::model> > models;
+    int batchSize;
+    QThreadPool pool;
+};
+
+UDPipeModelServer *UDPipeModelServer::s_instance = nullptr;
+static QMutex instanceMutex;
+
+UDPipeModelServer *UDPipeModelServer::instance()
+{
+    QMutexLocker locker(&instanceMutex);
+    if (!s_instance) s_instance = new UDPipeModelServer();
+    return s_instance;
+}
+
+void UDPipeModelServer::deleteInstance()
+{
+    QMutexLocker locker(&instanceMutex);
+    delete s_instance;
+    s_instance = nullptr;
+}
+
+UDPipeModelServer::UDPipeModelServer() :
+    d(new UDPipeModelServerData())
+{
+    d->pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+UDPipeModelServer::~UDPipeModelServer()
+{
+    d->pool.waitForDone();
+    delete d;
+}
+
+// ====================================================================================================================
+// Models
+// ====================================================================================================================
+
+// static
+QString UDPipeModelServer::modelFilePath(const QString &language)
+{
+    return QDir::homePath() + "/Praaline/plugins/udpipe/models/" + language + ".udpipe";
+}
+
+void UDPipeModelServer::setModelFilePath(const QString &language, const QString &filename)
+{
+    QMutexLocker locker(&d->mutex);
+    d->modelFilePaths.insert(language, filename);
+}
+
+static QSharedPointer<udpipe::model> findModel(UDPipeModelServerData *d, const QString &language, QString &errorMessage)
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        if (d->models.contains(language)) return d->models.value(language);
+    }
+    QMutexLocker loadLocker(&d->loadMutex);
+    QString filename;
+    {
+        QMutexLocker locker(&d->mutex);
+        if (d->models.contains(language)) return d->models.value(language);
+        filename = d->modelFilePaths.value(language, UDPipeModelServer::modelFilePath(language));
+    }
+    if (!QFile::exists(filename)) {
+        errorMessage = QString("UDPipe model for %1 not found: %2").arg(language).arg(filename);
+        return QSharedPointer<udpipe::model>();
+    }
+    QSharedPointer<udpipe::model> model(udpipe::model::load(QFile::encodeName(filename).constData()));
+    if (!model) {
+        errorMessage = QString("Cannot load UDPipe model %1").arg(filename);
+        return model;
+    }
+    qDebug() << "UDPipe model loaded:" << language << filename;
+    QMutexLocker locker(&d->mutex);
+    d->models.insert(language, model);
+    return model;
+}
+
+bool UDPipeModelServer::loadModel(const QString &language, QString &errorMessage)
+{
+    return !findModel(d, language, errorMessage).isNull();
+}
+
+bool UDPipeModelServer::isModelLoaded(const QString &language) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->models.contains(language);
+}
+
+void UDPipeModelServer::unloadModels()
+{
+    // Models still in use by a running call are released when it returns
+    QMutexLocker locker(&d->mutex);
+    d->models.clear();
+}
+
+int UDPipeModelServer::batchSize() const
+{
+    return d->batchSize;
+}
+
+void UDPipeModelServer::setBatchSize(int batchSize)
+{
+    d->batchSize = qMax(1, batchSize);
+}
+
+// ====================================================================================================================
+// Conversion between UDSentence and UDPipe sentences
+// ====================================================================================================================
+
+static inline std::string toStd(const QString &s)
+{
+    return s.toUtf8().toStdString();
+}
+
+static inline QString fromStd(const std::string &s)
+{
+    return QString::fromUtf8(s.data(), static_cast<int>(s.size()));
+}
+
+// Enhanced dependencies (DEPS) are left out: UDPipe neither uses nor predicts them
+static void toUDPipe(const UDSentence &sentence, udpipe::sentence &s)
+{
+    s.clear();
+    const QList<UDToken> &tokens = sentence.tokens();
+    for (int i = 1; i < tokens.count(); ++i) {
+        const UDToken &token = tokens.at(i);
+        udpipe::word &w = s.add_word(toStd(token.form()));
+        w.lemma = toStd(token.lemma());
+        w.upostag = toStd(token.UPOSTag());
+        w.xpostag = toStd(token.XPOSTag());
+        w.feats = toStd(token.featsToString());
+        w.misc = toStd(token.miscToString());
+    }
+    for (int i = 1; i < tokens.count(); ++i) {
+        if (tokens.at(i).head() >= 0 && tokens.at(i).head() < tokens.count())
+            s.set_head(i, tokens.at(i).head(), toStd(tokens.at(i).depRel()));
+    }
+    foreach (const UDTokenMultiWord &mwt, sentence.tokensMultiword()) {
+        s.multiword_tokens.emplace_back(mwt.IDFirst(), mwt.IDLast(), toStd(mwt.form()), toStd(mwt.miscToString()));
+    }
+    foreach (const UDEmptyNode &node, sentence.emptyNodes()) {
+        s.empty_nodes.emplace_back(node.ID(), node.index());
+        udpipe::empty_node &e = s.empty_nodes.back();
+        e.form = toStd(node.form());
+        e.lemma = toStd(node.lemma());
+        e.upostag = toStd(node.UPOSTag());
+        e.xpostag = toStd(node.XPOSTag());
+        e.feats = toStd(node.featsToString());
+        e.misc = toStd(node.miscToString());
+    }
+    foreach (const QString &comment, sentence.comments()) {
+        s.comments.push_back(toStd(comment));
+    }
+}
+
+static void fromUDPipe(const udpipe::sentence &s, UDSentence &sentence)
+{
+    sentence.clear();
+    for (size_t i = 1; i < s.words.size(); ++i) {
+        const udpipe::word &w = s.words[i];
+        UDToken &token = sentence.addToken(fromStd(w.form));
+        token.setLemma(fromStd(w.lemma));
+        token.setUPOSTag(fromStd(w.upostag));
+        token.setXPOSTag(fromStd(w.xpostag));
+        token.setFeatsFromString(fromStd(w.feats));
+        token.setMiscFromString(fromStd(w.misc));
+    }
+    for (size_t i = 1; i < s.words.size(); ++i) {
+        if (s.words[i].head >= 0)
+            sentence.setHead(static_cast<int>(i), s.words[i].head, fromStd(s.words[i].deprel));
+    }
+    for (const udpipe::multiword_token &mwt : s.multiword_tokens) {
+        sentence.tokensMultiword() << UDTokenMultiWord(mwt.id_first, mwt.id_last, fromStd(mwt.form), fromStd(mwt.misc));
+    }
+    for (const udpipe::empty_node &e : s.empty_nodes) {
+        UDEmptyNode node(e.id, e.index);
+        node.setForm(fromStd(e.form));
+        node.setLemma(fromStd(e.lemma));
+        node.setUPOSTag(fromStd(e.upostag));
+        node.setXPOSTag(fromStd(e.xpostag));
+        node.setFeatsFromString(fromStd(e.feats));
+        node.setMiscFromString(fromStd(e.misc));
+        sentence.emptyNodes() << node;
+    }
+    for (const std::string &comment : s.comments) {
+        sentence.comments() << fromStd(comment);
+    }
+}
+
+// ====================================================================================================================
+// Processing
+// ====================================================================================================================
+
+bool UDPipeModelServer::tokenize(const QString &language, const QString &text, QList<UDSentence> &sentences,
+                                 QString &errorMessage)
+{
+    QSharedPointer<udpipe::model> model = findModel(d, language, errorMessage);
+    if (!model) return false;
+    // A tokenizer keeps state between sentences, so it is not shared
+    std::unique_ptr<udpipe::input_format> tokenizer(model->new_tokenizer(udpipe::model::DEFAULT));
+    if (!tokenizer) {
+        errorMessage = QString("The UDPipe model for %1 has no tokenizer").arg(language);
+        return false;
+    }
+    std::string input = toStd(text);
+    tokenizer->set_text(input);
+    udpipe::sentence s;
+    std::string error;
+    while (tokenizer->next_sentence(s, error)) {
+        UDSentence sentence;
+        fromUDPipe(s, sentence);
+        sentences << sentence;
+    }
+    if (!error.empty()) {
+        errorMessage = QString("UDPipe tokenizer error: %1").arg(fromStd(error));
+        return false;
+    }
+    return true;
+}
+
+bool UDPipeModelServer::tagAndParse(const QString &language, QList<UDSentence> &sentences, bool tag, bool parse,
+                                    QString &errorMessage)
+{
+    if (sentences.isEmpty() || (!tag && !parse)) return true;
+    QSharedPointer<udpipe::model> model = findModel(d, language, errorMessage);
+    if (!model) return false;
+
+    // Take the addresses of the sentences here: the workers must not call the non-const accessors of the list
+    QVector<UDSentence *> items;
+    items.reserve(sentences.count());
+    for (int i = 0; i < sentences.count(); ++i) items << &sentences[i];
+
+    QMutex errorMutex;
+    QString firstError;
+    auto processBatch = [&](int from, int to) {
+        udpipe::sentence s; // workspace, reused for each sentence of the batch
+        std::string error;
+        for (int i = from; i < to; ++i) {
+            toUDPipe(*items[i], s);
+            if ((tag && !model->tag(s, udpipe::model::DEFAULT, error)) ||
+                (parse && !model->parse(s, udpipe::model::DEFAULT, error))) {
+                QMutexLocker locker(&errorMutex);
+                if (firstError.isEmpty()) firstError = fromStd(error);
+                continue;
+            }
+            fromUDPipe(s, *items[i]);
+        }
+    };
+
+    int batchSize = d->batchSize;
+    QList<QFuture<void> > futures;
+    for (int from = 0; from < items.count(); from += batchSize) {
+        futures << QtConcurrent::run(&d->pool, processBatch, from, qMin(from + batchSize, items.count()));
+    }
+    foreach (QFuture<void> future, futures) {
+        future.waitForFinished();
+    }
+
+    if (!firstError.isEmpty()) {
+        errorMessage = QString("UDPipe error: %1").arg(firstError);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef UDPIPEMODELSERVER_H
+#define UDPIPEMODELSERVER_H
+
+#include <QString>
+#include <QList>
+#include "syntax/UDSentence.h"
+
+struct UDPipeModelServerData;
+
+// Runs UDPipe tokenisation, tagging and parsing for all the users of UDPipe in the process. Each model is loaded once
+// and kept; a loaded model is read-only and is used by several threads at once. Tagging and parsing are done on
+// batches of sentences on a pool of worker threads, each with its own UDPipe sentence workspace, and the results are
+// written into the UDSentence / UDToken structures passed in.
+class UDPipeModelServer
+{
+public:
+    static UDPipeModelServer *instance();
+    static void deleteInstance(); // only when the plugin is finalised
+
+    // Default location of the model for a language: ~/Praaline/plugins/udpipe/models/<language>.udpipe
+    static QString modelFilePath(const QString &language);
+    // Use another model file for a language; a model already loaded for it is kept until unloadModels()
+    void setModelFilePath(const QString &language, const QString &filename);
+
+    // Load the model for a language now (e.g. when preparing plugin resources) rather than on first use
+    bool loadModel(const QString &language, QString &errorMessage);
+    bool isModelLoaded(const QString &language) const;
+    void unloadModels();
+
+    // Number of sentences given to a worker at a time
+    int batchSize() const;
+    void setBatchSize(int batchSize);
+
+    // Split raw text into sentences and tokens, appending them to sentences
+    bool tokenize(const QString &language, const QString &text, QList<UDSentence> &sentences, QString &errorMessage);
+    // Tag and/or parse sentences in place
+    bool tagAndParse(const QString &language, QList<UDSentence> &sentences, bool tag, bool parse, QString &errorMessage);
+
+private:
+    UDPipeModelServer();
+    ~UDPipeModelServer();
+    UDPipeModelServerData *d;
+    static UDPipeModelServer *s_instance;
+};
+
+#endif // UDPIPEMODELSERVER_H
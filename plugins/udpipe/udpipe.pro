@@ -70,3 +70,31 @@ SOURCES += \
     PluginUDPipe.cpp \
     DisMoUDPipeBridge.cpp \
     LaTexExporter.cpp
+
+# UDPipe model server, with the UD structures of the Syntax plugin. It needs the UDPipe library itself: the
+# amalgamated udpipe.cpp and udpipe.h of the UDPipe distribution (src_lib_only), which are not in the source tree.
+# Build with: qmake "CONFIG+=udpipe" UDPIPE_LIB_PATH=<path to src_lib_only>
+udpipe {
+    isEmpty(UDPIPE_LIB_PATH) {
+        error( Set UDPIPE_LIB_PATH to the directory of the amalgamated UDPipe library sources )
+    }
+    DEFINES += PRAALINE_WITH_UDPIPE
+    QT += concurrent
+    INCLUDEPATH += $${UDPIPE_LIB_PATH}
+    HEADERS += \
+        UDPipeModelServer.h \
+        ../syntax/UDTokenBase.h \
+        ../syntax/UDToken.h \
+        ../syntax/UDTokenMultiWord.h \
+        ../syntax/UDEmptyNode.h \
+        ../syntax/UDSentence.h \
+        $${UDPIPE_LIB_PATH}/udpipe.h
+    SOURCES += \
+        UDPipeModelServer.cpp \
+        ../syntax/UDTokenBase.cpp \
+        ../syntax/UDToken.cpp \
+        ../syntax/UDTokenMultiWord.cpp \
+        ../syntax/UDEmptyNode.cpp \
+        ../syntax/UDSentence.cpp \
+        $${UDPIPE_LIB_PATH}/udpipe.cpp
+}
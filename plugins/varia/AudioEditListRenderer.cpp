@@ -0,0 +1,291 @@
+#include <QDebug>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMap>
+#include <QCoreApplication>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <vector>
+
+#include "PraalineCore/Base/BaseTypes.h"
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineCore/Annotation/AnnotationTierGroup.h"
+using namespace Praaline::Core;
+
+#include "data/fileio/FileSource.h"
+#include "data/fileio/AudioFileReader.h"
+#include "data/fileio/AudioFileReaderFactory.h"
+#include "data/fileio/WavFileWriter.h"
+
+#include "AudioEditListRenderer.h"
+
+struct AudioEditListRendererData {
+    AudioEditListRendererData() :
+        blockSize(65536), silenceLabel("_")
+    {}
+
+    int blockSize;
+    QString silenceLabel;
+};
+
+AudioEditListRenderer::AudioEditListRenderer() :
+    d(new AudioEditListRendererData)
+{
+}
+
+AudioEditListRenderer::~AudioEditListRenderer()
+{
+    delete d;
+}
+
+int AudioEditListRenderer::blockSize() const
+{
+    return d->blockSize;
+}
+
+void AudioEditListRenderer::setBlockSize(int frames)
+{
+    if (frames > 0) d->blockSize = frames;
+}
+
+QString AudioEditListRenderer::silenceLabel() const
+{
+    return d->silenceLabel;
+}
+
+void AudioEditListRenderer::setSilenceLabel(const QString &label)
+{
+    d->silenceLabel = label;
+}
+
+// ====================================================================================================================
+// Rendering
+// ====================================================================================================================
+
+namespace {
+
+// Extent of a segment in its source and in the output, in sample frames. A segment fades in over its overlap with
+// the previous segment, and fades out over its overlap with the next one.
+struct Placement {
+    sv_frame_t sourceFrom;
+    sv_frame_t outputFrom;
+    sv_frame_t length;
+    sv_frame_t fadeIn;
+    sv_frame_t fadeOut;
+};
+
+// Intervals of the output annotation, by speaker and tier, with tier names in order of appearance
+struct ShiftedAnnotation {
+    QMap<QString, QStringList> tierNames;
+    QMap<QString, QMap<QString, QList<Interval *> > > intervals;
+
+    void add(const QString &speakerID, const QString &tierName, Interval *interval)
+    {
+        if (!tierNames[speakerID].contains(tierName)) tierNames[speakerID] << tierName;
+        intervals[speakerID][tierName] << interval;
+    }
+};
+
+} // namespace
+
+AudioEditListRenderer::Result AudioEditListRenderer::render(const EditList &editList) const
+{
+    Result result;
+    if (editList.segments.isEmpty()) {
+        result.error = QString("%1: empty edit list").arg(editList.outputFilepath);
+        return result;
+    }
+
+    // Open each source once, at the output sample rate
+    int sampleRate = editList.sampleRate;
+    int channels = editList.channels;
+    QHash<QString, AudioFileReader *> readers;
+    foreach (const Segment &segment, editList.segments) {
+        if (segment.isSilence() || readers.contains(segment.sourceFilepath)) continue;
+        AudioFileReader *reader = AudioFileReaderFactory::createReader(FileSource(segment.sourceFilepath), sampleRate);
+        if (!reader) {
+            result.error = QString("%1: cannot read %2").arg(editList.outputFilepath).arg(segment.sourceFilepath);
+            qDeleteAll(readers);
+            return result;
+        }
+        if (sampleRate == 0) sampleRate = static_cast<int>(reader->getSampleRate());
+        if (channels == 0) channels = reader->getChannelCount();
+        readers.insert(segment.sourceFilepath, reader);
+    }
+    if (sampleRate == 0) {
+        result.error = QString("%1: no sample rate for an edit list of silences").arg(editList.outputFilepath);
+        return result;
+    }
+    if (channels == 0) channels = 1;
+
+    // Place the segments on the output timeline
+    QList<Placement> placements;
+    sv_frame_t position = 0;
+    for (int i = 0; i < editList.segments.count(); ++i) {
+        const Segment &segment = editList.segments.at(i);
+        Placement p;
+        p.sourceFrom = (segment.isSilence()) ? 0 : RealTime::realTime2Frame(segment.timeFrom, sampleRate);
+        p.length = qMax(sv_frame_t(0), sv_frame_t(RealTime::realTime2Frame(segment.timeTo, sampleRate)) -
+                        sv_frame_t(RealTime::realTime2Frame(segment.timeFrom, sampleRate)));
+        p.fadeIn = qBound(sv_frame_t(0), sv_frame_t(RealTime::realTime2Frame(segment.crossfade, sampleRate)), p.length);
+        p.fadeOut = 0;
+        if (i > 0) {
+            // Both fades of the previous segment must fit in it
+            Placement &previous = placements.last();
+            p.fadeIn = qMin(p.fadeIn, previous.length - previous.fadeIn);
+            previous.fadeOut = p.fadeIn;
+            p.outputFrom = position - p.fadeIn;
+        } else {
+            p.outputFrom = 0;
+        }
+        position = p.outputFrom + p.length;
+        placements << p;
+    }
+    sv_frame_t total = position;
+
+    // Render, holding back the faded-out tail of each segment until the next one is mixed into it
+    WavFileWriter writer(editList.outputFilepath, sampleRate, channels, WavFileWriter::WriteToTemporary);
+    if (!writer.isOK()) {
+        result.error = QString("%1: %2").arg(editList.outputFilepath).arg(writer.getError());
+        qDeleteAll(readers);
+        return result;
+    }
+    int blockSize = d->blockSize;
+    std::vector<std::vector<float> > block(channels, std::vector<float>(blockSize));
+    std::vector<std::vector<float> > tail(channels);
+    std::vector<std::vector<float> > nextTail(channels);
+    std::vector<float *> pointers(channels);
+    bool ok = true;
+    for (int i = 0; i < editList.segments.count() && ok; ++i) {
+        const Segment &segment = editList.segments.at(i);
+        const Placement &p = placements.at(i);
+        AudioFileReader *reader = (segment.isSilence()) ? 0 : readers.value(segment.sourceFilepath);
+        int sourceChannels = (reader) ? reader->getChannelCount() : 0;
+        for (int c = 0; c < channels; ++c) nextTail[c].clear();
+        for (sv_frame_t done = 0; done < p.length && ok; done += blockSize) {
+            sv_frame_t n = qMin(sv_frame_t(blockSize), p.length - done);
+            for (int c = 0; c < channels; ++c) std::fill(block[c].begin(), block[c].begin() + n, 0.0f);
+            if (reader && sourceChannels > 0) {
+                SampleBlock samples = reader->getInterleavedFrames(p.sourceFrom + done, n);
+                sv_frame_t read = qMin(n, sv_frame_t(samples.size()) / sourceChannels);
+                for (sv_frame_t j = 0; j < read; ++j) {
+                    const float *frame = samples.data() + j * sourceChannels;
+                    if (channels == 1 && sourceChannels > 1) {
+                        float sum = 0.0f;
+                        for (int sc = 0; sc < sourceChannels; ++sc) sum += frame[sc];
+                        block[0][j] = sum / sourceChannels;
+                    } else {
+                        for (int c = 0; c < channels; ++c) block[c][j] = frame[qMin(c, sourceChannels - 1)];
+                    }
+                }
+                for (sv_frame_t j = 0; j < read; ++j) {
+                    sv_frame_t k = done + j;
+                    double gain = segment.gain;
+                    if (k < p.fadeIn) gain *= (k + 0.5) / p.fadeIn;
+                    if (k >= p.length - p.fadeOut) gain *= (p.length - k - 0.5) / p.fadeOut;
+                    for (int c = 0; c < channels; ++c) block[c][j] = static_cast<float>(block[c][j] * gain);
+                }
+            }
+            // Mix in the tail of the previous segment (none before the first one, which fades in from silence)
+            sv_frame_t tailLength = sv_frame_t(tail[0].size());
+            for (sv_frame_t j = 0; j < n && done + j < tailLength; ++j) {
+                for (int c = 0; c < channels; ++c) block[c][j] += tail[c][done + j];
+            }
+            // Write out up to the start of this segment's own tail, and hold back the rest
+            sv_frame_t written = qBound(sv_frame_t(0), p.length - p.fadeOut - done, n);
+            if (written > 0) {
+                for (int c = 0; c < channels; ++c) pointers[c] = block[c].data();
+                ok = writer.writeSamples(pointers.data(), written);
+            }
+            for (int c = 0; c < channels; ++c) {
+                nextTail[c].insert(nextTail[c].end(), block[c].begin() + written, block[c].begin() + n);
+            }
+        }
+        tail.swap(nextTail);
+    }
+    qDeleteAll(readers);
+    if (ok) ok = writer.close();
+    if (!ok) {
+        result.error = QString("%1: %2").arg(editList.outputFilepath).arg(writer.getError());
+        return result;
+    }
+    result.success = true;
+    result.duration = RealTime::frame2RealTime(total, sampleRate);
+
+    // Shift the annotation: each segment covers the output up to the middle of its crossfades. The middle is
+    // measured from the start of the crossfade on both sides, so that odd-length crossfades neither overlap nor
+    // leave a gap.
+    ShiftedAnnotation annotation;
+    QList<QPair<RealTime, RealTime> > silences;
+    for (int i = 0; i < editList.segments.count(); ++i) {
+        const Segment &segment = editList.segments.at(i);
+        const Placement &p = placements.at(i);
+        sv_frame_t from = p.fadeIn / 2;
+        sv_frame_t to = p.length - p.fadeOut + p.fadeOut / 2;
+        if (to <= from) continue;
+        RealTime outputFrom = RealTime::frame2RealTime(p.outputFrom + from, sampleRate);
+        RealTime outputTo = RealTime::frame2RealTime(p.outputFrom + to, sampleRate);
+        if (segment.isSilence()) {
+            silences << QPair<RealTime, RealTime>(outputFrom, outputTo);
+            continue;
+        }
+        RealTime sourceFrom = RealTime::frame2RealTime(p.sourceFrom + from, sampleRate);
+        RealTime sourceTo = RealTime::frame2RealTime(p.sourceFrom + to, sampleRate);
+        RealTime shift = outputFrom - sourceFrom;
+        foreach (QString speakerID, segment.tiers.keys()) {
+            AnnotationTierGroup *group = segment.tiers.value(speakerID);
+            if (!group) continue;
+            foreach (AnnotationTier *tier, group->tiers()) {
+                IntervalTier *intervalTier = qobject_cast<IntervalTier *>(tier);
+                if (!intervalTier) continue;
+                foreach (Interval *intv, intervalTier->intervals()) {
+                    if (intv->tMax() <= sourceFrom || intv->tMin() >= sourceTo) continue;
+                    RealTime tMin = qMax(intv->tMin(), sourceFrom) + shift;
+                    RealTime tMax = qMin(intv->tMax(), sourceTo) + shift;
+                    annotation.add(speakerID, intervalTier->name(), new Interval(tMin, tMax, intv->text()));
+                }
+            }
+        }
+    }
+    // The tiers are handed over to the caller's thread
+    QThread *thread = (QCoreApplication::instance()) ? QCoreApplication::instance()->thread() : 0;
+    foreach (QString speakerID, annotation.tierNames.keys()) {
+        AnnotationTierGroup *group = new AnnotationTierGroup();
+        foreach (QString tierName, annotation.tierNames.value(speakerID)) {
+            QList<Interval *> intervals = annotation.intervals[speakerID][tierName];
+            for (int s = 0; s < silences.count(); ++s) {
+                intervals << new Interval(silences.at(s).first, silences.at(s).second, d->silenceLabel);
+            }
+            std::sort(intervals.begin(), intervals.end(),
+                      [](Interval *a, Interval *b) { return a->tMin() < b->tMin(); });
+            IntervalTier *tier = new IntervalTier(tierName, intervals, RealTime::zeroTime, result.duration);
+            if (thread) tier->moveToThread(thread);
+            group->addTier(tier);
+        }
+        if (thread) group->moveToThread(thread);
+        result.tiers.insert(speakerID, group);
+    }
+    return result;
+}
+
+struct RenderEditListStep
+{
+    const AudioEditListRenderer *renderer;
+
+    RenderEditListStep(const AudioEditListRenderer *renderer) : renderer(renderer) {}
+    typedef AudioEditListRenderer::Result result_type;
+
+    AudioEditListRenderer::Result operator() (const AudioEditListRenderer::EditList &editList)
+    {
+        return renderer->render(editList);
+    }
+};
+
+QList<AudioEditListRenderer::Result> AudioEditListRenderer::render(const QList<EditList> &editLists) const
+{
+    return QtConcurrent::blockingMapped<QList<Result> >(editLists, RenderEditListStep(this));
+}
@@ -0,0 +1,87 @@
+#ifndef AUDIOEDITLISTRENDERER_H
+#define AUDIOEDITLISTRENDERER_H
+
+#include <QString>
+#include <QList>
+#include "PraalineCore/Base/RealTime.h"
+#include "PraalineCore/Annotation/AnnotationTierGroup.h"
+
+struct AudioEditListRendererData;
+
+// Renders edit lists (segments of source recordings and silences) to new recordings, in-process. Sources are read
+// in blocks, segment boundaries are placed on exact sample frames, and consecutive segments may be crossfaded. The
+// interval tiers of each segment's source annotation are cut and shifted to the output timeline in the same pass.
+class AudioEditListRenderer
+{
+public:
+    class Segment {
+    public:
+        Segment(const QString &sourceFilepath, RealTime timeFrom, RealTime timeTo,
+                double gain = 1.0, RealTime crossfade = RealTime::zeroTime) :
+            sourceFilepath(sourceFilepath), timeFrom(timeFrom), timeTo(timeTo), gain(gain), crossfade(crossfade)
+        {}
+        Segment(RealTime duration, RealTime crossfade = RealTime::zeroTime) :
+            sourceFilepath(QString()), timeFrom(RealTime::zeroTime), timeTo(duration), gain(1.0), crossfade(crossfade)
+        {}
+
+        QString sourceFilepath;
+        RealTime timeFrom;
+        RealTime timeTo;
+        double gain;
+        // Overlap with the previous segment: this segment fades in while the previous one fades out
+        RealTime crossfade;
+        // Annotation of the source recording by speaker, in source time (not owned)
+        SpeakerAnnotationTierGroupMap tiers;
+
+        bool isSilence() const {
+            return sourceFilepath.isEmpty();
+        }
+        RealTime duration() const {
+            return timeTo - timeFrom;
+        }
+    };
+
+    class EditList {
+    public:
+        EditList(const QString &outputFilepath = QString(), const QList<Segment> &segments = QList<Segment>(),
+                 int sampleRate = 0, int channels = 0) :
+            outputFilepath(outputFilepath), segments(segments), sampleRate(sampleRate), channels(channels)
+        {}
+
+        QString outputFilepath;
+        QList<Segment> segments;
+        // Output format; zero to use that of the first source recording
+        int sampleRate;
+        int channels;
+    };
+
+    class Result {
+    public:
+        Result() : success(false) {}
+
+        bool success;
+        QString error;
+        RealTime duration;
+        // Annotation of the output recording by speaker, owned by the caller
+        SpeakerAnnotationTierGroupMap tiers;
+    };
+
+    AudioEditListRenderer();
+    ~AudioEditListRenderer();
+
+    // Frames read and written at a time
+    int blockSize() const;
+    void setBlockSize(int frames);
+    // Text of the intervals covering silence segments in the output annotation
+    QString silenceLabel() const;
+    void setSilenceLabel(const QString &label);
+
+    Result render(const EditList &editList) const;
+    // Renders the edit lists in parallel; results are in the same order
+    QList<Result> render(const QList<EditList> &editLists) const;
+
+private:
+    AudioEditListRendererData *d;
+};
+
+#endif // AUDIOEDITLISTRENDERER_H
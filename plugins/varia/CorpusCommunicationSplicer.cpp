@@ -12,6 +12,7 @@
 #include "PraalineCore/Datastore/AnnotationDatastore.h"
 using namespace Praaline::Core;
 
+#include "AudioEditListRenderer.h"
 #include "CorpusCommunicationSplicer.h"
 
 struct CorpusCommunicationSplicerData {
@@ -20,6 +21,7 @@ struct CorpusCommunicationSplicerData {
     { }
     CorpusRepository *repositorySource;
     CorpusRepository *repositoryDestination;
+    QHash<QString, QString> sourceRecordings;
 };
 
 CorpusCommunicationSplicer::CorpusCommunicationSplicer() :
@@ -34,10 +36,68 @@ CorpusCommunicationSplicer::~CorpusCommunicationSplicer()
 
 void CorpusCommunicationSplicer::setRepositorySource(CorpusRepository *repository)
 {
-    Q_UNUSED(repository)
+    d->repositorySource = repository;
 }
 
 void CorpusCommunicationSplicer::setRepositoryDestination(CorpusRepository *repository)
 {
-    Q_UNUSED(repository)
+    d->repositoryDestination = repository;
+}
+
+void CorpusCommunicationSplicer::addSourceRecording(const QString &recordingID, const QString &filepath)
+{
+    d->sourceRecordings.insert(recordingID, filepath);
+}
+
+QString CorpusCommunicationSplicer::splice(const QList<Composition> &compositions)
+{
+    QString ret;
+    // Source annotations are read once, however many splices refer to them
+    QHash<QString, SpeakerAnnotationTierGroupMap> sourceTiers;
+    QList<AudioEditListRenderer::EditList> editLists;
+    foreach (const Composition &composition, compositions) {
+        AudioEditListRenderer::EditList editList(composition.recordingFilepath);
+        editList.sampleRate = static_cast<int>(composition.recordingSampleRate);
+        foreach (const Splice &splice, composition.splices) {
+            if (splice.isSilence()) {
+                editList.segments << AudioEditListRenderer::Segment(splice.duration(), splice.crossfade);
+                continue;
+            }
+            QString sourceFilepath = d->sourceRecordings.value(splice.recordingID);
+            if (sourceFilepath.isEmpty()) {
+                ret.append(QString("%1\tUnknown source recording %2\n").arg(composition.communicationID).arg(splice.recordingID));
+                continue;
+            }
+            AudioEditListRenderer::Segment segment(sourceFilepath, splice.timeFrom, splice.timeTo,
+                                                   splice.gain, splice.crossfade);
+            if (d->repositorySource && !splice.annotationID.isEmpty()) {
+                if (!sourceTiers.contains(splice.annotationID))
+                    sourceTiers.insert(splice.annotationID,
+                                       d->repositorySource->annotations()->getTiersAllSpeakers(splice.annotationID));
+                segment.tiers = sourceTiers.value(splice.annotationID);
+            }
+            editList.segments << segment;
+        }
+        editLists << editList;
+    }
+    AudioEditListRenderer renderer;
+    QList<AudioEditListRenderer::Result> results = renderer.render(editLists);
+    for (int i = 0; i < compositions.count() && i < results.count(); ++i) {
+        const Composition &composition = compositions.at(i);
+        const AudioEditListRenderer::Result &result = results.at(i);
+        if (!result.success) {
+            ret.append(QString("%1\t%2\n").arg(composition.communicationID).arg(result.error));
+        } else {
+            ret.append(QString("%1\t%2\t%3\n").arg(composition.communicationID).arg(composition.recordingFilepath)
+                       .arg(result.duration.toDouble()));
+            if (d->repositoryDestination && !composition.annotationID.isEmpty()) {
+                foreach (QString speakerID, result.tiers.keys())
+                    d->repositoryDestination->annotations()->saveTiers(composition.annotationID, speakerID,
+                                                                       result.tiers.value(speakerID));
+            }
+        }
+        qDeleteAll(result.tiers);
+    }
+    foreach (SpeakerAnnotationTierGroupMap tiers, sourceTiers) qDeleteAll(tiers);
+    return ret;
 }
@@ -2,6 +2,7 @@
 #define CORPUSCOMMUNICATIONSPLICER_H
 
 #include <QString>
+#include <QList>
 #include <QPointer>
 #include "PraalineCore/Base/RealTime.h"
 
@@ -20,13 +21,13 @@ public:
     class Splice {
     public:
         Splice(const QString &communicationID, const QString &recordingID, const QString &annotationID,
-               RealTime timeFrom, RealTime timeTo) :
+               RealTime timeFrom, RealTime timeTo, double gain = 1.0, RealTime crossfade = RealTime::zeroTime) :
             communicationID(communicationID), recordingID(recordingID), annotationID(annotationID),
-            timeFrom(timeFrom), timeTo(timeTo)
+            timeFrom(timeFrom), timeTo(timeTo), gain(gain), crossfade(crossfade)
         {}
-        Splice(RealTime duration) :
+        Splice(RealTime duration, RealTime crossfade = RealTime::zeroTime) :
             communicationID(QString()), recordingID(QString()), annotationID(QString()),
-            timeFrom(RealTime::zeroTime), timeTo(duration)
+            timeFrom(RealTime::zeroTime), timeTo(duration), gain(1.0), crossfade(crossfade)
         {}
 
         QString communicationID;
@@ -34,10 +35,13 @@ public:
         QString annotationID;
         RealTime timeFrom;
         RealTime timeTo;
-        bool isSilence() {
+        double gain;
+        // Overlap with the previous splice
+        RealTime crossfade;
+        bool isSilence() const {
             return communicationID.isEmpty();
         }
-        RealTime duration() {
+        RealTime duration() const {
             return timeTo - timeFrom;
         }
     };
@@ -63,6 +67,12 @@ public:
 
     void setRepositorySource(Praaline::Core::CorpusRepository *repository);
     void setRepositoryDestination(Praaline::Core::CorpusRepository *repository);
+    // Audio file of a source recording referred to by the splices
+    void addSourceRecording(const QString &recordingID, const QString &filepath);
+
+    // Renders the compositions (in parallel) and, when a destination repository is set, saves their annotation,
+    // shifted from the source annotations. Returns a report.
+    QString splice(const QList<Composition> &compositions);
 
 private:
     CorpusCommunicationSplicerData *d;
@@ -5,8 +5,11 @@
 #include <QMap>
 #include <QPointer>
 #include <QTextStream>
+#include <QFileInfo>
+#include <QDir>
 
 #include "PraalineCore/Corpus/Corpus.h"
+#include "PraalineCore/Corpus/CorpusRecording.h"
 #include "PraalineCore/Annotation/IntervalTier.h"
 #include "PraalineCore/Annotation/SequenceTier.h"
 #include "PraalineCore/Annotation/AnnotationTierGroup.h"
@@ -22,11 +25,15 @@ struct SilentPauseManipulatorData {
         levelIDTokens = "tok_mwu";
         levelIDSequences = "syntactic_units";
         attributeAddPauseAfter = "add_pause_after";
+        crossfade = RealTime::fromMilliseconds(5);
     }
 
     QString levelIDTokens;
     QString levelIDSequences;
     QString attributeAddPauseAfter;
+    // Overlap at the cuts, so that they do not click
+    RealTime crossfade;
+    QList<AudioEditListRenderer::EditList> editLists;
 };
 
 SilentPauseManipulator::SilentPauseManipulator() :
@@ -132,6 +139,38 @@ QString SilentPauseManipulator::process(CorpusCommunication *com)
                     tier_tokens_new->modifyIntervalDuration(i, newDuration - token->duration());
                 }
             }
+            // Edit list of the same manipulation, on the original timeline: cuts are crossfaded, starting the next
+            // segment earlier by the overlap so that durations are kept
+            CorpusRecording *rec = (com->recordings().isEmpty()) ? 0 : com->recordings().first();
+            if (rec) {
+                QFileInfo info(rec->filePath());
+                QString outputFilepath = info.absoluteDir().absoluteFilePath(
+                            QString("%1_manip%2.wav").arg(com->ID())
+                            .arg((tiersAll.count() > 1) ? QString("_%1").arg(speakerID) : QString()));
+                AudioEditListRenderer::EditList editList(outputFilepath);
+                RealTime cursor = RealTime::zeroTime;
+                RealTime overlap = RealTime::zeroTime;
+                for (int i = 0; i < tier_tokens->count(); ++i) {
+                    Interval *token = tier_tokens->at(i);
+                    if (token->attribute("pause_manipulation_reduce_to").toLongLong() > 0) {
+                        RealTime trimPos = RealTime::fromNanoseconds(token->attribute("pause_manipulation_trim_pos").toLongLong());
+                        RealTime trimLen = RealTime::fromNanoseconds(token->attribute("pause_manipulation_trim_len").toLongLong());
+                        editList.segments << AudioEditListRenderer::Segment(rec->filePath(), cursor, trimPos, 1.0, overlap);
+                        overlap = qMin(d->crossfade, trimPos + trimLen);
+                        cursor = trimPos + trimLen - overlap;
+                    }
+                    if (token->attribute(d->attributeAddPauseAfter).toInt() > 0) {
+                        RealTime duration = RealTime::fromMilliseconds(token->attribute(d->attributeAddPauseAfter).toInt());
+                        editList.segments << AudioEditListRenderer::Segment(rec->filePath(), cursor, token->tMax(), 1.0, overlap);
+                        editList.segments << AudioEditListRenderer::Segment(duration);
+                        cursor = token->tMax();
+                        overlap = RealTime::zeroTime;
+                    }
+                }
+                editList.segments << AudioEditListRenderer::Segment(rec->filePath(), cursor, tier_tokens->tMax(), 1.0, overlap);
+                d->editLists << editList;
+            }
+
             QString soxPadCommand = QString("sox %1_trimmed.wav %2.wav pad ")
                     .arg(com->ID()).arg(com->ID() + "_manip");
 
@@ -169,4 +208,28 @@ QString SilentPauseManipulator::process(CorpusCommunication *com)
     return ret.trimmed();
 }
 
+QList<AudioEditListRenderer::EditList> SilentPauseManipulator::editLists() const
+{
+    return d->editLists;
+}
+
+void SilentPauseManipulator::clearEditLists()
+{
+    d->editLists.clear();
+}
 
+QString SilentPauseManipulator::renderEditLists()
+{
+    QString ret;
+    AudioEditListRenderer renderer;
+    QList<AudioEditListRenderer::Result> results = renderer.render(d->editLists);
+    for (int i = 0; i < results.count(); ++i) {
+        const AudioEditListRenderer::Result &result = results.at(i);
+        if (result.success)
+            ret.append(QString("%1\t%2\n").arg(d->editLists.at(i).outputFilepath).arg(result.duration.toDouble()));
+        else
+            ret.append(result.error).append("\n");
+        qDeleteAll(result.tiers);
+    }
+    return ret.trimmed();
+}
@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QPointer>
+#include "AudioEditListRenderer.h"
 
 namespace Praaline {
 namespace Core {
@@ -19,6 +20,13 @@ public:
     ~SilentPauseManipulator();
 
     QString process(Praaline::Core::CorpusCommunication *com);
+
+    // Edit lists of the manipulated recordings, collected by process(), as an alternative to the sox commands in the report
+    QList<AudioEditListRenderer::EditList> editLists() const;
+    void clearEditLists();
+    // Renders the collected edit lists in parallel and returns a report
+    QString renderEditLists();
+
 private:
     SilentPauseManipulatorData *d;
 };
@@ -5,6 +5,7 @@
 #include <QHash>
 #include <QPointer>
 #include <QFile>
+#include <QDir>
 #include <QTextStream>
 #include <QElapsedTimer>
 #include <QMutex>
@@ -16,6 +17,7 @@
 #include "PraalineCore/Annotation/AnnotationTierGroup.h"
 #include "PraalineCore/Datastore/CorpusRepository.h"
 #include "PraalineCore/Datastore/AnnotationDatastore.h"
+#include "PraalineCore/Datastore/FileDatastore.h"
 #include "PraalineCore/Interfaces/Praat/PraatTextGrid.h"
 #include "PraalineCore/Interfaces/TEI/TEIHeader.h"
 using namespace Praaline::Core;
@@ -371,9 +373,12 @@ QString ORFEO::align(Praaline::Core::CorpusCommunication *com)
         timer.start();
         // Praat textgrid for the results
         foreach (QString speakerID, tiersAll.keys()) {
-            // Check if already aligned
+            // Utterances already aligned and not edited since are skipped by the aligner: their hashes are kept
+            // next to the corpus
             QString filenameTextGrid = QString(com->recordings().first()->filePath()).replace(".wav", "_align_%1.TextGrid").arg(speakerID);
-            if (QFile::exists(filenameTextGrid)) continue;
+            if (com->repository()->files() && !com->repository()->files()->basePath().isEmpty())
+                d->aligner.setUtteranceHashesFilename(QDir(com->repository()->files()->basePath()).absoluteFilePath("align_hashes.txt"));
+            d->aligner.setAnnotationContext(annotationID, speakerID);
 
             AnnotationTierGroup *tiers = tiersAll.value(speakerID);
             if (!tiers) continue;
@@ -424,6 +429,8 @@ QString ORFEO::align(Praaline::Core::CorpusCommunication *com)
             com->corpus()->repository()->annotations()->saveTier(annotationID, speakerID, tier_tok_min);
             // com->corpus()->repository()->annotations()->saveTier(annotationID, speakerID, tier_utterance);
             mutex.unlock();
+            // Only once the phones are saved
+            d->aligner.saveUtteranceHashes();
             // Save Praat TextGrid
             AnnotationTierGroup *txg = new AnnotationTierGroup();
             txg->addTier(tier_phone);
@@ -95,6 +95,7 @@ HEADERS += \
     corpus-specific/Rhapsodie.h \
     ProsodicBoundaries.h \
     CorpusCommunicationSplicer.h \
+    AudioEditListRenderer.h \
     corpus-specific/NCCFR.h \
     PhonoSeesaw.h \
     JsonAlignedTranscription.h \
@@ -129,6 +130,7 @@ SOURCES += \
     corpus-specific/Rhapsodie.cpp \
     ProsodicBoundaries.cpp \
     CorpusCommunicationSplicer.cpp \
+    AudioEditListRenderer.cpp \
     corpus-specific/NCCFR.cpp \
     PhonoSeesaw.cpp \
     JsonAlignedTranscription.cpp \
@@ -4,6 +4,7 @@
 #include <QMultiMap>
 #include <QString>
 #include <QList>
+#include <QHash>
 
 #include "PraalineCore/Annotation/AnnotationTierGroup.h"
 #include "PraalineCore/Annotation/AnnotationTier.h"
@@ -11,6 +12,8 @@
 #include "PraalineCore/Annotation/SequenceTier.h"
 using namespace Praaline::Core;
 
+#include "pnlib/annotation/IntervalTierCursor.h"
+
 #include "AnnotationMultiTierTableModel.h"
 #include "SequencesTableModel.h"
 
@@ -21,6 +24,10 @@ struct AnnotationTierModelData {
     QList<QPair<QString, QString> > attributes;     // Level ID, Attribute ID
     // Children models for sequences: one for each sequence tier given
     QMap<QString, SequencesTableModel *> sequencesModels;
+    // Cache of derived cells (context, grouped and concatenated intervals), by timeline index and attribute index
+    QHash<quint64, QVariant> cellCache;
+    // Cursors on the grouped tiers: rows are mostly painted in order, so each query starts where the previous one ended
+    QHash<IntervalTier *, IntervalTierCursor> groupCursors;
     // Constructor
     AnnotationTierModelData() : orientation(Qt::Vertical)
     {}
@@ -171,9 +178,11 @@ QVariant AnnotationMultiTierTableModel::dataCell(AnnotationTierGroup *spk_tiers,
         QString levelIDgrouped = attributeID.section(":", 1, 1);
         IntervalTier *tier_groupped = spk_tiers->getIntervalTierByName(levelIDgrouped);
         if (!tier_groupped) return QVariant();
-        QList<Interval *> intervals;
-        if      (attributeID.startsWith("_group:"))          intervals = tier_groupped->getIntervalsOverlappingWith(tier->interval(intvID));
-        else if (attributeID.startsWith("_group_contains:")) intervals = tier_groupped->getIntervalsContainedIn(tier->interval(intvID));
+        IntervalTierCursor &cursor = d->groupCursors[tier_groupped];
+        if (cursor.tier() != tier_groupped) cursor.setTier(tier_groupped);
+        IntervalSpan intervals;
+        if      (attributeID.startsWith("_group:"))          intervals = cursor.overlappingWith(tier->interval(intvID));
+        else if (attributeID.startsWith("_group_contains:")) intervals = cursor.containedIn(tier->interval(intvID));
         QString s;
         foreach (Interval *intv, intervals) s.append(intv->text()).append(" ");
         return QString("(%1)%2").arg(s.trimmed(), tier->interval(intvID)->text());
@@ -182,9 +191,11 @@ QVariant AnnotationMultiTierTableModel::dataCell(AnnotationTierGroup *spk_tiers,
         QString levelIDgrouped = attributeID.section(":", 1, 1);
         IntervalTier *tier_groupped = spk_tiers->getIntervalTierByName(levelIDgrouped);
         if (!tier_groupped) return QVariant();
-        QList<Interval *> intervals;
-        if      (attributeID.startsWith("_concat:"))          intervals = tier_groupped->getIntervalsOverlappingWith(tier->interval(intvID));
-        else if (attributeID.startsWith("_concat_contains:")) intervals = tier_groupped->getIntervalsContainedIn(tier->interval(intvID));
+        IntervalTierCursor &cursor = d->groupCursors[tier_groupped];
+        if (cursor.tier() != tier_groupped) cursor.setTier(tier_groupped);
+        IntervalSpan intervals;
+        if      (attributeID.startsWith("_concat:"))          intervals = cursor.overlappingWith(tier->interval(intvID));
+        else if (attributeID.startsWith("_concat_contains:")) intervals = cursor.containedIn(tier->interval(intvID));
         QString s;
         foreach (Interval *intv, intervals) s.append(intv->text()).append(".");
         if (s.endsWith(".")) s.chop(1);
@@ -196,6 +207,78 @@ QVariant AnnotationMultiTierTableModel::dataCell(AnnotationTierGroup *spk_tiers,
     return QVariant();
 }
 
+// Private
+static bool isDerivedCell(const QString &attributeID)
+{
+    return (attributeID == "_context") || attributeID.startsWith("_group:") || attributeID.startsWith("_group_contains:") ||
+            attributeID.startsWith("_concat:") || attributeID.startsWith("_concat_contains:");
+}
+
+static quint64 cellCacheKey(int timelineIndex, int attributeIndex)
+{
+    return (static_cast<quint64>(timelineIndex) << 32) | static_cast<quint32>(attributeIndex);
+}
+
+// Private
+QVariant AnnotationMultiTierTableModel::cachedDataCell(AnnotationTierGroup *spk_tiers, int timelineIndex, int attributeIndex) const
+{
+    TimelineData td = m_timeline.at(timelineIndex);
+    QString levelID = d->attributes.at(attributeIndex).first;
+    QString attributeID = d->attributes.at(attributeIndex).second;
+    if (!isDerivedCell(attributeID)) return dataCell(spk_tiers, td, levelID, attributeID);
+    quint64 key = cellCacheKey(timelineIndex, attributeIndex);
+    QHash<quint64, QVariant>::const_iterator cached = d->cellCache.constFind(key);
+    if (cached != d->cellCache.constEnd()) return cached.value();
+    QVariant value = dataCell(spk_tiers, td, levelID, attributeID);
+    d->cellCache.insert(key, value);
+    return value;
+}
+
+void AnnotationMultiTierTableModel::tiersChanged()
+{
+    beginResetModel();
+    calculateTimeline(d->tiers, d->tiernameMinimal);
+    invalidateCellCache();
+    endResetModel();
+}
+
+// Private
+void AnnotationMultiTierTableModel::invalidateCellCache()
+{
+    d->cellCache.clear();
+    d->groupCursors.clear();
+}
+
+// Private: after editing an interval, forget the derived cells that may display it. These are on the rows of the same
+// speaker that are within 7 intervals (context) of the edited one, or that fall in an interval of a displayed level
+// overlapping with it (grouped and concatenated cells).
+void AnnotationMultiTierTableModel::invalidateCellCache(const QString &speakerID, IntervalTier *tier, int intervalIndex)
+{
+    if (d->cellCache.isEmpty()) return;
+    AnnotationTierGroup *spk_tiers = d->tiers.value(speakerID, 0);
+    if (!spk_tiers || !tier || intervalIndex < 0 || intervalIndex >= tier->count()) return;
+    Interval *edited = tier->interval(intervalIndex);
+    RealTime from = tier->interval(qMax(0, intervalIndex - 7))->tMin();
+    RealTime to = tier->interval(qMin(tier->count() - 1, intervalIndex + 7))->tMax();
+    QList<QString> levelIDs;
+    for (const QPair<QString, QString> &pairLevelAttribute : d->attributes) {
+        if (levelIDs.contains(pairLevelAttribute.first)) continue;
+        levelIDs << pairLevelAttribute.first;
+        IntervalTier *tierDisplayed = spk_tiers->getIntervalTierByName(pairLevelAttribute.first);
+        if (!tierDisplayed) continue;
+        QList<Interval *> overlapping = tierDisplayed->getIntervalsOverlappingWith(edited);
+        if (overlapping.isEmpty()) continue;
+        if (overlapping.first()->tMin() < from) from = overlapping.first()->tMin();
+        if (overlapping.last()->tMax() > to) to = overlapping.last()->tMax();
+    }
+    for (int timelineIndex = timelineIndexAtTime(from); timelineIndex < m_timeline.count(); ++timelineIndex) {
+        if (m_timeline.at(timelineIndex).tMin > to) break;
+        if (m_timeline.at(timelineIndex).speakerID != speakerID) continue;
+        for (int attributeIndex = 0; attributeIndex < d->attributes.count(); ++attributeIndex)
+            d->cellCache.remove(cellCacheKey(timelineIndex, attributeIndex));
+    }
+}
+
 QVariant AnnotationMultiTierTableModel::data(const QModelIndex &index, int role) const
 {
     if (!index.isValid()) return QVariant();
@@ -204,15 +287,16 @@ QVariant AnnotationMultiTierTableModel::data(const QModelIndex &index, int role)
 
     // Translate row index to timeline position
     TimelineData td;
-    int dataCellIndex;
+    int timelineIndex, dataCellIndex;
     if (d->orientation == Qt::Vertical) {
-        td = m_timeline.at(index.row());
+        timelineIndex = index.row();
         dataCellIndex = index.column();
     }
     else {
-        td = m_timeline.at(index.column());
+        timelineIndex = index.column();
         dataCellIndex = index.row();
     }
+    td = m_timeline.at(timelineIndex);
     int attributeIndex = dataCellIndex - 3;
 
     AnnotationTierGroup *spk_tiers = d->tiers.value(td.speakerID, 0);
@@ -235,9 +319,7 @@ QVariant AnnotationMultiTierTableModel::data(const QModelIndex &index, int role)
             else return QVariant();
         }
         else if (attributeIndex >= 0 && attributeIndex < d->attributes.count()) {
-            QString levelID = d->attributes.at(attributeIndex).first;
-            QString attributeID = d->attributes.at(attributeIndex).second;
-            return dataCell(spk_tiers, td, levelID, attributeID);
+            return cachedDataCell(spk_tiers, timelineIndex, attributeIndex);
         }
     }
     else if (role == Qt::BackgroundColorRole) {
@@ -249,22 +331,26 @@ QVariant AnnotationMultiTierTableModel::data(const QModelIndex &index, int role)
 QList<AnnotationMultiTierTableModel::AnnotationTierCell>
 AnnotationMultiTierTableModel::dataBlock(const RealTime &from, const RealTime &to, const QList<int> &attributeIndices)
 {
+    // Only the rows in the requested (visible) range are visited, located by bisection; derived cells come from the cache
     QList<AnnotationMultiTierTableModel::AnnotationTierCell> ret;
+    if (m_timeline.isEmpty()) return ret;
     int timelineIndexFrom = timelineIndexAtTime(from);
     int timelineIndexTo = timelineIndexAtTime(to);
+    QList<int> validAttributeIndices;
+    foreach (int attributeIndex, attributeIndices) {
+        if (attributeIndex >= 0 && attributeIndex < d->attributes.count()) validAttributeIndices << attributeIndex;
+    }
+    ret.reserve((timelineIndexTo - timelineIndexFrom + 1) * validAttributeIndices.count());
     for (int timelineIndex = timelineIndexFrom; timelineIndex <= timelineIndexTo; ++timelineIndex) {
-        TimelineData td = m_timeline.at(timelineIndex);
+        const TimelineData &td = m_timeline.at(timelineIndex);
         AnnotationTierGroup *spk_tiers = d->tiers.value(td.speakerID, 0);
         if (!spk_tiers) continue;
-        foreach (int attributeIndex, attributeIndices) {
-            QString levelID = d->attributes.at(attributeIndex).first;
-            QString attributeID = d->attributes.at(attributeIndex).second;
-            QVariant value = dataCell(spk_tiers, td, levelID, attributeID);
+        foreach (int attributeIndex, validAttributeIndices) {
             AnnotationMultiTierTableModel::AnnotationTierCell cell;
             cell.tMin = td.tMin;
             cell.attributeIndex = attributeIndex;
             cell.speakerID = td.speakerID;
-            cell.value = value;
+            cell.value = cachedDataCell(spk_tiers, timelineIndex, attributeIndex);
             ret << cell;
         }
     }
@@ -311,6 +397,7 @@ bool AnnotationMultiTierTableModel::setData(const QModelIndex &index, const QVar
         int intervalIndex = tier_minimal->intervalIndexAtTime(td.tCenter);
         bool result = tier_minimal->moveBoundary(intervalIndex, RealTime::fromSeconds(value.toDouble()));
         if (!result) return false;
+        invalidateCellCache();
         // update timeline (previous interval's center and max, our min and center)
         if ((timelineIndex > 0) && (intervalIndex > 0)) {
             m_timeline[timelineIndex - 1].tCenter = tier_minimal->interval(intervalIndex - 1)->tCenter();
@@ -334,6 +421,7 @@ bool AnnotationMultiTierTableModel::setData(const QModelIndex &index, const QVar
         int intervalIndex = tier_minimal->intervalIndexAtTime(td.tCenter);
         bool result = tier_minimal->moveBoundary(intervalIndex + 1, RealTime::fromSeconds(value.toDouble()));
         if (!result) return false;
+        invalidateCellCache();
         // update timeline (our center and max, next interval's min and center)
         m_timeline[timelineIndex].tCenter = tier_minimal->interval(intervalIndex)->tCenter();
         m_timeline[timelineIndex].tMax = tier_minimal->interval(intervalIndex)->tMax();
@@ -354,18 +442,19 @@ bool AnnotationMultiTierTableModel::setData(const QModelIndex &index, const QVar
     else if (attributeIndex >= 0 && attributeIndex < d->attributes.count()) {
         IntervalTier *tier = spk_tiers->getIntervalTierByName(d->attributes.at(attributeIndex).first);
         if (!tier) return false;
-        Interval *intv = tier->intervalAtTime(td.tCenter);
+        int intervalIndex = tier->intervalIndexAtTime(td.tCenter);
+        if (intervalIndex < 0) return false;
+        Interval *intv = tier->interval(intervalIndex);
         if (!intv) return false;
         if (d->attributes.at(attributeIndex).second.isEmpty()) {
             intv->setText(value.toString());
-            emit dataChanged(index, index);
-            return true;
         }
         else {
             intv->setAttribute(d->attributes.at(attributeIndex).second, value);
-            emit dataChanged(index, index);
-            return true;
         }
+        invalidateCellCache(td.speakerID, tier, intervalIndex);
+        emit dataChanged(index, index);
+        return true;
     }
     return false;
 }
@@ -380,6 +469,7 @@ void AnnotationMultiTierTableModel::setOrientation(Qt::Orientation orientation)
     if (d->orientation == orientation) return;
     beginResetModel();
     d->orientation = orientation;
+    invalidateCellCache();
     endResetModel();
 }
 
@@ -422,6 +512,7 @@ bool AnnotationMultiTierTableModel::splitAnnotations(int timelineIndex, int data
     if (!spk_tiers) return false;
     IntervalTier *tier = spk_tiers->getIntervalTierByName(levelID);
     if (!tier) return false;
+    invalidateCellCache();
 
     if (levelID == d->tiernameMinimal) {
         if (splitMinimalAt == RealTime(0, 0)) {
@@ -524,6 +615,7 @@ bool AnnotationMultiTierTableModel::mergeAnnotations(int dataIndex, const QList<
     // Get the interval tier on which we are merging
     IntervalTier *tier = spk_tiers->getIntervalTierByName(levelID);
     if (!tier) return false;
+    invalidateCellCache();
 
     if (levelID == d->tiernameMinimal) {
         if (d->orientation == Qt::Vertical)
@@ -16,6 +16,12 @@
 #include "TimelineTableModelBase.h"
 #include "SequencesTableModel.h"
 
+namespace Praaline {
+namespace Core {
+class IntervalTier;
+}
+}
+
 struct AnnotationTierModelData;
 
 class AnnotationMultiTierTableModel : public TimelineTableModelBase
@@ -69,12 +75,18 @@ public:
 signals:
 
 public slots:
+    // Call after the tiers have been edited other than through this model (e.g. re-aligned, or edited in an annotation
+    // grid pane, see AnnotationGridModel::tiersChanged): recalculates the timeline and forgets all cached cells
+    void tiersChanged();
 
 private:
     AnnotationTierModelData *d;
 
     QVariant dataCell(Praaline::Core::AnnotationTierGroup *spk_tiers, TimelineData &td,
                       const QString &levelID, const QString &attributeID) const;
+    QVariant cachedDataCell(Praaline::Core::AnnotationTierGroup *spk_tiers, int timelineIndex, int attributeIndex) const;
+    void invalidateCellCache();
+    void invalidateCellCache(const QString &speakerID, Praaline::Core::IntervalTier *tier, int intervalIndex);
 };
 
 #endif // ANNOTATIONTIERMODEL_H
@@ -6,6 +6,7 @@
 #include <QMap>
 #include <QColor>
 #include <QAbstractTableModel>
+#include <algorithm>
 #include "PraalineCore/Base/RealTime.h"
 
 #include "PraalineCore/Annotation/AnnotationTierGroup.h"
@@ -41,15 +42,20 @@ void TimelineTableModelBase::calculateTimeline(SpeakerAnnotationTierGroupMap &ti
         m_speakerBackgroundColors.insert(speakerID, QColor(QColor::colorNames().at(i)));
         ++i;
     }
-    m_timeline = timeline.values();
+    m_timeline = timeline.values().toVector();
+}
+
+int TimelineTableModelBase::timelineLowerBound(const RealTime &time) const
+{
+    QVector<TimelineData>::const_iterator it = std::lower_bound(
+                m_timeline.constBegin(), m_timeline.constEnd(), time,
+                [](const TimelineData &td, const RealTime &t) { return td.tMin < t; });
+    return static_cast<int>(it - m_timeline.constBegin());
 }
 
 int TimelineTableModelBase::timelineIndexAtTime(const RealTime &time) const
 {
-    int timelineIndex = 0;
-    for (timelineIndex = 0; timelineIndex < m_timeline.count(); ++timelineIndex) {
-        if (m_timeline.at(timelineIndex).tMin >= time) break;
-    }
+    int timelineIndex = timelineLowerBound(time);
     // We found the first time index AFTER the time we should be moving to => subtract 1.
     if (timelineIndex > 0) timelineIndex--;
     return timelineIndex;
@@ -57,9 +63,11 @@ int TimelineTableModelBase::timelineIndexAtTime(const RealTime &time) const
 
 int TimelineTableModelBase::timelineIndexAtTime(const RealTime &time, double &tMin_msec, double &tMax_msec) const
 {
-    int timelineIndex = 0;
-    for (timelineIndex = 0; timelineIndex < m_timeline.count(); ++timelineIndex) {
-        if (m_timeline.at(timelineIndex).tMin >= time) break;
+    int timelineIndex = timelineLowerBound(time);
+    if (timelineIndex >= m_timeline.count()) timelineIndex = m_timeline.count() - 1;
+    if (timelineIndex < 0) {
+        tMin_msec = tMax_msec = 0.0;
+        return 0;
     }
     tMin_msec = m_timeline.at(timelineIndex).tMin.toDouble() * 1000.0;
     tMax_msec = m_timeline.at(timelineIndex).tMax.toDouble() * 1000.0;
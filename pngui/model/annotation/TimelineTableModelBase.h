@@ -5,6 +5,7 @@
 #include <QPointer>
 #include <QString>
 #include <QList>
+#include <QVector>
 #include <QHash>
 #include <QMap>
 #include <QColor>
@@ -48,10 +49,13 @@ signals:
 public slots:
 
 protected:
-    QList<TimelineData> m_timeline;
+    // Timeline entries of all speakers, in a contiguous array sorted by tMin (searched by bisection)
+    QVector<TimelineData> m_timeline;
     QHash<QString, QColor> m_speakerBackgroundColors;
 
     void calculateTimeline(Praaline::Core::SpeakerAnnotationTierGroupMap &tiers, const QString &timelineTier);
+    // Index of the first timeline entry starting at or after the given time (m_timeline.count() if none)
+    int timelineLowerBound(const RealTime &time) const;
 };
 
 #endif // TIMELINETABLEMODELBASE_H
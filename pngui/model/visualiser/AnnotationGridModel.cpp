@@ -235,6 +235,7 @@ bool AnnotationGridModel::setData(const QString &speakerID, const QString &level
             intv->setText(value.toString());
         else
             intv->setAttribute(attributeID, value);
+        emit tiersChanged();
         return true;
     }
     PointTier *tier_point = tiers_spk->getPointTierByName(levelID);
@@ -245,6 +246,7 @@ bool AnnotationGridModel::setData(const QString &speakerID, const QString &level
             point->setText(value.toString());
         else
             point->setAttribute(attributeID, value);
+        emit tiersChanged();
         return true;
     }
     return false;
@@ -316,6 +318,7 @@ bool AnnotationGridModel::addBoundary(const AnnotationGridPointModel::Point &bou
             d->boundaries[boundary.levelID]->addPoint(boundary);
             qDebug() << "addBoundary level=" << boundary.levelID << " speaker=" << boundary.speakerID << " frame=" << boundary.frame
                      << " index=" << index << " time=" << RealTime::frame2RealTime(boundary.frame, d->sampleRate).toString();
+            emit tiersChanged();
             return true;
         } else return false;
     }
@@ -338,6 +341,7 @@ bool AnnotationGridModel::deleteBoundary(const AnnotationGridPointModel::Point &
             d->boundaries[boundary.levelID]->deletePoint(boundary);
             qDebug() << "deleteBoundary level=" << boundary.levelID << " speaker=" << boundary.speakerID << " frame=" << boundary.frame
                      << " index=" << index << " time=" << RealTime::frame2RealTime(boundary.frame, d->sampleRate).toString();
+            emit tiersChanged();
             return true;
         } else return false;
     }
@@ -362,6 +366,7 @@ bool AnnotationGridModel::moveBoundary(const AnnotationGridPointModel::Point &ol
         // Debug
         qDebug() << "moveBoundary level=" << newBoundary.levelID << " speaker=" << newBoundary.speakerID << " frame=" << newBoundary.frame
                  << " index=" << index << " time=" << RealTime::frame2RealTime(newBoundary.frame, d->sampleRate).toString();
+        emit tiersChanged();
         return true;
     }
     return false;
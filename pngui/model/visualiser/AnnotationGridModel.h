@@ -147,6 +147,10 @@ public:
         AnnotationGridModel *m_model;
     };
 
+signals:
+    // The tiers were edited through this model (text, attributes or boundaries)
+    void tiersChanged();
+
 protected:
     AnnotationGridModelData *d;
 };
@@ -105,13 +105,13 @@ public:
         if (column < 2) {
             return SparseModel<AnnotationGridPoint>::getData(row, column, role);
         }
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return QVariant();
+        Point point(0);
+        if (!getPointForRow(row, point)) return QVariant();
 
         if (column == 2) {
-            return i->speakerID;
+            return point.speakerID;
         } else if (column == 3) {
-            return i->levelID;
+            return point.levelID;
         }
         return QVariant();
     }
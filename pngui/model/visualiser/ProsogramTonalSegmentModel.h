@@ -189,17 +189,17 @@ public:
         if (column < 2) {
             return SparseModel<ProsogramTonalSegment>::getData(row, column, role);
         }
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return QVariant();
+        Point point(0);
+        if (!getPointForRow(row, point)) return QVariant();
 
         if (column == 2) {
-            return int(i->duration);
+            return int(point.duration);
         } else if (column == 3) {
-            return i->speakerID;
+            return point.speakerID;
         } else if (column == 4) {
-            return i->f0StartHz;
+            return point.f0StartHz;
         } else if (column == 5) {
-            return i->f0EndHz;
+            return point.f0EndHz;
         }
         return QVariant();
     }
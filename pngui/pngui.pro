@@ -30,6 +30,10 @@ INCLUDEPATH += dependencies/qtilities/include
 # For QXlsx
 QT += core gui gui-private
 DEFINES += XLSX_NO_LIB
+# zlib, for the QXlsx streaming writer (linked with the application)
+win32-g++: INCLUDEPATH += $$PWD/../dependency-builds/sv/win32-mingw/include
+win32-msvc*: INCLUDEPATH += $$PWD/../dependency-builds/sv/win64-msvc/include
+macx*: INCLUDEPATH += $$PWD/../dependency-builds/sv/osx/include
 
 # For Node Editor
 DEFINES += NODE_EDITOR_STATIC
@@ -70,6 +74,8 @@ HEADERS += \
     epsengine/EpsEngine.h \
     widgets/CorpusCommunicationSpeakerRelationsWidget.h \
     xlsx/xlsxzipwriter_p.h \
+    xlsx/xlsxstreamingdocument.h \
+    xlsx/xlsxstreamingdocument_p.h \
     xlsx/xlsxzipreader_p.h \
     xlsx/xlsxworksheet.h \
     xlsx/xlsxworksheet_p.h \
@@ -269,6 +275,7 @@ SOURCES += \
     epsengine/EpsPaintDevice.cpp \
     widgets/CorpusCommunicationSpeakerRelationsWidget.cpp \
     xlsx/xlsxzipwriter.cpp \
+    xlsx/xlsxstreamingdocument.cpp \
     xlsx/xlsxzipreader.cpp \
     xlsx/xlsxworksheet.cpp \
     xlsx/xlsxworkbook.cpp \
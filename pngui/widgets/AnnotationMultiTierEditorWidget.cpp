@@ -88,6 +88,12 @@ void AnnotationMultiTierEditorWidget::annotationsMerge()
     d->model->mergeAnnotations(m_view->tableView()->selectionModel()->currentIndex().column(), m_selectedRows);
 }
 
+void AnnotationMultiTierEditorWidget::tiersChanged()
+{
+    if (!d->model) return;
+    d->model->tiersChanged();
+}
+
 void AnnotationMultiTierEditorWidget::removeSorting()
 {
     if (!d->model) return;
@@ -45,6 +45,8 @@ public slots:
     void annotationsMerge();
     void toggleOrientation();
     void removeSorting();
+    // The tiers were edited elsewhere (e.g. in a visualiser pane)
+    void tiersChanged();
 
 protected slots:
     void resultChanged(int filterRows, int unfilteredRows) override;
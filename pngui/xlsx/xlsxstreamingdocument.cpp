@@ -0,0 +1,502 @@
+/****************************************************************************
+** Copyright (c) 2013-2014 Debao Zhang <hello@debao.me>
+** All right reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+** NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+** LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+** OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+** WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+****************************************************************************/
+
+#include "xlsxstreamingdocument.h"
+#include "xlsxstreamingdocument_p.h"
+#include "xlsxcellreference.h"
+#include "xlsxcontenttypes_p.h"
+#include "xlsxrelationships_p.h"
+#include "xlsxtheme_p.h"
+#include "xlsxdocpropsapp_p.h"
+#include "xlsxdocpropscore_p.h"
+#include "xlsxutility_p.h"
+
+#include <QDateTime>
+#include <QXmlStreamWriter>
+#include <QDebug>
+
+QT_BEGIN_NAMESPACE_XLSX
+
+namespace {
+
+const int maxRowCount = 1048576;
+const int maxColumnCount = 16384;
+const int writeChunkSize = 65536;
+
+QByteArray escapedText(const QString &text)
+{
+    QString escaped;
+    escaped.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i) {
+        QChar c = text.at(i);
+        if (c == QLatin1Char('&'))          escaped.append(QLatin1String("&amp;"));
+        else if (c == QLatin1Char('<'))     escaped.append(QLatin1String("&lt;"));
+        else if (c == QLatin1Char('>'))     escaped.append(QLatin1String("&gt;"));
+        else if (c == QLatin1Char('"'))     escaped.append(QLatin1String("&quot;"));
+        else if (c.unicode() < 0x20 && c != QLatin1Char('\t') && c != QLatin1Char('\n') && c != QLatin1Char('\r'))
+            continue; // not allowed in XML 1.0
+        else
+            escaped.append(c);
+    }
+    return escaped.toUtf8();
+}
+
+QByteArray textElement(const QString &text)
+{
+    if (isSpaceReserveNeeded(text))
+        return "<t xml:space=\"preserve\">" + escapedText(text) + "</t>";
+    return "<t>" + escapedText(text) + "</t>";
+}
+
+}
+
+StreamingDocumentPrivate::StreamingDocumentPrivate(StreamingDocument *p) :
+    q_ptr(p), device(0), saved(false), styles(Styles::F_NewFromScratch),
+    sharedStringsCount(0), sharedStringsLimit(1000000),
+    sheetOpen(false), sheetDataStarted(false), rowBufferSize(256), lastFlushedRow(0), maxRow(0)
+{
+}
+
+QByteArray StreamingDocumentPrivate::stringCellXml(const QString &cellRef, const QByteArray &style, const QString &text)
+{
+    QByteArray xml = "<c r=\"" + cellRef.toLatin1() + "\"" + style;
+    int index = sharedStrings.value(text, -1);
+    if (index < 0 && sharedStrings.count() < sharedStringsLimit
+            && (sharedStringsFile.isOpen() || sharedStringsFile.open())) {
+        index = sharedStrings.count();
+        sharedStrings.insert(text, index);
+        sharedStringsFile.write("<si>" + textElement(text) + "</si>");
+    }
+    if (index < 0) {
+        // Too many distinct strings to keep track of: store the rest in the cells
+        return xml + " t=\"inlineStr\"><is>" + textElement(text) + "</is></c>";
+    }
+    sharedStringsCount++;
+    return xml + " t=\"s\"><v>" + QByteArray::number(index) + "</v></c>";
+}
+
+QByteArray StreamingDocumentPrivate::cellXml(int row, int col, const QVariant &value, const Format &format)
+{
+    QString cellRef = CellReference(row, col).toString();
+    int type = value.userType();
+
+    Format fmt = format;
+    double number = 0.0;
+    if (type == QMetaType::QDateTime || type == QMetaType::QDate) {
+        if (!fmt.isValid() || !fmt.isDateTimeFormat())
+            fmt.setNumberFormat(QStringLiteral("yyyy-mm-dd"));
+        number = datetimeToNumber(value.toDateTime());
+    } else if (type == QMetaType::QTime) {
+        if (!fmt.isValid() || !fmt.isDateTimeFormat())
+            fmt.setNumberFormat(QStringLiteral("hh:mm:ss"));
+        number = timeToNumber(value.toTime());
+    } else if (type == QMetaType::Int || type == QMetaType::UInt || type == QMetaType::LongLong
+               || type == QMetaType::ULongLong || type == QMetaType::Double || type == QMetaType::Float) {
+        number = value.toDouble();
+    }
+
+    QByteArray style;
+    if (!fmt.isEmpty()) {
+        styles.addXfFormat(fmt);
+        style = " s=\"" + QByteArray::number(fmt.xfIndex()) + "\"";
+    }
+    QByteArray xml = "<c r=\"" + cellRef.toLatin1() + "\"" + style;
+
+    if (value.isNull()) {
+        // Blank cells are only needed to carry a format
+        return style.isEmpty() ? QByteArray() : xml + "/>";
+    } else if (type == QMetaType::QString) {
+        QString token = value.toString();
+        if (token.startsWith(QLatin1String("=")))
+            return xml + "><f>" + escapedText(token.mid(1)) + "</f></c>";
+        return stringCellXml(cellRef, style, token);
+    } else if (type == QMetaType::Bool) {
+        return xml + " t=\"b\"><v>" + (value.toBool() ? "1" : "0") + "</v></c>";
+    } else if (type == QMetaType::QDateTime || type == QMetaType::QDate || type == QMetaType::QTime
+               || type == QMetaType::Int || type == QMetaType::UInt || type == QMetaType::LongLong
+               || type == QMetaType::ULongLong || type == QMetaType::Double || type == QMetaType::Float) {
+        return xml + "><v>" + QByteArray::number(number, 'g', 15) + "</v></c>";
+    }
+    return stringCellXml(cellRef, style, value.toString());
+}
+
+bool StreamingDocumentPrivate::beginSheetData()
+{
+    if (sheetDataStarted)
+        return true;
+    if (!zipWriter->beginFile(QStringLiteral("xl/worksheets/sheet%1.xml").arg(sheetNames.count())))
+        return false;
+    sheetDataStarted = true;
+
+    QByteArray xml = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+                     "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" "
+                     "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">";
+    if (sheetNames.count() == 1)
+        xml += "<sheetViews><sheetView tabSelected=\"1\" workbookViewId=\"0\"/></sheetViews>";
+    else
+        xml += "<sheetViews><sheetView workbookViewId=\"0\"/></sheetViews>";
+    xml += "<sheetFormatPr defaultRowHeight=\"15\"/>";
+    if (!columnWidths.isEmpty()) {
+        xml += "<cols>";
+        QMap<int, double>::const_iterator it;
+        for (it = columnWidths.constBegin(); it != columnWidths.constEnd(); ++it) {
+            xml += "<col min=\"" + QByteArray::number(it.key()) + "\" max=\"" + QByteArray::number(it.key())
+                    + "\" width=\"" + QByteArray::number(it.value(), 'g', 15) + "\" customWidth=\"1\"/>";
+        }
+        xml += "</cols>";
+    }
+    xml += "<sheetData>";
+    return zipWriter->writeData(xml);
+}
+
+bool StreamingDocumentPrivate::flushRows(int belowRow)
+{
+    if (!beginSheetData())
+        return false;
+    while (!pendingRows.isEmpty() && pendingRows.firstKey() <= belowRow) {
+        QMap<int, QMap<int, QByteArray> >::iterator row = pendingRows.begin();
+        buffer += "<row r=\"" + QByteArray::number(row.key()) + "\">";
+        foreach (const QByteArray &cell, row.value())
+            buffer += cell;
+        buffer += "</row>";
+        pendingRows.erase(row);
+        if (buffer.size() >= writeChunkSize) {
+            if (!zipWriter->writeData(buffer))
+                return false;
+            buffer.clear();
+        }
+    }
+    lastFlushedRow = qMax(lastFlushedRow, belowRow);
+    return true;
+}
+
+bool StreamingDocumentPrivate::endSheet()
+{
+    if (!sheetOpen)
+        return true;
+    sheetOpen = false;
+    if (!flushRows(maxRow))
+        return false;
+    buffer += "</sheetData></worksheet>";
+    bool ok = zipWriter->writeData(buffer) && zipWriter->endFile();
+    buffer.clear();
+    return ok;
+}
+
+/*!
+  \class StreamingDocument
+  \inmodule QtXlsx
+  \brief The StreamingDocument class writes large .xlsx files with constant memory.
+
+  Unlike Document, cells are not kept in memory: rows are written to the package, compressed, as
+  soon as the writer has moved rowBufferSize() rows past them. Rows can be written in any order
+  within that window; writing to a row that has already been written out fails. Worksheets are
+  written one after the other. Repeated strings are stored once, in the shared strings table,
+  up to sharedStringsLimit() distinct strings; further strings are stored inline in their cells.
+
+  Use Document for small files, or to read, edit or add charts and images.
+*/
+
+/*!
+ * Creates a new document, written to the file \a xlsxName.
+ */
+StreamingDocument::StreamingDocument(const QString &xlsxName) :
+    d_ptr(new StreamingDocumentPrivate(this))
+{
+    Q_D(StreamingDocument);
+    d->file.reset(new QFile(xlsxName));
+    d->file->open(QIODevice::WriteOnly);
+    d->device = d->file.data();
+    d->zipWriter.reset(new ZipStreamWriter(d->device));
+}
+
+/*!
+ * Creates a new document, written to \a device, which must be open for writing.
+ */
+StreamingDocument::StreamingDocument(QIODevice *device) :
+    d_ptr(new StreamingDocumentPrivate(this))
+{
+    Q_D(StreamingDocument);
+    d->device = device;
+    d->zipWriter.reset(new ZipStreamWriter(d->device));
+}
+
+/*!
+ * Saves the document, if this has not been done, and cleans up.
+ */
+StreamingDocument::~StreamingDocument()
+{
+    Q_D(StreamingDocument);
+    if (!d->saved)
+        save();
+    delete d_ptr;
+}
+
+/*!
+ * Returns true if the document can still be written.
+ */
+bool StreamingDocument::isValid() const
+{
+    Q_D(const StreamingDocument);
+    return !d->saved && !d->zipWriter->error();
+}
+
+/*!
+ * Returns the number of rows a worksheet can hold. Writes to later rows fail: longer
+ * tables have to be continued on another worksheet.
+ */
+int StreamingDocument::maximumRowCount()
+{
+    return maxRowCount;
+}
+
+/*!
+ * Finishes the current worksheet and starts a new one, called \a name.
+ * A first worksheet is added automatically if cells are written before this is called.
+ */
+bool StreamingDocument::addSheet(const QString &name)
+{
+    Q_D(StreamingDocument);
+    if (!isValid())
+        return false;
+    QString sheetName = name.isEmpty() ? QStringLiteral("Sheet%1").arg(d->sheetNames.count() + 1) : name;
+    if (d->sheetNames.contains(sheetName, Qt::CaseInsensitive))
+        return false;
+    if (!d->endSheet())
+        return false;
+    d->sheetNames.append(sheetName);
+    d->sheetOpen = true;
+    d->sheetDataStarted = false;
+    d->columnWidths.clear();
+    d->pendingRows.clear();
+    d->lastFlushedRow = 0;
+    d->maxRow = 0;
+    return true;
+}
+
+/*!
+ * Sets the \a width of the \a column of the current worksheet.
+ * Column widths must be set before the first rows of the worksheet are written out.
+ */
+bool StreamingDocument::setColumnWidth(int column, double width)
+{
+    return setColumnWidth(column, column, width);
+}
+
+/*!
+ * \overload
+ */
+bool StreamingDocument::setColumnWidth(int colFirst, int colLast, double width)
+{
+    Q_D(StreamingDocument);
+    if (!d->sheetOpen && !addSheet())
+        return false;
+    if (d->sheetDataStarted || colFirst < 1 || colLast > maxColumnCount || colFirst > colLast)
+        return false;
+    for (int col = colFirst; col <= colLast; ++col)
+        d->columnWidths.insert(col, width);
+    return true;
+}
+
+/*!
+ * \overload
+ */
+bool StreamingDocument::write(const CellReference &cell, const QVariant &value, const Format &format)
+{
+    if (!cell.isValid())
+        return false;
+    return write(cell.row(), cell.column(), value, format);
+}
+
+/*!
+ * Write \a value to cell (\a row, \a col) of the current worksheet with the \a format.
+ * Strings starting with "=" are written as formulas. Returns false if the row has already
+ * been written out.
+ */
+bool StreamingDocument::write(int row, int col, const QVariant &value, const Format &format)
+{
+    Q_D(StreamingDocument);
+    if (!isValid())
+        return false;
+    if (row < 1 || row > maxRowCount || col < 1 || col > maxColumnCount)
+        return false;
+    if (!d->sheetOpen && !addSheet())
+        return false;
+    if (row <= d->lastFlushedRow) {
+        qWarning() << "StreamingDocument: row" << row << "has already been written out";
+        return false;
+    }
+    QByteArray xml = d->cellXml(row, col, value, format);
+    if (xml.isEmpty()) {
+        if (d->pendingRows.contains(row))
+            d->pendingRows[row].remove(col);
+    } else
+        d->pendingRows[row].insert(col, xml);
+    if (row > d->maxRow) {
+        d->maxRow = row;
+        if (d->maxRow - d->rowBufferSize > d->lastFlushedRow)
+            return d->flushRows(d->maxRow - d->rowBufferSize);
+    }
+    return true;
+}
+
+/*!
+ * Sets the number of rows, up to the last row written to, that are kept in memory and can
+ * still be written to. The default is 256; with 1, rows must be written in order.
+ */
+void StreamingDocument::setRowBufferSize(int rows)
+{
+    Q_D(StreamingDocument);
+    d->rowBufferSize = qMax(rows, 1);
+}
+
+int StreamingDocument::rowBufferSize() const
+{
+    Q_D(const StreamingDocument);
+    return d->rowBufferSize;
+}
+
+/*!
+ * Sets the maximum number of distinct strings kept in the shared strings table.
+ * The default is 1000000.
+ */
+void StreamingDocument::setSharedStringsLimit(int count)
+{
+    Q_D(StreamingDocument);
+    d->sharedStringsLimit = qMax(count, 0);
+}
+
+int StreamingDocument::sharedStringsLimit() const
+{
+    Q_D(const StreamingDocument);
+    return d->sharedStringsLimit;
+}
+
+/*!
+ * Set the document properties such as Title, Author etc.
+ * See Document::setDocumentProperty() for the property names.
+ */
+void StreamingDocument::setDocumentProperty(const QString &name, const QString &property)
+{
+    Q_D(StreamingDocument);
+    d->documentProperties[name] = property;
+}
+
+/*!
+ * Finishes the current worksheet and writes the rest of the package.
+ * No more cells can be written afterwards. Returns true if saved successfully.
+ */
+bool StreamingDocument::save()
+{
+    Q_D(StreamingDocument);
+    if (d->saved)
+        return false;
+    if (d->zipWriter->error()) {
+        d->saved = true;
+        return false;
+    }
+    if (d->sheetNames.isEmpty())
+        addSheet();
+    bool ok = d->endSheet();
+    d->saved = true;
+
+    ContentTypes contentTypes(ContentTypes::F_NewFromScratch);
+    DocPropsApp docPropsApp(DocPropsApp::F_NewFromScratch);
+    DocPropsCore docPropsCore(DocPropsCore::F_NewFromScratch);
+    Relationships workbookRels;
+
+    docPropsApp.addHeadingPair(QStringLiteral("Worksheets"), d->sheetNames.size());
+    QByteArray workbookXml;
+    QXmlStreamWriter writer(&workbookXml);
+    writer.writeStartDocument(QStringLiteral("1.0"), true);
+    writer.writeStartElement(QStringLiteral("workbook"));
+    writer.writeAttribute(QStringLiteral("xmlns"), QStringLiteral("http://schemas.openxmlformats.org/spreadsheetml/2006/main"));
+    writer.writeAttribute(QStringLiteral("xmlns:r"), QStringLiteral("http://schemas.openxmlformats.org/officeDocument/2006/relationships"));
+    writer.writeStartElement(QStringLiteral("sheets"));
+    for (int i = 0; i < d->sheetNames.size(); ++i) {
+        contentTypes.addWorksheetName(QStringLiteral("sheet%1").arg(i + 1));
+        docPropsApp.addPartTitle(d->sheetNames.at(i));
+        workbookRels.addDocumentRelationship(QStringLiteral("/worksheet"), QStringLiteral("worksheets/sheet%1.xml").arg(i + 1));
+        writer.writeEmptyElement(QStringLiteral("sheet"));
+        writer.writeAttribute(QStringLiteral("name"), d->sheetNames.at(i));
+        writer.writeAttribute(QStringLiteral("sheetId"), QString::number(i + 1));
+        writer.writeAttribute(QStringLiteral("r:id"), QStringLiteral("rId%1").arg(i + 1));
+    }
+    writer.writeEndElement(); // sheets
+    writer.writeEndElement(); // workbook
+    writer.writeEndDocument();
+    workbookRels.addDocumentRelationship(QStringLiteral("/theme"), QStringLiteral("theme/theme1.xml"));
+    workbookRels.addDocumentRelationship(QStringLiteral("/styles"), QStringLiteral("styles.xml"));
+
+    ZipStreamWriter *zip = d->zipWriter.data();
+    if (!d->sharedStrings.isEmpty()) {
+        workbookRels.addDocumentRelationship(QStringLiteral("/sharedStrings"), QStringLiteral("sharedStrings.xml"));
+        contentTypes.addSharedString();
+        ok = ok && zip->beginFile(QStringLiteral("xl/sharedStrings.xml"));
+        ok = ok && zip->writeData("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+                                  "<sst xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" count=\""
+                                  + QByteArray::number(d->sharedStringsCount) + "\" uniqueCount=\""
+                                  + QByteArray::number(d->sharedStrings.count()) + "\">");
+        d->sharedStringsFile.seek(0);
+        while (ok && !d->sharedStringsFile.atEnd())
+            ok = zip->writeData(d->sharedStringsFile.read(writeChunkSize));
+        ok = ok && zip->writeData(QByteArray("</sst>")) && zip->endFile();
+        d->sharedStrings.clear();
+        d->sharedStringsFile.close();
+    }
+
+    contentTypes.addWorkbook();
+    ok = ok && zip->addFile(QStringLiteral("xl/workbook.xml"), workbookXml);
+    ok = ok && zip->addFile(QStringLiteral("xl/_rels/workbook.xml.rels"), workbookRels.saveToXmlData());
+
+    foreach (QString name, d->documentProperties.keys()) {
+        docPropsApp.setProperty(name, d->documentProperties.value(name));
+        docPropsCore.setProperty(name, d->documentProperties.value(name));
+    }
+    contentTypes.addDocPropApp();
+    contentTypes.addDocPropCore();
+    ok = ok && zip->addFile(QStringLiteral("docProps/app.xml"), docPropsApp.saveToXmlData());
+    ok = ok && zip->addFile(QStringLiteral("docProps/core.xml"), docPropsCore.saveToXmlData());
+
+    contentTypes.addStyles();
+    ok = ok && zip->addFile(QStringLiteral("xl/styles.xml"), d->styles.saveToXmlData());
+    Theme theme(Theme::F_NewFromScratch);
+    contentTypes.addTheme();
+    ok = ok && zip->addFile(QStringLiteral("xl/theme/theme1.xml"), theme.saveToXmlData());
+
+    Relationships rootrels;
+    rootrels.addDocumentRelationship(QStringLiteral("/officeDocument"), QStringLiteral("xl/workbook.xml"));
+    rootrels.addPackageRelationship(QStringLiteral("/metadata/core-properties"), QStringLiteral("docProps/core.xml"));
+    rootrels.addDocumentRelationship(QStringLiteral("/extended-properties"), QStringLiteral("docProps/app.xml"));
+    ok = ok && zip->addFile(QStringLiteral("_rels/.rels"), rootrels.saveToXmlData());
+    ok = ok && zip->addFile(QStringLiteral("[Content_Types].xml"), contentTypes.saveToXmlData());
+
+    ok = zip->close() && ok;
+    if (d->file)
+        d->file->close();
+    return ok;
+}
+
+QT_END_NAMESPACE_XLSX
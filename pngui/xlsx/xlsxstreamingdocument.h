@@ -0,0 +1,74 @@
+/****************************************************************************
+** Copyright (c) 2013-2014 Debao Zhang <hello@debao.me>
+** All right reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+** NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+** LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+** OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+** WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+****************************************************************************/
+
+#ifndef QXLSX_XLSXSTREAMINGDOCUMENT_H
+#define QXLSX_XLSXSTREAMINGDOCUMENT_H
+
+#include "xlsxglobal.h"
+#include "xlsxformat.h"
+#include <QString>
+#include <QVariant>
+class QIODevice;
+
+QT_BEGIN_NAMESPACE_XLSX
+
+class CellReference;
+
+class StreamingDocumentPrivate;
+class Q_XLSX_EXPORT StreamingDocument
+{
+    Q_DECLARE_PRIVATE(StreamingDocument)
+
+public:
+    explicit StreamingDocument(const QString &xlsxName);
+    explicit StreamingDocument(QIODevice *device);
+    ~StreamingDocument();
+
+    bool isValid() const;
+    static int maximumRowCount();
+
+    bool addSheet(const QString &name = QString());
+    bool setColumnWidth(int column, double width);
+    bool setColumnWidth(int colFirst, int colLast, double width);
+
+    bool write(const CellReference &cell, const QVariant &value, const Format &format=Format());
+    bool write(int row, int col, const QVariant &value, const Format &format=Format());
+
+    void setRowBufferSize(int rows);
+    int rowBufferSize() const;
+    void setSharedStringsLimit(int count);
+    int sharedStringsLimit() const;
+    void setDocumentProperty(const QString &name, const QString &property);
+
+    bool save();
+
+private:
+    Q_DISABLE_COPY(StreamingDocument)
+    StreamingDocumentPrivate * const d_ptr;
+};
+
+QT_END_NAMESPACE_XLSX
+
+#endif // QXLSX_XLSXSTREAMINGDOCUMENT_H
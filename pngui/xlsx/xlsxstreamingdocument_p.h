@@ -0,0 +1,96 @@
+/****************************************************************************
+** Copyright (c) 2013-2014 Debao Zhang <hello@debao.me>
+** All right reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining
+** a copy of this software and associated documentation files (the
+** "Software"), to deal in the Software without restriction, including
+** without limitation the rights to use, copy, modify, merge, publish,
+** distribute, sublicense, and/or sell copies of the Software, and to
+** permit persons to whom the Software is furnished to do so, subject to
+** the following conditions:
+**
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+** MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+** NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+** LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+** OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+** WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**
+****************************************************************************/
+
+#ifndef XLSXSTREAMINGDOCUMENT_P_H
+#define XLSXSTREAMINGDOCUMENT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt Xlsx API.  It exists for the convenience
+// of the Qt Xlsx.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "xlsxstreamingdocument.h"
+#include "xlsxstyles_p.h"
+#include "xlsxzipwriter_p.h"
+
+#include <QMap>
+#include <QHash>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QStringList>
+#include <QScopedPointer>
+
+namespace QXlsx {
+
+class StreamingDocumentPrivate
+{
+    Q_DECLARE_PUBLIC(StreamingDocument)
+public:
+    StreamingDocumentPrivate(StreamingDocument *p);
+
+    bool beginSheetData();
+    bool flushRows(int belowRow);
+    bool endSheet();
+    QByteArray cellXml(int row, int col, const QVariant &value, const Format &format);
+    QByteArray stringCellXml(const QString &cellRef, const QByteArray &style, const QString &text);
+
+    StreamingDocument *q_ptr;
+    QScopedPointer<QFile> file;  // when the document owns its device
+    QIODevice *device;
+    QScopedPointer<ZipStreamWriter> zipWriter;
+    bool saved;
+
+    Styles styles;
+    QMap<QString, QString> documentProperties;
+
+    // Shared strings: index of each distinct string; the <si> elements go to a temporary file,
+    // in index order, and are copied into the package when it is saved.
+    QHash<QString, int> sharedStrings;
+    QTemporaryFile sharedStringsFile;
+    int sharedStringsCount;
+    int sharedStringsLimit;
+
+    // Current sheet
+    QStringList sheetNames;
+    bool sheetOpen;
+    bool sheetDataStarted;
+    QMap<int, double> columnWidths;
+    // Rows not yet written, as <c> elements by column
+    QMap<int, QMap<int, QByteArray> > pendingRows;
+    int rowBufferSize;
+    int lastFlushedRow;
+    int maxRow;
+    QByteArray buffer;
+};
+
+}
+
+#endif // XLSXSTREAMINGDOCUMENT_P_H
@@ -24,7 +24,10 @@
 ****************************************************************************/
 #include "xlsxzipwriter_p.h"
 #include <QDebug>
+#include <QDateTime>
+#include <QIODevice>
 #include <private/qzipwriter_p.h>
+#include <zlib.h>
 
 namespace QXlsx {
 
@@ -65,4 +68,227 @@ void ZipWriter::close()
     m_writer->close();
 }
 
+namespace {
+
+void appendUInt16(QByteArray &buffer, quint16 value)
+{
+    buffer.append(char(value & 0xff));
+    buffer.append(char((value >> 8) & 0xff));
+}
+
+void appendUInt32(QByteArray &buffer, quint32 value)
+{
+    appendUInt16(buffer, quint16(value & 0xffff));
+    appendUInt16(buffer, quint16((value >> 16) & 0xffff));
+}
+
+const int chunkSize = 65536;
+const quint16 versionNeeded = 20;
+const quint16 flagDataDescriptorUtf8 = 0x0008 | 0x0800;
+const quint16 methodDeflated = 8;
+
+}
+
+ZipStreamWriter::ZipStreamWriter(QIODevice *device) :
+    m_device(device), m_stream(new z_stream), m_inFile(false), m_error(false),
+    m_position(0), m_compressedSize(0), m_uncompressedSize(0)
+{
+    if (!m_device || !m_device->isWritable())
+        m_error = true;
+    QDateTime now = QDateTime::currentDateTime();
+    m_dosTime = quint16((now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() / 2));
+    m_dosDate = quint16(((qMax(now.date().year(), 1980) - 1980) << 9) | (now.date().month() << 5) | now.date().day());
+    m_buffer.resize(chunkSize);
+}
+
+ZipStreamWriter::~ZipStreamWriter()
+{
+    if (m_inFile)
+        deflateEnd(m_stream);
+    delete m_stream;
+}
+
+bool ZipStreamWriter::error() const
+{
+    return m_error;
+}
+
+bool ZipStreamWriter::writeRaw(const QByteArray &data)
+{
+    if (m_error)
+        return false;
+    if (m_device->write(data) != data.size()) {
+        m_error = true;
+        return false;
+    }
+    m_position += data.size();
+    return true;
+}
+
+bool ZipStreamWriter::beginFile(const QString &filePath)
+{
+    if (m_error || m_inFile)
+        return false;
+    // Plain zip, without zip64 extensions: offsets must fit in 32 bits
+    if (m_position > 0xffffffffLL) {
+        m_error = true;
+        return false;
+    }
+    m_current.name = filePath.toUtf8();
+    m_current.crc = crc32(0L, Z_NULL, 0);
+    m_current.compressedSize = 0;
+    m_current.uncompressedSize = 0;
+    m_current.offset = quint32(m_position);
+    m_compressedSize = m_uncompressedSize = 0;
+
+    m_stream->zalloc = Z_NULL;
+    m_stream->zfree = Z_NULL;
+    m_stream->opaque = Z_NULL;
+    // Negative window bits: raw deflate data, as stored in zip files
+    if (deflateInit2(m_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        m_error = true;
+        return false;
+    }
+    m_inFile = true;
+
+    QByteArray header;
+    appendUInt32(header, 0x04034b50);
+    appendUInt16(header, versionNeeded);
+    appendUInt16(header, flagDataDescriptorUtf8);
+    appendUInt16(header, methodDeflated);
+    appendUInt16(header, m_dosTime);
+    appendUInt16(header, m_dosDate);
+    appendUInt32(header, 0); // crc, in data descriptor
+    appendUInt32(header, 0); // compressed size, in data descriptor
+    appendUInt32(header, 0); // uncompressed size, in data descriptor
+    appendUInt16(header, quint16(m_current.name.size()));
+    appendUInt16(header, 0); // extra field length
+    header.append(m_current.name);
+    return writeRaw(header);
+}
+
+bool ZipStreamWriter::deflateData(const char *data, qint64 size, int flush)
+{
+    m_stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    m_stream->avail_in = uInt(size);
+    int ret = Z_OK;
+    do {
+        m_stream->next_out = reinterpret_cast<Bytef *>(m_buffer.data());
+        m_stream->avail_out = uInt(m_buffer.size());
+        ret = deflate(m_stream, flush);
+        if (ret == Z_STREAM_ERROR) {
+            m_error = true;
+            return false;
+        }
+        int produced = m_buffer.size() - int(m_stream->avail_out);
+        if (produced > 0) {
+            if (!writeRaw(QByteArray::fromRawData(m_buffer.constData(), produced)))
+                return false;
+            m_compressedSize += produced;
+        }
+    } while (m_stream->avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+    return true;
+}
+
+bool ZipStreamWriter::writeData(const char *data, qint64 size)
+{
+    if (m_error || !m_inFile)
+        return false;
+    while (size > 0) {
+        qint64 length = qMin(size, qint64(chunkSize));
+        m_current.crc = crc32(m_current.crc, reinterpret_cast<const Bytef *>(data), uInt(length));
+        if (!deflateData(data, length, Z_NO_FLUSH))
+            return false;
+        m_uncompressedSize += length;
+        data += length;
+        size -= length;
+    }
+    return true;
+}
+
+bool ZipStreamWriter::writeData(const QByteArray &data)
+{
+    return writeData(data.constData(), data.size());
+}
+
+bool ZipStreamWriter::endFile()
+{
+    if (m_error || !m_inFile)
+        return false;
+    bool ok = deflateData(0, 0, Z_FINISH);
+    deflateEnd(m_stream);
+    m_inFile = false;
+    if (!ok)
+        return false;
+    if (m_compressedSize > 0xffffffffLL || m_uncompressedSize > 0xffffffffLL) {
+        m_error = true;
+        return false;
+    }
+    m_current.compressedSize = quint32(m_compressedSize);
+    m_current.uncompressedSize = quint32(m_uncompressedSize);
+
+    QByteArray descriptor;
+    appendUInt32(descriptor, 0x08074b50);
+    appendUInt32(descriptor, m_current.crc);
+    appendUInt32(descriptor, m_current.compressedSize);
+    appendUInt32(descriptor, m_current.uncompressedSize);
+    if (!writeRaw(descriptor))
+        return false;
+    m_entries.append(m_current);
+    return true;
+}
+
+bool ZipStreamWriter::addFile(const QString &filePath, const QByteArray &data)
+{
+    return beginFile(filePath) && writeData(data) && endFile();
+}
+
+bool ZipStreamWriter::close()
+{
+    if (m_inFile)
+        endFile();
+    if (m_error)
+        return false;
+
+    qint64 directoryOffset = m_position;
+    QByteArray directory;
+    foreach (const Entry &entry, m_entries) {
+        appendUInt32(directory, 0x02014b50);
+        appendUInt16(directory, versionNeeded); // version made by
+        appendUInt16(directory, versionNeeded);
+        appendUInt16(directory, flagDataDescriptorUtf8);
+        appendUInt16(directory, methodDeflated);
+        appendUInt16(directory, m_dosTime);
+        appendUInt16(directory, m_dosDate);
+        appendUInt32(directory, entry.crc);
+        appendUInt32(directory, entry.compressedSize);
+        appendUInt32(directory, entry.uncompressedSize);
+        appendUInt16(directory, quint16(entry.name.size()));
+        appendUInt16(directory, 0); // extra field length
+        appendUInt16(directory, 0); // comment length
+        appendUInt16(directory, 0); // disk number
+        appendUInt16(directory, 0); // internal attributes
+        appendUInt32(directory, 0); // external attributes
+        appendUInt32(directory, entry.offset);
+        directory.append(entry.name);
+    }
+    if (directoryOffset + directory.size() > 0xffffffffLL || m_entries.size() > 0xffff) {
+        m_error = true;
+        return false;
+    }
+    QByteArray end;
+    appendUInt32(end, 0x06054b50);
+    appendUInt16(end, 0); // disk number
+    appendUInt16(end, 0); // disk with the central directory
+    appendUInt16(end, quint16(m_entries.size()));
+    appendUInt16(end, quint16(m_entries.size()));
+    appendUInt32(end, quint32(directory.size()));
+    appendUInt32(end, quint32(directoryOffset));
+    appendUInt16(end, 0); // comment length
+    if (!writeRaw(directory) || !writeRaw(end))
+        return false;
+    m_entries.clear();
+    return true;
+}
+
 } // namespace QXlsx
@@ -37,8 +37,11 @@
 //
 
 #include <QString>
+#include <QList>
+#include <QByteArray>
 class QIODevice;
 class QZipWriter;
+struct z_stream_s;
 
 namespace QXlsx {
 
@@ -58,6 +61,49 @@ private:
     QZipWriter *m_writer;
 };
 
+// Writes a zip archive sequentially, so that an entry can be written piece by piece while
+// it is being generated, without holding it in memory. Entries are deflated, and their CRC
+// and sizes are written in a data descriptor after the data.
+class ZipStreamWriter
+{
+public:
+    explicit ZipStreamWriter(QIODevice *device);
+    ~ZipStreamWriter();
+
+    bool beginFile(const QString &filePath);
+    bool writeData(const char *data, qint64 size);
+    bool writeData(const QByteArray &data);
+    bool endFile();
+    bool addFile(const QString &filePath, const QByteArray &data);
+    bool error() const;
+    bool close();
+
+private:
+    struct Entry {
+        QByteArray name;
+        quint32 crc;
+        quint32 compressedSize;
+        quint32 uncompressedSize;
+        quint32 offset;
+    };
+
+    bool deflateData(const char *data, qint64 size, int flush);
+    bool writeRaw(const QByteArray &data);
+
+    QIODevice *m_device;
+    z_stream_s *m_stream;
+    QList<Entry> m_entries;
+    Entry m_current;
+    bool m_inFile;
+    bool m_error;
+    quint16 m_dosTime;
+    quint16 m_dosDate;
+    qint64 m_position;
+    qint64 m_compressedSize;
+    qint64 m_uncompressedSize;
+    QByteArray m_buffer;
+};
+
 } // namespace QXlsx
 
 #endif // QXLSX_ZIPWRITER_H
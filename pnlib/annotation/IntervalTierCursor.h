@@ -0,0 +1,187 @@
+#ifndef INTERVALTIERCURSOR_H
+#define INTERVALTIERCURSOR_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include "PraalineCore/Base/RealTime.h"
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+
+// Walking aligned interval tiers together (e.g. utterances, tokens, syllables, phones) in one linear pass, instead of
+// calling getIntervalsContainedIn or getIntervalsOverlappingWith on the lower tier for each interval of the upper one.
+// Header-only, so that pngui, the application and the plugins can use it without linking to pnlib.
+
+// Consecutive intervals [firstIndex, lastIndex] of a tier. Nothing is copied: a span stays valid only as long as its
+// tier is not modified. Can be iterated with foreach or a range-based for.
+class IntervalSpan
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator() : m_tier(nullptr), m_index(0) {}
+        const_iterator(Praaline::Core::IntervalTier *tier, int index) : m_tier(tier), m_index(index) {}
+        Praaline::Core::Interval *operator*() const { return m_tier->interval(m_index); }
+        const_iterator &operator++() { ++m_index; return *this; }
+        const_iterator operator++(int) { const_iterator i(*this); ++m_index; return i; }
+        bool operator==(const const_iterator &other) const { return m_index == other.m_index && m_tier == other.m_tier; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        // Index of the interval in its tier
+        int index() const { return m_index; }
+    private:
+        Praaline::Core::IntervalTier *m_tier;
+        int m_index;
+    };
+    typedef const_iterator iterator;
+
+    IntervalSpan() : m_tier(nullptr), m_first(0), m_last(-1) {}
+    IntervalSpan(Praaline::Core::IntervalTier *tier, int first, int last) : m_tier(tier), m_first(first), m_last(last) {}
+
+    Praaline::Core::IntervalTier *tier() const { return m_tier; }
+    int firstIndex() const { return m_first; }
+    int lastIndex() const { return m_last; }
+    int count() const { return (m_tier && m_last >= m_first) ? m_last - m_first + 1 : 0; }
+    bool isEmpty() const { return count() == 0; }
+
+    Praaline::Core::Interval *at(int i) const { return m_tier->interval(m_first + i); }
+    Praaline::Core::Interval *first() const { return m_tier->interval(m_first); }
+    Praaline::Core::Interval *last() const { return m_tier->interval(m_last); }
+
+    const_iterator begin() const { return const_iterator(m_tier, m_first); }
+    const_iterator end() const { return const_iterator(m_tier, m_first + count()); }
+
+    QList<Praaline::Core::Interval *> toList() const {
+        QList<Praaline::Core::Interval *> ret;
+        for (int i = 0; i < count(); ++i) ret << at(i);
+        return ret;
+    }
+
+private:
+    Praaline::Core::IntervalTier *m_tier;
+    int m_first;
+    int m_last;
+};
+
+// Answers containment and overlap queries on one tier. The cursor remembers where the last query started, so that
+// queries in time order cost a few comparisons each (plus the size of the result). Queries out of order, or far
+// ahead, fall back to a binary search: the results are always correct, only the cost changes.
+class IntervalTierCursor
+{
+public:
+    explicit IntervalTierCursor(Praaline::Core::IntervalTier *tier = nullptr) : m_tier(tier), m_position(0) {}
+
+    Praaline::Core::IntervalTier *tier() const { return m_tier; }
+    void setTier(Praaline::Core::IntervalTier *tier) { m_tier = tier; m_position = 0; }
+    void reset() { m_position = 0; }
+
+    // Index of the first interval ending after time t (the number of intervals if there is none)
+    int seek(const RealTime &t) {
+        if (!m_tier) return 0;
+        int n = m_tier->count();
+        if (m_position > n) m_position = n;
+        if (m_position > 0 && m_tier->interval(m_position - 1)->tMax() > t) {
+            m_position = lowerBound(0, m_position - 1, t);
+            return m_position;
+        }
+        int steps = 0;
+        while (m_position < n && m_tier->interval(m_position)->tMax() <= t) {
+            ++m_position;
+            if (++steps == linearSteps) {
+                m_position = lowerBound(m_position, n, t);
+                break;
+            }
+        }
+        return m_position;
+    }
+
+    // Intervals starting at or after tMin and ending at or before tMax
+    IntervalSpan containedIn(const RealTime &tMin, const RealTime &tMax) {
+        if (!m_tier) return IntervalSpan();
+        int n = m_tier->count();
+        int first = seek(tMin);
+        // Zero-length intervals at tMin end before the position of the cursor
+        while (first > 0 && m_tier->interval(first - 1)->tMin() >= tMin) --first;
+        while (first < n && m_tier->interval(first)->tMin() < tMin) ++first;
+        int last = first - 1;
+        while (last + 1 < n && m_tier->interval(last + 1)->tMax() <= tMax) ++last;
+        return IntervalSpan(m_tier, first, last);
+    }
+    IntervalSpan containedIn(const Praaline::Core::Interval *parent) {
+        return containedIn(parent->tMin(), parent->tMax());
+    }
+
+    // Intervals overlapping with [tMin, tMax] by more than threshold on each side
+    IntervalSpan overlappingWith(const RealTime &tMin, const RealTime &tMax, const RealTime &threshold = RealTime(0, 0)) {
+        if (!m_tier) return IntervalSpan();
+        int n = m_tier->count();
+        int first = seek(tMin + threshold);
+        int last = first - 1;
+        while (last + 1 < n && m_tier->interval(last + 1)->tMin() < tMax - threshold) ++last;
+        return IntervalSpan(m_tier, first, last);
+    }
+    IntervalSpan overlappingWith(const Praaline::Core::Interval *parent, const RealTime &threshold = RealTime(0, 0)) {
+        return overlappingWith(parent->tMin(), parent->tMax(), threshold);
+    }
+
+    // Moves up to this number of intervals forward before switching to a binary search
+    static const int linearSteps = 16;
+
+private:
+    Praaline::Core::IntervalTier *m_tier;
+    int m_position;
+
+    // First index in [from, to) of an interval ending after t, or to
+    int lowerBound(int from, int to, const RealTime &t) const {
+        while (from < to) {
+            int mid = from + (to - from) / 2;
+            if (m_tier->interval(mid)->tMax() <= t) from = mid + 1; else to = mid;
+        }
+        return from;
+    }
+};
+
+// One cursor per level of a hierarchy of aligned tiers, listed from the top down (e.g. utterances, tokens,
+// syllables, phones). Nested loops that ask, at each level, for the intervals within the current interval of the
+// level above walk the whole hierarchy in one linear pass:
+//
+//     IntervalTierHierarchyCursor h(QList<IntervalTier *>() << tier_utt << tier_tok << tier_syll);
+//     foreach (Interval *utt, h.all(0))
+//         foreach (Interval *tok, h.children(0, utt))
+//             foreach (Interval *syll, h.children(1, tok)) ...
+class IntervalTierHierarchyCursor
+{
+public:
+    enum Relation { Contained, Overlapping };
+
+    explicit IntervalTierHierarchyCursor(const QList<Praaline::Core::IntervalTier *> &levels, Relation relation = Contained) :
+        m_relation(relation)
+    {
+        foreach (Praaline::Core::IntervalTier *tier, levels) m_cursors << IntervalTierCursor(tier);
+    }
+
+    int levelCount() const { return m_cursors.count(); }
+    Praaline::Core::IntervalTier *level(int level) const { return m_cursors.at(level).tier(); }
+
+    // All the intervals of a level
+    IntervalSpan all(int level) const {
+        Praaline::Core::IntervalTier *tier = m_cursors.at(level).tier();
+        return tier ? IntervalSpan(tier, 0, tier->count() - 1) : IntervalSpan();
+    }
+    // Intervals of a level within an interval of any level above it
+    IntervalSpan within(int level, const Praaline::Core::Interval *parent) {
+        if (level < 0 || level >= m_cursors.count() || !parent) return IntervalSpan();
+        if (m_relation == Overlapping) return m_cursors[level].overlappingWith(parent);
+        return m_cursors[level].containedIn(parent);
+    }
+    // Intervals of the level below parentLevel within parent
+    IntervalSpan children(int parentLevel, const Praaline::Core::Interval *parent) {
+        return within(parentLevel + 1, parent);
+    }
+
+private:
+    QVector<IntervalTierCursor> m_cursors;
+    Relation m_relation;
+};
+
+#endif // INTERVALTIERCURSOR_H
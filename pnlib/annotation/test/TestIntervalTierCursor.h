@@ -0,0 +1,92 @@
+#ifndef TEST_INTERVALTIERCURSOR_H
+#define TEST_INTERVALTIERCURSOR_H
+
+#include "IntervalTierCursor.h"
+
+#include <QObject>
+#include <QtTest>
+
+using namespace Praaline::Core;
+
+// The cursors must give the same intervals as the queries of IntervalTier, whatever the order of the queries.
+class TestIntervalTierCursor : public QObject
+{
+    Q_OBJECT
+
+    // Intervals of 10 to 300 ms, covering [0, duration]
+    static IntervalTier *randomTier(const QString &name, double duration, quint32 seed) {
+        QList<Interval *> intervals;
+        double t = 0.0;
+        while (t < duration) {
+            seed = seed * 1664525u + 1013904223u;
+            double next = qMin(duration, t + 0.010 + 0.290 * ((seed >> 8) / 16777216.0));
+            intervals << new Interval(RealTime::fromSeconds(t), RealTime::fromSeconds(next), QString::number(intervals.count()));
+            t = next;
+        }
+        return new IntervalTier(name, intervals, RealTime::zeroTime, RealTime::fromSeconds(duration));
+    }
+
+    static QList<QPair<double, double> > windows(double duration, int count, bool ordered, quint32 seed) {
+        QList<QPair<double, double> > ret;
+        double start = 0.0;
+        for (int i = 0; i < count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            double r = (seed >> 8) / 16777216.0;
+            start = ordered ? qMin(duration, start + 0.5 * r) : r * duration;
+            seed = seed * 1664525u + 1013904223u;
+            double length = 2.0 * ((seed >> 8) / 16777216.0);
+            ret << QPair<double, double>(start, qMin(duration, start + length));
+        }
+        return ret;
+    }
+
+    static void compareQueries(bool ordered) {
+        QScopedPointer<IntervalTier> tier(randomTier("tier", 60.0, 42));
+        IntervalTierCursor cursorContained(tier.data()), cursorOverlapping(tier.data());
+        typedef QPair<double, double> Window;
+        foreach (Window w, windows(60.0, 500, ordered, 7)) {
+            RealTime tMin = RealTime::fromSeconds(w.first), tMax = RealTime::fromSeconds(w.second);
+            QCOMPARE(cursorContained.containedIn(tMin, tMax).toList(), tier->getIntervalsContainedIn(tMin, tMax));
+            Interval window(tMin, tMax, "");
+            QCOMPARE(cursorOverlapping.overlappingWith(&window).toList(), tier->getIntervalsOverlappingWith(&window));
+        }
+    }
+
+private slots:
+    void orderedQueries() {
+        compareQueries(true);
+    }
+
+    void unorderedQueries() {
+        compareQueries(false);
+    }
+
+    void emptySpans() {
+        IntervalTierCursor none;
+        QVERIFY(none.containedIn(RealTime::zeroTime, RealTime::fromSeconds(1.0)).isEmpty());
+        QScopedPointer<IntervalTier> tier(randomTier("tier", 10.0, 3));
+        IntervalTierCursor cursor(tier.data());
+        // A window shorter than any interval contains none of them
+        IntervalSpan span = cursor.containedIn(RealTime::fromSeconds(5.0), RealTime::fromSeconds(5.001));
+        QVERIFY(span.isEmpty());
+        int iterations = 0;
+        foreach (Interval *intv, span) { Q_UNUSED(intv) iterations++; }
+        QCOMPARE(iterations, 0);
+    }
+
+    void hierarchy() {
+        QScopedPointer<IntervalTier> tier_utt(randomTier("utt", 30.0, 11));
+        QScopedPointer<IntervalTier> tier_tok(randomTier("tok", 30.0, 12));
+        QScopedPointer<IntervalTier> tier_phone(randomTier("phone", 30.0, 13));
+        IntervalTierHierarchyCursor h(QList<IntervalTier *>() << tier_utt.data() << tier_tok.data() << tier_phone.data());
+        QCOMPARE(h.levelCount(), 3);
+        QCOMPARE(h.all(0).count(), tier_utt->count());
+        foreach (Interval *utt, h.all(0)) {
+            QCOMPARE(h.children(0, utt).toList(), tier_tok->getIntervalsContainedIn(utt));
+            // Phones of the utterance, skipping the token level
+            QCOMPARE(h.within(2, utt).toList(), tier_phone->getIntervalsContainedIn(utt));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,36 @@
+TEMPLATE = app
+
+CONFIG( debug, debug|release ) {
+    COMPONENTSPATH = build/debug
+} else {
+    COMPONENTSPATH = build/release
+}
+
+DEFINES += USE_NAMESPACE_PRAALINE_CORE
+INCLUDEPATH += .. ../../.. ../../../praaline-core/include
+DEPENDPATH += .. ../../..
+
+LIBS += -L../../../praaline-core/$${COMPONENTSPATH} -lpraaline-core$${PRAALINE_LIB_POSTFIX}
+
+CONFIG += qt thread warn_on stl rtti exceptions console c++11
+QT += concurrent testlib
+QT -= gui
+
+TARGET = annotation-test
+
+OBJECTS_DIR = o
+MOC_DIR = o
+
+HEADERS += TestIntervalTierCursor.h
+SOURCES += main.cpp
+
+!win32 {
+    !macx* {
+        QMAKE_POST_LINK=./$${TARGET}
+    }
+    macx* {
+        QMAKE_POST_LINK=./$${TARGET}.app/Contents/MacOS/$${TARGET}
+    }
+}
+
+win32:QMAKE_POST_LINK=./release/$${TARGET}.exe
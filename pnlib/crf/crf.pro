@@ -30,6 +30,7 @@ HEADERS += \
     feature_index.h \
     feature_cache.h \
     encoder.h \
+    cross_validation.h \
     darts.h \
     crfpp.h \
     config.h \
@@ -45,5 +46,6 @@ SOURCES += \
     feature_index.cpp \
     feature_cache.cpp \
     feature.cpp \
-    encoder.cpp
+    encoder.cpp \
+    cross_validation.cpp
 
@@ -0,0 +1,390 @@
+//
+//  CRF++ -- Yet Another CRF toolkit
+//
+//  In-process k-fold cross-validation and parameter sweep.
+//
+//  Copyright(C) 2005-2007 Taku Kudo <taku@chasen.org>
+//
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include "encoder.h"
+#include "tagger.h"
+#include "common.h"
+#include "feature_index.h"
+#include "scoped_ptr.h"
+#include "thread.h"
+#include "cross_validation.h"
+
+namespace CRFPP {
+
+namespace {
+double ratio(size_t num, size_t den) {
+    return den ? static_cast<double>(num) / static_cast<double>(den) : 0.0;
+}
+}
+
+double CrossValidationResult::accuracy() const {
+    return 1.0 - ratio(token_errors, tokens);
+}
+
+double CrossValidationResult::precision(size_t label) const {
+    return ratio(true_positives[label],
+                 true_positives[label] + false_positives[label]);
+}
+
+double CrossValidationResult::recall(size_t label) const {
+    return ratio(true_positives[label],
+                 true_positives[label] + false_negatives[label]);
+}
+
+double CrossValidationResult::f1(size_t label) const {
+    const double p = precision(label);
+    const double r = recall(label);
+    return (p + r > 0.0) ? 2.0 * p * r / (p + r) : 0.0;
+}
+
+double CrossValidationResult::macroF1() const {
+    if (labels.empty()) {
+        return 0.0;
+    }
+    double s = 0.0;
+    for (size_t i = 0; i < labels.size(); ++i) {
+        s += f1(i);
+    }
+    return s / labels.size();
+}
+
+struct CrossValidator::Setting {
+    double C;
+    size_t freq;
+};
+
+// Training data read and feature-extracted once for a frequency cut-off.
+// Read-only while the training jobs run.
+struct CrossValidator::SharedCorpus {
+    size_t                    freq;
+    EncoderFeatureIndex       feature_index;
+    scoped_ptr<Allocator>     allocator;
+    std::vector<TaggerImpl *> x;
+    std::string               error;
+
+    explicit SharedCorpus(size_t f) : freq(f) {}
+    ~SharedCorpus() {
+        for (size_t i = 0; i < x.size(); ++i) {
+            delete x[i];
+        }
+    }
+};
+
+struct CrossValidator::Job {
+    SharedCorpus   *corpus;
+    size_t          setting;
+    size_t          fold;
+    unsigned short  thread_num;
+    bool            prepare;
+};
+
+class CrossValidator::Worker: public thread {
+public:
+    CrossValidator    *owner;
+    std::vector<Job>  *jobs;
+
+    void run() {
+        Job *job = 0;
+        while (owner->nextJob(jobs, &job)) {
+            if (job->prepare) {
+                owner->prepare(job->corpus);
+            } else {
+                owner->train(job);
+            }
+        }
+    }
+};
+
+CrossValidator::CrossValidator()
+    : folds_(5), thread_num_(0), maxitr_(100000), eta_(0.0001),
+      shrinking_size_(20), algorithm_(Encoder::CRF_L2), listener_(0),
+      next_job_(0) {}
+
+CrossValidator::~CrossValidator() {
+    clearSettings();
+    for (size_t i = 0; i < corpora_.size(); ++i) {
+        delete corpora_[i];
+    }
+}
+
+void CrossValidator::addSetting(double C, size_t freq) {
+    Setting *setting = new Setting;
+    setting->C = C;
+    setting->freq = std::max(freq, static_cast<size_t>(1));
+    settings_.push_back(setting);
+}
+
+void CrossValidator::clearSettings() {
+    for (size_t i = 0; i < settings_.size(); ++i) {
+        delete settings_[i];
+    }
+    settings_.clear();
+}
+
+bool CrossValidator::nextJob(std::vector<Job> *jobs, Job **job) {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (next_job_ >= jobs->size()) {
+        return false;
+    }
+    *job = &(*jobs)[next_job_++];
+    return true;
+}
+
+void CrossValidator::finished(const CrossValidationResult &result) {
+    std::lock_guard<std::mutex> guard(lock_);
+    results_.push_back(result);
+    if (listener_) {
+        listener_->foldFinished(result);
+    }
+}
+
+void CrossValidator::runJobs(std::vector<Job> *jobs, unsigned short workers) {
+    next_job_ = 0;
+    std::vector<Worker> thread(std::max(workers, static_cast<unsigned short>(1)));
+    for (size_t i = 0; i < thread.size(); ++i) {
+        thread[i].owner = this;
+        thread[i].jobs = jobs;
+        thread[i].start();
+    }
+    for (size_t i = 0; i < thread.size(); ++i) {
+        thread[i].join();
+    }
+}
+
+bool CrossValidator::prepare(SharedCorpus *corpus) {
+    if (!corpus->feature_index.open(templfile_.c_str(), trainfile_.c_str())) {
+        corpus->error = corpus->feature_index.what();
+        return false;
+    }
+    corpus->allocator.reset(new Allocator(1));
+
+#if defined(__MINGW32__)
+    std::ifstream ifs(trainfile_.c_str());
+#else
+    std::ifstream ifs(WPATH(trainfile_.c_str()));
+#endif
+    if (!ifs) {
+        corpus->error = "cannot open: " + trainfile_;
+        return false;
+    }
+
+    while (ifs) {
+        TaggerImpl *x = new TaggerImpl();
+        x->open(&corpus->feature_index, corpus->allocator.get());
+        if (!x->read(&ifs) || !x->shrink()) {
+            corpus->error = x->what();
+            delete x;
+            return false;
+        }
+        if (x->empty()) {
+            delete x;
+            continue;
+        }
+        corpus->x.push_back(x);
+    }
+
+    corpus->feature_index.shrink(corpus->freq, corpus->allocator.get());
+    return true;
+}
+
+bool CrossValidator::train(Job *job) {
+    const Setting *setting = settings_[job->setting];
+    SharedCorpus *corpus = job->corpus;
+
+    CrossValidationResult result;
+    result.fold = job->fold;
+    result.C = setting->C;
+    result.freq = setting->freq;
+    result.features = corpus->feature_index.size();
+    result.trained = false;
+    result.tokens = result.token_errors = 0;
+    result.sentences = result.sentence_errors = 0;
+    for (size_t i = 0; i < corpus->feature_index.ysize(); ++i) {
+        result.labels.push_back(corpus->feature_index.y(i));
+    }
+    result.true_positives.resize(result.labels.size(), 0);
+    result.false_positives.resize(result.labels.size(), 0);
+    result.false_negatives.resize(result.labels.size(), 0);
+
+    // Private weights and lattices over the shared features
+    TrainerFeatureIndex feature_index(corpus->feature_index);
+    std::vector<double> alpha(feature_index.size() + 1, 0.0);
+    feature_index.set_alpha(&alpha[0]);
+    Allocator allocator(job->thread_num, corpus->allocator->feature_cache());
+
+    std::vector<TaggerImpl *> train_x;
+    std::vector<TaggerImpl *> test_x;
+    for (size_t i = 0; i < corpus->x.size(); ++i) {
+        TaggerImpl *x = new TaggerImpl();
+        x->openView(*corpus->x[i], &feature_index, &allocator);
+        if (i % folds_ == job->fold) {
+            test_x.push_back(x);
+        } else {
+            x->set_thread_id(train_x.size() % job->thread_num);
+            train_x.push_back(x);
+        }
+    }
+
+    if (!train_x.empty()) {
+        switch (algorithm_) {
+        case Encoder::MIRA:
+            result.trained = runMIRA(train_x, &feature_index, &alpha[0],
+                                     maxitr_, setting->C, eta_,
+                                     shrinking_size_, 1, 0);
+            break;
+        case Encoder::CRF_L2:
+        case Encoder::CRF_L1:
+            result.trained = runCRF(train_x, &feature_index, &alpha[0],
+                                    maxitr_, setting->C, eta_,
+                                    shrinking_size_, job->thread_num,
+                                    (algorithm_ == Encoder::CRF_L1), 0);
+            break;
+        }
+    }
+
+    if (result.trained) {
+        for (size_t i = 0; i < test_x.size(); ++i) {
+            TaggerImpl *x = test_x[i];
+            x->set_thread_id(0);
+            const int err = x->evaluate();
+            result.tokens += x->size();
+            result.token_errors += err;
+            result.sentences++;
+            if (err) {
+                result.sentence_errors++;
+            }
+            for (size_t k = 0; k < x->size(); ++k) {
+                const size_t answer = x->answer(k);
+                const size_t predicted = x->result(k);
+                if (answer == predicted) {
+                    result.true_positives[answer]++;
+                } else {
+                    result.false_positives[predicted]++;
+                    result.false_negatives[answer]++;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < train_x.size(); ++i) {
+        delete train_x[i];
+    }
+    for (size_t i = 0; i < test_x.size(); ++i) {
+        delete test_x[i];
+    }
+
+    finished(result);
+    return result.trained;
+}
+
+bool CrossValidator::run(const char *templfile, const char *trainfile) {
+    CHECK_FALSE(folds_ >= 2) << "number of folds must be >= 2";
+    CHECK_FALSE(!settings_.empty()) << "no setting to evaluate";
+    CHECK_FALSE(eta_ > 0.0) << "eta must be > 0.0";
+    CHECK_FALSE(shrinking_size_ >= 1) << "shrinking-size must be >= 1";
+    for (size_t i = 0; i < settings_.size(); ++i) {
+        CHECK_FALSE(settings_[i]->C >= 0.0) << "C must be >= 0.0";
+    }
+
+    templfile_ = templfile;
+    trainfile_ = trainfile;
+    results_.clear();
+    for (size_t i = 0; i < corpora_.size(); ++i) {
+        delete corpora_[i];
+    }
+    corpora_.clear();
+
+    unsigned short budget = thread_num_;
+    if (budget == 0) {
+        budget = static_cast<unsigned short>(
+                    std::max(1u, std::thread::hardware_concurrency()));
+    }
+#ifndef CRFPP_USE_THREAD
+    budget = 1;
+#endif
+
+    // Read the training data and extract features once per cut-off
+    std::vector<Job> jobs;
+    std::vector<SharedCorpus *> corpus_of_setting(settings_.size(), 0);
+    for (size_t s = 0; s < settings_.size(); ++s) {
+        for (size_t c = 0; c < corpora_.size(); ++c) {
+            if (corpora_[c]->freq == settings_[s]->freq) {
+                corpus_of_setting[s] = corpora_[c];
+            }
+        }
+        if (corpus_of_setting[s]) {
+            continue;
+        }
+        SharedCorpus *corpus = new SharedCorpus(settings_[s]->freq);
+        corpora_.push_back(corpus);
+        corpus_of_setting[s] = corpus;
+        Job job = { corpus, s, 0, 1, true };
+        jobs.push_back(job);
+    }
+    runJobs(&jobs, static_cast<unsigned short>(
+                std::min(static_cast<size_t>(budget), jobs.size())));
+    for (size_t c = 0; c < corpora_.size(); ++c) {
+        CHECK_FALSE(corpora_[c]->error.empty()) << corpora_[c]->error;
+        CHECK_FALSE(corpora_[c]->x.size() >= folds_)
+                << "fewer sentences than folds: " << trainfile;
+    }
+
+    // Train all folds of all settings; threads left over when there are
+    // fewer jobs than the budget go to the gradient computation of each job
+    jobs.clear();
+    const size_t total = settings_.size() * folds_;
+    unsigned short per_job = static_cast<unsigned short>(
+                std::max(static_cast<size_t>(1), budget / total));
+    if (algorithm_ == Encoder::MIRA) {
+        per_job = 1;
+    }
+    for (size_t s = 0; s < settings_.size(); ++s) {
+        for (size_t f = 0; f < folds_; ++f) {
+            Job job = { corpus_of_setting[s], s, f, per_job, false };
+            jobs.push_back(job);
+        }
+    }
+    runJobs(&jobs, static_cast<unsigned short>(
+                std::max(static_cast<size_t>(1),
+                         std::min(total, static_cast<size_t>(budget / per_job)))));
+
+    for (size_t i = 0; i < corpora_.size(); ++i) {
+        delete corpora_[i];
+    }
+    corpora_.clear();
+
+    return true;
+}
+
+int CrossValidator::bestSetting() const {
+    int best = -1;
+    double best_accuracy = -1.0;
+    for (size_t s = 0; s < settings_.size(); ++s) {
+        size_t tokens = 0;
+        size_t errors = 0;
+        for (size_t i = 0; i < results_.size(); ++i) {
+            if (results_[i].C == settings_[s]->C &&
+                    results_[i].freq == settings_[s]->freq) {
+                tokens += results_[i].tokens;
+                errors += results_[i].token_errors;
+            }
+        }
+        if (tokens == 0) {
+            continue;
+        }
+        const double accuracy = 1.0 - ratio(errors, tokens);
+        if (accuracy > best_accuracy) {
+            best_accuracy = accuracy;
+            best = static_cast<int>(s);
+        }
+    }
+    return best;
+}
+}
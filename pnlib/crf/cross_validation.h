@@ -0,0 +1,114 @@
+//
+//  CRF++ -- Yet Another CRF toolkit
+//
+//  In-process k-fold cross-validation and parameter sweep.
+//
+//  Copyright(C) 2005-2007 Taku Kudo <taku@chasen.org>
+//
+#ifndef CRFPP_CROSS_VALIDATION_H_
+#define CRFPP_CROSS_VALIDATION_H_
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include "common.h"
+
+namespace CRFPP {
+
+// Scores of one trained model (one fold of one C/frequency setting) on
+// its held-out fold.
+struct CrossValidationResult {
+    size_t fold;
+    double C;
+    size_t freq;
+    size_t features;
+    bool trained;
+    size_t tokens;
+    size_t token_errors;
+    size_t sentences;
+    size_t sentence_errors;
+    std::vector<std::string> labels;
+    std::vector<size_t> true_positives;
+    std::vector<size_t> false_positives;
+    std::vector<size_t> false_negatives;
+
+    double accuracy() const;
+    double precision(size_t label) const;
+    double recall(size_t label) const;
+    double f1(size_t label) const;
+    double macroF1() const;
+};
+
+class CrossValidationListener {
+public:
+    virtual ~CrossValidationListener() {}
+    // Called as soon as a fold has been trained and evaluated. Calls are
+    // serialised, but they come from the worker threads.
+    virtual void foldFinished(const CrossValidationResult &result) = 0;
+};
+
+// Trains and evaluates all folds of all (C, frequency cut-off) settings
+// concurrently, within a global thread budget. The training file is read
+// and its features extracted once per frequency cut-off; every fold and
+// every C value trained with that cut-off shares the same feature index
+// and feature cache, each model only owning its weight vector and its
+// lattices. Sentence i belongs to fold (i % folds).
+// Since features are extracted over the whole file, the frequency
+// cut-off also counts occurrences in the held-out fold; features seen
+// only in the held-out fold keep a zero weight.
+class CrossValidator {
+public:
+    CrossValidator();
+    virtual ~CrossValidator();
+
+    void setFolds(size_t folds)                    { folds_ = folds; }
+    void setThreadBudget(unsigned short thread_num) { thread_num_ = thread_num; }
+    void setMaxIterations(size_t maxitr)           { maxitr_ = maxitr; }
+    void setEta(double eta)                        { eta_ = eta; }
+    void setShrinkingSize(unsigned short size)     { shrinking_size_ = size; }
+    void setAlgorithm(int algorithm)               { algorithm_ = algorithm; }
+    void setListener(CrossValidationListener *listener) { listener_ = listener; }
+
+    void addSetting(double C, size_t freq);
+    void clearSettings();
+
+    bool run(const char *templfile, const char *trainfile);
+
+    const std::vector<CrossValidationResult> &results() const { return results_; }
+    // Index of the setting (in the order they were added) with the best
+    // mean token accuracy over all folds, or -1 before run().
+    int bestSetting() const;
+
+    const char* what() { return what_.str(); }
+
+private:
+    struct Setting;
+    struct SharedCorpus;
+    struct Job;
+    class Worker;
+    friend class Worker;
+
+    bool prepare(SharedCorpus *corpus);
+    bool train(Job *job);
+    void runJobs(std::vector<Job> *jobs, unsigned short workers);
+    bool nextJob(std::vector<Job> *jobs, Job **job);
+    void finished(const CrossValidationResult &result);
+
+    size_t                     folds_;
+    unsigned short             thread_num_;
+    size_t                     maxitr_;
+    double                     eta_;
+    unsigned short             shrinking_size_;
+    int                        algorithm_;
+    CrossValidationListener   *listener_;
+    std::vector<Setting *>     settings_;
+    std::vector<SharedCorpus *> corpora_;
+    std::vector<CrossValidationResult> results_;
+    std::string                templfile_;
+    std::string                trainfile_;
+    std::mutex                 lock_;
+    size_t                     next_job_;
+    whatlog                    what_;
+};
+}
+#endif
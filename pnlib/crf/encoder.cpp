@@ -25,6 +25,7 @@
 #include "feature_index.h"
 #include "scoped_ptr.h"
 #include "thread.h"
+#include "cross_validation.h"
 
 namespace CRFPP {
 namespace {
@@ -93,13 +94,14 @@ public:
 };
 
 bool runMIRA(const std::vector<TaggerImpl* > &x,
-             EncoderFeatureIndex *feature_index,
+             FeatureIndex *feature_index,
              double *alpha,
              size_t maxitr,
              float C,
              double /* eta */,
              unsigned short shrinking_size,
-             unsigned short /* thread_num */)
+             unsigned short /* thread_num */,
+             std::ostream *log)
 {
     std::vector<unsigned char> shrink(x.size());
     std::vector<float> upper_bound(x.size());
@@ -169,13 +171,15 @@ bool runMIRA(const std::vector<TaggerImpl* > &x,
             obj += alpha[i] * alpha[i];
         }
 
-        std::cout << "iter="  << itr
-                  << " terr=" << 1.0 * err / all
-                  << " serr=" << 1.0 * zeroone / x.size()
-                  << " act=" <<  active_set
-                  << " uact=" << upper_active_set
-                  << " obj=" << obj
-                  << " kkt=" << max_kkt_violation << std::endl;
+        if (log) {
+            *log << "iter="  << itr
+                 << " terr=" << 1.0 * err / all
+                 << " serr=" << 1.0 * zeroone / x.size()
+                 << " act=" <<  active_set
+                 << " uact=" << upper_active_set
+                 << " obj=" << obj
+                 << " kkt=" << max_kkt_violation << std::endl;
+        }
 
         if (max_kkt_violation <= 0.0) {
             std::fill(shrink.begin(), shrink.end(), 0);
@@ -193,14 +197,15 @@ bool runMIRA(const std::vector<TaggerImpl* > &x,
 }
 
 bool runCRF(const std::vector<TaggerImpl* > &x,
-            EncoderFeatureIndex *feature_index,
+            FeatureIndex *feature_index,
             double *alpha,
             size_t maxitr,
             float C,
             double eta,
             unsigned short /* shrinking_size */,
             unsigned short thread_num,
-            bool orthant) {
+            bool orthant,
+            std::ostream *log) {
     double old_obj = 1e+37;
     int    converge = 0;
     LBFGS lbfgs;
@@ -258,12 +263,14 @@ bool runCRF(const std::vector<TaggerImpl* > &x,
 
         double diff = (itr == 0 ? 1.0 :
                                   std::abs(old_obj - thread[0].obj)/old_obj);
-        std::cout << "iter="  << itr
-                  << " terr=" << 1.0 * thread[0].err / all
-                  << " serr=" << 1.0 * thread[0].zeroone / x.size()
-                  << " act=" << num_nonzero
-                  << " obj=" << thread[0].obj
-                  << " diff="  << diff << std::endl;
+        if (log) {
+            *log << "iter="  << itr
+                 << " terr=" << 1.0 * thread[0].err / all
+                 << " serr=" << 1.0 * thread[0].zeroone / x.size()
+                 << " act=" << num_nonzero
+                 << " obj=" << thread[0].obj
+                 << " diff="  << diff << std::endl;
+        }
         old_obj = thread[0].obj;
 
         if (diff < eta) {
@@ -397,19 +404,22 @@ bool Encoder::learn(const char *templfile,
     switch (algorithm) {
     case MIRA:
         if (!runMIRA(x, &feature_index, &alpha[0],
-                     maxitr, C, eta, shrinking_size, thread_num)) {
+                     maxitr, C, eta, shrinking_size, thread_num,
+                     &std::cout)) {
             WHAT_ERROR("MIRA execute error");
         }
         break;
     case CRF_L2:
         if (!runCRF(x, &feature_index, &alpha[0],
-                    maxitr, C, eta, shrinking_size, thread_num, false)) {
+                    maxitr, C, eta, shrinking_size, thread_num, false,
+                    &std::cout)) {
             WHAT_ERROR("CRF_L2 execute error");
         }
         break;
     case CRF_L1:
         if (!runCRF(x, &feature_index, &alpha[0],
-                    maxitr, C, eta, shrinking_size, thread_num, true)) {
+                    maxitr, C, eta, shrinking_size, thread_num, true,
+                    &std::cout)) {
             WHAT_ERROR("CRF_L1 execute error");
         }
         break;
@@ -449,11 +459,102 @@ const CRFPP::Option long_options[] = {
     {"shrinking-size", 'H', "20", "INT",
      "set INT for number of iterations variable needs to "
      " be optimal before considered for shrinking. (default 20)" },
+    {"cross-validation", 'k', "0", "INT",
+     "choose cost and cut-off by INT-fold cross-validation before "
+     "training (default 0, no cross-validation)" },
+    {"cv-cost",  'O', "",       "LIST",
+     "comma-separated costs to try in cross-validation (default --cost)" },
+    {"cv-freq",  'F', "",       "LIST",
+     "comma-separated cut-offs to try in cross-validation (default --freq)" },
     {"version",  'v', 0,        0,       "show the version and exit" },
     {"help",     'h', 0,        0,       "show this help and exit" },
     {0, 0, 0, 0, 0}
 };
 
+class CrossValidationPrinter : public CrossValidationListener {
+public:
+    void foldFinished(const CrossValidationResult &result) {
+        std::cout << "fold=" << result.fold
+                  << " C=" << result.C
+                  << " freq=" << result.freq;
+        if (!result.trained) {
+            std::cout << " not trained" << std::endl;
+            return;
+        }
+        std::cout << " features=" << result.features
+                  << " accuracy=" << result.accuracy()
+                  << " macro-F1=" << result.macroF1() << std::endl;
+    }
+};
+
+template <class T>
+bool parseList(const std::string &list, T defaultValue, std::vector<T> *values) {
+    values->clear();
+    if (list.empty()) {
+        values->push_back(defaultValue);
+        return true;
+    }
+    std::vector<char> buf(list.begin(), list.end());
+    buf.push_back('\0');
+    std::vector<char *> items(list.size() + 1);
+    const size_t size = tokenize(&buf[0], ",", items.begin(), items.size());
+    for (size_t i = 0; i < size; ++i) {
+        if (*items[i] == '\0') {
+            return false;
+        }
+        values->push_back(static_cast<T>(std::atof(items[i])));
+    }
+    return true;
+}
+
+// Chooses C and freq by cross-validation over the training file. Leaves
+// them untouched if there is nothing to choose from.
+bool crossValidate(const Param &param, const char *templfile,
+                   const char *trainfile, size_t folds, size_t maxiter,
+                   double eta, unsigned short thread,
+                   unsigned short shrinking_size, int algorithm,
+                   double *C, size_t *freq) {
+    std::vector<double> costs;
+    std::vector<size_t> freqs;
+    if (!parseList(param.get<std::string>("cv-cost"), *C, &costs) ||
+            !parseList(param.get<std::string>("cv-freq"), *freq, &freqs)) {
+        std::cerr << "invalid --cv-cost or --cv-freq list" << std::endl;
+        return false;
+    }
+
+    CrossValidationPrinter printer;
+    CrossValidator validator;
+    validator.setFolds(folds);
+    validator.setThreadBudget(thread);
+    validator.setMaxIterations(maxiter);
+    validator.setEta(eta);
+    validator.setShrinkingSize(shrinking_size);
+    validator.setAlgorithm(algorithm);
+    validator.setListener(&printer);
+    for (size_t i = 0; i < freqs.size(); ++i) {
+        for (size_t j = 0; j < costs.size(); ++j) {
+            validator.addSetting(costs[j], freqs[i]);
+        }
+    }
+
+    std::cout.setf(std::ios::fixed, std::ios::floatfield);
+    std::cout.precision(5);
+    if (!validator.run(templfile, trainfile)) {
+        std::cerr << validator.what() << std::endl;
+        return false;
+    }
+
+    const int best = validator.bestSetting();
+    if (best < 0) {
+        std::cerr << "cross-validation did not train any model" << std::endl;
+        return false;
+    }
+    *C = costs[best % costs.size()];
+    *freq = freqs[best / costs.size()];
+    std::cout << "best setting: C=" << *C << " freq=" << *freq << std::endl;
+    return true;
+}
+
 int crfpp_learn(const Param &param) {
     if (!param.help_version()) {
         return 0;
@@ -468,15 +569,16 @@ int crfpp_learn(const Param &param) {
         return 0;
     }
 
-    const size_t         freq           = param.get<int>("freq");
+    size_t               freq           = param.get<int>("freq");
     const size_t         maxiter        = param.get<int>("maxiter");
-    const double         C              = param.get<float>("cost");
+    double               C              = param.get<float>("cost");
     const double         eta            = param.get<float>("eta");
     const bool           textmodel      = param.get<bool>("textmodel");
     const unsigned short thread         =
             CRFPP::getThreadSize(param.get<unsigned short>("thread"));
     const unsigned short shrinking_size
             = param.get<unsigned short>("shrinking-size");
+    const size_t         folds          = param.get<int>("cross-validation");
     std::string salgo = param.get<std::string>("algorithm");
 
     CRFPP::toLower(&salgo);
@@ -500,6 +602,12 @@ int crfpp_learn(const Param &param) {
             return -1;
         }
     } else {
+        if (folds > 0 &&
+                !crossValidate(param, rest[0].c_str(), rest[1].c_str(),
+                               folds, maxiter, eta, thread, shrinking_size,
+                               algorithm, &C, &freq)) {
+            return -1;
+        }
         if (!encoder.learn(rest[0].c_str(),
                            rest[1].c_str(),
                            rest[2].c_str(),
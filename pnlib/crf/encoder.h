@@ -8,9 +8,36 @@
 #ifndef CRFPP_ENCODER_H_
 #define CRFPP_ENCODER_H_
 
+#include <vector>
 #include "common.h"
 
 namespace CRFPP {
+class FeatureIndex;
+class TaggerImpl;
+
+// Training loops shared by Encoder::learn and CrossValidator.
+// Progress is written to log, unless it is null.
+bool runMIRA(const std::vector<TaggerImpl* > &x,
+             FeatureIndex *feature_index,
+             double *alpha,
+             size_t maxitr,
+             float C,
+             double eta,
+             unsigned short shrinking_size,
+             unsigned short thread_num,
+             std::ostream *log);
+
+bool runCRF(const std::vector<TaggerImpl* > &x,
+            FeatureIndex *feature_index,
+            double *alpha,
+            size_t maxitr,
+            float C,
+            double eta,
+            unsigned short shrinking_size,
+            unsigned short thread_num,
+            bool orthant,
+            std::ostream *log);
+
 class Encoder {
 public:
     enum { CRF_L2, CRF_L1, MIRA };
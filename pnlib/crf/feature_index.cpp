@@ -51,6 +51,15 @@ char *Allocator::strdup(const char *p) {
 Allocator::Allocator(size_t thread_num)
     : thread_num_(thread_num),
       feature_cache_(new FeatureCache),
+      shared_feature_cache_(0),
+      char_freelist_(new FreeList<char>(8192)) {
+    init();
+}
+
+Allocator::Allocator(size_t thread_num, FeatureCache *shared_feature_cache)
+    : thread_num_(thread_num),
+      feature_cache_(new FeatureCache),
+      shared_feature_cache_(shared_feature_cache),
       char_freelist_(new FreeList<char>(8192)) {
     init();
 }
@@ -58,6 +67,7 @@ Allocator::Allocator(size_t thread_num)
 Allocator::Allocator()
     : thread_num_(1),
       feature_cache_(new FeatureCache),
+      shared_feature_cache_(0),
       char_freelist_(new FreeList<char>(8192)) {
     init();
 }
@@ -87,6 +97,9 @@ void Allocator::clear_freelist(size_t thread_id) {
 }
 
 FeatureCache *Allocator::feature_cache() const {
+    if (shared_feature_cache_) {
+        return shared_feature_cache_;
+    }
     return feature_cache_.get();
 }
 
@@ -103,6 +116,17 @@ void Allocator::init() {
     }
 }
 
+void FeatureIndex::copyStructure(const FeatureIndex &other) {
+    maxid_ = other.maxid_;
+    cost_factor_ = other.cost_factor_;
+    xsize_ = other.xsize_;
+    max_xsize_ = other.max_xsize_;
+    unigram_templs_ = other.unigram_templs_;
+    bigram_templs_ = other.bigram_templs_;
+    y_ = other.y_;
+    templs_ = other.templs_;
+}
+
 int DecoderFeatureIndex::getID(const char *key) const {
     return da_.exactMatchSearch<Darts::DoubleArray::result_type>(key);
 }
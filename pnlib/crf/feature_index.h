@@ -26,6 +26,9 @@ class TaggerImpl;
 class Allocator {
 public:
     explicit Allocator(size_t thread_num);
+    // Uses the (read-only) feature cache of another allocator, so that
+    // taggers opened with TaggerImpl::openView share extracted features.
+    Allocator(size_t thread_num, FeatureCache *shared_feature_cache);
     Allocator();
     virtual ~Allocator();
 
@@ -42,6 +45,7 @@ private:
 
     size_t                       thread_num_;
     scoped_ptr<FeatureCache>     feature_cache_;
+    FeatureCache                *shared_feature_cache_;
     scoped_ptr<FreeList<char> >  char_freelist_;
     scoped_array< FreeList<Path> > path_freelist_;
     scoped_array< FreeList<Node> > node_freelist_;
@@ -77,6 +81,8 @@ public:
     const char *getTemplate() const;
 
 protected:
+    void copyStructure(const FeatureIndex &other);
+
     virtual int getID(const char *str) const = 0;
     const char *getIndex(const char *&p,
                          size_t pos,
@@ -115,6 +121,19 @@ private:
     mutable std::map<std::string, std::pair<int, unsigned int> > dic_;
 };
 
+// Feature index used to train several models over the same extracted
+// features at the same time: it copies the tag set, templates and
+// feature id space of an encoder index, but keeps its own weights.
+class TrainerFeatureIndex: public FeatureIndex {
+public:
+    explicit TrainerFeatureIndex(const FeatureIndex &shared) {
+        copyStructure(shared);
+    }
+
+private:
+    int getID(const char *) const { return -1; }
+};
+
 class DecoderFeatureIndex: public FeatureIndex {
 public:
     bool open(const char *model_filename);
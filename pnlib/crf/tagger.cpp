@@ -134,6 +134,25 @@ bool TaggerImpl::open(FeatureIndex *feature_index,
     return true;
 }
 
+bool TaggerImpl::openView(const TaggerImpl &shared,
+                          FeatureIndex *feature_index,
+                          Allocator *allocator) {
+    close();
+    mode_ = LEARN;
+    feature_index_ = feature_index;
+    allocator_ = allocator;
+    ysize_ = feature_index_->ysize();
+    feature_id_ = shared.feature_id_;
+    x_ = shared.x_;
+    answer_ = shared.answer_;
+    result_ = shared.result_;
+    node_.resize(shared.node_.size());
+    for (size_t i = 0; i < node_.size(); ++i) {
+        node_[i].resize(ysize_);
+    }
+    return true;
+}
+
 bool TaggerImpl::open(FeatureIndex *feature_index,
                       unsigned int nbest,
                       unsigned int vlevel) {
@@ -454,6 +473,15 @@ bool TaggerImpl::next() {
     return 0;
 }
 
+int TaggerImpl::evaluate() {
+    if (x_.empty()) {
+        return 0;
+    }
+    buildLattice();
+    viterbi();
+    return eval();
+}
+
 int TaggerImpl::eval() {
     int err = 0;
     for (size_t i = 0; i < x_.size(); ++i) {
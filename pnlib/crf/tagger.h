@@ -75,6 +75,11 @@ public:
     // for LEARN mode
     bool         open(FeatureIndex *feature_index, Allocator *allocator);
 
+    // for LEARN mode, sharing the sentence and the extracted features
+    // of an already built tagger (see TrainerFeatureIndex).
+    bool         openView(const TaggerImpl &shared,
+                          FeatureIndex *feature_index, Allocator *allocator);
+
     // for TEST mode, but feature_index is shared.
     bool         open(FeatureIndex *feature_index,
                       unsigned int nvest, unsigned velvel);
@@ -88,6 +93,7 @@ public:
 
 
     int          eval();
+    int          evaluate();
     double       gradient(double *);
     double       collins(double *);
     bool         shrink();
@@ -0,0 +1,422 @@
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QtAlgorithms>
+#include <QtConcurrent>
+#include <vector>
+#include <algorithm>
+
+#include "PraalineCore/Annotation/Interval.h"
+using namespace Praaline::Core;
+
+#include "IntervalDiffEngine.h"
+
+// ====================================================================================================================
+// Label interning
+// ====================================================================================================================
+
+int IntervalLabelInterner::intern(const QString &label)
+{
+    QString key = (m_ignoreCase) ? label.toLower() : label;
+    QHash<QString, int>::const_iterator it = m_ids.constFind(key);
+    if (it != m_ids.constEnd()) return it.value();
+    int id = m_ids.count();
+    m_ids.insert(key, id);
+    return id;
+}
+
+QVector<int> IntervalLabelInterner::intern(const QList<Interval *> &intervals, const QString &attributeID)
+{
+    QVector<int> ids;
+    ids.reserve(intervals.count());
+    foreach (Interval *intv, intervals) {
+        if (!intv) { ids << intern(QString()); continue; }
+        ids << intern((attributeID.isEmpty()) ? intv->text() : intv->attribute(attributeID).toString());
+    }
+    return ids;
+}
+
+// ====================================================================================================================
+// Diff algorithms
+// ====================================================================================================================
+
+namespace {
+
+class DiffContext
+{
+public:
+    DiffContext(const int *a, int n, const int *b, int m, int alphabetSize, IntervalDiffSink *sink) :
+        a(a), n(n), b(b), m(m), alphabetSize(alphabetSize), sink(sink)
+    {}
+
+    void run();
+    int distance();
+
+private:
+    const int *a; int n;
+    const int *b; int m;
+    int alphabetSize;
+    IntervalDiffSink *sink;
+    // Buffers reused across the recursion
+    std::vector<int> v1, v2;
+    std::vector<quint64> masks, bits;
+    std::vector<int> rowForward, rowBackward;
+
+    void emitCommon(int i, int j)   { sink->addElement(dtl::SES_COMMON, i + 1, j + 1); }
+    void emitDelete(int i)          { sink->addElement(dtl::SES_DELETE, i + 1, 0); }
+    void emitAdd(int j)             { sink->addElement(dtl::SES_ADD, 0, j + 1); }
+    void emitReplace(int aLo, int aHi, int bLo, int bHi);
+
+    int trimPrefix(int aLo, int aHi, int bLo, int bHi) const;
+    int trimSuffix(int aLo, int aHi, int bLo, int bHi) const;
+
+    int myersDistance(int aLo, int aHi, int bLo, int bHi, int maxD);
+    void myers(int aLo, int aHi, int bLo, int bHi);
+    bool myersMiddleSnake(int aLo, int aHi, int bLo, int bHi, int &splitA, int &splitB);
+
+    void lcsRow(const int *x, int nx, const int *y, int ny, bool reversed, std::vector<int> &row);
+    void hirschberg(int aLo, int aHi, int bLo, int bHi);
+};
+
+void DiffContext::emitReplace(int aLo, int aHi, int bLo, int bHi)
+{
+    for (int i = aLo; i < aHi; ++i) emitDelete(i);
+    for (int j = bLo; j < bHi; ++j) emitAdd(j);
+}
+
+int DiffContext::trimPrefix(int aLo, int aHi, int bLo, int bHi) const
+{
+    int k = 0;
+    while (aLo + k < aHi && bLo + k < bHi && a[aLo + k] == b[bLo + k]) ++k;
+    return k;
+}
+
+int DiffContext::trimSuffix(int aLo, int aHi, int bLo, int bHi) const
+{
+    int k = 0;
+    while (aHi - k > aLo && bHi - k > bLo && a[aHi - k - 1] == b[bHi - k - 1]) ++k;
+    return k;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Myers O(ND), linear space
+// --------------------------------------------------------------------------------------------------------------------
+
+// Forward pass only: number of edits, or -1 if more than maxD
+int DiffContext::myersDistance(int aLo, int aHi, int bLo, int bHi, int maxD)
+{
+    int lenA = aHi - aLo, lenB = bHi - bLo;
+    int offset = maxD + 1;
+    v1.assign(2 * maxD + 3, -1);
+    v1[offset + 1] = 0;
+    int kStart = 0, kEnd = 0;
+    for (int d = 0; d <= maxD; ++d) {
+        for (int k = -d + kStart; k <= d - kEnd; k += 2) {
+            int x = (k == -d || (k != d && v1[offset + k - 1] < v1[offset + k + 1])) ?
+                        v1[offset + k + 1] : v1[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < lenA && y < lenB && a[aLo + x] == b[bLo + y]) { ++x; ++y; }
+            v1[offset + k] = x;
+            if (x > lenA)       kEnd += 2;
+            else if (y > lenB)  kStart += 2;
+            else if (x == lenA && y == lenB) return d;
+        }
+    }
+    return -1;
+}
+
+// Finds the middle snake of the shortest edit path, searching from both ends at the same time.
+// Returns false if the two sequences have nothing in common.
+bool DiffContext::myersMiddleSnake(int aLo, int aHi, int bLo, int bHi, int &splitA, int &splitB)
+{
+    int lenA = aHi - aLo, lenB = bHi - bLo;
+    int maxD = (lenA + lenB + 1) / 2;
+    int offset = maxD;
+    int size = 2 * maxD + 2;
+    v1.assign(size, -1);
+    v2.assign(size, -1);
+    v1[offset + 1] = 0;
+    v2[offset + 1] = 0;
+    int delta = lenA - lenB;
+    // If the total number of elements is odd, the front path will collide with the reverse path
+    bool front = (delta % 2 != 0);
+    int k1Start = 0, k1End = 0, k2Start = 0, k2End = 0;
+    for (int d = 0; d < maxD; ++d) {
+        // Walk the front path one step
+        for (int k1 = -d + k1Start; k1 <= d - k1End; k1 += 2) {
+            int k1Offset = offset + k1;
+            int x1 = (k1 == -d || (k1 != d && v1[k1Offset - 1] < v1[k1Offset + 1])) ?
+                         v1[k1Offset + 1] : v1[k1Offset - 1] + 1;
+            int y1 = x1 - k1;
+            while (x1 < lenA && y1 < lenB && a[aLo + x1] == b[bLo + y1]) { ++x1; ++y1; }
+            v1[k1Offset] = x1;
+            if (x1 > lenA)      k1End += 2;     // ran off the right of the graph
+            else if (y1 > lenB) k1Start += 2;   // ran off the bottom of the graph
+            else if (front) {
+                int k2Offset = offset + delta - k1;
+                if (k2Offset >= 0 && k2Offset < size && v2[k2Offset] != -1) {
+                    // Mirror x2 onto top-left coordinate system
+                    int x2 = lenA - v2[k2Offset];
+                    if (x1 >= x2) { splitA = aLo + x1; splitB = bLo + y1; return true; }
+                }
+            }
+        }
+        // Walk the reverse path one step
+        for (int k2 = -d + k2Start; k2 <= d - k2End; k2 += 2) {
+            int k2Offset = offset + k2;
+            int x2 = (k2 == -d || (k2 != d && v2[k2Offset - 1] < v2[k2Offset + 1])) ?
+                         v2[k2Offset + 1] : v2[k2Offset - 1] + 1;
+            int y2 = x2 - k2;
+            while (x2 < lenA && y2 < lenB && a[aHi - x2 - 1] == b[bHi - y2 - 1]) { ++x2; ++y2; }
+            v2[k2Offset] = x2;
+            if (x2 > lenA)      k2End += 2;
+            else if (y2 > lenB) k2Start += 2;
+            else if (!front) {
+                int k1Offset = offset + delta - k2;
+                if (k1Offset >= 0 && k1Offset < size && v1[k1Offset] != -1) {
+                    int x1 = v1[k1Offset];
+                    int y1 = offset + x1 - k1Offset;
+                    if (x1 >= lenA - x2) { splitA = aLo + x1; splitB = bLo + y1; return true; }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void DiffContext::myers(int aLo, int aHi, int bLo, int bHi)
+{
+    int prefix = trimPrefix(aLo, aHi, bLo, bHi);
+    for (int k = 0; k < prefix; ++k) emitCommon(aLo + k, bLo + k);
+    aLo += prefix; bLo += prefix;
+    int suffix = trimSuffix(aLo, aHi, bLo, bHi);
+    aHi -= suffix; bHi -= suffix;
+
+    int splitA = 0, splitB = 0;
+    if (aLo == aHi || bLo == bHi) {
+        emitReplace(aLo, aHi, bLo, bHi);
+    }
+    else if (myersMiddleSnake(aLo, aHi, bLo, bHi, splitA, splitB)) {
+        myers(aLo, splitA, bLo, splitB);
+        myers(splitA, aHi, splitB, bHi);
+    }
+    else {
+        emitReplace(aLo, aHi, bLo, bHi);
+    }
+
+    for (int k = 0; k < suffix; ++k) emitCommon(aHi + k, bHi + k);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Hirschberg, with bit-parallel LCS rows (Allison-Dix / Hyyro)
+// --------------------------------------------------------------------------------------------------------------------
+
+// row[j] = LCS(x, y[0..j)) for j = 0..ny; with reversed = true, both sequences are read backwards.
+// Bit i of the state vector stands for x[i]; after each element of y, the LCS is the number of zero bits.
+void DiffContext::lcsRow(const int *x, int nx, const int *y, int ny, bool reversed, std::vector<int> &row)
+{
+    int words = (nx + 63) / 64;
+    if (masks.size() < static_cast<size_t>(alphabetSize) * words)
+        masks.resize(static_cast<size_t>(alphabetSize) * words, 0);
+    for (int i = 0; i < nx; ++i) {
+        int c = (reversed) ? x[nx - 1 - i] : x[i];
+        masks[static_cast<size_t>(c) * words + i / 64] |= (Q_UINT64_C(1) << (i % 64));
+    }
+    bits.assign(words, ~Q_UINT64_C(0));
+    quint64 lastWordMask = (nx % 64) ? ((Q_UINT64_C(1) << (nx % 64)) - 1) : ~Q_UINT64_C(0);
+
+    row.resize(ny + 1);
+    row[0] = 0;
+    for (int j = 0; j < ny; ++j) {
+        int c = (reversed) ? y[ny - 1 - j] : y[j];
+        const quint64 *match = &masks[static_cast<size_t>(c) * words];
+        quint64 carry = 0;
+        int ones = 0;
+        for (int w = 0; w < words; ++w) {
+            quint64 v = bits[w];
+            quint64 u = v & match[w];
+            quint64 sum = v + u;
+            quint64 carryOut = (sum < v) ? 1 : 0;
+            sum += carry;
+            if (sum < carry) carryOut = 1;
+            carry = carryOut;
+            v = sum | (v & ~match[w]);
+            bits[w] = v;
+            ones += qPopulationCount((w == words - 1) ? (v & lastWordMask) : v);
+        }
+        row[j + 1] = nx - ones;
+    }
+
+    // Leave the masks cleared for the next call
+    for (int i = 0; i < nx; ++i) {
+        int c = (reversed) ? x[nx - 1 - i] : x[i];
+        masks[static_cast<size_t>(c) * words + i / 64] = 0;
+    }
+}
+
+void DiffContext::hirschberg(int aLo, int aHi, int bLo, int bHi)
+{
+    int prefix = trimPrefix(aLo, aHi, bLo, bHi);
+    for (int k = 0; k < prefix; ++k) emitCommon(aLo + k, bLo + k);
+    aLo += prefix; bLo += prefix;
+    int suffix = trimSuffix(aLo, aHi, bLo, bHi);
+    aHi -= suffix; bHi -= suffix;
+
+    int lenA = aHi - aLo, lenB = bHi - bLo;
+    if (lenA == 0 || lenB == 0) {
+        emitReplace(aLo, aHi, bLo, bHi);
+    }
+    else if (lenA == 1) {
+        int j = bLo;
+        while (j < bHi && b[j] != a[aLo]) ++j;
+        if (j == bHi) {
+            emitReplace(aLo, aHi, bLo, bHi);
+        } else {
+            for (int k = bLo; k < j; ++k) emitAdd(k);
+            emitCommon(aLo, j);
+            for (int k = j + 1; k < bHi; ++k) emitAdd(k);
+        }
+    }
+    else {
+        // Split A in two halves, and B where the sum of the LCS of the top half with the prefix of B
+        // and of the bottom half with the suffix of B is maximal.
+        int midA = aLo + lenA / 2;
+        lcsRow(a + aLo, midA - aLo, b + bLo, lenB, false, rowForward);
+        lcsRow(a + midA, aHi - midA, b + bLo, lenB, true, rowBackward);
+        int best = -1, splitB = bLo;
+        for (int j = 0; j <= lenB; ++j) {
+            int score = rowForward[j] + rowBackward[lenB - j];
+            if (score > best) { best = score; splitB = bLo + j; }
+        }
+        hirschberg(aLo, midA, bLo, splitB);
+        hirschberg(midA, aHi, splitB, bHi);
+    }
+
+    for (int k = 0; k < suffix; ++k) emitCommon(aHi + k, bHi + k);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+void DiffContext::run()
+{
+    int prefix = trimPrefix(0, n, 0, m);
+    int suffix = trimSuffix(prefix, n, prefix, m);
+    int lenA = n - prefix - suffix, lenB = m - prefix - suffix;
+    bool useMyers = true;
+    if (alphabetSize <= IntervalDiffEngine::smallAlphabetLimit && lenA > 0 && lenB > 0) {
+        // Myers takes about (N + M) * D steps, a bit-parallel LCS row N * M / 64. Try Myers with an edit
+        // budget costing about as much as two LCS rows, and fall back to Hirschberg when it is exceeded.
+        qint64 budget = static_cast<qint64>(lenA) * lenB / (32 * (static_cast<qint64>(lenA) + lenB));
+        if (budget < static_cast<qint64>(lenA) + lenB) {
+            useMyers = (myersDistance(prefix, n - suffix, prefix, m - suffix, static_cast<int>(budget)) >= 0);
+        }
+    }
+    if (useMyers)
+        myers(0, n, 0, m);
+    else
+        hirschberg(0, n, 0, m);
+}
+
+int DiffContext::distance()
+{
+    int prefix = trimPrefix(0, n, 0, m);
+    int suffix = trimSuffix(prefix, n, prefix, m);
+    int lenA = n - prefix - suffix, lenB = m - prefix - suffix;
+    if (lenA == 0 || lenB == 0) return lenA + lenB;
+    if (alphabetSize <= IntervalDiffEngine::smallAlphabetLimit) {
+        lcsRow(a + prefix, lenA, b + prefix, lenB, false, rowForward);
+        return lenA + lenB - 2 * rowForward[lenB];
+    }
+    return myersDistance(prefix, n - suffix, prefix, m - suffix, lenA + lenB);
+}
+
+// Collects the edit script in dtl format
+class SesCollectorSink : public IntervalDiffSink
+{
+public:
+    SesCollectorSink(const QList<Interval *> &intervalsA, const QList<Interval *> &intervalsB,
+                     dtl::Ses<Interval *>::sesElemVec &ses) :
+        intervalsA(intervalsA), intervalsB(intervalsB), ses(ses)
+    {}
+    void addElement(dtl::edit_t type, long long indexA, long long indexB) override
+    {
+        dtl::elemInfo info;
+        info.beforeIdx = indexA;
+        info.afterIdx = indexB;
+        info.type = type;
+        Interval *intv = (type == dtl::SES_ADD) ? intervalsB.at(indexB - 1) : intervalsA.at(indexA - 1);
+        ses.push_back(dtl::Ses<Interval *>::sesElem(intv, info));
+    }
+private:
+    const QList<Interval *> &intervalsA;
+    const QList<Interval *> &intervalsB;
+    dtl::Ses<Interval *>::sesElemVec &ses;
+};
+
+struct RunDiffStep
+{
+    typedef dtl::Ses<Interval *>::sesElemVec result_type;
+
+    dtl::Ses<Interval *>::sesElemVec operator() (const IntervalDiffEngine::Job &job)
+    {
+        return IntervalDiffEngine::diff(job.intervalsA, job.intervalsB, job.ignoreCase, job.attributeA, job.attributeB);
+    }
+};
+
+} // namespace
+
+// ====================================================================================================================
+// IntervalDiffEngine
+// ====================================================================================================================
+
+// static
+void IntervalDiffEngine::diffSequences(const QVector<int> &a, const QVector<int> &b, int alphabetSize,
+                                       IntervalDiffSink *sink)
+{
+    if (!sink) return;
+    DiffContext context(a.constData(), a.count(), b.constData(), b.count(), alphabetSize, sink);
+    context.run();
+}
+
+// static
+int IntervalDiffEngine::editDistance(const QVector<int> &a, const QVector<int> &b, int alphabetSize)
+{
+    DiffContext context(a.constData(), a.count(), b.constData(), b.count(), alphabetSize, 0);
+    return context.distance();
+}
+
+// static
+void IntervalDiffEngine::diff(const QList<Interval *> &intervalsA, const QList<Interval *> &intervalsB,
+                              IntervalDiffSink *sink, bool ignoreCase,
+                              const QString &attributeA, const QString &attributeB)
+{
+    IntervalLabelInterner interner(ignoreCase);
+    QVector<int> a = interner.intern(intervalsA, attributeA);
+    QVector<int> b = interner.intern(intervalsB, attributeB);
+    diffSequences(a, b, interner.alphabetSize(), sink);
+}
+
+// static
+dtl::Ses<Interval *>::sesElemVec IntervalDiffEngine::diff(
+        const QList<Interval *> &intervalsA, const QList<Interval *> &intervalsB,
+        bool ignoreCase, const QString &attributeA, const QString &attributeB)
+{
+    dtl::Ses<Interval *>::sesElemVec ses;
+    ses.reserve(std::max(intervalsA.count(), intervalsB.count()));
+    SesCollectorSink sink(intervalsA, intervalsB, ses);
+    diff(intervalsA, intervalsB, &sink, ignoreCase, attributeA, attributeB);
+    return ses;
+}
+
+// static
+QList<dtl::Ses<Interval *>::sesElemVec> IntervalDiffEngine::diffAll(const QList<Job> &jobs)
+{
+    if (jobs.count() == 1)
+        return QList<dtl::Ses<Interval *>::sesElemVec>() << diff(jobs.first().intervalsA, jobs.first().intervalsB,
+                                                                 jobs.first().ignoreCase,
+                                                                 jobs.first().attributeA, jobs.first().attributeB);
+    QFuture<dtl::Ses<Interval *>::sesElemVec> future = QtConcurrent::mapped(jobs, RunDiffStep());
+    future.waitForFinished();
+    return future.results();
+}
@@ -0,0 +1,77 @@
+#ifndef INTERVALDIFFENGINE_H
+#define INTERVALDIFFENGINE_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Diff/dtl/dtl.h"
+
+// Receives the shortest edit script, in order, as it is being computed. Indices are 1-based positions in the
+// compared sequences, following dtl conventions: indexB is 0 for deletions and indexA is 0 for additions.
+class IntervalDiffSink
+{
+public:
+    virtual ~IntervalDiffSink() {}
+    virtual void addElement(dtl::edit_t type, long long indexA, long long indexB) = 0;
+};
+
+// Maps labels to dense integer IDs, so that sequences are compared as integers.
+class IntervalLabelInterner
+{
+public:
+    IntervalLabelInterner(bool ignoreCase = false) : m_ignoreCase(ignoreCase) {}
+    int intern(const QString &label);
+    QVector<int> intern(const QList<Praaline::Core::Interval *> &intervals, const QString &attributeID = QString());
+    int alphabetSize() const { return m_ids.count(); }
+private:
+    bool m_ignoreCase;
+    QHash<QString, int> m_ids;
+};
+
+// Linear-space diff of interval sequences (a replacement for DiffIntervals::intervalDiff on long tiers).
+// Labels are interned to integer IDs. The edit script is computed with Myers' O(ND) algorithm in its
+// linear-space (middle snake) form; for small alphabets, when the sequences are very different, Hirschberg's
+// algorithm is used instead, with LCS rows computed bit-parallel (64 symbols per machine word). Both give a
+// shortest edit script, streamed to a sink in order without storing the whole script.
+class IntervalDiffEngine
+{
+public:
+    struct Job {
+        Job() : ignoreCase(false) {}
+        QList<Praaline::Core::Interval *> intervalsA;
+        QList<Praaline::Core::Interval *> intervalsB;
+        bool ignoreCase;
+        QString attributeA;
+        QString attributeB;
+    };
+
+    // Stream the edit script between two interval lists into sink
+    static void diff(const QList<Praaline::Core::Interval *> &intervalsA,
+                     const QList<Praaline::Core::Interval *> &intervalsB,
+                     IntervalDiffSink *sink, bool ignoreCase = false,
+                     const QString &attributeA = QString(), const QString &attributeB = QString());
+
+    // Same, collected in the SES format of dtl (as used by DiffSESforIntervalsTableModel)
+    static dtl::Ses<Praaline::Core::Interval *>::sesElemVec
+    diff(const QList<Praaline::Core::Interval *> &intervalsA,
+         const QList<Praaline::Core::Interval *> &intervalsB,
+         bool ignoreCase = false,
+         const QString &attributeA = QString(), const QString &attributeB = QString());
+
+    // Diff of interned sequences; alphabetSize bounds the IDs (0 <= id < alphabetSize)
+    static void diffSequences(const QVector<int> &a, const QVector<int> &b, int alphabetSize, IntervalDiffSink *sink);
+
+    // Edit distance (insertions + deletions), computed without building the edit script
+    static int editDistance(const QVector<int> &a, const QVector<int> &b, int alphabetSize);
+
+    // Run many independent diffs (e.g. one per level, speaker and annotation) on the global thread pool.
+    // Results are in the same order as the jobs.
+    static QList<dtl::Ses<Praaline::Core::Interval *>::sesElemVec> diffAll(const QList<Job> &jobs);
+
+    // Alphabets up to this size use bit-parallel LCS rows
+    static const int smallAlphabetLimit = 256;
+};
+
+#endif // INTERVALDIFFENGINE_H
@@ -13,6 +13,7 @@
 #include "PraalineCore/Annotation/IntervalTier.h"
 using namespace Praaline::Core;
 
+#include "StreamingVAD.h"
 #include "OpenSmileVAD.h"
 
 OpenSmileVAD::OpenSmileVAD(QObject *parent) : QObject(parent)
@@ -20,8 +21,56 @@ OpenSmileVAD::OpenSmileVAD(QObject *parent) : QObject(parent)
 
 }
 
+// Activations are given at the points where the detector switches between silence (negative score) and voice
+// (positive score), and at the end of the recording.
+static void voiceIntervalsToActivations(const StreamingVAD::Result &result,
+                                        QList<QPair<double, double> > &activations)
+{
+    activations.clear();
+    double position = 0.0;
+    for (int i = 0; i < result.voiceIntervals.count(); ++i) {
+        const QPair<double, double> &interval = result.voiceIntervals.at(i);
+        if (i == 0 && interval.first > 0.0) activations << QPair<double, double>(0.0, -1.0);
+        activations << QPair<double, double>(interval.first, 1.0);
+        activations << QPair<double, double>(interval.second, -1.0);
+        position = interval.second;
+    }
+    if (activations.isEmpty()) activations << QPair<double, double>(0.0, -1.0);
+    if (position < result.duration) activations << QPair<double, double>(result.duration, 1.0);
+}
+
 // static
 bool OpenSmileVAD::runVAD(const QString &filenameInputWave, QList<QPair<double, double> > &resultVADActivations)
+{
+    StreamingVAD::Result result = StreamingVAD::analyseFile(filenameInputWave);
+    if (!result.success) {
+        qDebug() << result.error;
+        return false;
+    }
+    voiceIntervalsToActivations(result, resultVADActivations);
+    return true;
+}
+
+// static
+QList<bool> OpenSmileVAD::runVAD(const QStringList &filenamesInputWave,
+                                 QList<QList<QPair<double, double> > > &resultVADActivations)
+{
+    QList<bool> ret;
+    resultVADActivations.clear();
+    foreach (StreamingVAD::Result result, StreamingVAD::analyseFiles(filenamesInputWave)) {
+        QList<QPair<double, double> > activations;
+        if (result.success)
+            voiceIntervalsToActivations(result, activations);
+        else
+            qDebug() << result.error;
+        resultVADActivations << activations;
+        ret << result.success;
+    }
+    return ret;
+}
+
+// static
+bool OpenSmileVAD::runOpenSmileVAD(const QString &filenameInputWave, QList<QPair<double, double> > &resultVADActivations)
 {
     // Check if wave file exists
     if (!QFile::exists(filenameInputWave)) return false;
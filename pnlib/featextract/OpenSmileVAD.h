@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QList>
 #include <QPair>
 #include "PraalineCore/Base/RealTime.h"
@@ -21,9 +22,18 @@ class OpenSmileVAD : public QObject
 public:
     explicit OpenSmileVAD(QObject *parent = nullptr);
 
+    // Voice activity detection with the built-in streaming detector (see StreamingVAD)
     static bool
     runVAD(const QString &filenameInputWave, QList<QPair<double, double> > &resultVADActivations);
 
+    // Runs the built-in detector over several recordings in parallel
+    static QList<bool>
+    runVAD(const QStringList &filenamesInputWave, QList<QList<QPair<double, double> > > &resultVADActivations);
+
+    // Voice activity detection by calling openSMILE (SMILExtract, with vad_opensource.conf)
+    static bool
+    runOpenSmileVAD(const QString &filenameInputWave, QList<QPair<double, double> > &resultVADActivations);
+
     static Praaline::Core::IntervalTier *
     splitToUtterances(QList<QPair<double, double> > &VADActivations,
                       RealTime minimumDurationSilent, RealTime minimumDurationVoice,
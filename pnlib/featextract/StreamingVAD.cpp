@@ -0,0 +1,379 @@
+#include <QDebug>
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QFile>
+#include <QByteArray>
+#include <QtEndian>
+#include <QtConcurrent>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "StreamingVAD.h"
+
+struct StreamingVADData {
+    StreamingVAD::Configuration config;
+    int sampleRate;
+    int frameLength;
+    int frameStep;
+    int fftSize;
+    int binFrom;
+    int binTo;
+    int onsetFrames;
+    int hangoverFrames;
+    std::vector<float> window;
+    // Samples not yet consumed by a whole frame
+    std::vector<float> pending;
+    std::vector<double> re;
+    std::vector<double> im;
+    qint64 frameIndex;
+    qint64 samplesProcessed;
+    double noiseLevel;
+    bool noiseInitialised;
+    // Onset and hangover state
+    bool inSpeech;
+    int speechRun;
+    int silenceRun;
+    qint64 runStartFrame;
+    qint64 speechStartFrame;
+    qint64 lastSpeechFrame;
+    QList<QPair<double, double> > intervals;
+};
+
+StreamingVAD::StreamingVAD(int sampleRate, const Configuration &config) :
+    d(new StreamingVADData)
+{
+    d->config = config;
+    d->sampleRate = qMax(1, sampleRate);
+    d->frameLength = qMax(2, qRound(config.frameLength * d->sampleRate));
+    d->frameStep = qMax(1, qRound(config.frameStep * d->sampleRate));
+    d->fftSize = 2;
+    while (d->fftSize < d->frameLength) d->fftSize *= 2;
+    // Spectral flatness over the speech band
+    d->binFrom = qMax(1, static_cast<int>(250.0 * d->fftSize / d->sampleRate));
+    d->binTo = qMin(d->fftSize / 2, static_cast<int>(4000.0 * d->fftSize / d->sampleRate));
+    if (d->binTo <= d->binFrom) d->binTo = d->fftSize / 2;
+    d->onsetFrames = qMax(1, qRound(config.onsetDuration / config.frameStep));
+    d->hangoverFrames = qMax(0, qRound(config.hangoverDuration / config.frameStep));
+    d->window.resize(d->frameLength);
+    for (int i = 0; i < d->frameLength; ++i)
+        d->window[i] = static_cast<float>(0.54 - 0.46 * cos(2.0 * M_PI * i / (d->frameLength - 1)));
+    d->re.resize(d->fftSize);
+    d->im.resize(d->fftSize);
+    d->frameIndex = 0;
+    d->samplesProcessed = 0;
+    d->noiseLevel = 0.0;
+    d->noiseInitialised = false;
+    d->inSpeech = false;
+    d->speechRun = 0;
+    d->silenceRun = 0;
+    d->runStartFrame = 0;
+    d->speechStartFrame = 0;
+    d->lastSpeechFrame = 0;
+}
+
+StreamingVAD::~StreamingVAD()
+{
+    delete d;
+}
+
+double StreamingVAD::duration() const
+{
+    return static_cast<double>(d->samplesProcessed) / d->sampleRate;
+}
+
+QList<QPair<double, double> > StreamingVAD::voiceIntervals() const
+{
+    return d->intervals;
+}
+
+void StreamingVAD::process(const float *samples, int count)
+{
+    if (count <= 0) return;
+    d->pending.insert(d->pending.end(), samples, samples + count);
+    d->samplesProcessed += count;
+    size_t position = 0;
+    while (position + d->frameLength <= d->pending.size()) {
+        analyseFrame(d->pending.data() + position);
+        position += d->frameStep;
+    }
+    d->pending.erase(d->pending.begin(), d->pending.begin() + qMin(position, d->pending.size()));
+}
+
+void StreamingVAD::finish()
+{
+    if (d->inSpeech) closeInterval();
+    d->inSpeech = false;
+    d->speechRun = 0;
+}
+
+// In-place radix-2 FFT
+static void fft(std::vector<double> &re, std::vector<double> &im)
+{
+    int n = static_cast<int>(re.size());
+    for (int i = 1, j = 0; i < n; ++i) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        double angle = -2.0 * M_PI / length;
+        double wRe = cos(angle), wIm = sin(angle);
+        for (int i = 0; i < n; i += length) {
+            double uRe = 1.0, uIm = 0.0;
+            for (int k = 0; k < length / 2; ++k) {
+                int a = i + k, b = i + k + length / 2;
+                double tRe = re[b] * uRe - im[b] * uIm;
+                double tIm = re[b] * uIm + im[b] * uRe;
+                re[b] = re[a] - tRe;
+                im[b] = im[a] - tIm;
+                re[a] += tRe;
+                im[a] += tIm;
+                double nextRe = uRe * wRe - uIm * wIm;
+                uIm = uRe * wIm + uIm * wRe;
+                uRe = nextRe;
+            }
+        }
+    }
+}
+
+void StreamingVAD::analyseFrame(const float *frame)
+{
+    // Energy and zero-crossing rate
+    double sum = 0.0;
+    int crossings = 0;
+    for (int i = 0; i < d->frameLength; ++i) {
+        double x = frame[i] * d->window[i];
+        sum += x * x;
+        if (i > 0 && ((frame[i] >= 0.0f) != (frame[i - 1] >= 0.0f))) crossings++;
+        d->re[i] = x;
+        d->im[i] = 0.0;
+    }
+    for (int i = d->frameLength; i < d->fftSize; ++i) {
+        d->re[i] = 0.0;
+        d->im[i] = 0.0;
+    }
+    double energy = 10.0 * log10(sum / d->frameLength + 1e-10);
+    double zeroCrossingRate = static_cast<double>(crossings) / d->frameLength;
+    // Spectral flatness: geometric over arithmetic mean of the power spectrum
+    fft(d->re, d->im);
+    double logSum = 0.0, powerSum = 0.0;
+    for (int k = d->binFrom; k < d->binTo; ++k) {
+        double power = d->re[k] * d->re[k] + d->im[k] * d->im[k] + 1e-12;
+        logSum += log(power);
+        powerSum += power;
+    }
+    int bins = d->binTo - d->binFrom;
+    double flatness = exp(logSum / bins) / (powerSum / bins);
+
+    if (!d->noiseInitialised) {
+        d->noiseLevel = energy;
+        d->noiseInitialised = true;
+    }
+    bool speech = (energy > d->noiseLevel + d->config.energyThreshold) && (energy > d->config.minimumEnergy) &&
+            (flatness < d->config.flatnessThreshold || zeroCrossingRate < d->config.zeroCrossingThreshold);
+    // The noise floor follows the energy down at once; it rises slowly outside speech, and very slowly within it,
+    // so that it recovers from a quiet start
+    if (energy < d->noiseLevel)
+        d->noiseLevel = energy;
+    else if (!speech)
+        d->noiseLevel = 0.95 * d->noiseLevel + 0.05 * energy;
+    else
+        d->noiseLevel += 0.005;
+
+    qint64 i = d->frameIndex++;
+    if (!d->inSpeech) {
+        if (!speech) {
+            d->speechRun = 0;
+            return;
+        }
+        if (d->speechRun == 0) d->runStartFrame = i;
+        if (++d->speechRun >= d->onsetFrames) {
+            d->inSpeech = true;
+            d->speechStartFrame = d->runStartFrame;
+            d->lastSpeechFrame = i;
+            d->silenceRun = 0;
+        }
+    } else if (speech) {
+        d->lastSpeechFrame = i;
+        d->silenceRun = 0;
+    } else if (++d->silenceRun > d->hangoverFrames) {
+        closeInterval();
+        d->inSpeech = false;
+        d->speechRun = 0;
+    }
+}
+
+void StreamingVAD::closeInterval()
+{
+    double start = static_cast<double>(d->speechStartFrame * d->frameStep) / d->sampleRate;
+    double end = static_cast<double>(d->lastSpeechFrame * d->frameStep + d->frameLength) / d->sampleRate;
+    end = qMin(end, duration());
+    if (!d->intervals.isEmpty() && d->intervals.last().second >= start)
+        d->intervals.last().second = end;
+    else
+        d->intervals << QPair<double, double>(start, end);
+}
+
+// ====================================================================================================================
+// WAV files
+// ====================================================================================================================
+
+namespace {
+
+// Reads the samples of a RIFF WAV file (integer PCM or floating point) block by block, mixed down to mono
+class WaveStream {
+public:
+    WaveStream(const QString &filename) :
+        m_file(filename), m_channels(0), m_sampleRate(0), m_bits(0), m_floatingPoint(false), m_remaining(0)
+    {}
+
+    int sampleRate() const { return m_sampleRate; }
+
+    bool open(QString &error) {
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            error = QString("Cannot open %1").arg(m_file.fileName());
+            return false;
+        }
+        QByteArray header = m_file.read(12);
+        if (header.size() < 12 || !header.startsWith("RIFF") || header.mid(8, 4) != "WAVE") {
+            error = QString("%1 is not a WAV file").arg(m_file.fileName());
+            return false;
+        }
+        bool haveFormat = false;
+        while (!m_file.atEnd()) {
+            QByteArray chunk = m_file.read(8);
+            if (chunk.size() < 8) break;
+            QByteArray id = chunk.left(4);
+            quint32 size = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(chunk.constData() + 4));
+            if (id == "fmt ") {
+                QByteArray format = m_file.read(size);
+                if (format.size() < 16) break;
+                const uchar *f = reinterpret_cast<const uchar *>(format.constData());
+                quint16 tag = qFromLittleEndian<quint16>(f);
+                m_channels = qFromLittleEndian<quint16>(f + 2);
+                m_sampleRate = static_cast<int>(qFromLittleEndian<quint32>(f + 4));
+                m_bits = qFromLittleEndian<quint16>(f + 14);
+                // WAVE_FORMAT_EXTENSIBLE: the format tag is at the start of the sub-format GUID
+                if (tag == 0xFFFE && format.size() >= 26) tag = qFromLittleEndian<quint16>(f + 24);
+                m_floatingPoint = (tag == 3);
+                if ((tag != 1 && tag != 3) || m_channels == 0 || m_sampleRate <= 0 ||
+                        (m_floatingPoint && m_bits != 32 && m_bits != 64) ||
+                        (!m_floatingPoint && (m_bits < 8 || m_bits > 32 || m_bits % 8 != 0))) {
+                    error = QString("%1: unsupported WAV format").arg(m_file.fileName());
+                    return false;
+                }
+                if (size % 2) m_file.read(1);
+                haveFormat = true;
+            }
+            else if (id == "data") {
+                if (!haveFormat) break;
+                // The size may be unset in files written as streams
+                m_remaining = qMin<qint64>(size, m_file.size() - m_file.pos());
+                return true;
+            }
+            else {
+                m_file.seek(m_file.pos() + size + (size % 2));
+            }
+        }
+        error = QString("%1: no audio data").arg(m_file.fileName());
+        return false;
+    }
+
+    // Returns the number of frames read
+    int read(float *mono, int frames) {
+        int bytesPerSample = m_bits / 8;
+        int bytesPerFrame = bytesPerSample * m_channels;
+        qint64 bytes = qMin<qint64>(static_cast<qint64>(frames) * bytesPerFrame, m_remaining);
+        bytes -= bytes % bytesPerFrame;
+        if (bytes <= 0) return 0;
+        m_buffer.resize(static_cast<int>(bytes));
+        qint64 read = m_file.read(m_buffer.data(), bytes);
+        if (read <= 0) return 0;
+        m_remaining -= read;
+        int count = static_cast<int>(read / bytesPerFrame);
+        const uchar *p = reinterpret_cast<const uchar *>(m_buffer.constData());
+        for (int i = 0; i < count; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < m_channels; ++c, p += bytesPerSample) sum += sample(p);
+            mono[i] = sum / m_channels;
+        }
+        return count;
+    }
+
+private:
+    float sample(const uchar *p) const {
+        if (m_floatingPoint) {
+            if (m_bits == 32) {
+                quint32 bits = qFromLittleEndian<quint32>(p);
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+            quint64 bits = qFromLittleEndian<quint64>(p);
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return static_cast<float>(value);
+        }
+        switch (m_bits) {
+        case 8:  return (static_cast<int>(p[0]) - 128) / 128.0f;
+        case 16: return qFromLittleEndian<qint16>(p) / 32768.0f;
+        case 24: return static_cast<qint32>((p[0] << 8) | (p[1] << 16) | (static_cast<quint32>(p[2]) << 24)) / 2147483648.0f;
+        default: return qFromLittleEndian<qint32>(p) / 2147483648.0f;
+        }
+    }
+
+    QFile m_file;
+    int m_channels;
+    int m_sampleRate;
+    int m_bits;
+    bool m_floatingPoint;
+    qint64 m_remaining;
+    QByteArray m_buffer;
+};
+
+} // namespace
+
+// static
+StreamingVAD::Result StreamingVAD::analyseFile(const QString &filename, const Configuration &config)
+{
+    Result result;
+    WaveStream wave(filename);
+    if (!wave.open(result.error)) return result;
+    StreamingVAD vad(wave.sampleRate(), config);
+    std::vector<float> block(8192);
+    int count = 0;
+    while ((count = wave.read(block.data(), static_cast<int>(block.size()))) > 0) {
+        vad.process(block.data(), count);
+    }
+    vad.finish();
+    result.success = true;
+    result.duration = vad.duration();
+    result.voiceIntervals = vad.voiceIntervals();
+    return result;
+}
+
+struct AnalyseFileStep
+{
+    StreamingVAD::Configuration config;
+
+    AnalyseFileStep(const StreamingVAD::Configuration &config) : config(config) {}
+    typedef StreamingVAD::Result result_type;
+
+    StreamingVAD::Result operator() (const QString &filename)
+    {
+        return StreamingVAD::analyseFile(filename, config);
+    }
+};
+
+// static
+QList<StreamingVAD::Result> StreamingVAD::analyseFiles(const QStringList &filenames, const Configuration &config)
+{
+    return QtConcurrent::blockingMapped<QList<Result> >(filenames, AnalyseFileStep(config));
+}
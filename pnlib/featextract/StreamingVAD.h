@@ -0,0 +1,73 @@
+#ifndef STREAMINGVAD_H
+#define STREAMINGVAD_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QPair>
+
+struct StreamingVADData;
+
+// Voice activity detector working block by block, in constant memory. Each analysis frame is classified from its
+// energy relative to an adaptive noise floor, its spectral flatness and its zero-crossing rate; runs of speech frames
+// are turned into voice intervals with an onset delay and a hangover, so that short gaps inside speech are bridged.
+class StreamingVAD
+{
+public:
+    class Configuration {
+    public:
+        Configuration() :
+            frameLength(0.025), frameStep(0.010), energyThreshold(9.0), minimumEnergy(-60.0),
+            flatnessThreshold(0.45), zeroCrossingThreshold(0.30), onsetDuration(0.030), hangoverDuration(0.250)
+        {}
+
+        // Analysis frames, in seconds
+        double frameLength;
+        double frameStep;
+        // A speech frame is this many dB above the noise floor, and above the minimum energy (dB full scale)
+        double energyThreshold;
+        double minimumEnergy;
+        // ...and is either not flat (spectral flatness below the threshold) or has few zero-crossings per sample
+        double flatnessThreshold;
+        double zeroCrossingThreshold;
+        // Speech starts after this much continuous speech, and ends after this much continuous non-speech (seconds)
+        double onsetDuration;
+        double hangoverDuration;
+    };
+
+    class Result {
+    public:
+        Result() : success(false), duration(0.0) {}
+
+        bool success;
+        QString error;
+        double duration;
+        // Voice intervals (start, end), in seconds
+        QList<QPair<double, double> > voiceIntervals;
+    };
+
+    StreamingVAD(int sampleRate, const Configuration &config = Configuration());
+    ~StreamingVAD();
+
+    // Feeds mono samples, in the range [-1, 1]
+    void process(const float *samples, int count);
+    // Closes the last voice interval, at the end of the stream
+    void finish();
+
+    double duration() const;
+    // Voice intervals found so far
+    QList<QPair<double, double> > voiceIntervals() const;
+
+    // Runs the detector over a WAV file, mixed down to mono
+    static Result analyseFile(const QString &filename, const Configuration &config = Configuration());
+    // Runs the detector over several WAV files in parallel; results are in the same order
+    static QList<Result> analyseFiles(const QStringList &filenames, const Configuration &config = Configuration());
+
+private:
+    StreamingVADData *d;
+
+    void analyseFrame(const float *frame);
+    void closeInterval();
+};
+
+#endif // STREAMINGVAD_H
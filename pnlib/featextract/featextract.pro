@@ -14,8 +14,12 @@ DEPENDPATH += . .. ../.. ../../praaline-core
 
 TARGET = praaline-featextract
 
+QT += concurrent
+
 HEADERS += \
-    OpenSmileVAD.h
+    OpenSmileVAD.h \
+    StreamingVAD.h
 
 SOURCES += \
-    OpenSmileVAD.cpp
+    OpenSmileVAD.cpp \
+    StreamingVAD.cpp
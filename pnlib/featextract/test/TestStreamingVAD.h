@@ -0,0 +1,169 @@
+#ifndef TEST_STREAMINGVAD_H
+#define TEST_STREAMINGVAD_H
+
+#include "StreamingVAD.h"
+#include "OpenSmileVAD.h"
+
+#include <QObject>
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QtEndian>
+
+#include <cmath>
+#include <vector>
+
+// The regression test against openSMILE runs over the WAV files in the directory given by PRAALINE_VAD_TEST_DIR,
+// and is skipped when it is not set or SMILExtract is not installed.
+class TestStreamingVAD : public QObject
+{
+    Q_OBJECT
+
+    static const int sampleRate = 16000;
+
+    // Three seconds: background noise, a harmonic voice-like signal between 1 s and 2 s, background noise
+    static std::vector<float> syntheticSignal() {
+        std::vector<float> signal(3 * sampleRate);
+        quint32 seed = 12345;
+        for (size_t i = 0; i < signal.size(); ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            double noise = 0.003 * ((seed >> 8) / 8388608.0 - 1.0);
+            double voice = 0.0;
+            if (i >= size_t(sampleRate) && i < size_t(2 * sampleRate)) {
+                double t = double(i) / sampleRate;
+                for (int h = 1; h <= 10; ++h) voice += 0.3 / h * sin(2.0 * M_PI * 140.0 * h * t);
+            }
+            signal[i] = float(noise + voice);
+        }
+        return signal;
+    }
+
+    static QList<QPair<double, double> > processInBlocks(const std::vector<float> &signal, int blockSize) {
+        StreamingVAD vad(sampleRate);
+        for (size_t i = 0; i < signal.size(); i += blockSize) {
+            vad.process(signal.data() + i, int(qMin(size_t(blockSize), signal.size() - i)));
+        }
+        vad.finish();
+        return vad.voiceIntervals();
+    }
+
+    static bool writeWave(const QString &filename, const std::vector<float> &signal, int channels) {
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly)) return false;
+        QByteArray data;
+        for (size_t i = 0; i < signal.size(); ++i) {
+            qint16 sample = qint16(qBound(-32768.0, floor(signal[i] * 32768.0 + 0.5), 32767.0));
+            uchar bytes[2];
+            qToLittleEndian<qint16>(sample, bytes);
+            for (int c = 0; c < channels; ++c) data.append(reinterpret_cast<const char *>(bytes), 2);
+        }
+        QByteArray header("RIFF");
+        uchar field[4];
+        qToLittleEndian<quint32>(quint32(36 + data.size()), field); header.append(reinterpret_cast<char *>(field), 4);
+        header.append("WAVEfmt ");
+        qToLittleEndian<quint32>(16, field); header.append(reinterpret_cast<char *>(field), 4);
+        qToLittleEndian<quint16>(1, field); header.append(reinterpret_cast<char *>(field), 2);
+        qToLittleEndian<quint16>(quint16(channels), field); header.append(reinterpret_cast<char *>(field), 2);
+        qToLittleEndian<quint32>(sampleRate, field); header.append(reinterpret_cast<char *>(field), 4);
+        qToLittleEndian<quint32>(quint32(sampleRate * channels * 2), field); header.append(reinterpret_cast<char *>(field), 4);
+        qToLittleEndian<quint16>(quint16(channels * 2), field); header.append(reinterpret_cast<char *>(field), 2);
+        qToLittleEndian<quint16>(16, field); header.append(reinterpret_cast<char *>(field), 2);
+        header.append("data");
+        qToLittleEndian<quint32>(quint32(data.size()), field); header.append(reinterpret_cast<char *>(field), 4);
+        return (file.write(header) == header.size()) && (file.write(data) == data.size());
+    }
+
+    // Voice decision at time t, from activation points (time, score) in increasing time order
+    static bool voiceAt(const QList<QPair<double, double> > &activations, double t, int &index) {
+        while (index + 1 < activations.count() && activations.at(index + 1).first <= t) ++index;
+        return (index < activations.count() && activations.at(index).first <= t && activations.at(index).second > 0.0);
+    }
+
+private slots:
+
+    void syntheticVoiceBurst()
+    {
+        QList<QPair<double, double> > intervals = processInBlocks(syntheticSignal(), 1024);
+        QCOMPARE(intervals.count(), 1);
+        QVERIFY(intervals.first().first > 0.95 && intervals.first().first < 1.05);
+        QVERIFY(intervals.first().second > 1.95 && intervals.first().second < 2.0 + 0.25 + 0.05);
+    }
+
+    void silence()
+    {
+        std::vector<float> signal(2 * sampleRate, 0.0f);
+        QVERIFY(processInBlocks(signal, 4096).isEmpty());
+    }
+
+    void blockSizeInvariance()
+    {
+        std::vector<float> signal = syntheticSignal();
+        QList<QPair<double, double> > reference = processInBlocks(signal, int(signal.size()));
+        QCOMPARE(processInBlocks(signal, 1), reference);
+        QCOMPARE(processInBlocks(signal, 160), reference);
+        QCOMPARE(processInBlocks(signal, 7919), reference);
+    }
+
+    void waveFile()
+    {
+        std::vector<float> signal = syntheticSignal();
+        QTemporaryFile file(QDir::tempPath() + "/vadXXXXXX.wav");
+        QVERIFY(file.open());
+        file.close();
+        QVERIFY(writeWave(file.fileName(), signal, 2));
+        StreamingVAD::Result result = StreamingVAD::analyseFile(file.fileName());
+        QVERIFY2(result.success, result.error.toLocal8Bit().constData());
+        QVERIFY(qAbs(result.duration - 3.0) < 1e-6);
+        QList<QPair<double, double> > reference = processInBlocks(signal, 4096);
+        QCOMPARE(result.voiceIntervals.count(), reference.count());
+        for (int i = 0; i < reference.count(); ++i) {
+            QVERIFY(qAbs(result.voiceIntervals.at(i).first - reference.at(i).first) < 0.02);
+            QVERIFY(qAbs(result.voiceIntervals.at(i).second - reference.at(i).second) < 0.02);
+        }
+        // Several recordings at once give the same results
+        QList<StreamingVAD::Result> results = StreamingVAD::analyseFiles(
+                    QStringList() << file.fileName() << file.fileName() << file.fileName());
+        QCOMPARE(results.count(), 3);
+        foreach (StreamingVAD::Result r, results) QCOMPARE(r.voiceIntervals, result.voiceIntervals);
+    }
+
+    void notAWaveFile()
+    {
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        file.write("not audio");
+        file.close();
+        StreamingVAD::Result result = StreamingVAD::analyseFile(file.fileName());
+        QVERIFY(!result.success);
+        QVERIFY(!result.error.isEmpty());
+    }
+
+    void regressionAgainstOpenSmile()
+    {
+        QString directory = qgetenv("PRAALINE_VAD_TEST_DIR");
+        if (directory.isEmpty()) QSKIP("PRAALINE_VAD_TEST_DIR not set");
+        if (!QFileInfo(QDir::homePath() + "/Praaline/tools/opensmile/SMILExtract").exists())
+            QSKIP("SMILExtract not installed");
+        QFileInfoList files = QDir(directory).entryInfoList(QStringList() << "*.wav", QDir::Files);
+        if (files.isEmpty()) QSKIP("No WAV files to compare");
+        foreach (QFileInfo info, files) {
+            QList<QPair<double, double> > native, openSmile;
+            QVERIFY(OpenSmileVAD::runVAD(info.absoluteFilePath(), native));
+            QVERIFY(OpenSmileVAD::runOpenSmileVAD(info.absoluteFilePath(), openSmile));
+            if (openSmile.isEmpty()) continue;
+            // Frame-level agreement, every 10 ms
+            int indexNative = 0, indexOpenSmile = 0, frames = 0, agreeing = 0;
+            for (double t = 0.0; t < openSmile.last().first; t += 0.010) {
+                if (voiceAt(native, t, indexNative) == voiceAt(openSmile, t, indexOpenSmile)) agreeing++;
+                frames++;
+            }
+            double agreement = (frames > 0) ? double(agreeing) / frames : 1.0;
+            QVERIFY2(agreement >= 0.85, QString("%1: agreement %2").arg(info.fileName()).arg(agreement)
+                     .toLocal8Bit().constData());
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "TestStreamingVAD.h"
+
+#include <QtTest>
+
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+    int good = 0, bad = 0;
+
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("Praaline");
+    app.setApplicationName("test-featextract");
+
+    {
+        TestStreamingVAD t;
+        if (QTest::qExec(&t, argc, argv) == 0) ++good;
+        else ++bad;
+    }
+
+    if (bad > 0) {
+        std::cerr << "\n********* " << bad << " test suite(s) failed!\n" << std::endl;
+        return 1;
+    } else {
+        std::cerr << "All tests passed" << std::endl;
+        return 0;
+    }
+}
@@ -0,0 +1,41 @@
+TEMPLATE = app
+
+CONFIG( debug, debug|release ) {
+    COMPONENTSPATH = build/debug
+} else {
+    COMPONENTSPATH = build/release
+}
+
+DEFINES += USE_NAMESPACE_PRAALINE_CORE
+INCLUDEPATH += .. ../../.. ../../../praaline-core/include
+DEPENDPATH += .. ../../..
+
+LIBS += -L../$${COMPONENTSPATH} -lpraaline-featextract \
+        -L../../../praaline-core/$${COMPONENTSPATH} -lpraaline-core$${PRAALINE_LIB_POSTFIX}
+
+CONFIG += qt thread warn_on stl rtti exceptions console c++11
+QT += concurrent testlib
+QT -= gui
+
+TARGET = featextract-test
+
+OBJECTS_DIR = o
+MOC_DIR = o
+
+HEADERS += TestStreamingVAD.h
+SOURCES += main.cpp
+
+!win* {
+PRE_TARGETDEPS += ../$${COMPONENTSPATH}/libpraaline-featextract.a
+}
+
+!win32 {
+    !macx* {
+        QMAKE_POST_LINK=./$${TARGET}
+    }
+    macx* {
+        QMAKE_POST_LINK=./$${TARGET}.app/Contents/MacOS/$${TARGET}
+    }
+}
+
+win32:QMAKE_POST_LINK=./release/$${TARGET}.exe
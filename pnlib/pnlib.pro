@@ -2,6 +2,7 @@ TEMPLATE = subdirs
 CONFIG += ordered
 
 SUBDIRS +=  crf \
-            featextract
+            featextract \
+            diff
 
 
@@ -40,6 +40,30 @@ public:
     QString phonetisationSeparatorForPhonemes() const;
     void setPhonetisationSeparatorForPhonemes(const QString &sep);
 
+    // Incremental alignment: a hash of each aligned utterance (time span, tokens and their phonetisations) is stored
+    // in an attribute of the utterance, and an utterance is aligned again only if its hash has changed or it has no
+    // phones. To keep the hashes between sessions, the attribute must be part of the utterance level.
+    bool incrementalAlignment() const;
+    void setIncrementalAlignment(bool incremental);
+
+    QString utteranceHashAttributeID() const;
+    void setUtteranceHashAttributeID(const QString &attributeID);
+
+    // The hashes are also kept in a side table file, keyed by annotation, speaker and utterance time span, so that
+    // they survive when the utterance tier is not saved or its level has no hash attribute. Set the annotation and
+    // speaker before aligning the tiers of each speaker. The table is saved at the end of alignAllUtterances(), by
+    // saveUtteranceHashes() and when the aligner is destroyed.
+    QString utteranceHashesFilename() const;
+    void setUtteranceHashesFilename(const QString &filename);
+    void setAnnotationContext(const QString &annotationID, const QString &speakerID);
+    bool saveUtteranceHashes();
+
+    QString utteranceHash(Praaline::Core::IntervalTier *tierUtterances, int indexUtterance,
+                          Praaline::Core::IntervalTier *tierTokens, bool insertLeadingAndTrailingPauses) const;
+    bool isUtteranceAlignmentCurrent(Praaline::Core::IntervalTier *tierUtterances, int indexUtterance,
+                                     Praaline::Core::IntervalTier *tierTokens, Praaline::Core::IntervalTier *tierPhones,
+                                     bool insertLeadingAndTrailingPauses) const;
+
     virtual bool alignTokens(const QString &waveFilepath, RealTime timeFrom, RealTime timeTo,
                              Praaline::Core::IntervalTier *tierTokens, int &indexFrom, int &indexTo,
                              bool insertLeadingAndTrailingPauses,
@@ -65,6 +89,8 @@ protected:
 
 private:
     ForcedAlignerData *d;
+
+    QString utteranceHashKey(Praaline::Core::Interval *utterance) const;
 };
 
 } // namespace ASR
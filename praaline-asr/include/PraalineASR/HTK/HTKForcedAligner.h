@@ -24,6 +24,9 @@ public:
                      bool insertLeadingAndTrailingPauses,
                      QList<Praaline::Core::Interval *> &outPhonesList, QString &outAlignerOutput) override;
 
+    // Number of HVite processes started by this aligner
+    int countProcessesLaunched() const;
+
 private:
     HTKForcedAlignerData *d;
 
@@ -28,6 +28,13 @@ public:
     static void addPhonetisationToTokens(Praaline::Core::IntervalTier *tier_tokens, const QString &attributeIDOrthographic,
                                          const QString &attributeIDPhonetisation);
 
+    // Phonetisations are cached across runs, so that only new forms and utterances are sent to the external
+    // phonetiser. An empty filename keeps the cache in memory only. New phonetisations are written to the cache
+    // file by saveCache(), which callers should call once at the end of a run; any left are saved at exit.
+    static void setCacheFilename(const QString &filename);
+    static void saveCache();
+    static void clearCache();
+
 signals:
 
 public slots:
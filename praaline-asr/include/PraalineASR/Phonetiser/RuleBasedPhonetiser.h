@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QString>
+#include <QHash>
+#include <QMap>
 
 #include "PraalineASR/PraalineASR_Global.h"
 #include "PraalineASR/Phonetiser.h"
@@ -22,8 +24,16 @@ public:
     QString phonetiseWord(const QString &word) override;
     QList<Core::Interval *> phonetiseUtterance(Core::Interval *utterance) override;
 
+    // Rules are compiled when the file is read: literal rules are applied as plain string replacements, and
+    // regular expressions are compiled (and JIT-optimised) once, instead of on every call.
     bool readRuleFile(const QString &filename);
+    int rulesCount() const;
+
+    // Apply all rules, in order. Results for single words are memoised. Thread-safe once the rules are loaded.
     QString phonetise(const QString &input);
+    void phonetiseTokenList(QHash<QString, QString> &tokens);
+    void phonetiseTokenList(QMap<QString, QString> &tokens);
+    void clearCache();
 
 signals:
 
@@ -43,7 +43,22 @@ public:
 
     QStringList getNormalisedUtterances(Praaline::Core::CorpusAnnotation *annotation);
 
+    // N-gram language model, with interpolated modified Kneser-Ney smoothing. Utterances are counted as they are
+    // added (in parallel, into hashed count tables), so the text does not need to be kept or exported. Each word
+    // of an n-gram is packed into 64/order bits of its key: e.g. up to 2M words for trigrams, 65K for 4-grams.
+    // Orders above 32 are clamped to 32.
+    int order() const;
+    void setOrder(int order);
+    void clearCounts();
+    bool addUtterances(const QStringList &normalisedUtterances);
+    bool addAnnotation(Praaline::Core::CorpusAnnotation *annotation);
+    int vocabularySize() const;
+    bool writeARPA(const QString &filename);
+    // Pocketsphinx binary (trie) format, converted from ARPA through sphinxbase
+    bool writeBinary(const QString &filename);
+
 signals:
+    void printMessage(QString message);
 
 public slots:
 
@@ -18,6 +18,7 @@ CONFIG(debug, debug|release) {
 CONFIG += qt thread warn_on stl rtti exceptions c++11
 
 QT -= gui
+QT += concurrent
 
 DEFINES += LIBRARY_PRAALINE_ASR
 DEFINES += USE_NAMESPACE_PRAALINE_ASR
@@ -5,6 +5,11 @@
 #include <QStringList>
 #include <QPointer>
 #include <QSharedPointer>
+#include <QCryptographicHash>
+#include <QHash>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
 
 #include "PraalineCore/Annotation/IntervalTier.h"
 using namespace Praaline::Core;
@@ -17,7 +22,8 @@ namespace ASR {
 
 struct ForcedAlignerData {
     ForcedAlignerData() :
-        usePronunciationVariants(true), returnDummyAlignmentOnFailure(true)
+        usePronunciationVariants(true), returnDummyAlignmentOnFailure(true), incrementalAlignment(true),
+        countAligned(0), countUnchanged(0), utteranceHashesChanged(false)
     {}
 
     QStringList phonemeset;
@@ -27,6 +33,17 @@ struct ForcedAlignerData {
     QString phonetisationSeparatorForPhonemes;
     bool usePronunciationVariants;
     bool returnDummyAlignmentOnFailure;
+    bool incrementalAlignment;
+    QString utteranceHashAttributeID;
+    // Side table of utterance hashes
+    QString utteranceHashesFilename;
+    QString contextAnnotationID;
+    QString contextSpeakerID;
+    QHash<QString, QString> utteranceHashes;
+    bool utteranceHashesChanged;
+    // Counts for the last call to alignAllUtterances
+    int countAligned;
+    int countUnchanged;
 };
 
 ForcedAligner::ForcedAligner(QObject *parent) :
@@ -38,6 +55,7 @@ ForcedAligner::ForcedAligner(QObject *parent) :
     d->phonetisationSeparatorForPhonemes = " ";
     d->usePronunciationVariants = true;
     d->returnDummyAlignmentOnFailure = true;
+    d->utteranceHashAttributeID = "align_hash";
     // Phoneme set. The order is important. Start with the longest phonemes.
     QStringList phonemeset;
     phonemeset << "9~" << "a~" << "e~" << "o~"
@@ -49,6 +67,7 @@ ForcedAligner::ForcedAligner(QObject *parent) :
 
 ForcedAligner::~ForcedAligner()
 {
+    saveUtteranceHashes();
     delete d;
 }
 
@@ -107,6 +126,126 @@ void ForcedAligner::setPhonetisationSeparatorForPhonemes(const QString &sep)
     d->phonetisationSeparatorForPhonemes = sep;
 }
 
+bool ForcedAligner::incrementalAlignment() const
+{
+    return d->incrementalAlignment;
+}
+
+void ForcedAligner::setIncrementalAlignment(bool incremental)
+{
+    d->incrementalAlignment = incremental;
+}
+
+QString ForcedAligner::utteranceHashAttributeID() const
+{
+    return d->utteranceHashAttributeID;
+}
+
+void ForcedAligner::setUtteranceHashAttributeID(const QString &attributeID)
+{
+    d->utteranceHashAttributeID = attributeID;
+}
+
+QString ForcedAligner::utteranceHashesFilename() const
+{
+    return d->utteranceHashesFilename;
+}
+
+void ForcedAligner::setUtteranceHashesFilename(const QString &filename)
+{
+    if (d->utteranceHashesFilename == filename) return;
+    saveUtteranceHashes();
+    d->utteranceHashesFilename = filename;
+    d->utteranceHashes.clear();
+    QFile file(filename);
+    if (filename.isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    // One line per utterance: annotation ID, speaker ID, tMin, tMax and hash, separated by tabs
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    while (!stream.atEnd()) {
+        QString line = stream.readLine();
+        int tab = line.lastIndexOf("\t");
+        if (tab <= 0) continue;
+        d->utteranceHashes.insert(line.left(tab), line.mid(tab + 1));
+    }
+}
+
+void ForcedAligner::setAnnotationContext(const QString &annotationID, const QString &speakerID)
+{
+    d->contextAnnotationID = annotationID;
+    d->contextSpeakerID = speakerID;
+}
+
+bool ForcedAligner::saveUtteranceHashes()
+{
+    if (!d->utteranceHashesChanged || d->utteranceHashesFilename.isEmpty()) return true;
+    QSaveFile file(d->utteranceHashesFilename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    for (QHash<QString, QString>::const_iterator i = d->utteranceHashes.constBegin(); i != d->utteranceHashes.constEnd(); ++i)
+        stream << i.key() << "\t" << i.value() << "\n";
+    stream.flush();
+    if (!file.commit()) return false;
+    d->utteranceHashesChanged = false;
+    return true;
+}
+
+// private
+QString ForcedAligner::utteranceHashKey(Interval *utterance) const
+{
+    if (d->utteranceHashesFilename.isEmpty() || (d->contextAnnotationID.isEmpty() && d->contextSpeakerID.isEmpty()))
+        return QString();
+    return QString("%1\t%2\t%3\t%4").arg(d->contextAnnotationID).arg(d->contextSpeakerID)
+            .arg(utterance->tMin().toDouble(), 0, 'f', 6).arg(utterance->tMax().toDouble(), 0, 'f', 6);
+}
+
+// public
+QString ForcedAligner::utteranceHash(IntervalTier *tierUtterances, int indexUtterance, IntervalTier *tierTokens,
+                                     bool insertLeadingAndTrailingPauses) const
+{
+    if (!tierUtterances || !tierTokens) return QString();
+    if ((indexUtterance < 0) || (indexUtterance >= tierUtterances->count())) return QString();
+    Interval *utterance = tierUtterances->at(indexUtterance);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    // The aligner and its settings: changing them means aligning again
+    hash.addData(QString("%1\t%2\t%3\t%4\t%5\n").arg(metaObject()->className())
+                 .arg(d->usePronunciationVariants).arg(insertLeadingAndTrailingPauses)
+                 .arg(d->phonetisationSeparatorForVariants).arg(d->phonetisationSeparatorForPhonemes).toUtf8());
+    hash.addData(QString("%1\t%2\n").arg(utterance->tMin().toDouble(), 0, 'f', 6)
+                 .arg(utterance->tMax().toDouble(), 0, 'f', 6).toUtf8());
+    // Tokens and their phonetisations, but not their boundaries (which the aligner moves) or the pauses between them
+    QPair<int, int> tokenIndices = tierTokens->getIntervalIndexesContainedIn(utterance);
+    for (int i = tokenIndices.first; (i >= 0) && (i <= tokenIndices.second) && (i < tierTokens->count()); ++i) {
+        Interval *token = tierTokens->at(i);
+        if (token->isPauseSilent()) continue;
+        hash.addData(QString("%1\t%2\n").arg(token->text())
+                     .arg(token->attribute(d->tokenPhonetisationAttributeID).toString()).toUtf8());
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// public
+bool ForcedAligner::isUtteranceAlignmentCurrent(IntervalTier *tierUtterances, int indexUtterance,
+                                                IntervalTier *tierTokens, IntervalTier *tierPhones,
+                                                bool insertLeadingAndTrailingPauses) const
+{
+    if (!tierUtterances || !tierTokens || !tierPhones) return false;
+    if ((indexUtterance < 0) || (indexUtterance >= tierUtterances->count())) return false;
+    Interval *utterance = tierUtterances->at(indexUtterance);
+    QString storedHash = utterance->attribute(d->utteranceHashAttributeID).toString();
+    if (storedHash.isEmpty()) storedHash = d->utteranceHashes.value(utteranceHashKey(utterance));
+    if (storedHash.isEmpty()) return false;
+    if (storedHash != utteranceHash(tierUtterances, indexUtterance, tierTokens, insertLeadingAndTrailingPauses))
+        return false;
+    // The phones may have been removed since (e.g. a new phone tier)
+    QPair<int, int> phoneIndices = tierPhones->getIntervalIndexesContainedIn(utterance);
+    for (int i = phoneIndices.first; (i >= 0) && (i <= phoneIndices.second) && (i < tierPhones->count()); ++i) {
+        if (!tierPhones->at(i)->isPauseSilent()) return true;
+    }
+    return false;
+}
+
 
 QList<SpeechToken> ForcedAligner::alignerTokensFromIntervalTier(bool insertLeadingAndTrailingPauses,
                                                                 IntervalTier *tierTokens, int indexFrom, int indexTo)
@@ -225,6 +364,18 @@ bool ForcedAligner::alignUtterance(const QString &waveFilepath,
     if (indexUtteranceToAlign >= tierUtterances->count()) return false;
     Interval *utterance = tierUtterances->at(indexUtteranceToAlign);
 
+    if (d->incrementalAlignment &&
+        isUtteranceAlignmentCurrent(tierUtterances, indexUtteranceToAlign, tierTokens, tierPhones,
+                                    insertLeadingAndTrailingPauses)) {
+        d->countUnchanged++;
+        return true;
+    }
+    d->countAligned++;
+    // Side table entry for the utterance as given, before pauses are split off it
+    QString hashKey = utteranceHashKey(utterance);
+    QString hashBeforeAlignment = (hashKey.isEmpty()) ? QString() :
+            utteranceHash(tierUtterances, indexUtteranceToAlign, tierTokens, insertLeadingAndTrailingPauses);
+
     RealTime timeFrom = utterance->tMin();
     RealTime timeTo = utterance->tMax();
     QPair<int, int> tokenIndices = tierTokens->getIntervalIndexesContainedIn(tierUtterances->at(indexUtteranceToAlign));
@@ -252,6 +403,14 @@ bool ForcedAligner::alignUtterance(const QString &waveFilepath,
             tierUtterances->at(indexUtteranceToAlign + 1)->setText("_");
         }
         tierPhones->patchIntervals(phonesList, timeFrom, timeTo);
+        // The hash of the utterance as aligned (without the pauses split off above)
+        tierUtterances->at(indexUtteranceToAlign)->setAttribute(
+                    d->utteranceHashAttributeID,
+                    utteranceHash(tierUtterances, indexUtteranceToAlign, tierTokens, insertLeadingAndTrailingPauses));
+        if (!hashKey.isEmpty()) {
+            d->utteranceHashes.insert(hashKey, hashBeforeAlignment);
+            d->utteranceHashesChanged = true;
+        }
     }
 
     if ((!ok) && d->returnDummyAlignmentOnFailure) {
@@ -286,6 +445,7 @@ bool ForcedAligner::alignAllUtterances(const QString &waveFilepath,
     if (!tierUtterances) return false;
     if (!tierTokens) return false;
     if (!tierPhones) return false;
+    d->countAligned = d->countUnchanged = 0;
     int indexUtterance = tierUtterances->count() - 1;
     while (indexUtterance >= 0) {
         if (tierUtterances->at(indexUtterance)->isPauseSilent()) { indexUtterance--; continue; }
@@ -302,6 +462,9 @@ bool ForcedAligner::alignAllUtterances(const QString &waveFilepath,
     tierUtterances->mergeIdenticalAnnotations("_");
     tierPhones->fillEmptyWith("", "_");
     tierPhones->mergeIdenticalAnnotations("_");
+    if (d->countUnchanged > 0)
+        emit alignerMessage(QString("Aligned %1 utterances, %2 unchanged").arg(d->countAligned).arg(d->countUnchanged));
+    saveUtteranceHashes();
     return true;
 }
 
@@ -24,7 +24,7 @@ namespace Praaline {
 namespace ASR {
 
 struct HTKForcedAlignerData {
-    HTKForcedAlignerData() : sampleRateAM(16000), beamThreshold(500)
+    HTKForcedAlignerData() : sampleRateAM(16000), beamThreshold(500), countProcessesLaunched(0)
     {}
     QString filenameCFG;
     QString filenameHMM;
@@ -34,6 +34,7 @@ struct HTKForcedAlignerData {
     QHash<QString, QString> phonemeTranslations;
     QHash<QString, QString> phonemeReverseTranslations;
     QString pathTemp;
+    int countProcessesLaunched;
 };
 
 
@@ -73,6 +74,12 @@ HTKForcedAligner::~HTKForcedAligner()
     delete d;
 }
 
+// public
+int HTKForcedAligner::countProcessesLaunched() const
+{
+    return d->countProcessesLaunched;
+}
+
 // Encode UTF entities (used for accented characters in dictionary and transcription files)
 // private
 QString HTKForcedAligner::encodeEntities(const QString &src, const QString &force)
@@ -196,6 +203,7 @@ bool HTKForcedAligner::runAligner(const QString &filenameBase, QList<SpeechToken
         alignerOutput = QString(hvite.readAllStandardOutput() + hvite.readAllStandardError());
         return false;
     }
+    d->countProcessesLaunched++;
     if (!hvite.waitForFinished(-1)) {
         alignerOutput = QString(hvite.readAllStandardOutput() + hvite.readAllStandardError());
         return false;
@@ -5,6 +5,14 @@
 #include <QTextStream>
 #include <QCoreApplication>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "PraalineCore/Annotation/IntervalTier.h"
 using namespace Praaline::Core;
@@ -39,102 +47,248 @@ ExternalPhonetiser::~ExternalPhonetiser()
     delete d;
 }
 
-bool callPhonetiserCitationForms(QHash<QString, QString> &citationForms)
+// Location of the external phonetiser
+QString phonetiserDirectory()
 {
-    if (citationForms.isEmpty()) return false;
-    // Get a temporary file and write out the forms
-    QString filenameIn, filenameOut;
-    QTemporaryFile fileIn, fileOut;
+    return QDir::homePath() + "/Praaline/plugins/aligner/phonetiser/";
+}
+
+QString phonetiserProgram()
+{
+    return phonetiserDirectory() + "lang/fra/phon250.exe";
+}
 
-    QList<QString> forms;
+QString phonetiserConfiguration()
+{
+    return phonetiserDirectory() + "lang/fra/phon250.fra.ini";
+}
 
-    if (!fileIn.open()) return false;
-    filenameIn = fileIn.fileName();
-    QTextStream streamIn(&fileIn);
-    streamIn.setCodec("ISO 8859-1");
-    foreach (QString form, citationForms.keys()) {
-        if (form.isEmpty()) continue;
-        forms << form;
-        streamIn << form << " .\n";
+// ====================================================================================================================
+// Persistent cache of phonetisations
+// ====================================================================================================================
+
+// Phonetisations already obtained from the external phonetiser, keyed by context ("form" for citation forms,
+// "utterance" for whole utterances) and orthographic text. The cache file records an identifier of the phonetiser
+// (programme and configuration, with their modification times), and is discarded when the phonetiser changes.
+// New entries are written out by flush(), at the end of a run, and when the cache is destroyed.
+class PhonetisationCache {
+public:
+    static PhonetisationCache *instance() {
+        static PhonetisationCache cache;
+        return &cache;
     }
-    fileIn.close();
 
-    // Touch the output file, and get its filename
-    if (!fileOut.open()) return false;
-    filenameOut = fileOut.fileName();
-    fileOut.close();
+    ~PhonetisationCache() {
+        flush();
+    }
 
-    // Pass to external phonetiser
-    // DIRECTORY:
-    QString phonPath = QDir::homePath() + "/Praaline/plugins/aligner/phonetiser/";
-    QProcess phonetiser;
-    phonetiser.setWorkingDirectory(phonPath);
-    phonetiser.start(phonPath + "lang/fra/phon250.exe" , QStringList() <<
-                     phonPath + "lang/fra/phon250.fra.ini" << filenameIn << filenameOut);
-    if (!phonetiser.waitForStarted(-1)) return false;
-    if (!phonetiser.waitForFinished(-1)) return false;
-    // Read responses into hash
-    if (!fileOut.open()) return false;
-    QTextStream streamOut(&fileOut);
-    streamOut.setCodec("ISO 8859-1");
-    int i = 0;
-    while (!streamOut.atEnd() && i < forms.count()) {
-        QString phonetisation = streamOut.readLine();
-        if (phonetisation.isEmpty()) continue;
-        phonetisation = phonetisation.replace("| _", "").trimmed();
-        citationForms[forms[i]] = phonetisation;
-        i++;
+    void setFilename(const QString &filename) {
+        QMutexLocker locker(&m_mutex);
+        if (m_dirty) save();
+        m_filename = filename;
+        m_entries.clear();
+        m_loaded = false;
     }
-    fileOut.close();
-    return true;
+
+    void clear() {
+        QMutexLocker locker(&m_mutex);
+        m_entries.clear();
+        m_phonetiserID = phonetiserID();
+        m_loaded = true;
+        m_dirty = false;
+        if (!m_filename.isEmpty()) QFile::remove(m_filename);
+    }
+
+    // Fills in the phonetisations that are in the cache, and returns the texts that are not
+    QStringList lookup(const QString &context, QHash<QString, QString> &phonetisations) {
+        QMutexLocker locker(&m_mutex);
+        load();
+        QStringList misses;
+        for (QHash<QString, QString>::iterator it = phonetisations.begin(); it != phonetisations.end(); ++it) {
+            QHash<QString, QString>::const_iterator cached = m_entries.constFind(key(context, it.key()));
+            if (cached != m_entries.constEnd())
+                it.value() = cached.value();
+            else
+                misses << it.key();
+        }
+        return misses;
+    }
+
+    void insert(const QString &context, const QHash<QString, QString> &phonetisations) {
+        if (phonetisations.isEmpty()) return;
+        QMutexLocker locker(&m_mutex);
+        load();
+        for (QHash<QString, QString>::const_iterator it = phonetisations.constBegin(); it != phonetisations.constEnd(); ++it)
+            m_entries.insert(key(context, it.key()), it.value());
+        m_dirty = true;
+    }
+
+    void flush() {
+        QMutexLocker locker(&m_mutex);
+        if (m_dirty) save();
+    }
+
+private:
+    PhonetisationCache() : m_loaded(false), m_dirty(false) {
+        QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (!cacheDirectory.isEmpty()) m_filename = cacheDirectory + "/phonetisation/external.cache";
+    }
+
+    static QString key(const QString &context, const QString &text) {
+        return context + QChar('\t') + text;
+    }
+
+    static QString phonetiserID() {
+        QString id;
+        foreach (QString filename, QStringList() << phonetiserProgram() << phonetiserConfiguration()) {
+            QFileInfo info(filename);
+            id.append(QString("%1;%2;%3;").arg(info.absoluteFilePath()).arg(info.size())
+                      .arg(info.lastModified().toMSecsSinceEpoch()));
+        }
+        return id;
+    }
+
+    void load() {
+        if (m_loaded) return;
+        m_loaded = true;
+        m_phonetiserID = phonetiserID();
+        if (m_filename.isEmpty()) return;
+        QFile file(m_filename);
+        if (!file.open(QIODevice::ReadOnly)) return;
+        QDataStream stream(&file);
+        quint32 magic(0), version(0);
+        QString id;
+        stream >> magic >> version;
+        if (magic != cacheMagic || version != cacheVersion) return;
+        stream >> id;
+        if (id != m_phonetiserID) return;
+        QHash<QString, QString> entries;
+        stream >> entries;
+        if (stream.status() == QDataStream::Ok) m_entries = entries;
+    }
+
+    void save() {
+        m_dirty = false;
+        if (m_filename.isEmpty()) return;
+        QDir().mkpath(QFileInfo(m_filename).absolutePath());
+        QSaveFile file(m_filename);
+        if (!file.open(QIODevice::WriteOnly)) return;
+        QDataStream stream(&file);
+        stream << cacheMagic << cacheVersion << m_phonetiserID << m_entries;
+        if (!file.commit()) qDebug() << "Could not write phonetisation cache" << m_filename;
+    }
+
+    static const quint32 cacheMagic = 0x50484f4e;
+    static const quint32 cacheVersion = 1;
+
+    QMutex m_mutex;
+    QString m_filename;
+    QString m_phonetiserID;
+    QHash<QString, QString> m_entries;
+    bool m_loaded;
+    bool m_dirty;
+};
+
+// static
+void ExternalPhonetiser::setCacheFilename(const QString &filename)
+{
+    PhonetisationCache::instance()->setFilename(filename);
 }
 
-bool callPhonetiser(QList<PUtterance> &utterances)
+// static
+void ExternalPhonetiser::saveCache()
 {
-    if (utterances.isEmpty()) return false;
+    PhonetisationCache::instance()->flush();
+}
 
-    // Get a temporary file and write out the utterances
-    QString filenameIn, filenameOut;
-    QTemporaryFile fileIn, fileOut;
+// static
+void ExternalPhonetiser::clearCache()
+{
+    PhonetisationCache::instance()->clear();
+}
 
+// ====================================================================================================================
+// Calls to the external phonetiser
+// ====================================================================================================================
+
+// Runs the external phonetiser once over all the texts (one per line) and returns their phonetisations, in the
+// same order
+bool runPhonetiser(const QStringList &texts, QStringList &phonetisations)
+{
+    if (texts.isEmpty()) return false;
+    // Get a temporary file and write out the texts
+    QTemporaryFile fileIn, fileOut;
     if (!fileIn.open()) return false;
-    filenameIn = fileIn.fileName();
     QTextStream streamIn(&fileIn);
     streamIn.setCodec("ISO 8859-1");
-    foreach (PUtterance utterance, utterances) {
-        if (utterance.orthographic.isEmpty()) continue;
-        streamIn << utterance.orthographic << " .\n";
+    foreach (QString text, texts) {
+        streamIn << text << " .\n";
     }
+    streamIn.flush();
     fileIn.close();
 
     // Touch the output file, and get its filename
     if (!fileOut.open()) return false;
-    filenameOut = fileOut.fileName();
     fileOut.close();
 
     // Pass to external phonetiser
-    // DIRECTORY:
-    QString phonPath = QDir::homePath() + "/Praaline/plugins/aligner/phonetiser/";
     QProcess phonetiser;
-    phonetiser.setWorkingDirectory(phonPath);
-    phonetiser.start(phonPath + "lang/fra/phon250.exe" , QStringList() <<
-                     phonPath + "lang/fra/phon250.fra.ini" << filenameIn << filenameOut);
+    phonetiser.setWorkingDirectory(phonetiserDirectory());
+    phonetiser.start(phonetiserProgram(), QStringList() << phonetiserConfiguration()
+                     << fileIn.fileName() << fileOut.fileName());
     if (!phonetiser.waitForStarted(-1)) return false;
     if (!phonetiser.waitForFinished(-1)) return false;
-    // Read responses into token list
+    // Read responses
     if (!fileOut.open()) return false;
     QTextStream streamOut(&fileOut);
     streamOut.setCodec("ISO 8859-1");
-    int i = 0;
-    while (!streamOut.atEnd() && i < utterances.count()) {
+    phonetisations.clear();
+    while (!streamOut.atEnd() && phonetisations.count() < texts.count()) {
         QString phonetisation = streamOut.readLine();
         if (phonetisation.isEmpty()) continue;
-        phonetisation = phonetisation.replace("| _", "");
-        utterances[i].phonetisation = phonetisation.trimmed();
-        i++;
+        phonetisations << phonetisation.replace("| _", "").trimmed();
     }
     fileOut.close();
-    return true;
+    return (phonetisations.count() == texts.count());
+}
+
+// Phonetises the texts that are not in the cache, all in one call, and caches the results
+bool callPhonetiserCached(const QString &context, QHash<QString, QString> &phonetisations)
+{
+    QStringList misses = PhonetisationCache::instance()->lookup(context, phonetisations);
+    if (misses.isEmpty()) return true;
+    QStringList results;
+    bool ok = runPhonetiser(misses, results);
+    QHash<QString, QString> phonetised;
+    for (int i = 0; i < results.count(); ++i) {
+        phonetisations[misses.at(i)] = results.at(i);
+        phonetised.insert(misses.at(i), results.at(i));
+    }
+    // Do not cache a partial output: the alignment of texts and lines is not reliable
+    if (ok) PhonetisationCache::instance()->insert(context, phonetised);
+    return ok;
+}
+
+bool callPhonetiserCitationForms(QHash<QString, QString> &citationForms)
+{
+    if (citationForms.isEmpty()) return false;
+    citationForms.remove(QString());
+    return callPhonetiserCached("form", citationForms);
+}
+
+bool callPhonetiser(QList<PUtterance> &utterances)
+{
+    if (utterances.isEmpty()) return false;
+    QHash<QString, QString> phonetisations;
+    foreach (PUtterance utterance, utterances) {
+        if (utterance.orthographic.isEmpty()) continue;
+        phonetisations.insert(utterance.orthographic, QString());
+    }
+    bool ok = callPhonetiserCached("utterance", phonetisations);
+    for (int i = 0; i < utterances.count(); ++i) {
+        utterances[i].phonetisation = phonetisations.value(utterances.at(i).orthographic);
+    }
+    return ok;
 }
 
 QList<SpeechToken> mergePhonetiserTokens(const QList<SpeechToken> &ptokens)
@@ -204,19 +358,18 @@ QList<SpeechToken> ExternalPhonetiser::phonetiseList(QList<Interval *> tokens, c
     putterances << PUtterance(putterance_tokens, putterance_orthographic);
 
     callPhonetiser(putterances);
-    foreach (PUtterance putterance, putterances) {
+    // Utterances whose phonetisation does not align with their tokens fall back to citation forms, all phonetised
+    // in one call
+    QList<int> fallbacks;
+    QHash<QString, QString> citationForms;
+    for (int u = 0; u < putterances.count(); ++u) {
+        const PUtterance &putterance = putterances.at(u);
         QStringList phonetisation_split = putterance.phonetisation.split("|", Qt::SkipEmptyParts);
         if (phonetisation_split.count() != putterance.ptokens.count()) {
-            // qDebug() << "mismatched tokens-phonotokens";
-            // qDebug() << putterance.phonetisation << putterance.orthographic;
-            QHash<QString, QString> citationForms;
             foreach (int ptoken_id, putterance.ptokens) {
                 citationForms.insert(ptokens[ptoken_id].orthographic, "");
             }
-            callPhonetiserCitationForms(citationForms);
-            foreach (int ptoken_id, putterance.ptokens) {
-                ptokens[ptoken_id].phonetisations << citationForms.value(ptokens[ptoken_id].orthographic, "@");
-            }
+            fallbacks << u;
             continue;
         }
         for (int i = 0; i < phonetisation_split.count(); ++i) {
@@ -224,6 +377,13 @@ QList<SpeechToken> ExternalPhonetiser::phonetiseList(QList<Interval *> tokens, c
             ptokens[ptoken_id].phonetisations << phonetisation_split[i].trimmed();
         }
     }
+    if (!citationForms.isEmpty()) callPhonetiserCitationForms(citationForms);
+    foreach (int u, fallbacks) {
+        foreach (int ptoken_id, putterances.at(u).ptokens) {
+            QString phonetisation = citationForms.value(ptokens[ptoken_id].orthographic);
+            ptokens[ptoken_id].phonetisations << ((phonetisation.isEmpty()) ? QString("@") : phonetisation);
+        }
+    }
     return ptokens;
 }
 
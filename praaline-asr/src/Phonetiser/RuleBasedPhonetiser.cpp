@@ -1,16 +1,33 @@
 #include <QDebug>
 #include <QString>
+#include <QStringList>
 #include <QFile>
 #include <QTextStream>
 #include <QRegularExpression>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrent>
 
 #include "PraalineASR/Phonetiser/RuleBasedPhonetiser.h"
 
 namespace Praaline {
 namespace ASR {
 
+struct RewriteRule {
+    RewriteRule() : literal(false) {}
+    QString pattern;
+    QString replacement;
+    // Literal rules (no regular expression syntax in the pattern, no back-references in the replacement) are
+    // applied with a plain string search; the others with their compiled regular expression.
+    bool literal;
+    QRegularExpression regex;
+};
+
 struct RuleBasedPhonetiserData {
-    QList<QPair<QString, QString> > rules;
+    QList<RewriteRule> rules;
+    // Memoised results for single words
+    QMutex mutex;
+    QHash<QString, QString> cache;
 };
 
 RuleBasedPhonetiser::RuleBasedPhonetiser(QObject *parent) :
@@ -28,6 +45,8 @@ bool RuleBasedPhonetiser::readRuleFile(const QString &filename)
     QFile fileRules(filename);
     if ( !fileRules.open( QIODevice::ReadOnly | QIODevice::Text ) ) return false;
     d->rules.clear();
+    clearCache();
+    QRegularExpression regexSyntax("[\\\\^$.|?*+()\\[\\]{}]");
     QTextStream rules(&fileRules);
     rules.setCodec("UTF-8");
     while (!rules.atEnd()) {
@@ -36,9 +55,19 @@ bool RuleBasedPhonetiser::readRuleFile(const QString &filename)
         if (line.startsWith("#")) continue;
         QStringList parts = line.split("::");
         if (parts.count() != 2) continue;
-        QPair<QString, QString> rule;
-        rule.first = parts[0].trimmed();
-        rule.second = parts[1].trimmed().prepend(" ").append(" ");
+        RewriteRule rule;
+        rule.pattern = parts[0].trimmed();
+        rule.replacement = parts[1].trimmed().prepend(" ").append(" ");
+        if (rule.pattern.isEmpty()) continue;
+        rule.literal = !rule.pattern.contains(regexSyntax) && !rule.replacement.contains("\\");
+        if (!rule.literal) {
+            rule.regex.setPattern(rule.pattern);
+            if (!rule.regex.isValid()) {
+                qDebug() << QString("Invalid rule %1: %2").arg(rule.pattern).arg(rule.regex.errorString());
+                continue;
+            }
+            rule.regex.optimize();
+        }
         d->rules << rule;
     }
     qDebug() << QString("%1 rules loaded.").arg(d->rules.count());
@@ -46,35 +75,117 @@ bool RuleBasedPhonetiser::readRuleFile(const QString &filename)
     return true;
 }
 
+int RuleBasedPhonetiser::rulesCount() const
+{
+    return d->rules.count();
+}
+
+void RuleBasedPhonetiser::clearCache()
+{
+    QMutexLocker locker(&d->mutex);
+    d->cache.clear();
+}
+
+// Replace each run of whitespace with a single space, as replacing "(\\s)+" with " " would. Returns early, without
+// copying, when there is nothing to collapse.
+static void collapseWhitespace(QString &text)
+{
+    const QChar *data = text.constData();
+    int length = text.length();
+    int i = 0;
+    for (; i < length; ++i) {
+        if (!data[i].isSpace()) continue;
+        if (data[i] != QChar(' ') || (i + 1 < length && data[i + 1].isSpace())) break;
+    }
+    if (i == length) return;
+    QString collapsed;
+    collapsed.reserve(length);
+    collapsed.append(data, i);
+    while (i < length) {
+        if (data[i].isSpace()) {
+            collapsed.append(QChar(' '));
+            while (i < length && data[i].isSpace()) ++i;
+        } else {
+            collapsed.append(data[i]);
+            ++i;
+        }
+    }
+    text = collapsed;
+}
+
 QString RuleBasedPhonetiser::phonetise(const QString &input)
 {
+    bool isWord = true;
+    for (int i = 0; i < input.length() && isWord; ++i) {
+        if (input.at(i).isSpace()) isWord = false;
+    }
+    if (isWord) {
+        QMutexLocker locker(&d->mutex);
+        QHash<QString, QString>::const_iterator cached = d->cache.constFind(input);
+        if (cached != d->cache.constEnd()) return cached.value();
+    }
+
     QString output(input);
 
     output = output.replace(QRegularExpression("\\s"), " | ").trimmed();
     output = output.prepend("| ");
     if (!output.endsWith("|")) output = output.append(" |");
 
-//    QFile fileDebug("D:/Aligner_train_tests/debug.txt");
-//    if ( !fileDebug.open( QIODevice::WriteOnly | QIODevice::Text ) ) return QString();
-//    QTextStream debug(&fileDebug);
-//    debug.setCodec("UTF-8");
-//    debug.setGenerateByteOrderMark(true);
-
-    QPair<QString, QString> rule;
-    foreach (rule, d->rules) {
-        if (rule.first.isEmpty()) continue;
-        output = output.replace(QRegularExpression(rule.first), rule.second).replace(QRegularExpression("(\\s)+"), " ");
-        // debug << rule.first << "\t" << rule.second << "\n" << output << "\n\n";
+    // Whitespace is collapsed after the first rule; after that, only rules that match can change the buffer
+    bool first = true;
+    foreach (const RewriteRule &rule, d->rules) {
+        if (rule.literal) {
+            if (!first && !output.contains(rule.pattern)) continue;
+            output.replace(rule.pattern, rule.replacement);
+        } else {
+            if (!first && !rule.regex.match(output).hasMatch()) continue;
+            output.replace(rule.regex, rule.replacement);
+        }
+        collapseWhitespace(output);
+        first = false;
     }
-    //fileDebug.close();
 
+    if (isWord) {
+        QMutexLocker locker(&d->mutex);
+        d->cache.insert(input, output);
+    }
     return output;
 }
 
+struct RunPhonetiseStep
+{
+    RuleBasedPhonetiser *phonetiser;
+
+    RunPhonetiseStep(RuleBasedPhonetiser *phonetiser) : phonetiser(phonetiser) {}
+    typedef QString result_type;
+
+    QString operator() (const QString &token)
+    {
+        return phonetiser->phonetise(token);
+    }
+};
+
+void RuleBasedPhonetiser::phonetiseTokenList(QHash<QString, QString> &tokens)
+{
+    QStringList keys = tokens.keys();
+    QList<QString> phonetisations = QtConcurrent::blockingMapped<QList<QString> >(keys, RunPhonetiseStep(this));
+    for (int i = 0; i < keys.count(); ++i) {
+        tokens[keys.at(i)] = phonetisations.at(i);
+    }
+}
+
+void RuleBasedPhonetiser::phonetiseTokenList(QMap<QString, QString> &tokens)
+{
+    QStringList keys = tokens.keys();
+    QList<QString> phonetisations = QtConcurrent::blockingMapped<QList<QString> >(keys, RunPhonetiseStep(this));
+    for (int i = 0; i < keys.count(); ++i) {
+        tokens[keys.at(i)] = phonetisations.at(i);
+    }
+}
+
 QString RuleBasedPhonetiser::phonetiseWord(const QString &word)
 {
-    Q_UNUSED(word)
-    return QString();
+    return phonetise(word);
 }
 
 QList<Core::Interval *> RuleBasedPhonetiser::phonetiseUtterance(Core::Interval *utterance)
@@ -4,6 +4,16 @@
 #include <QList>
 #include <QFile>
 #include <QTextStream>
+#include <QTemporaryFile>
+#include <QHash>
+#include <QVector>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+
+#include "sphinxbase/logmath.h"
+#include "sphinxbase/ngram_model.h"
 
 #include "PraalineCore/Annotation/IntervalTier.h"
 #include "PraalineCore/Annotation/AnnotationTierGroup.h"
@@ -17,9 +27,11 @@ using namespace Praaline::Core;
 namespace Praaline {
 namespace ASR {
 
+typedef QHash<quint64, quint32> NGramCounts;
+
 struct SphinxLanguageModelBuilderData {
     SphinxLanguageModelBuilderData() :
-        minimumNumberOfTokensInUtteranceFilter(0)
+        minimumNumberOfTokensInUtteranceFilter(0), order(3)
     {}
 
     QString levelUtterances, attributeUtterances;
@@ -27,6 +39,11 @@ struct SphinxLanguageModelBuilderData {
     QStringList speakersInclude;
     QStringList speakersExclude;
     int minimumNumberOfTokensInUtteranceFilter;
+    // N-gram counts: vocabulary (<s> and </s> are words 0 and 1), and raw counts for each order
+    int order;
+    QStringList words;
+    QHash<QString, quint32> wordIDs;
+    QVector<NGramCounts> counts;
 };
 
 SphinxLanguageModelBuilder::SphinxLanguageModelBuilder(QObject *parent) :
@@ -35,6 +52,7 @@ SphinxLanguageModelBuilder::SphinxLanguageModelBuilder(QObject *parent) :
     // Default values for utterance and token tiers
     d->levelTokens = "segment";
     d->levelTokens = "tok_min";
+    clearCounts();
 }
 
 SphinxLanguageModelBuilder::~SphinxLanguageModelBuilder()
@@ -104,46 +122,37 @@ void SphinxLanguageModelBuilder::setMinimumNumberOfTokensInUtteranceFilter(int m
     d->minimumNumberOfTokensInUtteranceFilter = min;
 }
 
-QStringList SphinxLanguageModelBuilder::getNormalisedUtterances(CorpusAnnotation *annotation)
+// Transcriptions of the utterances of one speaker. The tokens of each utterance are read by index from the token tier,
+// without building a list of them.
+struct NormaliseSpeakerUtterancesStep
 {
-    QStringList normalisedUtterances;
-    // Sanity checks
-    if (!annotation) return normalisedUtterances;
-    if (!annotation->repository()) return normalisedUtterances;
-    if (!annotation->repository()->annotations()) return normalisedUtterances;
-    // Process annotation
-    QString annotationID = annotation->ID();
-    SpeakerAnnotationTierGroupMap tiersAll = annotation->repository()->annotations()->getTiersAllSpeakers(annotationID);
-    foreach (QString speakerID, tiersAll.keys()) {
-        // Process all speakers based on the inclusion/exclusion filters
-        if ((!d->speakersInclude.isEmpty()) && (!d->speakersInclude.contains(speakerID))) continue;
-        if ((!d->speakersExclude.isEmpty()) && (d->speakersExclude.contains(speakerID))) continue;
-        AnnotationTierGroup *tiers = tiersAll.value(speakerID);
-        if (!tiers) continue;
+    SphinxLanguageModelBuilderData *d;
+
+    NormaliseSpeakerUtterancesStep(SphinxLanguageModelBuilderData *d) : d(d) {}
+    typedef QStringList result_type;
+
+    QStringList operator() (AnnotationTierGroup *tiers)
+    {
+        QStringList normalisedUtterances;
         // Get tiers: an utterance tier is necessary, a token tier is optional
         IntervalTier *tier_utterance = tiers->getIntervalTierByName(d->levelUtterances);
-        if (!tier_utterance) continue;
+        if (!tier_utterance) return normalisedUtterances;
         IntervalTier *tier_tokens = tiers->getIntervalTierByName(d->levelTokens);
         // Find transcribed utterances
-        QList<Interval *> list_utterances;
-        int i = 0;
         foreach (Interval *intv, tier_utterance->intervals()) {
             // Check if utterance is empty, or if has less tokens than the minimum number
-            if (intv->isPauseSilent()) { i++; continue; }
-            QList<Interval *> tokens;
+            if (intv->isPauseSilent()) continue;
+            QPair<int, int> tokenIndices(0, -1);
             if (tier_tokens) {
-                tokens = tier_tokens->getIntervalsContainedIn(intv);
-                if (tokens.count() < d->minimumNumberOfTokensInUtteranceFilter) { i++; continue; }
+                tokenIndices = tier_tokens->getIntervalIndexesContainedIn(intv->tMin(), intv->tMax());
+                if ((tokenIndices.first < 0) || (tokenIndices.second < 0)) tokenIndices = QPair<int, int>(0, -1);
+                if (tokenIndices.second - tokenIndices.first + 1 < d->minimumNumberOfTokensInUtteranceFilter) continue;
             }
-            QString utteranceID = QString("%1_%2_%3").arg(annotationID).arg(speakerID).arg(i);
-            // OK to proceed: add utterance to the list
-            Interval *utt = intv->clone();
-            utt->setAttribute("utteranceID", utteranceID);
-            list_utterances << utt;
             QString transcription;
             if (tier_tokens) {
                 transcription.append("<s> ");
-                foreach (Interval *token, tokens) {
+                for (int i = tokenIndices.first; i <= tokenIndices.second; ++i) {
+                    Interval *token = tier_tokens->at(i);
                     if (token->isPauseSilent()) continue;
                     QString t = (d->attributeTokens.isEmpty()) ? token->text() : token->attribute(d->attributeTokens).toString();
                     transcription.append(t).append(" ");
@@ -151,22 +160,314 @@ QStringList SphinxLanguageModelBuilder::getNormalisedUtterances(CorpusAnnotation
                 }
                 transcription.append("</s>");
             } else {
-                QString transcript = (d->attributeUtterances.isEmpty()) ? utt->text() : utt->attribute(d->attributeUtterances).toString();
+                QString transcript = (d->attributeUtterances.isEmpty()) ? intv->text() : intv->attribute(d->attributeUtterances).toString();
                 transcript = transcript.replace("'", "' ");
-                foreach (QString word, transcript.split(" ")) {
-                    // if (!d->dictionary->contains(word)) outUnknownWordsList << word;
-                }
                 transcription.append("<s> ").append(transcript).append(" </s>");
             }
-            i++; // proceed to next utterance
             normalisedUtterances << transcription;
         }
-        qDeleteAll(list_utterances);
+        return normalisedUtterances;
+    }
+};
+
+QStringList SphinxLanguageModelBuilder::getNormalisedUtterances(CorpusAnnotation *annotation)
+{
+    QStringList normalisedUtterances;
+    // Sanity checks
+    if (!annotation) return normalisedUtterances;
+    if (!annotation->repository()) return normalisedUtterances;
+    if (!annotation->repository()->annotations()) return normalisedUtterances;
+    // Process annotation
+    QString annotationID = annotation->ID();
+    SpeakerAnnotationTierGroupMap tiersAll = annotation->repository()->annotations()->getTiersAllSpeakers(annotationID);
+    // Process all speakers based on the inclusion/exclusion filters
+    QList<AnnotationTierGroup *> speakerTiers;
+    foreach (QString speakerID, tiersAll.keys()) {
+        if ((!d->speakersInclude.isEmpty()) && (!d->speakersInclude.contains(speakerID))) continue;
+        if ((!d->speakersExclude.isEmpty()) && (d->speakersExclude.contains(speakerID))) continue;
+        AnnotationTierGroup *tiers = tiersAll.value(speakerID);
+        if (tiers) speakerTiers << tiers;
     }
+    // Speakers are processed in parallel; their utterances are concatenated in the order of the speaker IDs
+    QList<QStringList> utterancesBySpeaker =
+            QtConcurrent::blockingMapped<QList<QStringList> >(speakerTiers, NormaliseSpeakerUtterancesStep(d));
+    foreach (const QStringList &speakerUtterances, utterancesBySpeaker) normalisedUtterances << speakerUtterances;
     qDeleteAll(tiersAll);
     // emit printMessage(QString("Created Sphinx transcription files for %1/%2").arg(com->ID()).arg(rec->ID()));
     return normalisedUtterances;
 }
 
+// ====================================================================================================================
+// N-gram counting
+// ====================================================================================================================
+
+namespace {
+
+// Words are packed in the keys of the count tables, most significant first, as (word ID + 1) on a fixed number of
+// bits that depends on the order.
+int bitsPerWord(int order)
+{
+    return qMin(32, 64 / order);
+}
+
+quint64 lastWordsMask(int bits, int n)
+{
+    return (bits * n >= 64) ? ~Q_UINT64_C(0) : ((Q_UINT64_C(1) << (bits * n)) - 1);
+}
+
+quint32 firstWord(quint64 key, int bits, int n)
+{
+    return static_cast<quint32>(key >> (bits * (n - 1))) - 1;
+}
+
+struct CountNGramsStep
+{
+    int order;
+
+    CountNGramsStep(int order) : order(order) {}
+    typedef QVector<NGramCounts> result_type;
+
+    QVector<NGramCounts> operator() (const QList<QVector<quint32> > &sentences)
+    {
+        QVector<NGramCounts> counts(order);
+        int bits = bitsPerWord(order);
+        foreach (const QVector<quint32> &sentence, sentences) {
+            for (int i = 0; i < sentence.count(); ++i) {
+                quint64 key = 0;
+                for (int n = 1; n <= order && i + n <= sentence.count(); ++n) {
+                    key = (key << bits) | (sentence.at(i + n - 1) + 1);
+                    counts[n - 1][key]++;
+                }
+            }
+        }
+        return counts;
+    }
+};
+
+// Modified Kneser-Ney discounts D1, D2 and D3+ (Chen & Goodman 1998), estimated from the counts of counts
+void estimateDiscounts(const NGramCounts &counts, double discounts[4])
+{
+    double countOfCounts[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    for (NGramCounts::const_iterator it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        if (it.value() >= 1 && it.value() <= 4) countOfCounts[it.value()] += 1.0;
+    }
+    double y = (countOfCounts[1] + 2.0 * countOfCounts[2] > 0.0) ?
+                countOfCounts[1] / (countOfCounts[1] + 2.0 * countOfCounts[2]) : 0.5;
+    discounts[0] = 0.0;
+    for (int k = 1; k <= 3; ++k) {
+        discounts[k] = (countOfCounts[k] > 0.0) ?
+                    k - (k + 1) * y * countOfCounts[k + 1] / countOfCounts[k] : 0.0;
+        // Too few n-grams to estimate the discount (typical for small, biased models): use a default
+        if (!(discounts[k] > 0.0 && discounts[k] < k)) discounts[k] = 0.5 * k;
+    }
+}
+
+struct ContextStatistics {
+    ContextStatistics() : total(0.0), discounted(0.0) {}
+    double total;
+    double discounted;
+};
+
+} // namespace
+
+int SphinxLanguageModelBuilder::order() const
+{
+    return d->order;
+}
+
+void SphinxLanguageModelBuilder::setOrder(int order)
+{
+    if (order < 1) return;
+    // Keys need at least 2 bits per word, to tell <s> and </s> apart
+    if (order > 32) order = 32;
+    if (order == d->order) return;
+    d->order = order;
+    clearCounts();
+}
+
+void SphinxLanguageModelBuilder::clearCounts()
+{
+    d->words.clear();
+    d->wordIDs.clear();
+    d->words << "<s>" << "</s>";
+    d->wordIDs.insert("<s>", 0);
+    d->wordIDs.insert("</s>", 1);
+    d->counts = QVector<NGramCounts>(d->order);
+}
+
+int SphinxLanguageModelBuilder::vocabularySize() const
+{
+    return d->words.count();
+}
+
+bool SphinxLanguageModelBuilder::addUtterances(const QStringList &normalisedUtterances)
+{
+    quint32 maxWordID = static_cast<quint32>((Q_UINT64_C(1) << bitsPerWord(d->order)) - 2);
+    // Map words to IDs
+    QList<QVector<quint32> > sentences;
+    foreach (QString utterance, normalisedUtterances) {
+        QStringList tokens = utterance.split(" ", Qt::SkipEmptyParts);
+        if (tokens.isEmpty()) continue;
+        if (tokens.first() != "<s>") tokens.prepend("<s>");
+        if (tokens.last() != "</s>") tokens.append("</s>");
+        if (tokens.count() < 3) continue;
+        QVector<quint32> sentence;
+        sentence.reserve(tokens.count());
+        foreach (QString token, tokens) {
+            QHash<QString, quint32>::const_iterator it = d->wordIDs.constFind(token);
+            if (it != d->wordIDs.constEnd()) {
+                sentence << it.value();
+                continue;
+            }
+            if (static_cast<quint32>(d->words.count()) > maxWordID) {
+                emit printMessage(QString("Vocabulary too large for a %1-gram model (maximum %2 words)")
+                                  .arg(d->order).arg(maxWordID + 1));
+                return false;
+            }
+            quint32 wordID = static_cast<quint32>(d->words.count());
+            d->words << token;
+            d->wordIDs.insert(token, wordID);
+            sentence << wordID;
+        }
+        sentences << sentence;
+    }
+    if (sentences.isEmpty()) return true;
+    // Count n-grams in parallel, over blocks of sentences, and merge the counts
+    int blockCount = qBound(1, sentences.count() / 256, QThread::idealThreadCount() * 4);
+    QList<QList<QVector<quint32> > > blocks;
+    for (int b = 0; b < blockCount; ++b) {
+        blocks << sentences.mid(sentences.count() * b / blockCount,
+                                sentences.count() * (b + 1) / blockCount - sentences.count() * b / blockCount);
+    }
+    QList<QVector<NGramCounts> > partialCounts =
+            QtConcurrent::blockingMapped<QList<QVector<NGramCounts> > >(blocks, CountNGramsStep(d->order));
+    foreach (const QVector<NGramCounts> &partial, partialCounts) {
+        for (int n = 0; n < d->order; ++n) {
+            if (d->counts[n].isEmpty()) {
+                d->counts[n] = partial.at(n);
+                continue;
+            }
+            for (NGramCounts::const_iterator it = partial.at(n).constBegin(); it != partial.at(n).constEnd(); ++it)
+                d->counts[n][it.key()] += it.value();
+        }
+    }
+    return true;
+}
+
+bool SphinxLanguageModelBuilder::addAnnotation(CorpusAnnotation *annotation)
+{
+    return addUtterances(getNormalisedUtterances(annotation));
+}
+
+// ====================================================================================================================
+// Interpolated modified Kneser-Ney smoothing and output
+// ====================================================================================================================
+
+bool SphinxLanguageModelBuilder::writeARPA(const QString &filename)
+{
+    int order = d->order;
+    int bits = bitsPerWord(order);
+    if (d->counts.isEmpty() || d->counts.first().isEmpty()) {
+        emit printMessage("No utterances to build the language model from");
+        return false;
+    }
+    // Adjusted counts: raw counts for the highest order and for n-grams starting with <s>, and continuation counts
+    // (number of distinct words preceding the n-gram) for the others
+    QVector<NGramCounts> adjusted(order);
+    adjusted[order - 1] = d->counts.at(order - 1);
+    for (int n = order - 1; n >= 1; --n) {
+        NGramCounts &counts = adjusted[n - 1];
+        for (NGramCounts::const_iterator it = d->counts.at(n - 1).constBegin(); it != d->counts.at(n - 1).constEnd(); ++it) {
+            if (firstWord(it.key(), bits, n) == 0) counts.insert(it.key(), it.value());
+        }
+        quint64 mask = lastWordsMask(bits, n);
+        for (NGramCounts::const_iterator it = d->counts.at(n).constBegin(); it != d->counts.at(n).constEnd(); ++it) {
+            quint64 suffix = it.key() & mask;
+            if (firstWord(suffix, bits, n) != 0) counts[suffix]++;
+        }
+    }
+    adjusted[0].remove(1); // <s> is never predicted
+
+    // Probabilities and backoff weights, from the lowest order up. The probability of an n-gram is interpolated
+    // with the probability of its suffix; the interpolation weight of a context is its backoff weight in ARPA.
+    QVector<QHash<quint64, double> > probabilities(order);
+    QVector<QHash<quint64, double> > backoffs(order);
+    int vocabularySize = d->words.count() - 1;
+    for (int n = 1; n <= order; ++n) {
+        double discounts[4];
+        estimateDiscounts(adjusted.at(n - 1), discounts);
+        QHash<quint64, ContextStatistics> contexts;
+        for (NGramCounts::const_iterator it = adjusted.at(n - 1).constBegin(); it != adjusted.at(n - 1).constEnd(); ++it) {
+            ContextStatistics &context = contexts[(n > 1) ? (it.key() >> bits) : 0];
+            context.total += it.value();
+            context.discounted += discounts[qMin<quint32>(it.value(), 3)];
+        }
+        quint64 mask = lastWordsMask(bits, n - 1);
+        for (NGramCounts::const_iterator it = adjusted.at(n - 1).constBegin(); it != adjusted.at(n - 1).constEnd(); ++it) {
+            const ContextStatistics &context = contexts[(n > 1) ? (it.key() >> bits) : 0];
+            double lower = (n > 1) ? probabilities.at(n - 2).value(it.key() & mask) : 1.0 / vocabularySize;
+            double p = (it.value() - discounts[qMin<quint32>(it.value(), 3)]) / context.total +
+                    context.discounted / context.total * lower;
+            probabilities[n - 1].insert(it.key(), p);
+        }
+        if (n > 1) {
+            for (QHash<quint64, ContextStatistics>::const_iterator it = contexts.constBegin(); it != contexts.constEnd(); ++it)
+                backoffs[n - 2].insert(it.key(), it.value().discounted / it.value().total);
+        }
+    }
+    probabilities[0].insert(1, 0.0);
+
+    // Write ARPA file, with n-grams sorted by word IDs
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        emit printMessage(QString("Cannot write to %1").arg(filename));
+        return false;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << "\\data\\\n";
+    for (int n = 1; n <= order; ++n)
+        out << QString("ngram %1=%2\n").arg(n).arg(probabilities.at(n - 1).count());
+    for (int n = 1; n <= order; ++n) {
+        out << QString("\n\\%1-grams:\n").arg(n);
+        QList<quint64> keys = probabilities.at(n - 1).keys();
+        std::sort(keys.begin(), keys.end());
+        foreach (quint64 key, keys) {
+            double p = probabilities.at(n - 1).value(key);
+            out << ((p > 0.0) ? QString::number(log10(p), 'f', 6) : QString("-99.000000"));
+            out << "\t";
+            for (int i = n; i >= 1; --i) {
+                out << d->words.at(firstWord(key & lastWordsMask(bits, i), bits, i));
+                if (i > 1) out << " ";
+            }
+            if (n < order && backoffs.at(n - 1).contains(key))
+                out << "\t" << QString::number(log10(backoffs.at(n - 1).value(key)), 'f', 6);
+            out << "\n";
+        }
+    }
+    out << "\n\\end\\\n";
+    file.close();
+    return true;
+}
+
+bool SphinxLanguageModelBuilder::writeBinary(const QString &filename)
+{
+    QTemporaryFile fileARPA;
+    if (!fileARPA.open()) return false;
+    fileARPA.close();
+    if (!writeARPA(fileARPA.fileName())) return false;
+    logmath_t *lmath = logmath_init(1.0001, 0, 0);
+    ngram_model_t *model = ngram_model_read(nullptr, fileARPA.fileName().toLocal8Bit().constData(), NGRAM_ARPA, lmath);
+    if (!model) {
+        logmath_free(lmath);
+        emit printMessage("Could not read the ARPA language model");
+        return false;
+    }
+    int32 result = ngram_model_write(model, filename.toLocal8Bit().constData(), NGRAM_BIN);
+    ngram_model_free(model);
+    logmath_free(lmath);
+    return (result == 0);
+}
+
 } // namespace ASR
 } // namespace Praaline
@@ -30,15 +30,18 @@ bool SyllabifierEasy::syllabify(IntervalTier *tier_phone, IntervalTier *tier_syl
     if (!tier_phone) return false;
     if (!tier_syll) return false;
     if (from > to) return false;
+    // Clone the phones by index, without an intermediate list of them
+    QPair<int, int> indices = tier_phone->getIntervalIndexesContainedIn(from, to);
+    if ((indices.first < 0) || (indices.second < indices.first)) return false;
     QList<Interval *> phones;
-    foreach (Interval *intv, tier_phone->getIntervalsContainedIn(from, to))
-        phones << intv->clone();
-    if (phones.isEmpty()) return false;
+    phones.reserve(indices.second - indices.first + 1);
+    for (int i = indices.first; i <= indices.second; ++i)
+        phones << tier_phone->at(i)->clone();
     if (!tier_syll->patchIntervals(phones, from, to)) {
         qDeleteAll(phones);
         return false;
     }
-    QPair<int, int> indices = tier_syll->getIntervalIndexesContainedIn(from, to);
+    indices = tier_syll->getIntervalIndexesContainedIn(from, to);
     if ((indices.first < 0) || (indices.second < 0)) return false;
 
     int current = indices.second;
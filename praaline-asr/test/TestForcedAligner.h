@@ -0,0 +1,129 @@
+#ifndef TEST_FORCEDALIGNER_H
+#define TEST_FORCEDALIGNER_H
+
+#include "PraalineCore/Annotation/Interval.h"
+#include "PraalineCore/Annotation/IntervalTier.h"
+#include "PraalineASR/ForcedAligner.h"
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+using namespace Praaline::Core;
+using namespace Praaline::ASR;
+
+// Gives one phone per token and records the start of each utterance passed to alignTokens
+class RecordingForcedAligner : public ForcedAligner
+{
+public:
+    QList<double> alignedFrom;
+
+    bool alignTokens(const QString &waveFilepath, RealTime timeFrom, RealTime timeTo,
+                     IntervalTier *tierTokens, int &indexFrom, int &indexTo,
+                     bool insertLeadingAndTrailingPauses,
+                     QList<Interval *> &outPhonesList, QString &outAlignerOutput) override {
+        Q_UNUSED(waveFilepath) Q_UNUSED(timeTo) Q_UNUSED(insertLeadingAndTrailingPauses) Q_UNUSED(outAlignerOutput)
+        alignedFrom << timeFrom.toDouble();
+        for (int i = indexFrom; i <= indexTo; ++i) {
+            Interval *token = tierTokens->at(i);
+            if (token->isPauseSilent()) continue;
+            outPhonesList << new Interval(token->tMin(), token->tMax(), token->text());
+        }
+        return true;
+    }
+};
+
+// Incremental alignment must survive saving and reloading the tiers, which drops the hash attribute of utterances
+// whose level does not have it.
+class TestForcedAligner : public QObject
+{
+    Q_OBJECT
+
+    static IntervalTier *tier(const QString &name, const QStringList &texts, const QList<double> &boundaries) {
+        QList<Interval *> intervals;
+        for (int i = 0; i < texts.count(); ++i) {
+            Interval *intv = new Interval(RealTime::fromSeconds(boundaries.at(i)), RealTime::fromSeconds(boundaries.at(i + 1)), texts.at(i));
+            if (name == "tok_min" && texts.at(i) != "_") intv->setAttribute("phonetisation", texts.at(i));
+            intervals << intv;
+        }
+        return new IntervalTier(name, intervals, RealTime::fromSeconds(boundaries.first()), RealTime::fromSeconds(boundaries.last()));
+    }
+
+    // What a repository gives back: texts, boundaries and the token phonetisations, but no utterance hashes
+    static IntervalTier *reload(IntervalTier *saved) {
+        QStringList texts;
+        QList<double> boundaries;
+        boundaries << saved->tMin().toDouble();
+        for (int i = 0; i < saved->count(); ++i) {
+            texts << saved->at(i)->text();
+            boundaries << saved->at(i)->tMax().toDouble();
+        }
+        return tier(saved->name(), texts, boundaries);
+    }
+
+    static IntervalTier *utterances() {
+        return tier("utterance", QStringList() << "_" << "a b" << "_" << "c d" << "_" << "e f" << "_",
+                    QList<double>() << 0 << 1 << 3 << 4 << 6 << 7 << 9 << 10);
+    }
+
+    static IntervalTier *tokens() {
+        return tier("tok_min", QStringList() << "_" << "a" << "b" << "_" << "c" << "d" << "_" << "e" << "f" << "_",
+                    QList<double>() << 0 << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10);
+    }
+
+private slots:
+    void realignsOnlyEditedUtterancesAfterReload() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString filename = dir.path() + "/align_hashes.txt";
+        QScopedPointer<IntervalTier> tierUtterances(utterances()), tierTokens(tokens());
+        QScopedPointer<IntervalTier> tierPhones(new IntervalTier("phone", RealTime::zeroTime, RealTime::fromSeconds(10)));
+        {
+            RecordingForcedAligner aligner;
+            aligner.setUtteranceHashesFilename(filename);
+            aligner.setAnnotationContext("annotation", "speaker");
+            aligner.alignAllUtterances("recording.wav", tierUtterances.data(), tierTokens.data(), tierPhones.data());
+            QCOMPARE(aligner.alignedFrom.count(), 3);
+        }
+        // Save and reload, then edit the second utterance
+        QScopedPointer<IntervalTier> reloadedUtterances(reload(tierUtterances.data()));
+        QScopedPointer<IntervalTier> reloadedTokens(reload(tierTokens.data()));
+        QScopedPointer<IntervalTier> reloadedPhones(reload(tierPhones.data()));
+        QVERIFY(reloadedUtterances->at(1)->attribute("align_hash").toString().isEmpty());
+        int indexEdited = reloadedTokens->intervalIndexAtTime(RealTime::fromSeconds(4.5));
+        reloadedTokens->at(indexEdited)->setText("x");
+        reloadedTokens->at(indexEdited)->setAttribute("phonetisation", "x");
+        {
+            RecordingForcedAligner aligner;
+            aligner.setUtteranceHashesFilename(filename);
+            aligner.setAnnotationContext("annotation", "speaker");
+            aligner.alignAllUtterances("recording.wav", reloadedUtterances.data(), reloadedTokens.data(), reloadedPhones.data());
+            QCOMPARE(aligner.alignedFrom, QList<double>() << 4.0);
+        }
+    }
+
+    void hashesAreKeptPerSpeaker() {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString filename = dir.path() + "/align_hashes.txt";
+        QScopedPointer<IntervalTier> tierUtterances(utterances()), tierTokens(tokens());
+        QScopedPointer<IntervalTier> tierPhones(new IntervalTier("phone", RealTime::zeroTime, RealTime::fromSeconds(10)));
+        {
+            RecordingForcedAligner aligner;
+            aligner.setUtteranceHashesFilename(filename);
+            aligner.setAnnotationContext("annotation", "speaker");
+            aligner.alignAllUtterances("recording.wav", tierUtterances.data(), tierTokens.data(), tierPhones.data());
+        }
+        QScopedPointer<IntervalTier> reloadedUtterances(reload(tierUtterances.data()));
+        QScopedPointer<IntervalTier> reloadedTokens(reload(tierTokens.data()));
+        QScopedPointer<IntervalTier> reloadedPhones(reload(tierPhones.data()));
+        RecordingForcedAligner aligner;
+        aligner.setUtteranceHashesFilename(filename);
+        aligner.setAnnotationContext("annotation", "other speaker");
+        aligner.alignAllUtterances("recording.wav", reloadedUtterances.data(), reloadedTokens.data(), reloadedPhones.data());
+        QCOMPARE(aligner.alignedFrom.count(), 3);
+    }
+};
+
+#endif // TEST_FORCEDALIGNER_H
@@ -0,0 +1,40 @@
+TEMPLATE = app
+
+CONFIG( debug, debug|release ) {
+    COMPONENTSPATH = build/debug
+    ASRLIB = praaline-asrd
+} else {
+    COMPONENTSPATH = build/release
+    ASRLIB = praaline-asr
+}
+
+DEFINES += USE_NAMESPACE_PRAALINE_CORE USE_NAMESPACE_PRAALINE_ASR
+INCLUDEPATH += ../include ../../praaline-core/include
+DEPENDPATH += ../include
+
+LIBS += -L../$${COMPONENTSPATH} -l$${ASRLIB} \
+        -L../../praaline-media/$${COMPONENTSPATH} -lpraaline-media$${PRAALINE_LIB_POSTFIX} \
+        -L../../praaline-core/$${COMPONENTSPATH} -lpraaline-core$${PRAALINE_LIB_POSTFIX}
+
+CONFIG += qt thread warn_on stl rtti exceptions console c++11
+QT += concurrent testlib
+QT -= gui
+
+TARGET = asr-test
+
+OBJECTS_DIR = o
+MOC_DIR = o
+
+HEADERS += TestForcedAligner.h
+SOURCES += main.cpp
+
+!win32 {
+    !macx* {
+        QMAKE_POST_LINK=./$${TARGET}
+    }
+    macx* {
+        QMAKE_POST_LINK=./$${TARGET}.app/Contents/MacOS/$${TARGET}
+    }
+}
+
+win32:QMAKE_POST_LINK=./release/$${TARGET}.exe
@@ -0,0 +1,373 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef _CHUNKED_SORTED_LIST_H_
+#define _CHUNKED_SORTED_LIST_H_
+
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+
+/**
+ * Sorted container with the interface of std::multiset (for the
+ * operations used by the sparse models), storing its items in
+ * contiguous chunks of at most 2 * ChunkSize items.
+ *
+ * Chunks are shared between copies and copied on write, so copying a
+ * list, or a range of it (see the range constructor), copies no items
+ * until one of the lists is modified, and then only the chunk that
+ * changes. Positional access (at, indexOf) takes O(log n).
+ *
+ * Unlike std::multiset, any modification invalidates the iterators
+ * of the list that is modified (but not those of its copies). Items
+ * cannot be modified through iterators.
+ */
+template <typename Item, typename Compare = std::less<Item> >
+class ChunkedSortedList
+{
+public:
+    enum { ChunkSize = 512 };
+
+    typedef Item value_type;
+    typedef Item key_type;
+    typedef Compare key_compare;
+    typedef const Item &reference;
+    typedef const Item &const_reference;
+    typedef const Item *pointer;
+    typedef const Item *const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef Item value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Item *pointer;
+        typedef const Item &reference;
+
+        const_iterator() : m_list(0), m_chunk(0), m_offset(0) { }
+
+        reference operator*() const {
+            return m_list->m_chunks[m_chunk].at(m_offset);
+        }
+        pointer operator->() const { return &(operator*()); }
+
+        const_iterator &operator++() {
+            if (++m_offset == m_list->m_chunks[m_chunk].size()) {
+                ++m_chunk;
+                m_offset = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator i(*this); ++(*this); return i;
+        }
+        const_iterator &operator--() {
+            if (m_offset == 0) {
+                --m_chunk;
+                m_offset = m_list->m_chunks[m_chunk].size() - 1;
+            } else {
+                --m_offset;
+            }
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator i(*this); --(*this); return i;
+        }
+
+        bool operator==(const const_iterator &i) const {
+            return m_chunk == i.m_chunk && m_offset == i.m_offset &&
+                m_list == i.m_list;
+        }
+        bool operator!=(const const_iterator &i) const {
+            return !(*this == i);
+        }
+
+    private:
+        friend class ChunkedSortedList;
+        const_iterator(const ChunkedSortedList *list, int chunk, int offset) :
+            m_list(list), m_chunk(chunk), m_offset(offset) { }
+
+        const ChunkedSortedList *m_list;
+        int m_chunk;
+        int m_offset;
+    };
+
+    typedef const_iterator iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef const_reverse_iterator reverse_iterator;
+
+    ChunkedSortedList() : m_size(0) {
+        m_offsets.push_back(0);
+    }
+
+    /**
+     * Construct a list holding the items from first (inclusive) to
+     * last (exclusive) of another list, sharing its storage.
+     */
+    ChunkedSortedList(const_iterator first, const_iterator last) :
+        m_size(0) {
+        m_offsets.push_back(0);
+        if (first == last) return;
+        const ChunkedSortedList *other = first.m_list;
+        for (int c = first.m_chunk; c <= last.m_chunk; ++c) {
+            if (c == int(other->m_chunks.size())) break;
+            Chunk chunk(other->m_chunks[c]);
+            if (c == last.m_chunk) {
+                chunk.end = chunk.begin + last.m_offset;
+            }
+            if (c == first.m_chunk) {
+                chunk.begin += first.m_offset;
+            }
+            if (chunk.size() == 0) continue;
+            m_chunks.push_back(chunk);
+            m_size += chunk.size();
+            m_offsets.push_back(int(m_size));
+        }
+    }
+
+    size_type size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0, 0);
+    }
+    const_iterator end() const {
+        return const_iterator(this, int(m_chunks.size()), 0);
+    }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    const Item &front() const { return m_chunks.front().at(0); }
+    const Item &back() const {
+        const Chunk &c = m_chunks.back();
+        return c.at(c.size() - 1);
+    }
+
+    /**
+     * Return the item at the given index in sort order.
+     */
+    const Item &at(int index) const {
+        return *iteratorAt(index);
+    }
+
+    /**
+     * Return an iterator to the item at the given index, or end() if
+     * the index is out of range.
+     */
+    const_iterator iteratorAt(int index) const {
+        if (index < 0 || index >= int(m_size)) return end();
+        int c = int(std::upper_bound(m_offsets.begin(), m_offsets.end(), index)
+                    - m_offsets.begin()) - 1;
+        return const_iterator(this, c, index - m_offsets[c]);
+    }
+
+    /**
+     * Return the index of the item at the given iterator.
+     */
+    int indexOf(const_iterator i) const {
+        return m_offsets[i.m_chunk] + i.m_offset;
+    }
+
+    const_iterator lower_bound(const Item &item) const {
+        return lowerBound(item, m_compare);
+    }
+
+    const_iterator upper_bound(const Item &item) const {
+        return upperBound(item, m_compare);
+    }
+
+    /**
+     * Lower bound with a comparator other than the list's own, which
+     * must order the items in the same way: less(item, key) returns
+     * true for the items that sort before the key.
+     */
+    template <typename Key, typename Less>
+    const_iterator lowerBound(const Key &key, Less less) const {
+        int c = 0, n = int(m_chunks.size());
+        while (n > 0) {
+            int half = n / 2;
+            const Chunk &chunk = m_chunks[c + half];
+            if (less(chunk.at(chunk.size() - 1), key)) {
+                c += half + 1;
+                n -= half + 1;
+            } else {
+                n = half;
+            }
+        }
+        if (c == int(m_chunks.size())) return end();
+        const Chunk &chunk = m_chunks[c];
+        const Item *first = chunk.data->data() + chunk.begin;
+        const Item *i = std::lower_bound(first, first + chunk.size(), key, less);
+        return const_iterator(this, c, int(i - first));
+    }
+
+    /**
+     * Upper bound with a comparator other than the list's own:
+     * less(key, item) returns true for the items that sort after the
+     * key.
+     */
+    template <typename Key, typename Less>
+    const_iterator upperBound(const Key &key, Less less) const {
+        int c = 0, n = int(m_chunks.size());
+        while (n > 0) {
+            int half = n / 2;
+            const Chunk &chunk = m_chunks[c + half];
+            if (!less(key, chunk.at(chunk.size() - 1))) {
+                c += half + 1;
+                n -= half + 1;
+            } else {
+                n = half;
+            }
+        }
+        if (c == int(m_chunks.size())) return end();
+        const Chunk &chunk = m_chunks[c];
+        const Item *first = chunk.data->data() + chunk.begin;
+        const Item *i = std::upper_bound(first, first + chunk.size(), key, less);
+        return const_iterator(this, c, int(i - first));
+    }
+
+    /**
+     * Insert an item after any items that compare equal to it.
+     * Inserting items in order appends to the last chunk, in
+     * amortised constant time.
+     */
+    const_iterator insert(const Item &item) {
+        int c, offset;
+        if (m_chunks.empty()) {
+            Chunk chunk;
+            chunk.data = std::make_shared<std::vector<Item> >();
+            chunk.data->reserve(ChunkSize);
+            m_chunks.push_back(chunk);
+            m_offsets.push_back(0);
+            c = 0;
+            offset = 0;
+        } else if (!m_compare(item, back())) {
+            c = int(m_chunks.size()) - 1;
+            offset = m_chunks[c].size();
+        } else {
+            const_iterator i = upper_bound(item);
+            c = i.m_chunk;
+            offset = i.m_offset;
+        }
+        Chunk &chunk = detach(c);
+        chunk.data->insert(chunk.data->begin() + offset, item);
+        ++chunk.end;
+        ++m_size;
+        for (int k = c + 1; k < int(m_offsets.size()); ++k) ++m_offsets[k];
+        if (chunk.size() > 2 * ChunkSize) {
+            split(c);
+            if (offset >= ChunkSize) {
+                ++c;
+                offset -= ChunkSize;
+            }
+        }
+        return const_iterator(this, c, offset);
+    }
+
+    /**
+     * Remove the item at the given iterator, and return an iterator
+     * to the item that followed it.
+     */
+    const_iterator erase(const_iterator i) {
+        int c = i.m_chunk;
+        Chunk &chunk = detach(c);
+        chunk.data->erase(chunk.data->begin() + i.m_offset);
+        --chunk.end;
+        --m_size;
+        for (int k = c + 1; k < int(m_offsets.size()); ++k) --m_offsets[k];
+        if (chunk.size() == 0) {
+            m_chunks.erase(m_chunks.begin() + c);
+            m_offsets.erase(m_offsets.begin() + c + 1);
+            return const_iterator(this, c, 0);
+        }
+        if (i.m_offset == chunk.size()) {
+            return const_iterator(this, c + 1, 0);
+        }
+        return i;
+    }
+
+    void clear() {
+        m_chunks.clear();
+        m_offsets.clear();
+        m_offsets.push_back(0);
+        m_size = 0;
+    }
+
+    void swap(ChunkedSortedList &other) {
+        m_chunks.swap(other.m_chunks);
+        m_offsets.swap(other.m_offsets);
+        std::swap(m_size, other.m_size);
+    }
+
+private:
+    // A slice [begin, end) of a vector that may be shared with other
+    // lists
+    struct Chunk {
+        Chunk() : begin(0), end(0) { }
+        std::shared_ptr<std::vector<Item> > data;
+        int begin;
+        int end;
+        int size() const { return end - begin; }
+        const Item &at(int i) const { return (*data)[begin + i]; }
+    };
+
+    std::vector<Chunk> m_chunks;
+    // m_offsets[c] is the index of the first item of chunk c; the
+    // last element is the size of the list
+    std::vector<int> m_offsets;
+    size_type m_size;
+    Compare m_compare;
+
+    // Give chunk c a vector of its own, holding only its slice
+    Chunk &detach(int c) {
+        Chunk &chunk = m_chunks[c];
+        if (chunk.data.use_count() > 1 || chunk.begin != 0 ||
+            chunk.end != int(chunk.data->size())) {
+            std::shared_ptr<std::vector<Item> > data =
+                std::make_shared<std::vector<Item> >();
+            data->reserve(std::max(int(ChunkSize), chunk.size() + 1));
+            data->insert(data->end(),
+                         chunk.data->begin() + chunk.begin,
+                         chunk.data->begin() + chunk.end);
+            chunk.data = data;
+            chunk.begin = 0;
+            chunk.end = int(data->size());
+        }
+        return chunk;
+    }
+
+    void split(int c) {
+        Chunk second;
+        second.data = std::make_shared<std::vector<Item> >
+            (m_chunks[c].data->begin() + ChunkSize, m_chunks[c].data->end());
+        second.end = int(second.data->size());
+        Chunk &first = m_chunks[c];
+        first.data->erase(first.data->begin() + ChunkSize, first.data->end());
+        first.end = ChunkSize;
+        m_chunks.insert(m_chunks.begin() + c + 1, second);
+        m_offsets.insert(m_offsets.begin() + c + 1, m_offsets[c] + ChunkSize);
+    }
+};
+
+#endif
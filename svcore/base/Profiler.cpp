@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include "Profiler.h"
+#include "Trace.h"
 
 #include <cstdio>
 
@@ -184,6 +185,8 @@ Profiler::Profiler(const char* c, bool showOnDestruct) :
     struct timeval tv;
     (void)gettimeofday(&tv, 0);
     m_startTime = RealTime::fromTimeval(tv);
+
+    m_traceStart = Trace::now();
 }
 
 void
@@ -216,6 +219,9 @@ Profiler::end()
 
     Profiles::getInstance()->accumulate(m_c, elapsedCPU, elapsedTime);
 
+    Trace::recordSpan("profiler", m_c, m_traceStart,
+                      Trace::now() - m_traceStart);
+
     if (m_showOnDestruct)
         cerr << "Profiler : id = " << m_c
              << " - elapsed = " << ((elapsedCPU * 1000) / CLOCKS_PER_SEC)
@@ -92,7 +92,8 @@ public:
      * true, the time consumed will be printed to stderr when the
      * object is destroyed; otherwise, only the accumulated, mean and
      * worst-case times will be shown when the program exits or
-     * Profiles::dump() is called.
+     * Profiles::dump() is called. The call is also recorded as a
+     * span in the "profiler" category when Trace is enabled.
      */
     Profiler(const char *name, bool showOnDestruct = false);
     ~Profiler();
@@ -104,6 +105,7 @@ protected:
     const char* m_c;
     clock_t m_startCPU;
     RealTime m_startTime;
+    qint64 m_traceStart;
     bool m_showOnDestruct;
     bool m_ended;
 };
@@ -0,0 +1,452 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#include "Trace.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+#include <QFile>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include <chrono>
+#include <vector>
+#include <set>
+#include <string>
+#include <algorithm>
+
+static_assert((Trace::BufferCapacity & (Trace::BufferCapacity - 1)) == 0,
+              "Trace buffer capacity must be a power of two");
+
+std::atomic<bool> Trace::m_enabled(false);
+
+namespace {
+
+// Ring buffer of one thread. Only the owning thread writes events
+// and advances the write count; readers take the registry mutex
+// and copy the events behind the write count.
+struct TraceBuffer
+{
+    TraceBuffer(int id) :
+        id(id), written(0), clearedAt(0), retired(false),
+        events(Trace::BufferCapacity) { }
+
+    int id;
+    QString name;                   // guarded by the registry mutex
+    std::atomic<quint64> written;
+    quint64 clearedAt;              // guarded by the registry mutex
+    bool retired;                   // guarded by the registry mutex
+    std::vector<Trace::Event> events;
+};
+
+struct TraceRegistry
+{
+    TraceRegistry() : nextThread(1) { }
+
+    QMutex mutex;
+    std::vector<TraceBuffer *> buffers;
+    std::set<std::string> strings;
+    QList<TraceCounter *> counters;
+    int nextThread;
+};
+
+// Never destroyed, so that threads finishing during static
+// destruction can still retire their buffers
+TraceRegistry &
+registry()
+{
+    static TraceRegistry *r = new TraceRegistry();
+    return *r;
+}
+
+// The buffers of threads that have finished are kept so that their
+// events can still be exported, up to this number
+const int MaxRetiredBuffers = 16;
+
+void
+pruneRetired(TraceRegistry &r)
+{
+    int retired = 0;
+    for (size_t i = 0; i < r.buffers.size(); ++i) {
+        if (r.buffers[i]->retired) ++retired;
+    }
+    std::vector<TraceBuffer *>::iterator i = r.buffers.begin();
+    while (retired > MaxRetiredBuffers && i != r.buffers.end()) {
+        if ((*i)->retired) {
+            delete *i;
+            i = r.buffers.erase(i);
+            --retired;
+        } else {
+            ++i;
+        }
+    }
+}
+
+struct TraceThreadState
+{
+    TraceThreadState() : buffer(0) { }
+
+    ~TraceThreadState() {
+        if (!buffer) return;
+        TraceRegistry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        buffer->retired = true;
+        pruneRetired(r);
+    }
+
+    TraceBuffer *buffer;
+    QString name;
+};
+
+thread_local TraceThreadState threadState;
+
+// The buffer is only allocated when the thread first records an
+// event, so threads are not charged for it while tracing is off
+TraceBuffer *
+currentBuffer()
+{
+    if (threadState.buffer) return threadState.buffer;
+
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    TraceBuffer *buffer = new TraceBuffer(r.nextThread++);
+    buffer->name = threadState.name;
+    if (buffer->name.isEmpty()) {
+        QThread *thread = QThread::currentThread();
+        if (thread) buffer->name = thread->objectName();
+    }
+    r.buffers.push_back(buffer);
+    threadState.buffer = buffer;
+    return buffer;
+}
+
+void
+append(Trace::Event::Type type, const char *category, const char *name,
+       qint64 start, qint64 duration, qint64 value)
+{
+    TraceBuffer *buffer = currentBuffer();
+    quint64 n = buffer->written.load(std::memory_order_relaxed);
+    Trace::Event &e = buffer->events[n & (Trace::BufferCapacity - 1)];
+    e.type = type;
+    e.category = category;
+    e.name = name;
+    e.start = start;
+    e.duration = duration;
+    e.value = value;
+    e.thread = buffer->id;
+    buffer->written.store(n + 1, std::memory_order_release);
+}
+
+QString
+threadNameLocked(TraceRegistry &r, int thread)
+{
+    for (size_t i = 0; i < r.buffers.size(); ++i) {
+        if (r.buffers[i]->id == thread && !r.buffers[i]->name.isEmpty()) {
+            return r.buffers[i]->name;
+        }
+    }
+    return QString("Thread %1").arg(thread);
+}
+
+bool
+eventStartsBefore(const Trace::Event &a, const Trace::Event &b)
+{
+    return a.start < b.start;
+}
+
+} // namespace
+
+void
+Trace::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64
+Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *
+Trace::intern(const QString &s)
+{
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    return r.strings.insert(s.toStdString()).first->c_str();
+}
+
+void
+Trace::setThreadName(const QString &name)
+{
+    threadState.name = name;
+    if (threadState.buffer) {
+        TraceRegistry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        threadState.buffer->name = name;
+    }
+}
+
+void
+Trace::recordSpan(const char *category, const char *name,
+                  qint64 start, qint64 duration)
+{
+    if (!isEnabled()) return;
+    append(Event::Span, category, name, start, duration, 0);
+}
+
+void
+Trace::recordInstant(const char *category, const char *name)
+{
+    if (!isEnabled()) return;
+    append(Event::Instant, category, name, now(), 0, 0);
+}
+
+void
+Trace::recordCounter(const char *category, const char *name, qint64 value)
+{
+    if (!isEnabled()) return;
+    append(Event::Counter, category, name, now(), 0, value);
+}
+
+void
+Trace::clear()
+{
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    std::vector<TraceBuffer *>::iterator i = r.buffers.begin();
+    while (i != r.buffers.end()) {
+        if ((*i)->retired) {
+            delete *i;
+            i = r.buffers.erase(i);
+        } else {
+            (*i)->clearedAt = (*i)->written.load(std::memory_order_acquire);
+            ++i;
+        }
+    }
+}
+
+QList<Trace::Event>
+Trace::events()
+{
+    const quint64 capacity = BufferCapacity;
+    std::vector<Event> all;
+
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+
+    for (size_t b = 0; b < r.buffers.size(); ++b) {
+        TraceBuffer *buffer = r.buffers[b];
+        quint64 end = buffer->written.load(std::memory_order_acquire);
+        quint64 begin = (end > capacity ? end - capacity : 0);
+        if (begin < buffer->clearedAt) begin = buffer->clearedAt;
+        std::vector<Event> copied;
+        for (quint64 i = begin; i < end; ++i) {
+            copied.push_back(buffer->events[i & (capacity - 1)]);
+        }
+        // The owning thread carries on writing while we copy: drop
+        // the events it may have overwritten in the meantime,
+        // including the slot it may be writing now
+        quint64 after = buffer->written.load(std::memory_order_acquire);
+        quint64 valid = (after + 1 > capacity ? after + 1 - capacity : 0);
+        quint64 skip = (valid > begin ? std::min(valid - begin, end - begin) : 0);
+        all.insert(all.end(), copied.begin() + skip, copied.end());
+    }
+
+    locker.unlock();
+
+    std::stable_sort(all.begin(), all.end(), eventStartsBefore);
+    QList<Event> result;
+    result.reserve(int(all.size()));
+    for (size_t i = 0; i < all.size(); ++i) result.push_back(all[i]);
+    return result;
+}
+
+QString
+Trace::threadName(int thread)
+{
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    return threadNameLocked(r, thread);
+}
+
+QList<Trace::SpanSummary>
+Trace::summary()
+{
+    QMap<QPair<QString, QString>, SpanSummary> summaries;
+    foreach (const Event &e, events()) {
+        if (e.type != Event::Span) continue;
+        QPair<QString, QString> key(e.category, e.name);
+        if (!summaries.contains(key)) {
+            SpanSummary s;
+            s.category = e.category;
+            s.name = e.name;
+            s.count = 0;
+            s.total = 0;
+            s.maximum = 0;
+            summaries.insert(key, s);
+        }
+        SpanSummary &s = summaries[key];
+        s.count++;
+        s.total += e.duration;
+        if (e.duration > s.maximum) s.maximum = e.duration;
+    }
+    return summaries.values();
+}
+
+QByteArray
+Trace::toChromeTraceJSON()
+{
+    QList<Event> recorded = events();
+    qint64 pid = QCoreApplication::applicationPid();
+    // Timestamps are in microseconds, from the first recorded event
+    qint64 origin = (recorded.isEmpty() ? 0 : recorded.first().start);
+
+    QJsonArray traceEvents;
+    QSet<int> threads;
+
+    foreach (const Event &e, recorded) {
+        QJsonObject o;
+        o.insert("name", QString(e.name));
+        o.insert("cat", QString(e.category));
+        o.insert("pid", double(pid));
+        o.insert("tid", e.thread);
+        o.insert("ts", double(e.start - origin) / 1000.0);
+        switch (e.type) {
+        case Event::Span:
+            o.insert("ph", QString("X"));
+            o.insert("dur", double(e.duration) / 1000.0);
+            break;
+        case Event::Instant:
+            o.insert("ph", QString("i"));
+            o.insert("s", QString("t"));
+            break;
+        case Event::Counter: {
+            o.insert("ph", QString("C"));
+            QJsonObject args;
+            args.insert("value", double(e.value));
+            o.insert("args", args);
+            break;
+        }
+        }
+        traceEvents.append(o);
+        threads.insert(e.thread);
+    }
+
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    foreach (int thread, threads) {
+        QJsonObject o;
+        o.insert("name", QString("thread_name"));
+        o.insert("ph", QString("M"));
+        o.insert("pid", double(pid));
+        o.insert("tid", thread);
+        QJsonObject args;
+        args.insert("name", threadNameLocked(r, thread));
+        o.insert("args", args);
+        traceEvents.append(o);
+    }
+    locker.unlock();
+
+    QJsonObject process;
+    process.insert("name", QString("process_name"));
+    process.insert("ph", QString("M"));
+    process.insert("pid", double(pid));
+    QJsonObject processArgs;
+    processArgs.insert("name", QCoreApplication::applicationName());
+    process.insert("args", processArgs);
+    traceEvents.append(process);
+
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", QString("ms"));
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool
+Trace::saveChromeTrace(QString filename, QString &error)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = QString("Failed to open %1 for writing: %2")
+            .arg(filename).arg(file.errorString());
+        return false;
+    }
+    QByteArray json = toChromeTraceJSON();
+    if (file.write(json) != json.size()) {
+        error = QString("Failed to write %1: %2")
+            .arg(filename).arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+TraceCounter::TraceCounter(const char *category, const char *name) :
+    m_category(category),
+    m_name(name),
+    m_value(0)
+{
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    r.counters.append(this);
+}
+
+QList<TraceCounter *>
+TraceCounter::all()
+{
+    // Make sure the standard counters are listed even before use
+    processesLaunched();
+    bytesRead();
+    tiersLoaded();
+    tiersSaved();
+
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    return r.counters;
+}
+
+TraceCounter &
+TraceCounter::processesLaunched()
+{
+    static TraceCounter counter("process", "processes launched");
+    return counter;
+}
+
+TraceCounter &
+TraceCounter::bytesRead()
+{
+    static TraceCounter counter("io", "bytes read");
+    return counter;
+}
+
+TraceCounter &
+TraceCounter::tiersLoaded()
+{
+    static TraceCounter counter("annotation", "tiers loaded");
+    return counter;
+}
+
+TraceCounter &
+TraceCounter::tiersSaved()
+{
+    static TraceCounter counter("annotation", "tiers saved");
+    return counter;
+}
@@ -0,0 +1,169 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+
+#include <atomic>
+
+/**
+ * Tracing of hot paths, available in release builds as well as in
+ * debug builds (unlike Profiler, which is compiled out when
+ * NO_TIMING is defined).
+ *
+ * Events are written to a ring buffer owned by the calling thread,
+ * so recording takes no lock; when a buffer is full its oldest
+ * events are overwritten. Recording is off by default, and a
+ * TraceSpan costs a single relaxed atomic load while it is off.
+ *
+ * Category and event name strings are not copied: use string
+ * literals, or Trace::intern() for names built at run time.
+ *
+ * The recorded events can be exported in the Chrome trace event
+ * format (chrome://tracing, Perfetto).
+ */
+class Trace
+{
+public:
+    struct Event {
+        enum Type { Span, Instant, Counter };
+        Type type;
+        const char *category;
+        const char *name;
+        qint64 start;       // ns, as returned by Trace::now()
+        qint64 duration;    // ns, spans only
+        qint64 value;       // counters only
+        int thread;
+    };
+
+    struct SpanSummary {
+        QString category;
+        QString name;
+        int count;
+        qint64 total;       // ns
+        qint64 maximum;     // ns
+    };
+
+    /// Number of events kept for each thread
+    static const int BufferCapacity = 8192;
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Monotonic time in nanoseconds
+    static qint64 now();
+
+    /// Return a string that remains valid for the life of the process
+    static const char *intern(const QString &s);
+
+    /// Name shown for the calling thread in exported traces
+    static void setThreadName(const QString &name);
+
+    static void recordSpan(const char *category, const char *name,
+                           qint64 start, qint64 duration);
+    static void recordInstant(const char *category, const char *name);
+    static void recordCounter(const char *category, const char *name,
+                              qint64 value);
+
+    /// Discard the events recorded so far (counters are not reset)
+    static void clear();
+
+    /// The events still held in the buffers of all threads, by start time
+    static QList<Event> events();
+    static QString threadName(int thread);
+
+    /// Count, total and worst duration of the recorded spans
+    static QList<SpanSummary> summary();
+
+    static QByteArray toChromeTraceJSON();
+    static bool saveChromeTrace(QString filename, QString &error);
+
+private:
+    static std::atomic<bool> m_enabled;
+};
+
+/**
+ * Scoped span: records the time between construction and destruction
+ * against the given category and name, if tracing is enabled when
+ * the span is constructed.
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name) :
+        m_category(category),
+        m_name(name),
+        m_start(Trace::isEnabled() ? Trace::now() : -1) { }
+
+    ~TraceSpan() {
+        if (m_start >= 0) {
+            Trace::recordSpan(m_category, m_name, m_start,
+                              Trace::now() - m_start);
+        }
+    }
+
+private:
+    TraceSpan(const TraceSpan &);
+    TraceSpan &operator=(const TraceSpan &);
+
+    const char *m_category;
+    const char *m_name;
+    qint64 m_start;
+};
+
+/**
+ * Cumulative counter. Counting is always on (it is a relaxed atomic
+ * add); the running value is also recorded as a counter event when
+ * tracing is enabled, so that it appears on the exported timeline.
+ */
+class TraceCounter
+{
+public:
+    TraceCounter(const char *category, const char *name);
+
+    void add(qint64 delta) {
+        qint64 value = m_value.fetch_add(delta, std::memory_order_relaxed)
+            + delta;
+        if (Trace::isEnabled()) {
+            Trace::recordCounter(m_category, m_name, value);
+        }
+    }
+
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+    const char *category() const { return m_category; }
+    const char *name() const { return m_name; }
+
+    static QList<TraceCounter *> all();
+
+    static TraceCounter &processesLaunched();
+    static TraceCounter &bytesRead();
+    static TraceCounter &tiersLoaded();
+    static TraceCounter &tiersSaved();
+
+private:
+    TraceCounter(const TraceCounter &);
+    TraceCounter &operator=(const TraceCounter &);
+
+    const char *m_category;
+    const char *m_name;
+    std::atomic<qint64> m_value;
+};
+
+#endif
@@ -0,0 +1,161 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef TEST_CHUNKED_SORTED_LIST_H
+#define TEST_CHUNKED_SORTED_LIST_H
+
+#include "../ChunkedSortedList.h"
+
+#include <QObject>
+#include <QtTest>
+
+#include <set>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+class TestChunkedSortedList : public QObject
+{
+    Q_OBJECT
+
+    // Items compare by key only, so that the position of items with
+    // equal keys (after any existing ones) can be checked with id
+    struct Item {
+        Item(int k = 0, int i = 0) : key(k), id(i) { }
+        int key;
+        int id;
+    };
+    struct Less {
+        bool operator()(const Item &a, const Item &b) const {
+            return a.key < b.key;
+        }
+    };
+    typedef ChunkedSortedList<Item, Less> List;
+    typedef multiset<Item, Less> Reference;
+
+    // Deterministic pseudo-random sequence
+    unsigned m_state;
+    int next(int n) {
+        m_state = m_state * 1664525u + 1013904223u;
+        return int((m_state >> 8) % unsigned(n));
+    }
+
+    void compare(const List &list, const Reference &ref) {
+        QCOMPARE(list.size(), ref.size());
+        Reference::const_iterator j = ref.begin();
+        int index = 0;
+        for (List::const_iterator i = list.begin(); i != list.end(); ++i, ++j) {
+            QCOMPARE(i->key, j->key);
+            QCOMPARE(i->id, j->id);
+            QCOMPARE(list.indexOf(i), index);
+            QVERIFY(list.iteratorAt(index) == i);
+            ++index;
+        }
+        Reference::const_reverse_iterator rj = ref.rbegin();
+        for (List::const_reverse_iterator ri = list.rbegin(); ri != list.rend(); ++ri, ++rj) {
+            QCOMPARE(ri->id, rj->id);
+        }
+    }
+
+private slots:
+    void init() {
+        m_state = 42;
+    }
+
+    void empty() {
+        List list;
+        QVERIFY(list.empty());
+        QVERIFY(list.begin() == list.end());
+        QVERIFY(list.lower_bound(Item(1)) == list.end());
+        QVERIFY(list.iteratorAt(0) == list.end());
+        List range(list.begin(), list.end());
+        QVERIFY(range.empty());
+    }
+
+    void orderedAppend() {
+        List list;
+        int n = List::ChunkSize * 7 + 3;
+        for (int i = 0; i < n; ++i) list.insert(Item(i / 2, i));
+        QCOMPARE(int(list.size()), n);
+        for (int i = 0; i < n; i += 97) {
+            QCOMPARE(list.at(i).id, i);
+        }
+        QCOMPARE(list.front().id, 0);
+        QCOMPARE(list.back().id, n - 1);
+    }
+
+    void randomEdits() {
+        List list;
+        Reference ref;
+        for (int n = 0; n < 20000; ++n) {
+            if (next(3) < 2) {
+                Item item(next(2000), n);
+                List::const_iterator i = list.insert(item);
+                ref.insert(item);
+                QCOMPARE(i->id, n);
+            } else {
+                Item key(next(2000));
+                List::const_iterator i = list.lower_bound(key);
+                Reference::iterator j = ref.lower_bound(key);
+                QCOMPARE(i == list.end(), j == ref.end());
+                if (j == ref.end()) continue;
+                QCOMPARE(i->id, j->id);
+                i = list.erase(i);
+                j = ref.erase(j);
+                QCOMPARE(i == list.end(), j == ref.end());
+                if (j != ref.end()) QCOMPARE(i->id, j->id);
+            }
+        }
+        compare(list, ref);
+        Item key(1000);
+        QCOMPARE(list.indexOf(list.upper_bound(key)),
+                 int(distance(ref.begin(), ref.upper_bound(key))));
+    }
+
+    void copyOnWrite() {
+        List list;
+        Reference ref;
+        for (int n = 0; n < 5000; ++n) {
+            Item item(next(1000), n);
+            list.insert(item);
+            ref.insert(item);
+        }
+        List copy(list);
+        Reference refCopy(ref);
+        List range(list.lower_bound(Item(200)), list.upper_bound(Item(700)));
+        Reference refRange(ref.lower_bound(Item(200)), ref.upper_bound(Item(700)));
+        compare(range, refRange);
+
+        // Editing the original leaves the copies as they were, and
+        // editing a copy leaves the original as it is
+        for (int n = 0; n < 2000; ++n) {
+            Item item(next(1000), 10000 + n);
+            list.insert(item);
+            ref.insert(item);
+            list.erase(list.lower_bound(Item(item.key)));
+            ref.erase(ref.lower_bound(Item(item.key)));
+        }
+        for (int n = 0; n < 500; ++n) {
+            Item item(200 + next(500), 20000 + n);
+            range.insert(item);
+            refRange.insert(item);
+        }
+        compare(list, ref);
+        compare(copy, refCopy);
+        compare(range, refRange);
+    }
+};
+
+#endif
@@ -0,0 +1,183 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef TEST_TRACE_H
+#define TEST_TRACE_H
+
+#include "../Trace.h"
+
+#include <QObject>
+#include <QThread>
+#include <QSet>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtTest>
+
+#include <iostream>
+
+using namespace std;
+
+class TestTraceThread : public QThread
+{
+public:
+    TestTraceThread(int spans) : m_spans(spans) { }
+
+protected:
+    void run() {
+        Trace::setThreadName(QString("worker %1").arg(m_spans));
+        for (int i = 0; i < m_spans; ++i) {
+            TraceSpan span("test", "worker");
+        }
+    }
+
+private:
+    int m_spans;
+};
+
+class TestTrace : public QObject
+{
+    Q_OBJECT
+
+private:
+    QList<Trace::Event> testEvents() {
+        QList<Trace::Event> result;
+        foreach (const Trace::Event &e, Trace::events()) {
+            if (QString(e.category) == "test") result << e;
+        }
+        return result;
+    }
+
+private slots:
+    void init() {
+        Trace::setEnabled(true);
+        Trace::clear();
+    }
+
+    void cleanup() {
+        Trace::setEnabled(false);
+        Trace::clear();
+    }
+
+    void disabled() {
+        Trace::setEnabled(false);
+        {
+            TraceSpan span("test", "disabled");
+        }
+        Trace::recordInstant("test", "disabled");
+        QCOMPARE(testEvents().count(), 0);
+    }
+
+    void span() {
+        {
+            TraceSpan span("test", "span");
+        }
+        QList<Trace::Event> events = testEvents();
+        QCOMPARE(events.count(), 1);
+        QCOMPARE(events[0].type, Trace::Event::Span);
+        QCOMPARE(QString(events[0].name), QString("span"));
+        QVERIFY(events[0].duration >= 0);
+    }
+
+    void clear() {
+        Trace::recordInstant("test", "before");
+        Trace::clear();
+        Trace::recordInstant("test", "after");
+        QList<Trace::Event> events = testEvents();
+        QCOMPARE(events.count(), 1);
+        QCOMPARE(QString(events[0].name), QString("after"));
+    }
+
+    void wrap() {
+        // The oldest events are overwritten once the buffer is full
+        for (int i = 0; i < Trace::BufferCapacity + 100; ++i) {
+            Trace::recordInstant("test", "wrap");
+        }
+        int n = testEvents().count();
+        QVERIFY(n <= Trace::BufferCapacity);
+        QVERIFY(n >= Trace::BufferCapacity - 1);
+    }
+
+    void threads() {
+        TestTraceThread a(10), b(20);
+        a.start();
+        b.start();
+        a.wait();
+        b.wait();
+        QSet<int> threads;
+        foreach (const Trace::Event &e, testEvents()) threads.insert(e.thread);
+        QCOMPARE(threads.count(), 2);
+        QCOMPARE(testEvents().count(), 30);
+        QStringList names;
+        foreach (int thread, threads) names << Trace::threadName(thread);
+        QVERIFY(names.contains("worker 10"));
+        QVERIFY(names.contains("worker 20"));
+    }
+
+    void summary() {
+        for (int i = 0; i < 3; ++i) {
+            TraceSpan span("test", "summary");
+        }
+        int count = 0;
+        foreach (const Trace::SpanSummary &s, Trace::summary()) {
+            if (s.category == "test" && s.name == "summary") {
+                count = s.count;
+                QVERIFY(s.maximum <= s.total);
+            }
+        }
+        QCOMPARE(count, 3);
+    }
+
+    void counter() {
+        TraceCounter counter("test", "counter");
+        Trace::setEnabled(false);
+        counter.add(5);
+        QCOMPARE(counter.value(), qint64(5));
+        QCOMPARE(testEvents().count(), 0);
+        Trace::setEnabled(true);
+        counter.add(2);
+        QCOMPARE(counter.value(), qint64(7));
+        QList<Trace::Event> events = testEvents();
+        QCOMPARE(events.count(), 1);
+        QCOMPARE(events[0].type, Trace::Event::Counter);
+        QCOMPARE(events[0].value, qint64(7));
+        QVERIFY(TraceCounter::all().contains(&TraceCounter::tiersLoaded()));
+    }
+
+    void chromeTrace() {
+        {
+            TraceSpan span("test", "exported");
+        }
+        QJsonDocument doc = QJsonDocument::fromJson(Trace::toChromeTraceJSON());
+        QVERIFY(doc.isObject());
+        QJsonArray events = doc.object().value("traceEvents").toArray();
+        bool found = false, named = false;
+        foreach (QJsonValue v, events) {
+            QJsonObject o = v.toObject();
+            if (o.value("ph").toString() == "X" &&
+                o.value("name").toString() == "exported") {
+                QCOMPARE(o.value("cat").toString(), QString("test"));
+                found = true;
+            }
+            if (o.value("ph").toString() == "M" &&
+                o.value("name").toString() == "thread_name") {
+                named = true;
+            }
+        }
+        QVERIFY(found);
+        QVERIFY(named);
+    }
+};
+
+#endif
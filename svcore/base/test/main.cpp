@@ -15,6 +15,8 @@
 #include "TestPitch.h"
 #include "TestRealTime.h"
 #include "TestStringBits.h"
+#include "TestTrace.h"
+#include "TestChunkedSortedList.h"
 
 #include <QtTest>
 
@@ -48,6 +50,16 @@ int main(int argc, char *argv[])
 	if (QTest::qExec(&t, argc, argv) == 0) ++good;
 	else ++bad;
     }
+    {
+	TestTrace t;
+	if (QTest::qExec(&t, argc, argv) == 0) ++good;
+	else ++bad;
+    }
+    {
+	TestChunkedSortedList t;
+	if (QTest::qExec(&t, argc, argv) == 0) ++good;
+	else ++bad;
+    }
 
     if (bad > 0) {
 	cerr << "\n********* " << bad << " test suite(s) failed!\n" << endl;
@@ -26,6 +26,7 @@
 #include "base/StorageAdviser.h"
 #include "base/Exceptions.h"
 #include "base/Profiler.h"
+#include "base/Trace.h"
 #include "base/Thread.h" // for debug mutex locker
 
 #include <QWriteLocker>
@@ -1459,6 +1460,9 @@ FFTDataServer::FillThread::run()
     }
     if (m_server.m_exiting) return;
 
+    Trace::setThreadName("FFT fill");
+    TraceSpan span("audio", "fft fill");
+
     sv_frame_t start = m_server.m_model->getStartFrame();
     sv_frame_t end = m_server.m_model->getEndFrame();
     sv_frame_t remainingEnd = end;
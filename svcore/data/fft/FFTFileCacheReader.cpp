@@ -228,9 +228,9 @@ size_t
 FFTFileCacheReader::getCacheSize(int width, int height,
                                  FFTCache::StorageType type)
 {
-    return (height * 2 + (type == FFTCache::Compact ? 2 : 1)) * width *
-        (type == FFTCache::Compact ? sizeof(uint16_t) : sizeof(float)) +
-        2 * sizeof(int); // matrix file header size
+    return MatrixFile::getFileSize
+        (type == FFTCache::Compact ? sizeof(uint16_t) : sizeof(float),
+         width, height * 2 + (type == FFTCache::Compact ? 2 : 1));
 }
 
 void
@@ -140,7 +140,7 @@ AudioFileReaderFactory::create(FileSource source,
                  threading ?
                  OggVorbisFileReader::DecodeThreaded :
                  OggVorbisFileReader::DecodeAtOnce,
-                 OggVorbisFileReader::CacheInTemporaryFile,
+                 OggVorbisFileReader::CacheSeekIndex,
                  targetRate,
                  normalised,
                  reporter);
@@ -161,7 +161,7 @@ AudioFileReaderFactory::create(FileSource source,
                  threading ?
                  MP3FileReader::DecodeThreaded :
                  MP3FileReader::DecodeAtOnce,
-                 MP3FileReader::CacheInTemporaryFile,
+                 MP3FileReader::CacheSeekIndex,
                  targetRate,
                  normalised,
                  reporter);
@@ -259,7 +259,7 @@ AudioFileReaderFactory::create(FileSource source,
              threading ?
              OggVorbisFileReader::DecodeThreaded :
              OggVorbisFileReader::DecodeAtOnce,
-             OggVorbisFileReader::CacheInTemporaryFile,
+             OggVorbisFileReader::CacheSeekIndex,
              targetRate,
              reporter);
 
@@ -278,7 +278,7 @@ AudioFileReaderFactory::create(FileSource source,
              threading ?
              MP3FileReader::DecodeThreaded :
              MP3FileReader::DecodeAtOnce,
-             MP3FileReader::CacheInTemporaryFile,
+             MP3FileReader::CacheSeekIndex,
              targetRate,
              reporter);
 
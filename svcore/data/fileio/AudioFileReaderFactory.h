@@ -47,6 +47,11 @@ public:
      * If normalised is true, the file data will be normalised to
      * abs(max) == 1.0. Otherwise the file will not be normalised.
      *
+     * MP3 and Ogg Vorbis files that need neither resampling nor
+     * normalisation are not decoded up front: they are indexed (once,
+     * the index being kept in the cache directory) and decoded on
+     * demand as they are read.
+     *
      * If a ProgressReporter is provided, it will be updated with
      * progress status.  Caller retains ownership of the reporter
      * object.
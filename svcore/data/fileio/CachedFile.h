@@ -39,6 +39,13 @@ public:
 
     QString getLocalFilename() const;
 
+    /**
+     * Return the persistent cache directory, creating it if
+     * necessary.  Throw DirectoryCreationFailed if it cannot be
+     * created.
+     */
+    static QString getCacheDirectory();
+
 protected:
     QString m_origin;
     QString m_localFilename;
@@ -52,7 +59,6 @@ protected:
     QDateTime getLastRetrieval();
     void updateLastRetrieval(bool successful);
 
-    static QString getCacheDirectory();
     static QString getLocalFilenameFor(QUrl url);
 
     typedef std::map<QString, QString> OriginLocalFilenameMap;
@@ -16,6 +16,7 @@
 #include "CodedAudioFileReader.h"
 
 #include "WavFileReader.h"
+#include "CachedFile.h"
 #include "base/TempDirectory.h"
 #include "base/Exceptions.h"
 #include "base/Profiler.h"
@@ -24,9 +25,24 @@
 
 #include <stdint.h>
 #include <iostream>
+#include <algorithm>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QCryptographicHash>
 #include <QMutexLocker>
 
+//#define DEBUG_CODED_AUDIO_FILE_READER 1
+
+// Number of decoded chunks kept in CacheSeekIndex mode
+static const int seekChunkCacheSize = 8;
+
+// Identifies, and versions, persisted seek index files
+static const quint32 seekIndexMagic = 0x53564958;
+static const quint32 seekIndexVersion = 1;
+
 CodedAudioFileReader::CodedAudioFileReader(CacheMode cacheMode,
                                            sv_samplerate_t targetRate,
                                            bool normalised) :
@@ -186,7 +202,7 @@ CodedAudioFileReader::addSamplesToDecodeCache(float **samples, sv_frame_t nframe
 {
     QMutexLocker locker(&m_cacheMutex);
 
-    if (!m_initialised) return;
+    if (!m_initialised || m_cacheMode == CacheSeekIndex) return;
 
     for (sv_frame_t i = 0; i < nframes; ++i) {
         
@@ -216,7 +232,7 @@ CodedAudioFileReader::addSamplesToDecodeCache(float *samples, sv_frame_t nframes
 {
     QMutexLocker locker(&m_cacheMutex);
 
-    if (!m_initialised) return;
+    if (!m_initialised || m_cacheMode == CacheSeekIndex) return;
 
     for (sv_frame_t i = 0; i < nframes; ++i) {
         
@@ -246,7 +262,7 @@ CodedAudioFileReader::addSamplesToDecodeCache(const SampleBlock &samples)
 {
     QMutexLocker locker(&m_cacheMutex);
 
-    if (!m_initialised) return;
+    if (!m_initialised || m_cacheMode == CacheSeekIndex) return;
 
     for (float sample: samples) {
         
@@ -278,6 +294,8 @@ CodedAudioFileReader::finishDecodeCache()
         return;
     }
 
+    if (m_cacheMode == CacheSeekIndex) return;
+
     pushBuffer(m_cacheWriteBuffer,
                m_cacheWriteBufferIndex / m_channelCount,
                true);
@@ -357,6 +375,9 @@ CodedAudioFileReader::pushBufferNonResampling(float *buffer, sv_frame_t sz)
         }
         m_dataLock.unlock();
         break;
+
+    case CacheSeekIndex:
+        break;
     }
 }
 
@@ -448,6 +469,44 @@ CodedAudioFileReader::getInterleavedFrames(sv_frame_t start, sv_frame_t count) c
         m_dataLock.unlock();
 
         frames.resize(i);
+        break;
+    }
+
+    case CacheSeekIndex:
+    {
+        if (!isOK()) return SampleBlock();
+        if (count <= 0 || start < 0 || start >= m_frameCount) {
+            return SampleBlock();
+        }
+        if (count > m_frameCount - start) count = m_frameCount - start;
+
+        SeekPoint sought;
+        sought.frame = start;
+        sought.offset = 0;
+        sought.preroll = 0;
+        int chunk = int(std::upper_bound
+                        (m_seekIndex.begin(), m_seekIndex.end(), sought,
+                         [](const SeekPoint &a, const SeekPoint &b) {
+                             return a.frame < b.frame;
+                         }) - m_seekIndex.begin()) - 1;
+        if (chunk < 0) return SampleBlock();
+
+        frames.reserve(count * m_channelCount);
+
+        sv_frame_t end = start + count;
+        sv_frame_t pos = start;
+
+        while (pos < end && chunk < int(m_seekIndex.size())) {
+            std::shared_ptr<const SampleBlock> data = getSeekChunk(chunk);
+            sv_frame_t chunkStart = m_seekIndex[chunk].frame;
+            sv_frame_t to = std::min(getSeekChunkEnd(chunk), end);
+            frames.insert(frames.end(),
+                          data->begin() + (pos - chunkStart) * m_channelCount,
+                          data->begin() + (to - chunkStart) * m_channelCount);
+            pos = to;
+            ++chunk;
+        }
+        break;
     }
     }
 
@@ -458,3 +517,222 @@ CodedAudioFileReader::getInterleavedFrames(sv_frame_t start, sv_frame_t count) c
     return frames;
 }
 
+bool
+CodedAudioFileReader::initialiseSeekIndex(const SeekIndex &index,
+                                          sv_frame_t frameCount)
+{
+    QMutexLocker locker(&m_cacheMutex);
+
+    if (m_fileRate == 0 || m_channelCount == 0 || index.empty() ||
+        index[0].frame != 0) {
+        cerr << "CodedAudioFileReader::initialiseSeekIndex: Invalid seek index or file format, falling back to temporary file cache" << endl;
+        m_cacheMode = CacheInTemporaryFile;
+        return false;
+    }
+
+    if (m_sampleRate == 0) {
+        m_sampleRate = m_fileRate;
+    }
+    
+    if (m_sampleRate != m_fileRate || m_normalised) {
+        cerr << "CodedAudioFileReader::initialiseSeekIndex: Resampling or normalisation required, falling back to temporary file cache" << endl;
+        m_cacheMode = CacheInTemporaryFile;
+        return false;
+    }
+
+    m_cacheMode = CacheSeekIndex;
+    m_seekIndex = index;
+    m_frameCount = frameCount;
+    m_fileFrameCount = frameCount;
+    m_initialised = true;
+
+#ifdef DEBUG_CODED_AUDIO_FILE_READER
+    cerr << "CodedAudioFileReader::initialiseSeekIndex: " << m_seekIndex.size()
+         << " chunks for " << m_frameCount << " frames" << endl;
+#endif
+
+    return true;
+}
+
+sv_frame_t
+CodedAudioFileReader::getSeekChunkEnd(int chunk) const
+{
+    if (chunk + 1 < int(m_seekIndex.size())) {
+        return m_seekIndex[chunk + 1].frame;
+    }
+    return m_frameCount;
+}
+
+bool
+CodedAudioFileReader::decodeSeekChunk(int, SampleBlock &) const
+{
+    return false;
+}
+
+std::shared_ptr<const SampleBlock>
+CodedAudioFileReader::getSeekChunk(int chunk) const
+{
+    {
+        QMutexLocker locker(&m_seekChunkMutex);
+        for (auto i = m_seekChunks.begin(); i != m_seekChunks.end(); ++i) {
+            if (i->chunk == chunk) {
+                m_seekChunks.splice(m_seekChunks.begin(), m_seekChunks, i);
+                return m_seekChunks.front().data;
+            }
+        }
+    }
+
+    // Decode without holding the lock, so that other threads can
+    // read chunks that are already cached in the meantime
+
+    Profiler profiler("CodedAudioFileReader::getSeekChunk");
+
+    std::shared_ptr<SampleBlock> data(new SampleBlock);
+    bool ok = decodeSeekChunk(chunk, *data);
+
+    // Pad or trim to the exact extent of the chunk, so that a
+    // damaged stream cannot shift the frames that follow it
+    sv_frame_t frames = getSeekChunkEnd(chunk) - m_seekIndex[chunk].frame;
+    if (!ok) {
+        cerr << "WARNING: CodedAudioFileReader::getSeekChunk: Failed to decode chunk " << chunk << endl;
+        data->clear();
+    }
+    data->resize(frames * m_channelCount, 0.f);
+
+    for (auto &f: *data) {
+        if (f >  1.f) f =  1.f;
+        if (f < -1.f) f = -1.f;
+    }
+
+    if (!ok) return data;
+
+    QMutexLocker locker(&m_seekChunkMutex);
+    SeekChunk entry;
+    entry.chunk = chunk;
+    entry.data = data;
+    m_seekChunks.push_front(entry);
+    while (int(m_seekChunks.size()) > seekChunkCacheSize) {
+        m_seekChunks.pop_back();
+    }
+    return data;
+}
+
+QString
+CodedAudioFileReader::getSeekIndexFilename(QString path)
+{
+    QDir dir(CachedFile::getCacheDirectory());
+    if (!dir.mkpath("seekindex")) {
+        throw DirectoryCreationFailed(dir.filePath("seekindex"));
+    }
+    QString filename = QString::fromLocal8Bit
+        (QCryptographicHash::hash(QFileInfo(path).absoluteFilePath().toUtf8(),
+                                  QCryptographicHash::Sha1).toHex());
+    return dir.filePath("seekindex/" + filename);
+}
+
+bool
+CodedAudioFileReader::loadSeekIndex(QString path, QString format)
+{
+    QString filename;
+    try {
+        filename = getSeekIndexFilename(path);
+    } catch (DirectoryCreationFailed f) {
+        return false;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QFileInfo info(path);
+    QDataStream stream(&file);
+
+    quint32 magic = 0, version = 0;
+    QString storedFormat;
+    qint64 size = 0, modified = 0;
+    stream >> magic >> version >> storedFormat >> size >> modified;
+
+    if (magic != seekIndexMagic || version != seekIndexVersion ||
+        storedFormat != format || size != info.size() ||
+        modified != info.lastModified().toMSecsSinceEpoch()) {
+        cerr << "CodedAudioFileReader::loadSeekIndex: Seek index for \"" << path << "\" is out of date" << endl;
+        return false;
+    }
+
+    double fileRate = 0.0;
+    qint32 channels = 0;
+    qint64 frameCount = 0;
+    quint32 n = 0;
+    stream >> fileRate >> channels >> frameCount >> n;
+
+    // Each seek point takes three 64-bit values: don't reserve for more
+    // points than the rest of the file can hold
+    const qint64 seekPointSize = 3 * sizeof(qint64);
+    if (stream.status() != QDataStream::Ok || frameCount < 0 ||
+        qint64(n) > (file.size() - file.pos()) / seekPointSize) {
+        cerr << "CodedAudioFileReader::loadSeekIndex: Seek index for \"" << path << "\" is damaged" << endl;
+        return false;
+    }
+
+    SeekIndex index;
+    index.reserve(n);
+    for (quint32 i = 0; i < n && stream.status() == QDataStream::Ok; ++i) {
+        qint64 frame = 0, offset = 0, preroll = 0;
+        stream >> frame >> offset >> preroll;
+        SeekPoint point;
+        point.frame = frame;
+        point.offset = offset;
+        point.preroll = preroll;
+        index.push_back(point);
+    }
+
+    if (stream.status() != QDataStream::Ok || index.size() != n) {
+        cerr << "CodedAudioFileReader::loadSeekIndex: Seek index for \"" << path << "\" is damaged" << endl;
+        return false;
+    }
+
+    m_fileRate = fileRate;
+    m_channelCount = channels;
+
+    if (!initialiseSeekIndex(index, frameCount)) {
+        m_fileRate = 0;
+        m_channelCount = 0;
+        return false;
+    }
+    return true;
+}
+
+void
+CodedAudioFileReader::saveSeekIndex(QString path, QString format) const
+{
+    QString filename;
+    try {
+        filename = getSeekIndexFilename(path);
+    } catch (DirectoryCreationFailed f) {
+        cerr << "WARNING: CodedAudioFileReader::saveSeekIndex: Failed to create cache directory" << endl;
+        return;
+    }
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        cerr << "WARNING: CodedAudioFileReader::saveSeekIndex: Failed to open \"" << filename << "\" for writing" << endl;
+        return;
+    }
+
+    QFileInfo info(path);
+    QDataStream stream(&file);
+
+    stream << seekIndexMagic << seekIndexVersion << format
+           << qint64(info.size())
+           << qint64(info.lastModified().toMSecsSinceEpoch())
+           << double(m_fileRate) << qint32(m_channelCount)
+           << qint64(m_frameCount) << quint32(m_seekIndex.size());
+
+    for (const SeekPoint &point: m_seekIndex) {
+        stream << qint64(point.frame) << qint64(point.offset)
+               << qint64(point.preroll);
+    }
+
+    if (!file.commit()) {
+        cerr << "WARNING: CodedAudioFileReader::saveSeekIndex: Failed to write \"" << filename << "\"" << endl;
+    }
+}
@@ -22,6 +22,10 @@
 #include <QMutex>
 #include <QReadWriteLock>
 
+#include <list>
+#include <memory>
+#include <vector>
+
 class WavFileReader;
 class Serialiser;
 class Resampler;
@@ -33,9 +37,20 @@ class CodedAudioFileReader : public AudioFileReader
 public:
     virtual ~CodedAudioFileReader();
 
+    /**
+     * CacheSeekIndex decodes nothing up front.  Instead the reader
+     * indexes the compressed stream (the index is persisted in the
+     * cache directory, so this happens only the first time a file is
+     * opened) and decodes the chunks that are requested on demand,
+     * keeping the most recently used ones.  It can only be used when
+     * neither resampling nor normalisation is needed; a reader that
+     * is asked for it otherwise, or that does not support it, falls
+     * back to CacheInTemporaryFile.
+     */
     enum CacheMode {
         CacheInTemporaryFile,
-        CacheInMemory
+        CacheInMemory,
+        CacheSeekIndex
     };
 
     virtual SampleBlock getInterleavedFrames(sv_frame_t start, sv_frame_t count) const;
@@ -70,11 +85,52 @@ protected:
     void startSerialised(QString id);
     void endSerialised();
 
+    /**
+     * A point in the compressed stream from which decoding can
+     * start.  Chunk i of the file runs from the frame of seek point
+     * i up to the frame of seek point i+1 (or the end of the file).
+     */
+    struct SeekPoint {
+        sv_frame_t frame;   // first frame of the chunk, at file rate
+        qint64 offset;      // byte offset at which to start decoding
+        sv_frame_t preroll; // frames decoded from offset before frame
+    };
+    typedef std::vector<SeekPoint> SeekIndex;
+
+    /**
+     * Switch to CacheSeekIndex mode with the given index.  The file
+     * rate and channel count must have been set.  Returns false, and
+     * switches to CacheInTemporaryFile instead, if the index cannot
+     * be used with this reader's target rate or normalisation.
+     */
+    bool initialiseSeekIndex(const SeekIndex &index, sv_frame_t frameCount);
+
+    /**
+     * Look for a seek index persisted for the given file and format,
+     * and initialise from it if it is still valid.  Sets the file
+     * rate and channel count on success.
+     */
+    bool loadSeekIndex(QString path, QString format);
+    void saveSeekIndex(QString path, QString format) const;
+
+    /**
+     * Decode the given chunk of the seek index into interleaved
+     * samples.  Called from getInterleavedFrames, possibly from more
+     * than one thread at once.  The default implementation fails.
+     */
+    virtual bool decodeSeekChunk(int chunk, SampleBlock &interleaved) const;
+
+    const SeekIndex &getSeekIndex() const { return m_seekIndex; }
+    sv_frame_t getSeekChunkEnd(int chunk) const;
+
 private:
     void pushBuffer(float *interleaved, sv_frame_t sz, bool final);
     void pushBufferResampling(float *interleaved, sv_frame_t sz, double ratio, bool final);
     void pushBufferNonResampling(float *interleaved, sv_frame_t sz);
 
+    std::shared_ptr<const SampleBlock> getSeekChunk(int chunk) const;
+    static QString getSeekIndexFilename(QString path);
+
 protected:
     QMutex m_cacheMutex;
     CacheMode m_cacheMode;
@@ -98,6 +154,15 @@ protected:
     bool m_normalised;
     float m_max;
     float m_gain;
+
+    SeekIndex m_seekIndex;
+
+    struct SeekChunk {
+        int chunk;
+        std::shared_ptr<const SampleBlock> data;
+    };
+    mutable std::list<SeekChunk> m_seekChunks; // most recently used first
+    mutable QMutex m_seekChunkMutex;
 };
 
 #endif
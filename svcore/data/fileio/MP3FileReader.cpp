@@ -17,6 +17,7 @@
 
 #include "MP3FileReader.h"
 #include "base/ProgressReporter.h"
+#include "base/Profiler.h"
 
 #include "system/System.h"
 
@@ -25,16 +26,26 @@
 #include <fcntl.h>
 
 #include <iostream>
+#include <algorithm>
 
 #include <cstdlib>
+#include <cstring>
 #include <unistd.h>
 
 #ifdef HAVE_ID3TAG
 #include <id3tag.h>
 #endif
 //#define DEBUG_ID3TAG 1
+//#define DEBUG_MP3_FILE_READER 1
 
 #include <QFileInfo>
+#include <QFile>
+
+// Seek index granularity: MPEG audio frames per chunk, and frames
+// decoded ahead of each chunk so that the bit reservoir and the
+// synthesis filterbank are filled by the time the chunk starts
+static const int seekChunkFrames = 64;
+static const int seekPrerollFrames = 8;
 
 MP3FileReader::MP3FileReader(FileSource source, DecodeMode decodeMode, 
                              CacheMode mode, sv_samplerate_t targetRate,
@@ -67,6 +78,13 @@ MP3FileReader::MP3FileReader(FileSource source, DecodeMode decodeMode,
     m_samplebuffer = 0;
     m_samplebuffersize = 0;
 
+    if (m_cacheMode == CacheSeekIndex && loadSeekIndex(m_path, "mp3")) {
+        loadTags();
+        m_completion = 100;
+        m_done = true;
+        return;
+    }
+
     int fd = -1;
     if ((fd = ::open(m_path.toLocal8Bit().data(), O_RDONLY
 #ifdef _WIN32
@@ -78,7 +96,8 @@ MP3FileReader::MP3FileReader(FileSource source, DecodeMode decodeMode,
     }	
 
     try {
-        m_filebuffer = new unsigned char[m_fileSize];
+        // zero padded as libmad requires to decode the final frame
+        m_filebuffer = new unsigned char[m_fileSize + MAD_BUFFER_GUARD];
     } catch (...) {
         m_error = QString("Out of memory");
         ::close(fd);
@@ -106,8 +125,22 @@ MP3FileReader::MP3FileReader(FileSource source, DecodeMode decodeMode,
 
     ::close(fd);
 
+    memset(m_filebuffer + m_fileSize, 0, MAD_BUFFER_GUARD);
+
     loadTags();
 
+    if (m_cacheMode == CacheSeekIndex && buildSeekIndex()) {
+        delete[] m_filebuffer;
+        m_filebuffer = 0;
+        m_completion = 100;
+        m_done = true;
+        return;
+    }
+
+    if (m_cacheMode == CacheSeekIndex) {
+        m_cacheMode = CacheInTemporaryFile;
+    }
+
     if (decodeMode == DecodeAtOnce) {
 
         if (m_reporter) {
@@ -318,21 +351,198 @@ MP3FileReader::input(void *dp, struct mad_stream *stream)
     unsigned char const *start = data->start;
     unsigned long length = data->length;
 
+    sv_frame_t taglen = data->reader->getAudioStart(start, length);
+    start += taglen;
+    length -= (unsigned long)taglen;
+
+    mad_stream_buffer(stream, start, length);
+    data->length = 0;
+
+    return MAD_FLOW_CONTINUE;
+}
+
+sv_frame_t
+MP3FileReader::getAudioStart(const unsigned char *buffer, sv_frame_t sz) const
+{
 #ifdef HAVE_ID3TAG
-    if (length > ID3_TAG_QUERYSIZE) {
-        ssize_t taglen = id3_tag_query(start, ID3_TAG_QUERYSIZE);
-        if (taglen > 0) {
+    if (sz > ID3_TAG_QUERYSIZE) {
+        long taglen = id3_tag_query(buffer, ID3_TAG_QUERYSIZE);
+        if (taglen > 0 && taglen < sz) {
 //            cerr << "ID3 tag length to skip: " << taglen << endl;
-            start += taglen;
-            length -= taglen;
+            return taglen;
         }
     }
+#else
+    (void)buffer;
+    (void)sz;
 #endif
+    return 0;
+}
 
-    mad_stream_buffer(stream, start, length);
-    data->length = 0;
+bool
+MP3FileReader::buildSeekIndex()
+{
+    Profiler profiler("MP3FileReader::buildSeekIndex", true);
 
-    return MAD_FLOW_CONTINUE;
+    // Only the frame headers are parsed here, no audio is decoded
+
+    sv_frame_t audioStart = getAudioStart(m_filebuffer, m_fileSize);
+
+    struct mad_stream stream;
+    struct mad_header header;
+
+    mad_stream_init(&stream);
+    mad_header_init(&header);
+    mad_stream_buffer(&stream, m_filebuffer + audioStart,
+                      (unsigned long)(m_fileSize - audioStart + MAD_BUFFER_GUARD));
+
+    SeekIndex index;
+    sv_frame_t frame = 0;
+    long count = 0;
+    int channels = 0;
+    sv_samplerate_t rate = 0;
+
+    // Offsets and positions of the most recent frames, from which
+    // the preroll of a new seek point starts
+    const int recent = seekPrerollFrames + 1;
+    std::vector<qint64> offsets(recent, 0);
+    std::vector<sv_frame_t> positions(recent, 0);
+
+    while (!m_cancelled) {
+
+        if (mad_header_decode(&header, &stream) == -1) {
+            if (MAD_RECOVERABLE(stream.error)) continue;
+            break; // MAD_ERROR_BUFLEN at end of data
+        }
+
+        qint64 offset = stream.this_frame - m_filebuffer;
+        if (offset >= m_fileSize) break;
+
+        if (count == 0) {
+            channels = MAD_NCHANNELS(&header);
+            rate = header.samplerate;
+        }
+
+        offsets[count % recent] = offset;
+        positions[count % recent] = frame;
+
+        if (count % seekChunkFrames == 0) {
+            long first = std::max(0L, count - seekPrerollFrames);
+            SeekPoint point;
+            point.frame = frame;
+            point.offset = offsets[first % recent];
+            point.preroll = frame - positions[first % recent];
+            index.push_back(point);
+        }
+
+        frame += 32 * MAD_NSBSAMPLES(&header);
+        ++count;
+    }
+
+    mad_header_finish(&header);
+    mad_stream_finish(&stream);
+
+    if (m_cancelled || count == 0 || channels == 0 || rate == 0) {
+        return false;
+    }
+
+    m_fileRate = rate;
+    m_channelCount = channels;
+
+    if (!initialiseSeekIndex(index, frame)) {
+        m_fileRate = 0;
+        m_channelCount = 0;
+        return false;
+    }
+
+#ifdef DEBUG_MP3_FILE_READER
+    cerr << "MP3FileReader::buildSeekIndex: " << count << " frames, "
+         << index.size() << " seek points" << endl;
+#endif
+
+    saveSeekIndex(m_path, "mp3");
+    return true;
+}
+
+bool
+MP3FileReader::decodeSeekChunk(int chunk, SampleBlock &interleaved) const
+{
+    const SeekIndex &index = getSeekIndex();
+    const SeekPoint &point = index[chunk];
+    sv_frame_t end = getSeekChunkEnd(chunk);
+
+    // The preroll of the chunk after next starts beyond the end of
+    // this chunk, so reading up to it is enough
+    qint64 endOffset = m_fileSize;
+    if (chunk + 2 < int(index.size())) {
+        endOffset = index[chunk + 2].offset;
+    }
+    if (endOffset <= point.offset) return false;
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(point.offset)) {
+        return false;
+    }
+
+    std::vector<unsigned char> buffer
+        (size_t(endOffset - point.offset) + MAD_BUFFER_GUARD, 0);
+    qint64 sz = file.read((char *)buffer.data(), endOffset - point.offset);
+    if (sz <= 0) return false;
+
+    struct mad_stream stream;
+    struct mad_frame frame;
+    struct mad_synth synth;
+
+    mad_stream_init(&stream);
+    mad_frame_init(&frame);
+    mad_synth_init(&synth);
+    mad_stream_buffer(&stream, buffer.data(),
+                      (unsigned long)(sz + MAD_BUFFER_GUARD));
+
+    int channels = getChannelCount();
+    sv_frame_t pos = point.frame - point.preroll;
+
+    interleaved.clear();
+    interleaved.reserve((end - point.frame) * channels);
+
+    while (pos < end) {
+
+        bool decoded = (mad_frame_decode(&frame, &stream) == 0);
+        sv_frame_t n = 0;
+
+        if (decoded) {
+            mad_synth_frame(&synth, &frame);
+            n = synth.pcm.length;
+        } else {
+            if (!MAD_RECOVERABLE(stream.error)) break;
+            // A bad header is not a frame (buildSeekIndex skipped it
+            // too); a frame with bad data still takes up its length,
+            // and is rendered as silence
+            if (stream.error < MAD_ERROR_BADCRC) continue;
+            n = 32 * MAD_NSBSAMPLES(&frame.header);
+        }
+
+        sv_frame_t from = std::max(sv_frame_t(0), point.frame - pos);
+        sv_frame_t to = std::min(n, end - pos);
+
+        for (sv_frame_t i = from; i < to; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                float sample = 0.f;
+                if (decoded && c < int(synth.pcm.channels)) {
+                    sample = float(synth.pcm.samples[c][i]) / float(MAD_F_ONE);
+                }
+                interleaved.push_back(sample);
+            }
+        }
+
+        pos += n;
+    }
+
+    mad_synth_finish(&synth);
+    mad_frame_finish(&frame);
+    mad_stream_finish(&stream);
+
+    return true;
 }
 
 enum mad_flow
@@ -96,6 +96,10 @@ protected:
     bool decode(void *mm, sv_frame_t sz);
     enum mad_flow accept(struct mad_header const *, struct mad_pcm *);
 
+    sv_frame_t getAudioStart(const unsigned char *buffer, sv_frame_t sz) const;
+    bool buildSeekIndex();
+    virtual bool decodeSeekChunk(int chunk, SampleBlock &interleaved) const;
+
     static enum mad_flow input(void *, struct mad_stream *);
     static enum mad_flow output(void *, struct mad_header const *, struct mad_pcm *);
     static enum mad_flow error(void *, struct mad_stream *, struct mad_frame *);
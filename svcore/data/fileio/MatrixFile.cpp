@@ -25,12 +25,18 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 #include <iostream>
 
 #include <cstdio>
 #include <cassert>
 
 #include <cstdlib>
+#include <cstring>
+#include <atomic>
 
 #include <QFileInfo>
 #include <QDir>
@@ -47,6 +53,20 @@
 std::map<QString, int> MatrixFile::m_refcount;
 QMutex MatrixFile::m_createMutex;
 
+#ifndef _WIN32
+bool MatrixFile::m_mappingEnabled = true;
+#else
+bool MatrixFile::m_mappingEnabled = false;
+#endif
+
+// Header: width, height, layout, offset of the first column's data
+static const int headerInts = 4;
+
+// Data of mapped files starts on a huge page boundary when there is
+// at least one huge page of it
+static const off_t hugePageSize = 2 * 1024 * 1024;
+static const int cacheLineSize = 64;
+
 static size_t totalStorage = 0;
 static size_t totalCount = 0;
 static size_t openCount = 0;
@@ -60,7 +80,12 @@ MatrixFile::MatrixFile(QString fileBase, Mode mode,
     m_cellSize(cellSize),
     m_width(width),
     m_height(height),
-    m_headerSize(2 * sizeof(int)),
+    m_headerSize(headerInts * sizeof(int)),
+    m_layout(InterleavedLayout),
+    m_dataOffset(0),
+    m_columnStride(0),
+    m_fileSize(0),
+    m_map(0),
     m_setColumns(0),
     m_autoClose(false),
     m_readyToReadColumn(-1)
@@ -93,7 +118,8 @@ MatrixFile::MatrixFile(QString fileBase, Mode mode,
     m_fmode = S_IRUSR | S_IWUSR;
 
     if (m_mode == WriteOnly) {
-        m_flags = O_WRONLY | O_CREAT;
+        // A writable mapping needs a file opened for reading as well
+        m_flags = (m_mappingEnabled ? O_RDWR : O_WRONLY) | O_CREAT;
     } else {
         m_flags = O_RDONLY;
     }
@@ -125,8 +151,9 @@ MatrixFile::MatrixFile(QString fileBase, Mode mode,
     if (newFile) {
         initialise(); // write header and "unwritten" column tags
     } else {
-        int header[2];
-        if (::read(m_fd, header, 2 * sizeof(int)) < 0) {
+        int header[headerInts];
+        if (::read(m_fd, header, headerInts * sizeof(int)) !=
+            ssize_t(headerInts * sizeof(int))) {
             ::perror("MatrixFile::MatrixFile: read failed");
             cerr << "ERROR: MatrixFile::MatrixFile: "
                       << "Failed to read header (fd " << m_fd << ", file \""
@@ -140,6 +167,18 @@ MatrixFile::MatrixFile(QString fileBase, Mode mode,
                       << m_width << "x" << m_height << endl;
             throw FailedToOpenFile(fileName);
         }
+        calculateLayout(header[2]);
+        if (m_dataOffset != off_t(header[3])) {
+            cerr << "ERROR: MatrixFile::MatrixFile: "
+                      << "Layout in file header differs from expected layout"
+                      << endl;
+            throw FailedToOpenFile(fileName);
+        }
+        if (m_layout == MappedLayout) {
+            // If the mapping fails, we read the same layout with
+            // read calls instead
+            map();
+        }
     }
 
     m_fileName = fileName;
@@ -157,6 +196,8 @@ MatrixFile::MatrixFile(QString fileBase, Mode mode,
 
 MatrixFile::~MatrixFile()
 {
+    unmap();
+
     if (m_fd >= 0) {
         if (::close(m_fd) < 0) {
             ::perror("MatrixFile::~MatrixFile: close failed");
@@ -181,7 +222,7 @@ MatrixFile::~MatrixFile()
     }
 
     if (m_mode == WriteOnly) {
-        totalStorage -= (m_headerSize + (m_width * m_height * m_cellSize) + m_width);
+        totalStorage -= m_fileSize;
     }
     totalCount --;
 
@@ -199,8 +240,11 @@ MatrixFile::initialise()
     assert(m_mode == WriteOnly);
 
     m_setColumns = new ResizeableBitset(m_width);
-    
-    off_t off = m_headerSize + (m_width * m_height * m_cellSize) + m_width;
+
+    // The file was opened for reading as well if it is to be mapped
+    calculateLayout((m_flags & O_RDWR) ? MappedLayout : InterleavedLayout);
+
+    off_t off = m_fileSize;
 
 #ifdef DEBUG_MATRIX_FILE
     cerr << "MatrixFile[" << m_fd << "]::initialise(" << m_width << ", " << m_height << "): cell size " << m_cellSize << ", header size " << m_headerSize << ", resizing file" << endl;
@@ -222,34 +266,187 @@ MatrixFile::initialise()
         throw FileOperationFailed(m_fileName, "lseek");
     }
 
-    int header[2];
+    int header[headerInts];
     header[0] = m_width;
     header[1] = m_height;
-    if (::write(m_fd, header, 2 * sizeof(int)) != 2 * sizeof(int)) {
+    header[2] = m_layout;
+    header[3] = int(m_dataOffset);
+    if (::write(m_fd, header, headerInts * sizeof(int)) !=
+        ssize_t(headerInts * sizeof(int))) {
         ::perror("ERROR: MatrixFile::initialise: Failed to write header");
         throw FileOperationFailed(m_fileName, "write");
     }
 
     if (m_mode == WriteOnly) {
-        totalStorage += (m_headerSize + (m_width * m_height * m_cellSize) + m_width);
+        totalStorage += m_fileSize;
     }
 
 #ifdef DEBUG_MATRIX_FILE
     cerr << "MatrixFile[" << m_fd << "]::initialise(" << m_width << ", " << m_height << "): storage "
-              << (m_headerSize + m_width * m_height * m_cellSize + m_width) << endl;
+              << m_fileSize << endl;
 
     cerr << "MatrixFile: Total storage " << totalStorage/1024 << "K" << endl;
 #endif
 
+    if (m_layout == MappedLayout) {
+        map();
+    }
+
     seekTo(0);
 }
 
+void
+MatrixFile::fileLayout(int layout, int cellSize, int width, int height,
+           int &columnStride, off_t &dataOffset, off_t &fileSize)
+{
+    off_t headerSize = headerInts * sizeof(int);
+    off_t columnSize = off_t(height) * cellSize;
+
+    if (layout == MappedLayout) {
+
+        // Column-valid flags come straight after the header, and the
+        // columns after them, each starting on a cache line, so that
+        // writing a column never touches the page holding the flags
+        // and reading one pulls in no neighbouring data
+        columnStride = int(((columnSize + cacheLineSize - 1) / cacheLineSize)
+                           * cacheLineSize);
+
+        off_t dataSize = off_t(columnStride) * width;
+        off_t alignment = 4096;
+#ifndef _WIN32
+        long pageSize = sysconf(_SC_PAGESIZE);
+        if (pageSize > 0) alignment = pageSize;
+#endif
+        if (dataSize >= hugePageSize) alignment = hugePageSize;
+
+        off_t flagsEnd = headerSize + width;
+        dataOffset = ((flagsEnd + alignment - 1) / alignment) * alignment;
+        fileSize = dataOffset + dataSize;
+
+    } else {
+
+        columnStride = int(columnSize + 1);
+        dataOffset = headerSize + 1;
+        fileSize = headerSize + off_t(columnStride) * width;
+    }
+}
+
+void
+MatrixFile::calculateLayout(int layout)
+{
+    m_layout = (layout == MappedLayout) ? MappedLayout : InterleavedLayout;
+    fileLayout(m_layout, m_cellSize, m_width, m_height,
+               m_columnStride, m_dataOffset, m_fileSize);
+}
+
+size_t
+MatrixFile::getFileSize(int cellSize, int width, int height)
+{
+    int columnStride;
+    off_t dataOffset, fileSize;
+    fileLayout(m_mappingEnabled ? MappedLayout : InterleavedLayout,
+               cellSize, width, height, columnStride, dataOffset, fileSize);
+    return size_t(fileSize);
+}
+
+bool
+MatrixFile::map()
+{
+#ifndef _WIN32
+    if (m_fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(m_fd, &st) < 0 || st.st_size < m_fileSize) {
+        cerr << "WARNING: MatrixFile::map: File \"" << m_fileName
+                  << "\" is shorter than expected, not mapping it" << endl;
+        return false;
+    }
+
+    int prot = PROT_READ;
+    if (m_mode == WriteOnly) prot |= PROT_WRITE;
+
+    void *addr = ::mmap(0, m_fileSize, prot, MAP_SHARED, m_fd, 0);
+    if (addr == MAP_FAILED) {
+        ::perror("WARNING: MatrixFile::map: mmap failed");
+        cerr << "WARNING: MatrixFile::map: Failed to map \"" << m_fileName
+                  << "\", using read and write calls instead" << endl;
+        return false;
+    }
+
+    m_map = (char *)addr;
+
+    // Caches are filled from start to end in a background thread,
+    // but views pick out columns wherever they happen to be looking.
+    // This is only a hint, so its failure doesn't matter
+    char *data = m_map + m_dataOffset;
+    size_t dataSize = size_t(m_fileSize - m_dataOffset);
+    if (dataSize > 0) {
+        ::madvise(data, dataSize,
+                  m_mode == WriteOnly ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+MatrixFile::unmap()
+{
+#ifndef _WIN32
+    if (m_map) {
+        if (::munmap(m_map, m_fileSize) < 0) {
+            ::perror("MatrixFile::unmap: munmap failed");
+        }
+        m_map = 0;
+    }
+#endif
+}
+
+void
+MatrixFile::setMappingEnabled(bool enabled)
+{
+#ifndef _WIN32
+    m_mappingEnabled = enabled;
+#else
+    Q_UNUSED(enabled);
+#endif
+}
+
+bool
+MatrixFile::isMappingEnabled()
+{
+    return m_mappingEnabled;
+}
+
+off_t
+MatrixFile::getFlagOffset(int x) const
+{
+    if (m_layout == MappedLayout) {
+        return m_headerSize + x;
+    } else {
+        return m_headerSize + off_t(x) * m_columnStride;
+    }
+}
+
+off_t
+MatrixFile::getColumnOffset(int x) const
+{
+    if (m_layout == MappedLayout) {
+        return m_dataOffset + off_t(x) * m_columnStride;
+    } else {
+        return getFlagOffset(x) + 1;
+    }
+}
+
 void
 MatrixFile::close()
 {
 #ifdef DEBUG_MATRIX_FILE
     cerr << "MatrixFile::close()" << endl;
 #endif
+    unmap();
     if (m_fd >= 0) {
         if (::close(m_fd) < 0) {
             ::perror("MatrixFile::close: close failed");
@@ -273,6 +470,19 @@ MatrixFile::getColumnAt(int x, void *data)
 
     Profiler profiler("MatrixFile::getColumnAt");
 
+    if (m_map) {
+        const volatile char *flag = m_map + getFlagOffset(x);
+        if (!*flag) {
+            cerr << "MatrixFile[" << m_fd << "]::getColumnAt(" << x << "): Column has not been set" << endl;
+            return;
+        }
+        // Pairs with the release fence in setColumnAt, so that the
+        // data we copy is at least as new as the flag we saw
+        std::atomic_thread_fence(std::memory_order_acquire);
+        memcpy(data, m_map + getColumnOffset(x), m_height * m_cellSize);
+        return;
+    }
+
     ssize_t r = -1;
 
     if (m_readyToReadColumn < 0 ||
@@ -295,6 +505,11 @@ MatrixFile::getColumnAt(int x, void *data)
         }
     }
 
+    if (m_layout == MappedLayout && !seekToColumnData(x)) {
+        cerr << "ERROR: MatrixFile::getColumnAt(" << x << "): Seek failed" << endl;
+        throw FileOperationFailed(m_fileName, "seek");
+    }
+
     r = ::read(m_fd, data, m_height * m_cellSize);
     if (r < 0) {
         ::perror("MatrixFile::getColumnAt: read failed");
@@ -309,6 +524,11 @@ MatrixFile::haveSetColumnAt(int x) const
         return m_setColumns->get(x);
     }
 
+    if (m_map) {
+        const volatile char *flag = m_map + getFlagOffset(x);
+        return *flag != 0;
+    }
+
     if (m_readyToReadColumn >= 0 &&
         int(m_readyToReadColumn) == x) return true;
     
@@ -348,6 +568,20 @@ MatrixFile::setColumnAt(int x, const void *data)
 //    cerr << ".";
 #endif
 
+    if (m_map) {
+        volatile char *flag = m_map + getFlagOffset(x);
+        *flag = 0;
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(m_map + getColumnOffset(x), data, m_height * m_cellSize);
+        std::atomic_thread_fence(std::memory_order_release);
+        *flag = 1;
+        m_setColumns->set(x);
+        if (m_autoClose && m_setColumns->isAllOn()) {
+            close();
+        }
+        return;
+    }
+
     ssize_t w = 0;
 
     if (!seekTo(x)) {
@@ -362,6 +596,11 @@ MatrixFile::setColumnAt(int x, const void *data)
         throw FileOperationFailed(m_fileName, "write");
     }
 
+    if (m_layout == MappedLayout && !seekToColumnData(x)) {
+        cerr << "ERROR: MatrixFile::setColumnAt(" << x << "): Seek failed" << endl;
+        throw FileOperationFailed(m_fileName, "seek");
+    }
+
     w = ::write(m_fd, data, m_height * m_cellSize);
     if (w != ssize_t(m_height * m_cellSize)) {
         ::perror("WARNING: MatrixFile::setColumnAt: write failed (2)");
@@ -417,7 +656,7 @@ MatrixFile::seekTo(int x) const
 
     m_readyToReadColumn = -1; // not ready, unless this is subsequently re-set
 
-    off_t off = m_headerSize + x * m_height * m_cellSize + x;
+    off_t off = getFlagOffset(x);
 
 #ifdef DEBUG_MATRIX_FILE_READ_SET
     if (m_mode == ReadOnly) {
@@ -439,3 +678,24 @@ MatrixFile::seekTo(int x) const
     return true;
 }
 
+bool
+MatrixFile::seekToColumnData(int x) const
+{
+    if (m_fd < 0) {
+        cerr << "ERROR: MatrixFile::seekToColumnData: File not open" << endl;
+        return false;
+    }
+
+    m_readyToReadColumn = -1;
+
+    off_t off = getColumnOffset(x);
+
+    if (::lseek(m_fd, off, SEEK_SET) == (off_t)-1) {
+        ::perror("Seek failed");
+        cerr << "ERROR: MatrixFile::seekToColumnData(" << x
+                  << ") = " << off << " failed" << endl;
+        return false;
+    }
+
+    return true;
+}
@@ -56,7 +56,10 @@ public:
      * persisting until all readers are complete.
      *
      * MatrixFile has no built-in cache and is not thread-safe.  Use a
-     * separate MatrixFile in each thread.
+     * separate MatrixFile in each thread.  The exception is a
+     * memory-mapped reader (see setMappingEnabled), whose
+     * haveSetColumnAt and getColumnAt may be called from several
+     * threads at once.
      */
     MatrixFile(QString fileBase, Mode mode, int cellSize,
                int width, int height);
@@ -80,7 +83,37 @@ public:
     void getColumnAt(int x, void *data); // may throw FileReadFailed
     void setColumnAt(int x, const void *data);
 
+    /**
+     * Return true if this MatrixFile accesses its file through a
+     * memory mapping rather than through read and write calls.
+     */
+    bool isMapped() const { return m_map != 0; }
+
+    /**
+     * Choose whether files created from now on are laid out for, and
+     * accessed through, memory mapping (the default where mmap is
+     * available).  Mapped files keep the column-valid flags together
+     * in a map ahead of the data, and align the data to the page size
+     * (or to 2MB for large files) with each column starting on a
+     * cache line.  Readers follow the layout of the file they open,
+     * whatever this setting.
+     */
+    static void setMappingEnabled(bool enabled);
+    static bool isMappingEnabled();
+
+    /**
+     * Return the size in bytes of the file a writer would create for
+     * a matrix of the given cell size and dimensions, using the
+     * layout implied by the current mapping setting.
+     */
+    static size_t getFileSize(int cellSize, int width, int height);
+
 protected:
+    enum Layout {
+        InterleavedLayout = 0, // flag byte before each column
+        MappedLayout = 1       // flags first, then aligned columns
+    };
+
     int     m_fd;
     Mode    m_mode;
     int     m_flags;
@@ -89,6 +122,11 @@ protected:
     int     m_width;
     int     m_height;
     int     m_headerSize;
+    int     m_layout;
+    off_t   m_dataOffset;
+    int     m_columnStride;
+    off_t   m_fileSize;
+    char   *m_map;
     QString m_fileName;
 
     ResizeableBitset *m_setColumns; // only in writer
@@ -100,9 +138,19 @@ protected:
 
     static std::map<QString, int> m_refcount;
     static QMutex m_createMutex;
+    static bool m_mappingEnabled;
 
     void initialise();
+    void calculateLayout(int layout);
+    static void fileLayout(int layout, int cellSize, int width, int height,
+                           int &columnStride, off_t &dataOffset,
+                           off_t &fileSize);
+    bool map();
+    void unmap();
+    off_t getFlagOffset(int col) const;
+    off_t getColumnOffset(int col) const;
     bool seekTo(int col) const;
+    bool seekToColumnData(int col) const;
 };
 
 #endif
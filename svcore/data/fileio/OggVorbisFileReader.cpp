@@ -26,11 +26,29 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
 #include <QFileInfo>
+#include <QFile>
 
 //static int instances = 0;
 
+// Approximate length of the chunks decoded in CacheSeekIndex mode
+static const sv_frame_t seekChunkFrames = 65536;
+
+struct OggVorbisFileReader::SeekDecoder
+{
+    FishSound *fishSound;
+    int channels;
+    int headerPackets;     // header packets decoded so far (of 3)
+    bool stopAfterHeaders;
+    sv_frame_t end;        // stop once the decoded audio reaches this
+    sv_frame_t first;      // frame of the first decoded sample, once known
+    sv_frame_t decoded;
+    std::vector<float> buffer; // interleaved
+};
+
 OggVorbisFileReader::OggVorbisFileReader(FileSource source,
                                          DecodeMode decodeMode,
                                          CacheMode mode,
@@ -69,6 +87,27 @@ OggVorbisFileReader::OggVorbisFileReader(FileSource source,
     fish_sound_set_decoded_callback(m_fishSound, acceptFrames, this);
     oggz_set_read_callback(m_oggz, -1, (OggzReadPacket)readPacket, this);
 
+    if (m_cacheMode == CacheSeekIndex &&
+        (loadSeekIndex(m_path, "ogg") || buildSeekIndex())) {
+
+        // Decode only as far as the first audio, which is where the
+        // comments are picked up
+        while (!m_commentsRead && oggz_read(m_oggz, 1024) > 0);
+
+        fish_sound_delete(m_fishSound);
+        m_fishSound = 0;
+        oggz_close(m_oggz);
+        m_oggz = 0;
+
+        if (m_reporter) m_reporter->setProgress(100);
+        m_completion = 100;
+        return;
+    }
+
+    if (m_cacheMode == CacheSeekIndex) {
+        m_cacheMode = CacheInTemporaryFile;
+    }
+
     if (decodeMode == DecodeAtOnce) {
 
         if (m_reporter) {
@@ -190,6 +229,8 @@ OggVorbisFileReader::acceptFrames(FishSound *fs, float **frames, long nframes,
         reader->m_commentsRead = true;
     }
 
+    if (reader->m_cacheMode == CacheSeekIndex) return 1;
+
     if (reader->m_channelCount == 0) {
 	FishSoundInfo fsinfo;
 	fish_sound_command(fs, FISH_SOUND_GET_INFO,
@@ -207,6 +248,228 @@ OggVorbisFileReader::acceptFrames(FishSound *fs, float **frames, long nframes,
     return 0;
 }
 
+static inline quint32
+readLittleEndian32(const uchar *data)
+{
+    return quint32(data[0]) | (quint32(data[1]) << 8) |
+        (quint32(data[2]) << 16) | (quint32(data[3]) << 24);
+}
+
+bool
+OggVorbisFileReader::buildSeekIndex()
+{
+    Profiler profiler("OggVorbisFileReader::buildSeekIndex", true);
+
+    // The Ogg pages are scanned directly, without decoding anything.
+    // The granule position of a page is the frame at which the audio
+    // of the last packet completed on it ends.  A seek point for a
+    // page starts decoding from the previous page, because the first
+    // packet decoded after a seek produces no audio.
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    if (!data) return false;
+
+    SeekIndex index;
+    SeekPoint start;
+    start.frame = 0;
+    start.offset = 0;
+    start.preroll = 0;
+    index.push_back(start);
+
+    bool first = true;
+    quint32 serial = 0;
+    int channels = 0;
+    sv_samplerate_t rate = 0;
+    qint64 previousOffset = -1;
+    sv_frame_t frameCount = 0;
+    qint64 pos = 0;
+
+    while (pos + 27 <= size && !m_cancelled) {
+
+        const uchar *page = data + pos;
+        if (memcmp(page, "OggS", 4) != 0) {
+            ++pos; // lost sync
+            continue;
+        }
+
+        int segments = page[26];
+        if (pos + 27 + segments > size) break;
+        qint64 bodySize = 0;
+        for (int i = 0; i < segments; ++i) bodySize += page[27 + i];
+        qint64 pageSize = 27 + segments + bodySize;
+        if (pos + pageSize > size) break;
+
+        const uchar *body = page + 27 + segments;
+        qint64 granule = qint64(quint64(readLittleEndian32(page + 6)) |
+                                (quint64(readLittleEndian32(page + 10)) << 32));
+        quint32 pageSerial = readLittleEndian32(page + 14);
+
+        if (first) {
+            // Vorbis identification header: packet type, "vorbis",
+            // version, channels, sample rate
+            if (bodySize < 16 || body[0] != 1 ||
+                memcmp(body + 1, "vorbis", 6) != 0) {
+                break;
+            }
+            serial = pageSerial;
+            channels = body[11];
+            rate = readLittleEndian32(body + 12);
+            first = false;
+        } else if (pageSerial == serial && granule != -1) {
+            if (granule >= index.back().frame + seekChunkFrames &&
+                previousOffset > 0) {
+                SeekPoint point;
+                point.frame = granule;
+                point.offset = previousOffset;
+                point.preroll = 0;
+                index.push_back(point);
+            }
+            frameCount = std::max(frameCount, sv_frame_t(granule));
+        }
+
+        if (pageSerial == serial) previousOffset = pos;
+        pos += pageSize;
+    }
+
+    file.unmap(data);
+
+    if (m_cancelled || first || channels == 0 || rate == 0 ||
+        frameCount == 0) {
+        return false;
+    }
+
+    while (index.size() > 1 && index.back().frame >= frameCount) {
+        index.pop_back();
+    }
+
+    m_fileRate = rate;
+    m_channelCount = channels;
+
+    if (!initialiseSeekIndex(index, frameCount)) {
+        m_fileRate = 0;
+        m_channelCount = 0;
+        return false;
+    }
+
+    saveSeekIndex(m_path, "ogg");
+    return true;
+}
+
+bool
+OggVorbisFileReader::decodeSeekChunk(int chunk, SampleBlock &interleaved) const
+{
+    // If a seek point turns out to start too late for its chunk,
+    // try again from the ones before it
+    for (int point = chunk; point >= 0 && point >= chunk - 2; --point) {
+        if (decodeSeekChunkFrom(point, chunk, interleaved)) return true;
+    }
+    return false;
+}
+
+bool
+OggVorbisFileReader::decodeSeekChunkFrom(int point, int chunk,
+                                         SampleBlock &interleaved) const
+{
+    const SeekIndex &index = getSeekIndex();
+    sv_frame_t from = index[chunk].frame;
+    sv_frame_t to = getSeekChunkEnd(chunk);
+    qint64 offset = index[point].offset;
+
+    OGGZ *oggz = oggz_open(m_path.toLocal8Bit().data(), OGGZ_READ);
+    if (!oggz) return false;
+
+    FishSoundInfo fsinfo;
+    SeekDecoder decoder;
+    decoder.fishSound = fish_sound_new(FISH_SOUND_DECODE, &fsinfo);
+    decoder.channels = getChannelCount();
+    decoder.headerPackets = 0;
+    decoder.stopAfterHeaders = (offset > 0);
+    decoder.end = to;
+    decoder.first = -1;
+    decoder.decoded = 0;
+
+    fish_sound_set_decoded_callback(decoder.fishSound, acceptSeekFrames, &decoder);
+    oggz_set_read_callback(oggz, -1, (OggzReadPacket)readSeekPacket, &decoder);
+
+    bool ok = true;
+
+    if (offset > 0) {
+        // The decoder needs the three header packets before any
+        // audio, and those are at the start of the file
+        while (decoder.headerPackets < 3 && oggz_read(oggz, 1024) > 0);
+        ok = (decoder.headerPackets == 3 &&
+              oggz_seek(oggz, offset, SEEK_SET) >= 0);
+    }
+
+    if (ok) {
+        while (oggz_read(oggz, 4096) > 0);
+        ok = (decoder.first >= 0 && decoder.first <= from);
+    }
+
+    if (ok) {
+        sv_frame_t a = from - decoder.first;
+        sv_frame_t b = std::min(to - decoder.first, decoder.decoded);
+        if (b < a) b = a;
+        interleaved.assign(decoder.buffer.begin() + a * decoder.channels,
+                           decoder.buffer.begin() + b * decoder.channels);
+    }
+
+    fish_sound_delete(decoder.fishSound);
+    oggz_close(oggz);
+
+    return ok;
+}
+
+int
+OggVorbisFileReader::readSeekPacket(OGGZ *, ogg_packet *packet, long, void *data)
+{
+    SeekDecoder *decoder = (SeekDecoder *)data;
+    FishSound *fs = decoder->fishSound;
+
+    fish_sound_prepare_truncation(fs, packet->granulepos, int(packet->e_o_s));
+    fish_sound_decode(fs, packet->packet, packet->bytes);
+
+    if (decoder->headerPackets < 3) {
+        ++decoder->headerPackets;
+        if (decoder->headerPackets == 3 && decoder->stopAfterHeaders) {
+            return 1;
+        }
+        return 0;
+    }
+
+    // The granule position of a packet is the frame at which its
+    // audio ends, which locates everything decoded so far
+    if (decoder->first < 0 && packet->granulepos != -1) {
+        decoder->first = sv_frame_t(packet->granulepos) - decoder->decoded;
+    }
+
+    if (decoder->first >= 0 &&
+        decoder->first + decoder->decoded >= decoder->end) {
+        return 1;
+    }
+    return 0;
+}
+
+int
+OggVorbisFileReader::acceptSeekFrames(FishSound *, float **frames, long nframes,
+                                      void *data)
+{
+    SeekDecoder *decoder = (SeekDecoder *)data;
+
+    for (long i = 0; i < nframes; ++i) {
+        for (int c = 0; c < decoder->channels; ++c) {
+            decoder->buffer.push_back(frames[c][i]);
+        }
+    }
+    decoder->decoded += nframes;
+
+    return 0;
+}
+
 void
 OggVorbisFileReader::getSupportedExtensions(std::set<QString> &extensions)
 {
@@ -88,6 +88,13 @@ protected:
     static int readPacket(OGGZ *, ogg_packet *, long, void *);
     static int acceptFrames(FishSound *, float **, long, void *);
 
+    struct SeekDecoder;
+    bool buildSeekIndex();
+    virtual bool decodeSeekChunk(int chunk, SampleBlock &interleaved) const;
+    bool decodeSeekChunkFrom(int point, int chunk, SampleBlock &interleaved) const;
+    static int readSeekPacket(OGGZ *, ogg_packet *, long, void *);
+    static int acceptSeekFrames(FishSound *, float **, long, void *);
+
     class DecodeThread : public Thread
     {
     public:
@@ -15,6 +15,8 @@
 
 #include "WavFileReader.h"
 
+#include "base/Trace.h"
+
 #include <iostream>
 
 #include <QMutexLocker>
@@ -160,6 +162,10 @@ WavFileReader::getInterleavedFrames(sv_frame_t start, sv_frame_t count) const
             return SampleBlock();
         }
 
+        // Counted as decoded sample data, whatever the file format
+        TraceCounter::bytesRead().add(readCount * m_fileInfo.channels *
+                                      sizeof(float));
+
         m_buffer.resize(readCount * m_fileInfo.channels);
         
         m_lastStart = start;
@@ -18,6 +18,8 @@
 
 #include "../AudioFileReaderFactory.h"
 #include "../AudioFileReader.h"
+#include "../MP3FileReader.h"
+#include "../OggVorbisFileReader.h"
 
 #include "AudioTestData.h"
 
@@ -191,6 +193,90 @@ private slots:
 	    }
 	}
     }
+
+    void readSeekIndexed_data()
+    {
+        QTest::addColumn<QString>("audiofile");
+        QStringList files = QDir(audioDir).entryList
+            (QStringList() << "*.mp3" << "*.ogg", QDir::Files);
+        foreach (QString filename, files) {
+            QTest::newRow(strOf(filename)) << filename;
+        }
+    }
+
+    void readSeekIndexed()
+    {
+        QFETCH(QString, audiofile);
+
+        QString path = audioDir + "/" + audiofile;
+        QString extension = audiofile.split(".")[1];
+
+        // Reference: the whole file decoded up front
+        AudioFileReader *full = 0;
+#ifdef HAVE_MAD
+        if (extension == "mp3") {
+            full = new MP3FileReader(path, MP3FileReader::DecodeAtOnce,
+                                     MP3FileReader::CacheInMemory);
+        }
+#endif
+#ifdef HAVE_OGGZ
+#ifdef HAVE_FISHSOUND
+        if (extension == "ogg") {
+            full = new OggVorbisFileReader(path, OggVorbisFileReader::DecodeAtOnce,
+                                           OggVorbisFileReader::CacheInMemory);
+        }
+#endif
+#endif
+        if (!full || !full->isOK()) {
+            delete full;
+#if ( QT_VERSION >= 0x050000 )
+            QSKIP("Unsupported file, skipping");
+#else
+            QSKIP("Unsupported file, skipping", SkipSingle);
+#endif
+        }
+
+        // Opened twice: the second time from the persisted seek index
+        for (int pass = 0; pass < 2; ++pass) {
+
+            AudioFileReader *reader =
+                AudioFileReaderFactory::createReader(path);
+            QVERIFY(reader);
+            QCOMPARE(reader->getChannelCount(), full->getChannelCount());
+            QCOMPARE(reader->getSampleRate(), full->getSampleRate());
+
+            int channels = reader->getChannelCount();
+            sv_frame_t frames = std::min(reader->getFrameCount(),
+                                         full->getFrameCount());
+            QVERIFY(frames > 0);
+
+            vector<float> reference = full->getInterleavedFrames(0, frames);
+
+            // Regions in no particular order, some of them spanning
+            // chunk boundaries, compared with the full decode
+            sv_frame_t starts[] = { frames / 2, 0, frames - 100, 1151,
+                                    frames / 3, 65530, frames / 2 - 7 };
+            for (sv_frame_t start: starts) {
+                if (start < 0 || start >= frames) continue;
+                sv_frame_t count = std::min(sv_frame_t(20000), frames - start);
+                vector<float> test = reader->getInterleavedFrames(start, count);
+                QCOMPARE(sv_frame_t(test.size()), count * channels);
+                float maxdiff = 0.f;
+                for (sv_frame_t i = 0; i < count * channels; ++i) {
+                    float diff = fabsf(test[i] - reference[start * channels + i]);
+                    if (diff > maxdiff) maxdiff = diff;
+                }
+                if (maxdiff >= 0.001f) {
+                    cerr << "ERROR: for audiofile " << audiofile << ": max diff = " << maxdiff << " reading " << count << " frames from " << start << endl;
+                    QVERIFY(maxdiff < 0.001f);
+                }
+            }
+
+            delete reader;
+        }
+
+        delete full;
+    }
 };
 
 #endif
@@ -0,0 +1,117 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef TEST_MATRIX_FILE_H
+#define TEST_MATRIX_FILE_H
+
+#include "../MatrixFile.h"
+
+#include <QObject>
+#include <QThread>
+#include <QtTest>
+
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+class MatrixFileTestReader : public QThread
+{
+public:
+    MatrixFileTestReader(MatrixFile *mf) : m_mf(mf), m_errors(0) { }
+    int errors() const { return m_errors; }
+
+protected:
+    void run() {
+        int h = m_mf->getHeight();
+        vector<float> column(h);
+        for (int x = m_mf->getWidth() - 1; x >= 0; --x) {
+            if (!m_mf->haveSetColumnAt(x)) { ++m_errors; continue; }
+            m_mf->getColumnAt(x, column.data());
+            for (int y = 0; y < h; ++y) {
+                if (column[y] != float(x * h + y)) ++m_errors;
+            }
+        }
+    }
+
+private:
+    MatrixFile *m_mf;
+    int m_errors;
+};
+
+class MatrixFileTest : public QObject
+{
+    Q_OBJECT
+
+    void fill(vector<float> &column, int x) {
+        int h = int(column.size());
+        for (int y = 0; y < h; ++y) column[y] = float(x * h + y);
+    }
+
+    void roundTrip(bool mapped, QString fileBase) {
+        int w = 300, h = 129;
+        bool wasEnabled = MatrixFile::isMappingEnabled();
+        MatrixFile::setMappingEnabled(mapped);
+        MatrixFile writer(fileBase, MatrixFile::WriteOnly, sizeof(float), w, h);
+        MatrixFile::setMappingEnabled(wasEnabled);
+        MatrixFile reader(fileBase, MatrixFile::ReadOnly, sizeof(float), w, h);
+        QCOMPARE(writer.isMapped(), reader.isMapped());
+        vector<float> column(h), result(h);
+        for (int x = 0; x < w; x += 2) {
+            fill(column, x);
+            writer.setColumnAt(x, column.data());
+        }
+        for (int x = 0; x < w; ++x) {
+            QCOMPARE(reader.haveSetColumnAt(x), x % 2 == 0);
+            QCOMPARE(writer.haveSetColumnAt(x), x % 2 == 0);
+            if (x % 2 != 0) continue;
+            reader.getColumnAt(x, result.data());
+            fill(column, x);
+            QVERIFY(result == column);
+        }
+    }
+
+private slots:
+    void syscall() {
+        roundTrip(false, "test-matrix-syscall");
+    }
+
+    void mapped() {
+        roundTrip(true, "test-matrix-mapped");
+    }
+
+    void sharedReader() {
+        // A mapped reader can serve several threads at once
+        int w = 500, h = 257;
+        bool wasEnabled = MatrixFile::isMappingEnabled();
+        MatrixFile::setMappingEnabled(true);
+        MatrixFile writer("test-matrix-shared", MatrixFile::WriteOnly, sizeof(float), w, h);
+        MatrixFile::setMappingEnabled(wasEnabled);
+        vector<float> column(h);
+        for (int x = 0; x < w; ++x) {
+            fill(column, x);
+            writer.setColumnAt(x, column.data());
+        }
+        MatrixFile reader("test-matrix-shared", MatrixFile::ReadOnly, sizeof(float), w, h);
+        if (!reader.isMapped()) {
+            QSKIP("Memory mapping not available");
+        }
+        MatrixFileTestReader a(&reader), b(&reader), c(&reader);
+        a.start(); b.start(); c.start();
+        a.wait(); b.wait(); c.wait();
+        QCOMPARE(a.errors() + b.errors() + c.errors(), 0);
+    }
+};
+
+#endif
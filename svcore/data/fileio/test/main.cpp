@@ -13,6 +13,7 @@
 */
 
 #include "AudioFileReaderTest.h"
+#include "MatrixFileTest.h"
 
 #include <QtTest>
 
@@ -32,6 +33,12 @@ int main(int argc, char *argv[])
 	else ++bad;
     }
 
+    {
+	MatrixFileTest t;
+	if (QTest::qExec(&t, argc, argv) == 0) ++good;
+	else ++bad;
+    }
+
     if (bad > 0) {
 	cerr << "\n********* " << bad << " test suite(s) failed!\n" << endl;
 	return 1;
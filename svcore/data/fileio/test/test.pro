@@ -50,7 +50,8 @@ OBJECTS_DIR = o
 MOC_DIR = o
 
 HEADERS += AudioFileReaderTest.h \
-           AudioTestData.h
+           AudioTestData.h \
+           MatrixFileTest.h
 SOURCES += main.cpp
 
 win* {
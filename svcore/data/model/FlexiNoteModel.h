@@ -185,12 +185,12 @@ public:
             return IntervalModel<FlexiNote>::getData(row, column, role);
         }
 
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return QVariant();
+        Point point(0);
+        if (!getPointForRow(row, point)) return QVariant();
 
         switch (column) {
-        case 4: return i->level;
-        case 5: return i->label;
+        case 4: return point.level;
+        case 5: return point.label;
         default: return QVariant();
         }
     }
@@ -203,11 +203,10 @@ public:
         }
 
         if (role != Qt::EditRole) return 0;
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return 0;
+        Point point(0);
+        if (!getPointForRow(row, point)) return 0;
         EditCommand *command = new EditCommand(this, tr("Edit Data"));
 
-        Point point(*i);
         command->deletePoint(point);
 
         switch (column) {
@@ -72,16 +72,15 @@ public:
                 (row, column, role);
         }
 
-        typename SparseModel<PointType>::PointList::const_iterator i
-            = SparseModel<PointType>::getPointListIteratorForRow(row);
-        if (i == SparseModel<PointType>::m_points.end()) return QVariant();
+        PointType point(0);
+        if (!SparseModel<PointType>::getPointForRow(row, point)) return QVariant();
 
         switch (column) {
         case 2:
-            if (role == Qt::EditRole || role == TabularModel::SortRole) return i->value;
-            else return QString("%1 %2").arg(i->value).arg
+            if (role == Qt::EditRole || role == TabularModel::SortRole) return point.value;
+            else return QString("%1 %2").arg(point.value).arg
                      (IntervalModel<PointType>::getScaleUnits());
-        case 3: return int(i->duration); //!!! could be better presented
+        case 3: return int(point.duration); //!!! could be better presented
         default: return QVariant();
         }
     }
@@ -96,13 +95,11 @@ public:
         }
 
         if (role != Qt::EditRole) return 0;
-        typename I::PointList::const_iterator i
-            = I::getPointListIteratorForRow(row);
-        if (i == I::m_points.end()) return 0;
+        PointType point(0);
+        if (!I::getPointForRow(row, point)) return 0;
         typename I::EditCommand *command = new typename I::EditCommand
             (this, I::tr("Edit Data"));
 
-        PointType point(*i);
         command->deletePoint(point);
 
         switch (column) {
@@ -166,11 +166,11 @@ public:
             return IntervalModel<RegionRec>::getData(row, column, role);
         }
 
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return QVariant();
+        Point point(0);
+        if (!getPointForRow(row, point)) return QVariant();
 
         switch (column) {
-        case 4: return i->label;
+        case 4: return point.label;
         default: return QVariant();
         }
     }
@@ -183,11 +183,10 @@ public:
         }
 
         if (role != Qt::EditRole) return 0;
-        PointListIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return 0;
+        Point point(0);
+        if (!getPointForRow(row, point)) return 0;
         EditCommand *command = new EditCommand(this, tr("Edit Data"));
 
-        Point point(*i);
         command->deletePoint(point);
 
         switch (column) {
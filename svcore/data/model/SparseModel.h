@@ -19,6 +19,7 @@
 #include "Model.h"
 #include "TabularModel.h"
 #include "base/Command.h"
+#include "base/ChunkedSortedList.h"
 #include "PraalineCore/Base/RealTime.h"
 
 #include <iostream>
@@ -68,7 +69,10 @@ public:
     virtual void extendEndFrame(sv_frame_t to) { m_extendTo = to; }
     
     typedef PointType Point;
-    typedef std::multiset<PointType,
+
+    // Points are kept sorted in contiguous chunks shared between
+    // copies, so that returning a range of them copies no points
+    typedef ChunkedSortedList<PointType,
     typename PointType::OrderComparator> PointList;
     typedef typename PointList::iterator PointListIterator;
     typedef typename PointList::const_iterator PointListConstIterator;
@@ -92,7 +96,9 @@ public:
      * Get all of the points in this model between the given
      * boundaries (in frames), as well as up to two points before and
      * after the boundaries.  If you need exact boundaries, check the
-     * point coordinates in the returned list.
+     * point coordinates in the returned list.  The returned list
+     * shares its storage with the model until either is modified, so
+     * this does not copy the points.
      */
     virtual PointList getPoints(sv_frame_t start, sv_frame_t end) const;
 
@@ -302,37 +308,37 @@ public:
 
     virtual sv_frame_t getFrameForRow(int row) const
     {
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return 0;
-        return i->frame;
+        Point point(0);
+        if (!getPointForRow(row, point)) return 0;
+        return point.frame;
     }
 
     virtual int getRowForFrame(sv_frame_t frame) const
     {
-        if (m_rows.empty()) rebuildRowVector();
-        std::vector<sv_frame_t>::iterator i =
-                std::lower_bound(m_rows.begin(), m_rows.end(), frame);
-        ssize_t row = std::distance(m_rows.begin(), i);
-        if (i != m_rows.begin() && (i == m_rows.end() || *i != frame)) {
+        QMutexLocker locker(&m_mutex);
+        PointListConstIterator i = m_points.lowerBound(frame, FrameLess());
+        int row = int(m_points.size());
+        if (i != m_points.end()) row = m_points.indexOf(i);
+        if (i != m_points.begin() && (i == m_points.end() || i->frame != frame)) {
             --row;
         }
-        return int(row);
+        return row;
     }
 
     virtual int getColumnCount() const { return 1; }
     virtual QVariant getData(int row, int column, int role) const
     {
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return QVariant();
+        Point point(0);
+        if (!getPointForRow(row, point)) return QVariant();
 
         switch (column) {
         case 0: {
-            if (role == SortRole) return int(i->frame);
-            RealTime rt = RealTime::frame2RealTime(i->frame, getSampleRate());
+            if (role == SortRole) return int(point.frame);
+            RealTime rt = RealTime::frame2RealTime(point.frame, getSampleRate());
             if (role == Qt::EditRole) return rt.toString().c_str();
             else return rt.toText().c_str();
         }
-        case 1: return int(i->frame);
+        case 1: return int(point.frame);
         }
 
         return QVariant();
@@ -342,11 +348,10 @@ public:
                                          const QVariant &value, int role)
     {
         if (role != Qt::EditRole) return 0;
-        PointListIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return 0;
+        Point point(0);
+        if (!getPointForRow(row, point)) return 0;
         EditCommand *command = new EditCommand(this, tr("Edit Data"));
 
-        Point point(*i);
         command->deletePoint(point);
 
         switch (column) {
@@ -362,19 +367,18 @@ public:
     {
         EditCommand *command = new EditCommand(this, tr("Insert Data Point"));
         Point point(0);
-        PointListIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end() && i != m_points.begin()) --i;
-        if (i != m_points.end()) point = *i;
+        // After the last row, copy the last point
+        if (!getPointForRow(row, point)) getPointForRow(getRowCount() - 1, point);
         command->addPoint(point);
         return command->finish();
     }
 
     virtual UndoableCommand *getRemoveRowCommand(int row)
     {
-        PointListIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return 0;
+        Point point(0);
+        if (!getPointForRow(row, point)) return 0;
         EditCommand *command = new EditCommand(this, tr("Delete Data Point"));
-        command->deletePoint(*i);
+        command->deletePoint(point);
         return command->finish();
     }
 
@@ -392,83 +396,29 @@ protected:
     mutable QMutex m_mutex;
     int m_completion;
 
-    void getPointIterators(sv_frame_t frame,
-                           PointListIterator &startItr,
-                           PointListIterator &endItr);
+    // Caller must hold m_mutex for as long as it uses the iterators
     void getPointIterators(sv_frame_t frame,
                            PointListConstIterator &startItr,
                            PointListConstIterator &endItr) const;
 
-    // This is only used if the model is called on to act in
-    // TabularModel mode
-    mutable std::vector<sv_frame_t> m_rows; // map from row number to frame
-    void rebuildRowVector() const
-    {
-        m_rows.clear();
-        for (PointListConstIterator i = m_points.begin(); i != m_points.end(); ++i) {
-            //            std::cerr << "rebuildRowVector: row " << m_rows.size() << " -> " << i->frame << std::endl;
-            m_rows.push_back(i->frame);
-        }
-    }
-
-    PointListIterator getPointListIteratorForRow(int row)
-    {
-        if (m_rows.empty()) rebuildRowVector();
-        if (row < 0 || row + 1 > int(m_rows.size())) return m_points.end();
-
-        sv_frame_t frame = m_rows[row];
-        int indexAtFrame = 0;
-        int ri = row;
-        while (ri > 0 && m_rows[ri-1] == m_rows[row]) { --ri; ++indexAtFrame; }
-        int initialIndexAtFrame = indexAtFrame;
-
-        PointListIterator i0, i1;
-        getPointIterators(frame, i0, i1);
-        PointListIterator i = i0;
-
-        for (i = i0; i != i1; ++i) {
-            if (i->frame < (int)frame) { continue; }
-            if (indexAtFrame > 0) { --indexAtFrame; continue; }
-            return i;
-        }
-
-        if (indexAtFrame > 0) {
-            std::cerr << "WARNING: SparseModel::getPointListIteratorForRow: No iterator available for row " << row << " (frame = " << frame << ", index at frame = " << initialIndexAtFrame << ", leftover index " << indexAtFrame << ")" << std::endl;
+    struct FrameLess {
+        bool operator()(const PointType &point, sv_frame_t frame) const {
+            return point.frame < frame;
         }
-        return i;
-    }
+    };
 
-    PointListConstIterator getPointListIteratorForRow(int row) const
+    // Rows are the points in sort order; the lookup is logarithmic
+    // in the number of points.  The point is copied while the mutex
+    // is held, as another thread may add or delete points (and so
+    // move the others) as soon as it is released.  Return false if
+    // the row is out of range.
+    bool getPointForRow(int row, PointType &point) const
     {
-        if (m_rows.empty()) rebuildRowVector();
-        if (row < 0 || row + 1 > int(m_rows.size())) return m_points.end();
-
-        sv_frame_t frame = m_rows[row];
-        int indexAtFrame = 0;
-        int ri = row;
-        while (ri > 0 && m_rows[ri-1] == m_rows[row]) { --ri; ++indexAtFrame; }
-        int initialIndexAtFrame = indexAtFrame;
-
-        //        std::cerr << "getPointListIteratorForRow " << row << ": initialIndexAtFrame = " << initialIndexAtFrame << std::endl;
-
-        PointListConstIterator i0, i1;
-        getPointIterators(frame, i0, i1);
-        PointListConstIterator i = i0;
-
-        for (i = i0; i != i1; ++i) {
-            //            std::cerr << "i->frame is " << i->frame << ", wanting " << frame << std::endl;
-
-            if (i->frame < (int)frame) { continue; }
-            if (indexAtFrame > 0) { --indexAtFrame; continue; }
-            return i;
-        }
-
-        //        std::cerr << "returning i with i->frame = " << i->frame << std::endl;
-
-        if (indexAtFrame > 0) {
-            std::cerr << "WARNING: SparseModel::getPointListIteratorForRow: No iterator available for row " << row << " (frame = " << frame << ", index at frame = " << initialIndexAtFrame << ", leftover index " << indexAtFrame << ")" << std::endl;
-        }
-        return i;
+        QMutexLocker locker(&m_mutex);
+        PointListConstIterator i = m_points.iteratorAt(row);
+        if (i == m_points.end()) return false;
+        point = *i;
+        return true;
     }
 
     QString toDelimitedDataStringSubsetFilled(QString delimiter,
@@ -596,52 +546,21 @@ SparseModel<PointType>::getPoints(sv_frame_t start, sv_frame_t end) const
     if (endItr != m_points.end()) ++endItr;
     if (endItr != m_points.end()) ++endItr;
 
-    PointList rv;
-
-    for (PointListConstIterator i = startItr; i != endItr; ++i) {
-        rv.insert(*i);
-    }
-
-    return rv;
+    return PointList(startItr, endItr);
 }
 
 template <typename PointType>
 typename SparseModel<PointType>::PointList
 SparseModel<PointType>::getPoints(sv_frame_t frame) const
 {
-    PointListConstIterator startItr, endItr;
-    getPointIterators(frame, startItr, endItr);
-
-    PointList rv;
-
-    for (PointListConstIterator i = startItr; i != endItr; ++i) {
-        rv.insert(*i);
-    }
-
-    return rv;
-}
-
-template <typename PointType>
-void
-SparseModel<PointType>::getPointIterators(sv_frame_t frame,
-                                          PointListIterator &startItr,
-                                          PointListIterator &endItr)
-{
+    // The iterators are only valid while the lock is held: a concurrent
+    // addPoint may split and reallocate the chunk they point into
     QMutexLocker locker(&m_mutex);
 
-    if (m_resolution == 0) {
-        startItr = m_points.end();
-        endItr = m_points.end();
-        return;
-    }
-
-    sv_frame_t start = (frame / m_resolution) * m_resolution;
-    sv_frame_t end = start + m_resolution;
-
-    PointType startPoint(start), endPoint(end);
+    PointListConstIterator startItr, endItr;
+    getPointIterators(frame, startItr, endItr);
 
-    startItr = m_points.lower_bound(startPoint);
-    endItr = m_points.upper_bound(endPoint);
+    return PointList(startItr, endItr);
 }
 
 template <typename PointType>
@@ -650,7 +569,7 @@ SparseModel<PointType>::getPointIterators(sv_frame_t frame,
                                           PointListConstIterator &startItr,
                                           PointListConstIterator &endItr) const
 {
-    QMutexLocker locker(&m_mutex);
+    // Called with m_mutex held
 
     if (m_resolution == 0) {
         //        std::cerr << "getPointIterators: resolution == 0, returning end()" << std::endl;
@@ -722,7 +641,6 @@ SparseModel<PointType>::setResolution(int resolution)
         QMutexLocker locker(&m_mutex);
         m_resolution = resolution;
     }
-    m_rows.clear();
     emit modelChanged();
 }
 
@@ -735,7 +653,6 @@ SparseModel<PointType>::clear()
         m_points.clear();
         m_pointCount = 0;
     }
-    m_rows.clear();
     emit modelChanged();
 }
 
@@ -757,7 +674,6 @@ SparseModel<PointType>::addPoint(const PointType &point)
     // alternative is to notify on setCompletion).
 
     if (m_notifyOnAdd) {
-        m_rows.clear(); //!!! inefficient
         emit modelChangedWithin(point.frame, point.frame + m_resolution);
     } else {
         if (m_sinceLastNotifyMin == -1 ||
@@ -792,7 +708,6 @@ SparseModel<PointType>::deletePoint(const PointType &point)
     }
     //    std::cout << "SparseOneDimensionalModel: emit modelChanged("
     //	      << point.frame << ")" << std::endl;
-    m_rows.clear(); //!!! inefficient
     emit modelChangedWithin(point.frame, point.frame + m_resolution);
 }
 
@@ -812,7 +727,6 @@ SparseModel<PointType>::setCompletion(int completion, bool update)
             }
 
             m_notifyOnAdd = true; // henceforth
-            m_rows.clear(); //!!! inefficient
             emit modelChanged();
 
         } else if (!m_notifyOnAdd) {
@@ -820,7 +734,6 @@ SparseModel<PointType>::setCompletion(int completion, bool update)
             if (update &&
                     m_sinceLastNotifyMin >= 0 &&
                     m_sinceLastNotifyMax >= 0) {
-                m_rows.clear(); //!!! inefficient
                 emit modelChangedWithin(m_sinceLastNotifyMin, m_sinceLastNotifyMax);
                 m_sinceLastNotifyMin = m_sinceLastNotifyMax = -1;
             } else {
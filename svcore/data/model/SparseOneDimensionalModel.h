@@ -98,6 +98,7 @@ public:
     int getIndexOf(const Point &point)
     {
         // slow
+        QMutexLocker locker(&m_mutex);
         int i = 0;
         Point::Comparator comparator;
         for (PointList::const_iterator j = m_points.begin();
@@ -136,11 +137,11 @@ public:
                     (row, column, role);
         }
 
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return QVariant();
+        Point point(0);
+        if (!getPointForRow(row, point)) return QVariant();
 
         switch (column) {
-        case 2: return i->label;
+        case 2: return point.label;
         default: return QVariant();
         }
     }
@@ -153,11 +154,10 @@ public:
         }
 
         if (role != Qt::EditRole) return 0;
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return 0;
+        Point point(0);
+        if (!getPointForRow(row, point)) return 0;
         EditCommand *command = new EditCommand(this, tr("Edit Data"));
 
-        Point point(*i);
         command->deletePoint(point);
 
         switch (column) {
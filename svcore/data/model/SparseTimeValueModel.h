@@ -137,14 +137,14 @@ public:
                     (row, column, role);
         }
 
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return QVariant();
+        Point point(0);
+        if (!getPointForRow(row, point)) return QVariant();
 
         switch (column) {
         case 2:
-            if (role == Qt::EditRole || role == SortRole) return i->value;
-            else return QString("%1 %2").arg(i->value).arg(getScaleUnits());
-        case 3: return i->label;
+            if (role == Qt::EditRole || role == SortRole) return point.value;
+            else return QString("%1 %2").arg(point.value).arg(getScaleUnits());
+        case 3: return point.label;
         default: return QVariant();
         }
     }
@@ -157,11 +157,10 @@ public:
         }
 
         if (role != Qt::EditRole) return 0;
-        PointListConstIterator i = getPointListIteratorForRow(row);
-        if (i == m_points.end()) return 0;
+        Point point(0);
+        if (!getPointForRow(row, point)) return 0;
         EditCommand *command = new EditCommand(this, tr("Edit Data"));
 
-        Point point(*i);
         command->deletePoint(point);
 
         switch (column) {
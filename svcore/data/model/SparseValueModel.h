@@ -94,17 +94,21 @@ public:
 
             float formerMin = m_valueMinimum, formerMax = m_valueMaximum;
 
-            for (typename SparseModel<PointType>::PointList::const_iterator i
-                 = m_points.begin();
-                 i != m_points.end(); ++i) {
-
-                if (i == m_points.begin() || i->value < m_valueMinimum) {
-                    m_valueMinimum = i->value;
-                    // std::cerr << "deletePoint: value min = " << m_valueMinimum << std::endl;
-                }
-                if (i == m_points.begin() || i->value > m_valueMaximum) {
-                    m_valueMaximum = i->value;
-                    // std::cerr << "deletePoint: value max = " << m_valueMaximum << std::endl;
+            {
+                QMutexLocker locker(&this->m_mutex);
+
+                for (typename SparseModel<PointType>::PointList::const_iterator i
+                     = m_points.begin();
+                     i != m_points.end(); ++i) {
+
+                    if (i == m_points.begin() || i->value < m_valueMinimum) {
+                        m_valueMinimum = i->value;
+                        // std::cerr << "deletePoint: value min = " << m_valueMinimum << std::endl;
+                    }
+                    if (i == m_points.begin() || i->value > m_valueMaximum) {
+                        m_valueMaximum = i->value;
+                        // std::cerr << "deletePoint: value max = " << m_valueMaximum << std::endl;
+                    }
                 }
             }
 
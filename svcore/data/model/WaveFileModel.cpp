@@ -21,6 +21,7 @@
 #include "system/System.h"
 
 #include "base/Preferences.h"
+#include "base/Trace.h"
 
 #include <QFileInfo>
 #include <QTextStream>
@@ -664,6 +665,9 @@ WaveFileModel::RangeCacheFillThread::run()
     SampleBlock block;
 
     if (!m_model.isOK()) return;
+
+    Trace::setThreadName("Waveform summary");
+    TraceSpan span("audio", "waveform summary fill");
     
     int channels = m_model.getChannelCount();
     bool updating = m_model.m_reader->isUpdating();
@@ -286,63 +286,37 @@ DSSIPluginFactory::getLRDFPath(QString &baseUri)
 void
 DSSIPluginFactory::discoverPluginsFrom(QString soname)
 {
-    Profiler profiler("DSSIPluginFactory::discoverPlugins");
-
-    // Note that soname is expected to be a full path at this point,
-    // of a file that is known to exist
-
-    void *libraryHandle = DLOPEN(soname, RTLD_LAZY);
-
-    if (!libraryHandle) {
-        cerr << "WARNING: DSSIPluginFactory::discoverPlugins: couldn't load plugin library "
-                  << soname << " - " << DLERROR() << endl;
+    PluginScanCache::PluginList plugins;
+    if (!PluginScanCache::getInstance()->getPlugins("dssi", soname,
+                                                    this, plugins)) {
         return;
     }
 
-    DSSI_Descriptor_Function fn = (DSSI_Descriptor_Function)
-	DLSYM(libraryHandle, "dssi_descriptor");
-
-    if (!fn) {
-	cerr << "WARNING: DSSIPluginFactory::discoverPlugins: No descriptor function in " << soname << endl;
-	return;
-    }
-
-    const DSSI_Descriptor *descriptor = 0;
-    
-    int index = 0;
-    while ((descriptor = fn(index))) {
-
-	const LADSPA_Descriptor *ladspaDescriptor = descriptor->LADSPA_Plugin;
-	if (!ladspaDescriptor) {
-	    cerr << "WARNING: DSSIPluginFactory::discoverPlugins: No LADSPA descriptor for plugin " << index << " in " << soname << endl;
-	    ++index;
-	    continue;
-	}
+    foreach (const PluginScanCache::Plugin &plugin, plugins) {
 
         RealTimePluginDescriptor *rtd = new RealTimePluginDescriptor;
-        rtd->name = ladspaDescriptor->Name;
-        rtd->label = ladspaDescriptor->Label;
-        rtd->maker = ladspaDescriptor->Maker;
-        rtd->copyright = ladspaDescriptor->Copyright;
+        rtd->name = plugin.name.toStdString();
+        rtd->label = plugin.label.toStdString();
+        rtd->maker = plugin.maker.toStdString();
+        rtd->copyright = plugin.copyright.toStdString();
         rtd->category = "";
-        rtd->isSynth = (descriptor->run_synth ||
-                        descriptor->run_multiple_synths);
-        rtd->parameterCount = 0;
-        rtd->audioInputPortCount = 0;
-        rtd->audioOutputPortCount = 0;
-        rtd->controlOutputPortCount = 0;
+        rtd->isSynth = plugin.isSynth;
+        rtd->parameterCount = plugin.parameters.size();
+        rtd->audioInputPortCount = plugin.audioInputPortCount;
+        rtd->audioOutputPortCount = plugin.audioOutputPortCount;
+        rtd->controlOutputPortCount = plugin.outputs.size();
+        foreach (const PluginScanCache::Output &output, plugin.outputs) {
+            rtd->controlOutputPortNames.push_back(output.name.toStdString());
+        }
 
 	QString identifier = PluginIdentifier::createIdentifier
-	    ("dssi", soname, ladspaDescriptor->Label);
+	    ("dssi", soname, plugin.label);
 
 #ifdef HAVE_LRDF
-	char *def_uri = 0;
-	lrdf_defaults *defs = 0;
-		
 	QString category = m_taxonomy[identifier];
 
-        if (category == "" && m_lrdfTaxonomy[ladspaDescriptor->UniqueID] != "") {
-            m_taxonomy[identifier] = m_lrdfTaxonomy[ladspaDescriptor->UniqueID];
+        if (category == "" && m_lrdfTaxonomy[plugin.uniqueId] != "") {
+            m_taxonomy[identifier] = m_lrdfTaxonomy[plugin.uniqueId];
             category = m_taxonomy[identifier];
         }
 
@@ -350,7 +324,7 @@ DSSIPluginFactory::discoverPluginsFrom(QString soname)
 	    std::string name = rtd->name;
 	    if (name.length() > 4 &&
 		name.substr(name.length() - 4) == " VST") {
-		if (descriptor->run_synth || descriptor->run_multiple_synths) {
+		if (plugin.isSynth) {
 		    category = "VST instruments";
 		} else {
 		    category = "VST effects";
@@ -360,73 +334,69 @@ DSSIPluginFactory::discoverPluginsFrom(QString soname)
 	}
 
         rtd->category = category.toStdString();
-	
-//	cerr << "Plugin id is " << ladspaDescriptor->UniqueID
-//                  << ", identifier is \"" << identifier
-//		  << "\", category is \"" << category
-//		  << "\", name is " << ladspaDescriptor->Name
-//		  << ", label is " << ladspaDescriptor->Label
-//		  << endl;
-	
-	def_uri = lrdf_get_default_uri(ladspaDescriptor->UniqueID);
-	if (def_uri) {
-	    defs = lrdf_get_setting_values(def_uri);
-	}
-	
-	unsigned int controlPortNumber = 1;
-	
-	for (int i = 0; i < (int)ladspaDescriptor->PortCount; i++) {
-	    
-	    if (LADSPA_IS_PORT_CONTROL(ladspaDescriptor->PortDescriptors[i])) {
-		
-		if (def_uri && defs) {
-		    
-		    for (int j = 0; j < (int)defs->count; j++) {
-			if (defs->items[j].pid == controlPortNumber) {
-//			    cerr << "Default for this port (" << defs->items[j].pid << ", " << defs->items[j].label << ") is " << defs->items[j].value << "; applying this to port number " << i << " with name " << ladspaDescriptor->PortNames[i] << endl;
-			    m_portDefaults[ladspaDescriptor->UniqueID][i] =
-				defs->items[j].value;
-			}
-		    }
-		}
-		
-		++controlPortNumber;
-	    }
-	}
-#endif // HAVE_LRDF
 
-	for (unsigned long i = 0; i < ladspaDescriptor->PortCount; i++) {
-	    if (LADSPA_IS_PORT_CONTROL(ladspaDescriptor->PortDescriptors[i])) {
-                if (LADSPA_IS_PORT_INPUT(ladspaDescriptor->PortDescriptors[i])) {
-                    ++rtd->parameterCount;
-                } else {
-                    if (strcmp(ladspaDescriptor->PortNames[i], "latency") &&
-                        strcmp(ladspaDescriptor->PortNames[i], "_latency")) {
-                        ++rtd->controlOutputPortCount;
-                        rtd->controlOutputPortNames.push_back
-                            (ladspaDescriptor->PortNames[i]);
-                    }
-                }
-            } else {
-                if (LADSPA_IS_PORT_INPUT(ladspaDescriptor->PortDescriptors[i])) {
-                    ++rtd->audioInputPortCount;
-                } else if (LADSPA_IS_PORT_OUTPUT(ladspaDescriptor->PortDescriptors[i])) {
-                    ++rtd->audioOutputPortCount;
-                }
-            }
-        }
+        // The LRDF port defaults are looked up when the plugin is
+        // instantiated, see LADSPAPluginFactory::getPortDefault
+#endif // HAVE_LRDF
 
 	m_identifiers.push_back(identifier);
 
         m_rtDescriptors[identifier] = rtd;
+    }
+}
+
+bool
+DSSIPluginFactory::scanLibrary(QString type, QString soname,
+                               PluginScanCache::PluginList &plugins)
+{
+    if (type != "dssi") return false;
+
+    Profiler profiler("DSSIPluginFactory::discoverPlugins");
+
+    // Note that soname is expected to be a full path at this point,
+    // of a file that is known to exist
+
+    void *libraryHandle = DLOPEN(soname, RTLD_LAZY);
+
+    if (!libraryHandle) {
+        cerr << "WARNING: DSSIPluginFactory::discoverPlugins: couldn't load plugin library "
+                  << soname << " - " << DLERROR() << endl;
+        return false;
+    }
+
+    DSSI_Descriptor_Function fn = (DSSI_Descriptor_Function)
+	DLSYM(libraryHandle, "dssi_descriptor");
+
+    if (!fn) {
+	cerr << "WARNING: DSSIPluginFactory::discoverPlugins: No descriptor function in " << soname << endl;
+	return false;
+    }
+
+    const DSSI_Descriptor *descriptor = 0;
+    
+    int index = 0;
+    while ((descriptor = fn(index))) {
+
+	const LADSPA_Descriptor *ladspaDescriptor = descriptor->LADSPA_Plugin;
+	if (!ladspaDescriptor) {
+	    cerr << "WARNING: DSSIPluginFactory::discoverPlugins: No LADSPA descriptor for plugin " << index << " in " << soname << endl;
+	    ++index;
+	    continue;
+	}
+
+        PluginScanCache::Plugin plugin = describePlugin(ladspaDescriptor);
+        plugin.isSynth = (descriptor->run_synth ||
+                          descriptor->run_multiple_synths);
+        plugins.push_back(plugin);
 
 	++index;
     }
 
     if (DLCLOSE(libraryHandle) != 0) {
         cerr << "WARNING: DSSIPluginFactory::discoverPlugins - can't unload " << libraryHandle << endl;
-        return;
     }
+
+    return true;
 }
 
     
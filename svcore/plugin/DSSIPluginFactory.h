@@ -44,6 +44,9 @@ public:
 						      int blockSize,
 						      int channels);
 
+    virtual bool scanLibrary(QString type, QString soName,
+                             PluginScanCache::PluginList &plugins);
+
 protected:
     DSSIPluginFactory();
     friend class RealTimePluginFactory;
@@ -115,6 +115,11 @@ FeatureExtractionPluginFactory::getPluginIdentifiers()
 
     std::vector<QString> rv;
     std::vector<QString> path = getPluginPath();
+
+    // The libraries are only loaded here if the scan cache has
+    // nothing for them; otherwise they wait until a plugin is
+    // instantiated
+    PluginScanCache *cache = PluginScanCache::getInstance();
     
     for (std::vector<QString>::iterator i = path.begin(); i != path.end(); ++i) {
 
@@ -130,86 +135,153 @@ FeatureExtractionPluginFactory::getPluginIdentifiers()
 
             QString soname = pluginDir.filePath(pluginDir[j]);
 
-#ifdef DEBUG_PLUGIN_SCAN_AND_INSTANTIATE
-            cerr << "FeatureExtractionPluginFactory::getPluginIdentifiers: trying potential library " << soname << endl;
-#endif
-
-            void *libraryHandle = DLOPEN(soname, RTLD_LAZY | RTLD_LOCAL);
-            
-            if (!libraryHandle) {
-                cerr << "WARNING: FeatureExtractionPluginFactory::getPluginIdentifiers: Failed to load library " << soname << ": " << DLERROR() << endl;
+            PluginScanCache::PluginList plugins;
+            if (!cache->getPlugins("vamp", soname, this, plugins)) {
                 continue;
             }
 
+            foreach (const PluginScanCache::Plugin &plugin, plugins) {
+                QString id = PluginIdentifier::createIdentifier
+                    ("vamp", soname, plugin.label);
+                rv.push_back(id);
+                m_metadata[id] = plugin;
 #ifdef DEBUG_PLUGIN_SCAN_AND_INSTANTIATE
-            cerr << "FeatureExtractionPluginFactory::getPluginIdentifiers: It's a library all right, checking for descriptor" << endl;
+                cerr << "FeatureExtractionPluginFactory::getPluginIdentifiers: Found plugin id " << id << endl;
 #endif
+            }
+	}
+    }
 
-            VampGetPluginDescriptorFunction fn = (VampGetPluginDescriptorFunction)
-                DLSYM(libraryHandle, "vampGetPluginDescriptor");
+    cache->save();
 
-            if (!fn) {
-                cerr << "WARNING: FeatureExtractionPluginFactory::getPluginIdentifiers: No descriptor function in " << soname << endl;
-                if (DLCLOSE(libraryHandle) != 0) {
-                    cerr << "WARNING: FeatureExtractionPluginFactory::getPluginIdentifiers: Failed to unload library " << soname << endl;
-                }
-                continue;
-            }
+    generateTaxonomy();
+
+    return rv;
+}
+
+bool
+FeatureExtractionPluginFactory::scanLibrary(QString type, QString soname,
+                                            PluginScanCache::PluginList &plugins)
+{
+    if (type != "vamp") return false;
 
 #ifdef DEBUG_PLUGIN_SCAN_AND_INSTANTIATE
-            cerr << "FeatureExtractionPluginFactory::getPluginIdentifiers: Vamp descriptor found" << endl;
+    cerr << "FeatureExtractionPluginFactory::scanLibrary: trying potential library " << soname << endl;
 #endif
 
-            const VampPluginDescriptor *descriptor = 0;
-            int index = 0;
-
-            std::map<std::string, int> known;
-            bool ok = true;
-
-            while ((descriptor = fn(VAMP_API_VERSION, index))) {
-
-                if (known.find(descriptor->identifier) != known.end()) {
-                    cerr << "WARNING: FeatureExtractionPluginFactory::getPluginIdentifiers: Plugin library "
-                              << soname
-                              << " returns the same plugin identifier \""
-                              << descriptor->identifier << "\" at indices "
-                              << known[descriptor->identifier] << " and "
-                              << index << endl;
-                    cerr << "FeatureExtractionPluginFactory::getPluginIdentifiers: Avoiding this library (obsolete API?)" << endl;
-                    ok = false;
-                    break;
-                } else {
-                    known[descriptor->identifier] = index;
-                }
-
-                ++index;
-            }
+    void *libraryHandle = DLOPEN(soname, RTLD_LAZY | RTLD_LOCAL);
+            
+    if (!libraryHandle) {
+        cerr << "WARNING: FeatureExtractionPluginFactory::scanLibrary: Failed to load library " << soname << ": " << DLERROR() << endl;
+        return false;
+    }
 
-            if (ok) {
+#ifdef DEBUG_PLUGIN_SCAN_AND_INSTANTIATE
+    cerr << "FeatureExtractionPluginFactory::scanLibrary: It's a library all right, checking for descriptor" << endl;
+#endif
 
-                index = 0;
+    VampGetPluginDescriptorFunction fn = (VampGetPluginDescriptorFunction)
+        DLSYM(libraryHandle, "vampGetPluginDescriptor");
 
-                while ((descriptor = fn(VAMP_API_VERSION, index))) {
+    if (!fn) {
+        cerr << "WARNING: FeatureExtractionPluginFactory::scanLibrary: No descriptor function in " << soname << endl;
+        if (DLCLOSE(libraryHandle) != 0) {
+            cerr << "WARNING: FeatureExtractionPluginFactory::scanLibrary: Failed to unload library " << soname << endl;
+        }
+        return false;
+    }
 
-                    QString id = PluginIdentifier::createIdentifier
-                        ("vamp", soname, descriptor->identifier);
-                    rv.push_back(id);
 #ifdef DEBUG_PLUGIN_SCAN_AND_INSTANTIATE
-                    cerr << "FeatureExtractionPluginFactory::getPluginIdentifiers: Found plugin id " << id << " at index " << index << endl;
+    cerr << "FeatureExtractionPluginFactory::scanLibrary: Vamp descriptor found" << endl;
 #endif
-                    ++index;
-                }
+
+    const VampPluginDescriptor *descriptor = 0;
+    int index = 0;
+
+    std::map<std::string, int> known;
+    bool ok = true;
+
+    while ((descriptor = fn(VAMP_API_VERSION, index))) {
+
+        if (known.find(descriptor->identifier) != known.end()) {
+            cerr << "WARNING: FeatureExtractionPluginFactory::scanLibrary: Plugin library "
+                      << soname
+                      << " returns the same plugin identifier \""
+                      << descriptor->identifier << "\" at indices "
+                      << known[descriptor->identifier] << " and "
+                      << index << endl;
+            cerr << "FeatureExtractionPluginFactory::scanLibrary: Avoiding this library (obsolete API?)" << endl;
+            ok = false;
+            break;
+        } else {
+            known[descriptor->identifier] = index;
+        }
+
+        ++index;
+    }
+
+    if (ok) {
+
+        index = 0;
+
+        while ((descriptor = fn(VAMP_API_VERSION, index))) {
+
+            // The outputs can only be had from an instance, so we
+            // make one while the library is loaded anyway
+            Vamp::PluginHostAdapter plugin(descriptor, 44100.f);
+
+            PluginScanCache::Plugin metadata;
+            metadata.label = plugin.getIdentifier().c_str();
+            metadata.name = plugin.getName().c_str();
+            metadata.description = plugin.getDescription().c_str();
+            metadata.maker = plugin.getMaker().c_str();
+            metadata.copyright = plugin.getCopyright().c_str();
+            metadata.inputDomain = int(plugin.getInputDomain());
+            metadata.programCount = int(plugin.getPrograms().size());
+
+            Vamp::Plugin::ParameterList parameters =
+                plugin.getParameterDescriptors();
+            for (int k = 0; k < (int)parameters.size(); ++k) {
+                PluginScanCache::Parameter p;
+                p.identifier = parameters[k].identifier.c_str();
+                p.name = parameters[k].name.c_str();
+                p.unit = parameters[k].unit.c_str();
+                p.minValue = parameters[k].minValue;
+                p.maxValue = parameters[k].maxValue;
+                p.defaultValue = parameters[k].defaultValue;
+                metadata.parameters.push_back(p);
             }
-            
-            if (DLCLOSE(libraryHandle) != 0) {
-                cerr << "WARNING: FeatureExtractionPluginFactory::getPluginIdentifiers: Failed to unload library " << soname << endl;
+
+            Vamp::Plugin::OutputList outputs = plugin.getOutputDescriptors();
+            for (int k = 0; k < (int)outputs.size(); ++k) {
+                PluginScanCache::Output o;
+                o.identifier = outputs[k].identifier.c_str();
+                o.name = outputs[k].name.c_str();
+                o.unit = outputs[k].unit.c_str();
+                metadata.outputs.push_back(o);
             }
-	}
+
+            plugins.push_back(metadata);
+            ++index;
+        }
+    }
+            
+    if (DLCLOSE(libraryHandle) != 0) {
+        cerr << "WARNING: FeatureExtractionPluginFactory::scanLibrary: Failed to unload library " << soname << endl;
     }
 
-    generateTaxonomy();
+    return ok;
+}
 
-    return rv;
+bool
+FeatureExtractionPluginFactory::getPluginMetadata(QString identifier,
+                                                  PluginScanCache::Plugin &metadata)
+{
+    std::map<QString, PluginScanCache::Plugin>::const_iterator i =
+        m_metadata.find(identifier);
+    if (i == m_metadata.end()) return false;
+    metadata = i->second;
+    return true;
 }
 
 QString
@@ -25,7 +25,9 @@
 #include "base/Debug.h"
 #include "PraalineCore/Base/BaseTypes.h"
 
-class FeatureExtractionPluginFactory
+#include "PluginScanCache.h"
+
+class FeatureExtractionPluginFactory : public PluginScanCache::Scanner
 {
 public:
     virtual ~FeatureExtractionPluginFactory() { }
@@ -50,9 +52,25 @@ public:
      */
     virtual QString getPluginCategory(QString identifier);
 
+    /**
+     * Get the metadata found for a plugin when scanning the plugin
+     * path (without instantiating it).  Return false if the plugin
+     * is not known.
+     */
+    virtual bool getPluginMetadata(QString identifier,
+                                   PluginScanCache::Plugin &metadata);
+
+    /**
+     * Load the library at path and describe the Vamp plugins in it,
+     * for the plugin scan cache.
+     */
+    virtual bool scanLibrary(QString type, QString path,
+                             PluginScanCache::PluginList &plugins);
+
 protected:
     std::vector<QString> m_pluginPath;
     std::map<QString, QString> m_taxonomy;
+    std::map<QString, PluginScanCache::Plugin> m_metadata;
 
     friend class PluginDeletionNotifyAdapter;
     void pluginDeleted(Vamp::Plugin *);
@@ -201,6 +201,10 @@ LADSPAPluginFactory::getPortDefault(const LADSPA_Descriptor *descriptor, int por
     float maximum = getPortMaximum(descriptor, port);
     float deft;
 
+#ifdef HAVE_LRDF
+    loadLRDFPortDefaults(descriptor);
+#endif // HAVE_LRDF
+
     if (m_portDefaults.find(descriptor->UniqueID) != 
 	m_portDefaults.end()) {
 	if (m_portDefaults[descriptor->UniqueID].find(port) !=
@@ -298,6 +302,42 @@ LADSPAPluginFactory::getPortDefault(const LADSPA_Descriptor *descriptor, int por
     return deft;
 }
 
+#ifdef HAVE_LRDF
+void
+LADSPAPluginFactory::loadLRDFPortDefaults(const LADSPA_Descriptor *descriptor)
+{
+    // Called when a plugin is first instantiated, rather than when it
+    // is discovered, so that discovery need not load the library
+    if (m_lrdfDefaultsLoaded.find(descriptor->UniqueID) !=
+        m_lrdfDefaultsLoaded.end()) return;
+    m_lrdfDefaultsLoaded.insert(descriptor->UniqueID);
+
+    lrdf_defaults *defs = 0;
+    char *def_uri = lrdf_get_default_uri(descriptor->UniqueID);
+    if (def_uri) {
+        defs = lrdf_get_setting_values(def_uri);
+    }
+    if (!def_uri || !defs) return;
+
+    unsigned int controlPortNumber = 1;
+
+    for (int i = 0; i < (int)descriptor->PortCount; i++) {
+
+        if (LADSPA_IS_PORT_CONTROL(descriptor->PortDescriptors[i])) {
+
+            for (unsigned int j = 0; j < defs->count; j++) {
+                if (defs->items[j].pid == controlPortNumber) {
+                    m_portDefaults[descriptor->UniqueID][i] =
+                        defs->items[j].value;
+                }
+            }
+
+            ++controlPortNumber;
+        }
+    }
+}
+#endif // HAVE_LRDF
+
 float
 LADSPAPluginFactory::getPortQuantization(const LADSPA_Descriptor *descriptor, int port)
 {
@@ -677,53 +717,41 @@ LADSPAPluginFactory::discoverPlugins()
 	    discoverPluginsFrom(QString("%1/%2").arg(*i).arg(pluginDir[j]));
 	}
     }
+    PluginScanCache::getInstance()->save();
 }
 
 void
 LADSPAPluginFactory::discoverPluginsFrom(QString soname)
 {
-    void *libraryHandle = DLOPEN(soname, RTLD_LAZY);
-
-    if (!libraryHandle) {
-        cerr << "WARNING: LADSPAPluginFactory::discoverPlugins: couldn't load plugin library "
-                  << soname << " - " << DLERROR() << endl;
+    PluginScanCache::PluginList plugins;
+    if (!PluginScanCache::getInstance()->getPlugins("ladspa", soname,
+                                                    this, plugins)) {
         return;
     }
 
-    LADSPA_Descriptor_Function fn = (LADSPA_Descriptor_Function)
-	DLSYM(libraryHandle, "ladspa_descriptor");
-
-    if (!fn) {
-	cerr << "WARNING: LADSPAPluginFactory::discoverPlugins: No descriptor function in " << soname << endl;
-	return;
-    }
-
-    const LADSPA_Descriptor *descriptor = 0;
-    
-    int index = 0;
-    while ((descriptor = fn(index))) {
+    foreach (const PluginScanCache::Plugin &plugin, plugins) {
 
         RealTimePluginDescriptor *rtd = new RealTimePluginDescriptor;
-        rtd->name = descriptor->Name;
-        rtd->label = descriptor->Label;
-        rtd->maker = descriptor->Maker;
-        rtd->copyright = descriptor->Copyright;
+        rtd->name = plugin.name.toStdString();
+        rtd->label = plugin.label.toStdString();
+        rtd->maker = plugin.maker.toStdString();
+        rtd->copyright = plugin.copyright.toStdString();
         rtd->category = "";
         rtd->isSynth = false;
-        rtd->parameterCount = 0;
-        rtd->audioInputPortCount = 0;
-        rtd->audioOutputPortCount = 0;
-        rtd->controlOutputPortCount = 0;
+        rtd->parameterCount = plugin.parameters.size();
+        rtd->audioInputPortCount = plugin.audioInputPortCount;
+        rtd->audioOutputPortCount = plugin.audioOutputPortCount;
+        rtd->controlOutputPortCount = plugin.outputs.size();
+        foreach (const PluginScanCache::Output &output, plugin.outputs) {
+            rtd->controlOutputPortNames.push_back(output.name.toStdString());
+        }
 
 	QString identifier = PluginIdentifier::createIdentifier
-	    ("ladspa", soname, descriptor->Label);
+	    ("ladspa", soname, plugin.label);
 
 #ifdef HAVE_LRDF
-	char *def_uri = 0;
-	lrdf_defaults *defs = 0;
-		
-        if (m_lrdfTaxonomy[descriptor->UniqueID] != "") {
-            m_taxonomy[identifier] = m_lrdfTaxonomy[descriptor->UniqueID];
+        if (m_lrdfTaxonomy[plugin.uniqueId] != "") {
+            m_taxonomy[identifier] = m_lrdfTaxonomy[plugin.uniqueId];
 //            cerr << "set id \"" << identifier << "\" to cat \"" << m_taxonomy[identifier] << "\" from LRDF" << endl;
 //            cout << identifier << "::" << m_taxonomy[identifier] << endl;
         }
@@ -741,71 +769,89 @@ LADSPAPluginFactory::discoverPluginsFrom(QString soname)
 	
         rtd->category = category.toStdString();
 
-//	cerr << "Plugin id is " << descriptor->UniqueID
-//		  << ", category is \"" << (category ? category : QString("(none)"))
-//		  << "\", name is " << descriptor->Name
-//		  << ", label is " << descriptor->Label
-//		  << endl;
-	
-	def_uri = lrdf_get_default_uri(descriptor->UniqueID);
-	if (def_uri) {
-	    defs = lrdf_get_setting_values(def_uri);
-	}
-
-	unsigned int controlPortNumber = 1;
-	
-	for (int i = 0; i < (int)descriptor->PortCount; i++) {
-	    
-	    if (LADSPA_IS_PORT_CONTROL(descriptor->PortDescriptors[i])) {
-		
-		if (def_uri && defs) {
-		    
-		    for (unsigned int j = 0; j < defs->count; j++) {
-			if (defs->items[j].pid == controlPortNumber) {
-//			    cerr << "Default for this port (" << defs->items[j].pid << ", " << defs->items[j].label << ") is " << defs->items[j].value << "; applying this to port number " << i << " with name " << descriptor->PortNames[i] << endl;
-			    m_portDefaults[descriptor->UniqueID][i] =
-				defs->items[j].value;
-			}
-		    }
-		}
-		
-		++controlPortNumber;
-	    }
-	}
+        // The LRDF port defaults are looked up when the plugin is
+        // instantiated, see getPortDefault
 #endif // HAVE_LRDF
 
-	for (int i = 0; i < (int)descriptor->PortCount; i++) {
-	    if (LADSPA_IS_PORT_CONTROL(descriptor->PortDescriptors[i])) {
-                if (LADSPA_IS_PORT_INPUT(descriptor->PortDescriptors[i])) {
-                    ++rtd->parameterCount;
-                } else {
-                    if (strcmp(descriptor->PortNames[i], "latency") &&
-                        strcmp(descriptor->PortNames[i], "_latency")) {
-                        ++rtd->controlOutputPortCount;
-                        rtd->controlOutputPortNames.push_back
-                            (descriptor->PortNames[i]);
-                    }
-                }
-            } else {
-                if (LADSPA_IS_PORT_INPUT(descriptor->PortDescriptors[i])) {
-                    ++rtd->audioInputPortCount;
-                } else if (LADSPA_IS_PORT_OUTPUT(descriptor->PortDescriptors[i])) {
-                    ++rtd->audioOutputPortCount;
-                }
-            }
-        }
-
 	m_identifiers.push_back(identifier);
 
         m_rtDescriptors[identifier] = rtd;
+    }
+}
+
+bool
+LADSPAPluginFactory::scanLibrary(QString type, QString soname,
+                                 PluginScanCache::PluginList &plugins)
+{
+    if (type != "ladspa") return false;
+
+    void *libraryHandle = DLOPEN(soname, RTLD_LAZY);
+
+    if (!libraryHandle) {
+        cerr << "WARNING: LADSPAPluginFactory::discoverPlugins: couldn't load plugin library "
+                  << soname << " - " << DLERROR() << endl;
+        return false;
+    }
+
+    LADSPA_Descriptor_Function fn = (LADSPA_Descriptor_Function)
+	DLSYM(libraryHandle, "ladspa_descriptor");
+
+    if (!fn) {
+	cerr << "WARNING: LADSPAPluginFactory::discoverPlugins: No descriptor function in " << soname << endl;
+	return false;
+    }
 
+    const LADSPA_Descriptor *descriptor = 0;
+    
+    int index = 0;
+    while ((descriptor = fn(index))) {
+        plugins.push_back(describePlugin(descriptor));
 	++index;
     }
 
     if (DLCLOSE(libraryHandle) != 0) {
         cerr << "WARNING: LADSPAPluginFactory::discoverPlugins - can't unload " << libraryHandle << endl;
-        return;
     }
+
+    return true;
+}
+
+PluginScanCache::Plugin
+LADSPAPluginFactory::describePlugin(const LADSPA_Descriptor *descriptor)
+{
+    PluginScanCache::Plugin plugin;
+    plugin.label = descriptor->Label;
+    plugin.name = descriptor->Name;
+    plugin.maker = descriptor->Maker;
+    plugin.copyright = descriptor->Copyright;
+    plugin.uniqueId = descriptor->UniqueID;
+
+    for (int i = 0; i < (int)descriptor->PortCount; i++) {
+        if (LADSPA_IS_PORT_CONTROL(descriptor->PortDescriptors[i])) {
+            if (LADSPA_IS_PORT_INPUT(descriptor->PortDescriptors[i])) {
+                PluginScanCache::Parameter parameter;
+                parameter.identifier = QString("%1").arg(i);
+                parameter.name = descriptor->PortNames[i];
+                plugin.parameters.push_back(parameter);
+            } else {
+                if (strcmp(descriptor->PortNames[i], "latency") &&
+                    strcmp(descriptor->PortNames[i], "_latency")) {
+                    PluginScanCache::Output output;
+                    output.identifier = QString("%1").arg(i);
+                    output.name = descriptor->PortNames[i];
+                    plugin.outputs.push_back(output);
+                }
+            }
+        } else {
+            if (LADSPA_IS_PORT_INPUT(descriptor->PortDescriptors[i])) {
+                ++plugin.audioInputPortCount;
+            } else if (LADSPA_IS_PORT_OUTPUT(descriptor->PortDescriptors[i])) {
+                ++plugin.audioOutputPortCount;
+            }
+        }
+    }
+
+    return plugin;
 }
 
 void
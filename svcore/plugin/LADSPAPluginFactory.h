@@ -22,6 +22,7 @@
 #define _LADSPA_PLUGIN_FACTORY_H_
 
 #include "RealTimePluginFactory.h"
+#include "PluginScanCache.h"
 #include "api/ladspa.h"
 
 #include <vector>
@@ -31,7 +32,8 @@
 
 class LADSPAPluginInstance;
 
-class LADSPAPluginFactory : public RealTimePluginFactory
+class LADSPAPluginFactory : public RealTimePluginFactory,
+                            public PluginScanCache::Scanner
 {
 public:
     virtual ~LADSPAPluginFactory();
@@ -59,6 +61,9 @@ public:
     float getPortQuantization(const LADSPA_Descriptor *, int port);
     int getPortDisplayHint(const LADSPA_Descriptor *, int port);
 
+    virtual bool scanLibrary(QString type, QString soName,
+                             PluginScanCache::PluginList &plugins);
+
 protected:
     LADSPAPluginFactory();
     friend class RealTimePluginFactory;
@@ -71,6 +76,8 @@ protected:
     virtual void generateTaxonomy(QString uri, QString base);
     virtual void generateFallbackCategories();
 
+    static PluginScanCache::Plugin describePlugin(const LADSPA_Descriptor *);
+
     virtual void releasePlugin(RealTimePluginInstance *, QString);
 
     virtual const LADSPA_Descriptor *getLADSPADescriptor(QString identifier);
@@ -86,6 +93,11 @@ protected:
     std::map<unsigned long, QString> m_lrdfTaxonomy;
     std::map<unsigned long, std::map<int, float> > m_portDefaults;
 
+#ifdef HAVE_LRDF
+    void loadLRDFPortDefaults(const LADSPA_Descriptor *);
+    std::set<unsigned long> m_lrdfDefaultsLoaded;
+#endif
+
     std::set<RealTimePluginInstance *> m_instances;
 
     typedef std::map<QString, void *> LibraryHandleMap;
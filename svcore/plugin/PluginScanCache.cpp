@@ -0,0 +1,436 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#include "PluginScanCache.h"
+
+#include "base/ResourceFinder.h"
+#include "base/Debug.h"
+#include "base/Profiler.h"
+#include "system/System.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+
+#include <iostream>
+
+//#define DEBUG_PLUGIN_SCAN_CACHE 1
+
+static const quint32 cacheMagic = 0x50534331; // "PSC1"
+static const quint32 cacheVersion = 1;
+
+PluginScanCache *
+PluginScanCache::m_instance = 0;
+
+static QMutex instanceMutex;
+
+PluginScanCache *
+PluginScanCache::getInstance()
+{
+    QMutexLocker locker(&instanceMutex);
+    if (!m_instance) m_instance = new PluginScanCache();
+    return m_instance;
+}
+
+void
+PluginScanCache::deleteInstance()
+{
+    QMutexLocker locker(&instanceMutex);
+    delete m_instance;
+    m_instance = 0;
+}
+
+PluginScanCache::PluginScanCache() :
+    m_dirty(false),
+    m_thread(0),
+    m_threadActive(false),
+    m_exiting(false)
+{
+    load();
+}
+
+PluginScanCache::~PluginScanCache()
+{
+    m_mutex.lock();
+    m_exiting = true;
+    m_mutex.unlock();
+
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+
+    save();
+}
+
+QString
+PluginScanCache::getCacheFilePath() const
+{
+    QString dir = ResourceFinder().getUserResourcePrefix();
+    if (dir == "") return "";
+    return QDir(dir).filePath("plugin-cache.dat");
+}
+
+bool
+PluginScanCache::stat(QString path, qint64 &size, qint64 &modified)
+{
+    QFileInfo fi(path);
+    if (!fi.exists()) {
+        size = 0;
+        modified = 0;
+        return false;
+    }
+    size = fi.size();
+    modified = fi.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+static void
+writePlugin(QDataStream &out, const PluginScanCache::Plugin &p)
+{
+    out << p.label << p.name << p.description << p.maker << p.copyright
+        << qint32(p.inputDomain) << qint32(p.programCount)
+        << quint64(p.uniqueId) << p.isSynth
+        << qint32(p.audioInputPortCount) << qint32(p.audioOutputPortCount);
+
+    out << quint32(p.parameters.size());
+    foreach (const PluginScanCache::Parameter &param, p.parameters) {
+        out << param.identifier << param.name << param.unit
+            << param.minValue << param.maxValue << param.defaultValue;
+    }
+
+    out << quint32(p.outputs.size());
+    foreach (const PluginScanCache::Output &output, p.outputs) {
+        out << output.identifier << output.name << output.unit;
+    }
+}
+
+static void
+readPlugin(QDataStream &in, PluginScanCache::Plugin &p)
+{
+    qint32 inputDomain, programCount, audioIn, audioOut;
+    quint64 uniqueId;
+    in >> p.label >> p.name >> p.description >> p.maker >> p.copyright
+       >> inputDomain >> programCount >> uniqueId >> p.isSynth
+       >> audioIn >> audioOut;
+    p.inputDomain = inputDomain;
+    p.programCount = programCount;
+    p.uniqueId = (unsigned long)uniqueId;
+    p.audioInputPortCount = audioIn;
+    p.audioOutputPortCount = audioOut;
+
+    quint32 n;
+    in >> n;
+    for (quint32 i = 0; i < n && in.status() == QDataStream::Ok; ++i) {
+        PluginScanCache::Parameter param;
+        in >> param.identifier >> param.name >> param.unit
+           >> param.minValue >> param.maxValue >> param.defaultValue;
+        p.parameters.push_back(param);
+    }
+
+    in >> n;
+    for (quint32 i = 0; i < n && in.status() == QDataStream::Ok; ++i) {
+        PluginScanCache::Output output;
+        in >> output.identifier >> output.name >> output.unit;
+        p.outputs.push_back(output);
+    }
+}
+
+void
+PluginScanCache::load()
+{
+    Profiler profiler("PluginScanCache::load");
+
+    QString path = getCacheFilePath();
+    if (path == "") return;
+
+    QFile file(path);
+    if (!file.exists()) return;
+    if (!file.open(QIODevice::ReadOnly)) {
+        cerr << "WARNING: PluginScanCache::load: Failed to open cache file "
+             << path << " for reading" << endl;
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic, version, count;
+    in >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion) {
+        cerr << "PluginScanCache::load: Cache file " << path
+             << " has an unknown format, ignoring it" << endl;
+        return;
+    }
+
+    EntryMap entries;
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Key key;
+        Entry e;
+        quint32 n;
+        in >> key.first >> key.second >> e.size >> e.modified >> e.ok
+           >> e.data >> n;
+        for (quint32 j = 0; j < n && in.status() == QDataStream::Ok; ++j) {
+            Plugin p;
+            readPlugin(in, p);
+            e.plugins.push_back(p);
+        }
+        entries[key] = e;
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        cerr << "WARNING: PluginScanCache::load: Cache file " << path
+             << " is truncated or corrupt, ignoring it" << endl;
+        return;
+    }
+
+#ifdef DEBUG_PLUGIN_SCAN_CACHE
+    cerr << "PluginScanCache::load: Loaded " << entries.size()
+         << " entries from " << path << endl;
+#endif
+
+    QMutexLocker locker(&m_mutex);
+    m_entries = entries;
+    m_dirty = false;
+}
+
+void
+PluginScanCache::save()
+{
+    Profiler profiler("PluginScanCache::save");
+
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_dirty) return;
+
+    QString path = getCacheFilePath();
+    if (path == "") return;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    for (EntryMap::iterator i = m_entries.begin(); i != m_entries.end(); ) {
+        if (!QFileInfo(i->first.second).exists()) {
+            m_entries.erase(i++);
+        } else {
+            ++i;
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        cerr << "WARNING: PluginScanCache::save: Failed to open cache file "
+             << path << " for writing" << endl;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out << cacheMagic << cacheVersion << quint32(m_entries.size());
+
+    for (EntryMap::const_iterator i = m_entries.begin();
+         i != m_entries.end(); ++i) {
+        const Entry &e = i->second;
+        out << i->first.first << i->first.second << e.size << e.modified
+            << e.ok << e.data << quint32(e.plugins.size());
+        foreach (const Plugin &p, e.plugins) {
+            writePlugin(out, p);
+        }
+    }
+
+    if (!file.commit()) {
+        cerr << "WARNING: PluginScanCache::save: Failed to write cache file "
+             << path << endl;
+        return;
+    }
+
+    m_dirty = false;
+}
+
+void
+PluginScanCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_dirty = true;
+}
+
+PluginScanCache::Entry
+PluginScanCache::scan(Key key, Scanner *scanner)
+{
+    // Stat before scanning, so that a file that changes while we
+    // scan it is found to be out of date next time
+    Entry e;
+    stat(key.second, e.size, e.modified);
+    e.ok = scanner->scanLibrary(key.first, key.second, e.plugins);
+    return e;
+}
+
+bool
+PluginScanCache::getPlugins(QString type, QString path, Scanner *scanner,
+                            PluginList &plugins)
+{
+    Key key(type, path);
+    qint64 size, modified;
+    stat(path, size, modified);
+
+    bool startThread = false;
+
+    m_mutex.lock();
+
+    EntryMap::const_iterator i = m_entries.find(key);
+
+    // A library that failed to load last time is scanned again now
+    // if it has changed, as it may have been fixed
+    if (i != m_entries.end() &&
+        (i->second.ok ||
+         (i->second.size == size && i->second.modified == modified))) {
+
+        const Entry &e = i->second;
+
+        if (e.size != size || e.modified != modified) {
+            bool queued = false;
+            for (size_t j = 0; j < m_pending.size(); ++j) {
+                if (m_pending[j].key == key) queued = true;
+            }
+            if (!queued) {
+#ifdef DEBUG_PLUGIN_SCAN_CACHE
+                cerr << "PluginScanCache::getPlugins: " << path
+                     << " has changed, queueing it to be scanned again" << endl;
+#endif
+                Pending p;
+                p.key = key;
+                p.scanner = scanner;
+                m_pending.push_back(p);
+                if (!m_threadActive && !m_exiting) {
+                    m_threadActive = true;
+                    startThread = true;
+                }
+            }
+        }
+
+        plugins = e.plugins;
+        bool ok = e.ok;
+        m_mutex.unlock();
+
+        if (startThread) {
+            if (!m_thread) {
+                m_thread = new RevalidateThread(this);
+            } else {
+                m_thread->wait(); // for the last run to return
+            }
+            m_thread->start(QThread::LowPriority);
+        }
+
+        return ok;
+    }
+
+    m_mutex.unlock();
+
+#ifdef DEBUG_PLUGIN_SCAN_CACHE
+    cerr << "PluginScanCache::getPlugins: No current entry for " << path
+         << ", scanning it" << endl;
+#endif
+
+    Entry e = scan(key, scanner);
+
+    m_mutex.lock();
+    m_entries[key] = e;
+    m_dirty = true;
+    m_mutex.unlock();
+
+    plugins = e.plugins;
+    return e.ok;
+}
+
+bool
+PluginScanCache::getData(QString type, QString path, QByteArray &data)
+{
+    qint64 size, modified;
+    if (!stat(path, size, modified)) return false;
+
+    QMutexLocker locker(&m_mutex);
+
+    EntryMap::const_iterator i = m_entries.find(Key(type, path));
+    if (i == m_entries.end() ||
+        i->second.size != size || i->second.modified != modified) {
+        return false;
+    }
+
+    data = i->second.data;
+    return true;
+}
+
+void
+PluginScanCache::setData(QString type, QString path, QByteArray data)
+{
+    Entry e;
+    if (!stat(path, e.size, e.modified)) return;
+    e.ok = true;
+    e.data = data;
+
+    QMutexLocker locker(&m_mutex);
+    m_entries[Key(type, path)] = e;
+    m_dirty = true;
+}
+
+void
+PluginScanCache::RevalidateThread::run()
+{
+    m_cache->revalidate();
+}
+
+void
+PluginScanCache::revalidate()
+{
+    while (true) {
+
+        Pending p;
+
+        m_mutex.lock();
+        if (m_exiting || m_pending.empty()) {
+            m_pending.clear();
+            m_threadActive = false;
+            m_mutex.unlock();
+            break;
+        }
+        p = m_pending.front();
+        m_pending.pop_front();
+        m_mutex.unlock();
+
+#ifdef DEBUG_PLUGIN_SCAN_CACHE
+        cerr << "PluginScanCache::revalidate: Scanning " << p.key.second
+             << " again" << endl;
+#endif
+
+        Entry e = scan(p.key, p.scanner);
+
+        // Plugins can change the locale, revert it to default.
+        RestoreStartupLocale();
+
+        m_mutex.lock();
+        m_entries[p.key] = e;
+        m_dirty = true;
+        m_mutex.unlock();
+    }
+
+    save();
+}
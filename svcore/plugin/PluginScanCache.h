@@ -0,0 +1,190 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef _PLUGIN_SCAN_CACHE_H_
+#define _PLUGIN_SCAN_CACHE_H_
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QMutex>
+#include <QThread>
+
+#include <map>
+#include <deque>
+
+/**
+ * Persistent cache of the metadata found by scanning plugin libraries
+ * (and plugin RDF description files), so that the libraries on the
+ * plugin path need not be loaded to find out what they contain.
+ * Libraries are then only loaded when a plugin is instantiated.
+ *
+ * Each entry is keyed by a file type ("vamp", "ladspa", "dssi",
+ * "rdf") and the file's path, and records the size and modification
+ * time the file had when it was scanned:
+ *
+ *  - If the file is unchanged, the entry is used as it is.
+ *
+ *  - If the file has changed, the entry is used anyway and the file
+ *    is scanned again in a background thread, so that the new
+ *    metadata is in the cache from the next startup onwards.  A
+ *    plugin that has gone from a changed library will fail when
+ *    instantiated, as it would if the library were removed while
+ *    running.
+ *
+ *  - If there is no entry, the file is scanned straight away.
+ *
+ * The cache is saved in the user resource directory.
+ */
+class PluginScanCache
+{
+public:
+    struct Output {
+        QString identifier;
+        QString name;
+        QString unit;
+    };
+
+    struct Parameter {
+        Parameter() : minValue(0), maxValue(0), defaultValue(0) { }
+        QString identifier;
+        QString name;
+        QString unit;
+        float minValue;
+        float maxValue;
+        float defaultValue;
+    };
+
+    /**
+     * Metadata for one plugin in a library.  For LADSPA and DSSI
+     * plugins the parameters are the control input ports, and the
+     * outputs are the control output ports other than latency.
+     */
+    struct Plugin {
+        Plugin() : inputDomain(0), programCount(0), uniqueId(0),
+                   isSynth(false), audioInputPortCount(0),
+                   audioOutputPortCount(0) { }
+        QString label; // Vamp plugin identifier or LADSPA label
+        QString name;
+        QString description;
+        QString maker;
+        QString copyright;
+        int inputDomain; // Vamp::Plugin::InputDomain
+        int programCount;
+        QList<Parameter> parameters;
+        QList<Output> outputs;
+        unsigned long uniqueId; // LADSPA and DSSI only
+        bool isSynth;
+        int audioInputPortCount;
+        int audioOutputPortCount;
+    };
+
+    typedef QList<Plugin> PluginList;
+
+    /**
+     * Implemented by the plugin factories to load a library and
+     * describe the plugins in it.  scanLibrary may be called from the
+     * background thread, so it must not touch the factory's state.
+     */
+    class Scanner {
+    public:
+        virtual ~Scanner() { }
+        virtual bool scanLibrary(QString type, QString path,
+                                 PluginList &plugins) = 0;
+    };
+
+    static PluginScanCache *getInstance();
+    static void deleteInstance(); // only when exiting
+
+    /**
+     * Return in plugins the plugins of the given type found in the
+     * library at path, from the cache or by calling the scanner as
+     * described above.  Return false if the library could not be
+     * loaded (this is cached too).
+     */
+    bool getPlugins(QString type, QString path, Scanner *scanner,
+                    PluginList &plugins);
+
+    /**
+     * Return in data the cached data for the file at path, if the
+     * file is unchanged since it was stored, and return true.
+     * Otherwise return false, and the caller must read the file and
+     * call setData.
+     */
+    bool getData(QString type, QString path, QByteArray &data);
+    void setData(QString type, QString path, QByteArray data);
+
+    /**
+     * Write the cache out, if anything has changed since it was
+     * loaded or last saved.  Entries for files that no longer exist
+     * are dropped.
+     */
+    void save();
+
+    /**
+     * Discard all cached entries, so that every file is scanned
+     * again.
+     */
+    void clear();
+
+    virtual ~PluginScanCache();
+
+protected:
+    PluginScanCache();
+
+    struct Entry {
+        Entry() : size(0), modified(0), ok(false) { }
+        qint64 size;
+        qint64 modified;
+        bool ok;
+        PluginList plugins;
+        QByteArray data;
+    };
+
+    typedef std::pair<QString, QString> Key; // type, path
+    typedef std::map<Key, Entry> EntryMap;
+
+    QMutex m_mutex;
+    EntryMap m_entries;
+    bool m_dirty;
+
+    struct Pending {
+        Key key;
+        Scanner *scanner;
+    };
+
+    std::deque<Pending> m_pending;
+
+    class RevalidateThread : public QThread
+    {
+    public:
+        RevalidateThread(PluginScanCache *cache) : m_cache(cache) { }
+        virtual void run();
+        PluginScanCache *m_cache;
+    };
+
+    RevalidateThread *m_thread;
+    bool m_threadActive;
+    bool m_exiting;
+
+    QString getCacheFilePath() const;
+    void load();
+    static bool stat(QString path, qint64 &size, qint64 &modified);
+    Entry scan(Key key, Scanner *scanner);
+    void revalidate();
+
+    static PluginScanCache *m_instance;
+};
+
+#endif
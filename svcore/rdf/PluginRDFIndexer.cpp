@@ -19,6 +19,7 @@
 #include "data/fileio/FileSource.h"
 #include "data/fileio/PlaylistFileReader.h"
 #include "plugin/PluginIdentifier.h"
+#include "plugin/PluginScanCache.h"
 
 #include "base/Profiler.h"
 
@@ -33,6 +34,7 @@
 #include <QDateTime>
 #include <QSettings>
 #include <QFile>
+#include <QDataStream>
 
 #include <iostream>
 
@@ -60,11 +62,14 @@ PluginRDFIndexer::getInstance()
 }
 
 PluginRDFIndexer::PluginRDFIndexer() :
-    m_index(new Dataquay::BasicStore)
+    m_index(new Dataquay::BasicStore),
+    m_blankCounter(0)
 {
     m_index->addPrefix("vamp", Uri("http://purl.org/ontology/vamp/"));
     m_index->addPrefix("foaf", Uri("http://xmlns.com/foaf/0.1/"));
     m_index->addPrefix("dc", Uri("http://purl.org/dc/elements/1.1/"));
+    // The index is loaded once and then read from any thread
+    m_index->setConcurrentReads(true);
     indexInstalledURLs();
 }
 
@@ -133,6 +138,8 @@ PluginRDFIndexer::indexInstalledURLs()
         }
     }
 
+    PluginScanCache::getInstance()->save();
+
     reindex();
 }
 
@@ -242,9 +249,72 @@ PluginRDFIndexer::getIndexedPluginIds()
 bool
 PluginRDFIndexer::pullFile(QString filepath)
 {
-    QUrl url = QUrl::fromLocalFile(filepath);
-    QString urlString = url.toString();
-    return pullURL(urlString);
+    // Installed description files rarely change, so the triples read
+    // from each are kept in the plugin scan cache and added straight
+    // to the index the next time, without parsing the file
+
+    PluginScanCache *cache = PluginScanCache::getInstance();
+
+    Triples tt;
+    QByteArray data;
+
+    if (cache->getData("rdf", filepath, data)) {
+        QDataStream in(data);
+        quint32 n;
+        in >> n;
+        for (quint32 i = 0; i < n && in.status() == QDataStream::Ok; ++i) {
+            Triple t;
+            in >> t;
+            tt.push_back(t);
+        }
+        if (in.status() != QDataStream::Ok) {
+            tt.clear();
+            data.clear();
+        }
+    }
+
+    if (data.isEmpty()) {
+
+        Profiler profiler("PluginRDFIndexer::pullFile");
+
+        BasicStore store;
+        try {
+            store.import(QUrl::fromLocalFile(filepath),
+                         BasicStore::ImportIgnoreDuplicates);
+        } catch (RDFException &e) {
+            cerr << e.what() << endl;
+            cerr << "PluginRDFIndexer::pullFile: Failed to import document from "
+                 << filepath << ": " << e.what() << endl;
+            return false;
+        }
+
+        tt = store.match(Triple());
+
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << quint32(tt.size());
+        foreach (Triple t, tt) out << t;
+        cache->setData("rdf", filepath, data);
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // Blank nodes are local to the document they came from, so give
+    // them a prefix of their own as import would
+    QString blankPrefix = QString("rdfidx%1_").arg(++m_blankCounter);
+
+    for (int i = 0; i < tt.size(); ++i) {
+        Triple &t = tt[i];
+        if (t.a.type == Node::Blank) t.a.value = blankPrefix + t.a.value;
+        if (t.c.type == Node::Blank) t.c.value = blankPrefix + t.c.value;
+        if (m_index->contains(t)) {
+            cerr << "PluginRDFIndexer::pullFile: Document at " << filepath
+                 << " duplicates triples found in earlier loaded document -- skipping it" << endl;
+            return false;
+        }
+    }
+
+    foreach (Triple t, tt) m_index->add(t);
+    return true;
 }
 
 bool
@@ -71,6 +71,7 @@ protected:
     bool reindex();
 
     Dataquay::BasicStore *m_index;
+    int m_blankCounter;
 
     static PluginRDFIndexer *m_instance;
 };
@@ -139,6 +139,10 @@ RDFImporterImpl::RDFImporterImpl(QString uri, sv_samplerate_t sampleRate) :
     m_store->addPrefix("event", Uri("http://purl.org/NET/c4dm/event.owl#"));
     m_store->addPrefix("rdfs", Uri("http://www.w3.org/2000/01/rdf-schema#"));
 
+    // Nothing is added after the import, which then takes a snapshot
+    // for the many reads that follow
+    m_store->setConcurrentReads(true);
+
     try {
         QUrl url;
         if (uri.startsWith("file:")) {
@@ -62,6 +62,7 @@ solaris*: DEFINES += __RTMIDI_DUMMY_ONLY__
 
 HEADERS += base/AudioLevel.h \
            base/AudioPlaySource.h \
+           base/ChunkedSortedList.h \
            base/Clipboard.h \
            base/Command.h \
            base/Debug.h \
@@ -91,6 +92,7 @@ HEADERS += base/AudioLevel.h \
            base/TempWriteFile.h \
            base/TextMatcher.h \
            base/Thread.h \
+           base/Trace.h \
            base/UnitDatabase.h \
            base/ViewManagerBase.h \
            base/Window.h \
@@ -125,6 +127,7 @@ SOURCES += base/AudioLevel.cpp \
            base/TempWriteFile.cpp \
            base/TextMatcher.cpp \
            base/Thread.cpp \
+           base/Trace.cpp \
            base/UnitDatabase.cpp \
            base/ViewManagerBase.cpp \
            base/XmlExportable.cpp
@@ -247,6 +250,7 @@ HEADERS += plugin/DSSIPluginFactory.h \
            plugin/LADSPAPluginFactory.h \
            plugin/LADSPAPluginInstance.h \
            plugin/PluginIdentifier.h \
+           plugin/PluginScanCache.h \
            plugin/PluginXml.h \
            plugin/RealTimePluginFactory.h \
            plugin/RealTimePluginInstance.h \
@@ -267,6 +271,7 @@ SOURCES += plugin/DSSIPluginFactory.cpp \
            plugin/LADSPAPluginFactory.cpp \
            plugin/LADSPAPluginInstance.cpp \
            plugin/PluginIdentifier.cpp \
+           plugin/PluginScanCache.cpp \
            plugin/PluginXml.cpp \
            plugin/RealTimePluginFactory.cpp \
            plugin/RealTimePluginInstance.cpp \
@@ -294,7 +299,8 @@ HEADERS += system/Init.h \
 SOURCES += system/Init.cpp \
            system/System.cpp
 
-HEADERS += transform/CSVFeatureWriter.h \
+HEADERS += transform/BatchFeatureExtractor.h \
+           transform/CSVFeatureWriter.h \
            transform/FeatureExtractionModelTransformer.h \
            transform/FeatureWriter.h \
            transform/FileFeatureWriter.h \
@@ -304,7 +310,8 @@ HEADERS += transform/CSVFeatureWriter.h \
            transform/TransformFactory.h \
            transform/ModelTransformer.h \
            transform/ModelTransformerFactory.h
-SOURCES += transform/CSVFeatureWriter.cpp \
+SOURCES += transform/BatchFeatureExtractor.cpp \
+           transform/CSVFeatureWriter.cpp \
            transform/FeatureExtractionModelTransformer.cpp \
            transform/FileFeatureWriter.cpp \
            transform/RealTimeEffectModelTransformer.cpp \
@@ -0,0 +1,426 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#include "BatchFeatureExtractor.h"
+
+#include "FeatureWriter.h"
+#include "TransformFactory.h"
+
+#include "plugin/FeatureExtractionPluginFactory.h"
+#include "data/fileio/AudioFileReader.h"
+#include "data/fileio/AudioFileReaderFactory.h"
+#include "data/fileio/FileSource.h"
+#include "base/Thread.h"
+#include "base/Profiler.h"
+#include "base/Debug.h"
+
+#include <vamp-hostsdk/Plugin.h>
+#include <vamp-hostsdk/PluginInputDomainAdapter.h>
+#include <vamp-hostsdk/PluginChannelAdapter.h>
+#include <vamp-hostsdk/PluginBufferingAdapter.h>
+
+#include <QMutexLocker>
+
+#include <iostream>
+
+using Vamp::Plugin;
+using Vamp::HostExt::PluginInputDomainAdapter;
+using Vamp::HostExt::PluginChannelAdapter;
+using Vamp::HostExt::PluginBufferingAdapter;
+
+// The plugin factories keep their library handle maps unlocked, so
+// instantiation and deletion of plugins from the worker threads must
+// be serialised
+static QMutex s_factoryMutex;
+
+class BatchFeatureExtractor::Worker : public Thread
+{
+public:
+    Worker(BatchFeatureExtractor *extractor) :
+        Thread(Thread::NonRTThread), m_extractor(extractor) { }
+
+protected:
+    virtual void run() {
+        int index = 0;
+        while (m_extractor->takeNextSource(index)) {
+            QString message;
+            bool ok = m_extractor->extractFeaturesFor(index, message);
+            m_extractor->sourceFinished(index, ok, message);
+        }
+    }
+
+    BatchFeatureExtractor *m_extractor;
+};
+
+namespace {
+
+// One plugin instance, serving all transforms of a group
+struct PluginRun {
+    Plugin *plugin;
+    std::vector<Transform> transforms;
+    std::vector<int> outputNos;
+    Plugin::OutputList outputs;
+};
+
+bool
+areTransformsSimilar(const Transform &t1, const Transform &t2)
+{
+    Transform t2o(t2);
+    t2o.setOutput(t1.getOutput());
+    return t1 == t2o;
+}
+
+void
+deletePlugins(std::vector<PluginRun> &runs)
+{
+    QMutexLocker locker(&s_factoryMutex);
+    for (int i = 0; i < (int)runs.size(); ++i) {
+        delete runs[i].plugin;
+    }
+    runs.clear();
+}
+
+}
+
+BatchFeatureExtractor::BatchFeatureExtractor(QObject *parent) :
+    QObject(parent),
+    m_threadCount(0),
+    m_readBlockSize(16384),
+    m_normalise(false),
+    m_abandoned(false),
+    m_nextSource(0),
+    m_done(0)
+{
+}
+
+BatchFeatureExtractor::~BatchFeatureExtractor()
+{
+}
+
+bool
+BatchFeatureExtractor::addTransform(const Transform &transform)
+{
+    if (transform.getType() != Transform::FeatureExtraction) {
+        cerr << "BatchFeatureExtractor::addTransform: Transform \""
+             << transform.getIdentifier() << "\" is not a feature extraction transform" << endl;
+        return false;
+    }
+    for (int i = 0; i < (int)m_groups.size(); ++i) {
+        if (areTransformsSimilar(m_groups[i][0], transform)) {
+            m_groups[i].push_back(transform);
+            return true;
+        }
+    }
+    m_groups.push_back(TransformGroup());
+    m_groups.back().push_back(transform);
+    return true;
+}
+
+void
+BatchFeatureExtractor::clearTransforms()
+{
+    m_groups.clear();
+}
+
+void
+BatchFeatureExtractor::addFeatureWriter(FeatureWriter *writer)
+{
+    if (writer) m_writers.push_back(writer);
+}
+
+QString
+BatchFeatureExtractor::getError(QString source) const
+{
+    return m_errors.value(source);
+}
+
+bool
+BatchFeatureExtractor::extractFeatures(const QStringList &sources)
+{
+    Profiler profiler("BatchFeatureExtractor::extractFeatures");
+
+    m_sources = sources;
+    m_nextSource = 0;
+    m_done = 0;
+    m_failed.clear();
+    m_errors.clear();
+    m_abandoned = false;
+
+    if (m_groups.empty() || sources.isEmpty()) return true;
+
+    int threads = m_threadCount;
+    if (threads <= 0) threads = QThread::idealThreadCount();
+    if (threads <= 0) threads = 1;
+    if (threads > sources.size()) threads = sources.size();
+
+    emit completionChanged(0, sources.size());
+
+    std::vector<Worker *> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(new Worker(this));
+        workers[i]->start();
+    }
+    for (int i = 0; i < threads; ++i) {
+        workers[i]->wait();
+        delete workers[i];
+    }
+
+    {
+        QMutexLocker locker(&m_writerMutex);
+        for (int i = 0; i < (int)m_writers.size(); ++i) {
+            m_writers[i]->finish();
+        }
+    }
+
+    return m_failed.isEmpty() && !m_abandoned;
+}
+
+bool
+BatchFeatureExtractor::takeNextSource(int &index)
+{
+    QMutexLocker locker(&m_queueMutex);
+    if (m_abandoned || m_nextSource >= m_sources.size()) return false;
+    index = m_nextSource++;
+    return true;
+}
+
+void
+BatchFeatureExtractor::sourceFinished(int index, bool succeeded, QString message)
+{
+    QString source = m_sources[index];
+    int done = 0;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        if (!succeeded) {
+            m_failed.push_back(source);
+            m_errors[source] = message;
+        }
+        done = ++m_done;
+    }
+    emit fileFinished(source, succeeded, message);
+    emit completionChanged(done, m_sources.size());
+}
+
+bool
+BatchFeatureExtractor::extractFeaturesFor(int index, QString &message)
+{
+    Profiler profiler("BatchFeatureExtractor::extractFeaturesFor");
+
+    QString source = m_sources[index];
+    emit fileStarted(source);
+
+    FileSource fileSource(source);
+    fileSource.waitForData();
+    if (!fileSource.isOK()) {
+        message = tr("Failed to open \"%1\": %2").arg(source).arg(fileSource.getErrorString());
+        return false;
+    }
+
+    AudioFileReader *reader = AudioFileReaderFactory::createReader
+        (fileSource, 0, m_normalise);
+    if (!reader || !reader->isOK()) {
+        message = tr("Failed to decode audio file \"%1\"").arg(source);
+        if (reader) {
+            if (reader->getError() != "") message = reader->getError();
+            delete reader;
+        }
+        return false;
+    }
+
+    sv_samplerate_t sampleRate = reader->getSampleRate();
+    int channels = reader->getChannelCount();
+    int readBlockSize = m_readBlockSize > 0 ? m_readBlockSize : 16384;
+
+    // Instantiate one adapted plugin per transform group
+
+    std::vector<PluginRun> runs;
+
+    for (int g = 0; g < (int)m_groups.size(); ++g) {
+
+        Transform primary = m_groups[g][0];
+        QString pluginId = primary.getPluginIdentifier();
+        Plugin *raw = 0;
+
+        {
+            QMutexLocker locker(&s_factoryMutex);
+            FeatureExtractionPluginFactory *factory =
+                FeatureExtractionPluginFactory::instanceFor(pluginId);
+            if (factory) {
+                raw = factory->instantiatePlugin(pluginId, sampleRate);
+            }
+        }
+        if (!raw) {
+            message = tr("Failed to instantiate plugin \"%1\"").arg(pluginId);
+            deletePlugins(runs);
+            delete reader;
+            return false;
+        }
+
+        TransformFactory::getInstance()->makeContextConsistentWithPlugin
+            (primary, raw);
+
+        // Outermost adapter owns the ones inside it
+        PluginBufferingAdapter *plugin = new PluginBufferingAdapter
+            (new PluginChannelAdapter(new PluginInputDomainAdapter(raw)));
+        plugin->setPluginStepSize(primary.getStepSize());
+        plugin->setPluginBlockSize(primary.getBlockSize());
+
+        PluginRun run;
+        run.plugin = plugin;
+        runs.push_back(run);
+
+        TransformFactory::getInstance()->setPluginParameters(primary, plugin);
+
+        if (!plugin->initialise(channels, readBlockSize, readBlockSize)) {
+            message = tr("Failed to initialise plugin \"%1\"").arg(pluginId);
+            deletePlugins(runs);
+            delete reader;
+            return false;
+        }
+
+        // Output descriptors after initialise, as the buffering
+        // adapter rewrites the timing of OneSamplePerStep outputs
+        Plugin::OutputList outputs = plugin->getOutputDescriptors();
+
+        for (int j = 0; j < (int)m_groups[g].size(); ++j) {
+            const Transform &t = m_groups[g][j];
+            int outputNo = -1;
+            for (int i = 0; i < (int)outputs.size(); ++i) {
+                if (t.getOutput() == "" ||
+                    outputs[i].identifier == t.getOutput().toStdString()) {
+                    outputNo = i;
+                    break;
+                }
+            }
+            if (outputNo < 0) {
+                message = tr("Plugin \"%1\" has no output named \"%2\"")
+                    .arg(pluginId).arg(t.getOutput());
+                deletePlugins(runs);
+                delete reader;
+                return false;
+            }
+            runs.back().transforms.push_back(t);
+            runs.back().outputNos.push_back(outputNo);
+        }
+        runs.back().outputs = outputs;
+    }
+
+    {
+        QMutexLocker locker(&m_writerMutex);
+        try {
+            for (int w = 0; w < (int)m_writers.size(); ++w) {
+                FeatureWriter::TrackMetadata metadata;
+                metadata.title = reader->getTitle();
+                metadata.maker = reader->getMaker();
+                m_writers[w]->setTrackMetadata(source, metadata);
+                for (int r = 0; r < (int)runs.size(); ++r) {
+                    for (int j = 0; j < (int)runs[r].transforms.size(); ++j) {
+                        m_writers[w]->testOutputFile
+                            (source, runs[r].transforms[j].getIdentifier());
+                    }
+                }
+            }
+        } catch (const std::exception &e) {
+            message = e.what();
+            deletePlugins(runs);
+            delete reader;
+            return false;
+        }
+    }
+
+    // Decode once, and feed every plugin from the same blocks
+
+    std::vector<float *> buffers(channels);
+    for (int c = 0; c < channels; ++c) {
+        buffers[c] = new float[readBlockSize];
+    }
+
+    bool ok = true;
+    sv_frame_t frameCount = reader->getFrameCount();
+    sv_frame_t frame = 0;
+
+    try {
+
+        while (!m_abandoned) {
+
+            bool last = false;
+            if (frame >= frameCount) {
+                last = true;
+            } else {
+                std::vector<SampleBlock> data =
+                    reader->getDeInterleavedFrames(frame, readBlockSize);
+                for (int c = 0; c < channels; ++c) {
+                    int got = (c < (int)data.size()) ? (int)data[c].size() : 0;
+                    if (got > readBlockSize) got = readBlockSize;
+                    for (int i = 0; i < got; ++i) buffers[c][i] = data[c][i];
+                    for (int i = got; i < readBlockSize; ++i) buffers[c][i] = 0.f;
+                }
+            }
+
+            Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime
+                (long(frame), (unsigned int)(sampleRate));
+
+            for (int r = 0; r < (int)runs.size(); ++r) {
+
+                PluginRun &run = runs[r];
+                Plugin::FeatureSet features;
+                if (last) {
+                    features = run.plugin->getRemainingFeatures();
+                } else {
+                    features = run.plugin->process(&buffers[0], timestamp);
+                }
+
+                QMutexLocker locker(&m_writerMutex);
+                for (int j = 0; j < (int)run.transforms.size(); ++j) {
+                    int outputNo = run.outputNos[j];
+                    if (features.find(outputNo) == features.end()) continue;
+                    const Plugin::FeatureList &list = features[outputNo];
+                    if (list.empty()) continue;
+                    for (int w = 0; w < (int)m_writers.size(); ++w) {
+                        m_writers[w]->setNofM(index + 1, m_sources.size());
+                        m_writers[w]->write(source, run.transforms[j],
+                                            run.outputs[outputNo], list);
+                    }
+                }
+            }
+
+            if (last) break;
+            frame += readBlockSize;
+        }
+
+    } catch (const std::exception &e) {
+        message = e.what();
+        ok = false;
+    }
+
+    if (m_abandoned && ok) {
+        message = tr("Extraction abandoned");
+        ok = false;
+    }
+
+    if (ok) {
+        QMutexLocker locker(&m_writerMutex);
+        for (int w = 0; w < (int)m_writers.size(); ++w) {
+            m_writers[w]->flush();
+        }
+    }
+
+    for (int c = 0; c < channels; ++c) {
+        delete[] buffers[c];
+    }
+    deletePlugins(runs);
+    delete reader;
+
+    return ok;
+}
@@ -0,0 +1,134 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef _BATCH_FEATURE_EXTRACTOR_H_
+#define _BATCH_FEATURE_EXTRACTOR_H_
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMutex>
+#include <QMap>
+
+#include <vector>
+#include <atomic>
+
+#include "Transform.h"
+
+class FeatureWriter;
+
+/**
+ * Headless extraction of a set of feature transforms over many audio
+ * files, without creating any models or views.
+ *
+ * Each file is decoded once and read in consecutive, non-overlapping
+ * blocks; every transform is fed from that same block stream. Plugins
+ * are wrapped in the Vamp host SDK input-domain, channel and buffering
+ * adapters, so that frequency-domain plugins get their FFT frames and
+ * each plugin gets its own step and block size from the common stream.
+ * Transforms that differ only in their output share one plugin
+ * instance. Several files are processed in parallel, and features are
+ * written to the given FeatureWriters (e.g. CSVFeatureWriter or
+ * RDFFeatureWriter) as soon as they are returned by the plugins.
+ *
+ * This is library API for batch tools: nothing in the application
+ * calls it yet, and the interactive extraction paths still go through
+ * ModelTransformerFactory.
+ */
+class BatchFeatureExtractor : public QObject
+{
+    Q_OBJECT
+
+public:
+    BatchFeatureExtractor(QObject *parent = 0);
+    virtual ~BatchFeatureExtractor();
+
+    /**
+     * Number of files to process at the same time. 0 (the default)
+     * uses the number of available processor cores.
+     */
+    void setThreadCount(int threads) { m_threadCount = threads; }
+    int getThreadCount() const { return m_threadCount; }
+
+    /**
+     * Number of frames read from the audio file at a time. This does
+     * not need to be related to the step or block sizes of the
+     * transforms.
+     */
+    void setReadBlockSize(int frames) { m_readBlockSize = frames; }
+    int getReadBlockSize() const { return m_readBlockSize; }
+
+    void setNormalise(bool normalise) { m_normalise = normalise; }
+    bool getNormalise() const { return m_normalise; }
+
+    /**
+     * Add a transform to extract. Only feature extraction transforms
+     * are accepted.
+     */
+    bool addTransform(const Transform &transform);
+    void clearTransforms();
+
+    /**
+     * Add a writer to receive the features. The writer is not owned
+     * by the extractor; its calls are serialised.
+     */
+    void addFeatureWriter(FeatureWriter *writer);
+
+    /**
+     * Extract all transforms from all given files (paths or URLs),
+     * and block until done. Return true if every file succeeded.
+     */
+    bool extractFeatures(const QStringList &sources);
+
+    /**
+     * Ask a running extraction to stop after the blocks in progress.
+     */
+    void abandon() { m_abandoned = true; }
+
+    QStringList getFailedSources() const { return m_failed; }
+    QString getError(QString source) const;
+
+signals:
+    void fileStarted(QString source);
+    void fileFinished(QString source, bool succeeded, QString message);
+    void completionChanged(int filesDone, int filesTotal);
+
+protected:
+    class Worker;
+    friend class Worker;
+
+    typedef std::vector<Transform> TransformGroup;
+    std::vector<TransformGroup> m_groups;
+    std::vector<FeatureWriter *> m_writers;
+
+    int m_threadCount;
+    int m_readBlockSize;
+    bool m_normalise;
+    std::atomic<bool> m_abandoned; // set by abandon() from another thread
+
+    QStringList m_sources;
+    int m_nextSource;
+    int m_done;
+    QStringList m_failed;
+    QMap<QString, QString> m_errors;
+
+    QMutex m_queueMutex;
+    QMutex m_writerMutex;
+
+    bool takeNextSource(int &index);
+    bool extractFeaturesFor(int index, QString &message);
+    void sourceFinished(int index, bool succeeded, QString message);
+};
+
+#endif
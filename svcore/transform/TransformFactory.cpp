@@ -19,6 +19,7 @@
 #include "plugin/RealTimePluginFactory.h"
 #include "plugin/RealTimePluginInstance.h"
 #include "plugin/PluginXml.h"
+#include "plugin/PluginScanCache.h"
 
 #include <vamp-hostsdk/Plugin.h>
 #include <vamp-hostsdk/PluginHostAdapter.h>
@@ -418,30 +419,31 @@ TransformFactory::populateFeatureExtractionPlugins(TransformDescriptionMap &tran
 	    continue;
 	}
 
-	Vamp::Plugin *plugin = 
-	    factory->instantiatePlugin(pluginId, 44100);
+        // Described from the metadata found when the plugin path was
+        // scanned (usually from the plugin scan cache), rather than
+        // by loading and instantiating the plugin
+        PluginScanCache::Plugin plugin;
 
-	if (!plugin) {
-	    cerr << "WARNING: TransformFactory::populateTransforms: Failed to instantiate plugin " << pluginId << endl;
+	if (!factory->getPluginMetadata(pluginId, plugin)) {
+	    cerr << "WARNING: TransformFactory::populateTransforms: No metadata for plugin " << pluginId << endl;
 	    continue;
 	}
 		
-	QString pluginName = plugin->getName().c_str();
+	QString pluginName = plugin.name;
         QString category = factory->getPluginCategory(pluginId);
 
-	Vamp::Plugin::OutputList outputs =
-	    plugin->getOutputDescriptors();
+	const QList<PluginScanCache::Output> &outputs = plugin.outputs;
 
 	for (int j = 0; j < (int)outputs.size(); ++j) {
 
 	    QString transformId = QString("%1:%2")
-		    .arg(pluginId).arg(outputs[j].identifier.c_str());
+		    .arg(pluginId).arg(outputs[j].identifier);
 
 	    QString userName;
             QString friendlyName;
-            QString units = outputs[j].unit.c_str();
-            QString description = plugin->getDescription().c_str();
-            QString maker = plugin->getMaker().c_str();
+            QString units = outputs[j].unit;
+            QString description = plugin.description;
+            QString maker = plugin.maker;
             if (maker == "") maker = tr("<unknown maker>");
 
             QString longDescription = description;
@@ -452,7 +454,7 @@ TransformFactory::populateFeatureExtractionPlugins(TransformDescriptionMap &tran
                         .arg(pluginName).arg(maker);
                 } else {
                     longDescription = tr("Extract features using \"%1\" output of \"%2\" plugin (from %3)")
-                        .arg(outputs[j].name.c_str()).arg(pluginName).arg(maker);
+                        .arg(outputs[j].name).arg(pluginName).arg(maker);
                 }
             } else {
                 if (outputs.size() == 1) {
@@ -460,7 +462,7 @@ TransformFactory::populateFeatureExtractionPlugins(TransformDescriptionMap &tran
                         .arg(longDescription).arg(pluginName).arg(maker);
                 } else {
                     longDescription = tr("%1 using \"%2\" output of \"%3\" plugin (from %4)")
-                        .arg(longDescription).arg(outputs[j].name.c_str()).arg(pluginName).arg(maker);
+                        .arg(longDescription).arg(outputs[j].name).arg(pluginName).arg(maker);
                 }
             }                    
 
@@ -470,12 +472,12 @@ TransformFactory::populateFeatureExtractionPlugins(TransformDescriptionMap &tran
 	    } else {
 		userName = QString("%1: %2")
 		    .arg(pluginName)
-		    .arg(outputs[j].name.c_str());
-                friendlyName = outputs[j].name.c_str();
+		    .arg(outputs[j].name);
+                friendlyName = outputs[j].name;
 	    }
 
-            bool configurable = (!plugin->getPrograms().empty() ||
-                                 !plugin->getParameterDescriptors().empty());
+            bool configurable = (plugin.programCount > 0 ||
+                                 !plugin.parameters.empty());
 
 #ifdef DEBUG_TRANSFORM_FACTORY
             cerr << "Feature extraction plugin transform: " << transformId << " friendly name: " << friendlyName << endl;
@@ -493,8 +495,6 @@ TransformFactory::populateFeatureExtractionPlugins(TransformDescriptionMap &tran
                                      units,
                                      configurable);
 	}
-
-        delete plugin;
     }
 }
 
@@ -881,6 +881,14 @@ TransformFactory::getTransformInputDomain(TransformId identifier)
         return Vamp::Plugin::TimeDomain;
     }
 
+    QString pluginId = transform.getPluginIdentifier();
+    FeatureExtractionPluginFactory *factory =
+        FeatureExtractionPluginFactory::instanceFor(pluginId);
+    PluginScanCache::Plugin metadata;
+    if (factory && factory->getPluginMetadata(pluginId, metadata)) {
+        return Vamp::Plugin::InputDomain(metadata.inputDomain);
+    }
+
     Vamp::Plugin *plugin =
         downcastVampPlugin(instantiateDefaultPluginFor(identifier, 0));
 
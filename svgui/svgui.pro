@@ -151,6 +151,7 @@ HEADERS += widgets/ActivityLog.h \
            widgets/TextAbbrev.h \
            widgets/Thumbwheel.h \
            widgets/TipDialog.h \
+           widgets/TraceViewer.h \
            widgets/TransformFinder.h \
            widgets/UnitConverter.h \
            widgets/WindowShapePreview.h \
@@ -191,6 +192,7 @@ SOURCES += widgets/ActivityLog.cpp \
            widgets/TextAbbrev.cpp \
            widgets/Thumbwheel.cpp \
            widgets/TipDialog.cpp \
+           widgets/TraceViewer.cpp \
            widgets/TransformFinder.cpp \
            widgets/UnitConverter.cpp \
            widgets/WindowShapePreview.cpp \
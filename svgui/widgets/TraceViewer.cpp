@@ -0,0 +1,179 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#include "TraceViewer.h"
+
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTimer>
+#include <QApplication>
+
+#include "base/Trace.h"
+
+namespace {
+
+QTableWidgetItem *
+numberItem(double value, int decimals)
+{
+    QTableWidgetItem *item = new QTableWidgetItem;
+    item->setData(Qt::DisplayRole, decimals > 0 ?
+                  QVariant(QString::number(value, 'f', decimals).toDouble()) :
+                  QVariant(qint64(value)));
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+}
+
+TraceViewer::TraceViewer() : QDialog()
+{
+    setWindowTitle(tr("Trace"));
+
+    QGridLayout *layout = new QGridLayout;
+    setLayout(layout);
+
+    layout->addWidget(new QLabel(tr("<p>Trace records the time spent in the main operations of %1 (annotation plugins, "
+                                    "alignment, statistics, audio analysis) and counts the processes launched, the bytes "
+                                    "read and the annotation tiers loaded and saved.</p>")
+                                 .arg(QApplication::applicationName())), 0, 0);
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    m_record = new QCheckBox(tr("Record"));
+    m_record->setChecked(Trace::isEnabled());
+    connect(m_record, SIGNAL(toggled(bool)), this, SLOT(recordToggled(bool)));
+    controls->addWidget(m_record);
+    m_status = new QLabel;
+    controls->addWidget(m_status, 10);
+    QPushButton *clear = new QPushButton(tr("Clear"));
+    connect(clear, SIGNAL(clicked()), this, SLOT(clearTrace()));
+    controls->addWidget(clear);
+    QPushButton *exportButton = new QPushButton(tr("Export..."));
+    exportButton->setToolTip(tr("Save the recorded events in the Chrome trace format (chrome://tracing, Perfetto)"));
+    connect(exportButton, SIGNAL(clicked()), this, SLOT(exportTrace()));
+    controls->addWidget(exportButton);
+    layout->addLayout(controls, 1, 0);
+
+    m_spans = new QTableWidget(0, 6);
+    m_spans->setHorizontalHeaderLabels(QStringList() << tr("Category") << tr("Name") << tr("Count")
+                                       << tr("Total (ms)") << tr("Mean (ms)") << tr("Max (ms)"));
+    m_spans->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_spans->setSortingEnabled(true);
+    m_spans->verticalHeader()->hide();
+    m_spans->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    layout->addWidget(m_spans, 2, 0);
+    layout->setRowStretch(2, 10);
+
+    m_counters = new QTableWidget(0, 3);
+    m_counters->setHorizontalHeaderLabels(QStringList() << tr("Category") << tr("Counter") << tr("Value"));
+    m_counters->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_counters->verticalHeader()->hide();
+    m_counters->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    layout->addWidget(m_counters, 3, 0);
+    layout->setRowStretch(3, 3);
+
+    QDialogButtonBox *bb = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(bb, &QDialogButtonBox::rejected, this, &QWidget::hide);
+    layout->addWidget(bb, 4, 0);
+
+    // Only poll the trace while the dialog is shown
+    m_timer = new QTimer(this);
+    m_timer->setInterval(1000);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(refresh()));
+
+    resize(720, 520);
+}
+
+TraceViewer::~TraceViewer()
+{
+}
+
+void
+TraceViewer::showEvent(QShowEvent *e)
+{
+    QDialog::showEvent(e);
+    m_record->setChecked(Trace::isEnabled());
+    refresh();
+    m_timer->start();
+}
+
+void
+TraceViewer::hideEvent(QHideEvent *e)
+{
+    m_timer->stop();
+    QDialog::hideEvent(e);
+}
+
+void
+TraceViewer::recordToggled(bool on)
+{
+    Trace::setEnabled(on);
+    refresh();
+}
+
+void
+TraceViewer::clearTrace()
+{
+    Trace::clear();
+    refresh();
+}
+
+void
+TraceViewer::refresh()
+{
+    QList<Trace::SpanSummary> summary = Trace::summary();
+
+    m_spans->setSortingEnabled(false);
+    m_spans->setRowCount(summary.count());
+    for (int row = 0; row < summary.count(); ++row) {
+        const Trace::SpanSummary &s = summary.at(row);
+        m_spans->setItem(row, 0, new QTableWidgetItem(s.category));
+        m_spans->setItem(row, 1, new QTableWidgetItem(s.name));
+        m_spans->setItem(row, 2, numberItem(s.count, 0));
+        m_spans->setItem(row, 3, numberItem(double(s.total) / 1.0e6, 3));
+        m_spans->setItem(row, 4, numberItem(double(s.total) / 1.0e6 / double(s.count), 3));
+        m_spans->setItem(row, 5, numberItem(double(s.maximum) / 1.0e6, 3));
+    }
+    m_spans->setSortingEnabled(true);
+
+    QList<TraceCounter *> counters = TraceCounter::all();
+    m_counters->setRowCount(counters.count());
+    for (int row = 0; row < counters.count(); ++row) {
+        TraceCounter *counter = counters.at(row);
+        m_counters->setItem(row, 0, new QTableWidgetItem(QString(counter->category())));
+        m_counters->setItem(row, 1, new QTableWidgetItem(QString(counter->name())));
+        m_counters->setItem(row, 2, numberItem(double(counter->value()), 0));
+    }
+
+    m_status->setText(Trace::isEnabled() ? tr("Recording") : tr("Not recording"));
+}
+
+void
+TraceViewer::exportTrace()
+{
+    QString filename = QFileDialog::getSaveFileName(this, tr("Export Trace"), "trace.json",
+                                                    tr("Chrome trace files (*.json)"));
+    if (filename.isEmpty()) return;
+    QString error;
+    if (!Trace::saveChromeTrace(filename, error)) {
+        QMessageBox::warning(this, tr("Export Trace"), error);
+    }
+}
@@ -0,0 +1,57 @@
+/* -*- c-basic-offset: 4 indent-tabs-mode: nil -*-  vi:set ts=8 sts=4 sw=4: */
+
+/*
+    Sonic Visualiser
+    An audio file viewer and annotation editor.
+    Centre for Digital Music, Queen Mary, University of London.
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation; either version 2 of the
+    License, or (at your option) any later version.  See the file
+    COPYING included with this distribution for more information.
+*/
+
+#ifndef _TRACE_VIEWER_H_
+#define _TRACE_VIEWER_H_
+
+#include <QDialog>
+
+class QCheckBox;
+class QTableWidget;
+class QLabel;
+class QTimer;
+
+/**
+ * Dialog to switch tracing on and off, inspect the spans and
+ * counters recorded so far, and export them as a Chrome trace.
+ */
+class TraceViewer : public QDialog
+{
+    Q_OBJECT
+
+public:
+    TraceViewer();
+    ~TraceViewer();
+
+public slots:
+    void refresh();
+
+protected slots:
+    void recordToggled(bool);
+    void clearTrace();
+    void exportTrace();
+
+protected:
+    void showEvent(QShowEvent *);
+    void hideEvent(QHideEvent *);
+
+private:
+    QCheckBox *m_record;
+    QLabel *m_status;
+    QTableWidget *m_spans;
+    QTableWidget *m_counters;
+    QTimer *m_timer;
+};
+
+#endif